@@ -0,0 +1,389 @@
+//--------------------------------------------------------------------------------------
+// File: AnimationBench.cpp
+//
+// AnimationPlayer suite: a crowd of characters sharing one skeleton, played and
+// cross-faded frame by frame. It reports bones per second for the player, which samples
+// four bones at a time, and for a scalar sampler that handles one bone at a time, and
+// checks every palette the player builds against the scalar one.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+
+#include "ModelAnimation.h"
+
+using namespace BenchTool;
+using namespace DirectX;
+
+
+namespace
+{
+    // Not a multiple of four, so the last group of bones is partly padding.
+    const size_t BoneCount = 61;
+    const float FrameTime = 1.f / 60.f;
+    const float FadeTime = 0.5f;
+
+    XMFLOAT4 RandomRotation(Random& random)
+    {
+        XMVECTOR axis = XMVectorSet(RandomFloat(random, -1.f, 1.f), RandomFloat(random, -1.f, 1.f), RandomFloat(random, -1.f, 1.f), 0.f);
+        if (XMVectorGetX(XMVector3Length(axis)) < 0.01f)
+            axis = g_XMIdentityR1;
+
+        XMVECTOR q = XMQuaternionRotationAxis(axis, RandomFloat(random, -XM_PI, XM_PI));
+
+        // Flip some keys to the other hemisphere, which slerp has to take the short way round.
+        if (RandomIndex(random, 4) == 0)
+            q = XMVectorNegate(q);
+
+        XMFLOAT4 result;
+        XMStoreFloat4(&result, q);
+        return result;
+    }
+
+
+    AnimationClip MakeClip(Random& random, const wchar_t* name, float duration, size_t trackCount)
+    {
+        AnimationClip clip;
+        clip.name = name;
+        clip.startTime = 0.25f;
+        clip.endTime = clip.startTime + duration;
+
+        for (size_t b = 0; b < trackCount; ++b)
+        {
+            // Some bones stay at their rest pose, some hold a single key.
+            size_t keyCount = (b % 9 == 4) ? 0 : (b % 11 == 7) ? 1 : 2 + RandomIndex(random, 24);
+
+            AnimationClip::Track track = { static_cast<uint32_t>(clip.keyTimes.size()), static_cast<uint32_t>(keyCount) };
+            clip.tracks.push_back(track);
+
+            for (size_t k = 0; k < keyCount; ++k)
+            {
+                // Two keys may share a time, as exported clips sometimes do.
+                float time = clip.startTime + duration * float(k) / float(std::max<size_t>(1, keyCount - 1));
+                if (k == 1 && (b % 5) == 0)
+                    time = clip.startTime;
+
+                clip.keyTimes.push_back(time);
+                clip.keyRotations.push_back(RandomRotation(random));
+                clip.keyTranslations.push_back(XMFLOAT3(RandomFloat(random, -1.f, 1.f), RandomFloat(random, 0.f, 2.f), RandomFloat(random, -1.f, 1.f)));
+                clip.keyScales.push_back(XMFLOAT3(RandomFloat(random, 0.5f, 1.5f), RandomFloat(random, 0.5f, 1.5f), RandomFloat(random, 0.5f, 1.5f)));
+            }
+        }
+
+        return clip;
+    }
+
+
+    std::shared_ptr<ModelSkeleton> MakeSkeleton()
+    {
+        Random random(28);
+
+        auto skeleton = std::make_shared<ModelSkeleton>();
+
+        for (size_t b = 0; b < BoneCount; ++b)
+        {
+            ModelBone bone;
+            bone.parentIndex = b ? static_cast<int32_t>((b - 1) / 2) : -1;
+
+            XMFLOAT4 rotation = RandomRotation(random);
+            XMStoreFloat4x4(&bone.localTransform, XMMatrixMultiply(XMMatrixRotationQuaternion(XMLoadFloat4(&rotation)), XMMatrixTranslation(0.f, 1.f, 0.f)));
+            XMStoreFloat4x4(&bone.invBindPose, XMMatrixTranslation(0.f, -float(b), 0.f));
+
+            skeleton->bones.push_back(bone);
+        }
+
+        skeleton->clips.push_back(MakeClip(random, L"walk", 1.3f, BoneCount));
+        skeleton->clips.push_back(MakeClip(random, L"wave", 0.7f, BoneCount - 10));
+
+        return skeleton;
+    }
+
+
+    // The sampler the player had before it worked on four bones at once: one bone at a
+    // time, with XMQuaternionSlerp and XMVectorLerp. Playback time and the cross-fade
+    // follow AnimationPlayer's, so the two can be compared frame by frame.
+    class ScalarPlayer
+    {
+    public:
+        explicit ScalarPlayer(std::shared_ptr<const ModelSkeleton> skeleton)
+          : mSkeleton(std::move(skeleton)),
+            mFadeTime(0.f),
+            mFading(false),
+            mPalette(BoneCount)
+        {
+            for (auto& bone : mSkeleton->bones)
+            {
+                XMVECTOR s, r, t;
+                if (!XMMatrixDecompose(&s, &r, &t, XMLoadFloat4x4(&bone.localTransform)))
+                {
+                    s = g_XMOne;
+                    r = XMQuaternionIdentity();
+                    t = g_XMZero;
+                }
+
+                mRest.push_back({ r, t, s });
+            }
+
+            mCurrent.clip = mPrevious.clip = -1;
+        }
+
+        void Play(size_t clip, bool fade)
+        {
+            mFading = fade && mCurrent.clip >= 0;
+            if (mFading)
+                std::swap(mPrevious, mCurrent);
+
+            mFadeTime = 0.f;
+            mCurrent.clip = static_cast<int>(clip);
+            mCurrent.time = 0.f;
+            mCurrent.cursors.assign(BoneCount, 0);
+        }
+
+        void Update(float elapsedSeconds)
+        {
+            Advance(mCurrent, elapsedSeconds);
+            Sample(mCurrent, mCurrentPose);
+
+            if (mFading)
+            {
+                mFadeTime += elapsedSeconds;
+
+                if (mFadeTime >= FadeTime)
+                {
+                    mFading = false;
+                }
+                else
+                {
+                    Advance(mPrevious, elapsedSeconds);
+                    Sample(mPrevious, mPreviousPose);
+
+                    float weight = mFadeTime / FadeTime;
+
+                    for (size_t b = 0; b < BoneCount; ++b)
+                    {
+                        mCurrentPose[b].rotation = XMQuaternionSlerp(mPreviousPose[b].rotation, mCurrentPose[b].rotation, weight);
+                        mCurrentPose[b].translation = XMVectorLerp(mPreviousPose[b].translation, mCurrentPose[b].translation, weight);
+                        mCurrentPose[b].scale = XMVectorLerp(mPreviousPose[b].scale, mCurrentPose[b].scale, weight);
+                    }
+                }
+            }
+
+            for (size_t b = 0; b < BoneCount; ++b)
+            {
+                auto& pose = mCurrentPose[b];
+                auto& bone = mSkeleton->bones[b];
+
+                XMMATRIX local = XMMatrixAffineTransformation(pose.scale, g_XMZero, pose.rotation, pose.translation);
+                mGlobal[b] = (bone.parentIndex >= 0) ? XMMatrixMultiply(local, mGlobal[bone.parentIndex]) : local;
+
+                mPalette[b] = XMMatrixMultiply(XMLoadFloat4x4(&bone.invBindPose), mGlobal[b]);
+            }
+        }
+
+        XMMATRIX const* GetBoneTransforms() const { return mPalette.data(); }
+
+    private:
+        struct Pose
+        {
+            XMVECTOR rotation;
+            XMVECTOR translation;
+            XMVECTOR scale;
+        };
+
+        struct Layer
+        {
+            int clip;
+            float time;
+            std::vector<uint32_t> cursors;
+        };
+
+        void Advance(Layer& layer, float elapsedSeconds)
+        {
+            float duration = mSkeleton->clips[layer.clip].GetDuration();
+
+            layer.time += elapsedSeconds;
+            if (layer.time >= duration)
+                layer.time = fmodf(layer.time, duration);
+        }
+
+        void Sample(Layer& layer, Pose* pose)
+        {
+            auto& clip = mSkeleton->clips[layer.clip];
+            float t = clip.startTime + layer.time;
+
+            for (size_t b = 0; b < BoneCount; ++b)
+            {
+                if (b >= clip.tracks.size() || !clip.tracks[b].keyCount)
+                {
+                    pose[b] = mRest[b];
+                    continue;
+                }
+
+                auto& track = clip.tracks[b];
+                auto times = &clip.keyTimes[track.firstKey];
+                uint32_t& cursor = layer.cursors[b];
+
+                if (cursor >= track.keyCount || times[cursor] > t)
+                    cursor = 0;
+
+                while (cursor + 1 < track.keyCount && times[cursor + 1] <= t)
+                    ++cursor;
+
+                size_t k0 = track.firstKey + cursor;
+
+                pose[b].rotation = XMLoadFloat4(&clip.keyRotations[k0]);
+                pose[b].translation = XMLoadFloat3(&clip.keyTranslations[k0]);
+                pose[b].scale = XMLoadFloat3(&clip.keyScales[k0]);
+
+                if (cursor + 1 >= track.keyCount || t <= times[cursor])
+                    continue;
+
+                size_t k1 = k0 + 1;
+                float span = times[cursor + 1] - times[cursor];
+                float f = (span > 0.f) ? (t - times[cursor]) / span : 0.f;
+
+                pose[b].rotation = XMQuaternionSlerp(pose[b].rotation, XMLoadFloat4(&clip.keyRotations[k1]), f);
+                pose[b].translation = XMVectorLerp(pose[b].translation, XMLoadFloat3(&clip.keyTranslations[k1]), f);
+                pose[b].scale = XMVectorLerp(pose[b].scale, XMLoadFloat3(&clip.keyScales[k1]), f);
+            }
+        }
+
+        std::shared_ptr<const ModelSkeleton> mSkeleton;
+        std::vector<Pose> mRest;
+        Layer mCurrent;
+        Layer mPrevious;
+        float mFadeTime;
+        bool mFading;
+        Pose mCurrentPose[BoneCount];
+        Pose mPreviousPose[BoneCount];
+        XMMATRIX mGlobal[BoneCount];
+        std::vector<XMMATRIX> mPalette;
+    };
+
+
+    float PaletteError(XMMATRIX const* a, XMMATRIX const* b)
+    {
+        float error = 0.f;
+
+        for (size_t j = 0; j < BoneCount; ++j)
+        {
+            for (size_t r = 0; r < 4; ++r)
+            {
+                XMVECTOR d = XMVectorAbs(XMVectorSubtract(a[j].r[r], b[j].r[r]));
+                error = std::max(error, std::max(std::max(XMVectorGetX(d), XMVectorGetY(d)), std::max(XMVectorGetZ(d), XMVectorGetW(d))));
+            }
+        }
+
+        return error;
+    }
+
+
+    //----------------------------------------------------------------------------------
+    void CheckPlayback(Bench& bench, std::shared_ptr<const ModelSkeleton> const& skeleton)
+    {
+        bench.Section("animation: palettes against one-bone-at-a-time sampling");
+
+        AnimationPlayer player(skeleton);
+        ScalarPlayer reference(skeleton);
+
+        player.Play(0);
+        reference.Play(0, false);
+
+        // Long enough to loop the clip, then fade into the other one and loop that too.
+        float worst = 0.f;
+
+        for (size_t frame = 0; frame < 300; ++frame)
+        {
+            if (frame == 120)
+            {
+                player.Play(1, true, FadeTime);
+                reference.Play(1, true);
+            }
+
+            player.Update(FrameTime);
+            reference.Update(FrameTime);
+
+            worst = std::max(worst, PaletteError(player.GetBoneTransforms(), reference.GetBoneTransforms()));
+        }
+
+        bench.Check(worst < 1e-3f, "animation: palette differs from the scalar sampler by %f", worst);
+        bench.Report("largest palette difference", worst * 1e6, "millionths");
+    }
+
+
+    template<typename TPlayer, typename TPlay>
+    double TimeCrowd(Bench& bench, std::vector<TPlayer>& crowd, size_t frames, TPlay play)
+    {
+        for (size_t j = 0; j < crowd.size(); ++j)
+            play(crowd[j], 0, false);
+
+        Timer timer;
+
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            // Characters start cross-fading at different frames, so every frame has some fading.
+            for (size_t j = 0; j < crowd.size(); ++j)
+            {
+                if ((frame + j * 7) % 90 == 0)
+                    play(crowd[j], (frame / 90 + j) & 1, true);
+
+                crowd[j].Update(FrameTime);
+            }
+        }
+
+        double seconds = timer.GetSeconds();
+
+        bench.Report("bones per second", double(crowd.size() * frames * BoneCount) / std::max(seconds, 1e-9), "");
+        bench.Report("time per character per frame", seconds * 1e6 / double(crowd.size() * frames), "us");
+
+        return seconds;
+    }
+
+
+    void TimeCrowds(Bench& bench, std::shared_ptr<const ModelSkeleton> const& skeleton)
+    {
+        size_t characters = 256;
+        size_t frames = bench.Scaled(200);
+
+        std::vector<AnimationPlayer> players;
+        std::vector<ScalarPlayer> scalars;
+
+        for (size_t j = 0; j < characters; ++j)
+        {
+            players.emplace_back(skeleton);
+            scalars.emplace_back(skeleton);
+        }
+
+        bench.Section("animation: AnimationPlayer, four bones at a time");
+        double fourWide = TimeCrowd(bench, players, frames, [](AnimationPlayer& player, size_t clip, bool fade)
+        {
+            player.Play(clip, true, fade ? FadeTime : 0.f);
+        });
+
+        bench.Section("animation: scalar sampling, one bone at a time");
+        double scalar = TimeCrowd(bench, scalars, frames, [](ScalarPlayer& player, size_t clip, bool fade)
+        {
+            player.Play(clip, fade);
+        });
+
+        bench.Report("AnimationPlayer speedup", scalar / std::max(fourWide, 1e-9), "x");
+    }
+}
+
+
+void BenchTool::AnimationSampling(Bench& bench)
+{
+    auto skeleton = MakeSkeleton();
+
+    CheckPlayback(bench, skeleton);
+    TimeCrowds(bench, skeleton);
+}
@@ -0,0 +1,341 @@
+//--------------------------------------------------------------------------------------
+// File: BcBench.cpp
+//
+// Block compression suite: the BC1, BC3, BC4 and BC5 codec in BlockCompression.h on a
+// synthetic photo-like image, reporting PSNR against encode and decode throughput on one
+// thread and on all of them. It checks hand-built blocks against the palettes the formats
+// define, that flat colors survive a round trip exactly, that BC1 keeps the source's one-bit
+// alpha, that the threaded encoder writes the same blocks as the single-threaded one, and
+// that images whose size isn't a multiple of four decode without touching the row padding.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+
+#include "BlockCompression.h"
+
+#include <thread>
+
+using namespace BenchTool;
+using namespace DirectX;
+
+
+namespace
+{
+    struct FormatInfo
+    {
+        BlockCompression::Format format;
+        const char* name;
+        size_t channelCount;    // Channels the format stores, for PSNR.
+        bool opaque;            // Measured on an opaque copy; BC1 turns the cut-out black.
+        double minimumPSNR;     // In dB, on the synthetic image.
+    };
+
+    const FormatInfo Formats[] =
+    {
+        { BlockCompression::BC1, "BC1", 3, true,  36.0 },
+        { BlockCompression::BC3, "BC3", 4, false, 36.0 },
+        { BlockCompression::BC4, "BC4", 1, false, 46.0 },
+        { BlockCompression::BC5, "BC5", 2, false, 48.0 },
+    };
+
+
+    // 8-bit RGBA with smooth shading and noise in red, a gradient in green, hard-edged
+    // checks in blue, and an alpha ramp with a fully transparent cut-out.
+    std::vector<uint8_t> MakeImage(size_t width, size_t height, size_t rowPitch)
+    {
+        std::vector<uint8_t> image(rowPitch * height, 0);
+
+        Random random(32);
+        std::uniform_int_distribution<int> noise(-6, 6);
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            uint8_t* row = &image[y * rowPitch];
+            for (size_t x = 0; x < width; ++x)
+            {
+                float shade = 128.f + 100.f * sinf(float(x) * 0.05f) * cosf(float(y) * 0.03f);
+                bool check = ((x / 32) + (y / 32)) & 1;
+                float dx = float(x) - float(width) * 0.5f;
+                float dy = float(y) - float(height) * 0.5f;
+                bool cutOut = (x % 64) < 8 && (y % 64) < 8;
+
+                int r = int(shade) + noise(random);
+                int g = int(x * 255 / std::max<size_t>(1, width - 1));
+                int b = (check ? 200 : 40) + noise(random);
+                int a = cutOut ? 0 : int(255.f - 160.f * std::min(1.f, sqrtf(dx * dx + dy * dy) / float(std::max(width, height))));
+
+                row[x * 4 + 0] = uint8_t(std::min(255, std::max(0, r)));
+                row[x * 4 + 1] = uint8_t(g);
+                row[x * 4 + 2] = uint8_t(std::min(255, std::max(0, b)));
+                row[x * 4 + 3] = uint8_t(a);
+            }
+        }
+
+        return image;
+    }
+
+
+    std::vector<uint8_t> MakeOpaque(std::vector<uint8_t> image)
+    {
+        for (size_t j = 3; j < image.size(); j += 4)
+            image[j] = 255;
+        return image;
+    }
+
+
+    size_t SurfaceSize(BlockCompression::Format format, size_t width, size_t height)
+    {
+        return std::max<size_t>(1, (width + 3) / 4) * std::max<size_t>(1, (height + 3) / 4) * BlockCompression::BlockSize(format);
+    }
+
+
+    bool TexelIs(const uint8_t* rgba, size_t index, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+    {
+        const uint8_t* t = rgba + index * 4;
+        return t[0] == r && t[1] == g && t[2] == b && t[3] == a;
+    }
+
+
+    // Blocks built by hand, with endpoints whose interpolated palettes are whole numbers.
+    void CheckKnownBlocks(Bench& bench)
+    {
+        // Indices 0, 1, 2, 3 repeated: 0xE4 packs them from the low bits up.
+        const uint8_t indexBytes[4] = { 0xE4, 0xE4, 0xE4, 0xE4 };
+
+        uint8_t texels[64];
+
+        // Four-color BC1: white and black, so the palette is 255, 0, 170, 85.
+        {
+            const uint8_t block[8] = { 0xFF, 0xFF, 0x00, 0x00, indexBytes[0], indexBytes[1], indexBytes[2], indexBytes[3] };
+            BlockCompression::DecodeBC1(block, texels);
+
+            bench.Check(TexelIs(texels, 0, 255, 255, 255, 255) && TexelIs(texels, 1, 0, 0, 0, 255)
+                        && TexelIs(texels, 2, 170, 170, 170, 255) && TexelIs(texels, 3, 85, 85, 85, 255)
+                        && memcmp(texels, texels + 16, 48) == 0,
+                        "bc: four-color BC1 block decoded to the wrong palette");
+        }
+
+        // Three-color BC1: black and 565 (16, 32, 16), which expands to (132, 130, 132); index 3 is transparent black.
+        {
+            const uint8_t block[8] = { 0x00, 0x00, 0x10, 0x84, indexBytes[0], indexBytes[1], indexBytes[2], indexBytes[3] };
+            BlockCompression::DecodeBC1(block, texels);
+
+            bench.Check(TexelIs(texels, 0, 0, 0, 0, 255) && TexelIs(texels, 1, 132, 130, 132, 255)
+                        && TexelIs(texels, 2, 66, 65, 66, 255) && TexelIs(texels, 3, 0, 0, 0, 0),
+                        "bc: three-color BC1 block decoded to the wrong palette");
+        }
+
+        // Eight-value BC4: 210 and 0 step by 30. Six-value BC4: 0 and 250 step by 50, then 0 and 255.
+        {
+            const uint8_t expected8[8] = { 210, 0, 180, 150, 120, 90, 60, 30 };
+            const uint8_t expected6[8] = { 0, 250, 50, 100, 150, 200, 0, 255 };
+
+            // Indices 0..7 for texels 0..7 and again for 8..15, three bits each.
+            uint64_t bits = 0;
+            for (uint64_t j = 0; j < 16; ++j)
+                bits |= (j & 7) << (j * 3);
+
+            uint8_t block[8] = {};
+            for (size_t j = 0; j < 6; ++j)
+                block[2 + j] = uint8_t(bits >> (j * 8));
+
+            uint8_t values[16];
+            block[0] = 210;
+            block[1] = 0;
+            BlockCompression::DecodeBC4(block, values, 1);
+            bool ok8 = memcmp(values, expected8, 8) == 0 && memcmp(values + 8, expected8, 8) == 0;
+
+            block[0] = 0;
+            block[1] = 250;
+            BlockCompression::DecodeBC4(block, values, 1);
+            bool ok6 = memcmp(values, expected6, 8) == 0 && memcmp(values + 8, expected6, 8) == 0;
+
+            bench.Check(ok8, "bc: eight-value BC4 block decoded to the wrong palette");
+            bench.Check(ok6, "bc: six-value BC4 block decoded to the wrong palette");
+        }
+    }
+
+
+    // Flat blocks in colors 565 can hold, and every BC4 value, must come back unchanged.
+    void CheckFlatBlocks(Bench& bench)
+    {
+        const uint8_t colors[][4] =
+        {
+            { 255, 0, 0, 255 }, { 0, 255, 0, 255 }, { 0, 0, 255, 255 }, { 255, 255, 255, 255 }, { 0, 0, 0, 255 },
+        };
+
+        size_t failures = 0;
+
+        for (auto color : colors)
+        {
+            uint8_t image[64];
+            for (size_t j = 0; j < 16; ++j)
+                memcpy(image + j * 4, color, 4);
+
+            for (auto format : { BlockCompression::BC1, BlockCompression::BC3 })
+            {
+                uint8_t block[16];
+                uint8_t decoded[64];
+                BlockCompression::Encode(format, image, 4, 4, 16, block, 1);
+                BlockCompression::Decode(format, block, 4, 4, decoded, 16, 1);
+
+                if (memcmp(image, decoded, sizeof(image)) != 0)
+                    ++failures;
+            }
+        }
+
+        for (unsigned value = 0; value < 256; ++value)
+        {
+            uint8_t image[64];
+            for (size_t j = 0; j < 16; ++j)
+            {
+                image[j * 4 + 0] = uint8_t(value);
+                image[j * 4 + 1] = uint8_t(255 - value);
+                image[j * 4 + 2] = 0;
+                image[j * 4 + 3] = 255;
+            }
+
+            uint8_t block[16];
+            uint8_t decoded[64];
+            BlockCompression::Encode(BlockCompression::BC5, image, 4, 4, 16, block, 1);
+            BlockCompression::Decode(BlockCompression::BC5, block, 4, 4, decoded, 16, 1);
+
+            if (memcmp(image, decoded, sizeof(image)) != 0)
+                ++failures;
+        }
+
+        bench.Check(failures == 0, "bc: %zu flat blocks didn't survive a round trip", failures);
+    }
+
+
+    // A 301x203 image with 64 bytes of padding per row: the last blocks overhang the image.
+    void CheckUnalignedImage(Bench& bench)
+    {
+        const size_t width = 301;
+        const size_t height = 203;
+        const size_t rowPitch = width * 4 + 64;
+        const uint8_t padding = 0xCD;
+
+        auto image = MakeImage(width, height, rowPitch);
+        auto opaqueImage = MakeOpaque(image);
+
+        for (auto const& info : Formats)
+        {
+            auto& source = info.opaque ? opaqueImage : image;
+
+            std::vector<uint8_t> blocks(SurfaceSize(info.format, width, height));
+            BlockCompression::Encode(info.format, source.data(), width, height, rowPitch, blocks.data(), 3);
+
+            std::vector<uint8_t> decoded(rowPitch * height, padding);
+            BlockCompression::Decode(info.format, blocks.data(), width, height, decoded.data(), rowPitch, 3);
+
+            size_t touched = 0;
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = width * 4; x < rowPitch; ++x)
+                {
+                    if (decoded[y * rowPitch + x] != padding)
+                        ++touched;
+                }
+            }
+
+            double psnr = BlockCompression::ComputePSNR(source.data(), decoded.data(), width, height, rowPitch, info.channelCount);
+
+            bench.Check(touched == 0, "bc: %s decode of a %zux%zu image wrote %zu bytes of row padding", info.name, width, height, touched);
+            bench.Check(psnr >= info.minimumPSNR, "bc: %s PSNR %.2f dB on a %zux%zu image, expected at least %.1f",
+                        info.name, psnr, width, height, info.minimumPSNR);
+        }
+
+        // BC1 keeps one bit of alpha: texels below 128 must come back transparent, the rest opaque.
+        std::vector<uint8_t> blocks(SurfaceSize(BlockCompression::BC1, width, height));
+        BlockCompression::Encode(BlockCompression::BC1, image.data(), width, height, rowPitch, blocks.data(), 3);
+
+        std::vector<uint8_t> decoded(rowPitch * height, padding);
+        BlockCompression::Decode(BlockCompression::BC1, blocks.data(), width, height, decoded.data(), rowPitch, 3);
+
+        size_t wrongAlpha = 0;
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                size_t j = y * rowPitch + x * 4 + 3;
+                if (decoded[j] != ((image[j] < 128) ? 0 : 255))
+                    ++wrongAlpha;
+            }
+        }
+
+        bench.Check(wrongAlpha == 0, "bc: %zu BC1 texels have the wrong one-bit alpha", wrongAlpha);
+    }
+
+
+    void TimeFormat(Bench& bench, FormatInfo const& info, std::vector<uint8_t> const& image, size_t size, unsigned threadCount)
+    {
+        auto source = info.opaque ? MakeOpaque(image) : image;
+
+        char section[128];
+        snprintf(section, sizeof(section), "bc: %s, %zux%zu", info.name, size, size);
+        bench.Section(section);
+
+        size_t rowPitch = size * 4;
+        size_t repeats = bench.Scaled(4);
+        double megapixels = double(size * size) * double(repeats) / 1e6;
+
+        std::vector<uint8_t> single(SurfaceSize(info.format, size, size));
+        std::vector<uint8_t> threaded(single.size());
+        std::vector<uint8_t> decoded(rowPitch * size);
+
+        Timer timer;
+        for (size_t j = 0; j < repeats; ++j)
+            BlockCompression::Encode(info.format, source.data(), size, size, rowPitch, single.data(), 1);
+        double encodeSeconds = timer.GetSeconds();
+
+        timer.Restart();
+        for (size_t j = 0; j < repeats; ++j)
+            BlockCompression::Encode(info.format, source.data(), size, size, rowPitch, threaded.data(), threadCount);
+        double threadedSeconds = timer.GetSeconds();
+
+        bench.Check(single == threaded, "bc: %s blocks encoded on %u threads differ from the single-threaded ones", info.name, threadCount);
+
+        timer.Restart();
+        for (size_t j = 0; j < repeats; ++j)
+            BlockCompression::Decode(info.format, threaded.data(), size, size, decoded.data(), rowPitch, 1);
+        double decodeSeconds = timer.GetSeconds();
+
+        double psnr = BlockCompression::ComputePSNR(source.data(), decoded.data(), size, size, rowPitch, info.channelCount);
+        bench.Check(psnr >= info.minimumPSNR, "bc: %s PSNR %.2f dB, expected at least %.1f", info.name, psnr, info.minimumPSNR);
+
+        char name[64];
+        bench.Report("PSNR", psnr, "dB");
+        bench.Report("encoded megapixels per second, 1 thread", megapixels / std::max(encodeSeconds, 1e-9), "");
+        snprintf(name, sizeof(name), "encoded megapixels per second, %u threads", threadCount);
+        bench.Report(name, megapixels / std::max(threadedSeconds, 1e-9), "");
+        bench.Report("decoded megapixels per second, 1 thread", megapixels / std::max(decodeSeconds, 1e-9), "");
+    }
+}
+
+
+void BenchTool::BlockCompressionCodec(Bench& bench)
+{
+    unsigned threadCount = bench.GetThreadCount() ? bench.GetThreadCount() : std::max(2u, std::thread::hardware_concurrency());
+
+    bench.Section("bc: known blocks, flat blocks and a 301x203 image");
+    CheckKnownBlocks(bench);
+    CheckFlatBlocks(bench);
+    CheckUnalignedImage(bench);
+
+    const size_t size = 512;
+    auto image = MakeImage(size, size, size * 4);
+
+    for (auto const& info : Formats)
+        TimeFormat(bench, info, image, size, threadCount);
+}
@@ -0,0 +1,131 @@
+//--------------------------------------------------------------------------------------
+// File: Bench.h
+//
+// What every BenchTool suite shares: the run settings, a timer, and reporting of
+// measurements and checks. A suite measures one part of DirectXTK and checks that the
+// work it measured was done correctly; any failed check makes benchtool exit with 1.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+
+namespace BenchTool
+{
+    class Bench
+    {
+    public:
+        Bench(double scale, unsigned threadCount)
+          : mScale(scale),
+            mThreadCount(threadCount),
+            mFailures(0)
+        {
+        }
+
+        // Work sizes are given for -scale 1 and shrink or grow with it, never below one.
+        size_t Scaled(size_t count) const
+        {
+            return std::max<size_t>(1, static_cast<size_t>(double(count) * mScale));
+        }
+
+        unsigned GetThreadCount() const { return mThreadCount; }
+        size_t GetFailures() const { return mFailures; }
+
+        void Section(const char* name)
+        {
+            printf("  %s\n", name);
+        }
+
+        void Report(const char* name, double value, const char* unit)
+        {
+            printf("    %-44s %16.2f %s\n", name, value, unit);
+        }
+
+        // Records a failure if the condition is false; returns the condition.
+        bool Check(bool condition, const char* format, ...)
+        {
+            if (!condition)
+            {
+                va_list args;
+                va_start(args, format);
+                printf("    FAILED: ");
+                vprintf(format, args);
+                printf("\n");
+                va_end(args);
+
+                mFailures++;
+            }
+
+            return condition;
+        }
+
+    private:
+        double mScale;
+        unsigned mThreadCount;
+        size_t mFailures;
+    };
+
+
+    class Timer
+    {
+    public:
+        Timer() : mStart(std::chrono::high_resolution_clock::now()) {}
+
+        void Restart() { mStart = std::chrono::high_resolution_clock::now(); }
+
+        double GetSeconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - mStart).count();
+        }
+
+    private:
+        std::chrono::high_resolution_clock::time_point mStart;
+    };
+
+
+    // Suites use a fixed seed, so every run measures the same work.
+    typedef std::mt19937 Random;
+
+    inline float RandomFloat(Random& random, float minimum, float maximum)
+    {
+        return std::uniform_real_distribution<float>(minimum, maximum)(random);
+    }
+
+    inline size_t RandomIndex(Random& random, size_t count)
+    {
+        return std::uniform_int_distribution<size_t>(0, count - 1)(random);
+    }
+
+
+    // Suites
+    void SpriteBatchScenarios(Bench& bench);
+    void SpriteBatchStress(Bench& bench);
+    void SpriteBatchLayers(Bench& bench);
+    void DDSHeaderValidation(Bench& bench);
+    void AnimationSampling(Bench& bench);
+    void RenderQueueSorting(Bench& bench);
+    void ScreenGrabQueueing(Bench& bench);
+    void ShardedCacheLookups(Bench& bench);
+    void BlockCompressionCodec(Bench& bench);
+    void MipChainGeneration(Bench& bench);
+    void DDSCubemapLoading(Bench& bench);
+    void SpriteSortKeys(Bench& bench);
+    void SpriteVertexGeneration(Bench& bench);
+    void SpriteRecording(Bench& bench);
+}
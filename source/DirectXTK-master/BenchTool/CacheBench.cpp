@@ -0,0 +1,272 @@
+//--------------------------------------------------------------------------------------
+// File: CacheBench.cpp
+//
+// ShardedCache suite: threads looking up and inserting shared assets by name, the way
+// EffectFactory's effect and texture caches are used while several models load at once,
+// against the std::map and single mutex those caches used before. Every thread must end
+// up with the same instance for each name, and the lookup counters must add up.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+
+#include "ShardedCache.h"
+
+#include <atomic>
+#include <map>
+#include <thread>
+
+using namespace BenchTool;
+using namespace DirectX;
+
+
+namespace
+{
+    const size_t NameCount = 2000;
+
+    struct Asset
+    {
+        explicit Asset(size_t id_) : id(id_) {}
+
+        size_t id;
+    };
+
+    typedef std::shared_ptr<Asset> AssetPtr;
+
+
+    // The caches as EffectFactory had them: a std::map keyed by std::wstring under one mutex.
+    // The old lookups didn't take the mutex, which raced with inserts; this one does.
+    class MapCache
+    {
+    public:
+        bool Find(const wchar_t* name, AssetPtr& result)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            auto it = mMap.find(name);
+            if (it == mMap.end())
+                return false;
+
+            result = it->second;
+            return true;
+        }
+
+        AssetPtr Insert(const wchar_t* name, AssetPtr const& value)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            return mMap.insert(std::make_pair(std::wstring(name), value)).first->second;
+        }
+
+    private:
+        std::mutex mMutex;
+        std::map<std::wstring, AssetPtr> mMap;
+    };
+
+
+    // Asset names as a model loader asks for them: a few common textures and effects shared by
+    // most models, and a long tail of ones used by a single model.
+    struct Workload
+    {
+        std::vector<std::wstring> names;
+        std::vector<std::vector<uint32_t>> requests;    // Per thread, indices into names.
+    };
+
+    Workload MakeWorkload(size_t threadCount, size_t lookupsPerThread)
+    {
+        Workload workload;
+
+        for (size_t j = 0; j < NameCount; ++j)
+        {
+            wchar_t name[64] = {};
+            swprintf_s(name, L"Media\\Levels\\Level%02zu\\Materials\\asset_%04zu.dds", j % 17, j);
+            workload.names.push_back(name);
+        }
+
+        Random random(30);
+        workload.requests.resize(threadCount);
+
+        for (auto& requests : workload.requests)
+        {
+            requests.reserve(lookupsPerThread);
+
+            for (size_t j = 0; j < lookupsPerThread; ++j)
+            {
+                // Squaring a uniform value skews the requests towards the low indices.
+                float u = RandomFloat(random, 0.0f, 1.0f);
+                requests.push_back(std::min(uint32_t(NameCount - 1), uint32_t(u * u * float(NameCount))));
+            }
+        }
+
+        return workload;
+    }
+
+
+    // Runs the workload on its threads; each thread keeps the instance it was handed for every name.
+    template<typename TCache>
+    double RunLookups(TCache& cache, Workload const& workload, std::vector<std::vector<Asset*>>& seen)
+    {
+        size_t threadCount = workload.requests.size();
+
+        seen.assign(threadCount, std::vector<Asset*>(NameCount, nullptr));
+
+        std::atomic<size_t> ready(0);
+        std::atomic<bool> start(false);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&, i]
+            {
+                auto& requests = workload.requests[i];
+                auto& mine = seen[i];
+
+                ++ready;
+                while (!start)
+                    std::this_thread::yield();
+
+                for (auto index : requests)
+                {
+                    const wchar_t* name = workload.names[index].c_str();
+
+                    AssetPtr asset;
+                    if (!cache.Find(name, asset))
+                    {
+                        asset = cache.Insert(name, std::make_shared<Asset>(index));
+                    }
+
+                    mine[index] = asset.get();
+                }
+            });
+        }
+
+        while (ready < threadCount)
+            std::this_thread::yield();
+
+        Timer timer;
+        start = true;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        return timer.GetSeconds();
+    }
+
+
+    // Every thread that asked for a name must hold the same instance, and it must be the right one.
+    void CheckShared(Bench& bench, std::vector<std::vector<Asset*>> const& seen, const char* what)
+    {
+        size_t mismatches = 0;
+
+        for (size_t j = 0; j < NameCount; ++j)
+        {
+            Asset* first = nullptr;
+
+            for (auto& mine : seen)
+            {
+                Asset* asset = mine[j];
+                if (!asset)
+                    continue;
+
+                if (asset->id != j || (first && asset != first))
+                    ++mismatches;
+
+                if (!first)
+                    first = asset;
+            }
+        }
+
+        bench.Check(mismatches == 0, "%s: %zu lookups were handed an unshared or wrong instance", what, mismatches);
+    }
+
+
+    // A second insert under a name must hand back the first instance rather than replace it.
+    template<typename TCache>
+    void CheckInsert(Bench& bench, TCache& cache, const char* what)
+    {
+        auto first = std::make_shared<Asset>(0);
+        auto second = std::make_shared<Asset>(0);
+
+        bool shared = cache.Insert(L"insert_check.dds", first) == first
+                   && cache.Insert(L"insert_check.dds", second) == first;
+
+        AssetPtr found;
+        bench.Check(shared && cache.Find(L"insert_check.dds", found) && found == first, "%s: a second insert replaced the cached instance", what);
+    }
+
+
+    void CompareCaches(Bench& bench, size_t threadCount)
+    {
+        size_t lookupsPerThread = bench.Scaled(400000);
+        auto workload = MakeWorkload(threadCount, lookupsPerThread);
+        size_t lookups = threadCount * lookupsPerThread;
+
+        char section[128];
+        snprintf(section, sizeof(section), "cache: %zu lookups of %zu names on %zu threads", lookups, NameCount, threadCount);
+        bench.Section(section);
+
+        std::vector<std::vector<Asset*>> seen;
+
+        // Each cache is kept alive until its instances have been checked.
+        ShardedCache<AssetPtr> sharded;
+        double shardedSeconds = RunLookups(sharded, workload, seen);
+        CheckShared(bench, seen, "ShardedCache");
+
+        auto stats = sharded.GetStatistics();
+        CheckInsert(bench, sharded, "ShardedCache");
+        bench.Check(stats.hits + stats.misses == lookups, "ShardedCache: %zu hits and %zu misses for %zu lookups", stats.hits, stats.misses, lookups);
+
+        size_t cached = 0;
+        for (auto const& name : workload.names)
+        {
+            AssetPtr asset;
+            if (sharded.Find(name.c_str(), asset))
+                ++cached;
+        }
+
+        size_t requested = 0;
+        for (size_t j = 0; j < NameCount; ++j)
+        {
+            for (auto& mine : seen)
+            {
+                if (mine[j])
+                {
+                    ++requested;
+                    break;
+                }
+            }
+        }
+
+        bench.Check(cached == requested, "ShardedCache: %zu names cached, %zu requested", cached, requested);
+
+        MapCache map;
+        CheckInsert(bench, map, "map and mutex");
+        double mapSeconds = RunLookups(map, workload, seen);
+        CheckShared(bench, seen, "map and mutex");
+
+        bench.Report("ShardedCache lookups per second", double(lookups) / std::max(shardedSeconds, 1e-9), "");
+        bench.Report("contended shard locks per 1000 lookups", 1000.0 * double(stats.contentions) / double(lookups), "");
+        bench.Report("map and mutex lookups per second", double(lookups) / std::max(mapSeconds, 1e-9), "");
+        bench.Report("ShardedCache speedup", mapSeconds / std::max(shardedSeconds, 1e-9), "x");
+    }
+}
+
+
+void BenchTool::ShardedCacheLookups(Bench& bench)
+{
+    unsigned maxThreads = bench.GetThreadCount() ? bench.GetThreadCount() : std::max(2u, std::thread::hardware_concurrency());
+
+    for (unsigned threadCount = 1; threadCount < maxThreads; threadCount *= 2)
+        CompareCaches(bench, threadCount);
+
+    CompareCaches(bench, maxThreads);
+}
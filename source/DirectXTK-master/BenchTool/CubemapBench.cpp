@@ -0,0 +1,429 @@
+//--------------------------------------------------------------------------------------
+// File: CubemapBench.cpp
+//
+// Cubemap suite: large synthetic DDS cubemaps and texture arrays, as skies and terrain
+// layers are shipped. It times the subresource setup FillInitData does, with the cached
+// layout table from LoaderHelpers.h against calling GetSurfaceInfo for every subresource
+// as it used to, and whole loads through CreateDDSTextureFromMemory and, with the file read
+// in chunks, CreateDDSTextureFromFile. It checks that the table gives the same pointers
+// and pitches as the old walk (with and without maxsize), and that every subresource the
+// recording device receives holds the bytes at its place in the file.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "DDSTextureLoader.h"
+#include "PlatformHelpers.h"
+#include "LoaderHelpers.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996)
+#endif
+
+using namespace BenchTool;
+using namespace DirectX;
+using namespace DirectX::LoaderHelpers;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    const size_t HeaderSize = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+
+    struct CubeFile
+    {
+        std::vector<uint8_t> data;
+        DXGI_FORMAT format;
+        size_t size;
+        size_t mipCount;
+        size_t items;           // Array items, six per cube
+        bool cube;
+        const char* name;
+    };
+
+
+    // Every payload byte is a hash of its offset, so a subresource taken from the wrong place shows.
+    uint8_t PayloadByte(size_t offset)
+    {
+        return uint8_t((uint32_t(offset) * 2654435761u) >> 24);
+    }
+
+
+    CubeFile WriteDDS(DXGI_FORMAT format, size_t size, size_t arraySize, bool cube, const char* name)
+    {
+        CubeFile file;
+        file.format = format;
+        file.size = size;
+        file.cube = cube;
+        file.name = name;
+        file.items = arraySize * (cube ? 6 : 1);
+
+        file.mipCount = 1;
+        for (size_t s = size; s > 1; s >>= 1)
+            ++file.mipCount;
+
+        DDS_HEADER header = {};
+        header.size = sizeof(DDS_HEADER);
+        header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
+        header.width = static_cast<uint32_t>(size);
+        header.height = static_cast<uint32_t>(size);
+        header.mipMapCount = static_cast<uint32_t>(file.mipCount);
+        header.caps = DDS_SURFACE_FLAGS_TEXTURE | DDS_SURFACE_FLAGS_MIPMAP;
+        header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+        header.ddspf.flags = DDS_FOURCC;
+        header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+
+        if (cube)
+        {
+            header.caps |= DDS_SURFACE_FLAGS_CUBEMAP;
+            header.caps2 = DDS_CUBEMAP | DDS_CUBEMAP_ALLFACES;
+        }
+
+        DDS_HEADER_DXT10 extension = {};
+        extension.dxgiFormat = format;
+        extension.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+        extension.miscFlag = cube ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+        extension.arraySize = static_cast<uint32_t>(arraySize);
+
+        size_t itemSize = 0;
+        for (size_t level = 0; level < file.mipCount; ++level)
+        {
+            size_t numBytes, rowBytes;
+            GetSurfaceInfo(std::max<size_t>(1, size >> level), std::max<size_t>(1, size >> level), format, &numBytes, &rowBytes, nullptr);
+            itemSize += numBytes;
+        }
+
+        file.data.resize(HeaderSize + itemSize * file.items);
+
+        memcpy(file.data.data(), &DDS_MAGIC, sizeof(uint32_t));
+        memcpy(file.data.data() + sizeof(uint32_t), &header, sizeof(header));
+        memcpy(file.data.data() + sizeof(uint32_t) + sizeof(header), &extension, sizeof(extension));
+
+        for (size_t i = HeaderSize; i < file.data.size(); ++i)
+            file.data[i] = PayloadByte(i);
+
+        return file;
+    }
+
+
+    // FillInitData as it was before the layout table: GetSurfaceInfo for every mip of every item.
+    size_t WalkSubresources(CubeFile const& file, size_t maxsize, D3D11_SUBRESOURCE_DATA* initData, size_t& skipMip)
+    {
+        const uint8_t* bits = file.data.data() + HeaderSize;
+        const uint8_t* end = file.data.data() + file.data.size();
+
+        skipMip = 0;
+        size_t index = 0;
+
+        for (size_t j = 0; j < file.items; ++j)
+        {
+            size_t w = file.size;
+            size_t h = file.size;
+            for (size_t i = 0; i < file.mipCount; ++i)
+            {
+                size_t numBytes, rowBytes;
+                GetSurfaceInfo(w, h, file.format, &numBytes, &rowBytes, nullptr);
+
+                if (file.mipCount <= 1 || !maxsize || (w <= maxsize && h <= maxsize))
+                {
+                    initData[index].pSysMem = bits;
+                    initData[index].SysMemPitch = static_cast<UINT>(rowBytes);
+                    initData[index].SysMemSlicePitch = static_cast<UINT>(numBytes);
+                    ++index;
+                }
+                else if (!j)
+                {
+                    ++skipMip;
+                }
+
+                if (bits + numBytes > end)
+                    return 0;
+
+                bits += numBytes;
+                w = std::max<size_t>(1, w >> 1);
+                h = std::max<size_t>(1, h >> 1);
+            }
+        }
+
+        return index;
+    }
+
+
+    // FillInitData as it is now: one cached layout shared by every item.
+    size_t FillFromLayout(CubeFile const& file, size_t maxsize, D3D11_SUBRESOURCE_DATA* initData, size_t& skipMip)
+    {
+        const uint8_t* bits = file.data.data() + HeaderSize;
+
+        auto layout = GetDDSSubresourceLayout(file.size, file.size, 1, file.mipCount, file.format);
+        if (layout->itemSize > (file.data.size() - HeaderSize) / file.items)
+            return 0;
+
+        skipMip = 0;
+        if (file.mipCount > 1 && maxsize)
+        {
+            while (skipMip < file.mipCount && (layout->mips[skipMip].width > maxsize || layout->mips[skipMip].height > maxsize))
+                ++skipMip;
+        }
+
+        size_t index = 0;
+        for (size_t j = 0; j < file.items; ++j)
+        {
+            const uint8_t* item = bits + j * layout->itemSize;
+            for (size_t i = skipMip; i < file.mipCount; ++i)
+            {
+                auto& mip = layout->mips[i];
+                initData[index].pSysMem = item + mip.offset;
+                initData[index].SysMemPitch = static_cast<UINT>(mip.rowPitch);
+                initData[index].SysMemSlicePitch = static_cast<UINT>(mip.slicePitch);
+                ++index;
+            }
+        }
+
+        return index;
+    }
+
+
+    void CheckLayouts(Bench& bench, CubeFile const& file)
+    {
+        std::vector<D3D11_SUBRESOURCE_DATA> walked(file.mipCount * file.items);
+        std::vector<D3D11_SUBRESOURCE_DATA> filled(walked.size());
+
+        for (size_t maxsize : { size_t(0), file.size / 4 })
+        {
+            size_t walkedSkip = 0, filledSkip = 0;
+            size_t walkedCount = WalkSubresources(file, maxsize, walked.data(), walkedSkip);
+            size_t filledCount = FillFromLayout(file, maxsize, filled.data(), filledSkip);
+
+            bool same = walkedCount == filledCount && walkedSkip == filledSkip && walkedCount > 0;
+            for (size_t j = 0; same && j < walkedCount; ++j)
+            {
+                same = walked[j].pSysMem == filled[j].pSysMem && walked[j].SysMemPitch == filled[j].SysMemPitch
+                    && walked[j].SysMemSlicePitch == filled[j].SysMemSlicePitch;
+            }
+
+            bench.Check(same, "cubemaps: %s with maxsize %zu: the layout table and GetSurfaceInfo walk disagree", file.name, maxsize);
+        }
+
+        auto first = GetDDSSubresourceLayout(file.size, file.size, 1, file.mipCount, file.format);
+        auto second = GetDDSSubresourceLayout(file.size, file.size, 1, file.mipCount, file.format);
+        bench.Check(first == second, "cubemaps: %s layout wasn't cached", file.name);
+    }
+
+
+    void TimeLayouts(Bench& bench, std::vector<CubeFile> const& files)
+    {
+        bench.Section("cubemaps: subresource setup, GetSurfaceInfo walk against the layout table");
+
+        size_t passes = bench.Scaled(20000);
+        size_t subresources = 0;
+        size_t checksum = 0;
+
+        std::vector<D3D11_SUBRESOURCE_DATA> initData;
+        for (auto& file : files)
+            initData.resize(std::max(initData.size(), file.mipCount * file.items));
+
+        Timer timer;
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& file : files)
+            {
+                size_t skip;
+                subresources += WalkSubresources(file, 0, initData.data(), skip);
+                checksum += initData[0].SysMemPitch;
+            }
+        }
+        double walkSeconds = timer.GetSeconds();
+
+        timer.Restart();
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& file : files)
+            {
+                size_t skip;
+                subresources += FillFromLayout(file, 0, initData.data(), skip);
+                checksum += initData[0].SysMemPitch;
+            }
+        }
+        double tableSeconds = timer.GetSeconds();
+
+        bench.Check(checksum != 0, "cubemaps: subresource setup was optimized away");
+
+        double loads = double(passes * files.size());
+        bench.Report("subresources per file", double(subresources) / (2.0 * loads), "");
+        bench.Report("time per file, GetSurfaceInfo walk", walkSeconds * 1e6 / loads, "us");
+        bench.Report("time per file, cached layout table", tableSeconds * 1e6 / loads, "us");
+        bench.Report("layout table speedup", walkSeconds / std::max(tableSeconds, 1e-9), "x");
+    }
+
+
+    // Every subresource must match the file bytes the old walk points it at.
+    bool CheckTexture(Bench& bench, CubeFile const& file, ComPtr<ID3D11Resource> const& resource, size_t maxsize, const char* what)
+    {
+        ComPtr<ID3D11Texture2D> texture;
+        D3D11_TEXTURE2D_DESC desc = {};
+        if (SUCCEEDED(resource.As(&texture)))
+            texture->GetDesc(&desc);
+
+        std::vector<D3D11_SUBRESOURCE_DATA> expected(file.mipCount * file.items);
+        size_t skip = 0;
+        size_t count = WalkSubresources(file, maxsize, expected.data(), skip);
+
+        size_t width = std::max<size_t>(1, file.size >> skip);
+        bool cubeFlag = (desc.MiscFlags & D3D11_RESOURCE_MISC_TEXTURECUBE) != 0;
+
+        if (!bench.Check(desc.Width == width && desc.Height == width && desc.MipLevels == file.mipCount - skip
+                         && desc.ArraySize == file.items && desc.Format == file.format && cubeFlag == file.cube,
+                         "cubemaps: %s %s is %ux%u with %u mips and %u items, expected %zux%zu with %zu and %zu",
+                         file.name, what, desc.Width, desc.Height, desc.MipLevels, desc.ArraySize, width, width, file.mipCount - skip, file.items))
+            return false;
+
+        size_t wrong = 0;
+        std::vector<uint8_t> data;
+        for (size_t j = 0; j < count; ++j)
+        {
+            if (FAILED(ReadSubresource(resource.Get(), UINT(j), data, nullptr))
+                || data.size() != expected[j].SysMemSlicePitch
+                || memcmp(data.data(), expected[j].pSysMem, data.size()) != 0)
+                ++wrong;
+        }
+
+        return bench.Check(wrong == 0, "cubemaps: %s %s has %zu of %zu subresources with the wrong contents", file.name, what, wrong, count);
+    }
+
+
+    void TimeMemoryLoads(Bench& bench, std::vector<CubeFile> const& files, ID3D11Device* device)
+    {
+        bench.Section("cubemaps: CreateDDSTextureFromMemory on the recording device");
+
+        size_t passes = bench.Scaled(10);
+        size_t bytes = 0;
+        size_t loads = 0;
+
+        Timer timer;
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& file : files)
+            {
+                ComPtr<ID3D11Resource> texture;
+                HRESULT hr = CreateDDSTextureFromMemory(device, file.data.data(), file.data.size(), texture.GetAddressOf(), nullptr);
+
+                if (pass == 0 && bench.Check(SUCCEEDED(hr), "cubemaps: %s failed to load (%08X)", file.name, static_cast<unsigned>(hr)))
+                    CheckTexture(bench, file, texture, 0, "from memory");
+
+                bytes += file.data.size();
+                ++loads;
+            }
+        }
+        double seconds = timer.GetSeconds();
+
+        // With maxsize, the top mips are skipped in every face.
+        for (auto& file : files)
+        {
+            ComPtr<ID3D11Resource> texture;
+            HRESULT hr = CreateDDSTextureFromMemoryEx(device, file.data.data(), file.data.size(), file.size / 4,
+                                                      D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, false, texture.GetAddressOf(), nullptr);
+
+            if (bench.Check(SUCCEEDED(hr), "cubemaps: %s failed to load with maxsize (%08X)", file.name, static_cast<unsigned>(hr)))
+                CheckTexture(bench, file, texture, file.size / 4, "with maxsize");
+        }
+
+        bench.Report("files loaded per second", double(loads) / std::max(seconds, 1e-9), "");
+        bench.Report("bytes loaded per second", double(bytes) / std::max(seconds, 1e-9), "bytes");
+    }
+
+
+    std::string GetTempDirectory()
+    {
+        const char* names[] = { "TMPDIR", "TEMP", "TMP" };
+        for (auto var : names)
+        {
+            auto value = getenv(var);
+            if (value && *value)
+                return value;
+        }
+
+        return ".";
+    }
+
+
+    void TimeFileLoads(Bench& bench, std::vector<CubeFile> const& files, ID3D11Device* device)
+    {
+        bench.Section("cubemaps: CreateDDSTextureFromFile, reading in chunks");
+
+        size_t passes = bench.Scaled(5);
+        size_t bytes = 0;
+        size_t loads = 0;
+        double seconds = 0;
+
+        for (auto& file : files)
+        {
+            std::string path = GetTempDirectory() + "/cubemap_bench.dds";
+
+            FILE* stream = fopen(path.c_str(), "wb");
+            bool written = stream && fwrite(file.data.data(), 1, file.data.size(), stream) == file.data.size();
+            if (stream)
+                fclose(stream);
+
+            if (!bench.Check(written, "cubemaps: couldn't write %s", path.c_str()))
+                continue;
+
+            std::wstring fileName(path.begin(), path.end());
+
+            Timer timer;
+            for (size_t pass = 0; pass < passes; ++pass)
+            {
+                ComPtr<ID3D11Resource> texture;
+                HRESULT hr = CreateDDSTextureFromFile(device, fileName.c_str(), texture.GetAddressOf(), nullptr);
+
+                if (pass == 0 && bench.Check(SUCCEEDED(hr), "cubemaps: %s failed to load from a file (%08X)", file.name, static_cast<unsigned>(hr)))
+                {
+                    seconds += timer.GetSeconds();
+                    CheckTexture(bench, file, texture, 0, "from a file");
+                    timer.Restart();
+                }
+
+                bytes += file.data.size();
+                ++loads;
+            }
+            seconds += timer.GetSeconds();
+
+            DeleteFileW(fileName.c_str());
+        }
+
+        bench.Report("files loaded per second", double(loads) / std::max(seconds, 1e-9), "");
+        bench.Report("bytes loaded per second", double(bytes) / std::max(seconds, 1e-9), "bytes");
+    }
+}
+
+
+void BenchTool::DDSCubemapLoading(Bench& bench)
+{
+    std::vector<CubeFile> files;
+    files.push_back(WriteDDS(DXGI_FORMAT_BC1_UNORM, 2048, 1, true, "2048 BC1 cubemap"));
+    files.push_back(WriteDDS(DXGI_FORMAT_R8G8B8A8_UNORM, 1024, 1, true, "1024 RGBA cubemap"));
+    files.push_back(WriteDDS(DXGI_FORMAT_R16G16B16A16_FLOAT, 256, 8, true, "8 x 256 RGBA16F cubemap array"));
+    files.push_back(WriteDDS(DXGI_FORMAT_BC1_UNORM, 512, 64, false, "64 x 512 BC1 texture array"));
+
+    bench.Section("cubemaps: layout table against the GetSurfaceInfo walk");
+    for (auto& file : files)
+        CheckLayouts(bench, file);
+
+    ComPtr<ID3D11Device> device;
+    ComPtr<ID3D11DeviceContext> context;
+    ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+    TimeLayouts(bench, files);
+    TimeMemoryLoads(bench, files, device.Get());
+    TimeFileLoads(bench, files, device.Get());
+}
@@ -0,0 +1,466 @@
+//--------------------------------------------------------------------------------------
+// File: DdsBench.cpp
+//
+// DDS header validation over a batch of small files covering every format DDSTextureLoader
+// accepts: legacy channel masks, FourCC codes and every "DX10" format, with cubemaps,
+// arrays and volumes among them. It times the format and layout lookups that header
+// parsing is made of (LoaderHelpers.h), whole loads through CreateDDSTextureFromMemory,
+// and the rejection of damaged headers, and checks each file resolves to the format and
+// size it was written with.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "DDSTextureLoader.h"
+#include "PlatformHelpers.h"
+#include "LoaderHelpers.h"
+
+using namespace BenchTool;
+using namespace DirectX;
+using namespace DirectX::LoaderHelpers;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    const size_t TextureSize = 32;
+
+    struct DDSFile
+    {
+        std::vector<uint8_t> data;
+        DXGI_FORMAT format;             // What the header should resolve to
+        D3D11_RESOURCE_DIMENSION dimension;
+        size_t depth;
+        size_t mipCount;
+        size_t arraySize;               // Six per cube
+        bool dx10;
+        const char* kind;
+    };
+
+
+    size_t MipCount(size_t size)
+    {
+        size_t count = 1;
+        while (size > 1)
+        {
+            size >>= 1;
+            ++count;
+        }
+        return count;
+    }
+
+
+    // Writes the headers, and a payload whose bytes are their own offsets so loads can be checked.
+    DDSFile WriteDDS(DXGI_FORMAT format, DDS_PIXELFORMAT const* legacyFormat, D3D11_RESOURCE_DIMENSION dimension, size_t depth, size_t arraySize, bool cube, const char* kind)
+    {
+        DDSFile file = {};
+        file.format = format;
+        file.dimension = dimension;
+        file.depth = depth;
+        auto layout = GetFormatInfo(format).layout;
+        file.mipCount = (layout == FORMAT_PLANAR || layout == FORMAT_NV11) ? 1 : MipCount(std::max(TextureSize, depth));
+        file.arraySize = arraySize * (cube ? 6 : 1);
+        file.dx10 = (legacyFormat == nullptr);
+        file.kind = kind;
+
+        DDS_HEADER header = {};
+        header.size = sizeof(DDS_HEADER);
+        header.flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
+        header.width = TextureSize;
+        header.height = (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE1D) ? 1 : TextureSize;
+        header.depth = static_cast<uint32_t>(depth);
+        header.mipMapCount = static_cast<uint32_t>(file.mipCount);
+        header.caps = DDS_SURFACE_FLAGS_TEXTURE | DDS_SURFACE_FLAGS_MIPMAP;
+
+        if (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE3D)
+        {
+            header.flags |= DDS_HEADER_FLAGS_VOLUME;
+            header.caps2 = DDS_FLAGS_VOLUME;
+        }
+
+        if (cube)
+        {
+            header.caps |= DDS_SURFACE_FLAGS_CUBEMAP;
+            header.caps2 = DDS_CUBEMAP | DDS_CUBEMAP_ALLFACES;
+        }
+
+        DDS_HEADER_DXT10 extension = {};
+
+        if (legacyFormat)
+        {
+            header.ddspf = *legacyFormat;
+        }
+        else
+        {
+            header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+            header.ddspf.flags = DDS_FOURCC;
+            header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+
+            extension.dxgiFormat = format;
+            extension.resourceDimension = dimension;
+            extension.miscFlag = cube ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+            extension.arraySize = static_cast<uint32_t>(arraySize);
+        }
+
+        size_t headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER) + (legacyFormat ? 0 : sizeof(DDS_HEADER_DXT10));
+
+        size_t itemSize = 0;
+        for (size_t level = 0; level < file.mipCount; ++level)
+        {
+            size_t numBytes, rowBytes;
+            GetSurfaceInfo(std::max<size_t>(1, header.width >> level), std::max<size_t>(1, header.height >> level), format, &numBytes, &rowBytes, nullptr);
+            itemSize += numBytes * std::max<size_t>(1, depth >> level);
+        }
+
+        file.data.resize(headerSize + itemSize * file.arraySize);
+
+        memcpy(file.data.data(), &DDS_MAGIC, sizeof(uint32_t));
+        memcpy(file.data.data() + sizeof(uint32_t), &header, sizeof(header));
+        if (!legacyFormat)
+            memcpy(file.data.data() + sizeof(uint32_t) + sizeof(header), &extension, sizeof(extension));
+
+        for (size_t i = headerSize; i < file.data.size(); ++i)
+            file.data[i] = static_cast<uint8_t>(i * 7);
+
+        return file;
+    }
+
+
+    std::vector<DDSFile> MakeBatch()
+    {
+        std::vector<DDSFile> files;
+
+        // Legacy headers with channel masks.
+        for (auto& entry : s_maskedFormats)
+        {
+            DDS_PIXELFORMAT pf = { sizeof(DDS_PIXELFORMAT), entry.flags, 0, entry.RGBBitCount, entry.RBitMask, entry.GBitMask, entry.BBitMask, entry.ABitMask };
+            files.push_back(WriteDDS(entry.format, &pf, D3D11_RESOURCE_DIMENSION_TEXTURE2D, 1, 1, false, "legacy mask"));
+        }
+
+        {
+            DDS_PIXELFORMAT pf = { sizeof(DDS_PIXELFORMAT), DDS_ALPHA, 0, 8, 0, 0, 0, 0xff };
+            files.push_back(WriteDDS(DXGI_FORMAT_A8_UNORM, &pf, D3D11_RESOURCE_DIMENSION_TEXTURE2D, 1, 1, false, "legacy mask"));
+        }
+
+        // Legacy FourCC codes, including a cubemap and a volume.
+        const struct
+        {
+            uint32_t fourCC;
+            DXGI_FORMAT format;
+        } fourCCs[] =
+        {
+            { MAKEFOURCC('D', 'X', 'T', '1'), DXGI_FORMAT_BC1_UNORM },
+            { MAKEFOURCC('D', 'X', 'T', '2'), DXGI_FORMAT_BC2_UNORM },
+            { MAKEFOURCC('D', 'X', 'T', '3'), DXGI_FORMAT_BC2_UNORM },
+            { MAKEFOURCC('D', 'X', 'T', '4'), DXGI_FORMAT_BC3_UNORM },
+            { MAKEFOURCC('D', 'X', 'T', '5'), DXGI_FORMAT_BC3_UNORM },
+            { MAKEFOURCC('A', 'T', 'I', '1'), DXGI_FORMAT_BC4_UNORM },
+            { MAKEFOURCC('B', 'C', '4', 'U'), DXGI_FORMAT_BC4_UNORM },
+            { MAKEFOURCC('B', 'C', '4', 'S'), DXGI_FORMAT_BC4_SNORM },
+            { MAKEFOURCC('A', 'T', 'I', '2'), DXGI_FORMAT_BC5_UNORM },
+            { MAKEFOURCC('B', 'C', '5', 'U'), DXGI_FORMAT_BC5_UNORM },
+            { MAKEFOURCC('B', 'C', '5', 'S'), DXGI_FORMAT_BC5_SNORM },
+            { MAKEFOURCC('R', 'G', 'B', 'G'), DXGI_FORMAT_R8G8_B8G8_UNORM },
+            { MAKEFOURCC('G', 'R', 'G', 'B'), DXGI_FORMAT_G8R8_G8B8_UNORM },
+            { MAKEFOURCC('Y', 'U', 'Y', '2'), DXGI_FORMAT_YUY2 },
+            { 36,  DXGI_FORMAT_R16G16B16A16_UNORM },
+            { 110, DXGI_FORMAT_R16G16B16A16_SNORM },
+            { 111, DXGI_FORMAT_R16_FLOAT },
+            { 112, DXGI_FORMAT_R16G16_FLOAT },
+            { 113, DXGI_FORMAT_R16G16B16A16_FLOAT },
+            { 114, DXGI_FORMAT_R32_FLOAT },
+            { 115, DXGI_FORMAT_R32G32_FLOAT },
+            { 116, DXGI_FORMAT_R32G32B32A32_FLOAT },
+        };
+
+        for (auto& entry : fourCCs)
+        {
+            DDS_PIXELFORMAT pf = { sizeof(DDS_PIXELFORMAT), DDS_FOURCC, entry.fourCC, 0, 0, 0, 0, 0 };
+            files.push_back(WriteDDS(entry.format, &pf, D3D11_RESOURCE_DIMENSION_TEXTURE2D, 1, 1, false, "legacy FourCC"));
+        }
+
+        {
+            DDS_PIXELFORMAT pf = { sizeof(DDS_PIXELFORMAT), DDS_FOURCC, MAKEFOURCC('D', 'X', 'T', '5'), 0, 0, 0, 0, 0 };
+            files.push_back(WriteDDS(DXGI_FORMAT_BC3_UNORM, &pf, D3D11_RESOURCE_DIMENSION_TEXTURE2D, 1, 1, true, "legacy cubemap"));
+
+            DDS_PIXELFORMAT rgba = { sizeof(DDS_PIXELFORMAT), DDS_RGBA, 0, 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000 };
+            files.push_back(WriteDDS(DXGI_FORMAT_R8G8B8A8_UNORM, &rgba, D3D11_RESOURCE_DIMENSION_TEXTURE3D, 8, 1, false, "legacy volume"));
+        }
+
+        // Every format the "DX10" header can name; block and linear formats also as arrays and cubes.
+        for (size_t i = 1; i < c_formatInfoCount; ++i)
+        {
+            auto format = static_cast<DXGI_FORMAT>(i);
+            auto& info = GetFormatInfo(format);
+
+            if (!info.bitsPerPixel)
+                continue;
+
+            switch (format)
+            {
+            case DXGI_FORMAT_AI44:
+            case DXGI_FORMAT_IA44:
+            case DXGI_FORMAT_P8:
+            case DXGI_FORMAT_A8P8:
+                continue;
+
+            default:
+                break;
+            }
+
+            files.push_back(WriteDDS(format, nullptr, D3D11_RESOURCE_DIMENSION_TEXTURE2D, 1, 1, false, "DX10 2D"));
+
+            if (info.layout == FORMAT_LINEAR || info.layout == FORMAT_BLOCK)
+            {
+                switch (i % 4)
+                {
+                case 0: files.push_back(WriteDDS(format, nullptr, D3D11_RESOURCE_DIMENSION_TEXTURE2D, 1, 3, false, "DX10 array")); break;
+                case 1: files.push_back(WriteDDS(format, nullptr, D3D11_RESOURCE_DIMENSION_TEXTURE2D, 1, 1, true, "DX10 cubemap")); break;
+                case 2: files.push_back(WriteDDS(format, nullptr, D3D11_RESOURCE_DIMENSION_TEXTURE1D, 1, 2, false, "DX10 1D array")); break;
+                default:
+                    if (info.layout == FORMAT_LINEAR)
+                        files.push_back(WriteDDS(format, nullptr, D3D11_RESOURCE_DIMENSION_TEXTURE3D, 4, 1, false, "DX10 volume"));
+                    break;
+                }
+            }
+        }
+
+        return files;
+    }
+
+
+    // The header checks and lookups DDSTextureLoader makes before creating anything.
+    HRESULT ParseHeader(DDSFile const& file, std::vector<DDSSubresourceRange>& ranges, _Out_ DXGI_FORMAT* format)
+    {
+        *format = DXGI_FORMAT_UNKNOWN;
+
+        auto data = file.data.data();
+        size_t size = file.data.size();
+
+        if (size < sizeof(uint32_t) + sizeof(DDS_HEADER) || *reinterpret_cast<const uint32_t*>(data) != DDS_MAGIC)
+            return E_FAIL;
+
+        auto header = reinterpret_cast<const DDS_HEADER*>(data + sizeof(uint32_t));
+        if (header->size != sizeof(DDS_HEADER) || header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+            return E_FAIL;
+
+        size_t offset = sizeof(uint32_t) + sizeof(DDS_HEADER);
+        size_t arraySize = 1;
+        size_t height = header->height;
+        size_t depth = (header->flags & DDS_HEADER_FLAGS_VOLUME) ? header->depth : 1;
+
+        if ((header->ddspf.flags & DDS_FOURCC) && header->ddspf.fourCC == MAKEFOURCC('D', 'X', '1', '0'))
+        {
+            auto extension = reinterpret_cast<const DDS_HEADER_DXT10*>(data + offset);
+            offset += sizeof(DDS_HEADER_DXT10);
+
+            if (!extension->arraySize || !BitsPerPixel(extension->dxgiFormat))
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            *format = extension->dxgiFormat;
+            arraySize = extension->arraySize * ((extension->miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE) ? 6 : 1);
+
+            if (extension->resourceDimension == D3D11_RESOURCE_DIMENSION_TEXTURE1D)
+                height = 1;
+        }
+        else
+        {
+            *format = GetDXGIFormat(header->ddspf);
+            if (*format == DXGI_FORMAT_UNKNOWN)
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            if (header->caps2 & DDS_CUBEMAP)
+                arraySize = 6;
+        }
+
+        return GetDDSSubresourceRanges(offset, header->width, height, depth, std::max<size_t>(1, header->mipMapCount), arraySize, *format, size, ranges);
+    }
+
+
+    //----------------------------------------------------------------------------------
+    void ParseBatch(Bench& bench, std::vector<DDSFile> const& files)
+    {
+        bench.Section("dds: header parsing and subresource layout with LoaderHelpers");
+
+        std::vector<DDSSubresourceRange> ranges;
+        size_t passes = bench.Scaled(2000);
+        size_t failures = 0;
+
+        Timer timer;
+
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& file : files)
+            {
+                DXGI_FORMAT format;
+                HRESULT hr = ParseHeader(file, ranges, &format);
+
+                if (pass == 0)
+                {
+                    bool valid = SUCCEEDED(hr) && format == file.format
+                        && ranges.size() == file.mipCount * file.arraySize
+                        && ranges.back().offset + ranges.back().size == file.data.size();
+
+                    if (!bench.Check(valid, "dds: %s header for format %d parsed to format %d (hr %08X)", file.kind, file.format, format, static_cast<unsigned>(hr)))
+                        failures++;
+                }
+            }
+        }
+
+        double seconds = timer.GetSeconds();
+
+        bench.Report("files in the batch", double(files.size()), "");
+        bench.Report("headers parsed per second", double(files.size() * passes) / std::max(seconds, 1e-9), "");
+        bench.Report("time per header", seconds * 1e9 / double(files.size() * passes), "ns");
+
+        // The format metadata on its own, as GetSurfaceInfo asks for it once per mip level.
+        size_t lookups = 0;
+        size_t checksum = 0;
+        timer.Restart();
+
+        for (size_t pass = 0; pass < passes * 16; ++pass)
+        {
+            for (size_t i = 0; i < c_formatInfoCount; ++i)
+            {
+                auto format = static_cast<DXGI_FORMAT>((i * 37 + pass) % c_formatInfoCount);
+                checksum += BitsPerPixel(format) + IsCompressed(format) + MakeSRGB(format) + EnsureNotTypeless(format);
+                lookups++;
+            }
+        }
+
+        seconds = timer.GetSeconds();
+
+        bench.Check(checksum != 0, "dds: format lookups were optimized away");
+        bench.Report("format metadata lookups per second", double(lookups) / std::max(seconds, 1e-9), "");
+    }
+
+
+    void LoadBatch(Bench& bench, std::vector<DDSFile> const& files)
+    {
+        bench.Section("dds: CreateDDSTextureFromMemory on the recording device");
+
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+        size_t passes = bench.Scaled(100);
+        size_t bytes = 0;
+
+        Timer timer;
+
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& file : files)
+            {
+                ComPtr<ID3D11Resource> texture;
+                ComPtr<ID3D11ShaderResourceView> view;
+
+                HRESULT hr = CreateDDSTextureFromMemory(device.Get(), file.data.data(), file.data.size(), texture.GetAddressOf(), view.GetAddressOf());
+                bytes += file.data.size();
+
+                if (pass != 0)
+                    continue;
+
+                if (!bench.Check(SUCCEEDED(hr), "dds: %s file with format %d failed to load (hr %08X)", file.kind, file.format, static_cast<unsigned>(hr)))
+                    continue;
+
+                D3D11_SHADER_RESOURCE_VIEW_DESC desc;
+                view->GetDesc(&desc);
+                bench.Check(desc.Format == file.format, "dds: %s file with format %d loaded as format %d", file.kind, file.format, desc.Format);
+
+                // The last subresource ends the file, so it shows the whole payload was placed correctly.
+                std::vector<uint8_t> contents;
+                UINT last = static_cast<UINT>(file.mipCount * file.arraySize - 1);
+                if (SUCCEEDED(ReadSubresource(texture.Get(), last, contents, nullptr)) && !contents.empty())
+                {
+                    bench.Check(memcmp(contents.data(), file.data.data() + file.data.size() - contents.size(), contents.size()) == 0,
+                                "dds: %s file with format %d has the wrong contents in its last subresource", file.kind, file.format);
+                }
+            }
+        }
+
+        double seconds = timer.GetSeconds();
+
+        bench.Report("textures loaded per second", double(files.size() * passes) / std::max(seconds, 1e-9), "");
+        bench.Report("bytes loaded per second", double(bytes) / std::max(seconds, 1e-9), "bytes");
+    }
+
+
+    void RejectBatch(Bench& bench, std::vector<DDSFile> const& files)
+    {
+        bench.Section("dds: rejecting damaged headers");
+
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+        // Each kind of damage is applied to every file in the batch.
+        const struct
+        {
+            const char* name;
+            void (*damage)(std::vector<uint8_t>& data);
+        } damages[] =
+        {
+            { "bad magic",          [](std::vector<uint8_t>& data) { data[0] = 'X'; } },
+            { "bad header size",    [](std::vector<uint8_t>& data) { data[sizeof(uint32_t)] = 0; } },
+            { "truncated",          [](std::vector<uint8_t>& data) { data.resize(data.size() - 1); } },
+            { "too many mips",      [](std::vector<uint8_t>& data) { uint32_t mips = 20; memcpy(&data[sizeof(uint32_t) + offsetof(DDS_HEADER, mipMapCount)], &mips, sizeof(mips)); } },
+            { "unknown format",     [](std::vector<uint8_t>& data) { uint32_t zero = 0; memcpy(&data[sizeof(uint32_t) + offsetof(DDS_HEADER, ddspf) + offsetof(DDS_PIXELFORMAT, flags)], &zero, sizeof(zero)); } },
+            { "oversized",          [](std::vector<uint8_t>& data) { uint32_t huge = 65536; memcpy(&data[sizeof(uint32_t) + offsetof(DDS_HEADER, width)], &huge, sizeof(huge)); } },
+        };
+
+        std::vector<std::vector<uint8_t>> damaged;
+        for (auto& damage : damages)
+        {
+            for (auto& file : files)
+            {
+                damaged.push_back(file.data);
+                damage.damage(damaged.back());
+            }
+        }
+
+        size_t passes = bench.Scaled(200);
+        size_t accepted = 0;
+
+        Timer timer;
+
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (auto& data : damaged)
+            {
+                ComPtr<ID3D11Resource> texture;
+                if (SUCCEEDED(CreateDDSTextureFromMemory(device.Get(), data.data(), data.size(), texture.GetAddressOf(), nullptr)))
+                    accepted++;
+            }
+        }
+
+        double seconds = timer.GetSeconds();
+
+        bench.Check(accepted == 0, "dds: %zu damaged files were loaded", accepted / passes);
+        bench.Check(GetRecordingDevice(device.Get())->GetCounters().textures == 0, "dds: damaged files created textures");
+
+        bench.Report("damaged headers rejected per second", double(damaged.size() * passes) / std::max(seconds, 1e-9), "");
+        bench.Report("time per rejection", seconds * 1e9 / double(damaged.size() * passes), "ns");
+    }
+}
+
+
+void BenchTool::DDSHeaderValidation(Bench& bench)
+{
+    auto files = MakeBatch();
+
+    ParseBatch(bench, files);
+    LoadBatch(bench, files);
+    RejectBatch(bench, files);
+}
@@ -0,0 +1,302 @@
+//--------------------------------------------------------------------------------------
+// File: MipBench.cpp
+//
+// Mip chain suite: MipGenerator.h on a 4096x4096 image (smaller with -scale below 1),
+// reporting the time per full chain for the box and Kaiser filters, in linear and sRGB
+// space, on one thread and on all of them. It checks the box filter against a reference
+// computed independently in double precision (on odd sizes too), that sRGB data is
+// averaged in linear space, that flat images stay flat through every level with either
+// filter, that alpha weighting keeps transparent colors from bleeding, and that the
+// threaded chain is identical to the single-threaded one.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+
+#include "MipGenerator.h"
+
+#include <thread>
+
+using namespace BenchTool;
+using namespace DirectX;
+using namespace DirectX::MipGeneration;
+
+
+namespace
+{
+    std::vector<uint8_t> MakeImage(size_t width, size_t height, uint32_t seed)
+    {
+        std::vector<uint8_t> image(width * height * 4);
+
+        Random random(seed);
+        std::uniform_int_distribution<int> noise(0, 255);
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                uint8_t* texel = &image[(y * width + x) * 4];
+                texel[0] = uint8_t((x * 255) / std::max<size_t>(1, width - 1));
+                texel[1] = uint8_t(((x / 16 + y / 16) & 1) ? 230 : 20);
+                texel[2] = uint8_t(noise(random));
+                texel[3] = uint8_t(255 - (y * 255) / std::max<size_t>(1, height - 1));
+            }
+        }
+
+        return image;
+    }
+
+
+    size_t MaxDifference(std::vector<uint8_t> const& a, std::vector<uint8_t> const& b)
+    {
+        if (a.size() != b.size())
+            return 256;
+
+        size_t result = 0;
+        for (size_t j = 0; j < a.size(); ++j)
+            result = std::max<size_t>(result, size_t(abs(int(a[j]) - int(b[j]))));
+        return result;
+    }
+
+
+    // The first level of a linear, unweighted box filter: each destination texel averages the
+    // source area it covers, weighting partly covered texels by the fraction covered.
+    std::vector<uint8_t> ReferenceBox(std::vector<uint8_t> const& image, size_t width, size_t height)
+    {
+        size_t dstWidth = std::max<size_t>(1, width / 2);
+        size_t dstHeight = std::max<size_t>(1, height / 2);
+        double sx = double(width) / double(dstWidth);
+        double sy = double(height) / double(dstHeight);
+
+        std::vector<uint8_t> result(dstWidth * dstHeight * 4);
+
+        for (size_t j = 0; j < dstHeight; ++j)
+        {
+            for (size_t i = 0; i < dstWidth; ++i)
+            {
+                double sum[4] = {};
+                double total = 0.0;
+
+                for (size_t y = 0; y < height; ++y)
+                {
+                    double wy = std::min(double(j + 1) * sy, double(y + 1)) - std::max(double(j) * sy, double(y));
+                    if (wy <= 0.0)
+                        continue;
+
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        double wx = std::min(double(i + 1) * sx, double(x + 1)) - std::max(double(i) * sx, double(x));
+                        if (wx <= 0.0)
+                            continue;
+
+                        for (size_t c = 0; c < 4; ++c)
+                            sum[c] += wx * wy * double(image[(y * width + x) * 4 + c]);
+                        total += wx * wy;
+                    }
+                }
+
+                for (size_t c = 0; c < 4; ++c)
+                    result[(j * dstWidth + i) * 4 + c] = uint8_t(sum[c] / total + 0.5);
+            }
+        }
+
+        return result;
+    }
+
+
+    void CheckBoxFilter(Bench& bench)
+    {
+        const size_t sizes[][2] = { { 64, 32 }, { 37, 23 }, { 5, 3 }, { 1, 9 } };
+
+        for (auto size : sizes)
+        {
+            auto image = MakeImage(size[0], size[1], uint32_t(size[0] * 100 + size[1]));
+
+            std::vector<MipLevel> mips;
+            GenerateMipChain(image.data(), size[0], size[1], size[0] * 4, 2, MIP_DEFAULT, mips, 1);
+
+            auto reference = ReferenceBox(image, size[0], size[1]);
+            size_t difference = MaxDifference(mips[1].pixels, reference);
+
+            bench.Check(difference <= 1, "mips: %zux%zu box filter is %zu away from the reference", size[0], size[1], difference);
+        }
+    }
+
+
+    // Black and white averaged in linear space is 0.5, which is sRGB code 188 rather than 128.
+    // The Kaiser filter clamps at the edges, so its border texels are left out.
+    void CheckLinearSpace(Bench& bench)
+    {
+        const size_t size = 64;
+
+        std::vector<uint8_t> checker(size * size * 4);
+        for (size_t j = 0; j < size * size; ++j)
+        {
+            uint8_t value = (((j % size) + (j / size)) & 1) ? 255 : 0;
+            checker[j * 4 + 0] = checker[j * 4 + 1] = checker[j * 4 + 2] = value;
+            checker[j * 4 + 3] = 255;
+        }
+
+        const struct { unsigned flags; uint8_t expected; } cases[] =
+        {
+            { MIP_DEFAULT,              128 },
+            { MIP_SRGB,                 188 },
+            { MIP_SRGB | MIP_KAISER,    188 },
+        };
+
+        for (auto& test : cases)
+        {
+            std::vector<MipLevel> mips;
+            GenerateMipChain(checker.data(), size, size, size * 4, 2, test.flags, mips, 1);
+
+            auto& mip = mips[1];
+            size_t border = (test.flags & MIP_KAISER) ? 3 : 0;
+            size_t wrong = 0;
+
+            for (size_t y = border; y < mip.height - border; ++y)
+            {
+                for (size_t x = border; x < mip.width - border; ++x)
+                {
+                    const uint8_t* texel = &mip.pixels[(y * mip.width + x) * 4];
+                    for (size_t c = 0; c < 3; ++c)
+                    {
+                        if (abs(int(texel[c]) - int(test.expected)) > 1)
+                            ++wrong;
+                    }
+                }
+            }
+
+            bench.Check(wrong == 0, "mips: a black and white checker with flags %u didn't average to %u (%zu values off)",
+                        test.flags, test.expected, wrong);
+        }
+    }
+
+
+    // A flat image must come through every level of the chain unchanged, with the right sizes.
+    void CheckFlatChains(Bench& bench)
+    {
+        const size_t width = 37;
+        const size_t height = 100;
+        const uint8_t color[4] = { 200, 100, 50, 160 };
+
+        std::vector<uint8_t> image(width * height * 4);
+        for (size_t j = 0; j < width * height; ++j)
+            memcpy(&image[j * 4], color, 4);
+
+        for (unsigned flags : { unsigned(MIP_DEFAULT), unsigned(MIP_SRGB), unsigned(MIP_KAISER), unsigned(MIP_SRGB | MIP_KAISER | MIP_ALPHA_WEIGHTED) })
+        {
+            std::vector<MipLevel> mips;
+            GenerateMipChain(image.data(), width, height, width * 4, 0, flags, mips, 1);
+
+            bool sized = mips.size() == CountMips(width, height) && mips.back().width == 1 && mips.back().height == 1;
+            size_t changed = 0;
+
+            for (size_t level = 0; level < mips.size(); ++level)
+            {
+                auto& mip = mips[level];
+                sized = sized && mip.width == std::max<size_t>(1, width >> level) && mip.height == std::max<size_t>(1, height >> level)
+                              && mip.pixels.size() == mip.width * mip.height * 4;
+
+                for (size_t j = 0; j < mip.pixels.size(); ++j)
+                {
+                    if (mip.pixels[j] != color[j & 3])
+                        ++changed;
+                }
+            }
+
+            bench.Check(sized, "mips: the chain for a %zux%zu image with flags %u has the wrong levels", width, height, flags);
+            bench.Check(changed == 0, "mips: %zu bytes of a flat image changed through the chain with flags %u", changed, flags);
+        }
+    }
+
+
+    // One opaque green texel among three transparent red ones: weighted by alpha, no red shows.
+    void CheckAlphaWeighting(Bench& bench)
+    {
+        const uint8_t image[16] =
+        {
+            255, 0, 0, 0,       0, 255, 0, 255,
+            255, 0, 0, 0,       255, 0, 0, 0,
+        };
+
+        std::vector<MipLevel> mips;
+        GenerateMipChain(image, 2, 2, 8, 0, MIP_ALPHA_WEIGHTED, mips, 1);
+
+        auto& texel = mips[1].pixels;
+        bench.Check(texel[0] == 0 && texel[1] == 255 && texel[2] == 0 && texel[3] == 64,
+                    "mips: alpha-weighted 2x2 gave (%u, %u, %u, %u), expected (0, 255, 0, 64)", texel[0], texel[1], texel[2], texel[3]);
+
+        GenerateMipChain(image, 2, 2, 8, 0, MIP_DEFAULT, mips, 1);
+        bench.Check(mips[1].pixels[0] > 128, "mips: without alpha weighting the transparent red should show");
+    }
+
+
+    void TimeChains(Bench& bench, unsigned threadCount)
+    {
+        // 4096 at -scale 1, rounded down to a power of two for smaller scales.
+        size_t size = 64;
+        while (size * 2 <= std::min<size_t>(4096, bench.Scaled(4096)))
+            size *= 2;
+
+        auto image = MakeImage(size, size, 33);
+
+        const struct { unsigned flags; const char* name; } filters[] =
+        {
+            { MIP_DEFAULT,              "box" },
+            { MIP_SRGB,                 "box, sRGB" },
+            { MIP_SRGB | MIP_KAISER,    "Kaiser, sRGB" },
+        };
+
+        for (auto& filter : filters)
+        {
+            char section[128];
+            snprintf(section, sizeof(section), "mips: %zux%zu chain, %s", size, size, filter.name);
+            bench.Section(section);
+
+            std::vector<MipLevel> single;
+            Timer timer;
+            GenerateMipChain(image.data(), size, size, size * 4, 0, filter.flags, single, 1);
+            double singleSeconds = timer.GetSeconds();
+
+            std::vector<MipLevel> threaded;
+            timer.Restart();
+            GenerateMipChain(image.data(), size, size, size * 4, 0, filter.flags, threaded, threadCount);
+            double threadedSeconds = timer.GetSeconds();
+
+            bool same = single.size() == threaded.size();
+            for (size_t level = 0; same && level < single.size(); ++level)
+                same = single[level].pixels == threaded[level].pixels;
+
+            bench.Check(same, "mips: the %s chain built on %u threads differs from the single-threaded one", filter.name, threadCount);
+
+            char name[64];
+            bench.Report("time per chain, 1 thread", singleSeconds * 1000.0, "ms");
+            snprintf(name, sizeof(name), "time per chain, %u threads", threadCount);
+            bench.Report(name, threadedSeconds * 1000.0, "ms");
+            bench.Report("source megapixels per second, 1 thread", double(size * size) / 1e6 / std::max(singleSeconds, 1e-9), "");
+        }
+    }
+}
+
+
+void BenchTool::MipChainGeneration(Bench& bench)
+{
+    unsigned threadCount = bench.GetThreadCount() ? bench.GetThreadCount() : std::max(2u, std::thread::hardware_concurrency());
+
+    bench.Section("mips: box reference, linear-space averaging, flat chains and alpha weighting");
+    CheckBoxFilter(bench);
+    CheckLinearSpace(bench);
+    CheckFlatChains(bench);
+    CheckAlphaWeighting(bench);
+
+    TimeChains(bench, threadCount);
+}
@@ -0,0 +1,315 @@
+//--------------------------------------------------------------------------------------
+// File: RecorderBench.cpp
+//
+// Sprite recorder suite: SpriteBatch::Recorder on 1, 2, 4 ... N threads, splitting the same
+// sprites between them, against drawing them all on one thread with SpriteBatch::Draw. It
+// reports recording throughput at each thread count, the time End spends merging the
+// recorders' queues (End with recorders against End with the same sprites drawn directly),
+// and checks the merged draw order: in SpriteSortMode_Deferred the batch's own sprites,
+// then each recorder's in the order the recorders were created; sorted by texture, that
+// order within each texture.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "PlatformHelpers.h"
+#include "SpriteBatch.h"
+#include "VertexTypes.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace BenchTool;
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    struct RecorderTarget
+    {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        std::unique_ptr<SpriteBatch> batch;
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textures;
+
+        explicit RecorderTarget(size_t textureCount)
+        {
+            ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+            batch = std::make_unique<SpriteBatch>(context.Get());
+
+            D3D11_TEXTURE2D_DESC desc = {};
+            desc.Width = desc.Height = 64;
+            desc.MipLevels = desc.ArraySize = 1;
+            desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            desc.SampleDesc.Count = 1;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+            for (size_t i = 0; i < textureCount; ++i)
+            {
+                ComPtr<ID3D11Texture2D> texture;
+                ComPtr<ID3D11ShaderResourceView> view;
+                ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf()));
+                ThrowIfFailed(device->CreateShaderResourceView(texture.Get(), nullptr, view.GetAddressOf()));
+                textures.push_back(view);
+            }
+        }
+
+        RecordingContext* GetRecording() const { return GetRecordingContext(context.Get()); }
+    };
+
+
+    // Each sprite's red channel holds its index, so the draw order can be read back from the vertices.
+    struct Sprite
+    {
+        XMFLOAT2 position;
+        RECT source;
+        float rotation;
+        size_t texture;
+    };
+
+    std::vector<Sprite> MakeSprites(size_t count, size_t textureCount, uint32_t seed)
+    {
+        std::vector<Sprite> sprites(count);
+
+        Random random(seed);
+
+        for (auto& sprite : sprites)
+        {
+            LONG cell = LONG(RandomIndex(random, 16));
+
+            sprite.position = XMFLOAT2(RandomFloat(random, 0, 1920.f), RandomFloat(random, 0, 1080.f));
+            sprite.source = { (cell % 4) * 16, (cell / 4) * 16, (cell % 4) * 16 + 16, (cell / 4) * 16 + 16 };
+            sprite.rotation = RandomFloat(random, 0, XM_2PI);
+            sprite.texture = RandomIndex(random, textureCount);
+        }
+
+        return sprites;
+    }
+
+    template<typename TTarget>
+    void DrawSprite(TTarget& target, RecorderTarget const& owner, std::vector<Sprite> const& sprites, size_t index)
+    {
+        auto& sprite = sprites[index];
+        target.Draw(owner.textures[sprite.texture].Get(), sprite.position, &sprite.source, XMVectorSet(float(index), 1.f, 1.f, 1.f),
+                    sprite.rotation, XMFLOAT2(8, 8), 1.f);
+    }
+
+
+    // Records sprites [begin, end) split evenly between the recorders, one thread each.
+    double Record(RecorderTarget const& target, std::vector<SpriteBatch::Recorder>& recorders, std::vector<Sprite> const& sprites, size_t begin, size_t end)
+    {
+        size_t threadCount = recorders.size();
+        size_t perThread = (end - begin + threadCount - 1) / threadCount;
+
+        std::atomic<size_t> ready(0);
+        std::atomic<bool> start(false);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&, i]
+            {
+                size_t first = std::min(end, begin + i * perThread);
+                size_t last = std::min(end, first + perThread);
+
+                ++ready;
+                while (!start)
+                    std::this_thread::yield();
+
+                for (size_t j = first; j < last; ++j)
+                    DrawSprite(recorders[i], target, sprites, j);
+            });
+        }
+
+        while (ready < threadCount)
+            std::this_thread::yield();
+
+        Timer timer;
+        start = true;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        return timer.GetSeconds();
+    }
+
+
+    // The sprite indices in the order End drew them.
+    std::vector<size_t> ReadDrawOrder(std::vector<uint8_t> const& vertices)
+    {
+        const size_t spriteBytes = 4 * sizeof(VertexPositionColorTexture);
+
+        std::vector<size_t> order(vertices.size() / spriteBytes);
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            VertexPositionColorTexture vertex;
+            memcpy(&vertex, &vertices[i * spriteBytes], sizeof(vertex));
+            order[i] = size_t(vertex.color.x);
+        }
+
+        return order;
+    }
+
+
+    // A fifth of the sprites drawn on the batch itself, the rest split between recorders, in
+    // both modes that keep draw order; twice, so recorders left dirty by a merge would show.
+    void CheckMergeOrder(Bench& bench, unsigned threadCount)
+    {
+        RecorderTarget target(8);
+        auto recording = target.GetRecording();
+
+        // Enough to take the parallel merge where there is more than one core.
+        auto sprites = MakeSprites(std::max<size_t>(20000, bench.Scaled(40000)), target.textures.size(), 43);
+        size_t own = sprites.size() / 5;
+
+        std::vector<ID3D11ShaderResourceView*> byPointer;
+        for (auto& view : target.textures)
+            byPointer.push_back(view.Get());
+        std::sort(byPointer.begin(), byPointer.end());
+
+        std::vector<size_t> textureOrder(sprites.size());
+        for (size_t i = 0; i < sprites.size(); ++i)
+            textureOrder[i] = size_t(std::find(byPointer.begin(), byPointer.end(), target.textures[sprites[i].texture].Get()) - byPointer.begin());
+
+        std::vector<SpriteBatch::Recorder> recorders;
+        for (unsigned i = 0; i < threadCount; ++i)
+            recorders.emplace_back(*target.batch);
+
+        for (auto mode : { SpriteSortMode_Deferred, SpriteSortMode_Texture, SpriteSortMode_Deferred })
+        {
+            const char* name = (mode == SpriteSortMode_Texture) ? "sorted by texture" : "deferred";
+
+            std::vector<uint8_t> vertices;
+            recording->SetVertexLog(&vertices);
+
+            target.batch->Begin(mode);
+            for (size_t i = 0; i < own; ++i)
+                DrawSprite(*target.batch, target, sprites, i);
+
+            Record(target, recorders, sprites, own, sprites.size());
+
+            target.batch->End();
+            recording->SetVertexLog(nullptr);
+
+            std::vector<size_t> expected(sprites.size());
+            for (size_t i = 0; i < expected.size(); ++i)
+                expected[i] = i;
+
+            if (mode == SpriteSortMode_Texture)
+                std::stable_sort(expected.begin(), expected.end(), [&](size_t x, size_t y) { return textureOrder[x] < textureOrder[y]; });
+
+            auto order = ReadDrawOrder(vertices);
+
+            size_t misplaced = 0;
+            for (size_t i = 0; i < std::min(order.size(), expected.size()); ++i)
+            {
+                if (order[i] != expected[i])
+                    ++misplaced;
+            }
+
+            bench.Check(order.size() == sprites.size() && misplaced == 0 && target.batch->GetStatistics().sprites == sprites.size(),
+                        "recorders: %s with %u recorders drew %zu sprites (%zu out of order), expected %zu",
+                        name, threadCount, order.size(), misplaced, sprites.size());
+        }
+    }
+
+
+    void TimeRecording(Bench& bench, unsigned threadCount, std::vector<Sprite> const& sprites, double drawSeconds, double drawEndSeconds)
+    {
+        RecorderTarget target(16);
+
+        char section[128];
+        snprintf(section, sizeof(section), "recorders: %zu sprites on %u threads, sorted by texture", sprites.size(), threadCount);
+        bench.Section(section);
+
+        std::vector<SpriteBatch::Recorder> recorders;
+        for (unsigned i = 0; i < threadCount; ++i)
+            recorders.emplace_back(*target.batch);
+
+        const size_t frames = 3;
+        double recordSeconds = 0;
+        double endSeconds = 0;
+
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            target.batch->Begin(SpriteSortMode_Texture);
+
+            recordSeconds += Record(target, recorders, sprites, 0, sprites.size());
+
+            Timer timer;
+            target.batch->End();
+            endSeconds += timer.GetSeconds();
+
+            bench.Check(target.batch->GetStatistics().sprites == sprites.size(), "recorders: frame %zu drew %u sprites, expected %zu",
+                        frame, target.batch->GetStatistics().sprites, sprites.size());
+        }
+
+        double count = double(frames * sprites.size());
+        bench.Report("recorded sprites per second", count / std::max(recordSeconds, 1e-9), "");
+        bench.Report("speedup over SpriteBatch::Draw on one thread", (drawSeconds / std::max(recordSeconds, 1e-9)), "x");
+        bench.Report("time per frame, End", endSeconds * 1000.0 / double(frames), "ms");
+        bench.Report("time per frame merging recorders in End", std::max(0.0, endSeconds - drawEndSeconds) * 1000.0 / double(frames), "ms");
+    }
+}
+
+
+void BenchTool::SpriteRecording(Bench& bench)
+{
+    unsigned maxThreads = bench.GetThreadCount() ? bench.GetThreadCount() : std::max(2u, std::thread::hardware_concurrency());
+
+    bench.Section("recorders: draw order after merging, deferred and sorted by texture");
+    CheckMergeOrder(bench, 1);
+    CheckMergeOrder(bench, maxThreads);
+    CheckMergeOrder(bench, 7);
+
+    auto sprites = MakeSprites(bench.Scaled(400000), 16, 44);
+
+    // The baseline: every sprite drawn on this thread straight into the batch's queue.
+    double drawSeconds = 0;
+    double drawEndSeconds = 0;
+    {
+        RecorderTarget target(16);
+
+        char section[128];
+        snprintf(section, sizeof(section), "recorders: %zu sprites drawn on one thread with SpriteBatch::Draw, sorted by texture", sprites.size());
+        bench.Section(section);
+
+        for (size_t frame = 0; frame < 3; ++frame)
+        {
+            Timer timer;
+
+            target.batch->Begin(SpriteSortMode_Texture);
+            for (size_t i = 0; i < sprites.size(); ++i)
+                DrawSprite(*target.batch, target, sprites, i);
+
+            drawSeconds += timer.GetSeconds();
+            timer.Restart();
+
+            target.batch->End();
+
+            drawEndSeconds += timer.GetSeconds();
+        }
+
+        bench.Report("drawn sprites per second", double(3 * sprites.size()) / std::max(drawSeconds, 1e-9), "");
+        bench.Report("time per frame, End", drawEndSeconds * 1000.0 / 3.0, "ms");
+    }
+
+    for (unsigned threadCount = 1; threadCount < maxThreads; threadCount *= 2)
+        TimeRecording(bench, threadCount, sprites, drawSeconds, drawEndSeconds);
+
+    TimeRecording(bench, maxThreads, sprites, drawSeconds, drawEndSeconds);
+}
@@ -0,0 +1,1628 @@
+//--------------------------------------------------------------------------------------
+// File: RecordingDevice.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "RecordingDevice.h"
+
+#include "PlatformHelpers.h"
+#include "LoaderHelpers.h"
+
+using namespace BenchTool;
+using namespace DirectX::LoaderHelpers;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    //--------------------------------------------------------------------------------------
+    // Shader containers. Direct3D rejects bytecode whose checksum doesn't match, so the
+    // device checks it too; that catches a damaged or hand-edited .inc file.
+    //--------------------------------------------------------------------------------------
+    inline uint32_t RotateLeft(uint32_t x, int c)
+    {
+        return (x << c) | (x >> (32 - c));
+    }
+
+    // One MD5 round over a 64 byte block.
+    void ChecksumBlock(uint32_t state[4], uint8_t const* block)
+    {
+        static const int s_shift[64] =
+        {
+            7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+            5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+            4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+            6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21,
+        };
+
+        static uint32_t s_table[64] = {};
+        static std::once_flag s_once;
+
+        std::call_once(s_once, []
+        {
+            for (int i = 0; i < 64; ++i)
+                s_table[i] = static_cast<uint32_t>(fabs(sin(double(i + 1))) * 4294967296.0);
+        });
+
+        uint32_t m[16];
+        memcpy(m, block, sizeof(m));
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+
+        for (int i = 0; i < 64; ++i)
+        {
+            uint32_t f;
+            int g;
+
+            if (i < 16)      { f = (b & c) | (~b & d); g = i; }
+            else if (i < 32) { f = (d & b) | (~d & c); g = (5 * i + 1) & 15; }
+            else if (i < 48) { f = b ^ c ^ d;          g = (3 * i + 5) & 15; }
+            else             { f = c ^ (b | ~d);       g = (7 * i) & 15; }
+
+            f += a + s_table[i] + m[g];
+            a = d;
+            d = c;
+            c = b;
+            b += RotateLeft(f, s_shift[i]);
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+    }
+
+    // The container checksum is MD5 over everything after it, with the length stored at
+    // both ends of the last block instead of MD5's usual padding.
+    bool IsValidShaderContainer(void const* bytecode, size_t length)
+    {
+        auto bytes = static_cast<uint8_t const*>(bytecode);
+
+        if (!bytecode || length < 32 || memcmp(bytes, "DXBC", 4) != 0)
+            return false;
+
+        uint32_t total;
+        memcpy(&total, bytes + 24, sizeof(total));
+        if (total != length)
+            return false;
+
+        uint32_t state[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+
+        uint8_t const* data = bytes + 20;
+        size_t size = length - 20;
+        size_t full = size & ~size_t(63);
+
+        for (size_t i = 0; i < full; i += 64)
+            ChecksumBlock(state, data + i);
+
+        uint32_t bits = static_cast<uint32_t>(size * 8);
+        uint32_t tail = (bits >> 2) | 1;
+        size_t rest = size - full;
+
+        uint8_t block[64] = {};
+
+        if (64 - (rest + 1) < 8)
+        {
+            memcpy(block, data + full, rest);
+            block[rest] = 0x80;
+            ChecksumBlock(state, block);
+
+            memset(block, 0, sizeof(block));
+        }
+        else
+        {
+            memcpy(block + 4, data + full, rest);
+            block[4 + rest] = 0x80;
+        }
+
+        memcpy(block, &bits, sizeof(bits));
+        memcpy(block + 60, &tail, sizeof(tail));
+        ChecksumBlock(state, block);
+
+        return memcmp(state, bytes + 4, 16) == 0;
+    }
+
+    // Finds a chunk such as "ISGN" in a shader container.
+    uint8_t const* FindChunk(void const* bytecode, char const* name, _Out_ uint32_t* size)
+    {
+        auto bytes = static_cast<uint8_t const*>(bytecode);
+
+        uint32_t count;
+        memcpy(&count, bytes + 28, sizeof(count));
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t offset;
+            memcpy(&offset, bytes + 32 + i * 4, sizeof(offset));
+
+            if (memcmp(bytes + offset, name, 4) == 0)
+            {
+                memcpy(size, bytes + offset + 4, sizeof(*size));
+                return bytes + offset + 8;
+            }
+        }
+
+        *size = 0;
+        return nullptr;
+    }
+
+    // Every input the vertex shader reads has to be in the layout.
+    bool IsLayoutCompatible(D3D11_INPUT_ELEMENT_DESC const* elements, UINT count, void const* bytecode)
+    {
+        uint32_t size;
+        auto signature = FindChunk(bytecode, "ISGN", &size);
+        if (!signature || size < 8)
+            return false;
+
+        uint32_t inputCount;
+        memcpy(&inputCount, signature, sizeof(inputCount));
+
+        for (uint32_t i = 0; i < inputCount; ++i)
+        {
+            uint32_t entry[6];
+            memcpy(entry, signature + 8 + i * 24, sizeof(entry));
+
+            // System values such as SV_VertexID come from the input assembler, not the layout.
+            if (entry[2] != 0)
+                continue;
+
+            auto name = reinterpret_cast<char const*>(signature + entry[0]);
+
+            bool found = false;
+            for (UINT j = 0; j < count && !found; ++j)
+            {
+                found = _stricmp(elements[j].SemanticName, name) == 0 && elements[j].SemanticIndex == entry[1];
+            }
+
+            if (!found)
+                return false;
+        }
+
+        return true;
+    }
+
+
+    //--------------------------------------------------------------------------------------
+    // Resources and the other device children.
+    //--------------------------------------------------------------------------------------
+    template<typename T, typename... TInterfaces>
+    class DeviceChild : public StubObject<T, TInterfaces..., ID3D11DeviceChild>
+    {
+    public:
+        explicit DeviceChild(_In_ ID3D11Device* device) : mDevice(device) {}
+
+        void STDMETHODCALLTYPE GetDevice(_Outptr_ ID3D11Device** ppDevice) override
+        {
+            mDevice.CopyTo(ppDevice);
+        }
+
+        HRESULT STDMETHODCALLTYPE SetPrivateData(_In_ REFGUID, _In_ UINT, _In_reads_bytes_opt_(DataSize) void const*) override
+        {
+            return S_OK;
+        }
+
+    private:
+        ComPtr<ID3D11Device> mDevice;
+    };
+
+
+    // The memory behind a resource: one block per subresource.
+    struct Subresource
+    {
+        std::vector<uint8_t> data;
+        UINT rowPitch;
+        UINT depthPitch;
+        UINT rows;
+        UINT depth;
+    };
+
+    struct Storage
+    {
+        std::vector<Subresource> subresources;
+
+        // Lays out a texture's subresources, filling in the mip count if it was left to the device.
+        HRESULT Allocate(DXGI_FORMAT format, UINT width, UINT height, UINT depth, UINT& mipLevels, UINT arraySize)
+        {
+            if (!width || !height || !depth || !arraySize || format == DXGI_FORMAT_UNKNOWN || !BitsPerPixel(format))
+                return E_INVALIDARG;
+
+            // Video formats with subsampled chroma planes take a single level of even size.
+            auto layout = GetFormatInfo(format).layout;
+            if ((layout == FORMAT_PLANAR || layout == FORMAT_NV11) && (mipLevels != 1 || (width & 1) || (height & 1)))
+                return E_INVALIDARG;
+
+            if (!mipLevels)
+            {
+                mipLevels = 1;
+                for (UINT size = std::max(std::max(width, height), depth); size > 1; size >>= 1)
+                    mipLevels++;
+            }
+
+            subresources.resize(size_t(mipLevels) * arraySize);
+
+            for (UINT item = 0; item < arraySize; ++item)
+            {
+                for (UINT level = 0; level < mipLevels; ++level)
+                {
+                    size_t numBytes, rowBytes, numRows;
+                    GetSurfaceInfo(std::max(1u, width >> level), std::max(1u, height >> level), format, &numBytes, &rowBytes, &numRows);
+
+                    auto& sub = subresources[D3D11CalcSubresource(level, item, mipLevels)];
+                    sub.rowPitch = static_cast<UINT>(rowBytes);
+                    sub.depthPitch = static_cast<UINT>(numBytes);
+                    sub.rows = static_cast<UINT>(numRows);
+                    sub.depth = std::max(1u, depth >> level);
+                    sub.data.resize(numBytes * sub.depth);
+                }
+            }
+
+            return S_OK;
+        }
+
+        void Initialize(_In_opt_ D3D11_SUBRESOURCE_DATA const* initialData)
+        {
+            if (!initialData)
+                return;
+
+            for (size_t i = 0; i < subresources.size(); ++i)
+            {
+                auto& sub = subresources[i];
+                auto source = static_cast<uint8_t const*>(initialData[i].pSysMem);
+
+                for (UINT z = 0; z < sub.depth; ++z)
+                {
+                    for (UINT row = 0; row < sub.rows; ++row)
+                    {
+                        memcpy(&sub.data[z * sub.depthPitch + row * sub.rowPitch],
+                               source + z * initialData[i].SysMemSlicePitch + row * initialData[i].SysMemPitch,
+                               sub.rowPitch);
+                    }
+                }
+            }
+        }
+
+        size_t Size() const
+        {
+            size_t size = 0;
+            for (auto& sub : subresources)
+                size += sub.data.size();
+            return size;
+        }
+    };
+
+
+    class Buffer : public DeviceChild<ID3D11Buffer, ID3D11Resource>, public Storage
+    {
+    public:
+        Buffer(_In_ ID3D11Device* device, D3D11_BUFFER_DESC const& desc)
+          : DeviceChild(device),
+            mDesc(desc)
+        {
+            subresources.resize(1);
+            subresources[0].data.resize(desc.ByteWidth);
+            subresources[0].rowPitch = subresources[0].depthPitch = desc.ByteWidth;
+            subresources[0].rows = subresources[0].depth = 1;
+        }
+
+        void STDMETHODCALLTYPE GetType(_Out_ D3D11_RESOURCE_DIMENSION* pResourceDimension) override { *pResourceDimension = D3D11_RESOURCE_DIMENSION_BUFFER; }
+        void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_BUFFER_DESC* pDesc) override { *pDesc = mDesc; }
+
+    private:
+        D3D11_BUFFER_DESC mDesc;
+    };
+
+
+    template<typename T, typename TDesc, D3D11_RESOURCE_DIMENSION Dimension>
+    class Texture : public DeviceChild<T, ID3D11Resource>, public Storage
+    {
+    public:
+        Texture(_In_ ID3D11Device* device, TDesc const& desc)
+          : DeviceChild<T, ID3D11Resource>(device),
+            mDesc(desc)
+        {
+        }
+
+        void STDMETHODCALLTYPE GetType(_Out_ D3D11_RESOURCE_DIMENSION* pResourceDimension) override { *pResourceDimension = Dimension; }
+        void STDMETHODCALLTYPE GetDesc(_Out_ TDesc* pDesc) override { *pDesc = mDesc; }
+
+        TDesc mDesc;
+    };
+
+    typedef Texture<ID3D11Texture1D, D3D11_TEXTURE1D_DESC, D3D11_RESOURCE_DIMENSION_TEXTURE1D> Texture1D;
+    typedef Texture<ID3D11Texture2D, D3D11_TEXTURE2D_DESC, D3D11_RESOURCE_DIMENSION_TEXTURE2D> Texture2D;
+    typedef Texture<ID3D11Texture3D, D3D11_TEXTURE3D_DESC, D3D11_RESOURCE_DIMENSION_TEXTURE3D> Texture3D;
+
+
+    Storage* GetStorage(_In_ ID3D11Resource* resource)
+    {
+        D3D11_RESOURCE_DIMENSION dimension;
+        resource->GetType(&dimension);
+
+        switch (dimension)
+        {
+        case D3D11_RESOURCE_DIMENSION_BUFFER:       return static_cast<Buffer*>(static_cast<ID3D11Buffer*>(resource));
+        case D3D11_RESOURCE_DIMENSION_TEXTURE1D:    return static_cast<Texture1D*>(static_cast<ID3D11Texture1D*>(resource));
+        case D3D11_RESOURCE_DIMENSION_TEXTURE2D:    return static_cast<Texture2D*>(static_cast<ID3D11Texture2D*>(resource));
+        case D3D11_RESOURCE_DIMENSION_TEXTURE3D:    return static_cast<Texture3D*>(static_cast<ID3D11Texture3D*>(resource));
+        default:                                    return nullptr;
+        }
+    }
+
+    DXGI_FORMAT GetFormat(_In_ ID3D11Resource* resource)
+    {
+        D3D11_RESOURCE_DIMENSION dimension;
+        resource->GetType(&dimension);
+
+        switch (dimension)
+        {
+        case D3D11_RESOURCE_DIMENSION_TEXTURE1D:    return static_cast<Texture1D*>(static_cast<ID3D11Texture1D*>(resource))->mDesc.Format;
+        case D3D11_RESOURCE_DIMENSION_TEXTURE2D:    return static_cast<Texture2D*>(static_cast<ID3D11Texture2D*>(resource))->mDesc.Format;
+        case D3D11_RESOURCE_DIMENSION_TEXTURE3D:    return static_cast<Texture3D*>(static_cast<ID3D11Texture3D*>(resource))->mDesc.Format;
+        default:                                    return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+    // Bytes and rows covered by a horizontal span of a subresource, allowing for 4x4 blocks.
+    void GetSpan(DXGI_FORMAT format, UINT left, UINT right, UINT top, UINT bottom,
+                 _Out_ size_t* offset, _Out_ size_t* bytes, _Out_ UINT* firstRow, _Out_ UINT* rowCount)
+    {
+        if (format == DXGI_FORMAT_UNKNOWN)
+        {
+            // Buffers are addressed in bytes.
+            *offset = left;
+            *bytes = right - left;
+            *firstRow = 0;
+            *rowCount = 1;
+        }
+        else if (IsCompressed(format))
+        {
+            size_t blockBytes = (BitsPerPixel(format) * 16) / 8;
+            *offset = (left / 4) * blockBytes;
+            *bytes = ((right + 3) / 4 - left / 4) * blockBytes;
+            *firstRow = top / 4;
+            *rowCount = (bottom + 3) / 4 - top / 4;
+        }
+        else
+        {
+            size_t bpp = BitsPerPixel(format);
+            *offset = (left * bpp) / 8;
+            *bytes = ((right - left) * bpp + 7) / 8;
+            *firstRow = top;
+            *rowCount = bottom - top;
+        }
+    }
+
+
+    class ShaderResourceView : public DeviceChild<ID3D11ShaderResourceView, ID3D11View>
+    {
+    public:
+        ShaderResourceView(_In_ ID3D11Device* device, _In_ ID3D11Resource* resource, D3D11_SHADER_RESOURCE_VIEW_DESC const& desc)
+          : DeviceChild(device),
+            mResource(resource),
+            mDesc(desc)
+        {
+        }
+
+        void STDMETHODCALLTYPE GetResource(_Outptr_ ID3D11Resource** ppResource) override { mResource.CopyTo(ppResource); }
+        void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_SHADER_RESOURCE_VIEW_DESC* pDesc) override { *pDesc = mDesc; }
+
+    private:
+        ComPtr<ID3D11Resource> mResource;
+        D3D11_SHADER_RESOURCE_VIEW_DESC mDesc;
+    };
+
+
+    template<typename T, typename TDesc>
+    class StateObject : public DeviceChild<T>
+    {
+    public:
+        StateObject(_In_ ID3D11Device* device, TDesc const& desc)
+          : DeviceChild<T>(device),
+            mDesc(desc)
+        {
+        }
+
+        void STDMETHODCALLTYPE GetDesc(_Out_ TDesc* pDesc) override { *pDesc = mDesc; }
+
+    private:
+        TDesc mDesc;
+    };
+
+
+    template<typename T>
+    class ShaderObject : public DeviceChild<T>
+    {
+    public:
+        explicit ShaderObject(_In_ ID3D11Device* device) : DeviceChild<T>(device) {}
+    };
+
+
+    template<typename T, typename TObject>
+    HRESULT Return(TObject* object, _COM_Outptr_opt_ T** ppObject)
+    {
+        if (ppObject)
+        {
+            *ppObject = object;
+        }
+        else
+        {
+            object->Release();
+        }
+
+        return S_OK;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// RecordingContext
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+RecordingContext::RecordingContext(RecordingDevice* device, D3D11_DEVICE_CONTEXT_TYPE type)
+  : mDevice(device),
+    mType(type),
+    mRefCount(1),
+    mBlendState(nullptr),
+    mDepthStencilState(nullptr),
+    mRasterizerState(nullptr),
+    mSampler(nullptr),
+    mVertexShader(nullptr),
+    mPixelShader(nullptr),
+    mTexture(nullptr),
+    mVertexBuffer(nullptr),
+    mVertexStride(0),
+    mVertexOffset(0),
+    mInputLayout(nullptr),
+    mIndexBuffer(nullptr),
+    mIndexFormat(DXGI_FORMAT_UNKNOWN),
+    mIndexOffset(0),
+    mTopology(D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED),
+    mDrawLog(nullptr),
+    mVertexLog(nullptr)
+{
+    viewport = { 0, 0, 1920.f, 1080.f, 0, 1.f };
+
+    ResetCounters();
+
+    // Deferred contexts keep their device alive; the immediate context is part of it.
+    if (mType == D3D11_DEVICE_CONTEXT_DEFERRED)
+        mDevice->AddRef();
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingContext::QueryInterface(REFIID riid, void** ppvObject)
+{
+    if (!ppvObject)
+        return E_POINTER;
+
+    if (riid == StubInterfaceId<IUnknown>::Get()
+        || riid == StubInterfaceId<ID3D11DeviceChild>::Get()
+        || riid == StubInterfaceId<ID3D11DeviceContext>::Get())
+    {
+        AddRef();
+        *ppvObject = static_cast<ID3D11DeviceContext*>(this);
+        return S_OK;
+    }
+
+    *ppvObject = nullptr;
+    return E_NOINTERFACE;
+}
+
+
+ULONG STDMETHODCALLTYPE RecordingContext::AddRef()
+{
+    if (mType == D3D11_DEVICE_CONTEXT_IMMEDIATE)
+        return mDevice->AddRef();
+
+    return ++mRefCount;
+}
+
+
+ULONG STDMETHODCALLTYPE RecordingContext::Release()
+{
+    if (mType == D3D11_DEVICE_CONTEXT_IMMEDIATE)
+        return mDevice->Release();
+
+    ULONG count = --mRefCount;
+    if (!count)
+    {
+        auto device = mDevice;
+        delete this;
+        device->Release();
+    }
+
+    return count;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::GetDevice(ID3D11Device** ppDevice)
+{
+    mDevice->AddRef();
+    *ppDevice = mDevice;
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingContext::SetPrivateData(REFGUID, UINT, void const*)
+{
+    return S_OK;
+}
+
+
+void RecordingContext::ClearState()
+{
+    mBlendState = nullptr;
+    mDepthStencilState = nullptr;
+    mRasterizerState = nullptr;
+    mSampler = nullptr;
+    mVertexShader = nullptr;
+    mPixelShader = nullptr;
+    mTexture = nullptr;
+    mVertexBuffer = nullptr;
+    mInputLayout = nullptr;
+    mIndexBuffer = nullptr;
+    mTopology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::VSSetConstantBuffers(UINT, UINT NumBuffers, ID3D11Buffer* const*)
+{
+    mCounters.constantBufferChanges += NumBuffers;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::PSSetShaderResources(UINT, UINT NumViews, ID3D11ShaderResourceView* const* ppShaderResourceViews)
+{
+    if (NumViews && ppShaderResourceViews && ppShaderResourceViews[0] != mTexture)
+    {
+        mTexture = ppShaderResourceViews[0];
+        mCounters.textureChanges++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::PSSetShader(ID3D11PixelShader* pPixelShader, ID3D11ClassInstance* const*, UINT)
+{
+    if (pPixelShader != mPixelShader)
+    {
+        mPixelShader = pPixelShader;
+        mCounters.shaderChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::PSSetSamplers(UINT, UINT NumSamplers, ID3D11SamplerState* const* ppSamplers)
+{
+    if (NumSamplers && ppSamplers && ppSamplers[0] != mSampler)
+    {
+        mSampler = ppSamplers[0];
+        mCounters.stateChanges++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::VSSetShader(ID3D11VertexShader* pVertexShader, ID3D11ClassInstance* const*, UINT)
+{
+    if (pVertexShader != mVertexShader)
+    {
+        mVertexShader = pVertexShader;
+        mCounters.shaderChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::DrawIndexed(UINT IndexCount, UINT StartIndexLocation, INT BaseVertexLocation)
+{
+    mCounters.drawCalls++;
+    mCounters.indicesDrawn += IndexCount;
+
+    if (mDrawLog)
+        Record(IndexCount, StartIndexLocation, BaseVertexLocation);
+
+    if (mVertexLog)
+        RecordVertices(IndexCount, StartIndexLocation, BaseVertexLocation);
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::Draw(UINT VertexCount, UINT StartVertexLocation)
+{
+    mCounters.drawCalls++;
+    mCounters.indicesDrawn += VertexCount;
+
+    if (mDrawLog)
+        Record(VertexCount, StartVertexLocation, 0);
+}
+
+
+void RecordingContext::Record(UINT count, UINT start, INT baseVertex)
+{
+    DrawRecord record;
+    record.texture = mTexture;
+    record.blendState = mBlendState;
+    record.depthStencilState = mDepthStencilState;
+    record.rasterizerState = mRasterizerState;
+    record.inputLayout = mInputLayout;
+    record.vertexBuffer = mVertexBuffer;
+    record.indexBuffer = mIndexBuffer;
+    record.vertexShader = mVertexShader;
+    record.pixelShader = mPixelShader;
+    record.topology = mTopology;
+    record.count = count;
+    record.start = start;
+    record.baseVertex = baseVertex;
+
+    mDrawLog->push_back(record);
+}
+
+
+void RecordingContext::RecordVertices(UINT count, UINT start, INT baseVertex)
+{
+    if (!count || !mVertexBuffer || !mIndexBuffer || !mVertexStride)
+        return;
+
+    auto& indexData = GetStorage(mIndexBuffer)->subresources[0].data;
+    auto& vertexData = GetStorage(mVertexBuffer)->subresources[0].data;
+
+    size_t indexSize = (mIndexFormat == DXGI_FORMAT_R32_UINT) ? 4 : 2;
+    size_t first = mIndexOffset + size_t(start) * indexSize;
+    if (first + size_t(count) * indexSize > indexData.size())
+        return;
+
+    uint32_t lowest = UINT32_MAX;
+    uint32_t highest = 0;
+
+    for (UINT i = 0; i < count; ++i)
+    {
+        uint32_t index = 0;
+        memcpy(&index, &indexData[first + i * indexSize], indexSize);
+
+        lowest = std::min(lowest, index);
+        highest = std::max(highest, index);
+    }
+
+    size_t begin = mVertexOffset + (int64_t(baseVertex) + lowest) * mVertexStride;
+    size_t end = mVertexOffset + (int64_t(baseVertex) + highest + 1) * mVertexStride;
+    if (end > vertexData.size())
+        return;
+
+    mVertexLog->insert(mVertexLog->end(), vertexData.begin() + begin, vertexData.begin() + end);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingContext::Map(ID3D11Resource* pResource, UINT Subresource, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE* pMappedResource)
+{
+    auto storage = GetStorage(pResource);
+    if (!storage || Subresource >= storage->subresources.size())
+        return E_INVALIDARG;
+
+    // Nothing is ever in flight, so every map succeeds at once, even with DO_NOT_WAIT.
+    auto& sub = storage->subresources[Subresource];
+
+    if (pMappedResource)
+    {
+        pMappedResource->pData = sub.data.data();
+        pMappedResource->RowPitch = sub.rowPitch;
+        pMappedResource->DepthPitch = sub.depthPitch;
+    }
+
+    mCounters.maps++;
+    mCounters.bytesMapped += sub.data.size();
+    return S_OK;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::Unmap(ID3D11Resource*, UINT)
+{
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::PSSetConstantBuffers(UINT, UINT NumBuffers, ID3D11Buffer* const*)
+{
+    mCounters.constantBufferChanges += NumBuffers;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::IASetInputLayout(ID3D11InputLayout* pInputLayout)
+{
+    if (pInputLayout != mInputLayout)
+    {
+        mInputLayout = pInputLayout;
+        mCounters.inputLayoutChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::IASetVertexBuffers(UINT, UINT NumBuffers, ID3D11Buffer* const* ppVertexBuffers, UINT const* pStrides, UINT const* pOffsets)
+{
+    if (NumBuffers && pStrides)
+        mVertexStride = pStrides[0];
+
+    if (NumBuffers && pOffsets)
+        mVertexOffset = pOffsets[0];
+
+    if (NumBuffers && ppVertexBuffers && ppVertexBuffers[0] != mVertexBuffer)
+    {
+        mVertexBuffer = ppVertexBuffers[0];
+        mCounters.vertexBufferChanges++;
+    }
+    else if (NumBuffers && ppVertexBuffers)
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::IASetIndexBuffer(ID3D11Buffer* pIndexBuffer, DXGI_FORMAT Format, UINT Offset)
+{
+    mIndexFormat = Format;
+    mIndexOffset = Offset;
+
+    if (pIndexBuffer != mIndexBuffer)
+    {
+        mIndexBuffer = pIndexBuffer;
+        mCounters.indexBufferChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology)
+{
+    if (Topology != mTopology)
+    {
+        mTopology = Topology;
+        mCounters.topologyChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::OMSetBlendState(ID3D11BlendState* pBlendState, FLOAT const*, UINT)
+{
+    if (pBlendState != mBlendState)
+    {
+        mBlendState = pBlendState;
+        mCounters.stateChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::OMSetDepthStencilState(ID3D11DepthStencilState* pDepthStencilState, UINT)
+{
+    if (pDepthStencilState != mDepthStencilState)
+    {
+        mDepthStencilState = pDepthStencilState;
+        mCounters.stateChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::RSSetState(ID3D11RasterizerState* pRasterizerState)
+{
+    if (pRasterizerState != mRasterizerState)
+    {
+        mRasterizerState = pRasterizerState;
+        mCounters.stateChanges++;
+    }
+    else
+    {
+        mCounters.redundantSets++;
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::RSGetViewports(UINT* pNumViewports, D3D11_VIEWPORT* pViewports)
+{
+    if (pViewports && *pNumViewports)
+    {
+        pViewports[0] = viewport;
+    }
+
+    *pNumViewports = 1;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::CopySubresourceRegion(ID3D11Resource* pDstResource, UINT DstSubresource, UINT DstX, UINT DstY, UINT DstZ,
+                                                               ID3D11Resource* pSrcResource, UINT SrcSubresource, D3D11_BOX const* pSrcBox)
+{
+    auto dst = GetStorage(pDstResource);
+    auto src = GetStorage(pSrcResource);
+
+    if (!dst || !src || DstSubresource >= dst->subresources.size() || SrcSubresource >= src->subresources.size())
+        return;
+
+    auto& dstSub = dst->subresources[DstSubresource];
+    auto& srcSub = src->subresources[SrcSubresource];
+
+    mCounters.copies++;
+
+    if (!pSrcBox && !DstX && !DstY && !DstZ && dstSub.data.size() == srcSub.data.size())
+    {
+        memcpy(dstSub.data.data(), srcSub.data.data(), srcSub.data.size());
+        return;
+    }
+
+    D3D11_BOX box;
+    if (pSrcBox)
+    {
+        box = *pSrcBox;
+    }
+    else
+    {
+        // The whole source subresource, in pixels.
+        DXGI_FORMAT format = GetFormat(pSrcResource);
+        UINT blockSize = IsCompressed(format) ? 4 : 1;
+        UINT width = (format == DXGI_FORMAT_UNKNOWN) ? srcSub.rowPitch : static_cast<UINT>((srcSub.rowPitch * 8) / std::max<size_t>(1, BitsPerPixel(format) * blockSize)) * blockSize;
+
+        box = { 0, 0, 0, width, srcSub.rows * blockSize, srcSub.depth };
+    }
+
+    DXGI_FORMAT format = GetFormat(pSrcResource);
+
+    size_t srcOffset, bytes, dstOffset, dstBytes;
+    UINT srcRow, rowCount, dstRow, dstRowCount;
+    GetSpan(format, box.left, box.right, box.top, box.bottom, &srcOffset, &bytes, &srcRow, &rowCount);
+    GetSpan(format, DstX, DstX + (box.right - box.left), DstY, DstY + (box.bottom - box.top), &dstOffset, &dstBytes, &dstRow, &dstRowCount);
+
+    for (UINT z = 0; z < box.back - box.front; ++z)
+    {
+        for (UINT row = 0; row < rowCount; ++row)
+        {
+            size_t from = (box.front + z) * size_t(srcSub.depthPitch) + (srcRow + row) * size_t(srcSub.rowPitch) + srcOffset;
+            size_t to = (DstZ + z) * size_t(dstSub.depthPitch) + (dstRow + row) * size_t(dstSub.rowPitch) + dstOffset;
+
+            if (from + bytes <= srcSub.data.size() && to + bytes <= dstSub.data.size())
+                memcpy(&dstSub.data[to], &srcSub.data[from], bytes);
+        }
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::CopyResource(ID3D11Resource* pDstResource, ID3D11Resource* pSrcResource)
+{
+    auto dst = GetStorage(pDstResource);
+    auto src = GetStorage(pSrcResource);
+
+    if (!dst || !src || dst->subresources.size() != src->subresources.size())
+        return;
+
+    for (size_t i = 0; i < src->subresources.size(); ++i)
+    {
+        auto& from = src->subresources[i].data;
+        auto& to = dst->subresources[i].data;
+        memcpy(to.data(), from.data(), std::min(from.size(), to.size()));
+    }
+
+    mCounters.copies++;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::UpdateSubresource(ID3D11Resource* pDstResource, UINT DstSubresource, D3D11_BOX const* pDstBox,
+                                                           void const* pSrcData, UINT SrcRowPitch, UINT SrcDepthPitch)
+{
+    auto dst = GetStorage(pDstResource);
+    if (!dst || DstSubresource >= dst->subresources.size())
+        return;
+
+    auto& sub = dst->subresources[DstSubresource];
+    auto source = static_cast<uint8_t const*>(pSrcData);
+
+    mCounters.updates++;
+
+    DXGI_FORMAT format = GetFormat(pDstResource);
+
+    if (format == DXGI_FORMAT_UNKNOWN)
+    {
+        // Buffers: the box is a byte range.
+        size_t begin = pDstBox ? pDstBox->left : 0;
+        size_t end = pDstBox ? pDstBox->right : sub.data.size();
+
+        if (begin < end && end <= sub.data.size())
+        {
+            memcpy(&sub.data[begin], source, end - begin);
+            mCounters.bytesUpdated += end - begin;
+        }
+        return;
+    }
+
+    if (!pDstBox)
+    {
+        for (UINT z = 0; z < sub.depth; ++z)
+        {
+            for (UINT row = 0; row < sub.rows; ++row)
+            {
+                memcpy(&sub.data[z * size_t(sub.depthPitch) + row * size_t(sub.rowPitch)], source + z * size_t(SrcDepthPitch) + row * size_t(SrcRowPitch), sub.rowPitch);
+            }
+        }
+
+        mCounters.bytesUpdated += sub.data.size();
+        return;
+    }
+
+    size_t offset, bytes;
+    UINT firstRow, rowCount;
+    GetSpan(format, pDstBox->left, pDstBox->right, pDstBox->top, pDstBox->bottom, &offset, &bytes, &firstRow, &rowCount);
+
+    for (UINT z = pDstBox->front; z < pDstBox->back; ++z)
+    {
+        for (UINT row = 0; row < rowCount; ++row)
+        {
+            size_t to = z * size_t(sub.depthPitch) + (firstRow + row) * size_t(sub.rowPitch) + offset;
+            if (to + bytes <= sub.data.size())
+            {
+                memcpy(&sub.data[to], source + (z - pDstBox->front) * size_t(SrcDepthPitch) + row * size_t(SrcRowPitch), bytes);
+                mCounters.bytesUpdated += bytes;
+            }
+        }
+    }
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::GenerateMips(ID3D11ShaderResourceView*)
+{
+    mCounters.copies++;
+}
+
+
+void STDMETHODCALLTYPE RecordingContext::ResolveSubresource(ID3D11Resource* pDstResource, UINT DstSubresource, ID3D11Resource* pSrcResource, UINT SrcSubresource, DXGI_FORMAT)
+{
+    // Recording devices never multisample, so a resolve is a copy.
+    CopySubresourceRegion(pDstResource, DstSubresource, 0, 0, 0, pSrcResource, SrcSubresource, nullptr);
+}
+
+
+D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE RecordingContext::GetType()
+{
+    return mType;
+}
+
+
+//--------------------------------------------------------------------------------------
+// RecordingDevice
+//--------------------------------------------------------------------------------------
+RecordingDevice::RecordingDevice(D3D_FEATURE_LEVEL featureLevel)
+  : mFeatureLevel(featureLevel),
+    mRefCount(1),
+    mImmediateContext(nullptr)
+{
+    mImmediateContext = new RecordingContext(this, D3D11_DEVICE_CONTEXT_IMMEDIATE);
+}
+
+
+RecordingDevice::~RecordingDevice()
+{
+    delete mImmediateContext;
+}
+
+
+HRESULT RecordingDevice::CreateDeferredContext(ID3D11DeviceContext** ppDeferredContext)
+{
+    if (!ppDeferredContext)
+        return E_POINTER;
+
+    *ppDeferredContext = new RecordingContext(this, D3D11_DEVICE_CONTEXT_DEFERRED);
+    return S_OK;
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::QueryInterface(REFIID riid, void** ppvObject)
+{
+    if (!ppvObject)
+        return E_POINTER;
+
+    if (riid == StubInterfaceId<IUnknown>::Get() || riid == StubInterfaceId<ID3D11Device>::Get())
+    {
+        AddRef();
+        *ppvObject = static_cast<ID3D11Device*>(this);
+        return S_OK;
+    }
+
+    *ppvObject = nullptr;
+    return E_NOINTERFACE;
+}
+
+
+ULONG STDMETHODCALLTYPE RecordingDevice::AddRef()
+{
+    return ++mRefCount;
+}
+
+
+ULONG STDMETHODCALLTYPE RecordingDevice::Release()
+{
+    ULONG count = --mRefCount;
+    if (!count)
+        delete this;
+    return count;
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateBuffer(D3D11_BUFFER_DESC const* pDesc, D3D11_SUBRESOURCE_DATA const* pInitialData, ID3D11Buffer** ppBuffer)
+{
+    if (!pDesc || !pDesc->ByteWidth)
+        return E_INVALIDARG;
+
+    if (pDesc->Usage == D3D11_USAGE_IMMUTABLE && !pInitialData)
+        return E_INVALIDARG;
+
+    if ((pDesc->BindFlags & D3D11_BIND_CONSTANT_BUFFER) && (pDesc->ByteWidth & 15))
+        return E_INVALIDARG;
+
+    auto buffer = new Buffer(this, *pDesc);
+
+    if (pInitialData)
+        memcpy(buffer->subresources[0].data.data(), pInitialData->pSysMem, pDesc->ByteWidth);
+
+    mCounters.buffers++;
+    mCounters.bytesAllocated += pDesc->ByteWidth;
+
+    return Return(buffer, ppBuffer);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateTexture1D(D3D11_TEXTURE1D_DESC const* pDesc, D3D11_SUBRESOURCE_DATA const* pInitialData, ID3D11Texture1D** ppTexture1D)
+{
+    if (!pDesc)
+        return E_INVALIDARG;
+
+    auto texture = new Texture1D(this, *pDesc);
+
+    HRESULT hr = texture->Allocate(pDesc->Format, pDesc->Width, 1, 1, texture->mDesc.MipLevels, pDesc->ArraySize);
+    if (FAILED(hr))
+    {
+        texture->Release();
+        return hr;
+    }
+
+    texture->Initialize(pInitialData);
+
+    mCounters.textures++;
+    mCounters.bytesAllocated += texture->Size();
+
+    return Return(texture, ppTexture1D);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateTexture2D(D3D11_TEXTURE2D_DESC const* pDesc, D3D11_SUBRESOURCE_DATA const* pInitialData, ID3D11Texture2D** ppTexture2D)
+{
+    if (!pDesc)
+        return E_INVALIDARG;
+
+    UINT maxSize = (mFeatureLevel >= D3D_FEATURE_LEVEL_11_0) ? D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION
+                 : (mFeatureLevel >= D3D_FEATURE_LEVEL_10_0) ? D3D10_REQ_TEXTURE2D_U_OR_V_DIMENSION
+                 : (mFeatureLevel >= D3D_FEATURE_LEVEL_9_3) ? D3D_FL9_3_REQ_TEXTURE2D_U_OR_V_DIMENSION
+                 : D3D_FL9_1_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+
+    if (pDesc->Width > maxSize || pDesc->Height > maxSize)
+        return E_INVALIDARG;
+
+    auto texture = new Texture2D(this, *pDesc);
+
+    HRESULT hr = texture->Allocate(pDesc->Format, pDesc->Width, pDesc->Height, 1, texture->mDesc.MipLevels, pDesc->ArraySize);
+    if (FAILED(hr))
+    {
+        texture->Release();
+        return hr;
+    }
+
+    texture->Initialize(pInitialData);
+
+    mCounters.textures++;
+    mCounters.bytesAllocated += texture->Size();
+
+    return Return(texture, ppTexture2D);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateTexture3D(D3D11_TEXTURE3D_DESC const* pDesc, D3D11_SUBRESOURCE_DATA const* pInitialData, ID3D11Texture3D** ppTexture3D)
+{
+    if (!pDesc)
+        return E_INVALIDARG;
+
+    auto texture = new Texture3D(this, *pDesc);
+
+    HRESULT hr = texture->Allocate(pDesc->Format, pDesc->Width, pDesc->Height, pDesc->Depth, texture->mDesc.MipLevels, 1);
+    if (FAILED(hr))
+    {
+        texture->Release();
+        return hr;
+    }
+
+    texture->Initialize(pInitialData);
+
+    mCounters.textures++;
+    mCounters.bytesAllocated += texture->Size();
+
+    return Return(texture, ppTexture3D);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateShaderResourceView(ID3D11Resource* pResource, D3D11_SHADER_RESOURCE_VIEW_DESC const* pDesc, ID3D11ShaderResourceView** ppSRView)
+{
+    if (!pResource)
+        return E_INVALIDARG;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC desc = {};
+
+    if (pDesc)
+    {
+        desc = *pDesc;
+    }
+    else
+    {
+        D3D11_RESOURCE_DIMENSION dimension;
+        pResource->GetType(&dimension);
+
+        desc.Format = GetFormat(pResource);
+        desc.ViewDimension = (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE1D) ? D3D11_SRV_DIMENSION_TEXTURE1D
+                           : (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE3D) ? D3D11_SRV_DIMENSION_TEXTURE3D
+                           : (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D) ? D3D11_SRV_DIMENSION_TEXTURE2D
+                           : D3D11_SRV_DIMENSION_BUFFER;
+        desc.Texture2D.MipLevels = UINT(-1);
+    }
+
+    mCounters.views++;
+
+    return Return(new ShaderResourceView(this, pResource, desc), ppSRView);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateInputLayout(D3D11_INPUT_ELEMENT_DESC const* pInputElementDescs, UINT NumElements,
+                                                             void const* pShaderBytecodeWithInputSignature, SIZE_T BytecodeLength, ID3D11InputLayout** ppInputLayout)
+{
+    if (!pInputElementDescs || !IsValidShaderContainer(pShaderBytecodeWithInputSignature, BytecodeLength)
+        || !IsLayoutCompatible(pInputElementDescs, NumElements, pShaderBytecodeWithInputSignature))
+        return E_INVALIDARG;
+
+    mCounters.stateObjects++;
+
+    return Return(new ShaderObject<ID3D11InputLayout>(this), ppInputLayout);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateVertexShader(void const* pShaderBytecode, SIZE_T BytecodeLength, ID3D11ClassLinkage*, ID3D11VertexShader** ppVertexShader)
+{
+    if (!IsValidShaderContainer(pShaderBytecode, BytecodeLength))
+        return E_INVALIDARG;
+
+    mCounters.shaders++;
+
+    return Return(new ShaderObject<ID3D11VertexShader>(this), ppVertexShader);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreatePixelShader(void const* pShaderBytecode, SIZE_T BytecodeLength, ID3D11ClassLinkage*, ID3D11PixelShader** ppPixelShader)
+{
+    if (!IsValidShaderContainer(pShaderBytecode, BytecodeLength))
+        return E_INVALIDARG;
+
+    mCounters.shaders++;
+
+    return Return(new ShaderObject<ID3D11PixelShader>(this), ppPixelShader);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateBlendState(D3D11_BLEND_DESC const* pBlendStateDesc, ID3D11BlendState** ppBlendState)
+{
+    if (!pBlendStateDesc)
+        return E_INVALIDARG;
+
+    mCounters.stateObjects++;
+
+    return Return(new StateObject<ID3D11BlendState, D3D11_BLEND_DESC>(this, *pBlendStateDesc), ppBlendState);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateDepthStencilState(D3D11_DEPTH_STENCIL_DESC const* pDepthStencilDesc, ID3D11DepthStencilState** ppDepthStencilState)
+{
+    if (!pDepthStencilDesc)
+        return E_INVALIDARG;
+
+    mCounters.stateObjects++;
+
+    return Return(new StateObject<ID3D11DepthStencilState, D3D11_DEPTH_STENCIL_DESC>(this, *pDepthStencilDesc), ppDepthStencilState);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateRasterizerState(D3D11_RASTERIZER_DESC const* pRasterizerDesc, ID3D11RasterizerState** ppRasterizerState)
+{
+    if (!pRasterizerDesc)
+        return E_INVALIDARG;
+
+    mCounters.stateObjects++;
+
+    return Return(new StateObject<ID3D11RasterizerState, D3D11_RASTERIZER_DESC>(this, *pRasterizerDesc), ppRasterizerState);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CreateSamplerState(D3D11_SAMPLER_DESC const* pSamplerDesc, ID3D11SamplerState** ppSamplerState)
+{
+    if (!pSamplerDesc)
+        return E_INVALIDARG;
+
+    mCounters.stateObjects++;
+
+    return Return(new StateObject<ID3D11SamplerState, D3D11_SAMPLER_DESC>(this, *pSamplerDesc), ppSamplerState);
+}
+
+
+HRESULT STDMETHODCALLTYPE RecordingDevice::CheckFormatSupport(DXGI_FORMAT Format, UINT* pFormatSupport)
+{
+    if (!pFormatSupport)
+        return E_INVALIDARG;
+
+    *pFormatSupport = 0;
+
+    if (Format == DXGI_FORMAT_UNKNOWN || !BitsPerPixel(Format))
+        return E_FAIL;
+
+    *pFormatSupport = D3D11_FORMAT_SUPPORT_TEXTURE1D | D3D11_FORMAT_SUPPORT_TEXTURE2D | D3D11_FORMAT_SUPPORT_TEXTURE3D
+                    | D3D11_FORMAT_SUPPORT_TEXTURECUBE | D3D11_FORMAT_SUPPORT_SHADER_SAMPLE | D3D11_FORMAT_SUPPORT_MIP;
+
+    if (!IsCompressed(Format))
+    {
+        *pFormatSupport |= D3D11_FORMAT_SUPPORT_MIP_AUTOGEN | D3D11_FORMAT_SUPPORT_RENDER_TARGET | D3D11_FORMAT_SUPPORT_MULTISAMPLE_RESOLVE;
+    }
+
+    return S_OK;
+}
+
+
+D3D_FEATURE_LEVEL STDMETHODCALLTYPE RecordingDevice::GetFeatureLevel()
+{
+    return mFeatureLevel;
+}
+
+
+UINT STDMETHODCALLTYPE RecordingDevice::GetCreationFlags()
+{
+    return 0;
+}
+
+
+void STDMETHODCALLTYPE RecordingDevice::GetImmediateContext(ID3D11DeviceContext** ppImmediateContext)
+{
+    AddRef();
+    *ppImmediateContext = mImmediateContext;
+}
+
+
+_Use_decl_annotations_
+HRESULT BenchTool::CreateRecordingDevice(D3D_FEATURE_LEVEL featureLevel, ID3D11Device** ppDevice, ID3D11DeviceContext** ppImmediateContext)
+{
+    if (!ppDevice || !ppImmediateContext)
+        return E_POINTER;
+
+    auto device = new RecordingDevice(featureLevel);
+
+    device->GetImmediateContext(ppImmediateContext);
+    *ppDevice = device;
+    return S_OK;
+}
+
+
+_Use_decl_annotations_
+HRESULT BenchTool::ReadSubresource(ID3D11Resource* resource, UINT subresource, std::vector<uint8_t>& data, UINT* rowPitch)
+{
+    auto storage = GetStorage(resource);
+    if (!storage || subresource >= storage->subresources.size())
+        return E_INVALIDARG;
+
+    data = storage->subresources[subresource].data;
+
+    if (rowPitch)
+        *rowPitch = storage->subresources[subresource].rowPitch;
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+// WIC
+//--------------------------------------------------------------------------------------
+namespace
+{
+    EncoderCounters s_encoderCounters;
+
+    std::atomic<bool> s_keepImages(false);
+    std::mutex s_imageMutex;
+    std::map<std::wstring, EncodedImage> s_images;
+
+    class PropertyBag : public StubObject<IPropertyBag2>
+    {
+    public:
+        HRESULT STDMETHODCALLTYPE Write(ULONG, PROPBAG2*, VARIANT*) override { return S_OK; }
+    };
+
+    class Stream : public StubObject<IWICStream, IStream>
+    {
+    public:
+        HRESULT STDMETHODCALLTYPE InitializeFromFilename(LPCWSTR wzFileName, DWORD) override
+        {
+            mFileName = wzFileName;
+            return S_OK;
+        }
+
+        std::wstring const& GetFileName() const { return mFileName; }
+
+    private:
+        std::wstring mFileName;
+    };
+
+    class MetadataWriter : public StubObject<IWICMetadataQueryWriter>
+    {
+    public:
+        HRESULT STDMETHODCALLTYPE SetMetadataByName(LPCWSTR, const PROPVARIANT*) override { return S_OK; }
+    };
+
+    // A copy of the pixels, as WIC's CreateBitmapFromMemory makes.
+    class Bitmap : public StubObject<IWICBitmap, IWICBitmapSource>
+    {
+    public:
+        Bitmap(UINT width, UINT height, REFWICPixelFormatGUID format, UINT stride, BYTE const* pixels)
+          : mWidth(width), mHeight(height), mFormat(format), mPixels(pixels, pixels + size_t(stride) * height)
+        {
+        }
+
+        HRESULT STDMETHODCALLTYPE GetSize(UINT* puiWidth, UINT* puiHeight) override { *puiWidth = mWidth; *puiHeight = mHeight; return S_OK; }
+        HRESULT STDMETHODCALLTYPE GetPixelFormat(WICPixelFormatGUID* pPixelFormat) override { *pPixelFormat = mFormat; return S_OK; }
+
+        size_t Size() const { return mPixels.size(); }
+
+        void GetImage(EncodedImage& image) const
+        {
+            image.width = mWidth;
+            image.height = mHeight;
+            image.pixelFormat = mFormat;
+            image.stride = mHeight ? UINT(mPixels.size() / mHeight) : 0;
+            image.pixels = mPixels;
+        }
+
+    private:
+        UINT mWidth;
+        UINT mHeight;
+        WICPixelFormatGUID mFormat;
+        std::vector<uint8_t> mPixels;
+    };
+
+    // Converts by forwarding the source, counting the conversion.
+    class FormatConverter : public StubObject<IWICFormatConverter, IWICBitmapSource>
+    {
+    public:
+        HRESULT STDMETHODCALLTYPE Initialize(IWICBitmapSource* pISource, REFWICPixelFormatGUID dstFormat, WICBitmapDitherType, void*, double, WICBitmapPaletteType) override
+        {
+            mSource = pISource;
+            mFormat = dstFormat;
+            s_encoderCounters.conversions++;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE CanConvert(REFWICPixelFormatGUID, REFWICPixelFormatGUID, BOOL* pfCanConvert) override { *pfCanConvert = TRUE; return S_OK; }
+        HRESULT STDMETHODCALLTYPE GetSize(UINT* puiWidth, UINT* puiHeight) override { return mSource->GetSize(puiWidth, puiHeight); }
+        HRESULT STDMETHODCALLTYPE GetPixelFormat(WICPixelFormatGUID* pPixelFormat) override { *pPixelFormat = mFormat; return S_OK; }
+
+        Bitmap const* GetSource() const { return static_cast<Bitmap*>(static_cast<IWICBitmap*>(mSource.Get())); }
+
+    private:
+        ComPtr<IWICBitmapSource> mSource;
+        WICPixelFormatGUID mFormat;
+    };
+
+    class FrameEncode : public StubObject<IWICBitmapFrameEncode>
+    {
+    public:
+        explicit FrameEncode(std::wstring const& fileName)
+          : mFileName(fileName)
+        {
+            mImage.width = 0;
+            mImage.height = 0;
+            mImage.pixelFormat = GUID{};
+            mImage.targetFormat = GUID{};
+            mImage.stride = 0;
+        }
+
+        HRESULT STDMETHODCALLTYPE Initialize(IPropertyBag2*) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE SetSize(UINT uiWidth, UINT uiHeight) override { mImage.width = uiWidth; mImage.height = uiHeight; return S_OK; }
+        HRESULT STDMETHODCALLTYPE SetResolution(double, double) override { return S_OK; }
+        HRESULT STDMETHODCALLTYPE SetPixelFormat(WICPixelFormatGUID* pPixelFormat) override { mImage.targetFormat = *pPixelFormat; return S_OK; }
+
+        HRESULT STDMETHODCALLTYPE WritePixels(UINT, UINT cbStride, UINT cbBufferSize, BYTE* pbPixels) override
+        {
+            s_encoderCounters.pixelBytes += cbBufferSize;
+
+            if (s_keepImages)
+            {
+                mImage.pixelFormat = mImage.targetFormat;
+                mImage.stride = cbStride;
+                mImage.pixels.assign(pbPixels, pbPixels + cbBufferSize);
+            }
+
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE WriteSource(IWICBitmapSource* pIBitmapSource, WICRect*) override
+        {
+            // ScreenGrab only writes through a converter.
+            auto source = static_cast<FormatConverter*>(static_cast<IWICFormatConverter*>(pIBitmapSource))->GetSource();
+            s_encoderCounters.pixelBytes += source->Size();
+
+            if (s_keepImages)
+            {
+                auto targetFormat = mImage.targetFormat;
+                source->GetImage(mImage);
+                mImage.targetFormat = targetFormat;
+            }
+
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE Commit() override
+        {
+            s_encoderCounters.frames++;
+
+            if (s_keepImages)
+            {
+                std::lock_guard<std::mutex> lock(s_imageMutex);
+                s_images[mFileName] = std::move(mImage);
+            }
+
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE GetMetadataQueryWriter(IWICMetadataQueryWriter** ppIMetadataQueryWriter) override
+        {
+            *ppIMetadataQueryWriter = new MetadataWriter;
+            return S_OK;
+        }
+
+    private:
+        std::wstring mFileName;
+        EncodedImage mImage;
+    };
+
+    class Encoder : public StubObject<IWICBitmapEncoder>
+    {
+    public:
+        HRESULT STDMETHODCALLTYPE Initialize(IStream* pIStream, WICBitmapEncoderCacheOption) override
+        {
+            mFileName = static_cast<Stream*>(static_cast<IWICStream*>(pIStream))->GetFileName();
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateNewFrame(IWICBitmapFrameEncode** ppIFrameEncode, IPropertyBag2** ppIEncoderOptions) override
+        {
+            *ppIFrameEncode = new FrameEncode(mFileName);
+            if (ppIEncoderOptions)
+                *ppIEncoderOptions = new PropertyBag;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE Commit() override { return S_OK; }
+
+    private:
+        std::wstring mFileName;
+    };
+
+    class ImagingFactory : public StubObject<IWICImagingFactory>
+    {
+    public:
+        HRESULT STDMETHODCALLTYPE CreateEncoder(REFGUID, const GUID*, IWICBitmapEncoder** ppIEncoder) override
+        {
+            s_encoderCounters.encoders++;
+            *ppIEncoder = new Encoder;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateFormatConverter(IWICFormatConverter** ppIFormatConverter) override
+        {
+            *ppIFormatConverter = new FormatConverter;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateStream(IWICStream** ppIWICStream) override
+        {
+            *ppIWICStream = new Stream;
+            return S_OK;
+        }
+
+        HRESULT STDMETHODCALLTYPE CreateBitmapFromMemory(UINT uiWidth, UINT uiHeight, REFWICPixelFormatGUID pixelFormat, UINT cbStride,
+                                                         UINT, BYTE* pbBuffer, IWICBitmap** ppIBitmap) override
+        {
+            *ppIBitmap = new Bitmap(uiWidth, uiHeight, pixelFormat, cbStride, pbBuffer);
+            return S_OK;
+        }
+    };
+}
+
+
+IWICImagingFactory* BenchTool::GetRecordingWIC()
+{
+    // Lives as long as the process, as the real factory does once created.
+    static ImagingFactory* s_factory = new ImagingFactory;
+    return s_factory;
+}
+
+
+EncoderCounters& BenchTool::GetEncoderCounters()
+{
+    return s_encoderCounters;
+}
+
+
+void BenchTool::KeepEncodedImages(bool enable)
+{
+    s_keepImages = enable;
+
+    if (!enable)
+    {
+        std::lock_guard<std::mutex> lock(s_imageMutex);
+        s_images.clear();
+    }
+}
+
+
+_Use_decl_annotations_
+bool BenchTool::TakeEncodedImage(const wchar_t* fileName, EncodedImage& image)
+{
+    std::lock_guard<std::mutex> lock(s_imageMutex);
+
+    auto it = s_images.find(fileName);
+    if (it == s_images.end())
+        return false;
+
+    image = std::move(it->second);
+    s_images.erase(it);
+    return true;
+}
+
+
+// ScreenGrab.cpp expects the WIC factory from WICTextureLoader.cpp, which BenchTool replaces.
+namespace DirectX
+{
+    bool _IsWIC2();
+    IWICImagingFactory* _GetWIC();
+}
+
+IWICImagingFactory* DirectX::_GetWIC()
+{
+    return BenchTool::GetRecordingWIC();
+}
+
+bool DirectX::_IsWIC2()
+{
+    return true;
+}
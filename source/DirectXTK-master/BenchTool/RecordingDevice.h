@@ -0,0 +1,283 @@
+//--------------------------------------------------------------------------------------
+// File: RecordingDevice.h
+//
+// A Direct3D 11 device and context that run entirely on the CPU. Resources keep their
+// contents in memory, so Map, UpdateSubresource and the copy calls behave as they would
+// on a real device once the GPU has caught up, and draws are only counted. BenchTool
+// drives the DirectXTK classes through it to measure their CPU cost without a GPU.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <d3d11_1.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+
+namespace BenchTool
+{
+    // What a context has been asked to do since its counters were last reset.
+    struct ContextCounters
+    {
+        uint64_t drawCalls;
+        uint64_t indicesDrawn;
+        uint64_t maps;
+        uint64_t bytesMapped;           // Size of the mapped subresources
+        uint64_t updates;
+        uint64_t bytesUpdated;          // Written by UpdateSubresource
+        uint64_t copies;
+        uint64_t stateChanges;          // Blend, depth/stencil, rasterizer and sampler states
+        uint64_t shaderChanges;
+        uint64_t textureChanges;
+        uint64_t constantBufferChanges;
+        uint64_t vertexBufferChanges;
+        uint64_t inputLayoutChanges;
+        uint64_t indexBufferChanges;
+        uint64_t topologyChanges;
+        uint64_t redundantSets;         // Set calls that bound what was already bound
+    };
+
+
+    // What was bound when a draw was made.
+    struct DrawRecord
+    {
+        void const* texture;            // Pixel shader slot 0
+        void const* blendState;
+        void const* depthStencilState;
+        void const* rasterizerState;
+        void const* inputLayout;
+        void const* vertexBuffer;
+        void const* indexBuffer;
+        void const* vertexShader;
+        void const* pixelShader;
+        D3D11_PRIMITIVE_TOPOLOGY topology;
+        UINT count;
+        UINT start;
+        INT baseVertex;
+    };
+
+
+    // What a device has created since it was made.
+    struct DeviceCounters
+    {
+        std::atomic<uint64_t> buffers;
+        std::atomic<uint64_t> textures;
+        std::atomic<uint64_t> views;
+        std::atomic<uint64_t> stateObjects;
+        std::atomic<uint64_t> shaders;
+        std::atomic<uint64_t> bytesAllocated;
+
+        DeviceCounters() : buffers(0), textures(0), views(0), stateObjects(0), shaders(0), bytesAllocated(0) {}
+    };
+
+
+    class RecordingDevice;
+
+
+    class RecordingContext : public ID3D11DeviceContext
+    {
+    public:
+        RecordingContext(_In_ RecordingDevice* device, D3D11_DEVICE_CONTEXT_TYPE type);
+
+        RecordingContext(RecordingContext const&) = delete;
+        RecordingContext& operator= (RecordingContext const&) = delete;
+
+        ContextCounters const& GetCounters() const { return mCounters; }
+        void ResetCounters() { memset(&mCounters, 0, sizeof(mCounters)); }
+
+        // Appends a record of every draw to the log until it is set back to null.
+        void SetDrawLog(_In_opt_ std::vector<DrawRecord>* log) { mDrawLog = log; }
+
+        // Appends the vertices each indexed draw reads (from its lowest index to its highest) as they
+        // are in the bound vertex buffer at the time of the draw, until it is set back to null.
+        void SetVertexLog(_In_opt_ std::vector<uint8_t>* log) { mVertexLog = log; }
+
+        // Direct3D's ClearState, which the stub ID3D11DeviceContext leaves out. Unbinds the
+        // tracked state, so the next set of each counts as a change.
+        void ClearState();
+
+        // IUnknown. The immediate context shares the device's reference count, as in Direct3D.
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override;
+        ULONG STDMETHODCALLTYPE AddRef() override;
+        ULONG STDMETHODCALLTYPE Release() override;
+
+        // ID3D11DeviceChild
+        void STDMETHODCALLTYPE GetDevice(_Outptr_ ID3D11Device** ppDevice) override;
+        HRESULT STDMETHODCALLTYPE SetPrivateData(_In_ REFGUID guid, _In_ UINT DataSize, _In_reads_bytes_opt_(DataSize) void const* pData) override;
+
+        // ID3D11DeviceContext
+        void STDMETHODCALLTYPE VSSetConstantBuffers(_In_ UINT StartSlot, _In_ UINT NumBuffers, _In_reads_opt_(NumBuffers) ID3D11Buffer* const* ppConstantBuffers) override;
+        void STDMETHODCALLTYPE PSSetShaderResources(_In_ UINT StartSlot, _In_ UINT NumViews, _In_reads_opt_(NumViews) ID3D11ShaderResourceView* const* ppShaderResourceViews) override;
+        void STDMETHODCALLTYPE PSSetShader(_In_opt_ ID3D11PixelShader* pPixelShader, _In_reads_opt_(NumClassInstances) ID3D11ClassInstance* const* ppClassInstances, UINT NumClassInstances) override;
+        void STDMETHODCALLTYPE PSSetSamplers(_In_ UINT StartSlot, _In_ UINT NumSamplers, _In_reads_opt_(NumSamplers) ID3D11SamplerState* const* ppSamplers) override;
+        void STDMETHODCALLTYPE VSSetShader(_In_opt_ ID3D11VertexShader* pVertexShader, _In_reads_opt_(NumClassInstances) ID3D11ClassInstance* const* ppClassInstances, UINT NumClassInstances) override;
+        void STDMETHODCALLTYPE DrawIndexed(_In_ UINT IndexCount, _In_ UINT StartIndexLocation, _In_ INT BaseVertexLocation) override;
+        void STDMETHODCALLTYPE Draw(_In_ UINT VertexCount, _In_ UINT StartVertexLocation) override;
+        HRESULT STDMETHODCALLTYPE Map(_In_ ID3D11Resource* pResource, _In_ UINT Subresource, _In_ D3D11_MAP MapType, _In_ UINT MapFlags, _Out_opt_ D3D11_MAPPED_SUBRESOURCE* pMappedResource) override;
+        void STDMETHODCALLTYPE Unmap(_In_ ID3D11Resource* pResource, _In_ UINT Subresource) override;
+        void STDMETHODCALLTYPE PSSetConstantBuffers(_In_ UINT StartSlot, _In_ UINT NumBuffers, _In_reads_opt_(NumBuffers) ID3D11Buffer* const* ppConstantBuffers) override;
+        void STDMETHODCALLTYPE IASetInputLayout(_In_opt_ ID3D11InputLayout* pInputLayout) override;
+        void STDMETHODCALLTYPE IASetVertexBuffers(_In_ UINT StartSlot, _In_ UINT NumBuffers, _In_reads_opt_(NumBuffers) ID3D11Buffer* const* ppVertexBuffers, _In_reads_opt_(NumBuffers) UINT const* pStrides, _In_reads_opt_(NumBuffers) UINT const* pOffsets) override;
+        void STDMETHODCALLTYPE IASetIndexBuffer(_In_opt_ ID3D11Buffer* pIndexBuffer, _In_ DXGI_FORMAT Format, _In_ UINT Offset) override;
+        void STDMETHODCALLTYPE IASetPrimitiveTopology(_In_ D3D11_PRIMITIVE_TOPOLOGY Topology) override;
+        void STDMETHODCALLTYPE OMSetBlendState(_In_opt_ ID3D11BlendState* pBlendState, _In_opt_ FLOAT const BlendFactor[4], _In_ UINT SampleMask) override;
+        void STDMETHODCALLTYPE OMSetDepthStencilState(_In_opt_ ID3D11DepthStencilState* pDepthStencilState, _In_ UINT StencilRef) override;
+        void STDMETHODCALLTYPE RSSetState(_In_opt_ ID3D11RasterizerState* pRasterizerState) override;
+        void STDMETHODCALLTYPE RSGetViewports(_Inout_ UINT* pNumViewports, _Out_writes_opt_(*pNumViewports) D3D11_VIEWPORT* pViewports) override;
+        void STDMETHODCALLTYPE CopySubresourceRegion(_In_ ID3D11Resource* pDstResource, _In_ UINT DstSubresource, _In_ UINT DstX, _In_ UINT DstY, _In_ UINT DstZ, _In_ ID3D11Resource* pSrcResource, _In_ UINT SrcSubresource, _In_opt_ D3D11_BOX const* pSrcBox) override;
+        void STDMETHODCALLTYPE CopyResource(_In_ ID3D11Resource* pDstResource, _In_ ID3D11Resource* pSrcResource) override;
+        void STDMETHODCALLTYPE UpdateSubresource(_In_ ID3D11Resource* pDstResource, _In_ UINT DstSubresource, _In_opt_ D3D11_BOX const* pDstBox, _In_ void const* pSrcData, _In_ UINT SrcRowPitch, _In_ UINT SrcDepthPitch) override;
+        void STDMETHODCALLTYPE GenerateMips(_In_ ID3D11ShaderResourceView* pShaderResourceView) override;
+        void STDMETHODCALLTYPE ResolveSubresource(_In_ ID3D11Resource* pDstResource, _In_ UINT DstSubresource, _In_ ID3D11Resource* pSrcResource, _In_ UINT SrcSubresource, _In_ DXGI_FORMAT Format) override;
+        D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE GetType() override;
+
+        D3D11_VIEWPORT viewport;
+
+    private:
+        friend class RecordingDevice;
+
+        virtual ~RecordingContext() {}
+
+        RecordingDevice* mDevice;
+        D3D11_DEVICE_CONTEXT_TYPE mType;
+        std::atomic<ULONG> mRefCount;
+
+        ContextCounters mCounters;
+        std::vector<DrawRecord>* mDrawLog;
+        std::vector<uint8_t>* mVertexLog;
+
+        void Record(UINT count, UINT start, INT baseVertex);
+        void RecordVertices(UINT count, UINT start, INT baseVertex);
+
+        // Last bound state, so redundant sets aren't counted as changes.
+        void const* mBlendState;
+        void const* mDepthStencilState;
+        void const* mRasterizerState;
+        void const* mSampler;
+        void const* mVertexShader;
+        void const* mPixelShader;
+        void const* mTexture;
+        ID3D11Buffer* mVertexBuffer;
+        UINT mVertexStride;
+        UINT mVertexOffset;
+        void const* mInputLayout;
+        ID3D11Buffer* mIndexBuffer;
+        DXGI_FORMAT mIndexFormat;
+        UINT mIndexOffset;
+        D3D11_PRIMITIVE_TOPOLOGY mTopology;
+    };
+
+
+    class RecordingDevice : public ID3D11Device
+    {
+    public:
+        explicit RecordingDevice(D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0);
+
+        RecordingDevice(RecordingDevice const&) = delete;
+        RecordingDevice& operator= (RecordingDevice const&) = delete;
+
+        RecordingContext* GetRecordingContext() { return mImmediateContext; }
+        DeviceCounters const& GetCounters() const { return mCounters; }
+
+        // Direct3D's CreateDeferredContext, which the stub ID3D11Device leaves out.
+        HRESULT CreateDeferredContext(_COM_Outptr_ ID3D11DeviceContext** ppDeferredContext);
+
+        // IUnknown
+        HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override;
+        ULONG STDMETHODCALLTYPE AddRef() override;
+        ULONG STDMETHODCALLTYPE Release() override;
+
+        // ID3D11Device
+        HRESULT STDMETHODCALLTYPE CreateBuffer(_In_ D3D11_BUFFER_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Buffer** ppBuffer) override;
+        HRESULT STDMETHODCALLTYPE CreateTexture1D(_In_ D3D11_TEXTURE1D_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Texture1D** ppTexture1D) override;
+        HRESULT STDMETHODCALLTYPE CreateTexture2D(_In_ D3D11_TEXTURE2D_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Texture2D** ppTexture2D) override;
+        HRESULT STDMETHODCALLTYPE CreateTexture3D(_In_ D3D11_TEXTURE3D_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Texture3D** ppTexture3D) override;
+        HRESULT STDMETHODCALLTYPE CreateShaderResourceView(_In_ ID3D11Resource* pResource, _In_opt_ D3D11_SHADER_RESOURCE_VIEW_DESC const* pDesc, _COM_Outptr_opt_ ID3D11ShaderResourceView** ppSRView) override;
+        HRESULT STDMETHODCALLTYPE CreateInputLayout(_In_reads_(NumElements) D3D11_INPUT_ELEMENT_DESC const* pInputElementDescs, _In_ UINT NumElements, _In_reads_(BytecodeLength) void const* pShaderBytecodeWithInputSignature, _In_ SIZE_T BytecodeLength, _COM_Outptr_opt_ ID3D11InputLayout** ppInputLayout) override;
+        HRESULT STDMETHODCALLTYPE CreateVertexShader(_In_reads_(BytecodeLength) void const* pShaderBytecode, _In_ SIZE_T BytecodeLength, _In_opt_ ID3D11ClassLinkage* pClassLinkage, _COM_Outptr_opt_ ID3D11VertexShader** ppVertexShader) override;
+        HRESULT STDMETHODCALLTYPE CreatePixelShader(_In_reads_(BytecodeLength) void const* pShaderBytecode, _In_ SIZE_T BytecodeLength, _In_opt_ ID3D11ClassLinkage* pClassLinkage, _COM_Outptr_opt_ ID3D11PixelShader** ppPixelShader) override;
+        HRESULT STDMETHODCALLTYPE CreateBlendState(_In_ D3D11_BLEND_DESC const* pBlendStateDesc, _COM_Outptr_opt_ ID3D11BlendState** ppBlendState) override;
+        HRESULT STDMETHODCALLTYPE CreateDepthStencilState(_In_ D3D11_DEPTH_STENCIL_DESC const* pDepthStencilDesc, _COM_Outptr_opt_ ID3D11DepthStencilState** ppDepthStencilState) override;
+        HRESULT STDMETHODCALLTYPE CreateRasterizerState(_In_ D3D11_RASTERIZER_DESC const* pRasterizerDesc, _COM_Outptr_opt_ ID3D11RasterizerState** ppRasterizerState) override;
+        HRESULT STDMETHODCALLTYPE CreateSamplerState(_In_ D3D11_SAMPLER_DESC const* pSamplerDesc, _COM_Outptr_opt_ ID3D11SamplerState** ppSamplerState) override;
+        HRESULT STDMETHODCALLTYPE CheckFormatSupport(_In_ DXGI_FORMAT Format, _Out_ UINT* pFormatSupport) override;
+        D3D_FEATURE_LEVEL STDMETHODCALLTYPE GetFeatureLevel() override;
+        UINT STDMETHODCALLTYPE GetCreationFlags() override;
+        void STDMETHODCALLTYPE GetImmediateContext(_Outptr_ ID3D11DeviceContext** ppImmediateContext) override;
+
+    private:
+        friend class RecordingContext;
+
+        virtual ~RecordingDevice();
+
+        D3D_FEATURE_LEVEL mFeatureLevel;
+        std::atomic<ULONG> mRefCount;
+        RecordingContext* mImmediateContext;
+
+        DeviceCounters mCounters;
+    };
+
+
+    // Creates a device at the given feature level, along with its immediate context.
+    HRESULT CreateRecordingDevice(D3D_FEATURE_LEVEL featureLevel,
+                                  _COM_Outptr_ ID3D11Device** ppDevice,
+                                  _COM_Outptr_ ID3D11DeviceContext** ppImmediateContext);
+
+    inline RecordingContext* GetRecordingContext(_In_ ID3D11DeviceContext* context)
+    {
+        return static_cast<RecordingContext*>(context);
+    }
+
+    inline RecordingDevice* GetRecordingDevice(_In_ ID3D11Device* device)
+    {
+        return static_cast<RecordingDevice*>(device);
+    }
+
+    // The contents of a mapped texture subresource, for checking what a DirectXTK class wrote.
+    HRESULT ReadSubresource(_In_ ID3D11Resource* resource, UINT subresource, std::vector<uint8_t>& data, _Out_opt_ UINT* rowPitch);
+
+
+    //--------------------------------------------------------------------------------------
+    // WIC: the encoders record the frames they are given instead of writing files.
+    //--------------------------------------------------------------------------------------
+    struct EncoderCounters
+    {
+        std::atomic<uint64_t> encoders;
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> pixelBytes;
+        std::atomic<uint64_t> conversions;
+
+        EncoderCounters() : encoders(0), frames(0), pixelBytes(0), conversions(0) {}
+    };
+
+    // The pixels an encoder was given for one file, before any format conversion.
+    struct EncodedImage
+    {
+        UINT width;
+        UINT height;
+        WICPixelFormatGUID pixelFormat;     // Format of the pixels below
+        WICPixelFormatGUID targetFormat;    // Format the frame was encoded to
+        UINT stride;
+        std::vector<uint8_t> pixels;
+    };
+
+    IWICImagingFactory* GetRecordingWIC();
+    EncoderCounters& GetEncoderCounters();
+
+    // While enabled, each committed frame is kept by file name until it is taken.
+    void KeepEncodedImages(bool enable);
+    bool TakeEncodedImage(_In_z_ const wchar_t* fileName, EncodedImage& image);
+}
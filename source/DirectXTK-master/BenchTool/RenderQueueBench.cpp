@@ -0,0 +1,634 @@
+//--------------------------------------------------------------------------------------
+// File: RenderQueueBench.cpp
+//
+// RenderQueue suite: a scene of a few hundred model instances, some culled, some with
+// alpha parts or a setCustomState hook, and more effects, input layouts and buffers than
+// fit in a byte, so every field of the sort key is exercised. The scene is submitted in
+// order and shuffled; each frame's draws are checked against the parts that should have
+// been drawn, the state bound for each of them, the sort order, and the queue's
+// Statistics against what the recording context saw. It reports parts per second and
+// state changes per frame for the queue and for drawing each instance with Model::Draw.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "CommonStates.h"
+#include "Effects.h"
+#include "Model.h"
+#include "PlatformHelpers.h"
+#include "RenderQueue.h"
+#include "VertexTypes.h"
+
+#include <map>
+#include <set>
+#include <tuple>
+
+using namespace BenchTool;
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    // Any valid shader container will do; the recording device doesn't run them.
+    #include "Shaders/Compiled/SpriteEffect_SpriteVertexShader.inc"
+    #include "Shaders/Compiled/SpriteEffect_SpritePixelShader.inc"
+
+    // Enough of each that their ids need more than eight bits of the sort key.
+    const size_t EffectCount = 300;
+    const size_t LayoutCount = 70;
+    const size_t BufferCount = 260;
+    const size_t ModelCount = 120;
+    const size_t InstanceCount = 600;
+
+
+    // Which effect was applied with which world matrix, and how many draws had been made by then.
+    struct AppliedEffect
+    {
+        size_t drawsBefore;
+        XMFLOAT3 translation;
+    };
+
+    struct EffectLog
+    {
+        std::vector<DrawRecord> const* draws;
+        std::vector<AppliedEffect> applies;
+        size_t applyCount;
+    };
+
+
+    // An effect with its own pixel shader, so the draw log shows which effect each draw used.
+    class TestEffect : public IEffect, public IEffectMatrices
+    {
+    public:
+        TestEffect(_In_ ID3D11Device* device, EffectLog& log)
+          : mLog(log)
+        {
+            XMStoreFloat4x4(&mWorld, XMMatrixIdentity());
+
+            ThrowIfFailed(device->CreatePixelShader(SpriteEffect_SpritePixelShader, sizeof(SpriteEffect_SpritePixelShader), nullptr, mPixelShader.GetAddressOf()));
+        }
+
+        void __cdecl Apply(_In_ ID3D11DeviceContext* deviceContext) override
+        {
+            deviceContext->PSSetShader(mPixelShader.Get(), nullptr, 0);
+
+            mLog.applyCount++;
+
+            if (mLog.draws)
+            {
+                AppliedEffect applied;
+                applied.drawsBefore = mLog.draws->size();
+                applied.translation = XMFLOAT3(mWorld._41, mWorld._42, mWorld._43);
+                mLog.applies.push_back(applied);
+            }
+        }
+
+        void __cdecl GetVertexShaderBytecode(_Out_ void const** pShaderByteCode, _Out_ size_t* pByteCodeLength) override
+        {
+            *pShaderByteCode = SpriteEffect_SpriteVertexShader;
+            *pByteCodeLength = sizeof(SpriteEffect_SpriteVertexShader);
+        }
+
+        void XM_CALLCONV SetWorld(FXMMATRIX value) override { XMStoreFloat4x4(&mWorld, value); }
+        void XM_CALLCONV SetView(FXMMATRIX) override {}
+        void XM_CALLCONV SetProjection(FXMMATRIX) override {}
+
+        ID3D11PixelShader* GetPixelShader() const { return mPixelShader.Get(); }
+
+    private:
+        EffectLog& mLog;
+        XMFLOAT4X4 mWorld;
+        ComPtr<ID3D11PixelShader> mPixelShader;
+    };
+
+
+    struct PartInfo
+    {
+        ModelMeshPart const* part;
+        ModelMesh const* mesh;
+        size_t sequence;        // Position of the part within its model
+    };
+
+    struct Instance
+    {
+        size_t model;
+        XMFLOAT4X4 world;
+        bool customState;
+    };
+
+
+    // A device and everything the scene's models are built from.
+    struct Scene
+    {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        std::unique_ptr<CommonStates> states;
+        ComPtr<ID3D11BlendState> customBlendState;
+
+        EffectLog log;
+        size_t hookCalls;
+
+        std::vector<std::shared_ptr<TestEffect>> effects;
+        std::vector<ComPtr<ID3D11InputLayout>> layouts;
+        std::vector<ComPtr<ID3D11Buffer>> vertexBuffers;
+        std::vector<ComPtr<ID3D11Buffer>> indexBuffers;
+
+        std::vector<std::unique_ptr<Model>> models;
+        std::vector<Instance> instances;
+
+        // Every part has its own start index, which identifies it in the draw log.
+        std::map<UINT, PartInfo> parts;
+
+        XMFLOAT4X4 view;
+        XMFLOAT4X4 projection;
+
+        explicit Scene(Random& random);
+
+        RecordingContext* GetRecording() const { return GetRecordingContext(context.Get()); }
+
+        std::function<void()> GetHook(Instance const& instance)
+        {
+            if (!instance.customState)
+                return nullptr;
+
+            return [this]()
+            {
+                context->OMSetBlendState(customBlendState.Get(), nullptr, 0xFFFFFFFF);
+                hookCalls++;
+            };
+        }
+
+    private:
+        ComPtr<ID3D11Buffer> CreateBuffer(UINT bindFlags)
+        {
+            D3D11_BUFFER_DESC desc = {};
+            desc.ByteWidth = 4096;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = bindFlags;
+
+            ComPtr<ID3D11Buffer> buffer;
+            ThrowIfFailed(device->CreateBuffer(&desc, nullptr, buffer.GetAddressOf()));
+            return buffer;
+        }
+    };
+
+
+    Scene::Scene(Random& random)
+      : hookCalls(0)
+    {
+        ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+        states = std::make_unique<CommonStates>(device.Get());
+
+        D3D11_BLEND_DESC blendDesc = {};
+        blendDesc.AlphaToCoverageEnable = TRUE;
+        ThrowIfFailed(device->CreateBlendState(&blendDesc, customBlendState.GetAddressOf()));
+
+        log.draws = nullptr;
+        log.applyCount = 0;
+
+        for (size_t i = 0; i < EffectCount; ++i)
+            effects.push_back(std::make_shared<TestEffect>(device.Get(), log));
+
+        for (size_t i = 0; i < LayoutCount; ++i)
+        {
+            ComPtr<ID3D11InputLayout> layout;
+            ThrowIfFailed(device->CreateInputLayout(VertexPositionColorTexture::InputElements, VertexPositionColorTexture::InputElementCount,
+                                                    SpriteEffect_SpriteVertexShader, sizeof(SpriteEffect_SpriteVertexShader), layout.GetAddressOf()));
+            layouts.push_back(layout);
+        }
+
+        for (size_t i = 0; i < BufferCount; ++i)
+        {
+            vertexBuffers.push_back(CreateBuffer(D3D11_BIND_VERTEX_BUFFER));
+            indexBuffers.push_back(CreateBuffer(D3D11_BIND_INDEX_BUFFER));
+        }
+
+        UINT startIndex = 0;
+
+        for (size_t m = 0; m < ModelCount; ++m)
+        {
+            auto model = std::make_unique<Model>();
+            size_t sequence = 0;
+
+            size_t meshCount = 1 + RandomIndex(random, 3);
+            for (size_t j = 0; j < meshCount; ++j)
+            {
+                auto mesh = std::make_shared<ModelMesh>();
+                mesh->ccw = RandomIndex(random, 4) != 0;
+                mesh->pmalpha = RandomIndex(random, 2) != 0;
+                mesh->boundingSphere = BoundingSphere(XMFLOAT3(0, 0, 0), 1.f);
+                mesh->boundingBox = BoundingBox(XMFLOAT3(0, 0, 0), XMFLOAT3(0.5f, 0.5f, 0.5f));
+
+                size_t partCount = 1 + RandomIndex(random, 4);
+                for (size_t k = 0; k < partCount; ++k)
+                {
+                    auto part = std::make_unique<ModelMeshPart>();
+                    part->indexCount = 3 * UINT(1 + RandomIndex(random, 100));
+                    part->startIndex = startIndex;
+                    part->vertexOffset = 0;
+                    part->vertexStride = sizeof(VertexPositionColorTexture);
+                    part->primitiveType = RandomIndex(random, 8) ? D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST : D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+                    part->indexFormat = DXGI_FORMAT_R16_UINT;
+                    part->inputLayout = layouts[RandomIndex(random, LayoutCount)];
+                    part->vertexBuffer = vertexBuffers[RandomIndex(random, BufferCount)];
+                    part->indexBuffer = indexBuffers[RandomIndex(random, BufferCount)];
+                    part->effect = effects[RandomIndex(random, EffectCount)];
+                    part->isAlpha = RandomIndex(random, 6) == 0;
+
+                    PartInfo info = { part.get(), mesh.get(), sequence++ };
+                    parts[startIndex] = info;
+
+                    startIndex += part->indexCount;
+
+                    mesh->meshParts.push_back(std::move(part));
+                }
+
+                model->meshes.push_back(mesh);
+            }
+
+            models.push_back(std::move(model));
+        }
+
+        XMStoreFloat4x4(&view, XMMatrixIdentity());
+        XMStoreFloat4x4(&projection, XMMatrixPerspectiveFovRH(XM_PIDIV4, 16.f / 9.f, 0.1f, 1000.f));
+
+        for (size_t i = 0; i < InstanceCount; ++i)
+        {
+            // Every tenth instance is behind the camera. The x offset keeps the translations
+            // unique, which is how the checks tell instances apart.
+            float z = (i % 10 == 9) ? 50.f : RandomFloat(random, -500.f, -10.f);
+            float x = RandomFloat(random, -0.3f, 0.3f) * z + float(i) * 0.001f;
+            float y = RandomFloat(random, -0.2f, 0.2f) * z;
+
+            Instance instance;
+            instance.model = RandomIndex(random, ModelCount);
+            XMStoreFloat4x4(&instance.world, XMMatrixTranslation(x, y, z));
+            instance.customState = RandomIndex(random, 12) == 0;
+
+            instances.push_back(instance);
+        }
+    }
+
+
+    void Submit(Scene& scene, RenderQueue& queue, std::vector<size_t> const& order, bool customStates)
+    {
+        queue.Begin(XMLoadFloat4x4(&scene.view), XMLoadFloat4x4(&scene.projection));
+
+        for (auto i : order)
+        {
+            auto const& instance = scene.instances[i];
+            auto world = XMLoadFloat4x4(&instance.world);
+
+            if (customStates)
+                queue.Enqueue(*scene.models[instance.model], world, scene.GetHook(instance));
+            else
+                queue.Enqueue(*scene.models[instance.model], world);
+        }
+
+        queue.End(scene.context.Get(), *scene.states);
+    }
+
+
+    // What a frame drew that shouldn't depend on the order the scene was submitted in.
+    struct FrameResult
+    {
+        RenderQueue::Statistics stats;
+        std::set<std::pair<void const*, void const*>> effectGroups;     // Rasterizer and pixel shader of the plain opaque parts
+        size_t effectRuns;
+    };
+
+
+    // Checks one frame's draws, state and Statistics.
+    FrameResult CheckFrame(Bench& bench, Scene& scene, RenderQueue& queue, std::vector<size_t> const& order, bool customStates, const char* name)
+    {
+        auto recording = scene.GetRecording();
+
+        std::vector<DrawRecord> draws;
+
+        recording->ClearState();
+        recording->ResetCounters();
+        recording->SetDrawLog(&draws);
+        scene.log.draws = &draws;
+        scene.log.applies.clear();
+        scene.log.applyCount = 0;
+        scene.hookCalls = 0;
+
+        Submit(scene, queue, order, customStates);
+
+        recording->SetDrawLog(nullptr);
+        scene.log.draws = nullptr;
+
+        FrameResult result;
+        result.stats = queue.GetStatistics();
+        result.effectRuns = 0;
+
+        auto const& stats = result.stats;
+        auto const& counters = recording->GetCounters();
+
+        // What should have been drawn: each part of each visible mesh, once per instance.
+        BoundingFrustum frustum;
+        Model::CreateViewFrustum(frustum, XMLoadFloat4x4(&scene.projection));
+
+        std::set<std::pair<UINT, size_t>> expected;
+        std::map<std::tuple<float, float, float>, size_t> instanceByTranslation;
+        uint32_t expectedCulled = 0;
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            auto const& instance = scene.instances[order[i]];
+            instanceByTranslation[std::make_tuple(instance.world._41, instance.world._42, instance.world._43)] = i;
+
+            XMMATRIX worldView = XMMatrixMultiply(XMLoadFloat4x4(&instance.world), XMLoadFloat4x4(&scene.view));
+
+            for (auto const& mesh : scene.models[instance.model]->meshes)
+            {
+                if (!mesh->IsVisible(worldView, frustum))
+                {
+                    expectedCulled++;
+                    continue;
+                }
+
+                for (auto const& part : mesh->meshParts)
+                    expected.emplace(part->startIndex, i);
+            }
+        }
+
+        bench.Check(expectedCulled > 0 && stats.meshesCulled == expectedCulled, "%s: culled %u meshes, expected %u", name, stats.meshesCulled, expectedCulled);
+        bench.Check(stats.partsQueued == expected.size(), "%s: queued %u parts, expected %zu", name, stats.partsQueued, expected.size());
+        bench.Check(stats.drawCalls == counters.drawCalls && draws.size() == expected.size(),
+                    "%s: counted %u draw calls, the context saw %llu, expected %zu", name, stats.drawCalls, static_cast<unsigned long long>(counters.drawCalls), expected.size());
+        bench.Check(stats.effectApplies == scene.log.applyCount, "%s: counted %u effect applies, the effects saw %zu", name, stats.effectApplies, scene.log.applyCount);
+        bench.Check(stats.customStateCalls == scene.hookCalls, "%s: counted %u setCustomState calls, the hooks saw %zu", name, stats.customStateCalls, scene.hookCalls);
+        // Every set call the context saw was counted by the queue, or made by an effect, a hook,
+        // or the queue's one call to set the samplers.
+        uint64_t contextSets = counters.stateChanges + counters.shaderChanges + counters.inputLayoutChanges + counters.vertexBufferChanges
+                             + counters.indexBufferChanges + counters.topologyChanges + counters.redundantSets;
+        uint64_t expectedSets = uint64_t(stats.StateChanges()) + stats.effectApplies + scene.hookCalls + 1;
+        bench.Check(contextSets == expectedSets, "%s: the context saw %llu set calls, expected %llu", name,
+                    static_cast<unsigned long long>(contextSets), static_cast<unsigned long long>(expectedSets));
+
+        // A hook may change anything, so the queue sets everything again after it, and some of those
+        // sets rebind what is already bound. Without hooks each counted change is a real one, and
+        // the only redundant sets are effects setting their shader again for another instance.
+        if (!customStates)
+        {
+            bench.Check(stats.inputLayoutChanges == counters.inputLayoutChanges
+                        && stats.vertexBufferChanges == counters.vertexBufferChanges
+                        && stats.indexBufferChanges == counters.indexBufferChanges
+                        && stats.topologyChanges == counters.topologyChanges,
+                        "%s: counted %u/%u/%u/%u layout/vertex buffer/index buffer/topology changes, the context saw %llu/%llu/%llu/%llu", name,
+                        stats.inputLayoutChanges, stats.vertexBufferChanges, stats.indexBufferChanges, stats.topologyChanges,
+                        static_cast<unsigned long long>(counters.inputLayoutChanges), static_cast<unsigned long long>(counters.vertexBufferChanges),
+                        static_cast<unsigned long long>(counters.indexBufferChanges), static_cast<unsigned long long>(counters.topologyChanges));
+
+            uint64_t expectedStateChanges = uint64_t(stats.blendStateChanges) + stats.depthStencilStateChanges + stats.rasterizerStateChanges + 1;
+            bench.Check(counters.stateChanges == expectedStateChanges, "%s: the context saw %llu state changes, expected %llu", name,
+                        static_cast<unsigned long long>(counters.stateChanges), static_cast<unsigned long long>(expectedStateChanges));
+
+            uint64_t effectRedundant = stats.effectApplies - counters.shaderChanges;
+            bench.Check(counters.redundantSets == effectRedundant, "%s: %llu redundant state sets", name,
+                        static_cast<unsigned long long>(counters.redundantSets - effectRedundant));
+        }
+
+        // Walk the draws in order.
+        std::set<std::pair<UINT, size_t>> drawn;
+        size_t apply = 0;
+        int lastSection = 0;
+        bool alphaDrawn = false;
+        std::pair<size_t, size_t> lastAlpha(0, 0);
+
+        // Each level of the opaque sort (rasterizer and effect, then layout, vertex buffer,
+        // index buffer) must form one contiguous run per value.
+        const size_t Levels = 4;
+        std::set<std::vector<void const*>> closed[Levels];
+        std::vector<void const*> current[Levels];
+
+        for (size_t d = 0; d < draws.size(); ++d)
+        {
+            auto const& draw = draws[d];
+
+            auto it = scene.parts.find(draw.start);
+            if (!bench.Check(it != scene.parts.end(), "%s: draw %zu starts at index %u, which is no part's", name, d, draw.start))
+                return result;
+
+            auto part = it->second.part;
+            auto mesh = it->second.mesh;
+
+            while (apply + 1 < scene.log.applies.size() && scene.log.applies[apply + 1].drawsBefore <= d)
+                ++apply;
+
+            if (!bench.Check(apply < scene.log.applies.size() && scene.log.applies[apply].drawsBefore <= d, "%s: draw %zu made before any effect was applied", name, d))
+                return result;
+
+            auto const& t = scene.log.applies[apply].translation;
+            auto instance = instanceByTranslation.find(std::make_tuple(t.x, t.y, t.z));
+            if (!bench.Check(instance != instanceByTranslation.end(), "%s: draw %zu used a world matrix no instance has", name, d))
+                return result;
+
+            auto key = std::make_pair(draw.start, instance->second);
+            if (!bench.Check(expected.count(key) == 1 && drawn.insert(key).second, "%s: draw %zu drew a part that was culled or already drawn", name, d))
+                return result;
+
+            bool customState = customStates && scene.instances[order[instance->second]].customState;
+
+            // The hook runs after the queue has set the blend state, alpha parts included.
+            ID3D11BlendState* blendState;
+            if (customState)
+                blendState = scene.customBlendState.Get();
+            else if (part->isAlpha)
+                blendState = mesh->pmalpha ? scene.states->AlphaBlend() : scene.states->NonPremultiplied();
+            else
+                blendState = scene.states->Opaque();
+
+            auto depthStencilState = part->isAlpha ? scene.states->DepthRead() : scene.states->DepthDefault();
+            auto rasterizerState = mesh->ccw ? scene.states->CullCounterClockwise() : scene.states->CullClockwise();
+            auto pixelShader = static_cast<TestEffect*>(part->effect.get())->GetPixelShader();
+
+            if (!bench.Check(draw.blendState == blendState && draw.depthStencilState == depthStencilState && draw.rasterizerState == rasterizerState
+                             && draw.inputLayout == part->inputLayout.Get() && draw.vertexBuffer == part->vertexBuffer.Get()
+                             && draw.indexBuffer == part->indexBuffer.Get() && draw.pixelShader == pixelShader
+                             && draw.topology == part->primitiveType && draw.count == part->indexCount,
+                             "%s: draw %zu was made with state that isn't its part's", name, d))
+                return result;
+
+            // Opaque parts, then those with a hook, then alpha parts.
+            int section = part->isAlpha ? 2 : (customState ? 1 : 0);
+            if (!bench.Check(section >= lastSection, "%s: draw %zu is out of order: %s after %s", name, d,
+                             section == 0 ? "an opaque part" : "a part with a hook", lastSection == 2 ? "alpha parts" : "parts with a hook"))
+                return result;
+
+            lastSection = section;
+
+            if (section == 2)
+            {
+                // Alpha parts keep their submission order.
+                std::pair<size_t, size_t> position(instance->second, it->second.sequence);
+                if (!bench.Check(!alphaDrawn || position > lastAlpha, "%s: alpha draw %zu is out of submission order", name, d))
+                    return result;
+
+                lastAlpha = position;
+                alphaDrawn = true;
+            }
+            else if (section == 0)
+            {
+                result.effectGroups.emplace(draw.rasterizerState, draw.pixelShader);
+
+                std::vector<void const*> fields = { draw.rasterizerState, draw.pixelShader, draw.inputLayout, draw.vertexBuffer, draw.indexBuffer };
+
+                for (size_t level = 0; level < Levels; ++level)
+                {
+                    std::vector<void const*> prefix(fields.begin(), fields.begin() + level + 2);
+
+                    // A new run must not be one that has been seen before.
+                    if (prefix != current[level])
+                    {
+                        if (level == 0)
+                            result.effectRuns++;
+
+                        if (!current[level].empty())
+                            closed[level].insert(current[level]);
+
+                        if (!bench.Check(closed[level].count(prefix) == 0, "%s: draw %zu splits a run of sort level %zu", name, d, level))
+                            return result;
+
+                        current[level] = prefix;
+                    }
+                }
+            }
+        }
+
+        bench.Check(drawn.size() == expected.size(), "%s: drew %zu of %zu parts", name, drawn.size(), expected.size());
+        bench.Check(result.effectRuns == result.effectGroups.size(), "%s: %zu runs of opaque draws for %zu effects", name, result.effectRuns, result.effectGroups.size());
+
+        return result;
+    }
+
+
+    void CheckScene(Bench& bench, Scene& scene)
+    {
+        RenderQueue queue;
+
+        std::vector<size_t> inOrder(scene.instances.size());
+        for (size_t i = 0; i < inOrder.size(); ++i)
+            inOrder[i] = i;
+
+        Random random(27);
+        std::vector<size_t> shuffled = inOrder;
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+        for (int customStates = 0; customStates < 2; ++customStates)
+        {
+            auto a = CheckFrame(bench, scene, queue, inOrder, customStates != 0, customStates ? "renderqueue in order, hooks" : "renderqueue in order");
+            auto b = CheckFrame(bench, scene, queue, shuffled, customStates != 0, customStates ? "renderqueue shuffled, hooks" : "renderqueue shuffled");
+
+            // Submission order changes which instances share an effect apply and the order of
+            // the alpha parts, but not what is drawn or how the opaque parts are grouped.
+            bench.Check(a.stats.partsQueued == b.stats.partsQueued && a.stats.meshesCulled == b.stats.meshesCulled
+                        && a.stats.drawCalls == b.stats.drawCalls && a.stats.customStateCalls == b.stats.customStateCalls
+                        && a.effectGroups == b.effectGroups && a.effectRuns == b.effectRuns,
+                        "renderqueue: shuffling the scene changed its Statistics (%u/%u parts, %u/%u draws, %u/%u hook calls, %zu/%zu opaque effect runs)",
+                        a.stats.partsQueued, b.stats.partsQueued, a.stats.drawCalls, b.stats.drawCalls,
+                        a.stats.customStateCalls, b.stats.customStateCalls, a.effectRuns, b.effectRuns);
+        }
+    }
+
+
+    void ReportCounters(Bench& bench, ContextCounters const& counters, size_t frames)
+    {
+        uint64_t changes = counters.stateChanges + counters.shaderChanges + counters.inputLayoutChanges
+                         + counters.vertexBufferChanges + counters.indexBufferChanges + counters.topologyChanges;
+
+        bench.Report("state changes per frame", double(changes) / double(frames), "");
+        bench.Report("state sets per frame", double(changes + counters.redundantSets) / double(frames), "");
+        bench.Report("draw calls per frame", double(counters.drawCalls) / double(frames), "");
+    }
+
+
+    void TimeScene(Bench& bench, Scene& scene)
+    {
+        size_t frames = bench.Scaled(200);
+
+        std::vector<size_t> order(scene.instances.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+
+        Random random(270);
+        std::shuffle(order.begin(), order.end(), random);
+
+        auto recording = scene.GetRecording();
+        auto view = XMLoadFloat4x4(&scene.view);
+        auto projection = XMLoadFloat4x4(&scene.projection);
+
+        bench.Section("renderqueue: RenderQueue, sorted and filtered");
+        {
+            RenderQueue queue;
+            uint64_t parts = 0;
+
+            recording->ClearState();
+            recording->ResetCounters();
+
+            Timer timer;
+
+            for (size_t frame = 0; frame < frames; ++frame)
+            {
+                Submit(scene, queue, order, true);
+                parts += queue.GetStatistics().drawCalls;
+            }
+
+            double seconds = timer.GetSeconds();
+
+            bench.Report("parts per second", double(parts) / std::max(seconds, 1e-9), "");
+            bench.Report("time per frame", seconds * 1000.0 / double(frames), "ms");
+            ReportCounters(bench, recording->GetCounters(), frames);
+        }
+
+        bench.Section("renderqueue: Model::Draw for each instance");
+        {
+            uint64_t parts = 0;
+
+            recording->ClearState();
+            recording->ResetCounters();
+
+            Timer timer;
+
+            for (size_t frame = 0; frame < frames; ++frame)
+            {
+                for (auto i : order)
+                {
+                    auto const& instance = scene.instances[i];
+                    scene.models[instance.model]->Draw(scene.context.Get(), *scene.states, XMLoadFloat4x4(&instance.world), view, projection, false, scene.GetHook(instance));
+                }
+            }
+
+            double seconds = timer.GetSeconds();
+            parts = recording->GetCounters().drawCalls;
+
+            bench.Report("parts per second", double(parts) / std::max(seconds, 1e-9), "");
+            bench.Report("time per frame", seconds * 1000.0 / double(frames), "ms");
+            ReportCounters(bench, recording->GetCounters(), frames);
+        }
+    }
+}
+
+
+void BenchTool::RenderQueueSorting(Bench& bench)
+{
+    Random random(2027);
+    Scene scene(random);
+
+    CheckScene(bench, scene);
+    TimeScene(bench, scene);
+}
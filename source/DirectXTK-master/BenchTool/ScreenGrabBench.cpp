@@ -0,0 +1,408 @@
+//--------------------------------------------------------------------------------------
+// File: ScreenGrabBench.cpp
+//
+// ScreenGrabQueue suite: fifty synthetic images of several formats and row pitches
+// queued with EncodeDDS and EncodeWIC, and frame sequences captured from an 8x MSAA back
+// buffer whose contents change every frame. Every .dds file is loaded back with
+// DDSTextureLoader and every WIC frame is taken from the recording encoders, and each is
+// compared with the pixels that were queued. It then reports the render thread's time per
+// capture for a sequence against SaveWICTextureToFile. The recording encoders only copy
+// pixels, so that time is the copying the queue leaves on the render thread, without the
+// compression a real encoder would add to the synchronous call.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "DDSTextureLoader.h"
+#include "PlatformHelpers.h"
+#include "LoaderHelpers.h"
+#include "ScreenGrab.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996)
+#endif
+
+using namespace BenchTool;
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    const size_t ImageCount = 50;
+    const UINT SequenceFrames = 30;
+
+    struct ImageFormat
+    {
+        DXGI_FORMAT format;
+        WICPixelFormatGUID const* wicFormat;
+    };
+
+    // Formats both writers support, with the WIC format ScreenGrab hands the encoder for each.
+    const ImageFormat ImageFormats[] =
+    {
+        { DXGI_FORMAT_R8G8B8A8_UNORM,       &GUID_WICPixelFormat32bppRGBA },
+        { DXGI_FORMAT_B8G8R8A8_UNORM,       &GUID_WICPixelFormat32bppBGRA },
+        { DXGI_FORMAT_R16G16B16A16_FLOAT,   &GUID_WICPixelFormat64bppRGBAHalf },
+        { DXGI_FORMAT_R10G10B10A2_UNORM,    &GUID_WICPixelFormat32bppRGBA1010102 },
+        { DXGI_FORMAT_B5G6R5_UNORM,         &GUID_WICPixelFormat16bppBGR565 },
+        { DXGI_FORMAT_R32_FLOAT,            &GUID_WICPixelFormat32bppGrayFloat },
+        { DXGI_FORMAT_R8_UNORM,             &GUID_WICPixelFormat8bppGray },
+    };
+
+    GUID const* const Containers[] =
+    {
+        &GUID_ContainerFormatPng,
+        &GUID_ContainerFormatBmp,
+        &GUID_ContainerFormatJpeg,
+        &GUID_ContainerFormatTiff,
+    };
+
+
+    // Files go to the temporary directory and are deleted once checked.
+    std::wstring GetFilePath(const wchar_t* name)
+    {
+        const char* names[] = { "TMPDIR", "TEMP", "TMP" };
+
+        std::string dir = ".";
+        for (auto var : names)
+        {
+            auto value = getenv(var);
+            if (value && *value)
+            {
+                dir = value;
+                break;
+            }
+        }
+
+        std::wstring path(dir.begin(), dir.end());
+        path += L'/';
+        path += name;
+        return path;
+    }
+
+
+    // A synthetic image: rows of rowPitch bytes, of which the first width * bytesPerPixel are pixels.
+    struct Image
+    {
+        DXGI_FORMAT format;
+        UINT width;
+        UINT height;
+        size_t rowBytes;
+        size_t rowPitch;
+        std::vector<uint8_t> pixels;
+
+        Image(DXGI_FORMAT format_, UINT width_, UINT height_, size_t padding, uint32_t seed)
+          : format(format_), width(width_), height(height_)
+        {
+            rowBytes = width * LoaderHelpers::BitsPerPixel(format) / 8;
+            rowPitch = rowBytes + padding;
+            pixels.resize(rowPitch * height);
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < rowPitch; ++x)
+                {
+                    // Padding gets a value no pixel has, so a writer that keeps it is caught.
+                    pixels[y * rowPitch + x] = (x < rowBytes) ? uint8_t((x * 7 + y * 13 + seed * 29) % 251) : 0xFF;
+                }
+            }
+        }
+
+        // Compares the pixels with rows of another pitch.
+        bool Matches(uint8_t const* data, size_t dataPitch, size_t dataSize) const
+        {
+            if (dataPitch < rowBytes || dataSize < dataPitch * (height - 1) + rowBytes)
+                return false;
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                if (memcmp(&pixels[y * rowPitch], data + y * dataPitch, rowBytes) != 0)
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+
+    // Loads a .dds file back, compares it with the image, and deletes it.
+    bool CheckDDSFile(Bench& bench, _In_ ID3D11Device* device, std::wstring const& fileName, Image const& image, const char* what)
+    {
+        ComPtr<ID3D11Resource> resource;
+        HRESULT hr = CreateDDSTextureFromFile(device, fileName.c_str(), resource.GetAddressOf(), nullptr);
+
+        DeleteFileW(fileName.c_str());
+
+        if (!bench.Check(SUCCEEDED(hr), "%s: loading %ls failed (%08X)", what, fileName.c_str(), static_cast<unsigned int>(hr)))
+            return false;
+
+        ComPtr<ID3D11Texture2D> texture;
+        D3D11_TEXTURE2D_DESC desc = {};
+        if (SUCCEEDED(resource.As(&texture)))
+            texture->GetDesc(&desc);
+
+        if (!bench.Check(desc.Width == image.width && desc.Height == image.height && desc.Format == image.format,
+                         "%s: %ls is %ux%u format %d, expected %ux%u format %d", what, fileName.c_str(),
+                         desc.Width, desc.Height, desc.Format, image.width, image.height, image.format))
+            return false;
+
+        std::vector<uint8_t> data;
+        UINT rowPitch = 0;
+        ThrowIfFailed(ReadSubresource(resource.Get(), 0, data, &rowPitch));
+
+        return bench.Check(image.Matches(data.data(), rowPitch, data.size()), "%s: %ls doesn't hold the queued pixels", what, fileName.c_str());
+    }
+
+
+    // Takes the frame the recording encoders were given for a file and compares it with the image.
+    bool CheckWICFile(Bench& bench, std::wstring const& fileName, Image const& image, WICPixelFormatGUID const& wicFormat, const char* what)
+    {
+        EncodedImage encoded;
+        if (!bench.Check(TakeEncodedImage(fileName.c_str(), encoded), "%s: nothing was encoded to %ls", what, fileName.c_str()))
+            return false;
+
+        if (!bench.Check(encoded.width == image.width && encoded.height == image.height && encoded.pixelFormat == wicFormat,
+                         "%s: %ls was encoded as %ux%u in the wrong format", what, fileName.c_str(), encoded.width, encoded.height))
+            return false;
+
+        return bench.Check(image.Matches(encoded.pixels.data(), encoded.stride, encoded.pixels.size()), "%s: %ls doesn't hold the queued pixels", what, fileName.c_str());
+    }
+
+
+    WICPixelFormatGUID const& GetWICFormat(DXGI_FORMAT format)
+    {
+        for (auto const& entry : ImageFormats)
+        {
+            if (entry.format == format)
+                return *entry.wicFormat;
+        }
+
+        throw std::exception("GetWICFormat");
+    }
+
+
+    void CheckEncodes(Bench& bench, _In_ ID3D11Device* device)
+    {
+        bench.Section("screengrab: EncodeDDS and EncodeWIC, 50 synthetic images");
+
+        Random random(37);
+        std::vector<Image> images;
+        std::vector<std::wstring> fileNames;
+
+        for (size_t i = 0; i < ImageCount; ++i)
+        {
+            auto format = ImageFormats[i % _countof(ImageFormats)].format;
+            UINT width = 1 + UINT(RandomIndex(random, 300));
+            UINT height = 1 + UINT(RandomIndex(random, 200));
+            size_t padding = RandomIndex(random, 3) * 16;
+
+            images.emplace_back(format, width, height, padding, uint32_t(i));
+
+            wchar_t name[64] = {};
+            swprintf_s(name, L"screengrab_bench_%02zu.%ls", i, (i & 1) ? L"img" : L"dds");
+            fileNames.push_back(GetFilePath(name));
+        }
+
+        KeepEncodedImages(true);
+
+        HRESULT hr = S_OK;
+        Timer timer;
+        {
+            ScreenGrabQueue queue(3, 4);
+
+            for (size_t i = 0; i < ImageCount && SUCCEEDED(hr); ++i)
+            {
+                auto const& image = images[i];
+
+                if (i & 1)
+                    hr = queue.EncodeWIC(image.format, image.width, image.height, image.pixels.data(), image.rowPitch, *Containers[(i / 2) % _countof(Containers)], fileNames[i].c_str());
+                else
+                    hr = queue.EncodeDDS(image.format, image.width, image.height, image.pixels.data(), image.rowPitch, fileNames[i].c_str());
+            }
+
+            if (SUCCEEDED(hr))
+                hr = queue.Flush(nullptr);
+        }
+        double seconds = timer.GetSeconds();
+
+        if (bench.Check(SUCCEEDED(hr), "screengrab: queueing the images failed (%08X)", static_cast<unsigned int>(hr)))
+        {
+            size_t good = 0;
+            for (size_t i = 0; i < ImageCount; ++i)
+            {
+                bool ok = (i & 1)
+                    ? CheckWICFile(bench, fileNames[i], images[i], GetWICFormat(images[i].format), "screengrab encode")
+                    : CheckDDSFile(bench, device, fileNames[i], images[i], "screengrab encode");
+
+                if (ok)
+                    ++good;
+            }
+
+            bench.Report("images written as queued", double(good), "");
+        }
+        else
+        {
+            for (auto const& fileName : fileNames)
+                DeleteFileW(fileName.c_str());
+        }
+
+        KeepEncodedImages(false);
+
+        bench.Report("images per second", double(ImageCount) / std::max(seconds, 1e-9), "");
+    }
+
+
+    ComPtr<ID3D11Texture2D> CreateBackBuffer(_In_ ID3D11Device* device, DXGI_FORMAT format, UINT width, UINT height, UINT sampleCount)
+    {
+        CD3D11_TEXTURE2D_DESC desc(format, width, height, 1, 1, D3D11_BIND_RENDER_TARGET);
+        desc.SampleDesc.Count = sampleCount;
+
+        ComPtr<ID3D11Texture2D> texture;
+        ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf()));
+        return texture;
+    }
+
+
+    // Records a sequence from an 8x MSAA back buffer that is redrawn every frame, then checks
+    // that each numbered file holds the frame it is named after.
+    void CheckSequence(Bench& bench, _In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context, _In_opt_ GUID const* container)
+    {
+        const UINT width = 160;
+        const UINT height = 90;
+        const DXGI_FORMAT format = DXGI_FORMAT_B8G8R8A8_UNORM;
+
+        auto backBuffer = CreateBackBuffer(device, format, width, height, 8);
+
+        std::vector<Image> frames;
+        for (UINT frame = 0; frame < SequenceFrames; ++frame)
+            frames.emplace_back(format, width, height, 0, 1000 + frame);
+
+        auto prefix = GetFilePath(container ? L"screengrab_bench_seq_png_" : L"screengrab_bench_seq_dds_");
+        const char* what = container ? "screengrab sequence (PNG)" : "screengrab sequence (DDS)";
+
+        KeepEncodedImages(true);
+
+        HRESULT hr = S_OK;
+        {
+            ScreenGrabQueue queue(3, 2);
+            queue.BeginSequence(prefix.c_str(), container);
+
+            for (UINT frame = 0; frame < SequenceFrames && SUCCEEDED(hr); ++frame)
+            {
+                context->UpdateSubresource(backBuffer.Get(), 0, nullptr, frames[frame].pixels.data(), UINT(frames[frame].rowPitch), 0);
+
+                hr = queue.CaptureFrame(context, backBuffer.Get());
+
+                queue.Update(context);
+            }
+
+            queue.EndSequence();
+
+            HRESULT hrFlush = queue.Flush(context);
+            if (SUCCEEDED(hr))
+                hr = hrFlush;
+        }
+
+        bench.Check(SUCCEEDED(hr), "%s: recording failed (%08X)", what, static_cast<unsigned int>(hr));
+
+        for (UINT frame = 0; frame < SequenceFrames; ++frame)
+        {
+            wchar_t number[16] = {};
+            swprintf_s(number, L"%05u", frame);
+            auto fileName = prefix + number + (container ? L".png" : L".dds");
+
+            if (container)
+                CheckWICFile(bench, fileName, frames[frame], GUID_WICPixelFormat32bppBGRA, what);
+            else
+                CheckDDSFile(bench, device, fileName, frames[frame], what);
+        }
+
+        KeepEncodedImages(false);
+    }
+
+
+    void TimeCaptures(Bench& bench, _In_ ID3D11Device* device, _In_ ID3D11DeviceContext* context)
+    {
+        size_t frames = bench.Scaled(120);
+
+        auto backBuffer = CreateBackBuffer(device, DXGI_FORMAT_B8G8R8A8_UNORM, 1280, 720, 1);
+        auto fileName = GetFilePath(L"screengrab_bench_timing.png");
+
+        bench.Section("screengrab: 1280x720 PNG sequence through ScreenGrabQueue");
+        {
+            double renderSeconds = 0;
+            HRESULT hr = S_OK;
+
+            Timer total;
+            {
+                ScreenGrabQueue queue;
+                queue.BeginSequence(fileName.c_str(), &GUID_ContainerFormatPng);
+
+                for (size_t frame = 0; frame < frames; ++frame)
+                {
+                    Timer timer;
+                    HRESULT hrCapture = queue.CaptureFrame(context, backBuffer.Get());
+                    queue.Update(context);
+                    renderSeconds += timer.GetSeconds();
+
+                    if (FAILED(hrCapture) && SUCCEEDED(hr))
+                        hr = hrCapture;
+                }
+
+                queue.EndSequence();
+
+                HRESULT hrFlush = queue.Flush(context);
+                if (SUCCEEDED(hr))
+                    hr = hrFlush;
+            }
+            double seconds = total.GetSeconds();
+
+            bench.Check(SUCCEEDED(hr), "screengrab: timed sequence failed (%08X)", static_cast<unsigned int>(hr));
+            bench.Report("render thread time per capture", renderSeconds * 1000.0 / double(frames), "ms");
+            bench.Report("captures per second, encoding included", double(frames) / std::max(seconds, 1e-9), "");
+        }
+
+        bench.Section("screengrab: 1280x720 PNG through SaveWICTextureToFile");
+        {
+            HRESULT hr = S_OK;
+
+            Timer timer;
+            for (size_t frame = 0; frame < frames && SUCCEEDED(hr); ++frame)
+            {
+                hr = SaveWICTextureToFile(context, backBuffer.Get(), GUID_ContainerFormatPng, fileName.c_str());
+            }
+            double seconds = timer.GetSeconds();
+
+            bench.Check(SUCCEEDED(hr), "screengrab: SaveWICTextureToFile failed (%08X)", static_cast<unsigned int>(hr));
+            bench.Report("render thread time per capture", seconds * 1000.0 / double(frames), "ms");
+        }
+    }
+}
+
+
+void BenchTool::ScreenGrabQueueing(Bench& bench)
+{
+    ComPtr<ID3D11Device> device;
+    ComPtr<ID3D11DeviceContext> context;
+    ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+    CheckEncodes(bench, device.Get());
+
+    bench.Section("screengrab: 30-frame sequences from an 8x MSAA back buffer");
+    CheckSequence(bench, device.Get(), context.Get(), nullptr);
+    CheckSequence(bench, device.Get(), context.Get(), &GUID_ContainerFormatPng);
+
+    TimeCaptures(bench, device.Get(), context.Get());
+}
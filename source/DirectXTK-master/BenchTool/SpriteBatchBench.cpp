@@ -0,0 +1,586 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteBatchBench.cpp
+//
+// SpriteBatch suites: frames shaped like a game's (a HUD, a tile map, particles, a UI that
+// switches textures), stress runs far beyond them (a million sprites, every sort mode,
+// recorders on several threads), and a static overlay kept in a layer against redrawing
+// it. Each reports sprites per second, batches and draw calls per frame and the vertex
+// bytes written to mapped buffers or uploaded, and checks the batch's Statistics against
+// what the recording context was actually asked to do.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "CommonStates.h"
+#include "PlatformHelpers.h"
+#include "SpriteBatch.h"
+#include "VertexTypes.h"
+
+using namespace BenchTool;
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    ComPtr<ID3D11ShaderResourceView> CreateTexture(_In_ ID3D11Device* device, UINT width, UINT height)
+    {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = width;
+        desc.Height = height;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        ComPtr<ID3D11Texture2D> texture;
+        ComPtr<ID3D11ShaderResourceView> view;
+
+        ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf()));
+        ThrowIfFailed(device->CreateShaderResourceView(texture.Get(), nullptr, view.GetAddressOf()));
+
+        return view;
+    }
+
+
+    // A device, a batch on its immediate context, and the textures a scenario draws with.
+    struct SpriteTarget
+    {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        std::unique_ptr<SpriteBatch> batch;
+        std::unique_ptr<CommonStates> states;
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textures;
+
+        SpriteTarget(size_t textureCount, UINT textureSize)
+        {
+            ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+            batch = std::make_unique<SpriteBatch>(context.Get());
+            states = std::make_unique<CommonStates>(device.Get());
+
+            for (size_t i = 0; i < textureCount; ++i)
+                textures.push_back(CreateTexture(device.Get(), textureSize, textureSize));
+        }
+
+        RecordingContext* GetRecording() const { return GetRecordingContext(context.Get()); }
+    };
+
+
+    // What one scenario did over all its frames.
+    struct FrameTotals
+    {
+        uint64_t sprites;
+        uint64_t batches;
+        uint64_t drawCalls;
+        uint64_t vertexBytes;
+        uint64_t maps;
+        double seconds;
+    };
+
+
+    // Vertex bytes for sprites drawn through the mapped vertex buffer.
+    uint64_t SpriteBytes(size_t sprites)
+    {
+        return uint64_t(sprites) * 4 * sizeof(VertexPositionColorTexture);
+    }
+
+
+    // Runs the frame function the given number of times, checking each frame's Statistics against the recording.
+    template<typename TFrame>
+    FrameTotals RunFrames(Bench& bench, SpriteTarget& target, const char* name, size_t frames, size_t expectedSprites, uint64_t expectedVertexBytes, TFrame frame)
+    {
+        FrameTotals totals = {};
+        auto recording = target.GetRecording();
+
+        for (size_t i = 0; i < frames; ++i)
+        {
+            recording->ResetCounters();
+
+            Timer timer;
+            frame(i);
+            totals.seconds += timer.GetSeconds();
+
+            auto& stats = target.batch->GetStatistics();
+            auto& counters = recording->GetCounters();
+
+            totals.sprites += stats.sprites;
+            totals.batches += stats.batches;
+            totals.drawCalls += stats.drawCalls;
+            totals.vertexBytes += stats.vertexBytes;
+            totals.maps += counters.maps;
+
+            if (!bench.Check(stats.sprites == expectedSprites, "%s: frame %zu counted %u sprites, %zu were drawn", name, i, stats.sprites, expectedSprites)
+                || !bench.Check(stats.drawCalls == counters.drawCalls, "%s: frame %zu counted %u draw calls, the context saw %llu", name, i, stats.drawCalls, static_cast<unsigned long long>(counters.drawCalls))
+                || !bench.Check(counters.indicesDrawn == uint64_t(expectedSprites) * 6, "%s: frame %zu drew %llu indices for %zu sprites", name, i, static_cast<unsigned long long>(counters.indicesDrawn), expectedSprites)
+                || !bench.Check(stats.vertexBytes == expectedVertexBytes, "%s: frame %zu wrote %u vertex bytes, expected %llu", name, i, stats.vertexBytes, static_cast<unsigned long long>(expectedVertexBytes))
+                || !bench.Check(stats.batches <= stats.drawCalls, "%s: frame %zu counted %u batches in %u draw calls", name, i, stats.batches, stats.drawCalls))
+            {
+                break;
+            }
+        }
+
+        return totals;
+    }
+
+    template<typename TFrame>
+    FrameTotals RunFrames(Bench& bench, SpriteTarget& target, const char* name, size_t frames, size_t expectedSprites, TFrame frame)
+    {
+        return RunFrames(bench, target, name, frames, expectedSprites, SpriteBytes(expectedSprites), frame);
+    }
+
+
+    void ReportFrames(Bench& bench, FrameTotals const& totals, size_t frames)
+    {
+        bench.Report("sprites per second", double(totals.sprites) / std::max(totals.seconds, 1e-9), "");
+        bench.Report("time per frame", totals.seconds * 1000.0 / double(frames), "ms");
+        bench.Report("batches per frame", double(totals.batches) / double(frames), "");
+        bench.Report("draw calls per frame", double(totals.drawCalls) / double(frames), "");
+        bench.Report("maps per frame", double(totals.maps) / double(frames), "");
+        bench.Report("vertex bytes mapped or uploaded per frame", double(totals.vertexBytes) / double(frames), "bytes");
+    }
+
+
+    struct Sprite
+    {
+        XMFLOAT2 position;
+        RECT source;
+        XMFLOAT4 color;
+        float rotation;
+        float scale;
+        float depth;
+        size_t texture;
+    };
+
+    // Sprites scattered over a 1920x1080 screen, cut from random cells of a texture divided into a grid.
+    std::vector<Sprite> ScatterSprites(Random& random, size_t count, size_t textureCount, LONG cellSize, LONG cellsAcross)
+    {
+        std::vector<Sprite> sprites(count);
+
+        for (auto& sprite : sprites)
+        {
+            LONG cell = static_cast<LONG>(RandomIndex(random, size_t(cellsAcross) * cellsAcross));
+
+            sprite.position = XMFLOAT2(RandomFloat(random, 0, 1920.f), RandomFloat(random, 0, 1080.f));
+            sprite.source.left = (cell % cellsAcross) * cellSize;
+            sprite.source.top = (cell / cellsAcross) * cellSize;
+            sprite.source.right = sprite.source.left + cellSize;
+            sprite.source.bottom = sprite.source.top + cellSize;
+            sprite.color = XMFLOAT4(RandomFloat(random, 0.5f, 1), RandomFloat(random, 0.5f, 1), RandomFloat(random, 0.5f, 1), RandomFloat(random, 0.25f, 1));
+            sprite.rotation = RandomFloat(random, 0, XM_2PI);
+            sprite.scale = RandomFloat(random, 0.5f, 2);
+            sprite.depth = RandomFloat(random, 0, 1);
+            sprite.texture = RandomIndex(random, textureCount);
+        }
+
+        return sprites;
+    }
+
+    void DrawSprites(SpriteBatch& batch, SpriteTarget const& target, std::vector<Sprite> const& sprites)
+    {
+        for (auto& sprite : sprites)
+        {
+            batch.Draw(target.textures[sprite.texture].Get(), sprite.position, &sprite.source, XMLoadFloat4(&sprite.color),
+                       sprite.rotation, XMFLOAT2(0, 0), sprite.scale, SpriteEffects_None, sprite.depth);
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // A HUD: a few hundred icons and bars cut from one atlas, drawn in order.
+    void HudScenario(Bench& bench)
+    {
+        bench.Section("hud: 300 atlas sprites per frame, deferred");
+
+        SpriteTarget target(1, 1024);
+        Random random(1);
+
+        auto sprites = ScatterSprites(random, 300, 1, 64, 16);
+        size_t frames = bench.Scaled(2000);
+
+        auto totals = RunFrames(bench, target, "hud", frames, sprites.size(), [&](size_t)
+        {
+            target.batch->Begin(SpriteSortMode_Deferred, target.states->NonPremultiplied());
+            DrawSprites(*target.batch, target, sprites);
+            target.batch->End();
+
+            bench.Check(target.batch->GetStatistics().batches == 1, "hud: one atlas should draw as a single batch");
+        });
+
+        ReportFrames(bench, totals, frames);
+    }
+
+
+    // A scrolling tile map: a screen of 16x16 tiles from one tile sheet, unrotated.
+    void TileMapScenario(Bench& bench)
+    {
+        bench.Section("tilemap: 8160 tiles per frame, sorted by texture");
+
+        SpriteTarget target(1, 256);
+        Random random(2);
+
+        const LONG columns = 120;
+        const LONG rows = 68;
+
+        std::vector<RECT> tiles(size_t(columns) * rows);
+        for (auto& tile : tiles)
+        {
+            LONG cell = static_cast<LONG>(RandomIndex(random, 256));
+            tile = { (cell % 16) * 16, (cell / 16) * 16, (cell % 16) * 16 + 16, (cell / 16) * 16 + 16 };
+        }
+
+        size_t frames = bench.Scaled(200);
+
+        auto totals = RunFrames(bench, target, "tilemap", frames, tiles.size(), [&](size_t frame)
+        {
+            float scroll = float(frame % 16);
+
+            target.batch->Begin(SpriteSortMode_Texture, target.states->Opaque(), target.states->PointClamp());
+
+            for (LONG y = 0; y < rows; ++y)
+            {
+                for (LONG x = 0; x < columns; ++x)
+                {
+                    target.batch->Draw(target.textures[0].Get(), XMFLOAT2(float(x * 16) - scroll, float(y * 16)), &tiles[size_t(y) * columns + x]);
+                }
+            }
+
+            target.batch->End();
+        });
+
+        ReportFrames(bench, totals, frames);
+    }
+
+
+    // Particles: rotated, scaled, depth sorted sprites from four textures, additively blended.
+    void ParticleScenario(Bench& bench)
+    {
+        bench.Section("particles: 20000 sprites per frame from 4 textures, back to front");
+
+        SpriteTarget target(4, 128);
+        Random random(3);
+
+        auto sprites = ScatterSprites(random, 20000, 4, 32, 4);
+        size_t frames = bench.Scaled(100);
+
+        auto totals = RunFrames(bench, target, "particles", frames, sprites.size(), [&](size_t frame)
+        {
+            // Particles drift, so the sort sees a different order each frame.
+            for (auto& sprite : sprites)
+                sprite.depth = fmodf(sprite.depth + 0.013f * float(frame + 1), 1.f);
+
+            target.batch->Begin(SpriteSortMode_BackToFront, target.states->Additive());
+            DrawSprites(*target.batch, target, sprites);
+            target.batch->End();
+        });
+
+        ReportFrames(bench, totals, frames);
+    }
+
+
+    // A UI that switches between eight textures from one sprite to the next: the worst case for
+    // batching in deferred mode, and what sorting by texture is for.
+    void InterleavedScenario(Bench& bench)
+    {
+        const size_t textureCount = 8;
+
+        SpriteTarget target(textureCount, 256);
+        Random random(4);
+
+        auto sprites = ScatterSprites(random, 2000, textureCount, 32, 8);
+        for (size_t i = 0; i < sprites.size(); ++i)
+            sprites[i].texture = i % textureCount;
+
+        size_t frames = bench.Scaled(500);
+
+        const SpriteSortMode modes[] = { SpriteSortMode_Deferred, SpriteSortMode_Texture };
+
+        for (auto mode : modes)
+        {
+            bool sorted = (mode == SpriteSortMode_Texture);
+
+            bench.Section(sorted ? "interleaved: 2000 sprites cycling 8 textures, sorted by texture"
+                                 : "interleaved: 2000 sprites cycling 8 textures, deferred");
+
+            size_t expectedBatches = sorted ? textureCount : sprites.size();
+
+            auto totals = RunFrames(bench, target, "interleaved", frames, sprites.size(), [&](size_t)
+            {
+                target.batch->Begin(mode);
+                DrawSprites(*target.batch, target, sprites);
+                target.batch->End();
+
+                bench.Check(target.batch->GetStatistics().batches == expectedBatches, "interleaved: %u batches, expected %zu",
+                            target.batch->GetStatistics().batches, expectedBatches);
+            });
+
+            ReportFrames(bench, totals, frames);
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // A million sprites over 256 textures in each sort mode that batches.
+    void MillionSpriteStress(Bench& bench)
+    {
+        SpriteTarget target(256, 64);
+        Random random(5);
+
+        auto sprites = ScatterSprites(random, bench.Scaled(1000000), target.textures.size(), 16, 4);
+
+        const struct
+        {
+            SpriteSortMode mode;
+            const char* name;
+        } modes[] =
+        {
+            { SpriteSortMode_Deferred,    "stress: %zu sprites over 256 textures, deferred" },
+            { SpriteSortMode_Texture,     "stress: %zu sprites over 256 textures, sorted by texture" },
+            { SpriteSortMode_BackToFront, "stress: %zu sprites over 256 textures, back to front" },
+            { SpriteSortMode_FrontToBack, "stress: %zu sprites over 256 textures, front to back" },
+        };
+
+        for (auto& mode : modes)
+        {
+            char section[128];
+            snprintf(section, sizeof(section), mode.name, sprites.size());
+            bench.Section(section);
+
+            auto totals = RunFrames(bench, target, "stress", 3, sprites.size(), [&](size_t)
+            {
+                target.batch->Begin(mode.mode);
+                DrawSprites(*target.batch, target, sprites);
+                target.batch->End();
+            });
+
+            if (mode.mode == SpriteSortMode_Texture)
+            {
+                bench.Check(totals.batches == 3 * target.textures.size(), "stress: sorting by texture drew %llu batches in 3 frames, expected %zu",
+                            static_cast<unsigned long long>(totals.batches), 3 * target.textures.size());
+            }
+
+            ReportFrames(bench, totals, 3);
+        }
+    }
+
+
+    // Immediate mode draws every sprite as it is submitted, one batch each.
+    void ImmediateStress(Bench& bench)
+    {
+        SpriteTarget target(1, 64);
+        Random random(6);
+
+        auto sprites = ScatterSprites(random, bench.Scaled(20000), 1, 16, 4);
+
+        char section[128];
+        snprintf(section, sizeof(section), "stress: %zu sprites in immediate mode", sprites.size());
+        bench.Section(section);
+
+        auto totals = RunFrames(bench, target, "immediate", 3, sprites.size(), [&](size_t)
+        {
+            target.batch->Begin(SpriteSortMode_Immediate);
+            DrawSprites(*target.batch, target, sprites);
+            target.batch->End();
+
+            bench.Check(target.batch->GetStatistics().batches == sprites.size(), "immediate: %u batches for %zu sprites",
+                        target.batch->GetStatistics().batches, sprites.size());
+        });
+
+        ReportFrames(bench, totals, 3);
+    }
+
+
+    // Sprites recorded on several threads at once, then drawn by End.
+    void RecorderStress(Bench& bench)
+    {
+        unsigned threadCount = bench.GetThreadCount() ? bench.GetThreadCount() : std::max(2u, std::thread::hardware_concurrency());
+
+        SpriteTarget target(16, 64);
+        Random random(7);
+
+        auto sprites = ScatterSprites(random, bench.Scaled(400000), target.textures.size(), 16, 4);
+
+        char section[128];
+        snprintf(section, sizeof(section), "stress: %zu sprites from recorders on %u threads, sorted by texture", sprites.size(), threadCount);
+        bench.Section(section);
+
+        size_t perThread = (sprites.size() + threadCount - 1) / threadCount;
+
+        double recordSeconds = 0;
+
+        auto totals = RunFrames(bench, target, "recorders", 3, sprites.size(), [&](size_t)
+        {
+            std::vector<SpriteBatch::Recorder> recorders;
+            for (unsigned i = 0; i < threadCount; ++i)
+                recorders.emplace_back(*target.batch);
+
+            target.batch->Begin(SpriteSortMode_Texture);
+
+            Timer timer;
+
+            std::vector<std::thread> threads;
+            for (unsigned i = 0; i < threadCount; ++i)
+            {
+                threads.emplace_back([&, i]
+                {
+                    size_t begin = std::min(sprites.size(), i * perThread);
+                    size_t end = std::min(sprites.size(), begin + perThread);
+
+                    for (size_t j = begin; j < end; ++j)
+                    {
+                        auto& sprite = sprites[j];
+                        recorders[i].Draw(target.textures[sprite.texture].Get(), sprite.position, &sprite.source, XMLoadFloat4(&sprite.color),
+                                          sprite.rotation, XMFLOAT2(0, 0), sprite.scale);
+                    }
+                });
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+
+            recordSeconds += timer.GetSeconds();
+
+            target.batch->End();
+        });
+
+        bench.Report("recorded sprites per second", double(totals.sprites) / std::max(recordSeconds, 1e-9), "");
+        ReportFrames(bench, totals, 3);
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // A static overlay drawn three ways: redrawn sprite by sprite every frame, kept in an unchanged
+    // layer whose tint animates, and kept in a layer re-recorded every frame with a few sprites moving.
+    void LayerTiming(Bench& bench)
+    {
+        const size_t changedCount = 50;
+
+        SpriteTarget target(4, 256);
+        Random random(8);
+
+        auto sprites = ScatterSprites(random, 5000, target.textures.size(), 32, 8);
+
+        // Overlays are usually drawn a texture at a time.
+        std::stable_sort(sprites.begin(), sprites.end(), [](Sprite const& a, Sprite const& b) { return a.texture < b.texture; });
+
+        size_t frames = bench.Scaled(500);
+        auto recording = target.GetRecording();
+
+        bench.Section("layers: 5000 overlay sprites redrawn every frame");
+
+        auto redrawn = RunFrames(bench, target, "redrawn", frames, sprites.size(), [&](size_t)
+        {
+            target.batch->Begin();
+            DrawSprites(*target.batch, target, sprites);
+            target.batch->End();
+        });
+
+        ReportFrames(bench, redrawn, frames);
+
+        SpriteBatch::Layer layer;
+
+        auto recordLayer = [&](size_t frame)
+        {
+            target.batch->Begin(layer);
+            DrawSprites(*target.batch, target, sprites);
+
+            // A block of sprites that moves with the frame, such as a cursor or a health bar.
+            for (size_t i = 0; i < changedCount; ++i)
+            {
+                auto& sprite = sprites[i];
+                XMFLOAT2 position(sprite.position.x + float(frame % 64), sprite.position.y);
+                target.batch->Draw(target.textures[sprite.texture].Get(), position, &sprite.source, XMLoadFloat4(&sprite.color));
+            }
+
+            target.batch->End();
+        };
+
+        auto drawLayer = [&](size_t frame)
+        {
+            float pulse = 0.75f + 0.25f * sinf(float(frame) * 0.1f);
+
+            target.batch->Begin();
+            target.batch->DrawLayer(layer, XMVectorSet(pulse, pulse, pulse, 1));
+            target.batch->End();
+        };
+
+        size_t layerSprites = sprites.size() + changedCount;
+
+        // The first draw uploads the whole layer.
+        recordLayer(0);
+        recording->ResetCounters();
+        drawLayer(0);
+
+        bench.Check(layer.GetSpriteCount() == layerSprites, "layers: recorded %zu sprites, expected %zu", layer.GetSpriteCount(), layerSprites);
+        bench.Check(recording->GetCounters().bytesUpdated == SpriteBytes(layerSprites), "layers: the first draw uploaded %llu bytes, expected %llu",
+                    static_cast<unsigned long long>(recording->GetCounters().bytesUpdated), static_cast<unsigned long long>(SpriteBytes(layerSprites)));
+
+        bench.Section("layers: the same sprites in an unchanged layer, tint animated");
+
+        auto unchanged = RunFrames(bench, target, "unchanged layer", frames, layerSprites, 0, [&](size_t frame)
+        {
+            drawLayer(frame);
+
+            bench.Check(recording->GetCounters().bytesUpdated == 0, "layers: changing the tint uploaded %llu bytes",
+                        static_cast<unsigned long long>(recording->GetCounters().bytesUpdated));
+        });
+
+        ReportFrames(bench, unchanged, frames);
+        bench.Report("time per frame relative to redrawing", unchanged.seconds / std::max(redrawn.seconds, 1e-9), "");
+
+        char section[128];
+        snprintf(section, sizeof(section), "layers: re-recorded every frame with %zu sprites moving", changedCount);
+        bench.Section(section);
+
+        double recordSeconds = 0;
+
+        auto changing = RunFrames(bench, target, "changing layer", frames, layerSprites, SpriteBytes(changedCount), [&](size_t frame)
+        {
+            Timer timer;
+            recordLayer(frame + 1);
+            recordSeconds += timer.GetSeconds();
+
+            drawLayer(frame);
+        });
+
+        ReportFrames(bench, changing, frames);
+        bench.Report("recording time per frame", recordSeconds * 1000.0 / double(frames), "ms");
+        bench.Report("time per frame relative to redrawing", changing.seconds / std::max(redrawn.seconds, 1e-9), "");
+    }
+}
+
+
+void BenchTool::SpriteBatchScenarios(Bench& bench)
+{
+    HudScenario(bench);
+    TileMapScenario(bench);
+    ParticleScenario(bench);
+    InterleavedScenario(bench);
+}
+
+
+void BenchTool::SpriteBatchStress(Bench& bench)
+{
+    MillionSpriteStress(bench);
+    ImmediateStress(bench);
+    RecorderStress(bench);
+}
+
+
+void BenchTool::SpriteBatchLayers(Bench& bench)
+{
+    LayerTiming(bench);
+}
@@ -0,0 +1,366 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteSortBench.cpp
+//
+// Sprite sorting suite: the 64-bit sort keys and radix sort from SpriteSort.h on queues of
+// 10k to 1M sprites, sorted by texture, back to front and front to back, against std::sort
+// on pointers into the queue as SpriteBatch used to sort. It checks that the keys come out
+// in the order std::stable_sort gives (sprites with equal sort values keep their draw
+// order), and that SpriteBatch itself draws sprites in that order in every sort mode.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "PlatformHelpers.h"
+#include "SpriteBatch.h"
+#include "SpriteSort.h"
+#include "VertexTypes.h"
+
+using namespace BenchTool;
+using namespace DirectX;
+using namespace DirectX::SpriteSorting;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    // Laid out like SpriteBatch's SpriteInfo, so the old sort touches memory the way it did.
+    __declspec(align(16)) struct QueuedSprite
+    {
+        XMFLOAT4A source;
+        XMFLOAT4A destination;
+        XMFLOAT4A color;
+        XMFLOAT4A originRotationDepth;
+        void const* texture;
+        int flags;
+    };
+
+
+    const struct
+    {
+        SpriteSortMode mode;
+        const char* name;
+    } g_SortModes[] =
+    {
+        { SpriteSortMode_Texture,     "by texture" },
+        { SpriteSortMode_BackToFront, "back to front" },
+        { SpriteSortMode_FrontToBack, "front to back" },
+    };
+
+
+    // Sprites drawn in runs that share a texture, with depths from a limited set so many are equal.
+    std::vector<QueuedSprite> MakeQueue(size_t count, std::vector<char> const& textures, uint32_t seed)
+    {
+        std::vector<QueuedSprite> queue(count);
+
+        Random random(seed);
+        void const* texture = nullptr;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!texture || !RandomIndex(random, 8))
+                texture = &textures[RandomIndex(random, textures.size())];
+
+            auto& sprite = queue[i];
+            memset(&sprite, 0, sizeof(sprite));
+            sprite.texture = texture;
+            sprite.originRotationDepth.w = float(RandomIndex(random, 1000)) / 1000.f;
+        }
+
+        return queue;
+    }
+
+
+    // The sort SpriteBatch used before: std::sort on pointers, dereferencing both sprites per comparison.
+    void PointerSort(std::vector<QueuedSprite> const& queue, SpriteSortMode mode, std::vector<QueuedSprite const*>& sorted)
+    {
+        sorted.resize(queue.size());
+        for (size_t i = 0; i < queue.size(); ++i)
+            sorted[i] = &queue[i];
+
+        switch (mode)
+        {
+            case SpriteSortMode_Texture:
+                std::sort(sorted.begin(), sorted.end(), [](QueuedSprite const* x, QueuedSprite const* y) { return x->texture < y->texture; });
+                break;
+
+            case SpriteSortMode_BackToFront:
+                std::sort(sorted.begin(), sorted.end(), [](QueuedSprite const* x, QueuedSprite const* y) { return x->originRotationDepth.w > y->originRotationDepth.w; });
+                break;
+
+            default:
+                std::sort(sorted.begin(), sorted.end(), [](QueuedSprite const* x, QueuedSprite const* y) { return x->originRotationDepth.w < y->originRotationDepth.w; });
+                break;
+        }
+    }
+
+
+    // The sort SpriteBatch::Impl::SortSprites does now: one key per sprite, read from the queue once.
+    void KeySort(std::vector<QueuedSprite> const& queue, SpriteSortMode mode, std::vector<uint64_t>& keys, std::vector<uint64_t>& scratch,
+                 std::vector<void const*>& textures, std::vector<QueuedSprite const*>& sorted)
+    {
+        size_t count = queue.size();
+
+        keys.resize(count);
+        scratch.resize(count);
+
+        if (mode == SpriteSortMode_Texture)
+        {
+            // SpriteBatch gets the texture changes from its texture references.
+            textures.clear();
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!i || queue[i].texture != queue[i - 1].texture)
+                    textures.push_back(queue[i].texture);
+            }
+
+            std::sort(textures.begin(), textures.end());
+            textures.erase(std::unique(textures.begin(), textures.end()), textures.end());
+
+            void const* texture = nullptr;
+            uint64_t textureKey = 0;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (queue[i].texture != texture)
+                {
+                    texture = queue[i].texture;
+                    textureKey = uint64_t(std::lower_bound(textures.cbegin(), textures.cend(), texture) - textures.cbegin()) << 32;
+                }
+
+                keys[i] = textureKey | i;
+            }
+        }
+        else
+        {
+            bool backToFront = (mode == SpriteSortMode_BackToFront);
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint32_t depthKey = GetDepthSortKey(queue[i].originRotationDepth.w);
+
+                keys[i] = (uint64_t(backToFront ? ~depthKey : depthKey) << 32) | i;
+            }
+        }
+
+        uint64_t* result = RadixSortKeys(keys.data(), scratch.data(), count);
+
+        sorted.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            sorted[i] = &queue[uint32_t(result[i])];
+    }
+
+
+    // Queue indices in draw order, as std::stable_sort puts them.
+    std::vector<size_t> StableOrder(std::vector<float> const& depths, std::vector<size_t> const& textureOrder, SpriteSortMode mode)
+    {
+        std::vector<size_t> order(depths.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+
+        switch (mode)
+        {
+            case SpriteSortMode_Texture:
+                std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return textureOrder[x] < textureOrder[y]; });
+                break;
+
+            case SpriteSortMode_BackToFront:
+                std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return depths[x] > depths[y]; });
+                break;
+
+            default:
+                std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return depths[x] < depths[y]; });
+                break;
+        }
+
+        return order;
+    }
+
+
+    void CompareSorts(Bench& bench, size_t count)
+    {
+        std::vector<char> textures(256);
+        auto queue = MakeQueue(count, textures, uint32_t(count));
+
+        std::vector<float> depths(count);
+        std::vector<size_t> textureOrder(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            depths[i] = queue[i].originRotationDepth.w;
+            textureOrder[i] = size_t(static_cast<char const*>(queue[i].texture) - textures.data());
+        }
+
+        size_t passes = std::max<size_t>(1, 1000000 / count);
+
+        std::vector<QueuedSprite const*> sorted;
+        std::vector<uint64_t> keys, scratch;
+        std::vector<void const*> sortTextures;
+
+        for (auto& mode : g_SortModes)
+        {
+            char section[128];
+            snprintf(section, sizeof(section), "spritesort: %zu sprites over 256 textures, %s", count, mode.name);
+            bench.Section(section);
+
+            Timer timer;
+            for (size_t pass = 0; pass < passes; ++pass)
+                PointerSort(queue, mode.mode, sorted);
+            double pointerSeconds = timer.GetSeconds() / double(passes);
+
+            // std::sort isn't stable, but it must still have put the sort values in order.
+            bool ordered = true;
+            for (size_t i = 1; ordered && i < count; ++i)
+            {
+                size_t x = size_t(sorted[i - 1] - queue.data());
+                size_t y = size_t(sorted[i] - queue.data());
+
+                ordered = (mode.mode == SpriteSortMode_Texture) ? textureOrder[x] <= textureOrder[y]
+                        : (mode.mode == SpriteSortMode_BackToFront) ? depths[x] >= depths[y]
+                        : depths[x] <= depths[y];
+            }
+
+            bench.Check(ordered, "spritesort: std::sort on pointers left %zu sprites out of order %s", count, mode.name);
+
+            timer.Restart();
+            for (size_t pass = 0; pass < passes; ++pass)
+                KeySort(queue, mode.mode, keys, scratch, sortTextures, sorted);
+            double keySeconds = timer.GetSeconds() / double(passes);
+
+            auto expected = StableOrder(depths, textureOrder, mode.mode);
+
+            size_t misplaced = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (size_t(sorted[i] - queue.data()) != expected[i])
+                    ++misplaced;
+            }
+
+            bench.Check(misplaced == 0, "spritesort: the key sort put %zu of %zu sprites somewhere std::stable_sort doesn't, %s", misplaced, count, mode.name);
+
+            bench.Report("time per sort, std::sort on pointers", pointerSeconds * 1000.0, "ms");
+            bench.Report("time per sort, radix sorted keys", keySeconds * 1000.0, "ms");
+            bench.Report("sprites sorted per second, radix sorted keys", double(count) / std::max(keySeconds, 1e-9), "");
+            bench.Report("radix sort speedup", pointerSeconds / std::max(keySeconds, 1e-9), "x");
+        }
+    }
+
+
+    // Depth keys must order like the floats they come from, with -0 equal to +0.
+    void CheckDepthKeys(Bench& bench)
+    {
+        const float depths[] = { -1e30f, -2.f, -1.f, -0.5f, -1e-30f, 0.f, 1e-30f, 0.25f, 0.5f, 1.f, 2.f, 1e30f };
+
+        bool ordered = true;
+        for (size_t i = 1; i < _countof(depths); ++i)
+            ordered = ordered && GetDepthSortKey(depths[i - 1]) < GetDepthSortKey(depths[i]);
+
+        bench.Check(ordered, "spritesort: depth keys don't order like their floats");
+        bench.Check(GetDepthSortKey(-0.f) == GetDepthSortKey(0.f), "spritesort: -0 and +0 have different depth keys");
+    }
+
+
+    // SpriteBatch must draw sprites in the stable sorted order. Each sprite's red channel holds
+    // its submission index, which is read back from the vertices of every draw.
+    void CheckSpriteBatchOrder(Bench& bench)
+    {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = desc.Height = 16;
+        desc.MipLevels = desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textures(8);
+        for (auto& view : textures)
+        {
+            ComPtr<ID3D11Texture2D> texture;
+            ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf()));
+            ThrowIfFailed(device->CreateShaderResourceView(texture.Get(), nullptr, view.GetAddressOf()));
+        }
+
+        std::vector<ID3D11ShaderResourceView*> byPointer;
+        for (auto& view : textures)
+            byPointer.push_back(view.Get());
+        std::sort(byPointer.begin(), byPointer.end());
+
+        // More sprites than fit in SpriteBatch's vertex buffer, so the order must hold across draws.
+        const size_t count = 5000;
+
+        Random random(41);
+        std::vector<float> depths(count);
+        std::vector<size_t> texture(count);
+        std::vector<size_t> textureOrder(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            depths[i] = float(RandomIndex(random, 16)) / 16.f;
+            texture[i] = RandomIndex(random, textures.size());
+            textureOrder[i] = size_t(std::find(byPointer.begin(), byPointer.end(), textures[texture[i]].Get()) - byPointer.begin());
+        }
+
+        SpriteBatch batch(context.Get());
+        auto recording = GetRecordingContext(context.Get());
+
+        for (auto& mode : g_SortModes)
+        {
+            std::vector<uint8_t> vertices;
+            recording->SetVertexLog(&vertices);
+
+            batch.Begin(mode.mode);
+            for (size_t i = 0; i < count; ++i)
+            {
+                batch.Draw(textures[texture[i]].Get(), XMFLOAT2(float(i % 64) * 4.f, float(i / 64) * 4.f), nullptr,
+                           XMVectorSet(float(i), 1.f, 1.f, 1.f), 0.f, XMFLOAT2(0, 0), 1.f, SpriteEffects_None, depths[i]);
+            }
+            batch.End();
+
+            recording->SetVertexLog(nullptr);
+
+            auto expected = StableOrder(depths, textureOrder, mode.mode);
+
+            const size_t spriteBytes = 4 * sizeof(VertexPositionColorTexture);
+
+            if (!bench.Check(vertices.size() == count * spriteBytes, "spritesort: SpriteBatch drew %zu vertex bytes %s, expected %zu",
+                             vertices.size(), mode.name, count * spriteBytes))
+                continue;
+
+            size_t misplaced = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                VertexPositionColorTexture vertex;
+                memcpy(&vertex, &vertices[i * spriteBytes], sizeof(vertex));
+
+                if (vertex.color.x != float(expected[i]))
+                    ++misplaced;
+            }
+
+            bench.Check(misplaced == 0, "spritesort: SpriteBatch drew %zu of %zu sprites out of stable order %s", misplaced, count, mode.name);
+        }
+    }
+}
+
+
+void BenchTool::SpriteSortKeys(Bench& bench)
+{
+    bench.Section("spritesort: depth keys, and SpriteBatch's draw order in each sort mode");
+    CheckDepthKeys(bench);
+    CheckSpriteBatchOrder(bench);
+
+    for (size_t count : { size_t(10000), size_t(100000), size_t(1000000) })
+        CompareSorts(bench, bench.Scaled(count));
+}
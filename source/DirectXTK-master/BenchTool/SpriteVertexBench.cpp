@@ -0,0 +1,267 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteVertexBench.cpp
+//
+// Sprite vertex suite: SpriteBatch turning queued sprites into vertices, four at a time
+// through RenderSprites and one at a time through RenderSprite. It reports the sprites per
+// second End writes to the mapped vertex buffer, and compares batches of three sprites
+// (all done one at a time) with batches of four (done as a group). It checks that both
+// paths write the same bytes for sprites covering every flag, rotation and source case,
+// including zero-size sources and -0 rotations and depths.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+#include "RecordingDevice.h"
+
+#include "PlatformHelpers.h"
+#include "SpriteBatch.h"
+#include "VertexTypes.h"
+
+using namespace BenchTool;
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    const size_t SpriteBytes = 4 * sizeof(VertexPositionColorTexture);
+
+
+    struct VertexTarget
+    {
+        ComPtr<ID3D11Device> device;
+        ComPtr<ID3D11DeviceContext> context;
+        std::unique_ptr<SpriteBatch> batch;
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textures;
+
+        VertexTarget()
+        {
+            ThrowIfFailed(CreateRecordingDevice(D3D_FEATURE_LEVEL_11_0, device.GetAddressOf(), context.GetAddressOf()));
+
+            batch = std::make_unique<SpriteBatch>(context.Get());
+
+            // Not square, so a swapped width and height shows in the texture coordinates.
+            D3D11_TEXTURE2D_DESC desc = {};
+            desc.Width = 64;
+            desc.Height = 32;
+            desc.MipLevels = desc.ArraySize = 1;
+            desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            desc.SampleDesc.Count = 1;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+            for (size_t i = 0; i < 2; ++i)
+            {
+                ComPtr<ID3D11Texture2D> texture;
+                ComPtr<ID3D11ShaderResourceView> view;
+                ThrowIfFailed(device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf()));
+                ThrowIfFailed(device->CreateShaderResourceView(texture.Get(), nullptr, view.GetAddressOf()));
+                textures.push_back(view);
+            }
+        }
+
+        RecordingContext* GetRecording() const { return GetRecordingContext(context.Get()); }
+    };
+
+
+    // Everything one Draw call takes, picked to reach every branch of the vertex code.
+    struct Sprite
+    {
+        bool destinationRect;   // Draw with a destination RECT (size in pixels) rather than a position and scale
+        XMFLOAT2 position;
+        XMFLOAT2 scale;
+        RECT destination;
+        bool hasSource;
+        RECT source;
+        XMFLOAT4 color;
+        float rotation;
+        XMFLOAT2 origin;
+        SpriteEffects effects;
+        float depth;
+    };
+
+    std::vector<Sprite> MakeSprites(size_t count, uint32_t seed)
+    {
+        std::vector<Sprite> sprites(count);
+
+        Random random(seed);
+
+        for (auto& sprite : sprites)
+        {
+            sprite.destinationRect = RandomIndex(random, 2) != 0;
+            sprite.position = XMFLOAT2(RandomFloat(random, -100, 2000), RandomFloat(random, -100, 1200));
+            sprite.scale = XMFLOAT2(RandomFloat(random, 0.25f, 4), RandomFloat(random, 0.25f, 4));
+
+            LONG left = LONG(RandomIndex(random, 1900));
+            LONG top = LONG(RandomIndex(random, 1000));
+            sprite.destination = { left, top, left + LONG(RandomIndex(random, 300)), top + LONG(RandomIndex(random, 300)) };
+
+            // A third have no source rectangle; some of the rest are empty.
+            sprite.hasSource = RandomIndex(random, 3) != 0;
+            LONG sx = LONG(RandomIndex(random, 64));
+            LONG sy = LONG(RandomIndex(random, 32));
+            LONG sw = RandomIndex(random, 8) ? LONG(RandomIndex(random, 64)) : 0;
+            LONG sh = RandomIndex(random, 8) ? LONG(RandomIndex(random, 32)) : 0;
+            sprite.source = { sx, sy, sx + sw, sy + sh };
+
+            sprite.color = XMFLOAT4(RandomFloat(random, 0, 1), RandomFloat(random, 0, 1), RandomFloat(random, 0, 1), RandomFloat(random, 0, 1));
+
+            switch (RandomIndex(random, 4))
+            {
+                case 0:  sprite.rotation = 0.f; break;
+                case 1:  sprite.rotation = -0.f; break;
+                default: sprite.rotation = RandomFloat(random, -XM_2PI, XM_2PI); break;
+            }
+
+            sprite.origin = RandomIndex(random, 2) ? XMFLOAT2(RandomFloat(random, -32, 64), RandomFloat(random, -16, 32)) : XMFLOAT2(0, 0);
+            sprite.effects = static_cast<SpriteEffects>(RandomIndex(random, 4));
+
+            switch (RandomIndex(random, 4))
+            {
+                case 0:  sprite.depth = 0.f; break;
+                case 1:  sprite.depth = -0.f; break;
+                default: sprite.depth = RandomFloat(random, 0, 1); break;
+            }
+        }
+
+        return sprites;
+    }
+
+    void DrawSprite(SpriteBatch& batch, ID3D11ShaderResourceView* texture, Sprite const& sprite)
+    {
+        RECT const* source = sprite.hasSource ? &sprite.source : nullptr;
+        XMVECTOR color = XMLoadFloat4(&sprite.color);
+
+        if (sprite.destinationRect)
+        {
+            batch.Draw(texture, sprite.destination, source, color, sprite.rotation, sprite.origin, sprite.effects, sprite.depth);
+        }
+        else
+        {
+            batch.Draw(texture, sprite.position, source, color, sprite.rotation, sprite.origin, sprite.scale, sprite.effects, sprite.depth);
+        }
+    }
+
+
+    // Immediate mode draws every sprite in a batch of its own, so each goes through RenderSprite. One
+    // deferred batch runs all but the last few through RenderSprites. The bytes must be the same.
+    void CheckPathsMatch(Bench& bench)
+    {
+        VertexTarget target;
+        auto recording = target.GetRecording();
+        auto texture = target.textures[0].Get();
+
+        // Not a multiple of four, so the last sprites of each draw take the single-sprite path too.
+        auto sprites = MakeSprites(bench.Scaled(40000) | 3, 42);
+
+        std::vector<uint8_t> single;
+        recording->SetVertexLog(&single);
+
+        target.batch->Begin(SpriteSortMode_Immediate);
+        for (auto& sprite : sprites)
+            DrawSprite(*target.batch, texture, sprite);
+        target.batch->End();
+
+        std::vector<uint8_t> grouped;
+        recording->SetVertexLog(&grouped);
+
+        target.batch->Begin(SpriteSortMode_Deferred);
+        for (auto& sprite : sprites)
+            DrawSprite(*target.batch, texture, sprite);
+        target.batch->End();
+
+        recording->SetVertexLog(nullptr);
+
+        if (!bench.Check(single.size() == sprites.size() * SpriteBytes && grouped.size() == single.size(),
+                         "spritevertices: %zu sprites gave %zu vertex bytes one at a time and %zu in groups, expected %zu",
+                         sprites.size(), single.size(), grouped.size(), sprites.size() * SpriteBytes))
+            return;
+
+        size_t different = 0;
+        size_t first = 0;
+        for (size_t i = 0; i < sprites.size(); ++i)
+        {
+            if (memcmp(&single[i * SpriteBytes], &grouped[i * SpriteBytes], SpriteBytes) != 0)
+            {
+                if (!different++)
+                    first = i;
+            }
+        }
+
+        bench.Check(different == 0, "spritevertices: %zu of %zu sprites have different vertices in groups of four than one at a time (first is %zu)",
+                    different, sprites.size(), first);
+    }
+
+
+    // Times End, which does the vertex generation, separately from queueing the sprites with Draw.
+    // Textures alternate every runLength sprites, so each batch holds that many.
+    void TimeVertices(Bench& bench, size_t count, size_t runLength, const char* name)
+    {
+        VertexTarget target;
+        auto sprites = MakeSprites(count, 7);
+
+        char section[128];
+        snprintf(section, sizeof(section), "spritevertices: %zu sprites, %s", count, name);
+        bench.Section(section);
+
+        const size_t frames = 5;
+        double drawSeconds = 0;
+        double endSeconds = 0;
+        uint64_t vertexBytes = 0;
+        uint32_t batches = 0;
+
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            Timer timer;
+
+            target.batch->Begin(SpriteSortMode_Deferred);
+            for (size_t i = 0; i < sprites.size(); ++i)
+                DrawSprite(*target.batch, target.textures[(i / runLength) & 1].Get(), sprites[i]);
+
+            drawSeconds += timer.GetSeconds();
+            timer.Restart();
+
+            target.batch->End();
+
+            endSeconds += timer.GetSeconds();
+
+            auto& stats = target.batch->GetStatistics();
+            vertexBytes += stats.vertexBytes;
+            batches = stats.batches;
+        }
+
+        size_t expectedBatches = (count + runLength - 1) / runLength;
+
+        bench.Check(vertexBytes == uint64_t(frames) * count * SpriteBytes, "spritevertices: wrote %llu vertex bytes for %zu sprites in %zu frames",
+                    static_cast<unsigned long long>(vertexBytes), count, frames);
+        bench.Check(batches == expectedBatches, "spritevertices: %u batches for runs of %zu sprites, expected %zu", batches, runLength, expectedBatches);
+
+        double drawn = double(frames * count);
+        bench.Report("sprites per second, End", drawn / std::max(endSeconds, 1e-9), "");
+        bench.Report("vertex bytes per second, End", double(vertexBytes) / std::max(endSeconds, 1e-9), "bytes");
+        bench.Report("sprites per second, Draw", drawn / std::max(drawSeconds, 1e-9), "");
+        bench.Report("time per sprite, End", endSeconds * 1e9 / drawn, "ns");
+    }
+}
+
+
+void BenchTool::SpriteVertexGeneration(Bench& bench)
+{
+    bench.Section("spritevertices: groups of four against one at a time, byte for byte");
+    CheckPathsMatch(bench);
+
+    size_t count = std::max<size_t>(12, bench.Scaled(600000) / 12 * 12);
+
+    TimeVertices(bench, count, count, "one texture");
+    TimeVertices(bench, count, 4, "batches of 4 (four at a time)");
+    TimeVertices(bench, count, 3, "batches of 3 (one at a time)");
+}
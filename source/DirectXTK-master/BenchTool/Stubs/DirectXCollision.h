@@ -0,0 +1,235 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXCollision.h
+//
+// BenchTool stand-in for DirectXCollision: the bounding volumes Model uses for frustum
+// culling, with the same frustum conventions (a left-handed frustum looking down +Z from
+// Origin, turned by Orientation) as the real library.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <float.h>
+
+#include <algorithm>
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    enum ContainmentType
+    {
+        DISJOINT = 0,
+        INTERSECTS = 1,
+        CONTAINS = 2,
+    };
+
+
+    struct BoundingSphere
+    {
+        XMFLOAT3 Center;
+        float Radius;
+
+        BoundingSphere() : Center(0, 0, 0), Radius(1.f) {}
+        BoundingSphere(const XMFLOAT3& center, float radius) : Center(center), Radius(radius) {}
+
+        void XM_CALLCONV Transform(BoundingSphere& Out, FXMMATRIX M) const
+        {
+            XMVECTOR center = XMVector3Transform(XMLoadFloat3(&Center), M);
+
+            float scale = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                scale = std::max(scale, XMVectorGetX(XMVector3Dot(M.r[i], M.r[i])));
+            }
+
+            XMStoreFloat3(&Out.Center, center);
+            Out.Radius = Radius * sqrtf(scale);
+        }
+    };
+
+
+    struct BoundingBox
+    {
+        XMFLOAT3 Center;
+        XMFLOAT3 Extents;
+
+        BoundingBox() : Center(0, 0, 0), Extents(1.f, 1.f, 1.f) {}
+        BoundingBox(const XMFLOAT3& center, const XMFLOAT3& extents) : Center(center), Extents(extents) {}
+
+        // Transforms the eight corners and bounds them, so the result stays axis aligned.
+        void XM_CALLCONV Transform(BoundingBox& Out, FXMMATRIX M) const
+        {
+            XMVECTOR center = XMLoadFloat3(&Center);
+            XMVECTOR extents = XMLoadFloat3(&Extents);
+
+            XMVECTOR lo = _mm_set1_ps(FLT_MAX);
+            XMVECTOR hi = _mm_set1_ps(-FLT_MAX);
+
+            for (int i = 0; i < 8; i++)
+            {
+                XMVECTOR sign = XMVectorSet((i & 1) ? 1.f : -1.f, (i & 2) ? 1.f : -1.f, (i & 4) ? 1.f : -1.f, 0);
+                XMVECTOR corner = XMVector3Transform(XMVectorMultiplyAdd(extents, sign, center), M);
+
+                lo = XMVectorMin(lo, corner);
+                hi = XMVectorMax(hi, corner);
+            }
+
+            XMStoreFloat3(&Out.Center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+            XMStoreFloat3(&Out.Extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+        }
+
+        static void XM_CALLCONV CreateFromPoints(BoundingBox& Out, FXMVECTOR pt1, FXMVECTOR pt2)
+        {
+            XMVECTOR lo = XMVectorMin(pt1, pt2);
+            XMVECTOR hi = XMVectorMax(pt1, pt2);
+
+            XMStoreFloat3(&Out.Center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+            XMStoreFloat3(&Out.Extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+        }
+    };
+
+
+    struct BoundingFrustum
+    {
+        XMFLOAT3 Origin;
+        XMFLOAT4 Orientation;
+
+        float RightSlope;
+        float LeftSlope;
+        float TopSlope;
+        float BottomSlope;
+        float Near, Far;
+
+        BoundingFrustum()
+          : Origin(0, 0, 0), Orientation(0, 0, 0, 1.f),
+            RightSlope(1.f), LeftSlope(-1.f), TopSlope(1.f), BottomSlope(-1.f),
+            Near(0), Far(1.f)
+        {
+        }
+
+        // Reads the slopes and planes back out of a left-handed projection.
+        static void XM_CALLCONV CreateFromMatrix(BoundingFrustum& Out, FXMMATRIX Projection)
+        {
+            static const XMVECTORF32 homogenousPoints[6] =
+            {
+                { { {  1.0f,  0.0f, 1.0f, 1.0f } } },   // right (at far plane)
+                { { { -1.0f,  0.0f, 1.0f, 1.0f } } },   // left
+                { { {  0.0f,  1.0f, 1.0f, 1.0f } } },   // top
+                { { {  0.0f, -1.0f, 1.0f, 1.0f } } },   // bottom
+                { { {  0.0f,  0.0f, 0.0f, 1.0f } } },   // near
+                { { {  0.0f,  0.0f, 1.0f, 1.0f } } },   // far
+            };
+
+            XMMATRIX inverse = XMMatrixInverse(nullptr, Projection);
+
+            XMFLOAT4 points[6];
+            for (int i = 0; i < 6; i++)
+            {
+                XMVECTOR p = XMVector4Transform(homogenousPoints[i], inverse);
+                p = XMVectorDivide(p, (i < 4) ? XMVectorSplatZ(p) : XMVectorSplatW(p));
+                XMStoreFloat4(&points[i], p);
+            }
+
+            Out.Origin = XMFLOAT3(0, 0, 0);
+            Out.Orientation = XMFLOAT4(0, 0, 0, 1.f);
+            Out.RightSlope = points[0].x;
+            Out.LeftSlope = points[1].x;
+            Out.TopSlope = points[2].y;
+            Out.BottomSlope = points[3].y;
+            Out.Near = points[4].z;
+            Out.Far = points[5].z;
+        }
+
+        ContainmentType XM_CALLCONV Contains(const BoundingSphere& sh) const
+        {
+            XMVECTOR center = ToLocal(XMLoadFloat3(&sh.Center));
+
+            bool inside = true;
+
+            XMFLOAT4 planes[6];
+            GetLocalPlanes(planes);
+
+            for (auto& plane : planes)
+            {
+                float distance = XMVectorGetX(XMVector3Dot(XMLoadFloat4(&plane), center)) + plane.w;
+
+                if (distance > sh.Radius)
+                    return DISJOINT;
+
+                if (distance > -sh.Radius)
+                    inside = false;
+            }
+
+            return inside ? CONTAINS : INTERSECTS;
+        }
+
+        // Separating plane test against the frustum planes. Like the real library this can
+        // report an intersection for a box that is outside near a frustum edge.
+        bool XM_CALLCONV Intersects(const BoundingBox& box) const
+        {
+            XMVECTOR center = ToLocal(XMLoadFloat3(&box.Center));
+            XMVECTOR orientation = XMLoadFloat4(&Orientation);
+
+            // The box's axes, as seen from the frustum.
+            XMVECTOR axes[3] =
+            {
+                XMVector3InverseRotate(g_XMIdentityR0, orientation),
+                XMVector3InverseRotate(g_XMIdentityR1, orientation),
+                XMVector3InverseRotate(g_XMIdentityR2, orientation),
+            };
+
+            XMFLOAT4 planes[6];
+            GetLocalPlanes(planes);
+
+            for (auto& plane : planes)
+            {
+                XMVECTOR normal = XMLoadFloat4(&plane);
+                float distance = XMVectorGetX(XMVector3Dot(normal, center)) + plane.w;
+
+                float radius = 0;
+                for (int i = 0; i < 3; i++)
+                {
+                    radius += fabsf(XMVectorGetX(XMVector3Dot(normal, axes[i]))) * reinterpret_cast<const float*>(&box.Extents)[i];
+                }
+
+                if (distance > radius)
+                    return false;
+            }
+
+            return true;
+        }
+
+    private:
+        XMVECTOR XM_CALLCONV ToLocal(FXMVECTOR point) const
+        {
+            return XMVector3InverseRotate(XMVectorSubtract(point, XMLoadFloat3(&Origin)), XMLoadFloat4(&Orientation));
+        }
+
+        // Outward facing planes, as (normal, offset), in the frustum's own space.
+        void GetLocalPlanes(XMFLOAT4 planes[6]) const
+        {
+            planes[0] = XMFLOAT4(0, 0, -1.f, Near);
+            planes[1] = XMFLOAT4(0, 0, 1.f, -Far);
+            planes[2] = Normalized(1.f, 0, -RightSlope);
+            planes[3] = Normalized(-1.f, 0, LeftSlope);
+            planes[4] = Normalized(0, 1.f, -TopSlope);
+            planes[5] = Normalized(0, -1.f, BottomSlope);
+        }
+
+        static XMFLOAT4 Normalized(float x, float y, float z)
+        {
+            float length = sqrtf(x * x + y * y + z * z);
+            return XMFLOAT4(x / length, y / length, z / length, 0);
+        }
+    };
+}
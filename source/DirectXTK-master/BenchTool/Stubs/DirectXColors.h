@@ -0,0 +1,35 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXColors.h
+//
+// BenchTool stand-in for DirectXColors: the named colors DirectXTK and the benchmarks use.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    namespace Colors
+    {
+        XMGLOBALCONST XMVECTORF32 Black             = { { { 0.000000000f, 0.000000000f, 0.000000000f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 White             = { { { 1.000000000f, 1.000000000f, 1.000000000f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 Red               = { { { 1.000000000f, 0.000000000f, 0.000000000f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 Green             = { { { 0.000000000f, 0.501960814f, 0.000000000f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 Blue              = { { { 0.000000000f, 0.000000000f, 1.000000000f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 Yellow            = { { { 1.000000000f, 1.000000000f, 0.000000000f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 Gold              = { { { 1.000000000f, 0.843137324f, 0.000000000f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 CornflowerBlue    = { { { 0.392156899f, 0.584313750f, 0.929411829f, 1.000000000f } } };
+        XMGLOBALCONST XMVECTORF32 Transparent       = { { { 0.000000000f, 0.000000000f, 0.000000000f, 0.000000000f } } };
+    }
+}
@@ -0,0 +1,839 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXMath.h
+//
+// BenchTool stand-in for DirectXMath: the SSE2 subset the DirectXTK sources compiled into
+// BenchTool use, with the same names, conventions (row vectors, row-major matrices) and
+// results as the real library, so the sprite and animation code is timed doing the same
+// vector work it does on Windows.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <emmintrin.h>
+
+#define _XM_SSE_INTRINSICS_
+#define XM_CALLCONV
+#ifdef _MSC_VER
+#define XMGLOBALCONST extern const __declspec(selectany)
+#else
+#define XMGLOBALCONST extern const __attribute__((weak))
+#endif
+
+
+namespace DirectX
+{
+    const float XM_PI       = 3.141592654f;
+    const float XM_2PI      = 6.283185307f;
+    const float XM_PIDIV2   = 1.570796327f;
+    const float XM_PIDIV4   = 0.785398163f;
+
+    const uint32_t XM_SELECT_0 = 0x00000000;
+    const uint32_t XM_SELECT_1 = 0xFFFFFFFF;
+
+    inline float XMConvertToRadians(float degrees) { return degrees * (XM_PI / 180.0f); }
+    inline float XMConvertToDegrees(float radians) { return radians * (180.0f / XM_PI); }
+
+    typedef __m128 XMVECTOR;
+    typedef const XMVECTOR FXMVECTOR;
+    typedef const XMVECTOR GXMVECTOR;
+    typedef const XMVECTOR HXMVECTOR;
+    typedef const XMVECTOR& CXMVECTOR;
+
+    struct XMMATRIX;
+    typedef const XMMATRIX FXMMATRIX;
+    typedef const XMMATRIX& CXMMATRIX;
+
+    struct alignas(16) XMVECTORF32
+    {
+        union
+        {
+            float f[4];
+            XMVECTOR v;
+        };
+
+        inline operator XMVECTOR() const { return v; }
+        inline operator const float*() const { return f; }
+    };
+
+    struct alignas(16) XMVECTORI32
+    {
+        union
+        {
+            int32_t i[4];
+            XMVECTOR v;
+        };
+
+        inline operator XMVECTOR() const { return v; }
+    };
+
+    struct alignas(16) XMVECTORU32
+    {
+        union
+        {
+            uint32_t u[4];
+            XMVECTOR v;
+        };
+
+        inline operator XMVECTOR() const { return v; }
+    };
+
+    struct alignas(16) XMMATRIX
+    {
+        XMVECTOR r[4];
+
+        XMMATRIX() {}
+        XMMATRIX(FXMVECTOR r0, FXMVECTOR r1, FXMVECTOR r2, CXMVECTOR r3) { r[0] = r0; r[1] = r1; r[2] = r2; r[3] = r3; }
+        XMMATRIX(float m00, float m01, float m02, float m03,
+                 float m10, float m11, float m12, float m13,
+                 float m20, float m21, float m22, float m23,
+                 float m30, float m31, float m32, float m33)
+        {
+            r[0] = _mm_setr_ps(m00, m01, m02, m03);
+            r[1] = _mm_setr_ps(m10, m11, m12, m13);
+            r[2] = _mm_setr_ps(m20, m21, m22, m23);
+            r[3] = _mm_setr_ps(m30, m31, m32, m33);
+        }
+
+        XMMATRIX operator* (CXMMATRIX m) const;
+        XMMATRIX& operator*= (CXMMATRIX m);
+    };
+
+    struct XMFLOAT2
+    {
+        float x;
+        float y;
+
+        XMFLOAT2() {}
+        XMFLOAT2(float _x, float _y) : x(_x), y(_y) {}
+    };
+
+    struct XMFLOAT3
+    {
+        float x;
+        float y;
+        float z;
+
+        XMFLOAT3() {}
+        XMFLOAT3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+    };
+
+    struct XMFLOAT4
+    {
+        float x;
+        float y;
+        float z;
+        float w;
+
+        XMFLOAT4() {}
+        XMFLOAT4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+    };
+
+    struct alignas(16) XMFLOAT4A : public XMFLOAT4
+    {
+        XMFLOAT4A() {}
+        XMFLOAT4A(float _x, float _y, float _z, float _w) : XMFLOAT4(_x, _y, _z, _w) {}
+    };
+
+    struct XMINT4
+    {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        int32_t w;
+    };
+
+    struct XMUINT4
+    {
+        uint32_t x;
+        uint32_t y;
+        uint32_t z;
+        uint32_t w;
+    };
+
+    struct XMFLOAT3X3
+    {
+        union
+        {
+            struct
+            {
+                float _11, _12, _13;
+                float _21, _22, _23;
+                float _31, _32, _33;
+            };
+            float m[3][3];
+        };
+    };
+
+    struct XMFLOAT4X4
+    {
+        union
+        {
+            struct
+            {
+                float _11, _12, _13, _14;
+                float _21, _22, _23, _24;
+                float _31, _32, _33, _34;
+                float _41, _42, _43, _44;
+            };
+            float m[4][4];
+        };
+
+        XMFLOAT4X4() {}
+        XMFLOAT4X4(float m00, float m01, float m02, float m03,
+                   float m10, float m11, float m12, float m13,
+                   float m20, float m21, float m22, float m23,
+                   float m30, float m31, float m32, float m33)
+          : _11(m00), _12(m01), _13(m02), _14(m03),
+            _21(m10), _22(m11), _23(m12), _24(m13),
+            _31(m20), _32(m21), _33(m22), _34(m23),
+            _41(m30), _42(m31), _43(m32), _44(m33)
+        {
+        }
+    };
+
+    struct alignas(16) XMFLOAT4X4A : public XMFLOAT4X4
+    {
+    };
+
+    XMGLOBALCONST XMVECTORF32 g_XMZero          = { { { 0.0f, 0.0f, 0.0f, 0.0f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMOne           = { { { 1.0f, 1.0f, 1.0f, 1.0f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMNegativeOne   = { { { -1.0f, -1.0f, -1.0f, -1.0f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMOneHalf       = { { { 0.5f, 0.5f, 0.5f, 0.5f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMEpsilon       = { { { 1.192092896e-7f, 1.192092896e-7f, 1.192092896e-7f, 1.192092896e-7f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMIdentityR0    = { { { 1.0f, 0.0f, 0.0f, 0.0f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMIdentityR1    = { { { 0.0f, 1.0f, 0.0f, 0.0f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMIdentityR2    = { { { 0.0f, 0.0f, 1.0f, 0.0f } } };
+    XMGLOBALCONST XMVECTORF32 g_XMIdentityR3    = { { { 0.0f, 0.0f, 0.0f, 1.0f } } };
+    XMGLOBALCONST XMVECTORU32 g_XMSelect1110    = { { { XM_SELECT_1, XM_SELECT_1, XM_SELECT_1, XM_SELECT_0 } } };
+    XMGLOBALCONST XMVECTORU32 g_XMMaskXYZ       = { { { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000 } } };
+    XMGLOBALCONST XMVECTORU32 g_XMAbsMask       = { { { 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF } } };
+
+
+    //----------------------------------------------------------------------------------
+    // Load and store.
+    //----------------------------------------------------------------------------------
+    inline XMVECTOR XM_CALLCONV XMLoadFloat(const float* p) { return _mm_load_ss(p); }
+    inline XMVECTOR XM_CALLCONV XMLoadInt(const uint32_t* p) { return _mm_load_ss(reinterpret_cast<const float*>(p)); }
+    inline XMVECTOR XM_CALLCONV XMLoadFloat2(const XMFLOAT2* p) { return _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))); }
+    inline XMVECTOR XM_CALLCONV XMLoadFloat3(const XMFLOAT3* p) { return _mm_setr_ps(p->x, p->y, p->z, 0.0f); }
+    inline XMVECTOR XM_CALLCONV XMLoadFloat4(const XMFLOAT4* p) { return _mm_loadu_ps(&p->x); }
+    inline XMVECTOR XM_CALLCONV XMLoadFloat4A(const XMFLOAT4A* p) { return _mm_load_ps(&p->x); }
+    inline XMVECTOR XM_CALLCONV XMLoadInt4(const uint32_t* p) { return _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+
+    inline XMMATRIX XM_CALLCONV XMLoadFloat4x4(const XMFLOAT4X4* p)
+    {
+        XMMATRIX m;
+        m.r[0] = _mm_loadu_ps(&p->_11);
+        m.r[1] = _mm_loadu_ps(&p->_21);
+        m.r[2] = _mm_loadu_ps(&p->_31);
+        m.r[3] = _mm_loadu_ps(&p->_41);
+        return m;
+    }
+
+    inline void XM_CALLCONV XMStoreFloat(float* p, FXMVECTOR v) { _mm_store_ss(p, v); }
+    inline void XM_CALLCONV XMStoreInt(uint32_t* p, FXMVECTOR v) { _mm_store_ss(reinterpret_cast<float*>(p), v); }
+    inline void XM_CALLCONV XMStoreFloat2(XMFLOAT2* p, FXMVECTOR v) { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(v)); }
+
+    inline void XM_CALLCONV XMStoreFloat3(XMFLOAT3* p, FXMVECTOR v)
+    {
+        float f[4];
+        _mm_storeu_ps(f, v);
+        p->x = f[0];
+        p->y = f[1];
+        p->z = f[2];
+    }
+
+    inline void XM_CALLCONV XMStoreFloat4(XMFLOAT4* p, FXMVECTOR v) { _mm_storeu_ps(&p->x, v); }
+    inline void XM_CALLCONV XMStoreFloat4A(XMFLOAT4A* p, FXMVECTOR v) { _mm_store_ps(&p->x, v); }
+
+    inline void XM_CALLCONV XMStoreFloat4x4(XMFLOAT4X4* p, FXMMATRIX m)
+    {
+        _mm_storeu_ps(&p->_11, m.r[0]);
+        _mm_storeu_ps(&p->_21, m.r[1]);
+        _mm_storeu_ps(&p->_31, m.r[2]);
+        _mm_storeu_ps(&p->_41, m.r[3]);
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Vector construction and lanes.
+    //----------------------------------------------------------------------------------
+    inline XMVECTOR XM_CALLCONV XMVectorZero() { return _mm_setzero_ps(); }
+    inline XMVECTOR XM_CALLCONV XMVectorSplatOne() { return _mm_set1_ps(1.0f); }
+    inline XMVECTOR XM_CALLCONV XMVectorSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+    inline XMVECTOR XM_CALLCONV XMVectorReplicate(float value) { return _mm_set1_ps(value); }
+    inline XMVECTOR XM_CALLCONV XMVectorReplicatePtr(const float* p) { return _mm_load_ps1(p); }
+    inline XMVECTOR XM_CALLCONV XMVectorTrueInt() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSplatX(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+    inline XMVECTOR XM_CALLCONV XMVectorSplatY(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+    inline XMVECTOR XM_CALLCONV XMVectorSplatZ(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+    inline XMVECTOR XM_CALLCONV XMVectorSplatW(FXMVECTOR v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+    inline float XM_CALLCONV XMVectorGetX(FXMVECTOR v) { return _mm_cvtss_f32(v); }
+    inline float XM_CALLCONV XMVectorGetY(FXMVECTOR v) { return _mm_cvtss_f32(XMVectorSplatY(v)); }
+    inline float XM_CALLCONV XMVectorGetZ(FXMVECTOR v) { return _mm_cvtss_f32(XMVectorSplatZ(v)); }
+    inline float XM_CALLCONV XMVectorGetW(FXMVECTOR v) { return _mm_cvtss_f32(XMVectorSplatW(v)); }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSetW(FXMVECTOR v, float w)
+    {
+        XMVECTOR t = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 2, 1, 3));
+        t = _mm_move_ss(t, _mm_set_ss(w));
+        return _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 2, 1, 3));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorMergeXY(FXMVECTOR a, FXMVECTOR b) { return _mm_unpacklo_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorMergeZW(FXMVECTOR a, FXMVECTOR b) { return _mm_unpackhi_ps(a, b); }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSelectControl(uint32_t i0, uint32_t i1, uint32_t i2, uint32_t i3)
+    {
+        __m128i control = _mm_setr_epi32(static_cast<int>(i0), static_cast<int>(i1), static_cast<int>(i2), static_cast<int>(i3));
+        return _mm_castsi128_ps(_mm_cmpgt_epi32(control, _mm_setzero_si128()));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorSelect(FXMVECTOR v1, FXMVECTOR v2, FXMVECTOR control)
+    {
+        return _mm_or_ps(_mm_andnot_ps(control, v1), _mm_and_ps(v2, control));
+    }
+
+    // Element i of the result is element Pi of the eight elements of v1 and v2.
+    template<uint32_t P0, uint32_t P1, uint32_t P2, uint32_t P3>
+    inline XMVECTOR XM_CALLCONV XMVectorPermute(FXMVECTOR v1, FXMVECTOR v2)
+    {
+        static_assert(P0 < 8 && P1 < 8 && P2 < 8 && P3 < 8, "Permute indices must be 0-7");
+
+        const int shuffle = _MM_SHUFFLE(P3 & 3, P2 & 3, P1 & 3, P0 & 3);
+        XMVECTOR a = _mm_shuffle_ps(v1, v1, shuffle);
+        XMVECTOR b = _mm_shuffle_ps(v2, v2, shuffle);
+
+        const XMVECTOR select = _mm_castsi128_ps(_mm_setr_epi32(P0 > 3 ? -1 : 0, P1 > 3 ? -1 : 0, P2 > 3 ? -1 : 0, P3 > 3 ? -1 : 0));
+        return _mm_or_ps(_mm_andnot_ps(select, a), _mm_and_ps(select, b));
+    }
+
+    template<uint32_t S0, uint32_t S1, uint32_t S2, uint32_t S3>
+    inline XMVECTOR XM_CALLCONV XMVectorSwizzle(FXMVECTOR v)
+    {
+        static_assert(S0 < 4 && S1 < 4 && S2 < 4 && S3 < 4, "Swizzle indices must be 0-3");
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(S3, S2, S1, S0));
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Arithmetic and comparison.
+    //----------------------------------------------------------------------------------
+    inline XMVECTOR XM_CALLCONV XMVectorAdd(FXMVECTOR a, FXMVECTOR b) { return _mm_add_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorSubtract(FXMVECTOR a, FXMVECTOR b) { return _mm_sub_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorMultiply(FXMVECTOR a, FXMVECTOR b) { return _mm_mul_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorDivide(FXMVECTOR a, FXMVECTOR b) { return _mm_div_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorMultiplyAdd(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    inline XMVECTOR XM_CALLCONV XMVectorNegativeMultiplySubtract(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+    inline XMVECTOR XM_CALLCONV XMVectorScale(FXMVECTOR v, float scale) { return _mm_mul_ps(v, _mm_set1_ps(scale)); }
+    inline XMVECTOR XM_CALLCONV XMVectorReciprocal(FXMVECTOR v) { return _mm_div_ps(_mm_set1_ps(1.0f), v); }
+    inline XMVECTOR XM_CALLCONV XMVectorSqrt(FXMVECTOR v) { return _mm_sqrt_ps(v); }
+    inline XMVECTOR XM_CALLCONV XMVectorNegate(FXMVECTOR v) { return _mm_sub_ps(_mm_setzero_ps(), v); }
+    inline XMVECTOR XM_CALLCONV XMVectorAbs(FXMVECTOR v) { return _mm_and_ps(v, g_XMAbsMask); }
+    inline XMVECTOR XM_CALLCONV XMVectorMin(FXMVECTOR a, FXMVECTOR b) { return _mm_min_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorMax(FXMVECTOR a, FXMVECTOR b) { return _mm_max_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorLerp(FXMVECTOR v0, FXMVECTOR v1, float t) { return _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), _mm_set1_ps(t))); }
+    inline XMVECTOR XM_CALLCONV XMVectorLerpV(FXMVECTOR v0, FXMVECTOR v1, FXMVECTOR t) { return _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), t)); }
+
+    // The polynomial approximations DirectXMath uses, rather than the C library per lane.
+    inline XMVECTOR XM_CALLCONV XMVectorSin(FXMVECTOR v)
+    {
+        // Bring the angle into [-pi, pi], then reflect it into [-pi/2, pi/2].
+        XMVECTOR turns = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(1.0f / XM_2PI))));
+        XMVECTOR x = _mm_sub_ps(v, _mm_mul_ps(turns, _mm_set1_ps(XM_2PI)));
+
+        XMVECTOR sign = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(int(0x80000000))));
+        XMVECTOR reflected = _mm_sub_ps(_mm_or_ps(sign, _mm_set1_ps(XM_PI)), x);
+        XMVECTOR inRange = _mm_cmple_ps(_mm_andnot_ps(sign, x), _mm_set1_ps(XM_PIDIV2));
+        x = _mm_or_ps(_mm_and_ps(inRange, x), _mm_andnot_ps(inRange, reflected));
+
+        XMVECTOR x2 = _mm_mul_ps(x, x);
+        XMVECTOR result = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-2.3889859e-08f), x2), _mm_set1_ps(2.7525562e-06f));
+        result = _mm_add_ps(_mm_mul_ps(result, x2), _mm_set1_ps(-0.00019840874f));
+        result = _mm_add_ps(_mm_mul_ps(result, x2), _mm_set1_ps(0.0083333310f));
+        result = _mm_add_ps(_mm_mul_ps(result, x2), _mm_set1_ps(-0.16666667f));
+        result = _mm_add_ps(_mm_mul_ps(result, x2), _mm_set1_ps(1.0f));
+        return _mm_mul_ps(result, x);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorACos(FXMVECTOR v)
+    {
+        XMVECTOR nonnegative = _mm_cmpge_ps(v, _mm_setzero_ps());
+        XMVECTOR x = _mm_and_ps(v, g_XMAbsMask);
+        XMVECTOR root = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x), _mm_setzero_ps()));
+
+        XMVECTOR t0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.0012624911f), x), _mm_set1_ps(0.0066700901f));
+        t0 = _mm_add_ps(_mm_mul_ps(t0, x), _mm_set1_ps(-0.0170881256f));
+        t0 = _mm_add_ps(_mm_mul_ps(t0, x), _mm_set1_ps(0.0308918810f));
+        t0 = _mm_add_ps(_mm_mul_ps(t0, x), _mm_set1_ps(-0.0501743046f));
+        t0 = _mm_add_ps(_mm_mul_ps(t0, x), _mm_set1_ps(0.0889789874f));
+        t0 = _mm_add_ps(_mm_mul_ps(t0, x), _mm_set1_ps(-0.2145988016f));
+        t0 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(t0, x), _mm_set1_ps(1.5707963050f)), root);
+
+        XMVECTOR t1 = _mm_sub_ps(_mm_set1_ps(XM_PI), t0);
+        return _mm_or_ps(_mm_and_ps(nonnegative, t0), _mm_andnot_ps(nonnegative, t1));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVectorEqual(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpeq_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorLess(FXMVECTOR a, FXMVECTOR b) { return _mm_cmplt_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV XMVectorGreater(FXMVECTOR a, FXMVECTOR b) { return _mm_cmpgt_ps(a, b); }
+    inline bool XM_CALLCONV XMVector4Equal(FXMVECTOR a, FXMVECTOR b) { return _mm_movemask_ps(_mm_cmpeq_ps(a, b)) == 0xF; }
+    inline bool XM_CALLCONV XMVector3Equal(FXMVECTOR a, FXMVECTOR b) { return (_mm_movemask_ps(_mm_cmpeq_ps(a, b)) & 7) == 7; }
+
+    inline XMVECTOR XM_CALLCONV XMConvertVectorIntToFloat(FXMVECTOR v, uint32_t divExponent)
+    {
+        XMVECTOR result = _mm_cvtepi32_ps(_mm_castps_si128(v));
+        return _mm_mul_ps(result, _mm_set1_ps(1.0f / static_cast<float>(1u << divExponent)));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMConvertVectorUIntToFloat(FXMVECTOR v, uint32_t divExponent)
+    {
+        // Convert the low 31 bits as signed, then add 2^31 back where the top bit was set.
+        __m128i i = _mm_castps_si128(v);
+        __m128i top = _mm_srai_epi32(i, 31);
+        XMVECTOR low = _mm_cvtepi32_ps(_mm_and_si128(i, _mm_set1_epi32(0x7FFFFFFF)));
+        XMVECTOR result = _mm_add_ps(low, _mm_and_ps(_mm_castsi128_ps(top), _mm_set1_ps(2147483648.0f)));
+        return _mm_mul_ps(result, _mm_set1_ps(1.0f / static_cast<float>(1u << divExponent)));
+    }
+
+    inline void XMScalarSinCos(float* pSin, float* pCos, float value)
+    {
+        *pSin = sinf(value);
+        *pCos = cosf(value);
+    }
+
+    inline bool XMScalarNearEqual(float s1, float s2, float epsilon)
+    {
+        return fabsf(s1 - s2) <= epsilon;
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Geometric vector functions.
+    //----------------------------------------------------------------------------------
+    inline XMVECTOR XM_CALLCONV XMVector4Dot(FXMVECTOR a, FXMVECTOR b)
+    {
+        XMVECTOR t = _mm_mul_ps(a, b);
+        t = _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3Dot(FXMVECTOR a, FXMVECTOR b)
+    {
+        return XMVector4Dot(_mm_and_ps(a, g_XMMaskXYZ), b);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3Cross(FXMVECTOR a, FXMVECTOR b)
+    {
+        XMVECTOR t1 = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2)));
+        XMVECTOR t2 = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1)));
+        return _mm_and_ps(_mm_sub_ps(t1, t2), g_XMMaskXYZ);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector3Dot(v, v)); }
+    inline XMVECTOR XM_CALLCONV XMVector4Length(FXMVECTOR v) { return _mm_sqrt_ps(XMVector4Dot(v, v)); }
+    inline XMVECTOR XM_CALLCONV XMVector3Normalize(FXMVECTOR v) { return _mm_div_ps(v, XMVector3Length(v)); }
+    inline XMVECTOR XM_CALLCONV XMVector4Normalize(FXMVECTOR v) { return _mm_div_ps(v, XMVector4Length(v)); }
+
+    inline XMVECTOR XM_CALLCONV XMVector4Transform(FXMVECTOR v, FXMMATRIX m)
+    {
+        XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+        result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+        result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+        return _mm_add_ps(result, _mm_mul_ps(XMVectorSplatW(v), m.r[3]));
+    }
+
+    // Transforms the point (x, y, z, 1).
+    inline XMVECTOR XM_CALLCONV XMVector3Transform(FXMVECTOR v, FXMMATRIX m)
+    {
+        XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+        result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+        result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+        return _mm_add_ps(result, m.r[3]);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3TransformCoord(FXMVECTOR v, FXMMATRIX m)
+    {
+        XMVECTOR result = XMVector3Transform(v, m);
+        return _mm_div_ps(result, XMVectorSplatW(result));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3TransformNormal(FXMVECTOR v, FXMMATRIX m)
+    {
+        XMVECTOR result = _mm_mul_ps(XMVectorSplatX(v), m.r[0]);
+        result = _mm_add_ps(result, _mm_mul_ps(XMVectorSplatY(v), m.r[1]));
+        return _mm_add_ps(result, _mm_mul_ps(XMVectorSplatZ(v), m.r[2]));
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Quaternions, as (x, y, z, w).
+    //----------------------------------------------------------------------------------
+    inline XMVECTOR XM_CALLCONV XMQuaternionIdentity() { return g_XMIdentityR3; }
+    inline XMVECTOR XM_CALLCONV XMQuaternionDot(FXMVECTOR a, FXMVECTOR b) { return XMVector4Dot(a, b); }
+    inline XMVECTOR XM_CALLCONV XMQuaternionNormalize(FXMVECTOR q) { return XMVector4Normalize(q); }
+    inline XMVECTOR XM_CALLCONV XMQuaternionConjugate(FXMVECTOR q) { return _mm_mul_ps(q, _mm_setr_ps(-1.0f, -1.0f, -1.0f, 1.0f)); }
+
+    // Returns q2 * q1: the rotation q1 followed by the rotation q2.
+    inline XMVECTOR XM_CALLCONV XMQuaternionMultiply(FXMVECTOR q1, FXMVECTOR q2)
+    {
+        XMFLOAT4 a, b;
+        XMStoreFloat4(&a, q1);
+        XMStoreFloat4(&b, q2);
+
+        return XMVectorSet(b.w * a.x + b.x * a.w + b.y * a.z - b.z * a.y,
+                           b.w * a.y - b.x * a.z + b.y * a.w + b.z * a.x,
+                           b.w * a.z + b.x * a.y - b.y * a.x + b.z * a.w,
+                           b.w * a.w - b.x * a.x - b.y * a.y - b.z * a.z);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMQuaternionRotationRollPitchYaw(float pitch, float yaw, float roll)
+    {
+        float sp = sinf(pitch * 0.5f), cp = cosf(pitch * 0.5f);
+        float sy = sinf(yaw * 0.5f), cy = cosf(yaw * 0.5f);
+        float sr = sinf(roll * 0.5f), cr = cosf(roll * 0.5f);
+
+        return XMVectorSet(sp * cy * cr + cp * sy * sr,
+                           cp * sy * cr - sp * cy * sr,
+                           cp * cy * sr - sp * sy * cr,
+                           cp * cy * cr + sp * sy * sr);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMQuaternionRotationAxis(FXMVECTOR axis, float angle)
+    {
+        XMVECTOR n = XMVector3Normalize(axis);
+        float s = sinf(angle * 0.5f);
+        return XMVectorSetW(_mm_mul_ps(n, _mm_set1_ps(s)), cosf(angle * 0.5f));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMQuaternionSlerp(FXMVECTOR q0, FXMVECTOR q1, float t)
+    {
+        float cosOmega = XMVectorGetX(XMVector4Dot(q0, q1));
+        float sign = (cosOmega < 0.0f) ? -1.0f : 1.0f;
+        cosOmega *= sign;
+
+        float s0, s1;
+        if (1.0f - cosOmega > 1.0e-6f)
+        {
+            float sinOmega = sqrtf(1.0f - cosOmega * cosOmega);
+            float omega = atan2f(sinOmega, cosOmega);
+            s0 = sinf((1.0f - t) * omega) / sinOmega;
+            s1 = sinf(t * omega) / sinOmega;
+        }
+        else
+        {
+            s0 = 1.0f - t;
+            s1 = t;
+        }
+
+        return _mm_add_ps(_mm_mul_ps(q0, _mm_set1_ps(s0)), _mm_mul_ps(q1, _mm_set1_ps(s1 * sign)));
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3Rotate(FXMVECTOR v, FXMVECTOR q)
+    {
+        XMVECTOR a = _mm_and_ps(v, g_XMMaskXYZ);
+        return XMQuaternionMultiply(XMQuaternionMultiply(XMQuaternionConjugate(q), a), q);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMVector3InverseRotate(FXMVECTOR v, FXMVECTOR q)
+    {
+        XMVECTOR a = _mm_and_ps(v, g_XMMaskXYZ);
+        return XMQuaternionMultiply(XMQuaternionMultiply(q, a), XMQuaternionConjugate(q));
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Matrices.
+    //----------------------------------------------------------------------------------
+    inline XMMATRIX XM_CALLCONV XMMatrixIdentity()
+    {
+        return XMMATRIX(g_XMIdentityR0, g_XMIdentityR1, g_XMIdentityR2, g_XMIdentityR3);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixMultiply(FXMMATRIX a, CXMMATRIX b)
+    {
+        XMMATRIX result;
+        for (int i = 0; i < 4; i++)
+        {
+            XMVECTOR v = a.r[i];
+            XMVECTOR r = _mm_mul_ps(XMVectorSplatX(v), b.r[0]);
+            r = _mm_add_ps(r, _mm_mul_ps(XMVectorSplatY(v), b.r[1]));
+            r = _mm_add_ps(r, _mm_mul_ps(XMVectorSplatZ(v), b.r[2]));
+            result.r[i] = _mm_add_ps(r, _mm_mul_ps(XMVectorSplatW(v), b.r[3]));
+        }
+        return result;
+    }
+
+    inline XMMATRIX XMMATRIX::operator* (CXMMATRIX m) const { return XMMatrixMultiply(*this, m); }
+    inline XMMATRIX& XMMATRIX::operator*= (CXMMATRIX m) { *this = XMMatrixMultiply(*this, m); return *this; }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixTranspose(FXMMATRIX m)
+    {
+        XMMATRIX result = m;
+        _MM_TRANSPOSE4_PS(result.r[0], result.r[1], result.r[2], result.r[3]);
+        return result;
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixScaling(float x, float y, float z)
+    {
+        return XMMATRIX(x, 0, 0, 0, 0, y, 0, 0, 0, 0, z, 0, 0, 0, 0, 1);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixScalingFromVector(FXMVECTOR scale)
+    {
+        XMFLOAT4 s;
+        XMStoreFloat4(&s, scale);
+        return XMMatrixScaling(s.x, s.y, s.z);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixTranslation(float x, float y, float z)
+    {
+        return XMMATRIX(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixTranslationFromVector(FXMVECTOR offset)
+    {
+        XMFLOAT4 t;
+        XMStoreFloat4(&t, offset);
+        return XMMatrixTranslation(t.x, t.y, t.z);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixRotationQuaternion(FXMVECTOR quaternion)
+    {
+        XMFLOAT4 q;
+        XMStoreFloat4(&q, quaternion);
+
+        float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+        return XMMATRIX(1 - 2 * (yy + zz), 2 * (xy + wz),     2 * (xz - wy),     0,
+                        2 * (xy - wz),     1 - 2 * (xx + zz), 2 * (yz + wx),     0,
+                        2 * (xz + wy),     2 * (yz - wx),     1 - 2 * (xx + yy), 0,
+                        0,                 0,                 0,                 1);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixRotationY(float angle)
+    {
+        float s = sinf(angle), c = cosf(angle);
+        return XMMATRIX(c, 0, -s, 0, 0, 1, 0, 0, s, 0, c, 0, 0, 0, 0, 1);
+    }
+
+    inline XMVECTOR XM_CALLCONV XMQuaternionRotationMatrix(FXMMATRIX m)
+    {
+        XMFLOAT4X4 f;
+        XMStoreFloat4x4(&f, m);
+
+        float trace = f._11 + f._22 + f._33;
+
+        if (trace > 0.0f)
+        {
+            float s = sqrtf(trace + 1.0f) * 2.0f;
+            return XMVectorSet((f._23 - f._32) / s, (f._31 - f._13) / s, (f._12 - f._21) / s, 0.25f * s);
+        }
+        else if (f._11 > f._22 && f._11 > f._33)
+        {
+            float s = sqrtf(1.0f + f._11 - f._22 - f._33) * 2.0f;
+            return XMVectorSet(0.25f * s, (f._12 + f._21) / s, (f._31 + f._13) / s, (f._23 - f._32) / s);
+        }
+        else if (f._22 > f._33)
+        {
+            float s = sqrtf(1.0f + f._22 - f._11 - f._33) * 2.0f;
+            return XMVectorSet((f._12 + f._21) / s, 0.25f * s, (f._23 + f._32) / s, (f._31 - f._13) / s);
+        }
+        else
+        {
+            float s = sqrtf(1.0f + f._33 - f._11 - f._22) * 2.0f;
+            return XMVectorSet((f._31 + f._13) / s, (f._23 + f._32) / s, 0.25f * s, (f._12 - f._21) / s);
+        }
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixAffineTransformation(FXMVECTOR scaling, FXMVECTOR rotationOrigin, FXMVECTOR rotationQuaternion, GXMVECTOR translation)
+    {
+        XMVECTOR origin = _mm_and_ps(rotationOrigin, g_XMMaskXYZ);
+
+        XMMATRIX m = XMMatrixScalingFromVector(scaling);
+        m.r[3] = _mm_sub_ps(m.r[3], origin);
+        m = XMMatrixMultiply(m, XMMatrixRotationQuaternion(rotationQuaternion));
+        m.r[3] = _mm_add_ps(m.r[3], origin);
+        m.r[3] = _mm_add_ps(m.r[3], _mm_and_ps(translation, g_XMMaskXYZ));
+        return m;
+    }
+
+    inline XMVECTOR XM_CALLCONV XMMatrixDeterminant(FXMMATRIX m)
+    {
+        XMFLOAT4X4 f;
+        XMStoreFloat4x4(&f, m);
+
+        float s0 = f._11 * f._22 - f._21 * f._12;
+        float s1 = f._11 * f._23 - f._21 * f._13;
+        float s2 = f._11 * f._24 - f._21 * f._14;
+        float s3 = f._12 * f._23 - f._22 * f._13;
+        float s4 = f._12 * f._24 - f._22 * f._14;
+        float s5 = f._13 * f._24 - f._23 * f._14;
+        float c5 = f._33 * f._44 - f._43 * f._34;
+        float c4 = f._32 * f._44 - f._42 * f._34;
+        float c3 = f._32 * f._43 - f._42 * f._33;
+        float c2 = f._31 * f._44 - f._41 * f._34;
+        float c1 = f._31 * f._43 - f._41 * f._33;
+        float c0 = f._31 * f._42 - f._41 * f._32;
+
+        return _mm_set1_ps(s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixInverse(XMVECTOR* pDeterminant, FXMMATRIX m)
+    {
+        XMFLOAT4X4 f;
+        XMStoreFloat4x4(&f, m);
+
+        float s0 = f._11 * f._22 - f._21 * f._12;
+        float s1 = f._11 * f._23 - f._21 * f._13;
+        float s2 = f._11 * f._24 - f._21 * f._14;
+        float s3 = f._12 * f._23 - f._22 * f._13;
+        float s4 = f._12 * f._24 - f._22 * f._14;
+        float s5 = f._13 * f._24 - f._23 * f._14;
+        float c5 = f._33 * f._44 - f._43 * f._34;
+        float c4 = f._32 * f._44 - f._42 * f._34;
+        float c3 = f._32 * f._43 - f._42 * f._33;
+        float c2 = f._31 * f._44 - f._41 * f._34;
+        float c1 = f._31 * f._43 - f._41 * f._33;
+        float c0 = f._31 * f._42 - f._41 * f._32;
+
+        float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        if (pDeterminant)
+            *pDeterminant = _mm_set1_ps(det);
+
+        float inv = 1.0f / det;
+
+        return XMMATRIX(
+            ( f._22 * c5 - f._23 * c4 + f._24 * c3) * inv,
+            (-f._12 * c5 + f._13 * c4 - f._14 * c3) * inv,
+            ( f._42 * s5 - f._43 * s4 + f._44 * s3) * inv,
+            (-f._32 * s5 + f._33 * s4 - f._34 * s3) * inv,
+
+            (-f._21 * c5 + f._23 * c2 - f._24 * c1) * inv,
+            ( f._11 * c5 - f._13 * c2 + f._14 * c1) * inv,
+            (-f._41 * s5 + f._43 * s2 - f._44 * s1) * inv,
+            ( f._31 * s5 - f._33 * s2 + f._34 * s1) * inv,
+
+            ( f._21 * c4 - f._22 * c2 + f._24 * c0) * inv,
+            (-f._11 * c4 + f._12 * c2 - f._14 * c0) * inv,
+            ( f._41 * s4 - f._42 * s2 + f._44 * s0) * inv,
+            (-f._31 * s4 + f._32 * s2 - f._34 * s0) * inv,
+
+            (-f._21 * c3 + f._22 * c1 - f._23 * c0) * inv,
+            ( f._11 * c3 - f._12 * c1 + f._13 * c0) * inv,
+            (-f._41 * s3 + f._42 * s1 - f._43 * s0) * inv,
+            ( f._31 * s3 - f._32 * s1 + f._33 * s0) * inv);
+    }
+
+    // Splits an affine matrix into scale, rotation and translation. A mirrored basis is
+    // returned as a negative x scale.
+    inline bool XM_CALLCONV XMMatrixDecompose(XMVECTOR* outScale, XMVECTOR* outRotQuat, XMVECTOR* outTrans, FXMMATRIX m)
+    {
+        *outTrans = _mm_and_ps(m.r[3], g_XMMaskXYZ);
+
+        XMVECTOR axes[3] = { _mm_and_ps(m.r[0], g_XMMaskXYZ), _mm_and_ps(m.r[1], g_XMMaskXYZ), _mm_and_ps(m.r[2], g_XMMaskXYZ) };
+
+        float scale[3];
+        for (int i = 0; i < 3; i++)
+        {
+            scale[i] = XMVectorGetX(XMVector3Length(axes[i]));
+            if (scale[i] < 1.0e-6f)
+                return false;
+
+            axes[i] = _mm_div_ps(axes[i], _mm_set1_ps(scale[i]));
+        }
+
+        if (XMVectorGetX(XMVector3Dot(XMVector3Cross(axes[0], axes[1]), axes[2])) < 0.0f)
+        {
+            scale[0] = -scale[0];
+            axes[0] = XMVectorNegate(axes[0]);
+        }
+
+        *outScale = XMVectorSet(scale[0], scale[1], scale[2], 0.0f);
+        *outRotQuat = XMQuaternionRotationMatrix(XMMATRIX(axes[0], axes[1], axes[2], g_XMIdentityR3));
+        return true;
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixPerspectiveFovLH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+    {
+        float height = 1.0f / tanf(0.5f * fovAngleY);
+        float width = height / aspectRatio;
+        float range = farZ / (farZ - nearZ);
+
+        return XMMATRIX(width, 0, 0, 0, 0, height, 0, 0, 0, 0, range, 1, 0, 0, -range * nearZ, 0);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixPerspectiveFovRH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+    {
+        float height = 1.0f / tanf(0.5f * fovAngleY);
+        float width = height / aspectRatio;
+        float range = farZ / (nearZ - farZ);
+
+        return XMMATRIX(width, 0, 0, 0, 0, height, 0, 0, 0, 0, range, -1, 0, 0, range * nearZ, 0);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixLookAtLH(FXMVECTOR eyePosition, FXMVECTOR focusPosition, FXMVECTOR upDirection)
+    {
+        XMVECTOR r2 = XMVector3Normalize(_mm_sub_ps(focusPosition, eyePosition));
+        XMVECTOR r0 = XMVector3Normalize(XMVector3Cross(upDirection, r2));
+        XMVECTOR r1 = XMVector3Cross(r2, r0);
+        XMVECTOR negEye = XMVectorNegate(eyePosition);
+
+        XMMATRIX m(XMVectorSetW(r0, XMVectorGetX(XMVector3Dot(r0, negEye))),
+                   XMVectorSetW(r1, XMVectorGetX(XMVector3Dot(r1, negEye))),
+                   XMVectorSetW(r2, XMVectorGetX(XMVector3Dot(r2, negEye))),
+                   g_XMIdentityR3);
+        return XMMatrixTranspose(m);
+    }
+
+    inline XMMATRIX XM_CALLCONV XMMatrixLookAtRH(FXMVECTOR eyePosition, FXMVECTOR focusPosition, FXMVECTOR upDirection)
+    {
+        return XMMatrixLookAtLH(eyePosition, _mm_sub_ps(_mm_add_ps(eyePosition, eyePosition), focusPosition), upDirection);
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Operators. GCC and Clang have them built in for __m128; these cover the constant
+    // types, and everything under Visual C++.
+    //----------------------------------------------------------------------------------
+#ifdef _MSC_VER
+    inline XMVECTOR XM_CALLCONV operator+ (FXMVECTOR v) { return v; }
+    inline XMVECTOR XM_CALLCONV operator- (FXMVECTOR v) { return XMVectorNegate(v); }
+    inline XMVECTOR XM_CALLCONV operator+ (FXMVECTOR a, FXMVECTOR b) { return _mm_add_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV operator- (FXMVECTOR a, FXMVECTOR b) { return _mm_sub_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV operator* (FXMVECTOR a, FXMVECTOR b) { return _mm_mul_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV operator/ (FXMVECTOR a, FXMVECTOR b) { return _mm_div_ps(a, b); }
+    inline XMVECTOR XM_CALLCONV operator* (FXMVECTOR v, float s) { return XMVectorScale(v, s); }
+    inline XMVECTOR XM_CALLCONV operator* (float s, FXMVECTOR v) { return XMVectorScale(v, s); }
+    inline XMVECTOR XM_CALLCONV operator/ (FXMVECTOR v, float s) { return _mm_div_ps(v, _mm_set1_ps(s)); }
+    inline XMVECTOR& XM_CALLCONV operator+= (XMVECTOR& a, FXMVECTOR b) { a = _mm_add_ps(a, b); return a; }
+    inline XMVECTOR& XM_CALLCONV operator-= (XMVECTOR& a, FXMVECTOR b) { a = _mm_sub_ps(a, b); return a; }
+    inline XMVECTOR& XM_CALLCONV operator*= (XMVECTOR& a, FXMVECTOR b) { a = _mm_mul_ps(a, b); return a; }
+    inline XMVECTOR& XM_CALLCONV operator/= (XMVECTOR& a, FXMVECTOR b) { a = _mm_div_ps(a, b); return a; }
+    inline XMVECTOR& XM_CALLCONV operator*= (XMVECTOR& v, float s) { v = XMVectorScale(v, s); return v; }
+#else
+    inline XMVECTOR XM_CALLCONV operator+ (XMVECTORF32 const& a, FXMVECTOR b) { return _mm_add_ps(a.v, b); }
+    inline XMVECTOR XM_CALLCONV operator- (XMVECTORF32 const& a, FXMVECTOR b) { return _mm_sub_ps(a.v, b); }
+    inline XMVECTOR XM_CALLCONV operator* (XMVECTORF32 const& a, FXMVECTOR b) { return _mm_mul_ps(a.v, b); }
+    inline XMVECTOR XM_CALLCONV operator+ (FXMVECTOR a, XMVECTORF32 const& b) { return _mm_add_ps(a, b.v); }
+    inline XMVECTOR XM_CALLCONV operator- (FXMVECTOR a, XMVECTORF32 const& b) { return _mm_sub_ps(a, b.v); }
+    inline XMVECTOR XM_CALLCONV operator* (FXMVECTOR a, XMVECTORF32 const& b) { return _mm_mul_ps(a, b.v); }
+#endif
+}
@@ -0,0 +1,86 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXPackedVector.h
+//
+// BenchTool stand-in for DirectXPackedVector: the 8-bit color formats vertex and color
+// code packs into.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+
+namespace DirectX
+{
+    namespace PackedVector
+    {
+        // BGRA, with blue in the low byte.
+        struct XMCOLOR
+        {
+            uint32_t c;
+
+            XMCOLOR() {}
+            explicit XMCOLOR(uint32_t color) : c(color) {}
+            operator uint32_t() const { return c; }
+        };
+
+        // RGBA, with red in the low byte.
+        struct XMUBYTEN4
+        {
+            union
+            {
+                struct
+                {
+                    uint8_t x;
+                    uint8_t y;
+                    uint8_t z;
+                    uint8_t w;
+                };
+                uint32_t v;
+            };
+
+            XMUBYTEN4() {}
+            explicit XMUBYTEN4(uint32_t packed) : v(packed) {}
+        };
+
+        inline XMVECTOR XM_CALLCONV XMLoadUByteN4(const XMUBYTEN4* p)
+        {
+            __m128i i = _mm_cvtsi32_si128(static_cast<int>(p->v));
+            i = _mm_unpacklo_epi8(i, _mm_setzero_si128());
+            i = _mm_unpacklo_epi16(i, _mm_setzero_si128());
+            return _mm_mul_ps(_mm_cvtepi32_ps(i), _mm_set1_ps(1.0f / 255.0f));
+        }
+
+        inline void XM_CALLCONV XMStoreUByteN4(XMUBYTEN4* p, FXMVECTOR v)
+        {
+            XMVECTOR n = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+            __m128i i = _mm_cvtps_epi32(_mm_mul_ps(n, _mm_set1_ps(255.0f)));
+            i = _mm_packs_epi32(i, i);
+            i = _mm_packus_epi16(i, i);
+            p->v = static_cast<uint32_t>(_mm_cvtsi128_si32(i));
+        }
+
+        inline XMVECTOR XM_CALLCONV XMLoadColor(const XMCOLOR* p)
+        {
+            XMUBYTEN4 bgra(p->c);
+            XMVECTOR v = XMLoadUByteN4(&bgra);
+            return XMVectorSwizzle<2, 1, 0, 3>(v);
+        }
+
+        inline void XM_CALLCONV XMStoreColor(XMCOLOR* p, FXMVECTOR v)
+        {
+            XMUBYTEN4 bgra;
+            XMStoreUByteN4(&bgra, XMVectorSwizzle<2, 1, 0, 3>(v));
+            p->c = bgra.v;
+        }
+    }
+}
@@ -0,0 +1,848 @@
+//--------------------------------------------------------------------------------------
+// File: d3d11_1.h
+//
+// BenchTool stand-in for the Direct3D 11 headers. The interfaces declare only the methods
+// the DirectXTK sources compiled into BenchTool call, with the same signatures as the
+// real ones; RecordingDevice.h implements them on the CPU.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <windows.h>
+
+
+//--------------------------------------------------------------------------------------
+// DXGI
+//--------------------------------------------------------------------------------------
+enum DXGI_FORMAT
+{
+    DXGI_FORMAT_UNKNOWN                     = 0,
+    DXGI_FORMAT_R32G32B32A32_TYPELESS       = 1,
+    DXGI_FORMAT_R32G32B32A32_FLOAT          = 2,
+    DXGI_FORMAT_R32G32B32A32_UINT           = 3,
+    DXGI_FORMAT_R32G32B32A32_SINT           = 4,
+    DXGI_FORMAT_R32G32B32_TYPELESS          = 5,
+    DXGI_FORMAT_R32G32B32_FLOAT             = 6,
+    DXGI_FORMAT_R32G32B32_UINT              = 7,
+    DXGI_FORMAT_R32G32B32_SINT              = 8,
+    DXGI_FORMAT_R16G16B16A16_TYPELESS       = 9,
+    DXGI_FORMAT_R16G16B16A16_FLOAT          = 10,
+    DXGI_FORMAT_R16G16B16A16_UNORM          = 11,
+    DXGI_FORMAT_R16G16B16A16_UINT           = 12,
+    DXGI_FORMAT_R16G16B16A16_SNORM          = 13,
+    DXGI_FORMAT_R16G16B16A16_SINT           = 14,
+    DXGI_FORMAT_R32G32_TYPELESS             = 15,
+    DXGI_FORMAT_R32G32_FLOAT                = 16,
+    DXGI_FORMAT_R32G32_UINT                 = 17,
+    DXGI_FORMAT_R32G32_SINT                 = 18,
+    DXGI_FORMAT_R32G8X24_TYPELESS           = 19,
+    DXGI_FORMAT_D32_FLOAT_S8X24_UINT        = 20,
+    DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS    = 21,
+    DXGI_FORMAT_X32_TYPELESS_G8X24_UINT     = 22,
+    DXGI_FORMAT_R10G10B10A2_TYPELESS        = 23,
+    DXGI_FORMAT_R10G10B10A2_UNORM           = 24,
+    DXGI_FORMAT_R10G10B10A2_UINT            = 25,
+    DXGI_FORMAT_R11G11B10_FLOAT             = 26,
+    DXGI_FORMAT_R8G8B8A8_TYPELESS           = 27,
+    DXGI_FORMAT_R8G8B8A8_UNORM              = 28,
+    DXGI_FORMAT_R8G8B8A8_UNORM_SRGB         = 29,
+    DXGI_FORMAT_R8G8B8A8_UINT               = 30,
+    DXGI_FORMAT_R8G8B8A8_SNORM              = 31,
+    DXGI_FORMAT_R8G8B8A8_SINT               = 32,
+    DXGI_FORMAT_R16G16_TYPELESS             = 33,
+    DXGI_FORMAT_R16G16_FLOAT                = 34,
+    DXGI_FORMAT_R16G16_UNORM                = 35,
+    DXGI_FORMAT_R16G16_UINT                 = 36,
+    DXGI_FORMAT_R16G16_SNORM                = 37,
+    DXGI_FORMAT_R16G16_SINT                 = 38,
+    DXGI_FORMAT_R32_TYPELESS                = 39,
+    DXGI_FORMAT_D32_FLOAT                   = 40,
+    DXGI_FORMAT_R32_FLOAT                   = 41,
+    DXGI_FORMAT_R32_UINT                    = 42,
+    DXGI_FORMAT_R32_SINT                    = 43,
+    DXGI_FORMAT_R24G8_TYPELESS              = 44,
+    DXGI_FORMAT_D24_UNORM_S8_UINT           = 45,
+    DXGI_FORMAT_R24_UNORM_X8_TYPELESS       = 46,
+    DXGI_FORMAT_X24_TYPELESS_G8_UINT        = 47,
+    DXGI_FORMAT_R8G8_TYPELESS               = 48,
+    DXGI_FORMAT_R8G8_UNORM                  = 49,
+    DXGI_FORMAT_R8G8_UINT                   = 50,
+    DXGI_FORMAT_R8G8_SNORM                  = 51,
+    DXGI_FORMAT_R8G8_SINT                   = 52,
+    DXGI_FORMAT_R16_TYPELESS                = 53,
+    DXGI_FORMAT_R16_FLOAT                   = 54,
+    DXGI_FORMAT_D16_UNORM                   = 55,
+    DXGI_FORMAT_R16_UNORM                   = 56,
+    DXGI_FORMAT_R16_UINT                    = 57,
+    DXGI_FORMAT_R16_SNORM                   = 58,
+    DXGI_FORMAT_R16_SINT                    = 59,
+    DXGI_FORMAT_R8_TYPELESS                 = 60,
+    DXGI_FORMAT_R8_UNORM                    = 61,
+    DXGI_FORMAT_R8_UINT                     = 62,
+    DXGI_FORMAT_R8_SNORM                    = 63,
+    DXGI_FORMAT_R8_SINT                     = 64,
+    DXGI_FORMAT_A8_UNORM                    = 65,
+    DXGI_FORMAT_R1_UNORM                    = 66,
+    DXGI_FORMAT_R9G9B9E5_SHAREDEXP          = 67,
+    DXGI_FORMAT_R8G8_B8G8_UNORM             = 68,
+    DXGI_FORMAT_G8R8_G8B8_UNORM             = 69,
+    DXGI_FORMAT_BC1_TYPELESS                = 70,
+    DXGI_FORMAT_BC1_UNORM                   = 71,
+    DXGI_FORMAT_BC1_UNORM_SRGB              = 72,
+    DXGI_FORMAT_BC2_TYPELESS                = 73,
+    DXGI_FORMAT_BC2_UNORM                   = 74,
+    DXGI_FORMAT_BC2_UNORM_SRGB              = 75,
+    DXGI_FORMAT_BC3_TYPELESS                = 76,
+    DXGI_FORMAT_BC3_UNORM                   = 77,
+    DXGI_FORMAT_BC3_UNORM_SRGB              = 78,
+    DXGI_FORMAT_BC4_TYPELESS                = 79,
+    DXGI_FORMAT_BC4_UNORM                   = 80,
+    DXGI_FORMAT_BC4_SNORM                   = 81,
+    DXGI_FORMAT_BC5_TYPELESS                = 82,
+    DXGI_FORMAT_BC5_UNORM                   = 83,
+    DXGI_FORMAT_BC5_SNORM                   = 84,
+    DXGI_FORMAT_B5G6R5_UNORM                = 85,
+    DXGI_FORMAT_B5G5R5A1_UNORM              = 86,
+    DXGI_FORMAT_B8G8R8A8_UNORM              = 87,
+    DXGI_FORMAT_B8G8R8X8_UNORM              = 88,
+    DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM  = 89,
+    DXGI_FORMAT_B8G8R8A8_TYPELESS           = 90,
+    DXGI_FORMAT_B8G8R8A8_UNORM_SRGB         = 91,
+    DXGI_FORMAT_B8G8R8X8_TYPELESS           = 92,
+    DXGI_FORMAT_B8G8R8X8_UNORM_SRGB         = 93,
+    DXGI_FORMAT_BC6H_TYPELESS               = 94,
+    DXGI_FORMAT_BC6H_UF16                   = 95,
+    DXGI_FORMAT_BC6H_SF16                   = 96,
+    DXGI_FORMAT_BC7_TYPELESS                = 97,
+    DXGI_FORMAT_BC7_UNORM                   = 98,
+    DXGI_FORMAT_BC7_UNORM_SRGB              = 99,
+    DXGI_FORMAT_AYUV                        = 100,
+    DXGI_FORMAT_Y410                        = 101,
+    DXGI_FORMAT_Y416                        = 102,
+    DXGI_FORMAT_NV12                        = 103,
+    DXGI_FORMAT_P010                        = 104,
+    DXGI_FORMAT_P016                        = 105,
+    DXGI_FORMAT_420_OPAQUE                  = 106,
+    DXGI_FORMAT_YUY2                        = 107,
+    DXGI_FORMAT_Y210                        = 108,
+    DXGI_FORMAT_Y216                        = 109,
+    DXGI_FORMAT_NV11                        = 110,
+    DXGI_FORMAT_AI44                        = 111,
+    DXGI_FORMAT_IA44                        = 112,
+    DXGI_FORMAT_P8                          = 113,
+    DXGI_FORMAT_A8P8                        = 114,
+    DXGI_FORMAT_B4G4R4A4_UNORM              = 115,
+    DXGI_FORMAT_FORCE_UINT                  = 0xffffffff
+};
+
+struct DXGI_SAMPLE_DESC
+{
+    UINT Count;
+    UINT Quality;
+};
+
+enum DXGI_MODE_ROTATION
+{
+    DXGI_MODE_ROTATION_UNSPECIFIED  = 0,
+    DXGI_MODE_ROTATION_IDENTITY     = 1,
+    DXGI_MODE_ROTATION_ROTATE90     = 2,
+    DXGI_MODE_ROTATION_ROTATE180    = 3,
+    DXGI_MODE_ROTATION_ROTATE270    = 4
+};
+
+#define DXGI_ERROR_UNSUPPORTED          static_cast<HRESULT>(0x887A0004)
+#define DXGI_ERROR_WAS_STILL_DRAWING    static_cast<HRESULT>(0x887A000A)
+
+
+//--------------------------------------------------------------------------------------
+// Enumerations and limits.
+//--------------------------------------------------------------------------------------
+enum D3D_FEATURE_LEVEL
+{
+    D3D_FEATURE_LEVEL_9_1   = 0x9100,
+    D3D_FEATURE_LEVEL_9_2   = 0x9200,
+    D3D_FEATURE_LEVEL_9_3   = 0x9300,
+    D3D_FEATURE_LEVEL_10_0  = 0xa000,
+    D3D_FEATURE_LEVEL_10_1  = 0xa100,
+    D3D_FEATURE_LEVEL_11_0  = 0xb000,
+    D3D_FEATURE_LEVEL_11_1  = 0xb100
+};
+
+enum D3D_PRIMITIVE_TOPOLOGY
+{
+    D3D_PRIMITIVE_TOPOLOGY_UNDEFINED        = 0,
+    D3D_PRIMITIVE_TOPOLOGY_POINTLIST        = 1,
+    D3D_PRIMITIVE_TOPOLOGY_LINELIST         = 2,
+    D3D_PRIMITIVE_TOPOLOGY_LINESTRIP        = 3,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST     = 4,
+    D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP    = 5,
+    D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED      = 0,
+    D3D11_PRIMITIVE_TOPOLOGY_POINTLIST      = 1,
+    D3D11_PRIMITIVE_TOPOLOGY_LINELIST       = 2,
+    D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP      = 3,
+    D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST   = 4,
+    D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP  = 5
+};
+typedef D3D_PRIMITIVE_TOPOLOGY D3D11_PRIMITIVE_TOPOLOGY;
+
+enum D3D_SRV_DIMENSION
+{
+    D3D_SRV_DIMENSION_UNKNOWN               = 0,
+    D3D_SRV_DIMENSION_BUFFER                = 1,
+    D3D_SRV_DIMENSION_TEXTURE1D             = 2,
+    D3D_SRV_DIMENSION_TEXTURE1DARRAY        = 3,
+    D3D_SRV_DIMENSION_TEXTURE2D             = 4,
+    D3D_SRV_DIMENSION_TEXTURE2DARRAY        = 5,
+    D3D_SRV_DIMENSION_TEXTURE2DMS           = 6,
+    D3D_SRV_DIMENSION_TEXTURE2DMSARRAY      = 7,
+    D3D_SRV_DIMENSION_TEXTURE3D             = 8,
+    D3D_SRV_DIMENSION_TEXTURECUBE           = 9,
+    D3D_SRV_DIMENSION_TEXTURECUBEARRAY      = 10,
+    D3D_SRV_DIMENSION_BUFFEREX              = 11,
+    D3D11_SRV_DIMENSION_UNKNOWN             = 0,
+    D3D11_SRV_DIMENSION_BUFFER              = 1,
+    D3D11_SRV_DIMENSION_TEXTURE1D           = 2,
+    D3D11_SRV_DIMENSION_TEXTURE1DARRAY      = 3,
+    D3D11_SRV_DIMENSION_TEXTURE2D           = 4,
+    D3D11_SRV_DIMENSION_TEXTURE2DARRAY      = 5,
+    D3D11_SRV_DIMENSION_TEXTURE2DMS         = 6,
+    D3D11_SRV_DIMENSION_TEXTURE2DMSARRAY    = 7,
+    D3D11_SRV_DIMENSION_TEXTURE3D           = 8,
+    D3D11_SRV_DIMENSION_TEXTURECUBE         = 9,
+    D3D11_SRV_DIMENSION_TEXTURECUBEARRAY    = 10,
+    D3D11_SRV_DIMENSION_BUFFEREX            = 11
+};
+typedef D3D_SRV_DIMENSION D3D11_SRV_DIMENSION;
+
+enum D3D11_RESOURCE_DIMENSION
+{
+    D3D11_RESOURCE_DIMENSION_UNKNOWN    = 0,
+    D3D11_RESOURCE_DIMENSION_BUFFER     = 1,
+    D3D11_RESOURCE_DIMENSION_TEXTURE1D  = 2,
+    D3D11_RESOURCE_DIMENSION_TEXTURE2D  = 3,
+    D3D11_RESOURCE_DIMENSION_TEXTURE3D  = 4
+};
+
+enum D3D11_USAGE
+{
+    D3D11_USAGE_DEFAULT     = 0,
+    D3D11_USAGE_IMMUTABLE   = 1,
+    D3D11_USAGE_DYNAMIC     = 2,
+    D3D11_USAGE_STAGING     = 3
+};
+
+enum D3D11_BIND_FLAG
+{
+    D3D11_BIND_VERTEX_BUFFER    = 0x1,
+    D3D11_BIND_INDEX_BUFFER     = 0x2,
+    D3D11_BIND_CONSTANT_BUFFER  = 0x4,
+    D3D11_BIND_SHADER_RESOURCE  = 0x8,
+    D3D11_BIND_STREAM_OUTPUT    = 0x10,
+    D3D11_BIND_RENDER_TARGET    = 0x20,
+    D3D11_BIND_DEPTH_STENCIL    = 0x40,
+    D3D11_BIND_UNORDERED_ACCESS = 0x80
+};
+
+enum D3D11_CPU_ACCESS_FLAG
+{
+    D3D11_CPU_ACCESS_WRITE  = 0x10000,
+    D3D11_CPU_ACCESS_READ   = 0x20000
+};
+
+enum D3D11_RESOURCE_MISC_FLAG
+{
+    D3D11_RESOURCE_MISC_GENERATE_MIPS   = 0x1,
+    D3D11_RESOURCE_MISC_SHARED          = 0x2,
+    D3D11_RESOURCE_MISC_TEXTURECUBE     = 0x4
+};
+
+enum D3D11_MAP
+{
+    D3D11_MAP_READ                  = 1,
+    D3D11_MAP_WRITE                 = 2,
+    D3D11_MAP_READ_WRITE            = 3,
+    D3D11_MAP_WRITE_DISCARD         = 4,
+    D3D11_MAP_WRITE_NO_OVERWRITE    = 5
+};
+
+enum D3D11_MAP_FLAG
+{
+    D3D11_MAP_FLAG_DO_NOT_WAIT = 0x100000
+};
+
+enum D3D11_FORMAT_SUPPORT
+{
+    D3D11_FORMAT_SUPPORT_TEXTURE1D              = 0x10,
+    D3D11_FORMAT_SUPPORT_TEXTURE2D              = 0x20,
+    D3D11_FORMAT_SUPPORT_TEXTURE3D              = 0x40,
+    D3D11_FORMAT_SUPPORT_TEXTURECUBE            = 0x80,
+    D3D11_FORMAT_SUPPORT_SHADER_SAMPLE          = 0x200,
+    D3D11_FORMAT_SUPPORT_MIP                    = 0x1000,
+    D3D11_FORMAT_SUPPORT_MIP_AUTOGEN            = 0x2000,
+    D3D11_FORMAT_SUPPORT_RENDER_TARGET          = 0x4000,
+    D3D11_FORMAT_SUPPORT_MULTISAMPLE_RESOLVE    = 0x40000
+};
+
+enum D3D11_DEVICE_CONTEXT_TYPE
+{
+    D3D11_DEVICE_CONTEXT_IMMEDIATE  = 0,
+    D3D11_DEVICE_CONTEXT_DEFERRED   = 1
+};
+
+enum D3D11_INPUT_CLASSIFICATION
+{
+    D3D11_INPUT_PER_VERTEX_DATA     = 0,
+    D3D11_INPUT_PER_INSTANCE_DATA   = 1
+};
+
+enum D3D11_BLEND
+{
+    D3D11_BLEND_ZERO                = 1,
+    D3D11_BLEND_ONE                 = 2,
+    D3D11_BLEND_SRC_COLOR           = 3,
+    D3D11_BLEND_INV_SRC_COLOR       = 4,
+    D3D11_BLEND_SRC_ALPHA           = 5,
+    D3D11_BLEND_INV_SRC_ALPHA       = 6,
+    D3D11_BLEND_DEST_ALPHA          = 7,
+    D3D11_BLEND_INV_DEST_ALPHA      = 8,
+    D3D11_BLEND_DEST_COLOR          = 9,
+    D3D11_BLEND_INV_DEST_COLOR      = 10,
+    D3D11_BLEND_SRC_ALPHA_SAT       = 11,
+    D3D11_BLEND_BLEND_FACTOR        = 14,
+    D3D11_BLEND_INV_BLEND_FACTOR    = 15
+};
+
+enum D3D11_BLEND_OP
+{
+    D3D11_BLEND_OP_ADD          = 1,
+    D3D11_BLEND_OP_SUBTRACT     = 2,
+    D3D11_BLEND_OP_REV_SUBTRACT = 3,
+    D3D11_BLEND_OP_MIN          = 4,
+    D3D11_BLEND_OP_MAX          = 5
+};
+
+enum D3D11_COLOR_WRITE_ENABLE
+{
+    D3D11_COLOR_WRITE_ENABLE_ALL = 15
+};
+
+enum D3D11_COMPARISON_FUNC
+{
+    D3D11_COMPARISON_NEVER          = 1,
+    D3D11_COMPARISON_LESS           = 2,
+    D3D11_COMPARISON_EQUAL          = 3,
+    D3D11_COMPARISON_LESS_EQUAL     = 4,
+    D3D11_COMPARISON_GREATER        = 5,
+    D3D11_COMPARISON_NOT_EQUAL      = 6,
+    D3D11_COMPARISON_GREATER_EQUAL  = 7,
+    D3D11_COMPARISON_ALWAYS         = 8
+};
+
+enum D3D11_DEPTH_WRITE_MASK
+{
+    D3D11_DEPTH_WRITE_MASK_ZERO = 0,
+    D3D11_DEPTH_WRITE_MASK_ALL  = 1
+};
+
+enum D3D11_STENCIL_OP
+{
+    D3D11_STENCIL_OP_KEEP       = 1,
+    D3D11_STENCIL_OP_ZERO       = 2,
+    D3D11_STENCIL_OP_REPLACE    = 3,
+    D3D11_STENCIL_OP_INCR_SAT   = 4,
+    D3D11_STENCIL_OP_DECR_SAT   = 5,
+    D3D11_STENCIL_OP_INVERT     = 6,
+    D3D11_STENCIL_OP_INCR       = 7,
+    D3D11_STENCIL_OP_DECR       = 8
+};
+
+enum D3D11_FILL_MODE
+{
+    D3D11_FILL_WIREFRAME    = 2,
+    D3D11_FILL_SOLID        = 3
+};
+
+enum D3D11_CULL_MODE
+{
+    D3D11_CULL_NONE     = 1,
+    D3D11_CULL_FRONT    = 2,
+    D3D11_CULL_BACK     = 3
+};
+
+enum D3D11_FILTER
+{
+    D3D11_FILTER_MIN_MAG_MIP_POINT  = 0,
+    D3D11_FILTER_MIN_MAG_MIP_LINEAR = 0x15,
+    D3D11_FILTER_ANISOTROPIC        = 0x55
+};
+
+enum D3D11_TEXTURE_ADDRESS_MODE
+{
+    D3D11_TEXTURE_ADDRESS_WRAP          = 1,
+    D3D11_TEXTURE_ADDRESS_MIRROR        = 2,
+    D3D11_TEXTURE_ADDRESS_CLAMP         = 3,
+    D3D11_TEXTURE_ADDRESS_BORDER        = 4,
+    D3D11_TEXTURE_ADDRESS_MIRROR_ONCE   = 5
+};
+
+#define D3D11_APPEND_ALIGNED_ELEMENT                    0xffffffff
+#define D3D11_DEFAULT_STENCIL_READ_MASK                 0xff
+#define D3D11_DEFAULT_STENCIL_WRITE_MASK                0xff
+#define D3D11_FLOAT32_MAX                               3.402823466e+38f
+#define D3D11_MAX_MAXANISOTROPY                         16
+#define D3D11_REQ_MIP_LEVELS                            15
+#define D3D11_REQ_TEXTURE1D_U_DIMENSION                 16384
+#define D3D11_REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION        2048
+#define D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION            16384
+#define D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION        2048
+#define D3D11_REQ_TEXTURE3D_U_V_OR_W_DIMENSION          2048
+#define D3D11_REQ_TEXTURECUBE_DIMENSION                 16384
+#define D3D10_REQ_TEXTURE1D_U_DIMENSION                 8192
+#define D3D10_REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION        512
+#define D3D10_REQ_TEXTURE2D_U_OR_V_DIMENSION            8192
+#define D3D10_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION        512
+#define D3D10_REQ_TEXTURE3D_U_V_OR_W_DIMENSION          2048
+#define D3D10_REQ_TEXTURECUBE_DIMENSION                 8192
+#define D3D_FL9_1_REQ_TEXTURE1D_U_DIMENSION             2048
+#define D3D_FL9_3_REQ_TEXTURE1D_U_DIMENSION             4096
+#define D3D_FL9_1_REQ_TEXTURE2D_U_OR_V_DIMENSION        2048
+#define D3D_FL9_3_REQ_TEXTURE2D_U_OR_V_DIMENSION        4096
+#define D3D_FL9_1_REQ_TEXTURECUBE_DIMENSION             512
+#define D3D_FL9_3_REQ_TEXTURECUBE_DIMENSION             4096
+#define D3D_FL9_1_REQ_TEXTURE3D_U_V_OR_W_DIMENSION      256
+
+inline UINT D3D11CalcSubresource(UINT mipSlice, UINT arraySlice, UINT mipLevels)
+{
+    return mipSlice + arraySlice * mipLevels;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Descriptions.
+//--------------------------------------------------------------------------------------
+struct D3D11_BOX
+{
+    UINT left;
+    UINT top;
+    UINT front;
+    UINT right;
+    UINT bottom;
+    UINT back;
+};
+
+struct D3D11_VIEWPORT
+{
+    FLOAT TopLeftX;
+    FLOAT TopLeftY;
+    FLOAT Width;
+    FLOAT Height;
+    FLOAT MinDepth;
+    FLOAT MaxDepth;
+};
+
+struct D3D11_SUBRESOURCE_DATA
+{
+    void const* pSysMem;
+    UINT SysMemPitch;
+    UINT SysMemSlicePitch;
+};
+
+struct D3D11_MAPPED_SUBRESOURCE
+{
+    void* pData;
+    UINT RowPitch;
+    UINT DepthPitch;
+};
+
+struct D3D11_INPUT_ELEMENT_DESC
+{
+    LPCSTR SemanticName;
+    UINT SemanticIndex;
+    DXGI_FORMAT Format;
+    UINT InputSlot;
+    UINT AlignedByteOffset;
+    D3D11_INPUT_CLASSIFICATION InputSlotClass;
+    UINT InstanceDataStepRate;
+};
+
+struct D3D11_BUFFER_DESC
+{
+    UINT ByteWidth;
+    D3D11_USAGE Usage;
+    UINT BindFlags;
+    UINT CPUAccessFlags;
+    UINT MiscFlags;
+    UINT StructureByteStride;
+};
+
+struct D3D11_TEXTURE1D_DESC
+{
+    UINT Width;
+    UINT MipLevels;
+    UINT ArraySize;
+    DXGI_FORMAT Format;
+    D3D11_USAGE Usage;
+    UINT BindFlags;
+    UINT CPUAccessFlags;
+    UINT MiscFlags;
+};
+
+struct CD3D11_TEXTURE1D_DESC : public D3D11_TEXTURE1D_DESC
+{
+    CD3D11_TEXTURE1D_DESC(DXGI_FORMAT format, UINT width, UINT arraySize = 1, UINT mipLevels = 0,
+                          UINT bindFlags = D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE usage = D3D11_USAGE_DEFAULT,
+                          UINT cpuaccessFlags = 0, UINT miscFlags = 0)
+    {
+        Width = width;
+        MipLevels = mipLevels;
+        ArraySize = arraySize;
+        Format = format;
+        Usage = usage;
+        BindFlags = bindFlags;
+        CPUAccessFlags = cpuaccessFlags;
+        MiscFlags = miscFlags;
+    }
+};
+
+struct D3D11_TEXTURE2D_DESC
+{
+    UINT Width;
+    UINT Height;
+    UINT MipLevels;
+    UINT ArraySize;
+    DXGI_FORMAT Format;
+    DXGI_SAMPLE_DESC SampleDesc;
+    D3D11_USAGE Usage;
+    UINT BindFlags;
+    UINT CPUAccessFlags;
+    UINT MiscFlags;
+};
+
+struct CD3D11_TEXTURE2D_DESC : public D3D11_TEXTURE2D_DESC
+{
+    CD3D11_TEXTURE2D_DESC(DXGI_FORMAT format, UINT width, UINT height, UINT arraySize = 1, UINT mipLevels = 0,
+                          UINT bindFlags = D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE usage = D3D11_USAGE_DEFAULT,
+                          UINT cpuaccessFlags = 0, UINT sampleCount = 1, UINT sampleQuality = 0, UINT miscFlags = 0)
+    {
+        Width = width;
+        Height = height;
+        MipLevels = mipLevels;
+        ArraySize = arraySize;
+        Format = format;
+        SampleDesc.Count = sampleCount;
+        SampleDesc.Quality = sampleQuality;
+        Usage = usage;
+        BindFlags = bindFlags;
+        CPUAccessFlags = cpuaccessFlags;
+        MiscFlags = miscFlags;
+    }
+};
+
+struct D3D11_TEXTURE3D_DESC
+{
+    UINT Width;
+    UINT Height;
+    UINT Depth;
+    UINT MipLevels;
+    DXGI_FORMAT Format;
+    D3D11_USAGE Usage;
+    UINT BindFlags;
+    UINT CPUAccessFlags;
+    UINT MiscFlags;
+};
+
+struct CD3D11_TEXTURE3D_DESC : public D3D11_TEXTURE3D_DESC
+{
+    CD3D11_TEXTURE3D_DESC(DXGI_FORMAT format, UINT width, UINT height, UINT depth, UINT mipLevels = 0,
+                          UINT bindFlags = D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE usage = D3D11_USAGE_DEFAULT,
+                          UINT cpuaccessFlags = 0, UINT miscFlags = 0)
+    {
+        Width = width;
+        Height = height;
+        Depth = depth;
+        MipLevels = mipLevels;
+        Format = format;
+        Usage = usage;
+        BindFlags = bindFlags;
+        CPUAccessFlags = cpuaccessFlags;
+        MiscFlags = miscFlags;
+    }
+};
+
+struct D3D11_TEX_SRV
+{
+    UINT MostDetailedMip;
+    UINT MipLevels;
+};
+
+struct D3D11_TEX_ARRAY_SRV
+{
+    UINT MostDetailedMip;
+    UINT MipLevels;
+    UINT FirstArraySlice;
+    UINT ArraySize;
+};
+
+struct D3D11_TEXCUBE_ARRAY_SRV
+{
+    UINT MostDetailedMip;
+    UINT MipLevels;
+    UINT First2DArrayFace;
+    UINT NumCubes;
+};
+
+struct D3D11_SHADER_RESOURCE_VIEW_DESC
+{
+    DXGI_FORMAT Format;
+    D3D11_SRV_DIMENSION ViewDimension;
+    union
+    {
+        D3D11_TEX_SRV Texture1D;
+        D3D11_TEX_ARRAY_SRV Texture1DArray;
+        D3D11_TEX_SRV Texture2D;
+        D3D11_TEX_ARRAY_SRV Texture2DArray;
+        D3D11_TEX_SRV Texture3D;
+        D3D11_TEX_SRV TextureCube;
+        D3D11_TEXCUBE_ARRAY_SRV TextureCubeArray;
+    };
+};
+
+struct CD3D11_SHADER_RESOURCE_VIEW_DESC : public D3D11_SHADER_RESOURCE_VIEW_DESC
+{
+    CD3D11_SHADER_RESOURCE_VIEW_DESC(D3D11_SRV_DIMENSION viewDimension, DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN,
+                                     UINT mostDetailedMip = 0, UINT mipLevels = UINT(-1),
+                                     UINT firstArraySlice = 0, UINT arraySize = UINT(-1))
+    {
+        Format = format;
+        ViewDimension = viewDimension;
+        Texture2DArray.MostDetailedMip = mostDetailedMip;
+        Texture2DArray.MipLevels = mipLevels;
+        Texture2DArray.FirstArraySlice = firstArraySlice;
+        Texture2DArray.ArraySize = arraySize;
+    }
+};
+
+struct D3D11_RENDER_TARGET_BLEND_DESC
+{
+    BOOL BlendEnable;
+    D3D11_BLEND SrcBlend;
+    D3D11_BLEND DestBlend;
+    D3D11_BLEND_OP BlendOp;
+    D3D11_BLEND SrcBlendAlpha;
+    D3D11_BLEND DestBlendAlpha;
+    D3D11_BLEND_OP BlendOpAlpha;
+    UINT8 RenderTargetWriteMask;
+};
+
+struct D3D11_BLEND_DESC
+{
+    BOOL AlphaToCoverageEnable;
+    BOOL IndependentBlendEnable;
+    D3D11_RENDER_TARGET_BLEND_DESC RenderTarget[8];
+};
+
+struct D3D11_DEPTH_STENCILOP_DESC
+{
+    D3D11_STENCIL_OP StencilFailOp;
+    D3D11_STENCIL_OP StencilDepthFailOp;
+    D3D11_STENCIL_OP StencilPassOp;
+    D3D11_COMPARISON_FUNC StencilFunc;
+};
+
+struct D3D11_DEPTH_STENCIL_DESC
+{
+    BOOL DepthEnable;
+    D3D11_DEPTH_WRITE_MASK DepthWriteMask;
+    D3D11_COMPARISON_FUNC DepthFunc;
+    BOOL StencilEnable;
+    UINT8 StencilReadMask;
+    UINT8 StencilWriteMask;
+    D3D11_DEPTH_STENCILOP_DESC FrontFace;
+    D3D11_DEPTH_STENCILOP_DESC BackFace;
+};
+
+struct D3D11_RASTERIZER_DESC
+{
+    D3D11_FILL_MODE FillMode;
+    D3D11_CULL_MODE CullMode;
+    BOOL FrontCounterClockwise;
+    INT DepthBias;
+    FLOAT DepthBiasClamp;
+    FLOAT SlopeScaledDepthBias;
+    BOOL DepthClipEnable;
+    BOOL ScissorEnable;
+    BOOL MultisampleEnable;
+    BOOL AntialiasedLineEnable;
+};
+
+struct D3D11_SAMPLER_DESC
+{
+    D3D11_FILTER Filter;
+    D3D11_TEXTURE_ADDRESS_MODE AddressU;
+    D3D11_TEXTURE_ADDRESS_MODE AddressV;
+    D3D11_TEXTURE_ADDRESS_MODE AddressW;
+    FLOAT MipLODBias;
+    UINT MaxAnisotropy;
+    D3D11_COMPARISON_FUNC ComparisonFunc;
+    FLOAT BorderColor[4];
+    FLOAT MinLOD;
+    FLOAT MaxLOD;
+};
+
+static GUID const WKPDID_D3DDebugObjectName = { 0x429b8c22, 0x9188, 0x4b0c, { 0x87, 0x42, 0xac, 0xb0, 0xbf, 0x85, 0xc2, 0x00 } };
+
+
+//--------------------------------------------------------------------------------------
+// Interfaces.
+//--------------------------------------------------------------------------------------
+struct ID3D11Device;
+struct ID3D11ClassLinkage;
+struct ID3D11ClassInstance;
+
+struct ID3D11DeviceChild : public IUnknown
+{
+    virtual void STDMETHODCALLTYPE GetDevice(_Outptr_ ID3D11Device** ppDevice) = 0;
+    virtual HRESULT STDMETHODCALLTYPE SetPrivateData(_In_ REFGUID guid, _In_ UINT DataSize, _In_reads_bytes_opt_(DataSize) void const* pData) = 0;
+};
+
+struct ID3D11Resource : public ID3D11DeviceChild
+{
+    virtual void STDMETHODCALLTYPE GetType(_Out_ D3D11_RESOURCE_DIMENSION* pResourceDimension) = 0;
+};
+
+struct ID3D11Buffer : public ID3D11Resource
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_BUFFER_DESC* pDesc) = 0;
+};
+
+struct ID3D11Texture1D : public ID3D11Resource
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_TEXTURE1D_DESC* pDesc) = 0;
+};
+
+struct ID3D11Texture2D : public ID3D11Resource
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_TEXTURE2D_DESC* pDesc) = 0;
+};
+
+struct ID3D11Texture3D : public ID3D11Resource
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_TEXTURE3D_DESC* pDesc) = 0;
+};
+
+struct ID3D11View : public ID3D11DeviceChild
+{
+    virtual void STDMETHODCALLTYPE GetResource(_Outptr_ ID3D11Resource** ppResource) = 0;
+};
+
+struct ID3D11ShaderResourceView : public ID3D11View
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_SHADER_RESOURCE_VIEW_DESC* pDesc) = 0;
+};
+
+struct ID3D11BlendState : public ID3D11DeviceChild
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_BLEND_DESC* pDesc) = 0;
+};
+
+struct ID3D11DepthStencilState : public ID3D11DeviceChild
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_DEPTH_STENCIL_DESC* pDesc) = 0;
+};
+
+struct ID3D11RasterizerState : public ID3D11DeviceChild
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_RASTERIZER_DESC* pDesc) = 0;
+};
+
+struct ID3D11SamplerState : public ID3D11DeviceChild
+{
+    virtual void STDMETHODCALLTYPE GetDesc(_Out_ D3D11_SAMPLER_DESC* pDesc) = 0;
+};
+
+struct ID3D11InputLayout : public ID3D11DeviceChild
+{
+};
+
+struct ID3D11VertexShader : public ID3D11DeviceChild
+{
+};
+
+struct ID3D11PixelShader : public ID3D11DeviceChild
+{
+};
+
+struct ID3D11DeviceContext : public ID3D11DeviceChild
+{
+    virtual void STDMETHODCALLTYPE VSSetConstantBuffers(_In_ UINT StartSlot, _In_ UINT NumBuffers, _In_reads_opt_(NumBuffers) ID3D11Buffer* const* ppConstantBuffers) = 0;
+    virtual void STDMETHODCALLTYPE PSSetShaderResources(_In_ UINT StartSlot, _In_ UINT NumViews, _In_reads_opt_(NumViews) ID3D11ShaderResourceView* const* ppShaderResourceViews) = 0;
+    virtual void STDMETHODCALLTYPE PSSetShader(_In_opt_ ID3D11PixelShader* pPixelShader, _In_reads_opt_(NumClassInstances) ID3D11ClassInstance* const* ppClassInstances, UINT NumClassInstances) = 0;
+    virtual void STDMETHODCALLTYPE PSSetSamplers(_In_ UINT StartSlot, _In_ UINT NumSamplers, _In_reads_opt_(NumSamplers) ID3D11SamplerState* const* ppSamplers) = 0;
+    virtual void STDMETHODCALLTYPE VSSetShader(_In_opt_ ID3D11VertexShader* pVertexShader, _In_reads_opt_(NumClassInstances) ID3D11ClassInstance* const* ppClassInstances, UINT NumClassInstances) = 0;
+    virtual void STDMETHODCALLTYPE DrawIndexed(_In_ UINT IndexCount, _In_ UINT StartIndexLocation, _In_ INT BaseVertexLocation) = 0;
+    virtual void STDMETHODCALLTYPE Draw(_In_ UINT VertexCount, _In_ UINT StartVertexLocation) = 0;
+    virtual HRESULT STDMETHODCALLTYPE Map(_In_ ID3D11Resource* pResource, _In_ UINT Subresource, _In_ D3D11_MAP MapType, _In_ UINT MapFlags, _Out_opt_ D3D11_MAPPED_SUBRESOURCE* pMappedResource) = 0;
+    virtual void STDMETHODCALLTYPE Unmap(_In_ ID3D11Resource* pResource, _In_ UINT Subresource) = 0;
+    virtual void STDMETHODCALLTYPE PSSetConstantBuffers(_In_ UINT StartSlot, _In_ UINT NumBuffers, _In_reads_opt_(NumBuffers) ID3D11Buffer* const* ppConstantBuffers) = 0;
+    virtual void STDMETHODCALLTYPE IASetInputLayout(_In_opt_ ID3D11InputLayout* pInputLayout) = 0;
+    virtual void STDMETHODCALLTYPE IASetVertexBuffers(_In_ UINT StartSlot, _In_ UINT NumBuffers, _In_reads_opt_(NumBuffers) ID3D11Buffer* const* ppVertexBuffers, _In_reads_opt_(NumBuffers) UINT const* pStrides, _In_reads_opt_(NumBuffers) UINT const* pOffsets) = 0;
+    virtual void STDMETHODCALLTYPE IASetIndexBuffer(_In_opt_ ID3D11Buffer* pIndexBuffer, _In_ DXGI_FORMAT Format, _In_ UINT Offset) = 0;
+    virtual void STDMETHODCALLTYPE IASetPrimitiveTopology(_In_ D3D11_PRIMITIVE_TOPOLOGY Topology) = 0;
+    virtual void STDMETHODCALLTYPE OMSetBlendState(_In_opt_ ID3D11BlendState* pBlendState, _In_opt_ FLOAT const BlendFactor[4], _In_ UINT SampleMask) = 0;
+    virtual void STDMETHODCALLTYPE OMSetDepthStencilState(_In_opt_ ID3D11DepthStencilState* pDepthStencilState, _In_ UINT StencilRef) = 0;
+    virtual void STDMETHODCALLTYPE RSSetState(_In_opt_ ID3D11RasterizerState* pRasterizerState) = 0;
+    virtual void STDMETHODCALLTYPE RSGetViewports(_Inout_ UINT* pNumViewports, _Out_writes_opt_(*pNumViewports) D3D11_VIEWPORT* pViewports) = 0;
+    virtual void STDMETHODCALLTYPE CopySubresourceRegion(_In_ ID3D11Resource* pDstResource, _In_ UINT DstSubresource, _In_ UINT DstX, _In_ UINT DstY, _In_ UINT DstZ, _In_ ID3D11Resource* pSrcResource, _In_ UINT SrcSubresource, _In_opt_ D3D11_BOX const* pSrcBox) = 0;
+    virtual void STDMETHODCALLTYPE CopyResource(_In_ ID3D11Resource* pDstResource, _In_ ID3D11Resource* pSrcResource) = 0;
+    virtual void STDMETHODCALLTYPE UpdateSubresource(_In_ ID3D11Resource* pDstResource, _In_ UINT DstSubresource, _In_opt_ D3D11_BOX const* pDstBox, _In_ void const* pSrcData, _In_ UINT SrcRowPitch, _In_ UINT SrcDepthPitch) = 0;
+    virtual void STDMETHODCALLTYPE GenerateMips(_In_ ID3D11ShaderResourceView* pShaderResourceView) = 0;
+    virtual void STDMETHODCALLTYPE ResolveSubresource(_In_ ID3D11Resource* pDstResource, _In_ UINT DstSubresource, _In_ ID3D11Resource* pSrcResource, _In_ UINT SrcSubresource, _In_ DXGI_FORMAT Format) = 0;
+    virtual D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE GetType() = 0;
+};
+
+struct ID3D11Device : public IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE CreateBuffer(_In_ D3D11_BUFFER_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Buffer** ppBuffer) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateTexture1D(_In_ D3D11_TEXTURE1D_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Texture1D** ppTexture1D) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateTexture2D(_In_ D3D11_TEXTURE2D_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Texture2D** ppTexture2D) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateTexture3D(_In_ D3D11_TEXTURE3D_DESC const* pDesc, _In_opt_ D3D11_SUBRESOURCE_DATA const* pInitialData, _COM_Outptr_opt_ ID3D11Texture3D** ppTexture3D) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateShaderResourceView(_In_ ID3D11Resource* pResource, _In_opt_ D3D11_SHADER_RESOURCE_VIEW_DESC const* pDesc, _COM_Outptr_opt_ ID3D11ShaderResourceView** ppSRView) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateInputLayout(_In_reads_(NumElements) D3D11_INPUT_ELEMENT_DESC const* pInputElementDescs, _In_ UINT NumElements, _In_reads_(BytecodeLength) void const* pShaderBytecodeWithInputSignature, _In_ SIZE_T BytecodeLength, _COM_Outptr_opt_ ID3D11InputLayout** ppInputLayout) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateVertexShader(_In_reads_(BytecodeLength) void const* pShaderBytecode, _In_ SIZE_T BytecodeLength, _In_opt_ ID3D11ClassLinkage* pClassLinkage, _COM_Outptr_opt_ ID3D11VertexShader** ppVertexShader) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreatePixelShader(_In_reads_(BytecodeLength) void const* pShaderBytecode, _In_ SIZE_T BytecodeLength, _In_opt_ ID3D11ClassLinkage* pClassLinkage, _COM_Outptr_opt_ ID3D11PixelShader** ppPixelShader) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateBlendState(_In_ D3D11_BLEND_DESC const* pBlendStateDesc, _COM_Outptr_opt_ ID3D11BlendState** ppBlendState) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateDepthStencilState(_In_ D3D11_DEPTH_STENCIL_DESC const* pDepthStencilDesc, _COM_Outptr_opt_ ID3D11DepthStencilState** ppDepthStencilState) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateRasterizerState(_In_ D3D11_RASTERIZER_DESC const* pRasterizerDesc, _COM_Outptr_opt_ ID3D11RasterizerState** ppRasterizerState) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateSamplerState(_In_ D3D11_SAMPLER_DESC const* pSamplerDesc, _COM_Outptr_opt_ ID3D11SamplerState** ppSamplerState) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CheckFormatSupport(_In_ DXGI_FORMAT Format, _Out_ UINT* pFormatSupport) = 0;
+    virtual D3D_FEATURE_LEVEL STDMETHODCALLTYPE GetFeatureLevel() = 0;
+    virtual UINT STDMETHODCALLTYPE GetCreationFlags() = 0;
+    virtual void STDMETHODCALLTYPE GetImmediateContext(_Outptr_ ID3D11DeviceContext** ppImmediateContext) = 0;
+};
+
+STUB_INTERFACE_ID(ID3D11DeviceChild, 0x100)
+STUB_INTERFACE_ID(ID3D11Resource, 0x101)
+STUB_INTERFACE_ID(ID3D11Buffer, 0x102)
+STUB_INTERFACE_ID(ID3D11Texture1D, 0x103)
+STUB_INTERFACE_ID(ID3D11Texture2D, 0x104)
+STUB_INTERFACE_ID(ID3D11Texture3D, 0x105)
+STUB_INTERFACE_ID(ID3D11View, 0x106)
+STUB_INTERFACE_ID(ID3D11ShaderResourceView, 0x107)
+STUB_INTERFACE_ID(ID3D11BlendState, 0x108)
+STUB_INTERFACE_ID(ID3D11DepthStencilState, 0x109)
+STUB_INTERFACE_ID(ID3D11RasterizerState, 0x10A)
+STUB_INTERFACE_ID(ID3D11SamplerState, 0x10B)
+STUB_INTERFACE_ID(ID3D11InputLayout, 0x10C)
+STUB_INTERFACE_ID(ID3D11VertexShader, 0x10D)
+STUB_INTERFACE_ID(ID3D11PixelShader, 0x10E)
+STUB_INTERFACE_ID(ID3D11DeviceContext, 0x10F)
+STUB_INTERFACE_ID(ID3D11Device, 0x110)
@@ -0,0 +1,21 @@
+//--------------------------------------------------------------------------------------
+// File: ocidl.h
+//
+// BenchTool stand-in for the OLE interfaces header; IPropertyBag2 comes from the stub
+// wincodec.h.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <windows.h>
+
+struct IPropertyBag2;
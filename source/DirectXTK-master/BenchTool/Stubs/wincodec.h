@@ -0,0 +1,285 @@
+//--------------------------------------------------------------------------------------
+// File: wincodec.h
+//
+// BenchTool stand-in for the Windows Imaging Component interfaces ScreenGrab encodes
+// with. The BenchTool factory (see RecordingDevice.h) records what is written instead of
+// writing image files.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <ocidl.h>
+
+#ifdef _MSC_VER
+#define STUB_GLOBALCONST extern const __declspec(selectany)
+#else
+#define STUB_GLOBALCONST extern const __attribute__((weak))
+#endif
+
+
+//--------------------------------------------------------------------------------------
+// Container and pixel formats. Like the interface ids these only have to be distinct.
+//--------------------------------------------------------------------------------------
+typedef GUID WICPixelFormatGUID;
+typedef REFGUID REFWICPixelFormatGUID;
+
+#define STUB_WIC_GUID(name, n) STUB_GLOBALCONST GUID name = { n, 0, 0, { 0x57, 0x49, 0x43, 0, 0, 0, 0, 0 } };
+
+STUB_WIC_GUID(GUID_ContainerFormatBmp,                  0x100)
+STUB_WIC_GUID(GUID_ContainerFormatPng,                  0x101)
+STUB_WIC_GUID(GUID_ContainerFormatIco,                  0x102)
+STUB_WIC_GUID(GUID_ContainerFormatJpeg,                 0x103)
+STUB_WIC_GUID(GUID_ContainerFormatTiff,                 0x104)
+STUB_WIC_GUID(GUID_ContainerFormatGif,                  0x105)
+STUB_WIC_GUID(GUID_ContainerFormatWmp,                  0x106)
+
+STUB_WIC_GUID(GUID_WICPixelFormat8bppGray,              0x200)
+STUB_WIC_GUID(GUID_WICPixelFormat8bppAlpha,             0x201)
+STUB_WIC_GUID(GUID_WICPixelFormat16bppGray,             0x202)
+STUB_WIC_GUID(GUID_WICPixelFormat16bppGrayHalf,         0x203)
+STUB_WIC_GUID(GUID_WICPixelFormat16bppBGR555,           0x204)
+STUB_WIC_GUID(GUID_WICPixelFormat16bppBGR565,           0x205)
+STUB_WIC_GUID(GUID_WICPixelFormat16bppBGRA5551,         0x206)
+STUB_WIC_GUID(GUID_WICPixelFormat24bppBGR,              0x207)
+STUB_WIC_GUID(GUID_WICPixelFormat24bppRGB,              0x208)
+STUB_WIC_GUID(GUID_WICPixelFormat32bppBGR,              0x209)
+STUB_WIC_GUID(GUID_WICPixelFormat32bppBGRA,             0x20A)
+STUB_WIC_GUID(GUID_WICPixelFormat32bppRGBA,             0x20B)
+STUB_WIC_GUID(GUID_WICPixelFormat32bppGrayFloat,        0x20C)
+STUB_WIC_GUID(GUID_WICPixelFormat32bppRGBA1010102,      0x20D)
+STUB_WIC_GUID(GUID_WICPixelFormat32bppRGBA1010102XR,    0x20E)
+STUB_WIC_GUID(GUID_WICPixelFormat48bppBGR,              0x20F)
+STUB_WIC_GUID(GUID_WICPixelFormat64bppRGBA,             0x210)
+STUB_WIC_GUID(GUID_WICPixelFormat64bppRGBAHalf,         0x211)
+STUB_WIC_GUID(GUID_WICPixelFormat96bppRGBFloat,         0x212)
+STUB_WIC_GUID(GUID_WICPixelFormat128bppRGBAFloat,       0x213)
+
+#undef STUB_WIC_GUID
+
+
+//--------------------------------------------------------------------------------------
+// Property bags and variants, as far as encoder options and metadata use them.
+//--------------------------------------------------------------------------------------
+typedef uint16_t VARTYPE;
+typedef int16_t VARIANT_BOOL;
+
+#define VARIANT_TRUE    ((VARIANT_BOOL)-1)
+#define VARIANT_FALSE   ((VARIANT_BOOL)0)
+
+enum VARENUM
+{
+    VT_EMPTY    = 0,
+    VT_I4       = 3,
+    VT_R4       = 4,
+    VT_BOOL     = 11,
+    VT_UI1      = 17,
+    VT_UI2      = 18,
+    VT_UI4      = 19,
+    VT_LPSTR    = 30,
+    VT_LPWSTR   = 31,
+};
+
+struct VARIANT
+{
+    VARTYPE vt;
+    union
+    {
+        LONG lVal;
+        FLOAT fltVal;
+        BYTE bVal;
+        VARIANT_BOOL boolVal;
+    };
+};
+
+struct PROPVARIANT
+{
+    VARTYPE vt;
+    union
+    {
+        LONG lVal;
+        FLOAT fltVal;
+        BYTE bVal;
+        uint16_t uiVal;
+        ULONG ulVal;
+        VARIANT_BOOL boolVal;
+        char* pszVal;
+        wchar_t* pwszVal;
+    };
+};
+
+inline void PropVariantInit(PROPVARIANT* pvar)
+{
+    memset(pvar, 0, sizeof(PROPVARIANT));
+}
+
+struct PROPBAG2
+{
+    DWORD dwType;
+    VARTYPE vt;
+    uint16_t cfType;
+    DWORD dwHint;
+    LPWSTR pstrName;
+    CLSID clsid;
+};
+
+struct IPropertyBag2 : public IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE Write(ULONG cProperties, PROPBAG2* pPropBag, VARIANT* pvarValue) = 0;
+};
+
+
+//--------------------------------------------------------------------------------------
+// Imaging interfaces.
+//--------------------------------------------------------------------------------------
+enum WICBitmapEncoderCacheOption
+{
+    WICBitmapEncoderCacheInMemory   = 0,
+    WICBitmapEncoderCacheTempFile   = 0x1,
+    WICBitmapEncoderNoCache         = 0x2,
+};
+
+enum WICBitmapDitherType
+{
+    WICBitmapDitherTypeNone         = 0,
+    WICBitmapDitherTypeErrorDiffusion = 0x8,
+};
+
+enum WICBitmapPaletteType
+{
+    WICBitmapPaletteTypeCustom      = 0,
+};
+
+struct WICRect
+{
+    INT X;
+    INT Y;
+    INT Width;
+    INT Height;
+};
+
+struct IStream : public IUnknown
+{
+};
+
+struct IWICStream : public IStream
+{
+    virtual HRESULT STDMETHODCALLTYPE InitializeFromFilename(LPCWSTR wzFileName, DWORD dwDesiredAccess) = 0;
+};
+
+struct IWICBitmapSource : public IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE GetSize(UINT* puiWidth, UINT* puiHeight) = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetPixelFormat(WICPixelFormatGUID* pPixelFormat) = 0;
+};
+
+struct IWICBitmap : public IWICBitmapSource
+{
+};
+
+struct IWICFormatConverter : public IWICBitmapSource
+{
+    virtual HRESULT STDMETHODCALLTYPE Initialize(IWICBitmapSource* pISource, REFWICPixelFormatGUID dstFormat, WICBitmapDitherType dither,
+                                                 void* pIPalette, double alphaThresholdPercent, WICBitmapPaletteType paletteTranslate) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CanConvert(REFWICPixelFormatGUID srcPixelFormat, REFWICPixelFormatGUID dstPixelFormat, BOOL* pfCanConvert) = 0;
+};
+
+struct IWICMetadataQueryWriter : public IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE SetMetadataByName(LPCWSTR wzName, const PROPVARIANT* pvarValue) = 0;
+};
+
+struct IWICBitmapFrameEncode : public IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE Initialize(IPropertyBag2* pIEncoderOptions) = 0;
+    virtual HRESULT STDMETHODCALLTYPE SetSize(UINT uiWidth, UINT uiHeight) = 0;
+    virtual HRESULT STDMETHODCALLTYPE SetResolution(double dpiX, double dpiY) = 0;
+    virtual HRESULT STDMETHODCALLTYPE SetPixelFormat(WICPixelFormatGUID* pPixelFormat) = 0;
+    virtual HRESULT STDMETHODCALLTYPE WritePixels(UINT lineCount, UINT cbStride, UINT cbBufferSize, BYTE* pbPixels) = 0;
+    virtual HRESULT STDMETHODCALLTYPE WriteSource(IWICBitmapSource* pIBitmapSource, WICRect* prc) = 0;
+    virtual HRESULT STDMETHODCALLTYPE Commit() = 0;
+    virtual HRESULT STDMETHODCALLTYPE GetMetadataQueryWriter(IWICMetadataQueryWriter** ppIMetadataQueryWriter) = 0;
+};
+
+struct IWICBitmapEncoder : public IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE Initialize(IStream* pIStream, WICBitmapEncoderCacheOption cacheOption) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateNewFrame(IWICBitmapFrameEncode** ppIFrameEncode, IPropertyBag2** ppIEncoderOptions) = 0;
+    virtual HRESULT STDMETHODCALLTYPE Commit() = 0;
+};
+
+struct IWICImagingFactory : public IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE CreateEncoder(REFGUID guidContainerFormat, const GUID* pguidVendor, IWICBitmapEncoder** ppIEncoder) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateFormatConverter(IWICFormatConverter** ppIFormatConverter) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateStream(IWICStream** ppIWICStream) = 0;
+    virtual HRESULT STDMETHODCALLTYPE CreateBitmapFromMemory(UINT uiWidth, UINT uiHeight, REFWICPixelFormatGUID pixelFormat, UINT cbStride,
+                                                             UINT cbBufferSize, BYTE* pbBuffer, IWICBitmap** ppIBitmap) = 0;
+};
+
+STUB_INTERFACE_ID(IPropertyBag2,            0x200)
+STUB_INTERFACE_ID(IStream,                  0x201)
+STUB_INTERFACE_ID(IWICStream,               0x202)
+STUB_INTERFACE_ID(IWICBitmapSource,         0x203)
+STUB_INTERFACE_ID(IWICBitmap,               0x204)
+STUB_INTERFACE_ID(IWICFormatConverter,      0x205)
+STUB_INTERFACE_ID(IWICMetadataQueryWriter,  0x206)
+STUB_INTERFACE_ID(IWICBitmapFrameEncode,    0x207)
+STUB_INTERFACE_ID(IWICBitmapEncoder,        0x208)
+STUB_INTERFACE_ID(IWICImagingFactory,       0x209)
+
+
+//--------------------------------------------------------------------------------------
+// Visual C++ lets std::exception take a message, which DirectXTK throws with. Elsewhere
+// a throw std::exception("...") constructs a std::runtime_error instead; a catch of
+// std::exception still catches it. This is the last header pch.h includes, so every
+// standard header the library and BenchTool use is included ahead of the macro.
+//--------------------------------------------------------------------------------------
+#ifndef _MSC_VER
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace std
+{
+    class exception_compat : public runtime_error
+    {
+    public:
+        exception_compat() : runtime_error("std::exception") {}
+        explicit exception_compat(const char* message) : runtime_error(message) {}
+    };
+}
+
+#define exception(...) exception_compat(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,1009 @@
+//--------------------------------------------------------------------------------------
+// File: windows.h
+//
+// BenchTool stand-in for the Windows headers: only the types, error codes, and file,
+// mapping and event functions that the DirectXTK sources compiled into BenchTool use.
+// The file functions are implemented with POSIX calls (or the C runtime under Visual C++),
+// so the library code runs unchanged, reading and writing real files.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <io.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sched.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+
+#define _WIN32_WINNT_WIN7   0x0601
+#define _WIN32_WINNT_WIN8   0x0602
+
+#define WINAPI_FAMILY_APP           2
+#define WINAPI_FAMILY_DESKTOP_APP   100
+
+
+//--------------------------------------------------------------------------------------
+// Compiler keywords and SAL annotations (Visual C++ has its own).
+//--------------------------------------------------------------------------------------
+#ifndef _MSC_VER
+#define __cdecl
+#define __stdcall
+#define __declspec(x) __declspec_##x
+#define __declspec_selectany __attribute__((weak))
+#define __declspec_align(n)
+#define __forceinline inline __attribute__((always_inline))
+#define _In_
+#define _In_z_
+#define _In_opt_
+#define _In_opt_z_
+#define _In_reads_(n)
+#define _In_reads_opt_(n)
+#define _In_reads_bytes_(n)
+#define _In_reads_bytes_opt_(n)
+#define _Out_
+#define _Out_opt_
+#define _Out_writes_(n)
+#define _Out_writes_all_(n)
+#define _Out_writes_opt_(n)
+#define _Out_writes_bytes_(n)
+#define _Out_writes_bytes_opt_(n)
+#define _Outptr_
+#define _Outptr_opt_
+#define _Outptr_result_maybenull_
+#define _Inout_
+#define _Inout_opt_
+#define _Inout_updates_(n)
+#define _Inout_updates_bytes_(n)
+#define _COM_Outptr_
+#define _COM_Outptr_opt_
+#define _Ret_maybenull_
+#define _Success_(x)
+#define _Analysis_assume_(x)
+#define _Printf_format_string_
+#define _Use_decl_annotations_
+#define _When_(a, b)
+#define _Field_size_(n)
+#define _Field_size_bytes_(n)
+#endif
+
+#define WINAPI
+#define STDMETHODCALLTYPE
+#define UNREFERENCED_PARAMETER(p) (void)(p)
+
+
+//--------------------------------------------------------------------------------------
+// Basic types.
+//--------------------------------------------------------------------------------------
+typedef uint8_t BYTE;
+typedef uint8_t BOOLEAN;
+typedef uint8_t UINT8;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef uint32_t UINT;
+typedef uint32_t ULONG;
+typedef uint64_t UINT64;
+typedef uint64_t ULONGLONG;
+typedef int32_t INT;
+typedef int32_t LONG;
+typedef int32_t BOOL;
+typedef int32_t HRESULT;
+typedef int64_t LONGLONG;
+typedef int64_t INT64;
+typedef float FLOAT;
+typedef size_t SIZE_T;
+typedef uintptr_t ULONG_PTR;
+typedef intptr_t LONG_PTR;
+typedef void* PVOID;
+typedef void* LPVOID;
+typedef void const* LPCVOID;
+typedef void* HANDLE;
+typedef wchar_t WCHAR;
+typedef wchar_t* LPWSTR;
+typedef wchar_t const* LPCWSTR;
+typedef char const* LPCSTR;
+
+#define TRUE 1
+#define FALSE 0
+
+// long is 32 bits on Windows, and LONG (which RECT and the file formats use) is kept that
+// size here, so its limits are the 32-bit ones too.
+#ifndef _MSC_VER
+#undef LONG_MAX
+#undef LONG_MIN
+#define LONG_MAX 2147483647
+#define LONG_MIN (-LONG_MAX - 1)
+#endif
+
+#ifndef MAX_PATH
+#define MAX_PATH 260
+#endif
+
+struct RECT
+{
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+};
+
+union LARGE_INTEGER
+{
+    struct
+    {
+        DWORD LowPart;
+        LONG HighPart;
+    };
+    LONGLONG QuadPart;
+};
+
+struct SECURITY_ATTRIBUTES;
+typedef SECURITY_ATTRIBUTES* LPSECURITY_ATTRIBUTES;
+
+
+//--------------------------------------------------------------------------------------
+// Error codes.
+//--------------------------------------------------------------------------------------
+#define SUCCEEDED(hr) (static_cast<HRESULT>(hr) >= 0)
+#define FAILED(hr) (static_cast<HRESULT>(hr) < 0)
+
+#define S_OK                                static_cast<HRESULT>(0)
+#define S_FALSE                             static_cast<HRESULT>(1)
+#define E_NOTIMPL                           static_cast<HRESULT>(0x80004001)
+#define E_NOINTERFACE                       static_cast<HRESULT>(0x80004002)
+#define E_POINTER                           static_cast<HRESULT>(0x80004003)
+#define E_ABORT                             static_cast<HRESULT>(0x80004004)
+#define E_FAIL                              static_cast<HRESULT>(0x80004005)
+#define E_UNEXPECTED                        static_cast<HRESULT>(0x8000FFFF)
+#define E_ACCESSDENIED                      static_cast<HRESULT>(0x80070005)
+#define E_HANDLE                            static_cast<HRESULT>(0x80070006)
+#define E_OUTOFMEMORY                       static_cast<HRESULT>(0x8007000E)
+#define E_INVALIDARG                        static_cast<HRESULT>(0x80070057)
+
+#define ERROR_SUCCESS                       0
+#define ERROR_FILE_NOT_FOUND                2
+#define ERROR_PATH_NOT_FOUND                3
+#define ERROR_ACCESS_DENIED                 5
+#define ERROR_INVALID_HANDLE                6
+#define ERROR_NOT_ENOUGH_MEMORY             8
+#define ERROR_INVALID_DATA                  13
+#define ERROR_HANDLE_EOF                    38
+#define ERROR_NOT_SUPPORTED                 50
+#define ERROR_FILE_EXISTS                   80
+#define ERROR_INVALID_PARAMETER             87
+#define ERROR_ALREADY_EXISTS                183
+#define ERROR_FILE_TOO_LARGE                223
+#define ERROR_ARITHMETIC_OVERFLOW           534
+#define ERROR_IO_PENDING                    997
+
+#define HRESULT_FROM_WIN32(x) ((x) == 0 ? S_OK : static_cast<HRESULT>((static_cast<uint32_t>(x) & 0x0000FFFF) | 0x80070000))
+
+
+//--------------------------------------------------------------------------------------
+// C runtime secure functions (Visual C++ has its own).
+//--------------------------------------------------------------------------------------
+#ifndef _MSC_VER
+
+#ifndef _countof
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#endif
+
+inline void* _aligned_malloc(size_t size, size_t alignment)
+{
+    void* p = nullptr;
+    return (posix_memalign(&p, (alignment < sizeof(void*)) ? sizeof(void*) : alignment, size) == 0) ? p : nullptr;
+}
+
+inline void _aligned_free(void* p)
+{
+    free(p);
+}
+
+inline int _stricmp(char const* a, char const* b)
+{
+    return strcasecmp(a, b);
+}
+
+inline int memcpy_s(void* dest, size_t destSize, void const* src, size_t count)
+{
+    if (count > destSize)
+        return 34;  // ERANGE
+
+    memcpy(dest, src, count);
+    return 0;
+}
+
+template<size_t TSize>
+inline int vsprintf_s(char (&buffer)[TSize], char const* format, va_list args)
+{
+    return vsnprintf(buffer, TSize, format, args);
+}
+
+template<size_t TSize>
+inline int sprintf_s(char (&buffer)[TSize], char const* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = vsnprintf(buffer, TSize, format, args);
+    va_end(args);
+    return result;
+}
+
+template<size_t TSize>
+inline int swprintf_s(wchar_t (&buffer)[TSize], wchar_t const* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = vswprintf(buffer, TSize, format, args);
+    va_end(args);
+    return result;
+}
+
+inline int swprintf_s(wchar_t* buffer, size_t count, wchar_t const* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int result = vswprintf(buffer, count, format, args);
+    va_end(args);
+    return result;
+}
+
+#endif
+
+
+//--------------------------------------------------------------------------------------
+// Kernel objects. A HANDLE points at one of these; CloseHandle deletes it.
+//--------------------------------------------------------------------------------------
+#define INVALID_HANDLE_VALUE reinterpret_cast<HANDLE>(static_cast<intptr_t>(-1))
+
+#define GENERIC_READ                0x80000000
+#define GENERIC_WRITE               0x40000000
+#define DELETE                      0x00010000
+#define SYNCHRONIZE                 0x00100000
+#define FILE_SHARE_READ             0x00000001
+#define FILE_SHARE_WRITE            0x00000002
+
+#define CREATE_NEW                  1
+#define CREATE_ALWAYS               2
+#define OPEN_EXISTING               3
+#define OPEN_ALWAYS                 4
+#define TRUNCATE_EXISTING           5
+
+#define FILE_ATTRIBUTE_NORMAL       0x00000080
+#define FILE_FLAG_OVERLAPPED        0x40000000
+#define FILE_FLAG_SEQUENTIAL_SCAN   0x08000000
+
+#define PAGE_READONLY               0x02
+#define FILE_MAP_READ               0x0004
+
+#define MEM_COMMIT                  0x00001000
+#define MEM_RESERVE                 0x00002000
+#define MEM_RELEASE                 0x00008000
+#define PAGE_READWRITE              0x04
+
+#define CREATE_EVENT_MANUAL_RESET   0x00000001
+#define CREATE_EVENT_INITIAL_SET    0x00000002
+#define EVENT_MODIFY_STATE          0x0002
+
+#define INFINITE                    0xFFFFFFFF
+#define WAIT_OBJECT_0               0
+#define WAIT_TIMEOUT                258
+#define WAIT_FAILED                 0xFFFFFFFF
+
+enum FILE_INFO_BY_HANDLE_CLASS
+{
+    FileBasicInfo,
+    FileStandardInfo,
+    FileNameInfo,
+    FileRenameInfo,
+    FileDispositionInfo,
+};
+
+struct FILE_STANDARD_INFO
+{
+    LARGE_INTEGER AllocationSize;
+    LARGE_INTEGER EndOfFile;
+    DWORD NumberOfLinks;
+    BOOLEAN DeletePending;
+    BOOLEAN Directory;
+};
+
+struct FILE_DISPOSITION_INFO
+{
+    BOOLEAN DeleteFile;
+};
+
+struct CREATEFILE2_EXTENDED_PARAMETERS
+{
+    DWORD dwSize;
+    DWORD dwFileAttributes;
+    DWORD dwFileFlags;
+    DWORD dwSecurityQosFlags;
+    LPSECURITY_ATTRIBUTES lpSecurityAttributes;
+    HANDLE hTemplateFile;
+};
+
+struct OVERLAPPED
+{
+    ULONG_PTR Internal;
+    ULONG_PTR InternalHigh;
+    union
+    {
+        struct
+        {
+            DWORD Offset;
+            DWORD OffsetHigh;
+        };
+        PVOID Pointer;
+    };
+    HANDLE hEvent;
+};
+typedef OVERLAPPED* LPOVERLAPPED;
+
+namespace StubWin32
+{
+    struct KernelObject
+    {
+        virtual ~KernelObject() {}
+    };
+
+    struct File : KernelObject
+    {
+        int fd;
+        std::string path;
+        bool deleteOnClose;
+
+        File(int f, std::string const& p) : fd(f), path(p), deleteOnClose(false) {}
+
+        ~File()
+        {
+#ifdef _MSC_VER
+            _close(fd);
+            if (deleteOnClose)
+                remove(path.c_str());
+#else
+            close(fd);
+            if (deleteOnClose)
+                unlink(path.c_str());
+#endif
+        }
+    };
+
+    struct FileMapping : KernelObject
+    {
+        int fd;
+        size_t size;
+
+        FileMapping(int f, size_t s) : fd(f), size(s) {}
+
+        ~FileMapping()
+        {
+#ifdef _MSC_VER
+            _close(fd);
+#else
+            close(fd);
+#endif
+        }
+    };
+
+    struct Event : KernelObject
+    {
+        std::mutex mutex;
+        std::condition_variable signal;
+        bool manualReset;
+        bool set;
+
+        Event(bool manual, bool initial) : manualReset(manual), set(initial) {}
+    };
+
+    inline DWORD& LastError()
+    {
+        static thread_local DWORD error = 0;
+        return error;
+    }
+
+    inline DWORD ErrorFromErrno(int error)
+    {
+        switch (error)
+        {
+        case ENOENT:    return ERROR_FILE_NOT_FOUND;
+        case ENOTDIR:   return ERROR_PATH_NOT_FOUND;
+        case EACCES:    return ERROR_ACCESS_DENIED;
+        case EEXIST:    return ERROR_FILE_EXISTS;
+        case ENOMEM:    return ERROR_NOT_ENOUGH_MEMORY;
+        case EFBIG:     return ERROR_FILE_TOO_LARGE;
+        default:        return ERROR_INVALID_DATA;
+        }
+    }
+
+    // File names are wide strings to the library and UTF-8 to the C runtime.
+    inline std::string NarrowPath(wchar_t const* path)
+    {
+        std::string result;
+
+        for (; *path; ++path)
+        {
+            auto c = static_cast<uint32_t>(*path);
+
+            if (c < 0x80)
+            {
+                result += static_cast<char>(c);
+            }
+            else if (c < 0x800)
+            {
+                result += static_cast<char>(0xC0 | (c >> 6));
+                result += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else if (c < 0x10000)
+            {
+                result += static_cast<char>(0xE0 | (c >> 12));
+                result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                result += static_cast<char>(0xF0 | (c >> 18));
+                result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                result += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+
+        return result;
+    }
+
+    // Mapped views and virtual allocations have to remember their size to be released.
+    inline std::map<void const*, size_t>& Views(std::mutex** lock)
+    {
+        static std::mutex s_lock;
+        static std::map<void const*, size_t> s_views;
+        *lock = &s_lock;
+        return s_views;
+    }
+
+    inline int64_t ReadAt(int fd, void* buffer, size_t size, int64_t offset)
+    {
+#ifdef _MSC_VER
+        // The CRT has no positional read, so overlapped reads on one handle are serialized.
+        static std::mutex s_lock;
+        std::lock_guard<std::mutex> lock(s_lock);
+        if (_lseeki64(fd, offset, SEEK_SET) < 0)
+            return -1;
+        return _read(fd, buffer, static_cast<unsigned>(size));
+#else
+        size_t total = 0;
+        while (total < size)
+        {
+            ssize_t n = pread(fd, static_cast<uint8_t*>(buffer) + total, size - total, static_cast<off_t>(offset + total));
+            if (n < 0)
+                return -1;
+            if (n == 0)
+                break;
+            total += static_cast<size_t>(n);
+        }
+        return static_cast<int64_t>(total);
+#endif
+    }
+
+    inline int64_t Read(int fd, void* buffer, size_t size)
+    {
+#ifdef _MSC_VER
+        return _read(fd, buffer, static_cast<unsigned>(size));
+#else
+        size_t total = 0;
+        while (total < size)
+        {
+            ssize_t n = read(fd, static_cast<uint8_t*>(buffer) + total, size - total);
+            if (n < 0)
+                return -1;
+            if (n == 0)
+                break;
+            total += static_cast<size_t>(n);
+        }
+        return static_cast<int64_t>(total);
+#endif
+    }
+
+    inline int64_t Write(int fd, void const* buffer, size_t size)
+    {
+#ifdef _MSC_VER
+        return _write(fd, buffer, static_cast<unsigned>(size));
+#else
+        size_t total = 0;
+        while (total < size)
+        {
+            ssize_t n = write(fd, static_cast<uint8_t const*>(buffer) + total, size - total);
+            if (n < 0)
+                return -1;
+            total += static_cast<size_t>(n);
+        }
+        return static_cast<int64_t>(total);
+#endif
+    }
+}
+
+inline DWORD GetLastError()
+{
+    return StubWin32::LastError();
+}
+
+inline void SetLastError(DWORD error)
+{
+    StubWin32::LastError() = error;
+}
+
+inline BOOL CloseHandle(HANDLE h)
+{
+    if (!h || h == INVALID_HANDLE_VALUE)
+    {
+        SetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    delete static_cast<StubWin32::KernelObject*>(h);
+    return TRUE;
+}
+
+inline HANDLE CreateFileW(LPCWSTR fileName, DWORD desiredAccess, DWORD shareMode, LPSECURITY_ATTRIBUTES, DWORD creationDisposition, DWORD flags, HANDLE)
+{
+    UNREFERENCED_PARAMETER(shareMode);
+    UNREFERENCED_PARAMETER(flags);
+
+    int mode = ((desiredAccess & GENERIC_READ) && (desiredAccess & GENERIC_WRITE)) ? O_RDWR
+             : (desiredAccess & GENERIC_WRITE) ? O_WRONLY : O_RDONLY;
+
+    switch (creationDisposition)
+    {
+    case CREATE_NEW:        mode |= O_CREAT | O_EXCL; break;
+    case CREATE_ALWAYS:     mode |= O_CREAT | O_TRUNC; break;
+    case OPEN_ALWAYS:       mode |= O_CREAT; break;
+    case TRUNCATE_EXISTING: mode |= O_TRUNC; break;
+    default:                break;
+    }
+
+    auto path = StubWin32::NarrowPath(fileName);
+
+#ifdef _MSC_VER
+    int fd = _open(path.c_str(), mode | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    int fd = open(path.c_str(), mode | O_CLOEXEC, 0644);
+#endif
+
+    if (fd < 0)
+    {
+        SetLastError(StubWin32::ErrorFromErrno(errno));
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return new StubWin32::File(fd, path);
+}
+
+inline HANDLE CreateFile2(LPCWSTR fileName, DWORD desiredAccess, DWORD shareMode, DWORD creationDisposition, CREATEFILE2_EXTENDED_PARAMETERS* params)
+{
+    return CreateFileW(fileName, desiredAccess, shareMode, nullptr, creationDisposition, params ? params->dwFileFlags : 0, nullptr);
+}
+
+inline BOOL DeleteFileW(LPCWSTR fileName)
+{
+    if (remove(StubWin32::NarrowPath(fileName).c_str()) != 0)
+    {
+        SetLastError(StubWin32::ErrorFromErrno(errno));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+inline BOOL GetFileInformationByHandleEx(HANDLE h, FILE_INFO_BY_HANDLE_CLASS infoClass, LPVOID info, DWORD size)
+{
+    if (infoClass != FileStandardInfo || size < sizeof(FILE_STANDARD_INFO))
+    {
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return FALSE;
+    }
+
+    auto file = static_cast<StubWin32::File*>(h);
+
+#ifdef _MSC_VER
+    struct _stat64 st;
+    int result = _fstat64(file->fd, &st);
+#else
+    struct stat st;
+    int result = fstat(file->fd, &st);
+#endif
+
+    if (result != 0)
+    {
+        SetLastError(StubWin32::ErrorFromErrno(errno));
+        return FALSE;
+    }
+
+    auto standardInfo = static_cast<FILE_STANDARD_INFO*>(info);
+    memset(standardInfo, 0, sizeof(FILE_STANDARD_INFO));
+    standardInfo->EndOfFile.QuadPart = static_cast<LONGLONG>(st.st_size);
+    standardInfo->AllocationSize.QuadPart = static_cast<LONGLONG>(st.st_size);
+    standardInfo->NumberOfLinks = 1;
+    return TRUE;
+}
+
+inline BOOL SetFileInformationByHandle(HANDLE h, FILE_INFO_BY_HANDLE_CLASS infoClass, LPVOID info, DWORD size)
+{
+    if (infoClass != FileDispositionInfo || size < sizeof(FILE_DISPOSITION_INFO))
+    {
+        SetLastError(ERROR_NOT_SUPPORTED);
+        return FALSE;
+    }
+
+    static_cast<StubWin32::File*>(h)->deleteOnClose = static_cast<FILE_DISPOSITION_INFO*>(info)->DeleteFile != 0;
+    return TRUE;
+}
+
+inline BOOL SetEvent(HANDLE h)
+{
+    auto event = static_cast<StubWin32::Event*>(h);
+    {
+        std::lock_guard<std::mutex> lock(event->mutex);
+        event->set = true;
+    }
+    event->signal.notify_all();
+    return TRUE;
+}
+
+inline BOOL ResetEvent(HANDLE h)
+{
+    auto event = static_cast<StubWin32::Event*>(h);
+    std::lock_guard<std::mutex> lock(event->mutex);
+    event->set = false;
+    return TRUE;
+}
+
+inline HANDLE CreateEventEx(LPSECURITY_ATTRIBUTES, LPCWSTR, DWORD flags, DWORD)
+{
+    return new StubWin32::Event((flags & CREATE_EVENT_MANUAL_RESET) != 0, (flags & CREATE_EVENT_INITIAL_SET) != 0);
+}
+
+inline DWORD WaitForSingleObject(HANDLE h, DWORD milliseconds)
+{
+    auto event = static_cast<StubWin32::Event*>(h);
+    std::unique_lock<std::mutex> lock(event->mutex);
+
+    if (milliseconds == INFINITE)
+    {
+        event->signal.wait(lock, [=] { return event->set; });
+    }
+    else if (!event->signal.wait_for(lock, std::chrono::milliseconds(milliseconds), [=] { return event->set; }))
+    {
+        return WAIT_TIMEOUT;
+    }
+
+    if (!event->manualReset)
+        event->set = false;
+
+    return WAIT_OBJECT_0;
+}
+
+// Overlapped reads complete before returning, which Windows also allows.
+inline BOOL ReadFile(HANDLE h, LPVOID buffer, DWORD size, DWORD* bytesRead, LPOVERLAPPED overlapped)
+{
+    auto file = static_cast<StubWin32::File*>(h);
+
+    int64_t result;
+    if (overlapped)
+    {
+        int64_t offset = static_cast<int64_t>(overlapped->Offset) | (static_cast<int64_t>(overlapped->OffsetHigh) << 32);
+        result = StubWin32::ReadAt(file->fd, buffer, size, offset);
+
+        overlapped->Internal = (result < 0) ? static_cast<ULONG_PTR>(StubWin32::ErrorFromErrno(errno)) : 0;
+        overlapped->InternalHigh = (result < 0) ? 0 : static_cast<ULONG_PTR>(result);
+
+        if (overlapped->hEvent)
+            SetEvent(overlapped->hEvent);
+    }
+    else
+    {
+        result = StubWin32::Read(file->fd, buffer, size);
+    }
+
+    if (result < 0)
+    {
+        SetLastError(StubWin32::ErrorFromErrno(errno));
+        return FALSE;
+    }
+
+    if (bytesRead)
+        *bytesRead = static_cast<DWORD>(result);
+
+    return TRUE;
+}
+
+inline BOOL WriteFile(HANDLE h, LPCVOID buffer, DWORD size, DWORD* bytesWritten, LPOVERLAPPED)
+{
+    auto file = static_cast<StubWin32::File*>(h);
+
+    int64_t result = StubWin32::Write(file->fd, buffer, size);
+    if (result < 0)
+    {
+        SetLastError(StubWin32::ErrorFromErrno(errno));
+        return FALSE;
+    }
+
+    if (bytesWritten)
+        *bytesWritten = static_cast<DWORD>(result);
+
+    return TRUE;
+}
+
+inline BOOL GetOverlappedResult(HANDLE, LPOVERLAPPED overlapped, DWORD* bytesTransferred, BOOL)
+{
+    if (overlapped->Internal)
+    {
+        SetLastError(static_cast<DWORD>(overlapped->Internal));
+        return FALSE;
+    }
+
+    *bytesTransferred = static_cast<DWORD>(overlapped->InternalHigh);
+    return TRUE;
+}
+
+inline HANDLE CreateFileMappingW(HANDLE h, LPSECURITY_ATTRIBUTES, DWORD, DWORD, DWORD, LPCWSTR)
+{
+    auto file = static_cast<StubWin32::File*>(h);
+
+    FILE_STANDARD_INFO info;
+    if (!GetFileInformationByHandleEx(h, FileStandardInfo, &info, sizeof(info)))
+        return nullptr;
+
+#ifdef _MSC_VER
+    int fd = _dup(file->fd);
+#else
+    int fd = dup(file->fd);
+#endif
+
+    if (fd < 0)
+    {
+        SetLastError(StubWin32::ErrorFromErrno(errno));
+        return nullptr;
+    }
+
+    return new StubWin32::FileMapping(fd, static_cast<size_t>(info.EndOfFile.QuadPart));
+}
+
+inline LPVOID MapViewOfFile(HANDLE h, DWORD, DWORD, DWORD, SIZE_T)
+{
+    auto mapping = static_cast<StubWin32::FileMapping*>(h);
+
+#ifdef _MSC_VER
+    // The CRT can't map files, so the view is a copy.
+    void* view = malloc(mapping->size);
+    if (!view || StubWin32::ReadAt(mapping->fd, view, mapping->size, 0) != static_cast<int64_t>(mapping->size))
+    {
+        free(view);
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return nullptr;
+    }
+#else
+    void* view = mmap(nullptr, mapping->size, PROT_READ, MAP_PRIVATE, mapping->fd, 0);
+    if (view == MAP_FAILED)
+    {
+        SetLastError(StubWin32::ErrorFromErrno(errno));
+        return nullptr;
+    }
+#endif
+
+    std::mutex* lock;
+    auto& views = StubWin32::Views(&lock);
+    std::lock_guard<std::mutex> guard(*lock);
+    views[view] = mapping->size;
+    return view;
+}
+
+inline BOOL UnmapViewOfFile(LPCVOID view)
+{
+    std::mutex* lock;
+    auto& views = StubWin32::Views(&lock);
+    std::lock_guard<std::mutex> guard(*lock);
+
+    auto it = views.find(view);
+    if (it == views.end())
+    {
+        SetLastError(ERROR_INVALID_PARAMETER);
+        return FALSE;
+    }
+
+#ifdef _MSC_VER
+    free(const_cast<void*>(view));
+#else
+    munmap(const_cast<void*>(view), it->second);
+#endif
+
+    views.erase(it);
+    return TRUE;
+}
+
+inline LPVOID VirtualAlloc(LPVOID, SIZE_T size, DWORD, DWORD)
+{
+    void* p = calloc(1, size);
+    if (!p)
+    {
+        SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+        return nullptr;
+    }
+
+    std::mutex* lock;
+    auto& views = StubWin32::Views(&lock);
+    std::lock_guard<std::mutex> guard(*lock);
+    views[p] = size;
+    return p;
+}
+
+inline BOOL VirtualFree(LPVOID p, SIZE_T, DWORD)
+{
+    std::mutex* lock;
+    auto& views = StubWin32::Views(&lock);
+    std::lock_guard<std::mutex> guard(*lock);
+
+    views.erase(p);
+    free(p);
+    return TRUE;
+}
+
+inline void OutputDebugStringA(LPCSTR text)
+{
+    fputs(text, stderr);
+}
+
+inline BOOL SwitchToThread()
+{
+    std::this_thread::yield();
+    return TRUE;
+}
+
+#ifndef _MSC_VER
+#define MemoryBarrier() std::atomic_thread_fence(std::memory_order_seq_cst)
+#endif
+
+
+//--------------------------------------------------------------------------------------
+// COM. Interface ids only have to be distinct, so each interface is given a numbered GUID
+// by STUB_INTERFACE_ID rather than its real one.
+//--------------------------------------------------------------------------------------
+struct GUID
+{
+    uint32_t Data1;
+    uint16_t Data2;
+    uint16_t Data3;
+    uint8_t Data4[8];
+};
+
+typedef GUID IID;
+typedef GUID CLSID;
+typedef GUID const& REFGUID;
+typedef GUID const& REFIID;
+typedef GUID const& REFCLSID;
+
+inline bool operator== (GUID const& a, GUID const& b) { return memcmp(&a, &b, sizeof(GUID)) == 0; }
+inline bool operator!= (GUID const& a, GUID const& b) { return !(a == b); }
+
+#define COINIT_MULTITHREADED        0x0
+#define COINIT_APARTMENTTHREADED    0x2
+#define CLSCTX_INPROC_SERVER        0x1
+
+inline HRESULT CoInitializeEx(LPVOID, DWORD) { return S_OK; }
+inline void CoUninitialize() {}
+
+struct IUnknown
+{
+    virtual HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) = 0;
+    virtual ULONG STDMETHODCALLTYPE AddRef() = 0;
+    virtual ULONG STDMETHODCALLTYPE Release() = 0;
+
+protected:
+    virtual ~IUnknown() {}
+};
+
+template<typename T> struct StubInterfaceId;
+
+#define STUB_INTERFACE_ID(T, n) \
+    template<> struct StubInterfaceId<T> { static IID const& Get() { static IID const id = { n, 0, 0, { 0xB3, 0x7C, 0, 0, 0, 0, 0, 0 } }; return id; } };
+
+STUB_INTERFACE_ID(IUnknown, 1)
+
+template<typename T>
+inline IID const& StubIIDOf(T**)
+{
+    return StubInterfaceId<T>::Get();
+}
+
+#define IID_PPV_ARGS(pp) StubIIDOf(pp), reinterpret_cast<void**>(pp)
+
+// Reference counting shared by the stub objects, which list the interfaces they answer to.
+template<typename T, typename... TInterfaces>
+class StubObject : public T
+{
+public:
+    StubObject() : mRefCount(1) {}
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override
+    {
+        if (!ppvObject)
+            return E_POINTER;
+
+        if (Implements<IUnknown, T, TInterfaces...>(riid))
+        {
+            AddRef();
+            *ppvObject = static_cast<T*>(this);
+            return S_OK;
+        }
+
+        *ppvObject = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    ULONG STDMETHODCALLTYPE AddRef() override
+    {
+        return ++mRefCount;
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override
+    {
+        ULONG count = --mRefCount;
+        if (!count)
+            delete this;
+        return count;
+    }
+
+private:
+    template<typename TFirst>
+    static bool Implements(REFIID riid)
+    {
+        return riid == StubInterfaceId<TFirst>::Get();
+    }
+
+    template<typename TFirst, typename TSecond, typename... TRest>
+    static bool Implements(REFIID riid)
+    {
+        return Implements<TFirst>(riid) || Implements<TSecond, TRest...>(riid);
+    }
+
+    std::atomic<ULONG> mRefCount;
+};
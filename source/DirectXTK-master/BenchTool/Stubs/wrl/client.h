@@ -0,0 +1,190 @@
+//--------------------------------------------------------------------------------------
+// File: wrl/client.h
+//
+// BenchTool stand-in for the WRL ComPtr smart pointer, over the IUnknown of the stub
+// windows.h.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <windows.h>
+
+#include <cstddef>
+#include <utility>
+
+
+namespace Microsoft
+{
+    namespace WRL
+    {
+        namespace Details
+        {
+            // What &comPtr returns: converts to T** (releasing whatever the pointer held, as an
+            // output parameter expects), to void** for IID_PPV_ARGS style calls, and to the
+            // ComPtr itself.
+            template<typename TComPtr>
+            class ComPtrRef
+            {
+            public:
+                typedef typename TComPtr::InterfaceType InterfaceType;
+
+                explicit ComPtrRef(TComPtr* ptr) : mPtr(ptr) {}
+
+                operator TComPtr*() { return mPtr; }
+                operator InterfaceType**() { return mPtr->ReleaseAndGetAddressOf(); }
+                operator void**() const { return reinterpret_cast<void**>(mPtr->ReleaseAndGetAddressOf()); }
+                InterfaceType* operator*() { return mPtr->Get(); }
+
+                InterfaceType* const* GetAddressOf() const { return mPtr->GetAddressOf(); }
+                InterfaceType** ReleaseAndGetAddressOf() { return mPtr->ReleaseAndGetAddressOf(); }
+
+            private:
+                TComPtr* mPtr;
+            };
+        }
+
+
+        template<typename T>
+        class ComPtr
+        {
+        public:
+            typedef T InterfaceType;
+
+            ComPtr() : ptr_(nullptr) {}
+            ComPtr(std::nullptr_t) : ptr_(nullptr) {}
+
+            template<class U>
+            ComPtr(U* other) : ptr_(other) { InternalAddRef(); }
+
+            ComPtr(const ComPtr& other) : ptr_(other.ptr_) { InternalAddRef(); }
+
+            template<class U>
+            ComPtr(const ComPtr<U>& other) : ptr_(other.Get()) { InternalAddRef(); }
+
+            ComPtr(ComPtr&& other) : ptr_(other.ptr_) { other.ptr_ = nullptr; }
+
+            template<class U>
+            ComPtr(ComPtr<U>&& other) : ptr_(other.Detach()) {}
+
+            ~ComPtr() { InternalRelease(); }
+
+            ComPtr& operator= (std::nullptr_t) { InternalRelease(); return *this; }
+            ComPtr& operator= (T* other) { ComPtr(other).Swap(*this); return *this; }
+            ComPtr& operator= (const ComPtr& other) { ComPtr(other).Swap(*this); return *this; }
+            ComPtr& operator= (ComPtr&& other) { ComPtr(std::move(other)).Swap(*this); return *this; }
+
+            template<class U>
+            ComPtr& operator= (const ComPtr<U>& other) { ComPtr(other).Swap(*this); return *this; }
+
+            template<class U>
+            ComPtr& operator= (ComPtr<U>&& other) { ComPtr(std::move(other)).Swap(*this); return *this; }
+
+            void Swap(ComPtr& r) { std::swap(ptr_, r.ptr_); }
+            void Swap(ComPtr&& r) { std::swap(ptr_, r.ptr_); }
+
+            explicit operator bool() const { return ptr_ != nullptr; }
+
+            T* Get() const { return ptr_; }
+            T* operator->() const { return ptr_; }
+
+            Details::ComPtrRef<ComPtr<T>> operator&() { return Details::ComPtrRef<ComPtr<T>>(this); }
+            const Details::ComPtrRef<const ComPtr<T>> operator&() const { return Details::ComPtrRef<const ComPtr<T>>(this); }
+
+            T* const* GetAddressOf() const { return &ptr_; }
+            T** GetAddressOf() { return &ptr_; }
+            T** ReleaseAndGetAddressOf() { InternalRelease(); return &ptr_; }
+
+            T* Detach()
+            {
+                T* ptr = ptr_;
+                ptr_ = nullptr;
+                return ptr;
+            }
+
+            void Attach(T* other)
+            {
+                InternalRelease();
+                ptr_ = other;
+            }
+
+            unsigned long Reset() { return InternalRelease(); }
+
+            HRESULT CopyTo(T** ptr) const
+            {
+                InternalAddRef();
+                *ptr = ptr_;
+                return S_OK;
+            }
+
+            HRESULT CopyTo(REFIID riid, void** ptr) const { return ptr_->QueryInterface(riid, ptr); }
+
+            template<typename U>
+            HRESULT CopyTo(U** ptr) const { return ptr_->QueryInterface(StubIIDOf(ptr), reinterpret_cast<void**>(ptr)); }
+
+            template<typename U>
+            HRESULT As(Details::ComPtrRef<ComPtr<U>> p) const
+            {
+                return ptr_->QueryInterface(StubInterfaceId<U>::Get(), static_cast<void**>(p));
+            }
+
+            template<typename U>
+            HRESULT As(ComPtr<U>* p) const
+            {
+                return ptr_->QueryInterface(StubInterfaceId<U>::Get(), reinterpret_cast<void**>(p->ReleaseAndGetAddressOf()));
+            }
+
+        private:
+            void InternalAddRef() const
+            {
+                if (ptr_)
+                    ptr_->AddRef();
+            }
+
+            unsigned long InternalRelease()
+            {
+                unsigned long ref = 0;
+                T* temp = ptr_;
+
+                if (temp)
+                {
+                    ptr_ = nullptr;
+                    ref = temp->Release();
+                }
+
+                return ref;
+            }
+
+            T* ptr_;
+        };
+
+        template<class T, class U>
+        bool operator== (const ComPtr<T>& a, const ComPtr<U>& b) { return a.Get() == b.Get(); }
+
+        template<class T>
+        bool operator== (const ComPtr<T>& a, std::nullptr_t) { return a.Get() == nullptr; }
+
+        template<class T>
+        bool operator== (std::nullptr_t, const ComPtr<T>& a) { return a.Get() == nullptr; }
+
+        template<class T, class U>
+        bool operator!= (const ComPtr<T>& a, const ComPtr<U>& b) { return a.Get() != b.Get(); }
+
+        template<class T>
+        bool operator!= (const ComPtr<T>& a, std::nullptr_t) { return a.Get() != nullptr; }
+
+        template<class T>
+        bool operator!= (std::nullptr_t, const ComPtr<T>& a) { return a.Get() != nullptr; }
+
+        template<class T, class U>
+        bool operator< (const ComPtr<T>& a, const ComPtr<U>& b) { return a.Get() < b.Get(); }
+    }
+}
@@ -0,0 +1,305 @@
+//--------------------------------------------------------------------------------------
+// File: benchtool.cpp
+//
+// CPU benchmarks for DirectXTK. The library sources are compiled as they are, against
+// the stand-in Windows, Direct3D 11 and WIC headers in Stubs, and driven through the
+// recording device in RecordingDevice.h, so the suites measure the CPU side of each
+// class (sprites per second, batches per frame, bytes mapped) on any machine, and check
+// that the work they measured was done correctly.
+//
+// Build it with the Visual Studio project, or with any C++14 compiler, for example:
+//
+//     g++ -O2 -std=c++14 -pthread -msse4.1 -D_CPPRTTI -Wall -Wno-unknown-pragmas
+//         -Wno-sign-compare -Wno-reorder -Wno-switch -Wno-enum-compare -Wno-class-memaccess
+//         -Wno-ignored-attributes -IStubs -I../Inc -I../Src -o benchtool
+//         benchtool.cpp RecordingDevice.cpp SpriteBatchBench.cpp DdsBench.cpp
+//         AnimationBench.cpp RenderQueueBench.cpp ScreenGrabBench.cpp CacheBench.cpp
+//         BcBench.cpp MipBench.cpp CubemapBench.cpp SpriteSortBench.cpp
+//         SpriteVertexBench.cpp RecorderBench.cpp
+//         ../Src/SpriteBatch.cpp ../Src/CommonStates.cpp ../Src/VertexTypes.cpp
+//         ../Src/DDSTextureLoader.cpp ../Src/ModelAnimation.cpp ../Src/Model.cpp
+//         ../Src/EffectCommon.cpp ../Src/RenderQueue.cpp ../Src/ScreenGrab.cpp
+//
+// The -Wno flags silence warnings in the library sources that Visual C++ doesn't give.
+// The same line with -O1 -g -fsanitize=address,undefined (or -fsanitize=thread -Wno-tsan)
+// builds the sanitizer runs that the Linux CI job makes.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Bench.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996)
+#endif
+
+using namespace BenchTool;
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+enum OPTIONS
+{
+    OPT_SCALE = 1,
+    OPT_THREADS,
+    OPT_LIST,
+    OPT_NOLOGO,
+    OPT_MAX
+};
+
+static_assert(OPT_MAX <= 32, "dwOptions is a uint32_t bitfield");
+
+struct SValue
+{
+    const char* pName;
+    uint32_t dwValue;
+};
+
+const SValue g_pOptions[] =
+{
+    { "scale",      OPT_SCALE },
+    { "threads",    OPT_THREADS },
+    { "list",       OPT_LIST },
+    { "nologo",     OPT_NOLOGO },
+    { nullptr,      0 }
+};
+
+struct SSuite
+{
+    const char* pName;
+    void (*pRun)(Bench& bench);
+    const char* pDescription;
+};
+
+const SSuite g_pSuites[] =
+{
+    { "sprites",        SpriteBatchScenarios,   "SpriteBatch in game-like frames: HUD, tile map, particles, texture switching" },
+    { "spritestress",   SpriteBatchStress,      "SpriteBatch with a million sprites, immediate mode and threaded recorders" },
+    { "layers",         SpriteBatchLayers,      "SpriteBatch layers against redrawing the same overlay every frame" },
+    { "ddsheaders",     DDSHeaderValidation,    "DDS header parsing, loading and rejection over a batch of every format" },
+    { "animation",      AnimationSampling,      "AnimationPlayer bones per second against sampling one bone at a time" },
+    { "renderqueue",    RenderQueueSorting,     "RenderQueue sort order and state filtering against Model::Draw per instance" },
+    { "screengrab",     ScreenGrabQueueing,     "ScreenGrabQueue images and MSAA frame sequences, checked file by file" },
+    { "cache",          ShardedCacheLookups,    "ShardedCache lookups on 1 to N threads against a std::map under one mutex" },
+    { "bc",             BlockCompressionCodec,  "BC1, BC3, BC4 and BC5 encode and decode throughput against PSNR" },
+    { "mips",           MipChainGeneration,     "CPU mip chains for a 4K image with box and Kaiser filters, linear and sRGB" },
+    { "cubemaps",       DDSCubemapLoading,      "DDS cubemaps and texture arrays: subresource layout setup and whole loads" },
+    { "spritesort",     SpriteSortKeys,         "Sprite sort keys and radix sort against std::sort on pointers, 10k to 1M sprites" },
+    { "spritevertices", SpriteVertexGeneration, "SpriteBatch vertex generation, four sprites at a time against one at a time" },
+    { "recorders",      SpriteRecording,        "SpriteBatch::Recorder on 1 to N threads, and merging their sprites in End" },
+    { nullptr,          nullptr,                nullptr }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    bool IsName(const char* a, const char* b)
+    {
+        std::string x(a), y(b);
+        std::transform(x.begin(), x.end(), x.begin(), ::tolower);
+        std::transform(y.begin(), y.end(), y.begin(), ::tolower);
+        return x == y;
+    }
+
+    uint32_t LookupByName(const char* pName, const SValue* pArray)
+    {
+        while (pArray->pName)
+        {
+            if (IsName(pName, pArray->pName))
+                return pArray->dwValue;
+
+            pArray++;
+        }
+
+        return 0;
+    }
+
+    const SSuite* LookupSuite(const char* pName)
+    {
+        for (auto suite = g_pSuites; suite->pName; ++suite)
+        {
+            if (IsName(pName, suite->pName))
+                return suite;
+        }
+
+        return nullptr;
+    }
+
+    void PrintLogo()
+    {
+        printf("Microsoft (R) DirectXTK CPU Benchmark Tool\n");
+        printf("Copyright (C) Microsoft Corp. All rights reserved.\n");
+#ifdef _DEBUG
+        printf("*** Debug build ***\n");
+#endif
+        printf("\n");
+    }
+
+    void PrintUsage()
+    {
+        PrintLogo();
+
+        printf("Usage: benchtool <options> [suites]\n");
+        printf("\n");
+        printf("   suites              suites to run, see -list (default: all of them)\n");
+        printf("   -scale <factor>     multiplies the work each suite does (default 1)\n");
+        printf("   -threads <count>    threads for the threaded suites, 0 for one per core (default)\n");
+        printf("   -list               list the suites and exit\n");
+        printf("   -nologo             suppress copyright message\n");
+        printf("\n");
+        printf("   The exit code is 1 if any suite throws or any of its checks fail.\n");
+    }
+
+    void PrintSuites()
+    {
+        for (auto suite = g_pSuites; suite->pName; ++suite)
+            printf("   %-16s %s\n", suite->pName, suite->pDescription);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    // Parameters and defaults
+    double scale = 1.0;
+    unsigned threadCount = 0;
+
+    // Process command line
+    uint32_t dwOptions = 0;
+    std::vector<const SSuite*> suites;
+
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        char* pArg = argv[iArg];
+
+        if (('-' == pArg[0]) || ('/' == pArg[0]))
+        {
+            pArg++;
+            char* pValue;
+
+            for (pValue = pArg; *pValue && (':' != *pValue); pValue++);
+
+            if (*pValue)
+                *pValue++ = 0;
+
+            uint32_t dwOption = LookupByName(pArg, g_pOptions);
+
+            if (!dwOption || (dwOptions & (1 << dwOption)))
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            dwOptions |= 1 << dwOption;
+
+            // Handle options with additional value parameter
+            switch (dwOption)
+            {
+            case OPT_SCALE:
+            case OPT_THREADS:
+                if (!*pValue)
+                {
+                    if ((iArg + 1 >= argc))
+                    {
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    iArg++;
+                    pValue = argv[iArg];
+                }
+                break;
+            }
+
+            switch (dwOption)
+            {
+            case OPT_SCALE:
+                scale = strtod(pValue, nullptr);
+                break;
+
+            case OPT_THREADS:
+                threadCount = unsigned(strtoul(pValue, nullptr, 10));
+                break;
+            }
+        }
+        else
+        {
+            auto suite = LookupSuite(pArg);
+            if (!suite)
+            {
+                printf("Unknown suite (%s)\n", pArg);
+                return 1;
+            }
+            suites.push_back(suite);
+        }
+    }
+
+    if (!(scale > 0))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (~dwOptions & (1 << OPT_NOLOGO))
+        PrintLogo();
+
+    if (dwOptions & (1 << OPT_LIST))
+    {
+        PrintSuites();
+        return 0;
+    }
+
+    if (suites.empty())
+    {
+        for (auto suite = g_pSuites; suite->pName; ++suite)
+            suites.push_back(suite);
+    }
+
+    Bench bench(scale, threadCount);
+    int result = 0;
+
+    for (auto suite : suites)
+    {
+        printf("%s\n", suite->pName);
+
+        Timer timer;
+
+        try
+        {
+            suite->pRun(bench);
+        }
+        catch (const std::exception& e)
+        {
+            printf("\nERROR: %s: %s\n", suite->pName, e.what());
+            result = 1;
+        }
+
+        printf("  (%.2f s)\n\n", timer.GetSeconds());
+    }
+
+    if (bench.GetFailures())
+    {
+        printf("%zu check(s) failed\n", bench.GetFailures());
+        result = 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,1938 @@
+//--------------------------------------------------------------------------------------
+// File: ddstool.cpp
+//
+// Simple command-line tool for converting .PNG images into .DDS textures with a
+// precomputed mip chain and BC1, BC3, BC4, BC5 or BC7 block compression, so that content can be
+// loaded with CreateDDSTextureFromFile rather than decoded through WIC at runtime. It can also
+// pack several images and .spritefont sheets into one atlas page for TextureAtlas.
+//
+// It only depends on the C++ standard library so it can run as part of a content build
+// on any platform, for example:
+//
+//     g++ -O2 -std=c++14 -pthread -I../Src -o ddstool ddstool.cpp
+//
+// For a more full-featured texture converter, see texconv in DirectXTex.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AtlasPacker.h"
+#include "BlockCompression.h"
+#include "MipGenerator.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996)
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+enum OPTIONS
+{
+    OPT_OUTPUTDIR = 1,
+    OPT_FORMAT,
+    OPT_MIPLEVELS,
+    OPT_SRGB,
+    OPT_NOGAMMA,
+    OPT_FILTER,
+    OPT_NOOVERWRITE,
+    OPT_PSNR,
+    OPT_ATLAS,
+    OPT_NOLOGO,
+    OPT_MAX
+};
+
+static_assert(OPT_MAX <= 32, "dwOptions is a uint32_t bitfield");
+
+enum FORMAT
+{
+    FORMAT_AUTO = 1,
+    FORMAT_BC1,
+    FORMAT_BC3,
+    FORMAT_BC4,
+    FORMAT_BC5,
+    FORMAT_BC7,
+    FORMAT_RGBA,
+};
+
+enum FILTER
+{
+    FILTER_BOX = 1,
+    FILTER_KAISER,
+};
+
+struct SValue
+{
+    const char* pName;
+    uint32_t dwValue;
+};
+
+const SValue g_pOptions[] =
+{
+    { "o",          OPT_OUTPUTDIR },
+    { "f",          OPT_FORMAT },
+    { "m",          OPT_MIPLEVELS },
+    { "srgb",       OPT_SRGB },
+    { "nogamma",    OPT_NOGAMMA },
+    { "if",         OPT_FILTER },
+    { "n",          OPT_NOOVERWRITE },
+    { "psnr",       OPT_PSNR },
+    { "atlas",      OPT_ATLAS },
+    { "nologo",     OPT_NOLOGO },
+    { nullptr,      0 }
+};
+
+const SValue g_pFormats[] =
+{
+    { "AUTO",       FORMAT_AUTO },
+    { "BC1",        FORMAT_BC1 },
+    { "DXT1",       FORMAT_BC1 },
+    { "BC3",        FORMAT_BC3 },
+    { "DXT5",       FORMAT_BC3 },
+    { "BC4",        FORMAT_BC4 },
+    { "BC5",        FORMAT_BC5 },
+    { "BC7",        FORMAT_BC7 },
+    { "RGBA",       FORMAT_RGBA },
+    { nullptr,      0 }
+};
+
+const SValue g_pFilters[] =
+{
+    { "BOX",        FILTER_BOX },
+    { "KAISER",     FILTER_KAISER },
+    { nullptr,      0 }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    //----------------------------------------------------------------------------------
+    // Image in 8-bit RGBA
+    struct Image
+    {
+        size_t width;
+        size_t height;
+        std::vector<uint8_t> pixels;
+
+        Image() : width(0), height(0) {}
+    };
+
+    std::vector<uint8_t> ReadEntireFile(const char* fileName)
+    {
+        FILE* f = fopen(fileName, "rb");
+        if (!f)
+            throw std::runtime_error("could not open file");
+
+        std::vector<uint8_t> data;
+
+        uint8_t buffer[65536];
+        for (;;)
+        {
+            size_t count = fread(buffer, 1, sizeof(buffer), f);
+            if (!count)
+                break;
+            data.insert(data.end(), buffer, buffer + count);
+        }
+
+        bool failed = ferror(f) != 0;
+        fclose(f);
+
+        if (failed)
+            throw std::runtime_error("error reading file");
+
+        return data;
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Inflate (RFC 1951) decoder for the zlib stream in PNG IDAT chunks
+    class Inflater
+    {
+    public:
+        Inflater(const uint8_t* src, size_t srcSize)
+            : mSrc(src), mSrcSize(srcSize), mPos(0), mBitBuf(0), mBitCount(0)
+        {}
+
+        void Decompress(std::vector<uint8_t>& out)
+        {
+            // zlib header (RFC 1950)
+            if (mSrcSize < 2 || (mSrc[0] & 0x0F) != 8 || ((mSrc[0] << 8) | mSrc[1]) % 31 != 0 || (mSrc[1] & 0x20))
+                throw std::runtime_error("invalid zlib stream");
+
+            mPos = 2;
+
+            int last;
+            do
+            {
+                last = Bits(1);
+                switch (Bits(2))
+                {
+                case 0: Stored(out); break;
+                case 1: Fixed(out); break;
+                case 2: Dynamic(out); break;
+                default: throw std::runtime_error("invalid deflate block");
+                }
+            } while (!last);
+        }
+
+    private:
+        static const int MaxBits = 15;
+
+        struct Huffman
+        {
+            uint16_t count[MaxBits + 1];
+            uint16_t symbol[288];
+        };
+
+        int Bits(int need)
+        {
+            uint32_t val = mBitBuf;
+            while (mBitCount < need)
+            {
+                if (mPos >= mSrcSize)
+                    throw std::runtime_error("unexpected end of deflate stream");
+                val |= uint32_t(mSrc[mPos++]) << mBitCount;
+                mBitCount += 8;
+            }
+
+            mBitBuf = val >> need;
+            mBitCount -= need;
+
+            return int(val & ((1u << need) - 1));
+        }
+
+        int Decode(const Huffman& h)
+        {
+            int code = 0;
+            int first = 0;
+            int index = 0;
+            for (int len = 1; len <= MaxBits; ++len)
+            {
+                code |= Bits(1);
+                int count = h.count[len];
+                if (code - count < first)
+                    return h.symbol[index + (code - first)];
+                index += count;
+                first += count;
+                first <<= 1;
+                code <<= 1;
+            }
+
+            throw std::runtime_error("invalid Huffman code");
+        }
+
+        static void Build(Huffman& h, const uint8_t* lengths, int n)
+        {
+            memset(h.count, 0, sizeof(h.count));
+            for (int s = 0; s < n; ++s)
+                h.count[lengths[s]]++;
+
+            uint16_t offs[MaxBits + 1];
+            offs[1] = 0;
+            for (int len = 1; len < MaxBits; ++len)
+                offs[len + 1] = uint16_t(offs[len] + h.count[len]);
+
+            for (int s = 0; s < n; ++s)
+            {
+                if (lengths[s])
+                    h.symbol[offs[lengths[s]]++] = uint16_t(s);
+            }
+        }
+
+        void Stored(std::vector<uint8_t>& out)
+        {
+            mBitBuf = 0;
+            mBitCount = 0;
+
+            if (mPos + 4 > mSrcSize)
+                throw std::runtime_error("unexpected end of deflate stream");
+
+            size_t len = mSrc[mPos] | (mSrc[mPos + 1] << 8);
+            size_t nlen = mSrc[mPos + 2] | (mSrc[mPos + 3] << 8);
+            mPos += 4;
+
+            if (len != (~nlen & 0xFFFF) || mPos + len > mSrcSize)
+                throw std::runtime_error("invalid stored block");
+
+            out.insert(out.end(), mSrc + mPos, mSrc + mPos + len);
+            mPos += len;
+        }
+
+        void Codes(std::vector<uint8_t>& out, const Huffman& lencode, const Huffman& distcode)
+        {
+            static const uint16_t s_lbase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+            static const uint8_t s_lext[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+            static const uint16_t s_dbase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+            static const uint8_t s_dext[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+            for (;;)
+            {
+                int symbol = Decode(lencode);
+                if (symbol < 256)
+                {
+                    out.push_back(uint8_t(symbol));
+                }
+                else if (symbol == 256)
+                {
+                    return;
+                }
+                else
+                {
+                    symbol -= 257;
+                    if (symbol >= 29)
+                        throw std::runtime_error("invalid length code");
+
+                    size_t len = s_lbase[symbol] + Bits(s_lext[symbol]);
+
+                    symbol = Decode(distcode);
+                    if (symbol >= 30)
+                        throw std::runtime_error("invalid distance code");
+
+                    size_t dist = s_dbase[symbol] + Bits(s_dext[symbol]);
+                    if (dist > out.size())
+                        throw std::runtime_error("distance too far back");
+
+                    size_t from = out.size() - dist;
+                    for (size_t j = 0; j < len; ++j)
+                        out.push_back(out[from + j]);
+                }
+            }
+        }
+
+        void Fixed(std::vector<uint8_t>& out)
+        {
+            uint8_t lengths[288 + 30];
+
+            int s = 0;
+            for (; s < 144; ++s) lengths[s] = 8;
+            for (; s < 256; ++s) lengths[s] = 9;
+            for (; s < 280; ++s) lengths[s] = 7;
+            for (; s < 288; ++s) lengths[s] = 8;
+            for (; s < 288 + 30; ++s) lengths[s] = 5;
+
+            Huffman lencode, distcode;
+            Build(lencode, lengths, 288);
+            Build(distcode, lengths + 288, 30);
+
+            Codes(out, lencode, distcode);
+        }
+
+        void Dynamic(std::vector<uint8_t>& out)
+        {
+            static const uint8_t s_order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+            int nlen = Bits(5) + 257;
+            int ndist = Bits(5) + 1;
+            int ncode = Bits(4) + 4;
+            if (nlen > 286 || ndist > 30)
+                throw std::runtime_error("invalid dynamic block");
+
+            uint8_t lengths[288 + 30] = {};
+            for (int j = 0; j < ncode; ++j)
+                lengths[s_order[j]] = uint8_t(Bits(3));
+
+            Huffman lencode, distcode;
+            Build(lencode, lengths, 19);
+
+            int index = 0;
+            while (index < nlen + ndist)
+            {
+                int symbol = Decode(lencode);
+                if (symbol < 16)
+                {
+                    lengths[index++] = uint8_t(symbol);
+                }
+                else
+                {
+                    uint8_t len = 0;
+                    int repeat;
+                    if (symbol == 16)
+                    {
+                        if (!index)
+                            throw std::runtime_error("invalid dynamic block");
+                        len = lengths[index - 1];
+                        repeat = 3 + Bits(2);
+                    }
+                    else if (symbol == 17)
+                    {
+                        repeat = 3 + Bits(3);
+                    }
+                    else
+                    {
+                        repeat = 11 + Bits(7);
+                    }
+
+                    if (index + repeat > nlen + ndist)
+                        throw std::runtime_error("invalid dynamic block");
+
+                    while (repeat--)
+                        lengths[index++] = len;
+                }
+            }
+
+            Build(lencode, lengths, nlen);
+            Build(distcode, lengths + nlen, ndist);
+
+            Codes(out, lencode, distcode);
+        }
+
+        const uint8_t*  mSrc;
+        size_t          mSrcSize;
+        size_t          mPos;
+        uint32_t        mBitBuf;
+        int             mBitCount;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // PNG decoder (non-interlaced, any bit depth and color type) producing 8-bit RGBA
+    inline uint32_t ReadBE32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    inline uint32_t ReadSample(const uint8_t* row, size_t index, unsigned depth)
+    {
+        switch (depth)
+        {
+        case 16:
+            return (uint32_t(row[index * 2]) << 8) | row[index * 2 + 1];
+
+        case 8:
+            return row[index];
+
+        default:
+        {
+            size_t bit = index * depth;
+            unsigned shift = 8 - depth - unsigned(bit & 7);
+            return (row[bit >> 3] >> shift) & ((1u << depth) - 1);
+        }
+        }
+    }
+
+    inline uint8_t ScaleSample(uint32_t value, unsigned depth)
+    {
+        switch (depth)
+        {
+        case 16: return uint8_t(value >> 8);
+        case 8: return uint8_t(value);
+        default: return uint8_t(value * 255 / ((1u << depth) - 1));
+        }
+    }
+
+    inline uint8_t Paeth(int a, int b, int c)
+    {
+        int p = a + b - c;
+        int pa = abs(p - a);
+        int pb = abs(p - b);
+        int pc = abs(p - c);
+        if (pa <= pb && pa <= pc)
+            return uint8_t(a);
+        return uint8_t((pb <= pc) ? b : c);
+    }
+
+    void DecodePNG(const std::vector<uint8_t>& file, Image& image, bool& hasAlpha)
+    {
+        static const uint8_t s_signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+        if (file.size() < 8 || memcmp(file.data(), s_signature, 8) != 0)
+            throw std::runtime_error("not a PNG file");
+
+        uint32_t width = 0, height = 0;
+        unsigned depth = 0, colorType = 0, interlace = 0;
+        uint8_t palette[256][4];
+        memset(palette, 0xFF, sizeof(palette));
+        bool hasKey = false;
+        uint32_t key[3] = {};
+        std::vector<uint8_t> idat;
+
+        hasAlpha = false;
+
+        size_t pos = 8;
+        for (;;)
+        {
+            if (pos + 8 > file.size())
+                throw std::runtime_error("truncated PNG file");
+
+            size_t length = ReadBE32(&file[pos]);
+            const uint8_t* type = &file[pos + 4];
+            const uint8_t* data = &file[pos + 8];
+
+            if (pos + 12 + length > file.size())
+                throw std::runtime_error("truncated PNG file");
+
+            if (!memcmp(type, "IHDR", 4))
+            {
+                if (length < 13)
+                    throw std::runtime_error("invalid IHDR chunk");
+                width = ReadBE32(data);
+                height = ReadBE32(data + 4);
+                depth = data[8];
+                colorType = data[9];
+                interlace = data[12];
+            }
+            else if (!memcmp(type, "PLTE", 4))
+            {
+                for (size_t j = 0; j < length / 3 && j < 256; ++j)
+                {
+                    palette[j][0] = data[j * 3];
+                    palette[j][1] = data[j * 3 + 1];
+                    palette[j][2] = data[j * 3 + 2];
+                }
+            }
+            else if (!memcmp(type, "tRNS", 4))
+            {
+                if (colorType == 3)
+                {
+                    for (size_t j = 0; j < length && j < 256; ++j)
+                        palette[j][3] = data[j];
+                }
+                else if (colorType == 0 && length >= 2)
+                {
+                    hasKey = true;
+                    key[0] = (data[0] << 8) | data[1];
+                }
+                else if (colorType == 2 && length >= 6)
+                {
+                    hasKey = true;
+                    for (size_t j = 0; j < 3; ++j)
+                        key[j] = (data[j * 2] << 8) | data[j * 2 + 1];
+                }
+            }
+            else if (!memcmp(type, "IDAT", 4))
+            {
+                idat.insert(idat.end(), data, data + length);
+            }
+            else if (!memcmp(type, "IEND", 4))
+            {
+                break;
+            }
+
+            pos += 12 + length;
+        }
+
+        unsigned channels;
+        switch (colorType)
+        {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default: throw std::runtime_error("unsupported PNG color type");
+        }
+
+        if (!width || !height || (depth != 1 && depth != 2 && depth != 4 && depth != 8 && depth != 16))
+            throw std::runtime_error("unsupported PNG image header");
+
+        if (interlace)
+            throw std::runtime_error("interlaced PNG files are not supported");
+
+        size_t bitsPerPixel = channels * depth;
+        size_t rowPitch = (width * bitsPerPixel + 7) / 8;
+        size_t filterStride = std::max<size_t>(1, bitsPerPixel / 8);
+
+        std::vector<uint8_t> raw;
+        raw.reserve((rowPitch + 1) * height);
+        Inflater(idat.data(), idat.size()).Decompress(raw);
+
+        if (raw.size() < (rowPitch + 1) * height)
+            throw std::runtime_error("truncated PNG image data");
+
+        // Undo the per-row filters in place
+        for (size_t y = 0; y < height; ++y)
+        {
+            uint8_t* row = &raw[y * (rowPitch + 1)];
+            uint8_t filter = *row++;
+            const uint8_t* prior = y ? (row - rowPitch - 1) : nullptr;
+
+            for (size_t x = 0; x < rowPitch; ++x)
+            {
+                int a = (x >= filterStride) ? row[x - filterStride] : 0;
+                int b = prior ? prior[x] : 0;
+                int c = (prior && x >= filterStride) ? prior[x - filterStride] : 0;
+
+                switch (filter)
+                {
+                case 0: break;
+                case 1: row[x] = uint8_t(row[x] + a); break;
+                case 2: row[x] = uint8_t(row[x] + b); break;
+                case 3: row[x] = uint8_t(row[x] + ((a + b) >> 1)); break;
+                case 4: row[x] = uint8_t(row[x] + Paeth(a, b, c)); break;
+                default: throw std::runtime_error("invalid PNG row filter");
+                }
+            }
+        }
+
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(size_t(width) * height * 4);
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            const uint8_t* row = &raw[y * (rowPitch + 1) + 1];
+            uint8_t* dest = &image.pixels[y * width * 4];
+
+            for (size_t x = 0; x < width; ++x, dest += 4)
+            {
+                switch (colorType)
+                {
+                case 0:
+                {
+                    uint32_t v = ReadSample(row, x, depth);
+                    dest[0] = dest[1] = dest[2] = ScaleSample(v, depth);
+                    dest[3] = (hasKey && v == key[0]) ? 0 : 255;
+                    break;
+                }
+
+                case 2:
+                {
+                    uint32_t r = ReadSample(row, x * 3, depth);
+                    uint32_t g = ReadSample(row, x * 3 + 1, depth);
+                    uint32_t b = ReadSample(row, x * 3 + 2, depth);
+                    dest[0] = ScaleSample(r, depth);
+                    dest[1] = ScaleSample(g, depth);
+                    dest[2] = ScaleSample(b, depth);
+                    dest[3] = (hasKey && r == key[0] && g == key[1] && b == key[2]) ? 0 : 255;
+                    break;
+                }
+
+                case 3:
+                    memcpy(dest, palette[ReadSample(row, x, depth) & 0xFF], 4);
+                    break;
+
+                case 4:
+                    dest[0] = dest[1] = dest[2] = ScaleSample(ReadSample(row, x * 2, depth), depth);
+                    dest[3] = ScaleSample(ReadSample(row, x * 2 + 1, depth), depth);
+                    break;
+
+                case 6:
+                    for (size_t c = 0; c < 4; ++c)
+                        dest[c] = ScaleSample(ReadSample(row, x * 4 + c, depth), depth);
+                    break;
+                }
+
+                if (dest[3] != 255)
+                    hasAlpha = true;
+            }
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Mip chain generation comes from Src/MipGenerator.h; colors are weighted by alpha since
+    // PNGs store straight alpha, and filtered in linear light unless disabled
+    void GenerateMips(const Image& base, size_t levels, unsigned flags, std::vector<Image>& mips)
+    {
+        std::vector<DirectX::MipGeneration::MipLevel> chain;
+        DirectX::MipGeneration::GenerateMipChain(base.pixels.data(), base.width, base.height, base.width * 4,
+                                                 levels, flags | DirectX::MipGeneration::MIP_ALPHA_WEIGHTED, chain);
+
+        mips.resize(chain.size());
+        for (size_t level = 0; level < chain.size(); ++level)
+        {
+            mips[level].width = chain[level].width;
+            mips[level].height = chain[level].height;
+            mips[level].pixels.swap(chain[level].pixels);
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Block compression; BC1 through BC5 come from Src/BlockCompression.h, BC7 is encoded here
+    struct Block
+    {
+        float pixels[16][4];
+    };
+
+    void LoadBlock(const Image& image, size_t bx, size_t by, Block& block)
+    {
+        // Partial blocks at the edges of small mips replicate the last row/column
+        for (size_t y = 0; y < 4; ++y)
+        {
+            size_t sy = std::min(by * 4 + y, image.height - 1);
+            for (size_t x = 0; x < 4; ++x)
+            {
+                size_t sx = std::min(bx * 4 + x, image.width - 1);
+                const uint8_t* s = &image.pixels[(sy * image.width + sx) * 4];
+                for (size_t c = 0; c < 4; ++c)
+                    block.pixels[y * 4 + x][c] = float(s[c]);
+            }
+        }
+    }
+
+    // The color of a transparent texel is never seen, so pull each color towards the block's
+    // alpha-weighted mean in proportion to its transparency before fitting endpoints.
+    void WeightByAlpha(const Block& block, Block& result)
+    {
+        float mean[3] = {};
+        float total = 0.f;
+        for (size_t j = 0; j < 16; ++j)
+        {
+            float a = block.pixels[j][3];
+            for (size_t c = 0; c < 3; ++c)
+                mean[c] += block.pixels[j][c] * a;
+            total += a;
+        }
+
+        if (total <= 0.f || total >= 16.f * 255.f)
+        {
+            result = block;
+            return;
+        }
+
+        for (size_t c = 0; c < 3; ++c)
+            mean[c] /= total;
+
+        for (size_t j = 0; j < 16; ++j)
+        {
+            float a = block.pixels[j][3] / 255.f;
+            for (size_t c = 0; c < 3; ++c)
+                result.pixels[j][c] = mean[c] + (block.pixels[j][c] - mean[c]) * a;
+            result.pixels[j][3] = block.pixels[j][3];
+        }
+    }
+
+    // Principal axis of the block's colors via power iteration.
+    void PrincipalAxis(const Block& block, size_t channels, float mean[4], float axis[4])
+    {
+        for (size_t c = 0; c < 4; ++c)
+            mean[c] = 0.f;
+
+        for (size_t j = 0; j < 16; ++j)
+            for (size_t c = 0; c < channels; ++c)
+                mean[c] += block.pixels[j][c];
+
+        for (size_t c = 0; c < channels; ++c)
+            mean[c] /= 16.f;
+
+        float cov[4][4] = {};
+        for (size_t j = 0; j < 16; ++j)
+        {
+            float d[4];
+            for (size_t c = 0; c < channels; ++c)
+                d[c] = block.pixels[j][c] - mean[c];
+
+            for (size_t r = 0; r < channels; ++r)
+                for (size_t c = 0; c < channels; ++c)
+                    cov[r][c] += d[r] * d[c];
+        }
+
+        float v[4] = { 1.f, 1.f, 1.f, 1.f };
+        for (size_t iter = 0; iter < 8; ++iter)
+        {
+            float w[4] = {};
+            for (size_t r = 0; r < channels; ++r)
+                for (size_t c = 0; c < channels; ++c)
+                    w[r] += cov[r][c] * v[c];
+
+            float len = 0.f;
+            for (size_t c = 0; c < channels; ++c)
+                len = std::max(len, fabsf(w[c]));
+
+            if (len < 1e-6f)
+                break;
+
+            for (size_t c = 0; c < channels; ++c)
+                v[c] = w[c] / len;
+        }
+
+        float len = 0.f;
+        for (size_t c = 0; c < channels; ++c)
+            len += v[c] * v[c];
+        len = sqrtf(len);
+
+        for (size_t c = 0; c < 4; ++c)
+            axis[c] = (c < channels) ? (v[c] / len) : 0.f;
+    }
+
+    void AxisEndpoints(const Block& block, size_t channels, float e0[4], float e1[4])
+    {
+        float mean[4], axis[4];
+        PrincipalAxis(block, channels, mean, axis);
+
+        float tmin = 0.f, tmax = 0.f;
+        for (size_t j = 0; j < 16; ++j)
+        {
+            float t = 0.f;
+            for (size_t c = 0; c < channels; ++c)
+                t += (block.pixels[j][c] - mean[c]) * axis[c];
+            tmin = std::min(tmin, t);
+            tmax = std::max(tmax, t);
+        }
+
+        for (size_t c = 0; c < channels; ++c)
+        {
+            e0[c] = std::min(std::max(mean[c] + axis[c] * tmax, 0.f), 255.f);
+            e1[c] = std::min(std::max(mean[c] + axis[c] * tmin, 0.f), 255.f);
+        }
+    }
+
+    // Least-squares endpoints for fixed interpolation weights (Castano, "High Quality DXT Compression").
+    bool RefineEndpoints(const Block& block, size_t channels, const float weights[16], float e0[4], float e1[4])
+    {
+        float aa = 0.f, bb = 0.f, ab = 0.f;
+        float ax[4] = {}, bx[4] = {};
+
+        for (size_t j = 0; j < 16; ++j)
+        {
+            float b = weights[j];
+            float a = 1.f - b;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (size_t c = 0; c < channels; ++c)
+            {
+                ax[c] += a * block.pixels[j][c];
+                bx[c] += b * block.pixels[j][c];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+            return false;
+
+        float inv = 1.f / det;
+        for (size_t c = 0; c < channels; ++c)
+        {
+            e0[c] = std::min(std::max((ax[c] * bb - bx[c] * ab) * inv, 0.f), 255.f);
+            e1[c] = std::min(std::max((bx[c] * aa - ax[c] * ab) * inv, 0.f), 255.f);
+        }
+
+        return true;
+    }
+
+    // BC7 mode 6: a single subset with 7.7.7.7 endpoints, a p-bit per endpoint and 4-bit indices.
+    const int g_bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct BC7Mode6
+    {
+        uint8_t endpoint[2][4];     // 7-bit values
+        uint8_t pbit[2];
+        uint8_t index[16];
+    };
+
+    float FitBC7Indices(const Block& block, BC7Mode6& result, float weights[16])
+    {
+        int e[2][4];
+        for (size_t k = 0; k < 2; ++k)
+            for (size_t c = 0; c < 4; ++c)
+                e[k][c] = (result.endpoint[k][c] << 1) | result.pbit[k];
+
+        float palette[16][4];
+        for (size_t i = 0; i < 16; ++i)
+            for (size_t c = 0; c < 4; ++c)
+                palette[i][c] = float(((64 - g_bc7Weights4[i]) * e[0][c] + g_bc7Weights4[i] * e[1][c] + 32) >> 6);
+
+        float error = 0.f;
+        for (size_t j = 0; j < 16; ++j)
+        {
+            float best = 1e30f;
+            uint8_t bestIndex = 0;
+            for (uint8_t i = 0; i < 16; ++i)
+            {
+                float d = 0.f;
+                for (size_t c = 0; c < 4; ++c)
+                {
+                    float t = block.pixels[j][c] - palette[i][c];
+                    d += t * t;
+                }
+                if (d < best)
+                {
+                    best = d;
+                    bestIndex = i;
+                }
+            }
+
+            result.index[j] = bestIndex;
+            weights[j] = float(g_bc7Weights4[bestIndex]) / 64.f;
+            error += best;
+        }
+
+        return error;
+    }
+
+    float QuantizeBC7(const Block& block, const float e0[4], const float e1[4], BC7Mode6& best, float weights[16])
+    {
+        float bestError = 1e30f;
+
+        for (uint8_t p = 0; p < 4; ++p)
+        {
+            BC7Mode6 trial;
+            trial.pbit[0] = p & 1;
+            trial.pbit[1] = (p >> 1) & 1;
+
+            for (size_t c = 0; c < 4; ++c)
+            {
+                int q0 = int((e0[c] - trial.pbit[0]) / 2.f + 0.5f);
+                int q1 = int((e1[c] - trial.pbit[1]) / 2.f + 0.5f);
+                trial.endpoint[0][c] = uint8_t(std::min(std::max(q0, 0), 127));
+                trial.endpoint[1][c] = uint8_t(std::min(std::max(q1, 0), 127));
+            }
+
+            float trialWeights[16];
+            float error = FitBC7Indices(block, trial, trialWeights);
+            if (error < bestError)
+            {
+                bestError = error;
+                best = trial;
+                memcpy(weights, trialWeights, sizeof(trialWeights));
+            }
+        }
+
+        return bestError;
+    }
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t* out) : mOut(out), mBit(0) { memset(out, 0, 16); }
+
+        void Write(uint32_t value, size_t bits)
+        {
+            for (size_t j = 0; j < bits; ++j, ++mBit)
+            {
+                if (value & (1u << j))
+                    mOut[mBit >> 3] |= uint8_t(1u << (mBit & 7));
+            }
+        }
+
+    private:
+        uint8_t* mOut;
+        size_t mBit;
+    };
+
+    void EncodeBC7(const Block& source, uint8_t* out)
+    {
+        Block block;
+        WeightByAlpha(source, block);
+
+        float e0[4], e1[4];
+        AxisEndpoints(block, 4, e0, e1);
+
+        BC7Mode6 best;
+        float weights[16];
+        float error = QuantizeBC7(block, e0, e1, best, weights);
+
+        for (size_t iter = 0; iter < 2 && error > 0.f; ++iter)
+        {
+            float r0[4], r1[4];
+            if (!RefineEndpoints(block, 4, weights, r0, r1))
+                break;
+
+            BC7Mode6 trial;
+            float trialWeights[16];
+            float trialError = QuantizeBC7(block, r0, r1, trial, trialWeights);
+            if (trialError >= error)
+                break;
+
+            best = trial;
+            error = trialError;
+            memcpy(weights, trialWeights, sizeof(weights));
+        }
+
+        // The anchor index is stored without its high bit, so it must be < 8
+        if (best.index[0] & 8)
+        {
+            for (size_t c = 0; c < 4; ++c)
+                std::swap(best.endpoint[0][c], best.endpoint[1][c]);
+            std::swap(best.pbit[0], best.pbit[1]);
+            for (size_t j = 0; j < 16; ++j)
+                best.index[j] = uint8_t(15 - best.index[j]);
+        }
+
+        BitWriter writer(out);
+        writer.Write(1u << 6, 7);
+        for (size_t c = 0; c < 4; ++c)
+        {
+            writer.Write(best.endpoint[0][c], 7);
+            writer.Write(best.endpoint[1][c], 7);
+        }
+        writer.Write(best.pbit[0], 1);
+        writer.Write(best.pbit[1], 1);
+        writer.Write(best.index[0], 3);
+        for (size_t j = 1; j < 16; ++j)
+            writer.Write(best.index[j], 4);
+    }
+
+    void DecodeBC7(const uint8_t* in, uint8_t* rgba)
+    {
+        uint32_t bits[4];
+        for (size_t j = 0; j < 4; ++j)
+            bits[j] = uint32_t(in[j * 4]) | (uint32_t(in[j * 4 + 1]) << 8) | (uint32_t(in[j * 4 + 2]) << 16) | (uint32_t(in[j * 4 + 3]) << 24);
+
+        size_t pos = 7;
+        auto read = [&](size_t count)
+        {
+            uint32_t value = 0;
+            for (size_t j = 0; j < count; ++j, ++pos)
+                value |= ((bits[pos >> 5] >> (pos & 31)) & 1) << j;
+            return value;
+        };
+
+        int e[2][4];
+        for (size_t c = 0; c < 4; ++c)
+        {
+            e[0][c] = int(read(7));
+            e[1][c] = int(read(7));
+        }
+
+        int p0 = int(read(1));
+        int p1 = int(read(1));
+        for (size_t c = 0; c < 4; ++c)
+        {
+            e[0][c] = (e[0][c] << 1) | p0;
+            e[1][c] = (e[1][c] << 1) | p1;
+        }
+
+        for (size_t j = 0; j < 16; ++j)
+        {
+            int w = g_bc7Weights4[read(j ? 4 : 3)];
+            for (size_t c = 0; c < 4; ++c)
+                rgba[j * 4 + c] = uint8_t(((64 - w) * e[0][c] + w * e[1][c] + 32) >> 6);
+        }
+    }
+
+    size_t BlockSize(uint32_t format)
+    {
+        return (format == FORMAT_BC1 || format == FORMAT_BC4) ? 8 : 16;
+    }
+
+    DirectX::BlockCompression::Format GetCodecFormat(uint32_t format)
+    {
+        switch (format)
+        {
+        case FORMAT_BC1: return DirectX::BlockCompression::BC1;
+        case FORMAT_BC3: return DirectX::BlockCompression::BC3;
+        case FORMAT_BC4: return DirectX::BlockCompression::BC4;
+        default: return DirectX::BlockCompression::BC5;
+        }
+    }
+
+    // Compresses one mip level, spreading block rows across the available cores.
+    void Compress(const Image& image, uint32_t format, std::vector<uint8_t>& out)
+    {
+        size_t blocksWide = std::max<size_t>(1, (image.width + 3) / 4);
+        size_t blocksHigh = std::max<size_t>(1, (image.height + 3) / 4);
+        size_t blockSize = BlockSize(format);
+
+        size_t offset = out.size();
+        out.resize(offset + blocksWide * blocksHigh * blockSize);
+
+        if (format != FORMAT_BC7)
+        {
+            DirectX::BlockCompression::Encode(GetCodecFormat(format), image.pixels.data(), image.width, image.height, image.width * 4, &out[offset]);
+            return;
+        }
+
+        DirectX::BlockCompression::Internal::ForEachBlockRow(blocksHigh, 0, [&](size_t by)
+        {
+            uint8_t* dest = &out[offset + by * blocksWide * blockSize];
+            for (size_t bx = 0; bx < blocksWide; ++bx, dest += blockSize)
+            {
+                Block block;
+                LoadBlock(image, bx, by, block);
+                EncodeBC7(block, dest);
+            }
+        });
+    }
+
+    void Premultiply(Image& image)
+    {
+        for (size_t j = 0; j < image.pixels.size(); j += 4)
+        {
+            uint32_t a = image.pixels[j + 3];
+            for (size_t c = 0; c < 3; ++c)
+                image.pixels[j + c] = uint8_t((image.pixels[j + c] * a + 127) / 255);
+        }
+    }
+
+    // Decodes the top level back to RGBA so the result can be compared with the source.
+    void Decompress(const uint8_t* blocks, size_t width, size_t height, uint32_t format, Image& result)
+    {
+        result.width = width;
+        result.height = height;
+        result.pixels.resize(width * height * 4);
+
+        if (format != FORMAT_BC7)
+        {
+            DirectX::BlockCompression::Decode(GetCodecFormat(format), blocks, width, height, result.pixels.data(), width * 4);
+            return;
+        }
+
+        size_t blocksWide = (width + 3) / 4;
+        for (size_t by = 0; by < (height + 3) / 4; ++by)
+        {
+            for (size_t bx = 0; bx < blocksWide; ++bx)
+            {
+                uint8_t texels[64];
+                DecodeBC7(blocks + (by * blocksWide + bx) * 16, texels);
+
+                for (size_t y = 0; y < 4 && by * 4 + y < height; ++y)
+                    memcpy(&result.pixels[((by * 4 + y) * width + bx * 4) * 4], texels + y * 16, std::min<size_t>(4, width - bx * 4) * 4);
+            }
+        }
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // DDS output (see Src/dds.h)
+    const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+    const uint32_t DDS_FOURCC = 0x00000004;
+    const uint32_t DDS_RGBA = 0x00000041;
+
+    const uint32_t DDS_HEADER_FLAGS_TEXTURE = 0x00001007; // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+    const uint32_t DDS_HEADER_FLAGS_MIPMAP = 0x00020000;
+    const uint32_t DDS_HEADER_FLAGS_PITCH = 0x00000008;
+    const uint32_t DDS_HEADER_FLAGS_LINEARSIZE = 0x00080000;
+
+    const uint32_t DDS_SURFACE_FLAGS_TEXTURE = 0x00001000;
+    const uint32_t DDS_SURFACE_FLAGS_MIPMAP = 0x00400008;
+
+    const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+    // DXGI_FORMAT values
+    const uint32_t FORMAT_R8G8B8A8_UNORM = 28;
+    const uint32_t FORMAT_R8G8B8A8_UNORM_SRGB = 29;
+    const uint32_t FORMAT_BC1_UNORM = 71;
+    const uint32_t FORMAT_BC1_UNORM_SRGB = 72;
+    const uint32_t FORMAT_BC3_UNORM = 77;
+    const uint32_t FORMAT_BC3_UNORM_SRGB = 78;
+    const uint32_t FORMAT_BC4_UNORM = 80;
+    const uint32_t FORMAT_BC5_UNORM = 83;
+    const uint32_t FORMAT_BC7_UNORM = 98;
+    const uint32_t FORMAT_BC7_UNORM_SRGB = 99;
+
+    inline uint32_t MakeFourCC(char a, char b, char c, char d)
+    {
+        return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+    }
+
+    uint32_t GetDXGIFormat(uint32_t format, bool srgb)
+    {
+        switch (format)
+        {
+        case FORMAT_BC1: return srgb ? FORMAT_BC1_UNORM_SRGB : FORMAT_BC1_UNORM;
+        case FORMAT_BC3: return srgb ? FORMAT_BC3_UNORM_SRGB : FORMAT_BC3_UNORM;
+        case FORMAT_BC4: return FORMAT_BC4_UNORM;
+        case FORMAT_BC5: return FORMAT_BC5_UNORM;
+        case FORMAT_BC7: return srgb ? FORMAT_BC7_UNORM_SRGB : FORMAT_BC7_UNORM;
+        default: return srgb ? FORMAT_R8G8B8A8_UNORM_SRGB : FORMAT_R8G8B8A8_UNORM;
+        }
+    }
+
+    const char* GetFormatName(uint32_t format, bool srgb)
+    {
+        switch (format)
+        {
+        case FORMAT_BC1: return srgb ? "BC1_UNORM_SRGB" : "BC1_UNORM";
+        case FORMAT_BC3: return srgb ? "BC3_UNORM_SRGB" : "BC3_UNORM";
+        case FORMAT_BC4: return "BC4_UNORM";
+        case FORMAT_BC5: return "BC5_UNORM";
+        case FORMAT_BC7: return srgb ? "BC7_UNORM_SRGB" : "BC7_UNORM";
+        default: return srgb ? "R8G8B8A8_UNORM_SRGB" : "R8G8B8A8_UNORM";
+        }
+    }
+
+    void WriteDDS(const char* fileName, size_t width, size_t height, size_t levels, uint32_t format, bool srgb, const std::vector<uint8_t>& data)
+    {
+        uint32_t header[31] = {};
+        header[0] = 124;                                                    // size
+        header[1] = DDS_HEADER_FLAGS_TEXTURE;                               // flags
+        header[2] = uint32_t(height);
+        header[3] = uint32_t(width);
+        header[6] = uint32_t(levels);                                       // mipMapCount
+        header[26] = DDS_SURFACE_FLAGS_TEXTURE;                             // caps
+
+        if (levels > 1)
+        {
+            header[1] |= DDS_HEADER_FLAGS_MIPMAP;
+            header[26] |= DDS_SURFACE_FLAGS_MIPMAP;
+        }
+
+        if (format == FORMAT_RGBA)
+        {
+            header[1] |= DDS_HEADER_FLAGS_PITCH;
+            header[4] = uint32_t(width * 4);                                // pitchOrLinearSize
+        }
+        else
+        {
+            header[1] |= DDS_HEADER_FLAGS_LINEARSIZE;
+            header[4] = uint32_t(std::max<size_t>(1, (width + 3) / 4) * std::max<size_t>(1, (height + 3) / 4) * BlockSize(format));
+        }
+
+        // DDS_PIXELFORMAT starts at header[18]
+        bool dx10 = srgb || format == FORMAT_BC7;
+        header[18] = 32;
+        if (dx10)
+        {
+            header[19] = DDS_FOURCC;
+            header[20] = MakeFourCC('D', 'X', '1', '0');
+        }
+        else if (format == FORMAT_RGBA)
+        {
+            header[19] = DDS_RGBA;
+            header[21] = 32;
+            header[22] = 0x000000ff;
+            header[23] = 0x0000ff00;
+            header[24] = 0x00ff0000;
+            header[25] = 0xff000000;
+        }
+        else
+        {
+            header[19] = DDS_FOURCC;
+            switch (format)
+            {
+            case FORMAT_BC1: header[20] = MakeFourCC('D', 'X', 'T', '1'); break;
+            case FORMAT_BC3: header[20] = MakeFourCC('D', 'X', 'T', '5'); break;
+            case FORMAT_BC4: header[20] = MakeFourCC('B', 'C', '4', 'U'); break;
+            case FORMAT_BC5: header[20] = MakeFourCC('B', 'C', '5', 'U'); break;
+            }
+        }
+
+        FILE* f = fopen(fileName, "wb");
+        if (!f)
+            throw std::runtime_error("could not create output file");
+
+        bool ok = fwrite(&DDS_MAGIC, sizeof(uint32_t), 1, f) == 1
+               && fwrite(header, sizeof(header), 1, f) == 1;
+
+        if (ok && dx10)
+        {
+            uint32_t ext[5] = { GetDXGIFormat(format, srgb), DDS_DIMENSION_TEXTURE2D, 0, 1, 0 };
+            ok = fwrite(ext, sizeof(ext), 1, f) == 1;
+        }
+
+        if (ok)
+            ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+
+        fclose(f);
+
+        if (!ok)
+            throw std::runtime_error("error writing output file");
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Atlas input and output. Fonts are read from the binary format written by the
+    // MakeSpriteFont utility (see Src/SpriteFont.cpp).
+    const uint32_t FORMAT_BC2_UNORM = 74;
+    const uint32_t FORMAT_B4G4R4A4_UNORM = 115;
+
+    // Entries are padded by extruding their edges, and placed on multiples of the padding
+    // so that the first AtlasMaxMips levels keep at least one texel between neighbours.
+    const size_t AtlasPadding = 8;
+    const size_t AtlasMaxMips = 4;
+    const size_t AtlasMaxSize = 16384;
+
+    struct Glyph
+    {
+        uint32_t character;
+        int32_t left;
+        int32_t top;
+        int32_t right;
+        int32_t bottom;
+        float xOffset;
+        float yOffset;
+        float xAdvance;
+    };
+
+    static_assert(sizeof(Glyph) == 32, "Glyph must match SpriteFont::Glyph");
+
+    struct AtlasEntry
+    {
+        std::string name;
+        Image image;
+        size_t x;
+        size_t y;
+
+        // Only used by fonts
+        std::vector<Glyph> glyphs;
+        float lineSpacing;
+        uint32_t defaultCharacter;
+
+        AtlasEntry() : x(0), y(0), lineSpacing(0), defaultCharacter(0) {}
+    };
+
+    class ByteReader
+    {
+    public:
+        explicit ByteReader(const std::vector<uint8_t>& file) : mPos(file.data()), mEnd(file.data() + file.size()) {}
+
+        const uint8_t* ReadBytes(size_t count)
+        {
+            if (count > size_t(mEnd - mPos))
+                throw std::runtime_error("truncated .spritefont file");
+
+            auto result = mPos;
+            mPos += count;
+            return result;
+        }
+
+        template<typename T> T Read()
+        {
+            T value;
+            memcpy(&value, ReadBytes(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+    private:
+        const uint8_t* mPos;
+        const uint8_t* mEnd;
+    };
+
+    void ReadSpriteFont(const std::vector<uint8_t>& file, AtlasEntry& entry)
+    {
+        static const char spriteFontMagic[] = "DXTKfont";
+
+        ByteReader reader(file);
+        if (memcmp(reader.ReadBytes(sizeof(spriteFontMagic) - 1), spriteFontMagic, sizeof(spriteFontMagic) - 1) != 0)
+            throw std::runtime_error("not a MakeSpriteFont .spritefont file");
+
+        uint32_t glyphCount = reader.Read<uint32_t>();
+        auto glyphs = reader.ReadBytes(size_t(glyphCount) * sizeof(Glyph));
+        entry.glyphs.resize(glyphCount);
+        if (glyphCount)
+            memcpy(entry.glyphs.data(), glyphs, size_t(glyphCount) * sizeof(Glyph));
+
+        entry.lineSpacing = reader.Read<float>();
+        entry.defaultCharacter = reader.Read<uint32_t>();
+
+        uint32_t width = reader.Read<uint32_t>();
+        uint32_t height = reader.Read<uint32_t>();
+        uint32_t format = reader.Read<uint32_t>();
+        uint32_t stride = reader.Read<uint32_t>();
+        uint32_t rows = reader.Read<uint32_t>();
+        auto data = reader.ReadBytes(size_t(stride) * rows);
+
+        Image& image = entry.image;
+        image.width = width;
+        image.height = height;
+        image.pixels.resize(size_t(width) * height * 4);
+
+        switch (format)
+        {
+        case FORMAT_R8G8B8A8_UNORM:
+            if (stride < width * 4 || rows < height)
+                throw std::runtime_error("invalid .spritefont texture");
+
+            for (size_t y = 0; y < height; ++y)
+                memcpy(&image.pixels[y * width * 4], data + y * stride, width * 4);
+            break;
+
+        case FORMAT_B4G4R4A4_UNORM:
+            if (stride < width * 2 || rows < height)
+                throw std::runtime_error("invalid .spritefont texture");
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                for (size_t x = 0; x < width; ++x)
+                {
+                    uint32_t v = uint32_t(data[y * stride + x * 2]) | (uint32_t(data[y * stride + x * 2 + 1]) << 8);
+                    uint8_t* dest = &image.pixels[(y * width + x) * 4];
+                    dest[0] = uint8_t(((v >> 8) & 0xf) * 17);
+                    dest[1] = uint8_t(((v >> 4) & 0xf) * 17);
+                    dest[2] = uint8_t((v & 0xf) * 17);
+                    dest[3] = uint8_t((v >> 12) * 17);
+                }
+            }
+            break;
+
+        case FORMAT_BC2_UNORM:
+        {
+            size_t blocksWide = (width + 3) / 4;
+            if (stride < blocksWide * 16 || rows < (height + 3) / 4)
+                throw std::runtime_error("invalid .spritefont texture");
+
+            for (size_t by = 0; by < (height + 3) / 4; ++by)
+            {
+                for (size_t bx = 0; bx < blocksWide; ++bx)
+                {
+                    const uint8_t* block = data + by * stride + bx * 16;
+
+                    // BC2 is explicit 4-bit alpha followed by a four color BC1 block
+                    uint8_t texels[64];
+                    DirectX::BlockCompression::DecodeBC1(block + 8, texels, true);
+                    for (size_t j = 0; j < 16; ++j)
+                        texels[j * 4 + 3] = uint8_t(((block[j / 2] >> ((j & 1) * 4)) & 0xf) * 17);
+
+                    for (size_t y = 0; y < 4 && by * 4 + y < height; ++y)
+                        memcpy(&image.pixels[((by * 4 + y) * width + bx * 4) * 4], texels + y * 16, std::min<size_t>(4, width - bx * 4) * 4);
+                }
+            }
+            break;
+        }
+
+        default:
+            throw std::runtime_error("unsupported .spritefont texture format");
+        }
+    }
+
+    std::string BaseName(const std::string& path)
+    {
+        size_t slash = path.find_last_of("/\\");
+        std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+
+        size_t dot = name.find_last_of('.');
+        if (dot != std::string::npos)
+            name.resize(dot);
+
+        return name;
+    }
+
+    bool IsSpriteFont(const std::string& path)
+    {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos)
+            return false;
+
+        std::string ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext == "spritefont";
+    }
+
+    // Loads every input and packs them into a single page, returning the content efficiency.
+    double BuildAtlas(const std::vector<std::string>& inputs, Image& page, bool& hasAlpha, std::vector<AtlasEntry>& entries)
+    {
+        entries.resize(inputs.size());
+        hasAlpha = false;
+
+        std::vector<size_t> widths;
+        std::vector<size_t> heights;
+        for (size_t j = 0; j < inputs.size(); ++j)
+        {
+            auto file = ReadEntireFile(inputs[j].c_str());
+
+            AtlasEntry& entry = entries[j];
+            entry.name = BaseName(inputs[j]);
+
+            if (IsSpriteFont(inputs[j]))
+            {
+                ReadSpriteFont(file, entry);
+                hasAlpha = true;
+            }
+            else
+            {
+                bool alpha;
+                DecodePNG(file, entry.image, alpha);
+                hasAlpha |= alpha;
+            }
+
+            widths.push_back(entry.image.width);
+            heights.push_back(entry.image.height);
+        }
+
+        DirectX::AtlasPacking::PackResult packing;
+        if (!DirectX::AtlasPacking::PackRects(widths, heights, AtlasPadding, AtlasPadding, AtlasMaxSize, packing))
+            throw std::runtime_error("inputs do not fit in a single atlas page");
+
+        page.width = packing.pageWidth;
+        page.height = packing.pageHeight;
+        page.pixels.assign(page.width * page.height * 4, 0);
+
+        for (size_t j = 0; j < entries.size(); ++j)
+        {
+            AtlasEntry& entry = entries[j];
+            entry.x = packing.x[j];
+            entry.y = packing.y[j];
+
+            // Copy the image along with its padding, clamping to its edges
+            const Image& image = entry.image;
+            for (size_t py = 0; py < image.height + 2 * AtlasPadding; ++py)
+            {
+                size_t sy = std::min(std::max(py, AtlasPadding) - AtlasPadding, image.height - 1);
+                uint8_t* dest = &page.pixels[((entry.y - AtlasPadding + py) * page.width + entry.x - AtlasPadding) * 4];
+
+                for (size_t px = 0; px < image.width + 2 * AtlasPadding; ++px, dest += 4)
+                {
+                    size_t sx = std::min(std::max(px, AtlasPadding) - AtlasPadding, image.width - 1);
+                    memcpy(dest, &image.pixels[(sy * image.width + sx) * 4], 4);
+                }
+            }
+        }
+
+        return packing.efficiency;
+    }
+
+    // Writes the entry rectangles (and font glyphs remapped into the page) for TextureAtlas.
+    void WriteAtlas(const char* fileName, const Image& page, const std::vector<AtlasEntry>& entries)
+    {
+        static const char atlasMagic[] = "DXTKatlas";
+
+        std::vector<uint8_t> data(atlasMagic, atlasMagic + sizeof(atlasMagic) - 1);
+
+        auto write = [&](const void* value, size_t size)
+        {
+            auto bytes = static_cast<const uint8_t*>(value);
+            data.insert(data.end(), bytes, bytes + size);
+        };
+
+        uint32_t header[3] = { uint32_t(page.width), uint32_t(page.height), uint32_t(entries.size()) };
+        write(header, sizeof(header));
+
+        for (auto& entry : entries)
+        {
+            uint32_t nameLength = uint32_t(entry.name.size());
+            write(&nameLength, sizeof(nameLength));
+            write(entry.name.data(), entry.name.size());
+
+            int32_t rect[4] = { int32_t(entry.x), int32_t(entry.y), int32_t(entry.x + entry.image.width), int32_t(entry.y + entry.image.height) };
+            write(rect, sizeof(rect));
+
+            uint32_t glyphCount = uint32_t(entry.glyphs.size());
+            write(&glyphCount, sizeof(glyphCount));
+
+            if (glyphCount)
+            {
+                write(&entry.lineSpacing, sizeof(entry.lineSpacing));
+                write(&entry.defaultCharacter, sizeof(entry.defaultCharacter));
+
+                for (auto glyph : entry.glyphs)
+                {
+                    glyph.left += rect[0];
+                    glyph.right += rect[0];
+                    glyph.top += rect[1];
+                    glyph.bottom += rect[1];
+                    write(&glyph, sizeof(glyph));
+                }
+            }
+        }
+
+        FILE* f = fopen(fileName, "wb");
+        if (!f)
+            throw std::runtime_error("could not create atlas file");
+
+        bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+
+        fclose(f);
+
+        if (!ok)
+            throw std::runtime_error("error writing atlas file");
+    }
+
+
+    //----------------------------------------------------------------------------------
+    uint32_t LookupByName(const char* pName, const SValue* pArray)
+    {
+        while (pArray->pName)
+        {
+            std::string a(pName), b(pArray->pName);
+            std::transform(a.begin(), a.end(), a.begin(), ::tolower);
+            std::transform(b.begin(), b.end(), b.begin(), ::tolower);
+            if (a == b)
+                return pArray->dwValue;
+
+            pArray++;
+        }
+
+        return 0;
+    }
+
+    bool FileExists(const char* fileName)
+    {
+        FILE* f = fopen(fileName, "rb");
+        if (f)
+        {
+            fclose(f);
+            return true;
+        }
+
+        return false;
+    }
+
+    std::string OutputPath(const std::string& input, const char* outputDir)
+    {
+        size_t slash = input.find_last_of("/\\");
+        std::string name = (slash == std::string::npos) ? input : input.substr(slash + 1);
+
+        size_t dot = name.find_last_of('.');
+        if (dot != std::string::npos)
+            name.resize(dot);
+        name += ".dds";
+
+        if (outputDir && *outputDir)
+        {
+            std::string dir(outputDir);
+            if (dir.back() != '/' && dir.back() != '\\')
+                dir += '/';
+            return dir + name;
+        }
+
+        return (slash == std::string::npos) ? name : (input.substr(0, slash + 1) + name);
+    }
+
+    double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void PrintLogo()
+    {
+        printf("Microsoft (R) DDS Texture Conversion Tool\n");
+        printf("Copyright (C) Microsoft Corp. All rights reserved.\n");
+#ifdef _DEBUG
+        printf("*** Debug build ***\n");
+#endif
+        printf("\n");
+    }
+
+    void PrintUsage()
+    {
+        PrintLogo();
+
+        printf("Usage: ddstool <options> <png-files>\n");
+        printf("\n");
+        printf("   -o <directory>      output directory (defaults to the input file's)\n");
+        printf("   -f <format>         BC1, BC3, BC4, BC5, BC7, RGBA or AUTO (the default: BC1 for\n");
+        printf("                       opaque images, BC3 for images with alpha)\n");
+        printf("   -m <levels>         number of mip levels, 0 for a full chain (default)\n");
+        printf("   -srgb               write sRGB formats\n");
+        printf("   -nogamma            filter mips in gamma space rather than linear light\n");
+        printf("   -if <filter>        mip filter, BOX (the default) or KAISER\n");
+        printf("   -n                  do not overwrite output\n");
+        printf("   -psnr               report the PSNR and encode rate of the top level\n");
+        printf("   -atlas <name>       pack every input (PNG or .spritefont) into <name>.dds, with\n");
+        printf("                       the entry rectangles and font glyphs in <name>.atlas\n");
+        printf("   -nologo             suppress copyright message\n");
+        printf("\n");
+        printf("   Block-compressed formats need a top level that is a multiple of 4 texels;\n");
+        printf("   other images are written as RGBA.\n");
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    // Parameters and defaults
+    const char* outputDir = nullptr;
+    uint32_t format = FORMAT_AUTO;
+    uint32_t filter = FILTER_BOX;
+    size_t mipLevels = 0;
+    const char* atlasName = nullptr;
+
+    // Process command line
+    uint32_t dwOptions = 0;
+    std::vector<std::string> conversion;
+
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        char* pArg = argv[iArg];
+
+        if (('-' == pArg[0]) || ('/' == pArg[0]))
+        {
+            pArg++;
+            char* pValue;
+
+            for (pValue = pArg; *pValue && (':' != *pValue); pValue++);
+
+            if (*pValue)
+                *pValue++ = 0;
+
+            uint32_t dwOption = LookupByName(pArg, g_pOptions);
+
+            if (!dwOption || (dwOptions & (1 << dwOption)))
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            dwOptions |= 1 << dwOption;
+
+            // Handle options with additional value parameter
+            switch (dwOption)
+            {
+            case OPT_OUTPUTDIR:
+            case OPT_FORMAT:
+            case OPT_FILTER:
+            case OPT_MIPLEVELS:
+            case OPT_ATLAS:
+                if (!*pValue)
+                {
+                    if ((iArg + 1 >= argc))
+                    {
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    iArg++;
+                    pValue = argv[iArg];
+                }
+                break;
+            }
+
+            switch (dwOption)
+            {
+            case OPT_OUTPUTDIR:
+                outputDir = pValue;
+                break;
+
+            case OPT_FORMAT:
+                format = LookupByName(pValue, g_pFormats);
+                if (!format)
+                {
+                    printf("Invalid value specified with -f (%s)\n", pValue);
+                    return 1;
+                }
+                break;
+
+            case OPT_FILTER:
+                filter = LookupByName(pValue, g_pFilters);
+                if (!filter)
+                {
+                    printf("Invalid value specified with -if (%s)\n", pValue);
+                    return 1;
+                }
+                break;
+
+            case OPT_MIPLEVELS:
+                mipLevels = size_t(strtoul(pValue, nullptr, 10));
+                break;
+
+            case OPT_ATLAS:
+                atlasName = pValue;
+                break;
+            }
+        }
+        else
+        {
+            conversion.push_back(pArg);
+        }
+    }
+
+    if (conversion.empty())
+    {
+        PrintUsage();
+        return 0;
+    }
+
+    if (~dwOptions & (1 << OPT_NOLOGO))
+        PrintLogo();
+
+
+    bool srgb = (dwOptions & (1 << OPT_SRGB)) != 0;
+
+    unsigned mipFlags = 0;
+    if (!(dwOptions & (1 << OPT_NOGAMMA)))
+        mipFlags |= DirectX::MipGeneration::MIP_SRGB;
+    if (filter == FILTER_KAISER)
+        mipFlags |= DirectX::MipGeneration::MIP_KAISER;
+    bool psnr = (dwOptions & (1 << OPT_PSNR)) != 0;
+
+    // In atlas mode all the inputs become a single output
+    std::vector<std::string> atlasInputs;
+    if (atlasName)
+    {
+        atlasInputs.swap(conversion);
+        conversion.push_back(atlasName);
+
+        if (mipFlags & DirectX::MipGeneration::MIP_KAISER)
+        {
+            // The wider filter would reach past the padding between entries
+            printf("WARNING: atlas mips use the BOX filter\n");
+            mipFlags &= ~unsigned(DirectX::MipGeneration::MIP_KAISER);
+        }
+    }
+
+    size_t totalBefore = 0;
+    size_t totalAfter = 0;
+    double totalDecode = 0.0;
+    int result = 0;
+
+    for (auto it = conversion.cbegin(); it != conversion.cend(); ++it)
+    {
+        std::string outputFile = OutputPath(*it, outputDir);
+
+        if (atlasName)
+        {
+            printf("packing %zu images into %s", atlasInputs.size(), it->c_str());
+        }
+        else
+        {
+            printf("reading %s", it->c_str());
+        }
+        fflush(stdout);
+
+        try
+        {
+            if ((dwOptions & (1 << OPT_NOOVERWRITE)) && FileExists(outputFile.c_str()))
+            {
+                printf("\nERROR: Output file %s already exists!\n", outputFile.c_str());
+                result = 1;
+                continue;
+            }
+
+            std::vector<uint8_t> file;
+            if (!atlasName)
+            {
+                file = ReadEntireFile(it->c_str());
+            }
+
+            auto start = std::chrono::high_resolution_clock::now();
+
+            Image image;
+            bool hasAlpha;
+            std::vector<AtlasEntry> entries;
+            double efficiency = 0;
+            if (atlasName)
+            {
+                efficiency = BuildAtlas(atlasInputs, image, hasAlpha, entries);
+            }
+            else
+            {
+                DecodePNG(file, image, hasAlpha);
+            }
+
+            double decodeTime = Milliseconds(start);
+
+            uint32_t fileFormat = format;
+            if (fileFormat == FORMAT_AUTO)
+            {
+                fileFormat = hasAlpha ? FORMAT_BC3 : FORMAT_BC1;
+            }
+
+            bool fallback = false;
+            if (fileFormat != FORMAT_RGBA && ((image.width & 3) || (image.height & 3)))
+            {
+                fileFormat = FORMAT_RGBA;
+                fallback = true;
+            }
+
+            size_t levels = DirectX::MipGeneration::CountMips(image.width, image.height);
+            if (mipLevels)
+                levels = std::min(levels, mipLevels);
+            if (atlasName)
+                levels = std::min(levels, AtlasMaxMips);
+
+            printf(" (%zux%zu %s)\n", image.width, image.height, hasAlpha ? "RGBA" : "RGB");
+
+            if (fallback)
+            {
+                printf("WARNING: %zux%zu is not a multiple of 4, writing RGBA instead\n", image.width, image.height);
+            }
+
+            start = std::chrono::high_resolution_clock::now();
+
+            std::vector<Image> mips;
+            GenerateMips(image, levels, mipFlags, mips);
+
+            double mipTime = Milliseconds(start);
+
+            start = std::chrono::high_resolution_clock::now();
+
+            std::vector<uint8_t> data;
+            double topTime = 0;
+            for (auto& mip : mips)
+            {
+                if (fileFormat == FORMAT_RGBA)
+                {
+                    data.insert(data.end(), mip.pixels.begin(), mip.pixels.end());
+                }
+                else
+                {
+                    Compress(mip, fileFormat, data);
+                }
+
+                if (&mip == &mips.front())
+                    topTime = Milliseconds(start);
+            }
+
+            double encodeTime = Milliseconds(start);
+
+            WriteDDS(outputFile.c_str(), image.width, image.height, levels, fileFormat, srgb, data);
+
+            // The WIC loader creates a single 32bpp level when it has no device context
+            size_t before = image.width * image.height * 4;
+            size_t after = data.size();
+
+            totalBefore += before;
+            totalAfter += after;
+            totalDecode += decodeTime;
+
+            printf("writing %s (%s, %zu mip levels)\n", outputFile.c_str(), GetFormatName(fileFormat, srgb), levels);
+            printf("    PNG decode %.1f ms, mips %.1f ms, encode %.1f ms\n", decodeTime, mipTime, encodeTime);
+            printf("    VRAM %zu KB as decoded PNG (1 level) -> %zu KB as DDS (%zu levels), %.0f%% of the original\n",
+                   before / 1024, after / 1024, levels, 100.0 * double(after) / double(before));
+
+            if (atlasName)
+            {
+                std::string atlasFile = outputFile.substr(0, outputFile.size() - 4) + ".atlas";
+                WriteAtlas(atlasFile.c_str(), image, entries);
+
+                printf("writing %s (%zu entries, %.1f%% of the page is content)\n", atlasFile.c_str(), entries.size(), 100.0 * efficiency);
+                for (auto& entry : entries)
+                {
+                    printf("    %s: %zux%zu at (%zu, %zu)%s\n", entry.name.c_str(), entry.image.width, entry.image.height,
+                           entry.x, entry.y, entry.glyphs.empty() ? "" : " (font)");
+                }
+            }
+
+            if (psnr && fileFormat != FORMAT_RGBA)
+            {
+                // Compare against the same channels the format stores
+                size_t channels = (fileFormat == FORMAT_BC4) ? 1 : (fileFormat == FORMAT_BC5) ? 2 : (fileFormat == FORMAT_BC1) ? 3 : 4;
+
+                Image decoded;
+                Decompress(data.data(), image.width, image.height, fileFormat, decoded);
+
+                Image reference = image;
+                if (hasAlpha && channels > 2)
+                {
+                    // Colors under transparent texels are never seen, so measure what gets blended
+                    Premultiply(reference);
+                    Premultiply(decoded);
+                }
+
+                double value = DirectX::BlockCompression::ComputePSNR(reference.pixels.data(), decoded.pixels.data(),
+                                                                      image.width, image.height, image.width * 4, channels);
+
+                printf("    PSNR %.2f dB over %zu channel(s), top level encoded at %.1f MP/s\n",
+                       value, channels, double(image.width * image.height) / (topTime * 1000.0));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            printf("\nERROR: %s\n", e.what());
+            result = 1;
+        }
+    }
+
+    if (totalBefore)
+    {
+        printf("\ntotal: %.1f ms of PNG decoding moved offline, VRAM %zu KB -> %zu KB (%.0f%% of the original)\n",
+               totalDecode, totalBefore / 1024, totalAfter / 1024, 100.0 * double(totalAfter) / double(totalBefore));
+    }
+
+    return result;
+}
@@ -0,0 +1,74 @@
+//--------------------------------------------------------------------------------------
+// File: DDSTextureStreamer.h
+//
+// Progressive loading of DDS textures: only the header and the low resolution mips are
+// read when a texture is created, and the larger mips stream in later under a per-frame
+// byte budget, with sampling clamped to the mips that have arrived.
+//
+// Warning: not thread-safe, as both creating textures and streaming use the d3dContext.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+#include <d3d11_x.h>
+#else
+#include <d3d11_1.h>
+#endif
+
+#include <memory>
+
+#include <stdint.h>
+
+
+namespace DirectX
+{
+    class DDSTextureStreamer
+    {
+    public:
+        explicit DDSTextureStreamer(_In_ ID3D11Device* d3dDevice);
+        DDSTextureStreamer(DDSTextureStreamer&& moveFrom);
+        DDSTextureStreamer& operator= (DDSTextureStreamer&& moveFrom);
+
+        DDSTextureStreamer(DDSTextureStreamer const&) = delete;
+        DDSTextureStreamer& operator= (DDSTextureStreamer const&) = delete;
+
+        virtual ~DDSTextureStreamer();
+
+        // Creates a 2D texture (or texture array) with its full mip chain, uploading only the
+        // mips no larger than tailSize texels. Feature Level 9.x devices can't clamp sampling
+        // to the resident mips, so there the whole chain is loaded immediately.
+        HRESULT __cdecl CreateTexture(
+            _In_ ID3D11DeviceContext* d3dContext,
+            _In_z_ const wchar_t* szFileName,
+            _Outptr_opt_ ID3D11Resource** texture,
+            _Outptr_opt_ ID3D11ShaderResourceView** textureView,
+            _In_ size_t tailSize = 64,
+            _In_ bool forceSRGB = false);
+
+        // Uploads pending mips, coarsest first across all textures, until the budget is spent
+        // (always at least one mip). Returns the number of textures still streaming.
+        size_t __cdecl Update(_In_ ID3D11DeviceContext* d3dContext);
+
+        // Bytes of mip data uploaded per Update call (defaults to 1 MB).
+        void __cdecl SetUploadBudget(size_t bytesPerUpdate);
+
+        // Stops streaming and closes the files.
+        void __cdecl Clear();
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
+}
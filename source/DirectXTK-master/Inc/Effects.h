@@ -20,11 +20,14 @@
 #endif
 
 #include <DirectXMath.h>
+#include <functional>
 #include <memory>
 
 
 namespace DirectX
 {
+    class TextureCache;
+
     //----------------------------------------------------------------------------------
     // Abstract interface representing any effect which can be applied onto a D3D device context.
     class IEffect
@@ -599,6 +602,16 @@ namespace DirectX
             EffectInfo() { memset( this, 0, sizeof(EffectInfo) ); };
         };
 
+        // Cache lookup counters; contentions counts lookups that had to wait for another thread.
+        struct CacheStatistics
+        {
+            size_t  effectHits;
+            size_t  effectMisses;
+            size_t  textureHits;
+            size_t  textureMisses;
+            size_t  contentions;
+        };
+
         virtual std::shared_ptr<IEffect> __cdecl CreateEffect( _In_ const EffectInfo& info, _In_opt_ ID3D11DeviceContext* deviceContext ) = 0;
 
         virtual void __cdecl CreateTexture( _In_z_ const wchar_t* name, _In_opt_ ID3D11DeviceContext* deviceContext, _Outptr_ ID3D11ShaderResourceView** textureView ) = 0;
@@ -632,6 +645,21 @@ namespace DirectX
 
         void __cdecl SetDirectory( _In_opt_z_ const wchar_t* path );
 
+        // Textures are loaded through the given cache, so decoded images outlive ReleaseCache and device loss.
+        void __cdecl SetTextureCache( _In_opt_ std::shared_ptr<TextureCache> cache );
+
+        CacheStatistics __cdecl GetCacheStatistics() const;
+        void __cdecl ResetCacheStatistics();
+
+        // Lazy texture loading: effects start with a 1x1 placeholder while texture files are read on a
+        // background thread; ProcessTextureLoads creates them (within the per-call byte budget) and
+        // returns the number of textures still pending. Lazily loaded textures are created from the file data
+        // directly, not through CreateTexture, so an override of CreateTexture only sees non-lazy loads.
+        void __cdecl EnableLazyTextureLoading( bool enabled );
+        void __cdecl SetTextureUploadBudget( size_t bytesPerFrame );
+        void __cdecl SetTextureLoadedCallback( _In_opt_ std::function<void __cdecl(const wchar_t* name, HRESULT hr)> callback );
+        size_t __cdecl ProcessTextureLoads( _In_opt_ ID3D11DeviceContext* deviceContext );
+
     private:
         // Private implementation.
         class Impl;
@@ -681,6 +709,10 @@ namespace DirectX
 
         void __cdecl SetDirectory( _In_opt_z_ const wchar_t* path );
 
+        // Shader cache hits and misses are counted with the textures.
+        CacheStatistics __cdecl GetCacheStatistics() const;
+        void __cdecl ResetCacheStatistics();
+
     private:
         // Private implementation.
         class Impl;
@@ -30,7 +30,7 @@
 
 #include <stdint.h>
 
-#include <wrl\client.h>
+#include <wrl/client.h>
 
 
 namespace DirectX
@@ -39,6 +39,7 @@ namespace DirectX
     class IEffectFactory;
     class CommonStates;
     class ModelMesh;
+    class ModelSkeleton;
 
     //----------------------------------------------------------------------------------
     // Each mesh part is a submesh with a single effect
@@ -89,6 +90,7 @@ namespace DirectX
         std::wstring                name;
         bool                        ccw;
         bool                        pmalpha;
+        std::shared_ptr<ModelSkeleton> skeleton;    // Bones and animation clips (CMO skinned meshes only)
 
         typedef std::vector<std::shared_ptr<ModelMesh>> Collection;
 
@@ -98,6 +100,9 @@ namespace DirectX
         // Draw the mesh
         void XM_CALLCONV Draw( _In_ ID3D11DeviceContext* deviceContext, FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
                                bool alpha = false, _In_opt_ std::function<void __cdecl()> setCustomState = nullptr ) const;
+
+        // Test the mesh bounds, transformed by worldView, against a view space frustum
+        bool XM_CALLCONV IsVisible( FXMMATRIX worldView, const BoundingFrustum& viewFrustum ) const;
     };
 
 
@@ -106,11 +111,19 @@ namespace DirectX
     class Model
     {
     public:
+        Model();
         virtual ~Model();
 
         ModelMesh::Collection   meshes;
         std::wstring            name;
 
+        // Number of meshes drawn and culled by Draw since the last ResetCullingStats
+        struct CullingStats
+        {
+            uint32_t meshesDrawn;
+            uint32_t meshesCulled;
+        };
+
         // Draw all the meshes in the model
         void XM_CALLCONV Draw( _In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
                                bool wireframe = false, _In_opt_ std::function<void __cdecl()> setCustomState = nullptr ) const;
@@ -118,6 +131,16 @@ namespace DirectX
         // Notify model that effects, parts list, or mesh list has changed
         void __cdecl Modified() { mEffectCache.clear(); }
 
+        // Per-mesh view frustum culling in Draw (enabled by default)
+        void __cdecl SetFrustumCulling( bool enabled ) { mFrustumCulling = enabled; }
+        bool __cdecl GetFrustumCulling() const { return mFrustumCulling; }
+
+        const CullingStats& __cdecl GetCullingStats() const { return mCullingStats; }
+        void __cdecl ResetCullingStats() { mCullingStats.meshesDrawn = mCullingStats.meshesCulled = 0; }
+
+        // Builds a view space frustum from a left- or right-handed perspective projection
+        static void XM_CALLCONV CreateViewFrustum( _Out_ BoundingFrustum& viewFrustum, FXMMATRIX projection );
+
         // Update all effects used by the model
         void __cdecl UpdateEffects( _In_ std::function<void __cdecl(IEffect*)> setEffect );
 
@@ -140,6 +163,8 @@ namespace DirectX
                                                              _In_opt_ std::shared_ptr<IEffect> ieffect = nullptr, bool ccw = false, bool pmalpha = false );
 
     private:
-        std::set<IEffect*>  mEffectCache;
+        std::set<IEffect*>      mEffectCache;
+        bool                    mFrustumCulling;
+        mutable CullingStats    mCullingStats;
     };
  }
\ No newline at end of file
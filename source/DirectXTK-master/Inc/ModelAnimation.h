@@ -0,0 +1,117 @@
+//--------------------------------------------------------------------------------------
+// File: ModelAnimation.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+
+namespace DirectX
+{
+    class IEffectSkinning;
+
+    //----------------------------------------------------------------------------------
+    // A single bone; parents always precede their children in a skeleton
+    struct ModelBone
+    {
+        int32_t         parentIndex;
+        XMFLOAT4X4      invBindPose;
+        XMFLOAT4X4      localTransform;
+        std::wstring    name;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // Keyframes of an animation clip, stored as one track per bone with the key
+    // components held in separate (structure of arrays) streams
+    class AnimationClip
+    {
+    public:
+        AnimationClip();
+
+        struct Track
+        {
+            uint32_t firstKey;
+            uint32_t keyCount;      // A track with no keys holds the bone at its rest pose
+        };
+
+        std::wstring            name;
+        float                   startTime;
+        float                   endTime;
+        std::vector<Track>      tracks;
+        std::vector<float>      keyTimes;
+        std::vector<XMFLOAT4>   keyRotations;
+        std::vector<XMFLOAT3>   keyTranslations;
+        std::vector<XMFLOAT3>   keyScales;
+
+        float __cdecl GetDuration() const { return endTime - startTime; }
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // The bones and animation clips of a skinned mesh
+    class ModelSkeleton
+    {
+    public:
+        std::vector<ModelBone>      bones;
+        std::vector<AnimationClip>  clips;
+
+        // Returns the clip index, or -1 if there is no clip with that name
+        int __cdecl FindClip( _In_z_ const wchar_t* clipName ) const;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // Plays back (and cross-fades between) the clips of a skeleton, producing the
+    // bone palette for IEffectSkinning::SetBoneTransforms
+    class AnimationPlayer
+    {
+    public:
+        explicit AnimationPlayer( _In_ std::shared_ptr<const ModelSkeleton> skeleton );
+        AnimationPlayer(AnimationPlayer&& moveFrom);
+        AnimationPlayer& operator= (AnimationPlayer&& moveFrom);
+
+        AnimationPlayer(AnimationPlayer const&) = delete;
+        AnimationPlayer& operator= (AnimationPlayer const&) = delete;
+
+        virtual ~AnimationPlayer();
+
+        // Start a clip, blending out of the current one over fadeDuration seconds
+        void __cdecl Play( size_t clipIndex, bool loop = true, float fadeDuration = 0.f );
+
+        // Advance playback and rebuild the bone palette
+        void __cdecl Update( float elapsedSeconds );
+
+        float __cdecl GetTime() const;
+        bool __cdecl IsPlaying() const;
+
+        // Bone palette (inverse bind pose * animated model space transform per bone)
+        XMMATRIX const* __cdecl GetBoneTransforms() const;
+        size_t __cdecl GetBoneCount() const;
+
+        // Upload the palette to an effect, clamped to the effect's bone limit
+        void __cdecl SetBoneTransforms( _In_ IEffectSkinning* effect ) const;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
+}
@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------------------
+// File: RenderQueue.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+#include <d3d11_x.h>
+#else
+#include <d3d11_1.h>
+#endif
+
+#include <DirectXMath.h>
+
+#include <functional>
+#include <memory>
+
+#include <stdint.h>
+
+
+namespace DirectX
+{
+    class CommonStates;
+    class Model;
+
+    // Collects the mesh parts of many models, sorts them by pipeline state and
+    // submits them with redundant state changes filtered out.
+    class RenderQueue
+    {
+    public:
+        RenderQueue();
+        RenderQueue(RenderQueue&& moveFrom);
+        RenderQueue& operator= (RenderQueue&& moveFrom);
+
+        RenderQueue(RenderQueue const&) = delete;
+        RenderQueue& operator= (RenderQueue const&) = delete;
+
+        virtual ~RenderQueue();
+
+        // Counters for the most recent End, for comparing against a recording context.
+        struct Statistics
+        {
+            uint32_t partsQueued;
+            uint32_t meshesCulled;
+            uint32_t drawCalls;
+            uint32_t batches;
+            uint32_t effectApplies;
+            uint32_t blendStateChanges;
+            uint32_t depthStencilStateChanges;
+            uint32_t rasterizerStateChanges;
+            uint32_t inputLayoutChanges;
+            uint32_t vertexBufferChanges;
+            uint32_t indexBufferChanges;
+            uint32_t topologyChanges;
+            uint32_t customStateCalls;
+
+            uint32_t __cdecl StateChanges() const
+            {
+                return blendStateChanges + depthStencilStateChanges + rasterizerStateChanges
+                     + inputLayoutChanges + vertexBufferChanges + indexBufferChanges + topologyChanges;
+            }
+        };
+
+        // Begin/End a frame of queued model drawing.
+        void XM_CALLCONV Begin(FXMMATRIX view, CXMMATRIX projection);
+        void __cdecl End(_In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, bool wireframe = false);
+
+        // Queue every visible mesh part of the model. As in Model::Draw, setCustomState runs before
+        // each of the model's parts is drawn; those parts are sorted after the other opaque parts,
+        // and every state is set again after them, since the hook may have changed any of it.
+        void XM_CALLCONV Enqueue(const Model& model, FXMMATRIX world, _In_opt_ std::function<void __cdecl()> setCustomState = nullptr);
+
+        const Statistics& __cdecl GetStatistics() const;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
+}
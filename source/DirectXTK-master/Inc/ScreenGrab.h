@@ -30,6 +30,7 @@
 #include <ocidl.h>
 
 #include <functional>
+#include <memory>
 #include <stdint.h>
 
 
@@ -47,4 +48,66 @@ namespace DirectX
         _In_z_ const wchar_t* fileName,
         _In_opt_ const GUID* targetFormat = nullptr,
         _In_opt_ std::function<void __cdecl(IPropertyBag2*)> setCustomProps = nullptr);
+
+    // Captures without stalling the frame: copies go into a ring of staging textures that are
+    // read back frameLatency frames later, and the pixels are encoded on worker threads.
+    class ScreenGrabQueue
+    {
+    public:
+        // A workerCount of 0 picks one encoder thread per core, up to four.
+        explicit ScreenGrabQueue(size_t frameLatency = 3, size_t workerCount = 0);
+
+        ScreenGrabQueue(ScreenGrabQueue&& moveFrom);
+        ScreenGrabQueue& operator= (ScreenGrabQueue&& moveFrom);
+
+        ScreenGrabQueue(ScreenGrabQueue const&) = delete;
+        ScreenGrabQueue& operator= (ScreenGrabQueue const&) = delete;
+
+        // Finishes encoding queued images. Copies still on the GPU are dropped, so call Flush first to keep them.
+        virtual ~ScreenGrabQueue();
+
+        // Queue a copy of the top-level image of a 2D texture, to be saved as a .dds or with a WIC encoder.
+        HRESULT __cdecl CaptureDDS(
+            _In_ ID3D11DeviceContext* pContext,
+            _In_ ID3D11Resource* pSource,
+            _In_z_ const wchar_t* fileName);
+
+        HRESULT __cdecl CaptureWIC(
+            _In_ ID3D11DeviceContext* pContext,
+            _In_ ID3D11Resource* pSource,
+            _In_ REFGUID guidContainerFormat,
+            _In_z_ const wchar_t* fileName);
+
+        // Queue an image already in memory; it doesn't need a device. The pixels are copied before returning.
+        HRESULT __cdecl EncodeDDS(
+            DXGI_FORMAT format, UINT width, UINT height,
+            _In_ const void* pixels, size_t rowPitch,
+            _In_z_ const wchar_t* fileName);
+
+        HRESULT __cdecl EncodeWIC(
+            DXGI_FORMAT format, UINT width, UINT height,
+            _In_ const void* pixels, size_t rowPitch,
+            _In_ REFGUID guidContainerFormat,
+            _In_z_ const wchar_t* fileName);
+
+        // Frame sequences are numbered from <prefix>00000, as .dds files unless a WIC container is given.
+        void __cdecl BeginSequence(_In_z_ const wchar_t* filePrefix, _In_opt_ const GUID* guidContainerFormat = nullptr);
+        void __cdecl EndSequence();
+        bool __cdecl IsRecording() const;
+
+        // Captures the next frame of the sequence; returns S_FALSE when not recording.
+        HRESULT __cdecl CaptureFrame(_In_ ID3D11DeviceContext* pContext, _In_ ID3D11Resource* pSource);
+
+        // Call once per frame to hand copies that have reached the frame latency to the encoders.
+        void __cdecl Update(_In_ ID3D11DeviceContext* pContext);
+
+        // Reads back every pending copy, waits for the encoders and returns the first failure since the last Flush.
+        HRESULT __cdecl Flush(_In_opt_ ID3D11DeviceContext* pContext);
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
 }
\ No newline at end of file
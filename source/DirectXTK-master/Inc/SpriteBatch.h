@@ -24,6 +24,8 @@
 #include <functional>
 #include <memory>
 
+#include <stdint.h>
+
 
 namespace DirectX
 {
@@ -43,6 +45,10 @@ namespace DirectX
         SpriteEffects_FlipHorizontally = 1,
         SpriteEffects_FlipVertically = 2,
         SpriteEffects_FlipBoth = SpriteEffects_FlipHorizontally | SpriteEffects_FlipVertically,
+
+        // The texture alpha holds a signed distance field with the edge at 0.5, as written by MakeSpriteFont
+        // /SignedDistanceField. These sprites stay sharp at any scale, and need Feature Level 9.3 or later.
+        SpriteEffects_DistanceField = 4,
     };
 
     
@@ -84,6 +90,92 @@ namespace DirectX
         // Set viewport for sprite transformation
         void __cdecl SetViewport( const D3D11_VIEWPORT& viewPort );
 
+        // Counters for the most recent Begin/End pair. A new batch starts whenever the texture
+        // changes, so sprites sharing an atlas page draw together.
+        struct Statistics
+        {
+            uint32_t sprites;
+            uint32_t batches;
+            uint32_t drawCalls;
+            uint32_t vertexBytes;   // Written to mapped vertex buffers, or uploaded for layers
+        };
+
+        const Statistics& __cdecl GetStatistics() const;
+
+        // Records sprites for this batch on another thread. Each recording thread needs its own
+        // Recorder, used only between Begin and End; End draws the recorded sprites along with the
+        // batch's own, so it must not be called until the recording threads are done. Recorded
+        // sprites are only drawn by End, so they come after any layers drawn with DrawLayer. In
+        // SpriteSortMode_Deferred the batch's own sprites draw first, then each recorder's in the
+        // order the recorders were created. The SpriteBatch must outlive its recorders.
+        class Recorder
+        {
+        public:
+            explicit Recorder(SpriteBatch& batch);
+            Recorder(Recorder&& moveFrom);
+            Recorder& operator= (Recorder&& moveFrom);
+
+            Recorder(Recorder const&) = delete;
+            Recorder& operator= (Recorder const&) = delete;
+
+            virtual ~Recorder();
+
+            // Draw overloads specifying position, origin and scale as XMFLOAT2.
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            // Draw overloads specifying position, origin and scale via the first two components of an XMVECTOR.
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, FXMVECTOR position, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+            // Draw overloads specifying position as a RECT.
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color = Colors::White);
+            void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, _In_opt_ RECT const* sourceRectangle, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0);
+
+        private:
+            // Private implementation.
+            class Impl;
+
+            std::unique_ptr<Impl> pImpl;
+        };
+
+        // Keeps the vertices of sprites that rarely change, such as static overlays. Between Begin(layer)
+        // and End, Draw calls (including SpriteFont::DrawString) record into the layer instead of drawing.
+        // Sprites that match the previous recording keep their vertices, so only the changed ranges are
+        // regenerated and uploaded. DrawLayer draws a layer within a normal Begin/End pair, in order
+        // with the sprites around it and with its own tint and transform. The tint is applied by the
+        // vertex shader, so changing it uploads nothing; custom shaders find it in constant buffer b1.
+        class Layer
+        {
+        public:
+            Layer();
+            Layer(Layer&& moveFrom);
+            Layer& operator= (Layer&& moveFrom);
+
+            Layer(Layer const&) = delete;
+            Layer& operator= (Layer const&) = delete;
+
+            virtual ~Layer();
+
+            size_t __cdecl GetSpriteCount() const;
+
+            // Releases the vertex buffer, such as on device lost; the next DrawLayer uploads every sprite again.
+            void __cdecl ReleaseDeviceResources();
+
+        private:
+            // Private implementation.
+            class Impl;
+
+            std::unique_ptr<Impl> pImpl;
+
+            friend class SpriteBatch;
+        };
+
+        void __cdecl Begin(Layer& layer);
+        void XM_CALLCONV DrawLayer(Layer& layer, FXMVECTOR tint = Colors::White, FXMMATRIX transform = MatrixIdentity);
+
     private:
         // Private implementation.
         class Impl;
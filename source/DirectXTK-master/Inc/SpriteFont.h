@@ -15,6 +15,8 @@
 
 #include "SpriteBatch.h"
 
+#include <vector>
+
 
 namespace DirectX
 {
@@ -22,8 +24,12 @@ namespace DirectX
     {
     public:
         struct Glyph;
+        class TextLayout;
 
-        SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB = false);
+        // With memoryMapped, the file stays mapped for the lifetime of the font, and glyph metrics are read from
+        // it in place rather than copied. This keeps large fonts out of the heap, but the file can't be replaced
+        // while the font exists.
+        SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB = false, bool memoryMapped = false);
         SpriteFont(_In_ ID3D11Device* device, _In_reads_bytes_(dataSize) uint8_t const* dataBlob, _In_ size_t dataSize, bool forceSRGB = false);
         SpriteFont(_In_ ID3D11ShaderResourceView* texture, _In_reads_(glyphCount) Glyph const* glyphs, _In_ size_t glyphCount, _In_ float lineSpacing);
 
@@ -42,6 +48,16 @@ namespace DirectX
 
         XMVECTOR XM_CALLCONV MeasureString(_In_z_ wchar_t const* text) const;
 
+        // Text that is drawn repeatedly can be laid out once. Layouts are cached by their text, so asking for
+        // the same string again returns the same layout until it is evicted, least recently used first.
+        std::shared_ptr<const TextLayout> __cdecl CreateTextLayout(_In_z_ wchar_t const* text) const;
+        void __cdecl SetTextLayoutCacheSize(size_t layoutCount);
+
+        void XM_CALLCONV DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, XMFLOAT2 const& position, FXMVECTOR color = Colors::White, float rotation = 0, XMFLOAT2 const& origin = Float2Zero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color = Colors::White, float rotation = 0, FXMVECTOR origin = g_XMZero, float scale = 1, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+        void XM_CALLCONV DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects = SpriteEffects_None, float layerDepth = 0) const;
+
         RECT __cdecl MeasureDrawBounds(_In_z_ wchar_t const* text, XMFLOAT2 const& position) const;
         RECT XM_CALLCONV MeasureDrawBounds(_In_z_ wchar_t const* text, FXMVECTOR position) const;
 
@@ -55,6 +71,11 @@ namespace DirectX
 
         bool __cdecl ContainsCharacter(wchar_t character) const;
 
+        // Fonts written by MakeSpriteFont /SignedDistanceField draw with SpriteEffects_DistanceField. The range
+        // is the distance in texels between the 0 and 1 alpha values, centered on the glyph edge.
+        bool __cdecl IsDistanceField() const;
+        float __cdecl GetDistanceRange() const;
+
         // Custom layout/rendering
         Glyph const* __cdecl FindGlyph(wchar_t character) const;
         void __cdecl GetSpriteSheet( ID3D11ShaderResourceView** texture ) const;
@@ -69,6 +90,44 @@ namespace DirectX
             float XAdvance;
         };
 
+        // A string laid out into glyph quads, split into lines. Layouts keep the line spacing and
+        // default character the font had when they were created.
+        class TextLayout
+        {
+        public:
+            struct GlyphQuad
+            {
+                RECT Subrect;   // Source rectangle in the sprite sheet.
+                float X;        // Offset from the layout origin, before scaling.
+                float Y;
+                uint32_t Word;  // Words of a line are separated by whitespace and numbered from 0.
+            };
+
+            struct Line
+            {
+                uint32_t FirstGlyph;
+                uint32_t GlyphCount;
+                float Y;
+                float Width;
+            };
+
+            // Same as MeasureString for the text.
+            XMVECTOR XM_CALLCONV GetSize() const;
+
+            size_t __cdecl GetGlyphCount() const;
+            GlyphQuad const* __cdecl GetGlyphs() const;
+
+            size_t __cdecl GetLineCount() const;
+            Line const* __cdecl GetLines() const;
+
+        private:
+            std::vector<GlyphQuad> mGlyphs;
+            std::vector<Line> mLines;
+            XMFLOAT2 mSize;
+
+            friend class SpriteFont;
+        };
+
 
     private:
         // Private implementation.
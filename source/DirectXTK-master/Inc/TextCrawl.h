@@ -0,0 +1,74 @@
+//--------------------------------------------------------------------------------------
+// File: TextCrawl.h
+//
+// Draws a long document laid out on a plane in 3D, such as an opening crawl. The text is
+// laid out once, and each frame only the lines that fall inside the view are drawn, so the
+// cost per frame depends on how much text is on screen rather than on the document length.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpriteFont.h"
+
+
+namespace DirectX
+{
+    enum TextCrawlAlignment
+    {
+        TextCrawlAlignment_Center,
+
+        // Lines are stretched to the width of the widest line by widening the gaps between their words
+        // (or between the glyphs of a line that is a single word), except for the last line of each
+        // paragraph, which is centered.
+        TextCrawlAlignment_Justify,
+    };
+
+
+    class TextCrawl
+    {
+    public:
+        // The text is laid out in the font's pixels, with lines centered on x = 0 and the top of the first
+        // line at y = 0. The font's texture is kept, so the font itself doesn't have to outlive the crawl.
+        TextCrawl(_In_ SpriteFont const* font, _In_z_ wchar_t const* text, TextCrawlAlignment alignment = TextCrawlAlignment_Center);
+
+        TextCrawl(TextCrawl&& moveFrom);
+        TextCrawl& operator= (TextCrawl&& moveFrom);
+
+        TextCrawl(TextCrawl const&) = delete;
+        TextCrawl& operator= (TextCrawl const&) = delete;
+
+        virtual ~TextCrawl();
+
+        // Draws the visible lines in a Begin/End pair of its own. The matrix takes the text plane, in layout
+        // pixels with y down, all the way to clip space: typically scale * world * view * projection.
+        void XM_CALLCONV Draw(_In_ SpriteBatch* spriteBatch, FXMMATRIX textToClip, FXMVECTOR color = Colors::White,
+                              _In_opt_ ID3D11BlendState* blendState = nullptr, _In_opt_ ID3D11DepthStencilState* depthStencilState = nullptr);
+
+        // Lines fade out as their clip space w (their view depth, for a perspective projection) goes from
+        // start to end, and lines past the end are not drawn at all. Fading is off when end <= start.
+        void __cdecl SetFadeDistance(float start, float end);
+
+        // Width of the widest line, and height of all the lines.
+        XMVECTOR XM_CALLCONV GetSize() const;
+
+        size_t __cdecl GetLineCount() const;
+
+        // Lines drawn by the most recent Draw call.
+        size_t __cdecl GetVisibleLineCount() const;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
+}
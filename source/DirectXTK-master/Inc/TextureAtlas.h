@@ -0,0 +1,56 @@
+//--------------------------------------------------------------------------------------
+// File: TextureAtlas.h
+//
+// Loads an atlas page packed offline by DDSTool -atlas, so sprites and text from several
+// source images share one texture and SpriteBatch can draw them in a single batch.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "SpriteFont.h"
+
+
+namespace DirectX
+{
+    class TextureAtlas
+    {
+    public:
+        // Reads the .atlas file along with the .dds page of the same name next to it.
+        TextureAtlas(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB = false);
+
+        TextureAtlas(TextureAtlas&& moveFrom);
+        TextureAtlas& operator= (TextureAtlas&& moveFrom);
+
+        TextureAtlas(TextureAtlas const&) = delete;
+        TextureAtlas& operator= (TextureAtlas const&) = delete;
+
+        virtual ~TextureAtlas();
+
+        ID3D11ShaderResourceView* __cdecl GetTexture() const;
+
+        // Source rectangle of an entry, named after its input file without the extension.
+        bool __cdecl ContainsEntry(_In_z_ wchar_t const* name) const;
+        RECT const& __cdecl GetSourceRect(_In_z_ wchar_t const* name) const;
+
+        // Creates a font for a .spritefont entry, with its glyphs drawn from the page.
+        std::unique_ptr<SpriteFont> __cdecl CreateSpriteFont(_In_z_ wchar_t const* name) const;
+
+        // Fraction of the page covered by entries.
+        float __cdecl GetPackingEfficiency() const;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
+}
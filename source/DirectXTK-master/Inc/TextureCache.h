@@ -0,0 +1,96 @@
+//--------------------------------------------------------------------------------------
+// File: TextureCache.h
+//
+// Keeps decoded images in system memory keyed by a hash of the file contents, so the same
+// image reached through different paths is decoded once, and textures can be recreated
+// after a device reset without decoding again. Decoded WIC images can also be kept as
+// .dds files in a cache directory, which skips decoding entirely on later runs.
+//
+// Warning: like CreateWICTexture*, not thread-safe if given a d3dContext instance for
+//          auto-gen mipmap support.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+#include <d3d11_x.h>
+#else
+#include <d3d11_1.h>
+#endif
+
+#include <memory>
+
+#include <stdint.h>
+
+
+namespace DirectX
+{
+    class TextureCache
+    {
+    public:
+        struct Statistics
+        {
+            size_t memoryHits;      // Images found already decoded in memory
+            size_t diskHits;        // Images read back from the cache directory
+            size_t decodes;         // Images read and decoded from their source
+            size_t evictions;       // Images dropped to stay within the memory budget
+            size_t residentBytes;   // Decoded image bytes held in memory
+        };
+
+        static const size_t DefaultMemoryBudget = 256 * 1024 * 1024;
+
+        // The cache directory is created if needed; pass nullptr to keep decoded images in memory only.
+        explicit TextureCache(size_t memoryBudget = DefaultMemoryBudget, _In_opt_z_ const wchar_t* cacheDirectory = nullptr);
+        TextureCache(TextureCache&& moveFrom);
+        TextureCache& operator= (TextureCache&& moveFrom);
+
+        TextureCache(TextureCache const&) = delete;
+        TextureCache& operator= (TextureCache const&) = delete;
+
+        virtual ~TextureCache();
+
+        // Loads a DDS or WIC image file. Files whose size and time stamp match an earlier load
+        // are not read again when their decoded image is still cached.
+        HRESULT __cdecl CreateTextureFromFile(
+            _In_ ID3D11Device* d3dDevice,
+            _In_opt_ ID3D11DeviceContext* d3dContext,
+            _In_z_ const wchar_t* szFileName,
+            _Outptr_opt_ ID3D11Resource** texture,
+            _Outptr_opt_ ID3D11ShaderResourceView** textureView,
+            bool forceSRGB = false,
+            size_t maxsize = 0);
+
+        HRESULT __cdecl CreateTextureFromMemory(
+            _In_ ID3D11Device* d3dDevice,
+            _In_opt_ ID3D11DeviceContext* d3dContext,
+            _In_reads_bytes_(dataSize) const uint8_t* data,
+            _In_ size_t dataSize,
+            _Outptr_opt_ ID3D11Resource** texture,
+            _Outptr_opt_ ID3D11ShaderResourceView** textureView,
+            bool forceSRGB = false,
+            size_t maxsize = 0);
+
+        // Least recently used images are dropped once the decoded images exceed the budget.
+        void __cdecl SetMemoryBudget(size_t bytes);
+
+        // Releases every decoded image held in memory; the cache directory is kept.
+        void __cdecl Trim();
+
+        Statistics __cdecl GetStatistics() const;
+
+    private:
+        // Private implementation.
+        class Impl;
+
+        std::unique_ptr<Impl> pImpl;
+    };
+}
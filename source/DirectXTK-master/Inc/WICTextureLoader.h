@@ -7,7 +7,8 @@
 // Note: Assumes application has already called CoInitializeEx
 //
 // Warning: CreateWICTexture* functions are not thread-safe if given a d3dContext instance for
-//          auto-gen mipmap support.
+//          auto-gen mipmap support. WIC_LOADER_CPU_MIPS builds the mipmaps on the CPU instead,
+//          which needs no d3dContext.
 //
 // Note these functions are useful for images created as simple 2D textures. For
 // more complex resources, DDSTextureLoader is an excellent light-weight runtime loader.
@@ -43,6 +44,7 @@ namespace DirectX
         WIC_LOADER_DEFAULT      = 0,
         WIC_LOADER_FORCE_SRGB   = 0x1,
         WIC_LOADER_IGNORE_SRGB  = 0x2,
+        WIC_LOADER_CPU_MIPS     = 0x4,  // Full mip chain generated on the CPU for 32bpp RGBA/BGRA images
     };
 
     // Standard version
@@ -95,5 +95,13 @@ namespace MakeSpriteFont
 
         // For large fonts, the default tightest pack is too slow
         public bool FastPack = false;
+
+
+        // Writes a signed distance field font, which one small texture draws sharply at any size.
+        public bool SignedDistanceField = false;
+
+
+        // Distance in output texels between the 0 and 1 values of a distance field, centered on the glyph edge.
+        public float DistanceRange = 8;
     }
 }
@@ -0,0 +1,268 @@
+// DirectXTK MakeSpriteFont tool
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+
+using System;
+using System.Drawing;
+using System.Drawing.Imaging;
+using System.Threading.Tasks;
+
+namespace MakeSpriteFont
+{
+    // Converts glyph bitmaps into signed distance fields. Glyphs are rasterized larger than the output size,
+    // then each output texel stores the distance from its center to the glyph edge, measured on the large
+    // bitmap and scaled down. The runtime shader thresholds these at 0.5, so one small texture draws
+    // crisp text at any size.
+    public static class DistanceFieldGenerator
+    {
+        // How much larger than the output TrueType glyphs are rasterized.
+        public const int TrueTypeSupersample = 8;
+
+
+        public static void Generate(Glyph[] glyphs, int supersample, float distanceRange)
+        {
+            // Output texels of padding, so the field reaches zero around each glyph.
+            int padding = (int)Math.Ceiling(distanceRange / 2);
+
+            // Read the glyph coverage up front, since GDI+ bitmaps can't be used from several threads.
+            var masks = new bool[glyphs.Length][];
+
+            for (int i = 0; i < glyphs.Length; i++)
+            {
+                masks[i] = ReadMask(glyphs[i]);
+            }
+
+            // Each glyph is transformed independently, so spread them across the cores.
+            var fields = new byte[glyphs.Length][];
+
+            Parallel.For(0, glyphs.Length, i =>
+            {
+                Rectangle subrect = glyphs[i].Subrect;
+
+                fields[i] = ComputeField(masks[i], subrect.Width, subrect.Height, supersample, padding, distanceRange);
+            });
+
+            for (int i = 0; i < glyphs.Length; i++)
+            {
+                Glyph glyph = glyphs[i];
+
+                int width = OutputSize(glyph.Subrect.Width, supersample, padding);
+                int height = OutputSize(glyph.Subrect.Height, supersample, padding);
+
+                // Keep the pen position the same, so text advances just as the scaled down bitmap font would.
+                float advance = (glyph.XOffset + glyph.Subrect.Width + glyph.XAdvance) / supersample;
+
+                glyph.XOffset = glyph.XOffset / supersample - padding;
+                glyph.YOffset = glyph.YOffset / supersample - padding;
+                glyph.XAdvance = advance - glyph.XOffset - width;
+
+                glyph.Bitmap = WriteField(fields[i], width, height);
+                glyph.Subrect = new Rectangle(0, 0, width, height);
+            }
+        }
+
+
+        static int OutputSize(int size, int supersample, int padding)
+        {
+            return (size + supersample - 1) / supersample + padding * 2;
+        }
+
+
+        // Texels at least half covered count as inside the glyph.
+        static bool[] ReadMask(Glyph glyph)
+        {
+            Rectangle subrect = glyph.Subrect;
+
+            var mask = new bool[subrect.Width * subrect.Height];
+
+            using (var bitmapData = new BitmapUtils.PixelAccessor(glyph.Bitmap, ImageLockMode.ReadOnly, subrect))
+            {
+                for (int y = 0; y < subrect.Height; y++)
+                {
+                    for (int x = 0; x < subrect.Width; x++)
+                    {
+                        mask[x + y * subrect.Width] = bitmapData[x, y].A >= 128;
+                    }
+                }
+            }
+
+            return mask;
+        }
+
+
+        static Bitmap WriteField(byte[] field, int width, int height)
+        {
+            var bitmap = new Bitmap(width, height, PixelFormat.Format32bppArgb);
+
+            using (var bitmapData = new BitmapUtils.PixelAccessor(bitmap, ImageLockMode.WriteOnly))
+            {
+                for (int y = 0; y < height; y++)
+                {
+                    for (int x = 0; x < width; x++)
+                    {
+                        bitmapData[x, y] = Color.FromArgb(field[x + y * width], 255, 255, 255);
+                    }
+                }
+            }
+
+            return bitmap;
+        }
+
+
+        // Computes the output texels of one glyph from its supersampled coverage mask.
+        static byte[] ComputeField(bool[] mask, int maskWidth, int maskHeight, int supersample, int padding, float distanceRange)
+        {
+            int outputWidth = OutputSize(maskWidth, supersample, padding);
+            int outputHeight = OutputSize(maskHeight, supersample, padding);
+
+            // The supersampled image covers the whole output, with the glyph inset by the padding.
+            int width = outputWidth * supersample;
+            int height = outputHeight * supersample;
+            int inset = padding * supersample;
+
+            var inside = new bool[width * height];
+
+            for (int y = 0; y < maskHeight; y++)
+            {
+                for (int x = 0; x < maskWidth; x++)
+                {
+                    inside[(x + inset) + (y + inset) * width] = mask[x + y * maskWidth];
+                }
+            }
+
+            // Squared distances from each pixel to the nearest pixel outside, and to the nearest pixel inside.
+            float[] toOutside = DistanceTransform(inside, width, height, true);
+            float[] toInside = DistanceTransform(inside, width, height, false);
+
+            // Average the signed distance over each block of supersampled pixels. Pixel centers are half a
+            // pixel from the edge between them, hence the 0.5 offsets.
+            var field = new byte[outputWidth * outputHeight];
+
+            float scale = 1.0f / (supersample * supersample * supersample * distanceRange);
+
+            for (int oy = 0; oy < outputHeight; oy++)
+            {
+                for (int ox = 0; ox < outputWidth; ox++)
+                {
+                    float sum = 0;
+
+                    for (int y = oy * supersample; y < (oy + 1) * supersample; y++)
+                    {
+                        for (int x = ox * supersample; x < (ox + 1) * supersample; x++)
+                        {
+                            int i = x + y * width;
+
+                            sum += inside[i] ? (float)Math.Sqrt(toOutside[i]) - 0.5f
+                                             : 0.5f - (float)Math.Sqrt(toInside[i]);
+                        }
+                    }
+
+                    float value = 0.5f + sum * scale;
+
+                    field[ox + oy * outputWidth] = (byte)Math.Round(Math.Min(Math.Max(value, 0), 1) * 255);
+                }
+            }
+
+            return field;
+        }
+
+
+        // Exact squared Euclidean distance transform (Felzenszwalb and Huttenlocher), separated into
+        // a pass down each column followed by a pass along each row.
+        static float[] DistanceTransform(bool[] inside, int width, int height, bool fromInside)
+        {
+            const float Infinity = 1e20f;
+
+            var distance = new float[width * height];
+
+            for (int i = 0; i < distance.Length; i++)
+            {
+                // Pixels on the other side of the edge are the features we measure distance to.
+                distance[i] = (inside[i] != fromInside) ? 0 : Infinity;
+            }
+
+            int size = Math.Max(width, height);
+
+            var input = new float[size];
+            var output = new float[size];
+            var vertices = new int[size];
+            var boundaries = new float[size + 1];
+
+            for (int x = 0; x < width; x++)
+            {
+                for (int y = 0; y < height; y++)
+                    input[y] = distance[x + y * width];
+
+                Transform1D(input, output, height, vertices, boundaries);
+
+                for (int y = 0; y < height; y++)
+                    distance[x + y * width] = output[y];
+            }
+
+            for (int y = 0; y < height; y++)
+            {
+                Array.Copy(distance, y * width, input, 0, width);
+
+                Transform1D(input, output, width, vertices, boundaries);
+
+                Array.Copy(output, 0, distance, y * width, width);
+            }
+
+            return distance;
+        }
+
+
+        // One dimensional pass: the lower envelope of the parabolas rooted at each sample.
+        static void Transform1D(float[] input, float[] output, int count, int[] vertices, float[] boundaries)
+        {
+            int k = 0;
+
+            vertices[0] = 0;
+            boundaries[0] = float.NegativeInfinity;
+            boundaries[1] = float.PositiveInfinity;
+
+            for (int q = 1; q < count; q++)
+            {
+                // Drop parabolas hidden by the new one. The first boundary is minus infinity, so k stays >= 0.
+                float s = Intersect(input, vertices[k], q);
+
+                while (s <= boundaries[k])
+                {
+                    k--;
+                    s = Intersect(input, vertices[k], q);
+                }
+
+                k++;
+                vertices[k] = q;
+                boundaries[k] = s;
+                boundaries[k + 1] = float.PositiveInfinity;
+            }
+
+            k = 0;
+
+            for (int q = 0; q < count; q++)
+            {
+                while (boundaries[k + 1] < q)
+                    k++;
+
+                int v = vertices[k];
+
+                output[q] = (q - v) * (q - v) + input[v];
+            }
+        }
+
+
+        // Where the parabolas rooted at samples p and q cross.
+        static float Intersect(float[] input, int p, int q)
+        {
+            return ((input[q] + q * q) - (input[p] + p * p)) / (2 * q - 2 * p);
+        }
+    }
+}
@@ -51,8 +51,9 @@ namespace MakeSpriteFont
             Console.WriteLine("Importing {0}", options.SourceFont);
 
             float lineSpacing;
+            int supersample;
 
-            Glyph[] glyphs = ImportFont(options, out lineSpacing);
+            Glyph[] glyphs = ImportFont(options, out lineSpacing, out supersample);
 
             Console.WriteLine("Captured {0} glyphs", glyphs.Length);
 
@@ -64,6 +65,15 @@ namespace MakeSpriteFont
                 GlyphCropper.Crop(glyph);
             }
 
+            if (options.SignedDistanceField)
+            {
+                Console.WriteLine("Generating distance fields");
+
+                DistanceFieldGenerator.Generate(glyphs, supersample, options.DistanceRange);
+
+                lineSpacing /= supersample;
+            }
+
             Console.WriteLine("Packing glyphs into sprite sheet");
 
             Bitmap bitmap;
@@ -104,6 +114,11 @@ namespace MakeSpriteFont
                 }
             }
 
+            if (options.SignedDistanceField && options.FeatureLevel < FeatureLevel.FL9_3)
+            {
+                Console.WriteLine("WARNING: Distance field fonts are drawn with a shader that requires a Feature Level 9.3 or later device.");
+            }
+
             // Adjust line and character spacing.
             lineSpacing += options.LineSpacing;
 
@@ -113,7 +128,7 @@ namespace MakeSpriteFont
             }
 
             // Automatically detect whether this is a monochromatic or color font?
-            if (options.TextureFormat == TextureFormat.Auto)
+            if (options.TextureFormat == TextureFormat.Auto && !options.SignedDistanceField)
             {
                 bool isMono = BitmapUtils.IsRgbEntirely(Color.White, bitmap);
 
@@ -121,8 +136,8 @@ namespace MakeSpriteFont
                                                  TextureFormat.Rgba32;
             }
 
-            // Convert to premultiplied alpha format.
-            if (!options.NoPremultiply)
+            // Convert to premultiplied alpha format. Distance fields keep just the distance, in alpha.
+            if (!options.NoPremultiply && !options.SignedDistanceField)
             {
                 Console.WriteLine("Premultiplying alpha");
 
@@ -137,13 +152,13 @@ namespace MakeSpriteFont
                 bitmap.Save(options.DebugOutputSpriteSheet);
             }
 
-            Console.WriteLine("Writing {0} ({1} format)", options.OutputFile, options.TextureFormat);
+            Console.WriteLine("Writing {0} ({1} format)", options.OutputFile, options.SignedDistanceField ? "DistanceField" : options.TextureFormat.ToString());
 
             SpriteFontWriter.WriteSpriteFont(options, glyphs, lineSpacing, bitmap);
         }
 
 
-        static Glyph[] ImportFont(CommandLineOptions options, out float lineSpacing)
+        static Glyph[] ImportFont(CommandLineOptions options, out float lineSpacing, out int supersample)
         {
             // Which importer knows how to read this source font?
             IFontImporter importer;
@@ -152,6 +167,8 @@ namespace MakeSpriteFont
 
             string[] BitmapFileExtensions = { ".bmp", ".png", ".gif" };
 
+            supersample = 1;
+
             if (BitmapFileExtensions.Contains(fileExtension))
             {
                 importer = new BitmapImporter();
@@ -159,10 +176,27 @@ namespace MakeSpriteFont
             else
             {
                 importer = new TrueTypeImporter();
+
+                // Distance fields are measured on glyphs rasterized larger than the output.
+                if (options.SignedDistanceField)
+                {
+                    supersample = DistanceFieldGenerator.TrueTypeSupersample;
+                }
             }
 
             // Import the source font data.
-            importer.Import(options);
+            float fontSize = options.FontSize;
+
+            options.FontSize *= supersample;
+
+            try
+            {
+                importer.Import(options);
+            }
+            finally
+            {
+                options.FontSize = fontSize;
+            }
 
             lineSpacing = importer.LineSpacing;
 
@@ -20,32 +20,41 @@ namespace MakeSpriteFont
     public static class SpriteFontWriter
     {
         const string spriteFontMagic = "DXTKfont";
+        const string spriteFontDistanceFieldMagic = "DXTKfsdf";
 
         const int DXGI_FORMAT_R8G8B8A8_UNORM = 28;
         const int DXGI_FORMAT_B4G4R4A4_UNORM = 115;
         const int DXGI_FORMAT_BC2_UNORM = 74;
 
 
+        // Everything after the 8 byte magic is written in 32 bit fields, so each one lands on a 4 byte boundary.
+        // The runtime relies on this to use the glyphs in place from a memory mapped file; keep it that way
+        // when adding fields.
         [System.Diagnostics.CodeAnalysis.SuppressMessage("Microsoft.Usage", "CA2202:Do not dispose objects multiple times")]
         public static void WriteSpriteFont(CommandLineOptions options, Glyph[] glyphs, float lineSpacing, Bitmap bitmap)
         {
             using (FileStream file = File.OpenWrite(options.OutputFile))
             using (BinaryWriter writer = new BinaryWriter(file))
             {
-                WriteMagic(writer);
+                WriteMagic(writer, options.SignedDistanceField ? spriteFontDistanceFieldMagic : spriteFontMagic);
                 WriteGlyphs(writer, glyphs);
 
                 writer.Write(lineSpacing);
                 writer.Write(options.DefaultCharacter);
+
+                if (options.SignedDistanceField)
+                {
+                    writer.Write(options.DistanceRange);
+                }
                 
                 WriteBitmap(writer, options, bitmap);
             }
         }
 
 
-        static void WriteMagic(BinaryWriter writer)
+        static void WriteMagic(BinaryWriter writer, string magicString)
         {
-            foreach (char magic in spriteFontMagic)
+            foreach (char magic in magicString)
             {
                 writer.Write((byte)magic);
             }
@@ -77,6 +86,13 @@ namespace MakeSpriteFont
             writer.Write(bitmap.Width);
             writer.Write(bitmap.Height);
 
+            // Distance fields are white with the distance in alpha, so they load on any feature level.
+            if (options.SignedDistanceField)
+            {
+                WriteRgba32(writer, bitmap);
+                return;
+            }
+
             switch (options.TextureFormat)
             {
                 case TextureFormat.Rgba32:
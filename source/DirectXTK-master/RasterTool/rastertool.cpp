@@ -0,0 +1,1068 @@
+//--------------------------------------------------------------------------------------
+// File: rastertool.cpp
+//
+// Headless regression renderer. Draws a set of scenes built from the same pieces the
+// samples use with Direct3D (GeometricPrimitive shapes under BasicEffect, a textured sky
+// and fogged crawl, SpriteBatch overlays) through the software rasterizer in
+// Src/SoftwareRasterizer.h, writes every frame as a .DDS image, reports how long each
+// frame took to rasterize, and optionally compares the frames against golden images so
+// rendering changes can be caught on machines without a GPU.
+//
+// It only depends on the C++ standard library, for example:
+//
+//     g++ -O2 -std=c++14 -pthread -I../Src -o rastertool rastertool.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "SoftwareRasterizer.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4996)
+#endif
+
+using namespace DirectX::SoftwareRendering;
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+enum OPTIONS
+{
+    OPT_OUTPUTDIR = 1,
+    OPT_WIDTH,
+    OPT_HEIGHT,
+    OPT_FRAMES,
+    OPT_THREADS,
+    OPT_GOLDEN,
+    OPT_PSNR,
+    OPT_SKY,
+    OPT_NOLOGO,
+    OPT_MAX
+};
+
+static_assert(OPT_MAX <= 32, "dwOptions is a uint32_t bitfield");
+
+enum SCENE
+{
+    SCENE_PRIMITIVES = 1,
+    SCENE_CRAWL,
+    SCENE_SPRITES,
+};
+
+struct SValue
+{
+    const char* pName;
+    uint32_t dwValue;
+};
+
+const SValue g_pOptions[] =
+{
+    { "o",          OPT_OUTPUTDIR },
+    { "w",          OPT_WIDTH },
+    { "h",          OPT_HEIGHT },
+    { "frames",     OPT_FRAMES },
+    { "threads",    OPT_THREADS },
+    { "golden",     OPT_GOLDEN },
+    { "psnr",       OPT_PSNR },
+    { "sky",        OPT_SKY },
+    { "nologo",     OPT_NOLOGO },
+    { nullptr,      0 }
+};
+
+const SValue g_pScenes[] =
+{
+    { "primitives", SCENE_PRIMITIVES },
+    { "crawl",      SCENE_CRAWL },
+    { "sprites",    SCENE_SPRITES },
+    { nullptr,      0 }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+    const float PI = 3.14159265358979323846f;
+
+    // Scenes advance at a fixed rate so frame N is always the same image.
+    const float FrameSeconds = 1.f / 30.f;
+
+    //----------------------------------------------------------------------------------
+    // Same layout and input elements as VertexPositionNormalTexture in VertexTypes.h
+    struct VertexPositionNormalTexture
+    {
+        Vector3 position;
+        Vector3 normal;
+        Vector2 textureCoordinate;
+
+        static const int InputElementCount = 3;
+        static const InputElement InputElements[InputElementCount];
+    };
+
+    const InputElement VertexPositionNormalTexture::InputElements[] =
+    {
+        { "SV_Position", 0, FORMAT_R32G32B32_FLOAT, 0, APPEND_ALIGNED_ELEMENT, 0, 0 },
+        { "NORMAL",      0, FORMAT_R32G32B32_FLOAT, 0, APPEND_ALIGNED_ELEMENT, 0, 0 },
+        { "TEXCOORD",    0, FORMAT_R32G32_FLOAT,    0, APPEND_ALIGNED_ELEMENT, 0, 0 },
+    };
+
+    typedef std::vector<VertexPositionNormalTexture> VertexCollection;
+    typedef std::vector<uint16_t> IndexCollection;
+
+    struct Shape
+    {
+        VertexCollection vertices;
+        IndexCollection indices;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // Shapes generated as in Src/Geometry.cpp
+    void ReverseWinding(Shape& shape)
+    {
+        for (size_t j = 0; j + 2 < shape.indices.size(); j += 3)
+            std::swap(shape.indices[j], shape.indices[j + 2]);
+
+        for (auto& vertex : shape.vertices)
+            vertex.textureCoordinate.x = 1.f - vertex.textureCoordinate.x;
+    }
+
+    void ComputeBox(Shape& shape, float size, bool rhcoords)
+    {
+        static const Vector3 faceNormals[6] =
+        {
+            {  0,  0,  1 },
+            {  0,  0, -1 },
+            {  1,  0,  0 },
+            { -1,  0,  0 },
+            {  0,  1,  0 },
+            {  0, -1,  0 },
+        };
+
+        static const Vector2 textureCoordinates[4] =
+        {
+            { 1, 0 },
+            { 1, 1 },
+            { 0, 1 },
+            { 0, 0 },
+        };
+
+        using namespace DirectX::SoftwareRendering::Internal;
+
+        float half = size / 2;
+
+        for (size_t i = 0; i < 6; ++i)
+        {
+            Vector3 normal = faceNormals[i];
+
+            // Two vectors perpendicular both to the face normal and to each other.
+            Vector3 basis = (i >= 4) ? Vector3{ 0, 0, 1 } : Vector3{ 0, 1, 0 };
+
+            Vector3 side1 = Cross(normal, basis);
+            Vector3 side2 = Cross(normal, side1);
+
+            uint16_t vbase = uint16_t(shape.vertices.size());
+            uint16_t face[6] = { 0, 1, 2, 0, 2, 3 };
+            for (auto index : face)
+                shape.indices.push_back(uint16_t(vbase + index));
+
+            shape.vertices.push_back({ (normal - side1 - side2) * half, normal, textureCoordinates[0] });
+            shape.vertices.push_back({ (normal - side1 + side2) * half, normal, textureCoordinates[1] });
+            shape.vertices.push_back({ (normal + side1 + side2) * half, normal, textureCoordinates[2] });
+            shape.vertices.push_back({ (normal + side1 - side2) * half, normal, textureCoordinates[3] });
+        }
+
+        if (!rhcoords)
+            ReverseWinding(shape);
+    }
+
+    void ComputeSphere(Shape& shape, float diameter, size_t tessellation, bool rhcoords)
+    {
+        size_t verticalSegments = tessellation;
+        size_t horizontalSegments = tessellation * 2;
+        float radius = diameter / 2;
+
+        // Rings of vertices at progressively higher latitudes.
+        for (size_t i = 0; i <= verticalSegments; ++i)
+        {
+            float v = 1 - float(i) / float(verticalSegments);
+            float latitude = (float(i) * PI / float(verticalSegments)) - PI / 2;
+            float dy = sinf(latitude), dxz = cosf(latitude);
+
+            for (size_t j = 0; j <= horizontalSegments; ++j)
+            {
+                float u = float(j) / float(horizontalSegments);
+                float longitude = float(j) * 2 * PI / float(horizontalSegments);
+                float dx = sinf(longitude) * dxz, dz = cosf(longitude) * dxz;
+
+                shape.vertices.push_back({ { dx * radius, dy * radius, dz * radius }, { dx, dy, dz }, { u, v } });
+            }
+        }
+
+        // Triangles joining each pair of latitude rings.
+        size_t stride = horizontalSegments + 1;
+        for (size_t i = 0; i < verticalSegments; ++i)
+        {
+            for (size_t j = 0; j <= horizontalSegments; ++j)
+            {
+                size_t nextI = i + 1;
+                size_t nextJ = (j + 1) % stride;
+
+                size_t quad[6] = { i * stride + j, nextI * stride + j, i * stride + nextJ, i * stride + nextJ, nextI * stride + j, nextI * stride + nextJ };
+                for (auto index : quad)
+                    shape.indices.push_back(uint16_t(index));
+            }
+        }
+
+        if (!rhcoords)
+            ReverseWinding(shape);
+    }
+
+    // A GeometricPrimitive::Draw with its default states.
+    void DrawShape(Rasterizer& rasterizer, const Shape& shape, const BasicEffectState& effect, bool alpha)
+    {
+        static const InputLayout layout = InputLayout::Create<VertexPositionNormalTexture>();
+
+        rasterizer.SetBlendState(alpha ? BLEND_ALPHA : BLEND_OPAQUE);
+        rasterizer.SetDepthStencilState(alpha ? DEPTH_READ : DEPTH_DEFAULT);
+        rasterizer.SetRasterizerState(CULL_COUNTERCLOCKWISE);
+        rasterizer.SetSamplerState(SAMPLER_LINEAR_WRAP);
+
+        rasterizer.DrawIndexed(effect, layout, shape.vertices.data(), shape.vertices.size(), shape.indices.data(), shape.indices.size());
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Procedural textures, so the scenes don't depend on content files
+    uint32_t NextRandom(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    std::unique_ptr<Texture> CreateCheckerTexture()
+    {
+        const size_t size = 64;
+        std::vector<uint8_t> pixels(size * size * 4);
+        for (size_t y = 0; y < size; ++y)
+        {
+            for (size_t x = 0; x < size; ++x)
+            {
+                bool odd = ((x / 8) ^ (y / 8)) & 1;
+                uint8_t* texel = &pixels[(y * size + x) * 4];
+                texel[0] = odd ? 230 : 40;
+                texel[1] = odd ? 200 : 90;
+                texel[2] = odd ? 90 : 160;
+                texel[3] = 255;
+            }
+        }
+        return std::make_unique<Texture>(pixels.data(), size, size, size * 4);
+    }
+
+    std::unique_ptr<Texture> CreateStarTexture()
+    {
+        const size_t width = 1024, height = 512;
+        std::vector<uint8_t> pixels(width * height * 4, 0);
+        uint32_t seed = 12345;
+        for (size_t j = 0; j < 4000; ++j)
+        {
+            size_t x = NextRandom(seed) % width;
+            size_t y = NextRandom(seed) % height;
+            uint8_t brightness = uint8_t(96 + NextRandom(seed) % 160);
+            uint8_t* texel = &pixels[(y * width + x) * 4];
+            texel[0] = texel[1] = texel[2] = brightness;
+        }
+        for (size_t j = 0; j < width * height; ++j)
+            pixels[j * 4 + 3] = 255;
+
+        return std::make_unique<Texture>(pixels.data(), width, height, width * 4);
+    }
+
+    // Rows of yellow "words" on transparent black, premultiplied like the crawl text.
+    std::unique_ptr<Texture> CreateTextTexture()
+    {
+        const size_t width = 256, height = 1024;
+        std::vector<uint8_t> pixels(width * height * 4, 0);
+        uint32_t seed = 4242;
+        for (size_t line = 0; line < height / 24; ++line)
+        {
+            size_t x = 8;
+            while (x < width - 8)
+            {
+                size_t word = 8 + NextRandom(seed) % 40;
+                if (x + word > width - 8)
+                    break;
+
+                for (size_t y = line * 24 + 6; y < line * 24 + 18; ++y)
+                {
+                    for (size_t i = x; i < x + word; ++i)
+                    {
+                        uint8_t* texel = &pixels[(y * width + i) * 4];
+                        texel[0] = 229;
+                        texel[1] = 177;
+                        texel[2] = 58;
+                        texel[3] = 255;
+                    }
+                }
+                x += word + 6;
+            }
+        }
+        return std::make_unique<Texture>(pixels.data(), width, height, width * 4);
+    }
+
+    // An overlay page like the one DDSTool -atlas packs: a black square and a block of
+    // blue "text", each with its source rectangle.
+    std::unique_ptr<Texture> CreateOverlayTexture(Rect& black, Rect& text)
+    {
+        const size_t size = 256;
+        std::vector<uint8_t> pixels(size * size * 4, 0);
+
+        // Filtering reads past the source rectangle, so the black has a border around it.
+        black = Rect{ 4, 4, 12, 12 };
+        for (size_t y = 0; y < 16; ++y)
+        {
+            for (size_t x = 0; x < 16; ++x)
+                pixels[(y * size + x) * 4 + 3] = 255;
+        }
+
+        text = Rect{ 16, 32, 240, 96 };
+        uint32_t seed = 777;
+        for (int32_t y = text.top; y < text.bottom; ++y)
+        {
+            for (int32_t x = text.left; x < text.right; ++x)
+            {
+                if (((y - text.top) % 16) < 10 && (NextRandom(seed) % 3))
+                {
+                    uint8_t* texel = &pixels[(size_t(y) * size + size_t(x)) * 4];
+                    texel[0] = 75;
+                    texel[1] = 213;
+                    texel[2] = 238;
+                    texel[3] = 255;
+                }
+            }
+        }
+        return std::make_unique<Texture>(pixels.data(), size, size, size * 4);
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // DDS input and output (see Src/dds.h)
+    const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+    const uint32_t DDS_FOURCC = 0x00000004;
+    const uint32_t DDS_RGB = 0x00000040;
+    const uint32_t DDS_RGBA = 0x00000041;
+
+    const uint32_t DDS_HEADER_FLAGS_TEXTURE = 0x00001007; // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+    const uint32_t DDS_HEADER_FLAGS_PITCH = 0x00000008;
+    const uint32_t DDS_SURFACE_FLAGS_TEXTURE = 0x00001000;
+
+    inline uint32_t MakeFourCC(char a, char b, char c, char d)
+    {
+        return uint32_t(uint8_t(a)) | (uint32_t(uint8_t(b)) << 8) | (uint32_t(uint8_t(c)) << 16) | (uint32_t(uint8_t(d)) << 24);
+    }
+
+    std::vector<uint8_t> ReadEntireFile(const char* fileName)
+    {
+        FILE* f = fopen(fileName, "rb");
+        if (!f)
+            throw std::runtime_error("could not open file");
+
+        std::vector<uint8_t> data;
+
+        uint8_t buffer[65536];
+        for (;;)
+        {
+            size_t count = fread(buffer, 1, sizeof(buffer), f);
+            if (!count)
+                break;
+            data.insert(data.end(), buffer, buffer + count);
+        }
+
+        fclose(f);
+        return data;
+    }
+
+    // Reads the mip chain of a 2D RGBA, BGRA, BC1, BC3, BC4 or BC5 texture into RGBA levels.
+    std::vector<DirectX::MipGeneration::MipLevel> ReadDDS(const char* fileName)
+    {
+        auto file = ReadEntireFile(fileName);
+
+        uint32_t header[31];
+        if (file.size() < 4 + sizeof(header) || memcmp(file.data(), &DDS_MAGIC, 4))
+            throw std::runtime_error("not a DDS file");
+
+        memcpy(header, file.data() + 4, sizeof(header));
+        size_t offset = 4 + sizeof(header);
+
+        enum { RGBA, BGRA, BLOCKS } layout;
+        DirectX::BlockCompression::Format codec = DirectX::BlockCompression::BC1;
+
+        uint32_t flags = header[19];
+        uint32_t fourCC = header[20];
+        if ((flags & DDS_FOURCC) && fourCC == MakeFourCC('D', 'X', '1', '0'))
+        {
+            if (file.size() < offset + 20)
+                throw std::runtime_error("truncated DDS file");
+
+            uint32_t format;
+            memcpy(&format, file.data() + offset, sizeof(format));
+            offset += 20;
+
+            switch (format)
+            {
+            case 28: case 29: layout = RGBA; break;
+            case 87: case 91: layout = BGRA; break;
+            case 71: case 72: layout = BLOCKS; codec = DirectX::BlockCompression::BC1; break;
+            case 77: case 78: layout = BLOCKS; codec = DirectX::BlockCompression::BC3; break;
+            case 80:          layout = BLOCKS; codec = DirectX::BlockCompression::BC4; break;
+            case 83:          layout = BLOCKS; codec = DirectX::BlockCompression::BC5; break;
+            default:
+                throw std::runtime_error("unsupported DDS format");
+            }
+        }
+        else if (flags & DDS_FOURCC)
+        {
+            layout = BLOCKS;
+            if (fourCC == MakeFourCC('D', 'X', 'T', '1'))
+                codec = DirectX::BlockCompression::BC1;
+            else if (fourCC == MakeFourCC('D', 'X', 'T', '5'))
+                codec = DirectX::BlockCompression::BC3;
+            else if (fourCC == MakeFourCC('B', 'C', '4', 'U') || fourCC == MakeFourCC('A', 'T', 'I', '1'))
+                codec = DirectX::BlockCompression::BC4;
+            else if (fourCC == MakeFourCC('B', 'C', '5', 'U') || fourCC == MakeFourCC('A', 'T', 'I', '2'))
+                codec = DirectX::BlockCompression::BC5;
+            else
+                throw std::runtime_error("unsupported DDS format");
+        }
+        else if ((flags & DDS_RGB) && header[21] == 32)
+        {
+            layout = (header[22] == 0x000000ff) ? RGBA : BGRA;
+        }
+        else
+        {
+            throw std::runtime_error("unsupported DDS format");
+        }
+
+        size_t width = header[3];
+        size_t height = header[2];
+        size_t levels = std::max<uint32_t>(1, header[6]);
+        if (!width || !height)
+            throw std::runtime_error("empty DDS file");
+
+        std::vector<DirectX::MipGeneration::MipLevel> mips(std::min(levels, DirectX::MipGeneration::CountMips(width, height)));
+        for (auto& mip : mips)
+        {
+            mip.width = width;
+            mip.height = height;
+            mip.pixels.resize(width * height * 4);
+
+            size_t size = (layout == BLOCKS)
+                ? std::max<size_t>(1, (width + 3) / 4) * std::max<size_t>(1, (height + 3) / 4) * DirectX::BlockCompression::BlockSize(codec)
+                : width * height * 4;
+
+            if (file.size() < offset + size)
+                throw std::runtime_error("truncated DDS file");
+
+            const uint8_t* src = file.data() + offset;
+            if (layout == BLOCKS)
+            {
+                DirectX::BlockCompression::Decode(codec, src, width, height, mip.pixels.data(), width * 4);
+            }
+            else
+            {
+                memcpy(mip.pixels.data(), src, size);
+                if (layout == BGRA)
+                {
+                    for (size_t j = 0; j < width * height; ++j)
+                        std::swap(mip.pixels[j * 4], mip.pixels[j * 4 + 2]);
+                }
+            }
+
+            offset += size;
+            width = std::max<size_t>(1, width / 2);
+            height = std::max<size_t>(1, height / 2);
+        }
+
+        return mips;
+    }
+
+    void WriteDDS(const char* fileName, size_t width, size_t height, const uint8_t* pixels)
+    {
+        uint32_t header[31] = {};
+        header[0] = 124;                                                    // size
+        header[1] = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_PITCH;      // flags
+        header[2] = uint32_t(height);
+        header[3] = uint32_t(width);
+        header[4] = uint32_t(width * 4);                                    // pitchOrLinearSize
+        header[6] = 1;                                                      // mipMapCount
+        header[18] = 32;
+        header[19] = DDS_RGBA;
+        header[21] = 32;
+        header[22] = 0x000000ff;
+        header[23] = 0x0000ff00;
+        header[24] = 0x00ff0000;
+        header[25] = 0xff000000;
+        header[26] = DDS_SURFACE_FLAGS_TEXTURE;                             // caps
+
+        FILE* f = fopen(fileName, "wb");
+        if (!f)
+            throw std::runtime_error("could not create output file");
+
+        size_t size = width * height * 4;
+        bool ok = fwrite(&DDS_MAGIC, sizeof(uint32_t), 1, f) == 1
+               && fwrite(header, sizeof(header), 1, f) == 1
+               && fwrite(pixels, 1, size, f) == size;
+
+        fclose(f);
+
+        if (!ok)
+            throw std::runtime_error("error writing output file");
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Scenes. Each sets up its resources once and then draws any frame on demand.
+    class Scene
+    {
+    public:
+        virtual ~Scene() {}
+        virtual void Render(Rasterizer& rasterizer, float time) = 0;
+    };
+
+    // GeometricPrimitive shapes with the default BasicEffect lighting, per-pixel lighting,
+    // fog, texturing and an alpha blended sphere.
+    class PrimitivesScene : public Scene
+    {
+    public:
+        explicit PrimitivesScene(float aspectRatio)
+          : mChecker(CreateCheckerTexture())
+        {
+            ComputeBox(mBox, 1.f, true);
+            ComputeSphere(mSphere, 1.f, 16, true);
+
+            mView = Matrix::LookAt(Vector3{ 0.f, 1.5f, 4.5f }, Vector3{ 0.f, 0.f, 0.f }, Vector3{ 0.f, 1.f, 0.f });
+            mProjection = Matrix::PerspectiveFieldOfView(PI / 4.f, aspectRatio, 0.1f, 50.f);
+        }
+
+        void Render(Rasterizer& rasterizer, float time) override
+        {
+            rasterizer.Clear(Vector4{ 0.39f, 0.58f, 0.93f, 1.f });
+
+            BasicEffectState effect;
+            effect.view = mView;
+            effect.projection = mProjection;
+            effect.EnableDefaultLighting();
+
+            float angle = time * 0.8f;
+
+            // Textured box, lit per vertex.
+            effect.world = Matrix::RotationY(angle) * Matrix::RotationX(angle * 0.5f) * Matrix::Translation(-1.4f, 0.f, 0.f);
+            effect.textureEnabled = true;
+            effect.texture = mChecker.get();
+            DrawShape(rasterizer, mBox, effect, false);
+
+            // Sphere lit per pixel.
+            effect.world = Matrix::RotationY(-angle) * Matrix::Translation(0.f, 0.f, 0.f);
+            effect.textureEnabled = false;
+            effect.perPixelLighting = true;
+            effect.diffuseColor = Vector3{ 0.8f, 0.3f, 0.2f };
+            DrawShape(rasterizer, mSphere, effect, false);
+
+            // Fogged box sliding into the distance.
+            effect.world = Matrix::RotationY(angle) * Matrix::Translation(1.4f, 0.f, -3.f * (1.f + sinf(time)));
+            effect.perPixelLighting = false;
+            effect.diffuseColor = Vector3{ 0.3f, 0.9f, 0.4f };
+            effect.fogEnabled = true;
+            effect.fogStart = 4.f;
+            effect.fogEnd = 10.f;
+            effect.fogColor = Vector3{ 0.39f, 0.58f, 0.93f };
+            DrawShape(rasterizer, mBox, effect, false);
+
+            // Translucent sphere in front, drawn last like GeometricPrimitive's alpha path.
+            effect.world = Matrix::Scale(0.6f, 0.6f, 0.6f) * Matrix::Translation(0.f, -0.4f + 0.3f * sinf(time * 2.f), 1.2f);
+            effect.fogEnabled = false;
+            effect.diffuseColor = Vector3{ 1.f, 1.f, 1.f };
+            effect.alpha = 0.5f;
+            DrawShape(rasterizer, mSphere, effect, true);
+        }
+
+    private:
+        Shape mBox;
+        Shape mSphere;
+        std::unique_ptr<Texture> mChecker;
+        Matrix mView;
+        Matrix mProjection;
+    };
+
+    // The opening crawl: a star sky sphere seen from inside, and text receding into fog,
+    // set up like the skybox and crawl model effects in the game.
+    class CrawlScene : public Scene
+    {
+    public:
+        CrawlScene(float aspectRatio, const char* skyFile)
+          : mText(CreateTextTexture())
+        {
+            if (skyFile)
+            {
+                auto levels = ReadDDS(skyFile);
+                if (levels.size() > 1)
+                {
+                    mSky = std::make_unique<Texture>(std::move(levels));
+                }
+                else
+                {
+                    mSky = std::make_unique<Texture>(levels[0].pixels.data(), levels[0].width, levels[0].height, levels[0].width * 4);
+                }
+            }
+            else
+            {
+                mSky = CreateStarTexture();
+            }
+
+            ComputeSphere(mSkySphere, 100.f, 32, false);
+
+            // A long strip in the XY plane, facing +Z.
+            const float halfWidth = 1.2f, length = 12.f;
+            mCrawl.vertices =
+            {
+                { { -halfWidth, 0.f,    0.f }, { 0, 0, 1 }, { 0, 1 } },
+                { { -halfWidth, length, 0.f }, { 0, 0, 1 }, { 0, 0 } },
+                { {  halfWidth, length, 0.f }, { 0, 0, 1 }, { 1, 0 } },
+                { {  halfWidth, 0.f,    0.f }, { 0, 0, 1 }, { 1, 1 } },
+            };
+            mCrawl.indices = { 0, 1, 2, 0, 2, 3 };
+
+            mProjection = Matrix::PerspectiveFieldOfView(PI / 4.f, aspectRatio, 0.1f, 50.f);
+            mSkyProjection = Matrix::PerspectiveFieldOfView(PI / 4.f, aspectRatio, 0.1f, 100.f);
+        }
+
+        void Render(Rasterizer& rasterizer, float time) override
+        {
+            rasterizer.Clear(Vector4{ 0.f, 0.f, 0.f, 1.f });
+
+            Matrix view = Matrix::Identity();
+
+            BasicEffectState sky;
+            sky.world = Matrix::RotationY(time * -0.8f * PI / 180.f);
+            sky.view = view;
+            sky.projection = mSkyProjection;
+            sky.textureEnabled = true;
+            sky.texture = mSky.get();
+            sky.DisableSpecular();
+            DrawShape(rasterizer, mSkySphere, sky, false);
+
+            // Tilted back by the crawl angle and scrolling away from the camera.
+            const float crawlAngle = 28.f * PI / 180.f;
+            BasicEffectState crawl;
+            crawl.world = Matrix::Translation(0.f, -6.f + time * 0.3f, 0.f) * Matrix::RotationX(-(PI / 2.f - crawlAngle)) * Matrix::Translation(0.f, -1.f, -2.f);
+            crawl.view = view;
+            crawl.projection = mProjection;
+            crawl.lightingEnabled = true;
+            crawl.ambientLightColor = Vector3{ 1.3f, 1.3f, 1.3f };
+            crawl.lights[0].enabled = false;
+            crawl.textureEnabled = true;
+            crawl.texture = mText.get();
+            crawl.fogEnabled = true;
+            crawl.fogStart = 9.f;
+            crawl.fogEnd = 10.f;
+            DrawShape(rasterizer, mCrawl, crawl, true);
+        }
+
+    private:
+        Shape mSkySphere;
+        Shape mCrawl;
+        std::unique_ptr<Texture> mSky;
+        std::unique_ptr<Texture> mText;
+        Matrix mProjection;
+        Matrix mSkyProjection;
+    };
+
+    // The overlay pass: a fullscreen background and fading prelude text drawn from one
+    // atlas page, then a ring of rotated, mirrored and additive sprites in texture order.
+    class SpritesScene : public Scene
+    {
+    public:
+        SpritesScene()
+          : mOverlay(CreateOverlayTexture(mBlack, mText)),
+            mChecker(CreateCheckerTexture())
+        {
+        }
+
+        void Render(Rasterizer& rasterizer, float time) override
+        {
+            rasterizer.Clear(Vector4{ 0.2f, 0.2f, 0.2f, 1.f });
+
+            float width = float(rasterizer.Width());
+            float height = float(rasterizer.Height());
+
+            SpriteRenderer sprites(rasterizer);
+
+            sprites.Begin();
+            sprites.Draw(*mOverlay, Rect{ 0, 0, int32_t(width / 2), int32_t(height) }, &mBlack);
+
+            float fade = std::min(1.f, std::max(0.f, cosf(time / 2.5f + 2.f) * -1.5f));
+            Vector2 origin = { float(mText.right - mText.left) / 2.f, float(mText.bottom - mText.top) / 2.f };
+            sprites.Draw(*mOverlay, Vector2{ width / 2.f, height / 2.f }, &mText, Vector4{ fade, fade, fade, fade }, 0.f, origin, Vector2{ 1.5f, 1.5f });
+            sprites.End();
+
+            sprites.Begin(SPRITE_SORT_TEXTURE);
+            for (size_t j = 0; j < 24; ++j)
+            {
+                float angle = time + float(j) * 2.f * PI / 24.f;
+                Vector2 position = { width / 2.f + cosf(angle) * height * 0.35f, height / 2.f + sinf(angle) * height * 0.35f };
+                auto& texture = (j & 1) ? *mChecker : *mOverlay;
+                const Rect* source = (j & 1) ? nullptr : &mText;
+                Vector2 center = (j & 1) ? Vector2{ 32.f, 32.f } : origin;
+                float scale = (j & 1) ? 0.5f : 0.15f;
+                sprites.Draw(texture, position, source, Vector4{ 1.f, 1.f, 1.f, 1.f }, angle, center, Vector2{ scale, scale }, unsigned(j % 4));
+            }
+            sprites.End();
+
+            sprites.Begin(SPRITE_SORT_DEFERRED, BLEND_ADDITIVE);
+            sprites.Draw(*mChecker, Rect{ int32_t(width) - 96, 16, int32_t(width) - 16, 96 }, nullptr, Vector4{ 1.f, 0.5f, 0.5f, 0.5f });
+            sprites.End();
+        }
+
+    private:
+        Rect mBlack;
+        Rect mText;
+        std::unique_ptr<Texture> mOverlay;
+        std::unique_ptr<Texture> mChecker;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    uint32_t LookupByName(const char* pName, const SValue* pArray)
+    {
+        while (pArray->pName)
+        {
+            std::string a(pName), b(pArray->pName);
+            std::transform(a.begin(), a.end(), a.begin(), ::tolower);
+            std::transform(b.begin(), b.end(), b.begin(), ::tolower);
+            if (a == b)
+                return pArray->dwValue;
+
+            pArray++;
+        }
+
+        return 0;
+    }
+
+    const char* LookupByValue(uint32_t value, const SValue* pArray)
+    {
+        while (pArray->pName)
+        {
+            if (pArray->dwValue == value)
+                return pArray->pName;
+
+            pArray++;
+        }
+
+        return "";
+    }
+
+    std::string JoinPath(const char* dir, const std::string& name)
+    {
+        if (!dir || !*dir)
+            return name;
+
+        std::string path(dir);
+        if (path.back() != '/' && path.back() != '\\')
+            path += '/';
+        return path + name;
+    }
+
+    void PrintLogo()
+    {
+        printf("Microsoft (R) Software Rasterizer Regression Tool\n");
+        printf("Copyright (C) Microsoft Corp. All rights reserved.\n");
+#ifdef _DEBUG
+        printf("*** Debug build ***\n");
+#endif
+        printf("\n");
+    }
+
+    void PrintUsage()
+    {
+        PrintLogo();
+
+        printf("Usage: rastertool <options> [scenes]\n");
+        printf("\n");
+        printf("   scenes              primitives, crawl and/or sprites (default: all of them)\n");
+        printf("   -o <directory>      output directory for the frames (default: current)\n");
+        printf("   -w <width>          frame width (default 1280)\n");
+        printf("   -h <height>         frame height (default 720)\n");
+        printf("   -frames <count>     frames per scene, 1/30 s apart (default 1)\n");
+        printf("   -threads <count>    rasterizer threads, 0 for one per core (default)\n");
+        printf("   -golden <directory> compare each frame against the image of the same name\n");
+        printf("   -psnr <dB>          lowest PSNR that matches a golden image (default 50)\n");
+        printf("   -sky <dds-file>     texture for the crawl scene's sky\n");
+        printf("   -nologo             suppress copyright message\n");
+        printf("\n");
+        printf("   Frames are written as <scene>_<frame>.dds. The exit code is 1 if any\n");
+        printf("   frame fails to render or doesn't match its golden image.\n");
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    // Parameters and defaults
+    const char* outputDir = nullptr;
+    const char* goldenDir = nullptr;
+    const char* skyFile = nullptr;
+    size_t width = 1280;
+    size_t height = 720;
+    size_t frameCount = 1;
+    unsigned threadCount = 0;
+    double minPSNR = 50.0;
+
+    // Process command line
+    uint32_t dwOptions = 0;
+    std::vector<uint32_t> scenes;
+
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        char* pArg = argv[iArg];
+
+        if (('-' == pArg[0]) || ('/' == pArg[0]))
+        {
+            pArg++;
+            char* pValue;
+
+            for (pValue = pArg; *pValue && (':' != *pValue); pValue++);
+
+            if (*pValue)
+                *pValue++ = 0;
+
+            uint32_t dwOption = LookupByName(pArg, g_pOptions);
+
+            if (!dwOption || (dwOptions & (1 << dwOption)))
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            dwOptions |= 1 << dwOption;
+
+            // Handle options with additional value parameter
+            switch (dwOption)
+            {
+            case OPT_OUTPUTDIR:
+            case OPT_WIDTH:
+            case OPT_HEIGHT:
+            case OPT_FRAMES:
+            case OPT_THREADS:
+            case OPT_GOLDEN:
+            case OPT_PSNR:
+            case OPT_SKY:
+                if (!*pValue)
+                {
+                    if ((iArg + 1 >= argc))
+                    {
+                        PrintUsage();
+                        return 1;
+                    }
+
+                    iArg++;
+                    pValue = argv[iArg];
+                }
+                break;
+            }
+
+            switch (dwOption)
+            {
+            case OPT_OUTPUTDIR:
+                outputDir = pValue;
+                break;
+
+            case OPT_WIDTH:
+                width = size_t(strtoul(pValue, nullptr, 10));
+                break;
+
+            case OPT_HEIGHT:
+                height = size_t(strtoul(pValue, nullptr, 10));
+                break;
+
+            case OPT_FRAMES:
+                frameCount = size_t(strtoul(pValue, nullptr, 10));
+                break;
+
+            case OPT_THREADS:
+                threadCount = unsigned(strtoul(pValue, nullptr, 10));
+                break;
+
+            case OPT_GOLDEN:
+                goldenDir = pValue;
+                break;
+
+            case OPT_PSNR:
+                minPSNR = strtod(pValue, nullptr);
+                break;
+
+            case OPT_SKY:
+                skyFile = pValue;
+                break;
+            }
+        }
+        else
+        {
+            uint32_t scene = LookupByName(pArg, g_pScenes);
+            if (!scene)
+            {
+                printf("Unknown scene (%s)\n", pArg);
+                return 1;
+            }
+            scenes.push_back(scene);
+        }
+    }
+
+    if (!width || !height || width > 16384 || height > 16384 || !frameCount)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (scenes.empty())
+    {
+        for (auto scene = g_pScenes; scene->pName; ++scene)
+            scenes.push_back(scene->dwValue);
+    }
+
+    if (~dwOptions & (1 << OPT_NOLOGO))
+        PrintLogo();
+
+    float aspectRatio = float(width) / float(height);
+    int result = 0;
+    size_t failures = 0;
+
+    Rasterizer rasterizer(width, height, threadCount);
+
+    for (auto sceneId : scenes)
+    {
+        const char* sceneName = LookupByValue(sceneId, g_pScenes);
+
+        try
+        {
+            std::unique_ptr<Scene> scene;
+            switch (sceneId)
+            {
+            case SCENE_PRIMITIVES:  scene = std::make_unique<PrimitivesScene>(aspectRatio); break;
+            case SCENE_CRAWL:       scene = std::make_unique<CrawlScene>(aspectRatio, skyFile); break;
+            default:                scene = std::make_unique<SpritesScene>(); break;
+            }
+
+            printf("rendering %s (%zux%zu, %zu frame%s)\n", sceneName, width, height, frameCount, (frameCount == 1) ? "" : "s");
+
+            double totalRaster = 0;
+            double worstRaster = 0;
+
+            for (size_t frame = 0; frame < frameCount; ++frame)
+            {
+                rasterizer.ResetStatistics();
+
+                scene->Render(rasterizer, float(frame) * FrameSeconds);
+                const uint8_t* pixels = rasterizer.GetPixels();
+
+                auto& stats = rasterizer.GetStatistics();
+                totalRaster += stats.rasterMilliseconds;
+                worstRaster = std::max(worstRaster, stats.rasterMilliseconds);
+
+                char name[256];
+                snprintf(name, sizeof(name), "%s_%03zu.dds", sceneName, frame);
+
+                std::string outputFile = JoinPath(outputDir, name);
+                WriteDDS(outputFile.c_str(), width, height, pixels);
+
+                printf("    %s: %zu draws, %zu triangles (%zu rasterized), %zu pixels, setup %.2f ms, raster %.2f ms",
+                       name, stats.drawCalls, stats.triangles, stats.trianglesRasterized, stats.pixels,
+                       stats.setupMilliseconds, stats.rasterMilliseconds);
+
+                if (goldenDir)
+                {
+                    std::string goldenFile = JoinPath(goldenDir, name);
+                    try
+                    {
+                        auto golden = ReadDDS(goldenFile.c_str());
+                        if (golden[0].width != width || golden[0].height != height)
+                        {
+                            printf(", FAILED (golden image is %zux%zu)", golden[0].width, golden[0].height);
+                            ++failures;
+                        }
+                        else
+                        {
+                            double psnr = DirectX::BlockCompression::ComputePSNR(pixels, golden[0].pixels.data(), width, height, width * 4);
+
+                            int maxError = 0;
+                            for (size_t j = 0; j < width * height * 4; ++j)
+                                maxError = std::max(maxError, abs(int(pixels[j]) - int(golden[0].pixels[j])));
+
+                            if (psnr < minPSNR)
+                            {
+                                printf(", FAILED (PSNR %.2f dB, max error %d)", psnr, maxError);
+                                ++failures;
+                            }
+                            else
+                            {
+                                printf(", matches golden (PSNR %.2f dB)", psnr);
+                            }
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        printf(", FAILED (%s: %s)", goldenFile.c_str(), e.what());
+                        ++failures;
+                    }
+                }
+
+                printf("\n");
+            }
+
+            printf("    raster %.2f ms per frame on average, %.2f ms at worst\n", totalRaster / double(frameCount), worstRaster);
+        }
+        catch (const std::exception& e)
+        {
+            printf("\nERROR: %s: %s\n", sceneName, e.what());
+            result = 1;
+        }
+    }
+
+    if (failures)
+    {
+        printf("\n%zu frame(s) did not match their golden images\n", failures);
+        result = 1;
+    }
+
+    return result;
+}
@@ -0,0 +1,261 @@
+//--------------------------------------------------------------------------------------
+// File: AtlasPacker.h
+//
+// Skyline rectangle packer for building texture atlas pages, shared by the command-line
+// tools. Like BlockCompression.h, this header only depends on the C++ standard library.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+
+namespace DirectX
+{
+    namespace AtlasPacking
+    {
+        // Bottom-left skyline packer: the top edge of the packed area is kept as a list of
+        // horizontal segments, and each rectangle goes where its top ends up lowest.
+        class SkylinePacker
+        {
+        public:
+            SkylinePacker(size_t width, size_t height)
+              : mWidth(width),
+                mHeight(height)
+            {
+                Segment segment = { 0, 0, width };
+                mSkyline.push_back(segment);
+            }
+
+            bool Insert(size_t width, size_t height, size_t& x, size_t& y)
+            {
+                size_t bestIndex = mSkyline.size();
+                size_t bestTop = SIZE_MAX;
+                size_t bestWidth = SIZE_MAX;
+
+                for (size_t j = 0; j < mSkyline.size(); ++j)
+                {
+                    size_t top;
+                    if (!Fit(j, width, height, top))
+                        continue;
+
+                    // Lowest top edge, then the narrowest segment to limit wasted space
+                    if (top + height < bestTop || (top + height == bestTop && mSkyline[j].width < bestWidth))
+                    {
+                        bestIndex = j;
+                        bestTop = top + height;
+                        bestWidth = mSkyline[j].width;
+                    }
+                }
+
+                if (bestIndex == mSkyline.size())
+                    return false;
+
+                x = mSkyline[bestIndex].x;
+                y = bestTop - height;
+                AddSegment(bestIndex, x, bestTop, width);
+                return true;
+            }
+
+            // Height of the tallest column used so far.
+            size_t GetUsedHeight() const
+            {
+                size_t used = 0;
+                for (auto& segment : mSkyline)
+                    used = std::max(used, segment.y);
+                return used;
+            }
+
+        private:
+            struct Segment
+            {
+                size_t x;
+                size_t y;
+                size_t width;
+            };
+
+            // Returns the y a rectangle would rest at if its left edge were at segment index.
+            bool Fit(size_t index, size_t width, size_t height, size_t& y) const
+            {
+                if (mSkyline[index].x + width > mWidth)
+                    return false;
+
+                y = 0;
+                size_t remaining = width;
+                for (size_t j = index; remaining > 0; ++j)
+                {
+                    if (j >= mSkyline.size())
+                        return false;
+
+                    y = std::max(y, mSkyline[j].y);
+                    if (y + height > mHeight)
+                        return false;
+
+                    remaining -= std::min(remaining, mSkyline[j].width);
+                }
+
+                return true;
+            }
+
+            void AddSegment(size_t index, size_t x, size_t y, size_t width)
+            {
+                Segment segment = { x, y, width };
+                mSkyline.insert(mSkyline.begin() + ptrdiff_t(index), segment);
+
+                // Trim or remove the segments the new one now covers
+                for (size_t j = index + 1; j < mSkyline.size(); )
+                {
+                    size_t end = mSkyline[j - 1].x + mSkyline[j - 1].width;
+                    if (mSkyline[j].x >= end)
+                        break;
+
+                    size_t shrink = end - mSkyline[j].x;
+                    if (mSkyline[j].width <= shrink)
+                    {
+                        mSkyline.erase(mSkyline.begin() + ptrdiff_t(j));
+                        continue;
+                    }
+
+                    mSkyline[j].x += shrink;
+                    mSkyline[j].width -= shrink;
+                    break;
+                }
+
+                // Merge neighbours at the same height
+                for (size_t j = 1; j < mSkyline.size(); )
+                {
+                    if (mSkyline[j - 1].y == mSkyline[j].y)
+                    {
+                        mSkyline[j - 1].width += mSkyline[j].width;
+                        mSkyline.erase(mSkyline.begin() + ptrdiff_t(j));
+                    }
+                    else
+                    {
+                        ++j;
+                    }
+                }
+            }
+
+            size_t                  mWidth;
+            size_t                  mHeight;
+            std::vector<Segment>    mSkyline;
+        };
+
+
+        // Where each rectangle's content landed; the page is trimmed to the packed area.
+        struct PackResult
+        {
+            size_t              pageWidth;
+            size_t              pageHeight;
+            std::vector<size_t> x;
+            std::vector<size_t> y;
+
+            // Content area over page area.
+            double              efficiency;
+        };
+
+        // Packs rectangles into the smallest page (by area) up to maxSize on a side. Each is
+        // surrounded by padding texels and placed at multiples of alignment, which padding
+        // should also be a multiple of, so mips and compressed blocks stay within one entry.
+        inline bool PackRects(const std::vector<size_t>& widths, const std::vector<size_t>& heights,
+                              size_t padding, size_t alignment, size_t maxSize, PackResult& result)
+        {
+            size_t count = widths.size();
+
+            auto cellSize = [&](size_t size)
+            {
+                return (size + 2 * padding + alignment - 1) / alignment * alignment;
+            };
+
+            // Tallest first packs a skyline tightly
+            std::vector<size_t> order(count);
+            std::iota(order.begin(), order.end(), size_t(0));
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+            {
+                return (heights[a] != heights[b]) ? heights[a] > heights[b] : widths[a] > widths[b];
+            });
+
+            size_t contentArea = 0;
+            size_t cellArea = 0;
+            size_t minWidth = alignment;
+            size_t minHeight = alignment;
+            for (size_t j = 0; j < count; ++j)
+            {
+                contentArea += widths[j] * heights[j];
+                cellArea += cellSize(widths[j]) * cellSize(heights[j]);
+                minWidth = std::max(minWidth, cellSize(widths[j]));
+                minHeight = std::max(minHeight, cellSize(heights[j]));
+            }
+
+            // Candidate power of two pages, smallest first
+            std::vector<std::pair<size_t, size_t>> pages;
+            for (size_t w = 1; w <= maxSize; w *= 2)
+            {
+                for (size_t h = 1; h <= maxSize; h *= 2)
+                {
+                    if (w >= minWidth && h >= minHeight && w * h >= cellArea)
+                        pages.push_back(std::make_pair(w, h));
+                }
+            }
+
+            std::sort(pages.begin(), pages.end(), [](std::pair<size_t, size_t> const& a, std::pair<size_t, size_t> const& b)
+            {
+                size_t areaA = a.first * a.second;
+                size_t areaB = b.first * b.second;
+                if (areaA != areaB)
+                    return areaA < areaB;
+
+                // Prefer wide pages, which suit the skyline
+                return a.first > b.first;
+            });
+
+            for (auto& page : pages)
+            {
+                SkylinePacker packer(page.first, page.second);
+
+                result.x.assign(count, 0);
+                result.y.assign(count, 0);
+
+                bool fits = true;
+                size_t usedWidth = 0;
+                for (auto j : order)
+                {
+                    size_t x, y;
+                    if (!packer.Insert(cellSize(widths[j]), cellSize(heights[j]), x, y))
+                    {
+                        fits = false;
+                        break;
+                    }
+
+                    result.x[j] = x + padding;
+                    result.y[j] = y + padding;
+                    usedWidth = std::max(usedWidth, x + cellSize(widths[j]));
+                }
+
+                if (fits)
+                {
+                    result.pageWidth = usedWidth;
+                    result.pageHeight = packer.GetUsedHeight();
+                    result.efficiency = double(contentArea) / double(result.pageWidth * result.pageHeight);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+    }
+}
@@ -90,3 +90,52 @@ HRESULT BinaryReader::ReadEntireFile(_In_z_ wchar_t const* fileName, _Inout_ std
     
     return S_OK;
 }
+
+
+// Maps the file into memory.
+HRESULT BinaryReader::MapEntireFile(_In_z_ wchar_t const* fileName, _Inout_ ScopedMappedView& view, _Out_ size_t* dataSize)
+{
+    // Open the file.
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile(safe_handle(CreateFile2(fileName, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)));
+#endif
+
+    if (!hFile)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    // Get the file size.
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // File is too big for a 32-bit view, so reject it. Empty files can't be mapped at all.
+    if (fileInfo.EndOfFile.HighPart > 0 || fileInfo.EndOfFile.LowPart == 0)
+        return E_FAIL;
+
+    // Map the whole file. The view keeps its own reference to the mapping, so both handles can be closed.
+#if !defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP)
+    ScopedHandle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+#else
+    ScopedHandle hMapping(CreateFileMappingFromApp(hFile.get(), nullptr, PAGE_READONLY, 0, nullptr));
+#endif
+
+    if (!hMapping)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+#if !defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP)
+    view.reset(MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0));
+#else
+    view.reset(MapViewOfFileFromApp(hMapping.get(), FILE_MAP_READ, 0, 0));
+#endif
+
+    if (!view)
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    *dataSize = fileInfo.EndOfFile.LowPart;
+
+    return S_OK;
+}
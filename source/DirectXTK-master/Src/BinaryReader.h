@@ -64,6 +64,10 @@ namespace DirectX
         // Lower level helper reads directly from the filesystem into memory.
         static HRESULT ReadEntireFile(_In_z_ wchar_t const* fileName, _Inout_ std::unique_ptr<uint8_t[]>& data, _Out_ size_t* dataSize);
 
+        // Maps a read-only view of the whole file instead of copying it. The view starts on a page
+        // boundary, and stays valid after the file is closed until it is unmapped.
+        static HRESULT MapEntireFile(_In_z_ wchar_t const* fileName, _Inout_ ScopedMappedView& view, _Out_ size_t* dataSize);
+
 
     private:
         // The data currently being read.
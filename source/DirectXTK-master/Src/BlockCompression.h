@@ -0,0 +1,764 @@
+//--------------------------------------------------------------------------------------
+// File: BlockCompression.h
+//
+// CPU encoder and decoder for the BC1, BC3, BC4 and BC5 block-compressed formats, for
+// content tools and for checking DDS data on machines without a GPU. This header only
+// depends on the C++ standard library (and SSE2 where available) so that it can also be
+// used by the command-line tools on other platforms.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define DIRECTX_BC_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace DirectX
+{
+    namespace BlockCompression
+    {
+        enum Format
+        {
+            BC1,        // RGB + 1-bit alpha, 8 bytes per block
+            BC3,        // RGB + interpolated alpha, 16 bytes per block
+            BC4,        // R, 8 bytes per block
+            BC5,        // RG, 16 bytes per block
+        };
+
+        inline size_t BlockSize(Format format)
+        {
+            return (format == BC1 || format == BC4) ? 8 : 16;
+        }
+
+        // The 16 texels of a 4x4 block with one array per channel, all in the 0..255 range.
+        struct alignas(16) Block
+        {
+            float r[16];
+            float g[16];
+            float b[16];
+            float a[16];
+        };
+
+        namespace Internal
+        {
+            const float OpaqueThreshold = 128.f;
+
+            inline uint16_t To565(const float c[3])
+            {
+                unsigned r = unsigned(std::min(std::max(c[0], 0.f), 255.f) * 31.f / 255.f + 0.5f);
+                unsigned g = unsigned(std::min(std::max(c[1], 0.f), 255.f) * 63.f / 255.f + 0.5f);
+                unsigned b = unsigned(std::min(std::max(c[2], 0.f), 255.f) * 31.f / 255.f + 0.5f);
+                return uint16_t((r << 11) | (g << 5) | b);
+            }
+
+            inline void From565(uint16_t v, float c[3])
+            {
+                unsigned r = (v >> 11) & 31;
+                unsigned g = (v >> 5) & 63;
+                unsigned b = v & 31;
+                c[0] = float((r << 3) | (r >> 2));
+                c[1] = float((g << 2) | (g >> 4));
+                c[2] = float((b << 3) | (b >> 2));
+            }
+
+            // The color of a transparent texel is never seen, so pull each color towards the
+            // block's alpha-weighted mean in proportion to its transparency before fitting.
+            inline void WeightByAlpha(const Block& block, Block& result)
+            {
+                float mean[3] = {};
+                float total = 0.f;
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    mean[0] += block.r[j] * block.a[j];
+                    mean[1] += block.g[j] * block.a[j];
+                    mean[2] += block.b[j] * block.a[j];
+                    total += block.a[j];
+                }
+
+                result = block;
+
+                if (total <= 0.f || total >= 16.f * 255.f)
+                    return;
+
+                for (size_t c = 0; c < 3; ++c)
+                    mean[c] /= total;
+
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    float t = block.a[j] / 255.f;
+                    result.r[j] = mean[0] + (block.r[j] - mean[0]) * t;
+                    result.g[j] = mean[1] + (block.g[j] - mean[1]) * t;
+                    result.b[j] = mean[2] + (block.b[j] - mean[2]) * t;
+                }
+            }
+
+            // Endpoints along the principal axis (by power iteration) of the texels with a non-zero mask.
+            inline void ColorEndpoints(const Block& block, const float mask[16], float e0[3], float e1[3])
+            {
+                float mean[3] = {};
+                float count = 0.f;
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    mean[0] += block.r[j] * mask[j];
+                    mean[1] += block.g[j] * mask[j];
+                    mean[2] += block.b[j] * mask[j];
+                    count += mask[j];
+                }
+
+                for (size_t c = 0; c < 3; ++c)
+                    mean[c] /= count;
+
+                float cov[6] = {};
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    float r = (block.r[j] - mean[0]) * mask[j];
+                    float g = (block.g[j] - mean[1]) * mask[j];
+                    float b = (block.b[j] - mean[2]) * mask[j];
+                    cov[0] += r * r;
+                    cov[1] += r * g;
+                    cov[2] += r * b;
+                    cov[3] += g * g;
+                    cov[4] += g * b;
+                    cov[5] += b * b;
+                }
+
+                float axis[3] = { 1.f, 1.f, 1.f };
+                for (size_t iter = 0; iter < 8; ++iter)
+                {
+                    float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+                    float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+                    float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+
+                    float len = std::max(fabsf(x), std::max(fabsf(y), fabsf(z)));
+                    if (len < 1e-6f)
+                        break;
+
+                    axis[0] = x / len;
+                    axis[1] = y / len;
+                    axis[2] = z / len;
+                }
+
+                float len = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+                for (size_t c = 0; c < 3; ++c)
+                    axis[c] /= len;
+
+                float tmin = 0.f, tmax = 0.f;
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    if (mask[j] == 0.f)
+                        continue;
+
+                    float t = (block.r[j] - mean[0]) * axis[0] + (block.g[j] - mean[1]) * axis[1] + (block.b[j] - mean[2]) * axis[2];
+                    tmin = std::min(tmin, t);
+                    tmax = std::max(tmax, t);
+                }
+
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    e0[c] = mean[c] + axis[c] * tmax;
+                    e1[c] = mean[c] + axis[c] * tmin;
+                }
+            }
+
+            // Least-squares endpoints for fixed interpolation weights (Castano, "High Quality DXT Compression").
+            inline bool RefineColorEndpoints(const Block& block, const float mask[16], const float weights[16], float e0[3], float e1[3])
+            {
+                float aa = 0.f, bb = 0.f, ab = 0.f;
+                float ax[3] = {}, bx[3] = {};
+
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    float b = weights[j] * mask[j];
+                    float a = (1.f - weights[j]) * mask[j];
+                    aa += a * a;
+                    bb += b * b;
+                    ab += a * b;
+                    ax[0] += a * block.r[j];
+                    ax[1] += a * block.g[j];
+                    ax[2] += a * block.b[j];
+                    bx[0] += b * block.r[j];
+                    bx[1] += b * block.g[j];
+                    bx[2] += b * block.b[j];
+                }
+
+                float det = aa * bb - ab * ab;
+                if (fabsf(det) < 1e-6f)
+                    return false;
+
+                float inv = 1.f / det;
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    e0[c] = (ax[c] * bb - bx[c] * ab) * inv;
+                    e1[c] = (bx[c] * aa - ax[c] * ab) * inv;
+                }
+
+                return true;
+            }
+
+            // Nearest palette entry for each texel; returns the summed squared error of the masked texels.
+            inline float FitColorIndices(const Block& block, const float mask[16], const float palette[4][3], size_t paletteCount, uint8_t indices[16])
+            {
+            #if defined(DIRECTX_BC_USE_SSE2)
+                __m128 total = _mm_setzero_ps();
+                for (size_t j = 0; j < 16; j += 4)
+                {
+                    __m128 r = _mm_load_ps(&block.r[j]);
+                    __m128 g = _mm_load_ps(&block.g[j]);
+                    __m128 b = _mm_load_ps(&block.b[j]);
+
+                    __m128 best = _mm_set1_ps(1e30f);
+                    __m128 bestIndex = _mm_setzero_ps();
+                    for (size_t i = 0; i < paletteCount; ++i)
+                    {
+                        __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[i][0]));
+                        __m128 dg = _mm_sub_ps(g, _mm_set1_ps(palette[i][1]));
+                        __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[i][2]));
+                        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+
+                        __m128 closer = _mm_cmplt_ps(d, best);
+                        best = _mm_min_ps(d, best);
+                        bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(float(i))), _mm_andnot_ps(closer, bestIndex));
+                    }
+
+                    total = _mm_add_ps(total, _mm_mul_ps(best, _mm_loadu_ps(&mask[j])));
+
+                    __m128i index = _mm_cvttps_epi32(bestIndex);
+                    alignas(16) int32_t lanes[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), index);
+                    for (size_t k = 0; k < 4; ++k)
+                        indices[j + k] = uint8_t(lanes[k]);
+                }
+
+                alignas(16) float sums[4];
+                _mm_store_ps(sums, total);
+                return sums[0] + sums[1] + sums[2] + sums[3];
+            #else
+                float error = 0.f;
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    float best = 1e30f;
+                    uint8_t bestIndex = 0;
+                    for (size_t i = 0; i < paletteCount; ++i)
+                    {
+                        float dr = block.r[j] - palette[i][0];
+                        float dg = block.g[j] - palette[i][1];
+                        float db = block.b[j] - palette[i][2];
+                        float d = dr * dr + dg * dg + db * db;
+                        if (d < best)
+                        {
+                            best = d;
+                            bestIndex = uint8_t(i);
+                        }
+                    }
+
+                    indices[j] = bestIndex;
+                    error += best * mask[j];
+                }
+                return error;
+            #endif
+            }
+
+            // BC1 palette and fit for a pair of endpoints; three-color mode reserves index 3 for transparent texels.
+            inline float FitBC1(const Block& block, const float mask[16], uint16_t c0, uint16_t c1, bool threeColor, uint8_t indices[16], float weights[16])
+            {
+                static const float s_weights4[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+                static const float s_weights3[4] = { 0.f, 1.f, 0.5f, 0.f };
+
+                float palette[4][3];
+                From565(c0, palette[0]);
+                From565(c1, palette[1]);
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    if (threeColor)
+                    {
+                        palette[2][c] = (palette[0][c] + palette[1][c]) * 0.5f;
+                    }
+                    else
+                    {
+                        palette[2][c] = (2.f * palette[0][c] + palette[1][c]) / 3.f;
+                        palette[3][c] = (palette[0][c] + 2.f * palette[1][c]) / 3.f;
+                    }
+                }
+
+                float error = FitColorIndices(block, mask, palette, threeColor ? 3 : 4, indices);
+
+                const float* table = threeColor ? s_weights3 : s_weights4;
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    if (mask[j] == 0.f)
+                        indices[j] = 3;
+                    weights[j] = table[indices[j]];
+                }
+
+                return error;
+            }
+
+            // Nearest palette entry for each value; returns the summed squared error.
+            inline float FitBC4Indices(const float values[16], const float palette[8], uint8_t indices[16])
+            {
+            #if defined(DIRECTX_BC_USE_SSE2)
+                __m128 total = _mm_setzero_ps();
+                for (size_t j = 0; j < 16; j += 4)
+                {
+                    __m128 v = _mm_loadu_ps(&values[j]);
+
+                    __m128 best = _mm_set1_ps(1e30f);
+                    __m128 bestIndex = _mm_setzero_ps();
+                    for (size_t i = 0; i < 8; ++i)
+                    {
+                        __m128 d = _mm_sub_ps(v, _mm_set1_ps(palette[i]));
+                        d = _mm_mul_ps(d, d);
+
+                        __m128 closer = _mm_cmplt_ps(d, best);
+                        best = _mm_min_ps(d, best);
+                        bestIndex = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(float(i))), _mm_andnot_ps(closer, bestIndex));
+                    }
+
+                    total = _mm_add_ps(total, best);
+
+                    alignas(16) int32_t lanes[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvttps_epi32(bestIndex));
+                    for (size_t k = 0; k < 4; ++k)
+                        indices[j + k] = uint8_t(lanes[k]);
+                }
+
+                alignas(16) float sums[4];
+                _mm_store_ps(sums, total);
+                return sums[0] + sums[1] + sums[2] + sums[3];
+            #else
+                float error = 0.f;
+                for (size_t j = 0; j < 16; ++j)
+                {
+                    float best = 1e30f;
+                    uint8_t bestIndex = 0;
+                    for (size_t i = 0; i < 8; ++i)
+                    {
+                        float d = values[j] - palette[i];
+                        d *= d;
+                        if (d < best)
+                        {
+                            best = d;
+                            bestIndex = uint8_t(i);
+                        }
+                    }
+
+                    indices[j] = bestIndex;
+                    error += best;
+                }
+                return error;
+            #endif
+            }
+
+            // Palette as decoded by the hardware: 8 interpolated values if e0 > e1, otherwise 6 plus 0 and 255.
+            inline void BC4Palette(unsigned e0, unsigned e1, float palette[8])
+            {
+                palette[0] = float(e0);
+                palette[1] = float(e1);
+                if (e0 > e1)
+                {
+                    for (unsigned i = 1; i < 7; ++i)
+                        palette[i + 1] = float((7 - i) * e0 + i * e1) / 7.f;
+                }
+                else
+                {
+                    for (unsigned i = 1; i < 5; ++i)
+                        palette[i + 1] = float((5 - i) * e0 + i * e1) / 5.f;
+                    palette[6] = 0.f;
+                    palette[7] = 255.f;
+                }
+            }
+
+            inline float FitBC4(const float values[16], unsigned e0, unsigned e1, uint8_t indices[16])
+            {
+                float palette[8];
+                BC4Palette(e0, e1, palette);
+                return FitBC4Indices(values, palette, indices);
+            }
+
+            inline uint8_t ToByte(float v)
+            {
+                return uint8_t(std::min(std::max(v, 0.f), 255.f) + 0.5f);
+            }
+        }
+
+
+        //------------------------------------------------------------------------------
+        // Single blocks
+        //------------------------------------------------------------------------------
+
+        // Fills a block from 8-bit RGBA texels; blocks that overhang the image replicate its edge.
+        inline void LoadBlock(const uint8_t* rgba, size_t rowPitch, size_t width, size_t height, size_t bx, size_t by, Block& block)
+        {
+            for (size_t y = 0; y < 4; ++y)
+            {
+                const uint8_t* row = rgba + std::min(by * 4 + y, height - 1) * rowPitch;
+                for (size_t x = 0; x < 4; ++x)
+                {
+                    const uint8_t* texel = row + std::min(bx * 4 + x, width - 1) * 4;
+                    size_t j = y * 4 + x;
+                    block.r[j] = float(texel[0]);
+                    block.g[j] = float(texel[1]);
+                    block.b[j] = float(texel[2]);
+                    block.a[j] = float(texel[3]);
+                }
+            }
+        }
+
+        // Texels with alpha below 128 are encoded as transparent using the three-color mode,
+        // unless allowTransparent is false (as for the color part of BC3).
+        inline void EncodeBC1(const Block& block, uint8_t* out, bool allowTransparent = true)
+        {
+            float mask[16];
+            bool threeColor = false;
+            float count = 0.f;
+            for (size_t j = 0; j < 16; ++j)
+            {
+                bool opaque = !allowTransparent || block.a[j] >= Internal::OpaqueThreshold;
+                mask[j] = opaque ? 1.f : 0.f;
+                threeColor |= !opaque;
+                count += mask[j];
+            }
+
+            uint16_t c0 = 0, c1 = 0;
+            uint8_t indices[16];
+            float weights[16];
+
+            if (count == 0.f)
+            {
+                memset(indices, 3, sizeof(indices));
+            }
+            else
+            {
+                float e0[3], e1[3];
+                Internal::ColorEndpoints(block, mask, e0, e1);
+
+                c0 = Internal::To565(e0);
+                c1 = Internal::To565(e1);
+                float error = Internal::FitBC1(block, mask, c0, c1, threeColor, indices, weights);
+
+                for (size_t iter = 0; iter < 2 && error > 0.f; ++iter)
+                {
+                    if (!Internal::RefineColorEndpoints(block, mask, weights, e0, e1))
+                        break;
+
+                    uint16_t n0 = Internal::To565(e0);
+                    uint16_t n1 = Internal::To565(e1);
+
+                    uint8_t nindices[16];
+                    float nweights[16];
+                    float nerror = Internal::FitBC1(block, mask, n0, n1, threeColor, nindices, nweights);
+                    if (nerror >= error)
+                        break;
+
+                    c0 = n0;
+                    c1 = n1;
+                    error = nerror;
+                    memcpy(indices, nindices, sizeof(indices));
+                    memcpy(weights, nweights, sizeof(weights));
+                }
+
+                // color0 > color1 selects the four-color mode, color0 <= color1 the three-color one
+                if (threeColor ? (c0 > c1) : (c0 < c1))
+                {
+                    std::swap(c0, c1);
+                    for (size_t j = 0; j < 16; ++j)
+                    {
+                        if (indices[j] < 2 || !threeColor)
+                            indices[j] ^= 1;
+                    }
+                }
+                else if (!threeColor && c0 == c1)
+                {
+                    memset(indices, 0, sizeof(indices));
+                }
+            }
+
+            uint32_t bits = 0;
+            for (size_t j = 0; j < 16; ++j)
+                bits |= uint32_t(indices[j]) << (j * 2);
+
+            out[0] = uint8_t(c0);
+            out[1] = uint8_t(c0 >> 8);
+            out[2] = uint8_t(c1);
+            out[3] = uint8_t(c1 >> 8);
+            out[4] = uint8_t(bits);
+            out[5] = uint8_t(bits >> 8);
+            out[6] = uint8_t(bits >> 16);
+            out[7] = uint8_t(bits >> 24);
+        }
+
+        // Encodes 16 values in the 0..255 range, trying both the 8-value and the 6-value (with 0 and 255) modes.
+        inline void EncodeBC4(const float values[16], uint8_t* out)
+        {
+            float vmin = 255.f, vmax = 0.f;
+            float inner0 = 255.f, inner1 = 0.f;
+            for (size_t j = 0; j < 16; ++j)
+            {
+                vmin = std::min(vmin, values[j]);
+                vmax = std::max(vmax, values[j]);
+                if (values[j] > 0.5f && values[j] < 254.5f)
+                {
+                    inner0 = std::min(inner0, values[j]);
+                    inner1 = std::max(inner1, values[j]);
+                }
+            }
+
+            unsigned e0 = Internal::ToByte(vmax);
+            unsigned e1 = Internal::ToByte(vmin);
+
+            uint8_t indices[16];
+            float error = 0.f;
+
+            if (e0 == e1)
+            {
+                memset(indices, 0, sizeof(indices));
+            }
+            else
+            {
+                error = Internal::FitBC4(values, e0, e1, indices);
+
+                if (inner0 <= inner1 && error > 0.f)
+                {
+                    unsigned s0 = Internal::ToByte(inner0);
+                    unsigned s1 = Internal::ToByte(inner1);
+
+                    uint8_t sindices[16];
+                    float serror = Internal::FitBC4(values, s0, s1, sindices);
+                    if (serror < error)
+                    {
+                        e0 = s0;
+                        e1 = s1;
+                        memcpy(indices, sindices, sizeof(indices));
+                    }
+                }
+            }
+
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 16; ++j)
+                bits |= uint64_t(indices[j]) << (j * 3);
+
+            out[0] = uint8_t(e0);
+            out[1] = uint8_t(e1);
+            for (size_t j = 0; j < 6; ++j)
+                out[2 + j] = uint8_t(bits >> (j * 8));
+        }
+
+        inline void EncodeBC3(const Block& block, uint8_t* out)
+        {
+            EncodeBC4(block.a, out);
+
+            Block weighted;
+            Internal::WeightByAlpha(block, weighted);
+            EncodeBC1(weighted, out + 8, false);
+        }
+
+        inline void EncodeBC5(const Block& block, uint8_t* out)
+        {
+            EncodeBC4(block.r, out);
+            EncodeBC4(block.g, out + 8);
+        }
+
+        // Decoders write a 4x4 block of 8-bit RGBA texels, 16 bytes per row.
+        inline void DecodeBC1(const uint8_t* in, uint8_t* rgba, bool forceFourColor = false)
+        {
+            uint16_t c0 = uint16_t(in[0] | (in[1] << 8));
+            uint16_t c1 = uint16_t(in[2] | (in[3] << 8));
+            uint32_t bits = uint32_t(in[4]) | (uint32_t(in[5]) << 8) | (uint32_t(in[6]) << 16) | (uint32_t(in[7]) << 24);
+
+            float e0[3], e1[3];
+            Internal::From565(c0, e0);
+            Internal::From565(c1, e1);
+
+            uint8_t palette[4][4];
+            for (size_t c = 0; c < 3; ++c)
+            {
+                palette[0][c] = uint8_t(e0[c]);
+                palette[1][c] = uint8_t(e1[c]);
+                if (forceFourColor || c0 > c1)
+                {
+                    palette[2][c] = Internal::ToByte((2.f * e0[c] + e1[c]) / 3.f);
+                    palette[3][c] = Internal::ToByte((e0[c] + 2.f * e1[c]) / 3.f);
+                }
+                else
+                {
+                    palette[2][c] = Internal::ToByte((e0[c] + e1[c]) * 0.5f);
+                    palette[3][c] = 0;
+                }
+            }
+            palette[0][3] = palette[1][3] = palette[2][3] = 255;
+            palette[3][3] = (forceFourColor || c0 > c1) ? 255 : 0;
+
+            for (size_t j = 0; j < 16; ++j)
+                memcpy(rgba + j * 4, palette[(bits >> (j * 2)) & 3], 4);
+        }
+
+        // Decodes 16 values into every stride-th byte of out.
+        inline void DecodeBC4(const uint8_t* in, uint8_t* out, size_t stride)
+        {
+            float values[8];
+            Internal::BC4Palette(in[0], in[1], values);
+
+            uint8_t palette[8];
+            for (size_t i = 0; i < 8; ++i)
+                palette[i] = Internal::ToByte(values[i]);
+
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 6; ++j)
+                bits |= uint64_t(in[2 + j]) << (j * 8);
+
+            for (size_t j = 0; j < 16; ++j)
+                out[j * stride] = palette[(bits >> (j * 3)) & 7];
+        }
+
+        inline void DecodeBC3(const uint8_t* in, uint8_t* rgba)
+        {
+            DecodeBC1(in + 8, rgba, true);
+            DecodeBC4(in, rgba + 3, 4);
+        }
+
+        inline void DecodeBC4(const uint8_t* in, uint8_t* rgba)
+        {
+            for (size_t j = 0; j < 16; ++j)
+            {
+                rgba[j * 4 + 1] = rgba[j * 4 + 2] = 0;
+                rgba[j * 4 + 3] = 255;
+            }
+            DecodeBC4(in, rgba, 4);
+        }
+
+        inline void DecodeBC5(const uint8_t* in, uint8_t* rgba)
+        {
+            DecodeBC4(in, rgba);
+            DecodeBC4(in + 8, rgba + 1, 4);
+        }
+
+
+        //------------------------------------------------------------------------------
+        // Whole surfaces, with block rows spread over threadCount threads (0 for one per core)
+        //------------------------------------------------------------------------------
+        namespace Internal
+        {
+            template<typename TRow>
+            void ForEachBlockRow(size_t blocksHigh, unsigned threadCount, TRow row)
+            {
+                if (!threadCount)
+                    threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+                threadCount = unsigned(std::min<size_t>(threadCount, blocksHigh));
+
+                std::atomic<size_t> next(0);
+                auto worker = [&]()
+                {
+                    for (size_t by = next++; by < blocksHigh; by = next++)
+                        row(by);
+                };
+
+                std::vector<std::thread> threads;
+                for (unsigned j = 1; j < threadCount; ++j)
+                    threads.emplace_back(worker);
+
+                worker();
+
+                for (auto& t : threads)
+                    t.join();
+            }
+        }
+
+        // Encodes an 8-bit RGBA image into tightly packed blocks.
+        inline void Encode(Format format, const uint8_t* rgba, size_t width, size_t height, size_t rowPitch, uint8_t* blocks, unsigned threadCount = 0)
+        {
+            size_t blocksWide = std::max<size_t>(1, (width + 3) / 4);
+            size_t blocksHigh = std::max<size_t>(1, (height + 3) / 4);
+            size_t blockSize = BlockSize(format);
+
+            Internal::ForEachBlockRow(blocksHigh, threadCount, [&](size_t by)
+            {
+                uint8_t* dest = blocks + by * blocksWide * blockSize;
+                for (size_t bx = 0; bx < blocksWide; ++bx, dest += blockSize)
+                {
+                    Block block;
+                    LoadBlock(rgba, rowPitch, width, height, bx, by, block);
+
+                    switch (format)
+                    {
+                    case BC1: EncodeBC1(block, dest); break;
+                    case BC3: EncodeBC3(block, dest); break;
+                    case BC4: EncodeBC4(block.r, dest); break;
+                    case BC5: EncodeBC5(block, dest); break;
+                    }
+                }
+            });
+        }
+
+        // Decodes tightly packed blocks into an 8-bit RGBA image.
+        inline void Decode(Format format, const uint8_t* blocks, size_t width, size_t height, uint8_t* rgba, size_t rowPitch, unsigned threadCount = 0)
+        {
+            size_t blocksWide = std::max<size_t>(1, (width + 3) / 4);
+            size_t blocksHigh = std::max<size_t>(1, (height + 3) / 4);
+            size_t blockSize = BlockSize(format);
+
+            Internal::ForEachBlockRow(blocksHigh, threadCount, [&](size_t by)
+            {
+                const uint8_t* src = blocks + by * blocksWide * blockSize;
+                for (size_t bx = 0; bx < blocksWide; ++bx, src += blockSize)
+                {
+                    uint8_t texels[64];
+                    switch (format)
+                    {
+                    case BC1: DecodeBC1(src, texels); break;
+                    case BC3: DecodeBC3(src, texels); break;
+                    case BC4: DecodeBC4(src, texels); break;
+                    case BC5: DecodeBC5(src, texels); break;
+                    }
+
+                    size_t rows = std::min<size_t>(4, height - by * 4);
+                    size_t columns = std::min<size_t>(4, width - bx * 4);
+                    for (size_t y = 0; y < rows; ++y)
+                        memcpy(rgba + (by * 4 + y) * rowPitch + bx * 16, texels + y * 16, columns * 4);
+                }
+            });
+        }
+
+        // Peak signal-to-noise ratio in dB over the first channelCount channels of two 8-bit RGBA images.
+        inline double ComputePSNR(const uint8_t* a, const uint8_t* b, size_t width, size_t height, size_t rowPitch, size_t channelCount = 4)
+        {
+            double sum = 0.0;
+            for (size_t y = 0; y < height; ++y)
+            {
+                const uint8_t* ra = a + y * rowPitch;
+                const uint8_t* rb = b + y * rowPitch;
+                for (size_t x = 0; x < width; ++x)
+                {
+                    for (size_t c = 0; c < channelCount; ++c)
+                    {
+                        double d = double(ra[x * 4 + c]) - double(rb[x * 4 + c]);
+                        sum += d * d;
+                    }
+                }
+            }
+
+            double mse = sum / double(width * height * channelCount);
+            return (mse > 0.0) ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+        }
+    }
+}
@@ -63,71 +63,50 @@ namespace
         theight = 0;
         tdepth = 0;
 
-        size_t NumBytes = 0;
-        size_t RowBytes = 0;
-        const uint8_t* pSrcBits = bitData;
-        const uint8_t* pEndBits = bitData + bitSize;
+        // Array items share one mip layout, so it is only computed once
+        auto layout = GetDDSSubresourceLayout(width, height, depth, mipCount, format);
 
-        size_t index = 0;
-        for (size_t j = 0; j < arraySize; j++)
+        if (arraySize && layout->itemSize > bitSize / arraySize)
+        {
+            return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+        }
+
+        // Mips only shrink, so the ones kept are those after any that exceed maxsize
+        if ((mipCount > 1) && maxsize)
         {
-            size_t w = width;
-            size_t h = height;
-            size_t d = depth;
-            for (size_t i = 0; i < mipCount; i++)
+            while (skipMip < mipCount)
             {
-                GetSurfaceInfo(w,
-                    h,
-                    format,
-                    &NumBytes,
-                    &RowBytes,
-                    nullptr
-                );
-
-                if ((mipCount <= 1) || !maxsize || (w <= maxsize && h <= maxsize && d <= maxsize))
-                {
-                    if (!twidth)
-                    {
-                        twidth = w;
-                        theight = h;
-                        tdepth = d;
-                    }
+                auto& mip = layout->mips[skipMip];
+                if (mip.width <= maxsize && mip.height <= maxsize && mip.depth <= maxsize)
+                    break;
 
-                    assert(index < mipCount * arraySize);
-                    _Analysis_assume_(index < mipCount * arraySize);
-                    initData[index].pSysMem = reinterpret_cast<const void*>(pSrcBits);
-                    initData[index].SysMemPitch = static_cast<UINT>(RowBytes);
-                    initData[index].SysMemSlicePitch = static_cast<UINT>(NumBytes);
-                    ++index;
-                }
-                else if (!j)
-                {
-                    // Count number of skipped mipmaps (first item only)
-                    ++skipMip;
-                }
+                ++skipMip;
+            }
+        }
 
-                if (pSrcBits + (NumBytes*d) > pEndBits)
-                {
-                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
-                }
+        if (skipMip >= mipCount)
+        {
+            return E_FAIL;
+        }
 
-                pSrcBits += NumBytes * d;
+        twidth = layout->mips[skipMip].width;
+        theight = layout->mips[skipMip].height;
+        tdepth = layout->mips[skipMip].depth;
 
-                w = w >> 1;
-                h = h >> 1;
-                d = d >> 1;
-                if (w == 0)
-                {
-                    w = 1;
-                }
-                if (h == 0)
-                {
-                    h = 1;
-                }
-                if (d == 0)
-                {
-                    d = 1;
-                }
+        size_t index = 0;
+        for (size_t j = 0; j < arraySize; j++)
+        {
+            const uint8_t* pItemBits = bitData + j * layout->itemSize;
+            for (size_t i = skipMip; i < mipCount; i++)
+            {
+                auto& mip = layout->mips[i];
+
+                assert(index < mipCount * arraySize);
+                _Analysis_assume_(index < mipCount * arraySize);
+                initData[index].pSysMem = reinterpret_cast<const void*>(pItemBits + mip.offset);
+                initData[index].SysMemPitch = static_cast<UINT>(mip.rowPitch);
+                initData[index].SysMemSlicePitch = static_cast<UINT>(mip.slicePitch);
+                ++index;
             }
         }
 
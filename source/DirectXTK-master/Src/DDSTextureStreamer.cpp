@@ -0,0 +1,481 @@
+//--------------------------------------------------------------------------------------
+// File: DDSTextureStreamer.cpp
+//
+// Progressive loading of DDS textures: only the header and the low resolution mips are
+// read when a texture is created, and the larger mips stream in later under a per-frame
+// byte budget, with sampling clamped to the mips that have arrived.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "DDSTextureStreamer.h"
+
+#include "DirectXHelpers.h"
+#include "PlatformHelpers.h"
+#include "LoaderHelpers.h"
+
+using namespace DirectX;
+using namespace DirectX::LoaderHelpers;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    HRESULT ReadFileRange(_In_ HANDLE hFile, size_t offset, size_t size, _Out_writes_bytes_(size) uint8_t* dest)
+    {
+        LARGE_INTEGER position;
+        position.QuadPart = static_cast<LONGLONG>(offset);
+        if (!SetFilePointerEx(hFile, position, nullptr, FILE_BEGIN))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        DWORD bytesRead = 0;
+        if (!ReadFile(hFile, dest, static_cast<DWORD>(size), &bytesRead, nullptr))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        return (bytesRead == size) ? S_OK : HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+    }
+}
+
+
+// Internal DDSTextureStreamer implementation class.
+class DDSTextureStreamer::Impl
+{
+public:
+    explicit Impl(_In_ ID3D11Device* device)
+      : mDevice(device),
+        mBudget(1024 * 1024)
+    { }
+
+    HRESULT CreateTexture(_In_ ID3D11DeviceContext* d3dContext, _In_z_ const wchar_t* fileName, size_t tailSize, bool forceSRGB,
+                          _Outptr_opt_ ID3D11Resource** texture, _Outptr_opt_ ID3D11ShaderResourceView** textureView);
+    size_t Update(_In_ ID3D11DeviceContext* d3dContext);
+
+    void Clear()
+    {
+        mStreaming.clear();
+    }
+
+    ComPtr<ID3D11Device> mDevice;
+    size_t mBudget;
+
+private:
+    // A texture whose larger mips are still to be read from the file.
+    struct StreamingTexture
+    {
+        ScopedHandle                        file;
+        ComPtr<ID3D11Texture2D>             texture;
+        std::vector<DDSSubresourceRange>    ranges;
+        size_t                              mipCount;
+        size_t                              residentMip;    // Most detailed mip uploaded so far
+
+        size_t MipBytes(size_t mip) const
+        {
+            size_t bytes = 0;
+            for (auto& range : ranges)
+            {
+                if (range.mipLevel == mip)
+                    bytes += range.size;
+            }
+            return bytes;
+        }
+    };
+
+    static HRESULT Upload(_In_ ID3D11DeviceContext* d3dContext, StreamingTexture& streaming, size_t firstMip, size_t endMip);
+
+    std::vector<std::unique_ptr<StreamingTexture>> mStreaming;
+};
+
+
+// Reads mips [firstMip, endMip) of every array item with as few reads as the file layout allows.
+_Use_decl_annotations_
+HRESULT DDSTextureStreamer::Impl::Upload(ID3D11DeviceContext* d3dContext, StreamingTexture& streaming, size_t firstMip, size_t endMip)
+{
+    std::vector<DDSFileRange> reads;
+    PlanDDSReads(streaming.ranges, firstMip, endMip, reads);
+
+    size_t total = 0;
+    for (auto& read : reads)
+        total += read.size;
+
+    std::unique_ptr<uint8_t[]> data(new (std::nothrow) uint8_t[total]);
+    if (!data)
+        return E_OUTOFMEMORY;
+
+    size_t cursor = 0;
+    for (auto& read : reads)
+    {
+        HRESULT hr = ReadFileRange(streaming.file.get(), read.offset, read.size, data.get() + cursor);
+        if (FAILED(hr))
+            return hr;
+
+        cursor += read.size;
+    }
+
+    // The reads follow file order, as do the ranges, so the subresources are packed in the same order
+    cursor = 0;
+    for (auto& range : streaming.ranges)
+    {
+        if (range.mipLevel < firstMip || range.mipLevel >= endMip)
+            continue;
+
+        UINT subresource = D3D11CalcSubresource(static_cast<UINT>(range.mipLevel), static_cast<UINT>(range.arrayIndex), static_cast<UINT>(streaming.mipCount));
+        d3dContext->UpdateSubresource(streaming.texture.Get(), subresource, nullptr, data.get() + cursor,
+                                      static_cast<UINT>(range.rowPitch), static_cast<UINT>(range.slicePitch));
+
+        cursor += range.size;
+    }
+
+    return S_OK;
+}
+
+
+_Use_decl_annotations_
+HRESULT DDSTextureStreamer::Impl::CreateTexture(ID3D11DeviceContext* d3dContext, const wchar_t* fileName, size_t tailSize, bool forceSRGB,
+                                                ID3D11Resource** texture, ID3D11ShaderResourceView** textureView)
+{
+    if (texture)
+    {
+        *texture = nullptr;
+    }
+    if (textureView)
+    {
+        *textureView = nullptr;
+    }
+
+    if (!d3dContext || !fileName || (!texture && !textureView))
+    {
+        return E_INVALIDARG;
+    }
+
+    std::unique_ptr<StreamingTexture> streaming(new StreamingTexture);
+
+    // open the file
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    streaming->file.reset(safe_handle(CreateFile2(fileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        OPEN_EXISTING,
+        nullptr)));
+#else
+    streaming->file.reset(safe_handle(CreateFileW(fileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr)));
+#endif
+
+    if (!streaming->file)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(streaming->file.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // File is too big for 32-bit allocation, so reject read
+    if (fileInfo.EndOfFile.HighPart > 0)
+    {
+        return E_FAIL;
+    }
+
+    size_t fileSize = fileInfo.EndOfFile.LowPart;
+
+    // Read just the headers
+    uint8_t headerData[sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)] = {};
+    if (fileSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
+    {
+        return E_FAIL;
+    }
+
+    HRESULT hr = ReadFileRange(streaming->file.get(), 0, std::min(fileSize, sizeof(headerData)), headerData);
+    if (FAILED(hr))
+        return hr;
+
+    if (*reinterpret_cast<const uint32_t*>(headerData) != DDS_MAGIC)
+    {
+        return E_FAIL;
+    }
+
+    auto header = reinterpret_cast<const DDS_HEADER*>(headerData + sizeof(uint32_t));
+    if (header->size != sizeof(DDS_HEADER) ||
+        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    {
+        return E_FAIL;
+    }
+
+    size_t width = header->width;
+    size_t height = header->height;
+    size_t arraySize = 1;
+    size_t bitOffset = sizeof(uint32_t) + sizeof(DDS_HEADER);
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+
+    size_t mipCount = header->mipMapCount;
+    if (0 == mipCount)
+    {
+        mipCount = 1;
+    }
+
+    // Only 2D textures and texture arrays stream; anything else should use CreateDDSTextureFromFile
+    if ((header->ddspf.flags & DDS_FOURCC) &&
+        (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+    {
+        if (fileSize < sizeof(headerData))
+        {
+            return E_FAIL;
+        }
+
+        auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>(headerData + sizeof(uint32_t) + sizeof(DDS_HEADER));
+
+        if (d3d10ext->resourceDimension != D3D11_RESOURCE_DIMENSION_TEXTURE2D
+            || (d3d10ext->miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE))
+        {
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        }
+
+        arraySize = d3d10ext->arraySize;
+        if (arraySize == 0)
+        {
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        }
+
+        format = d3d10ext->dxgiFormat;
+        bitOffset += sizeof(DDS_HEADER_DXT10);
+    }
+    else
+    {
+        if ((header->flags & DDS_HEADER_FLAGS_VOLUME) || (header->caps2 & DDS_CUBEMAP))
+        {
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        }
+
+        format = GetDXGIFormat(header->ddspf);
+    }
+
+    switch (format)
+    {
+    case DXGI_FORMAT_UNKNOWN:
+    case DXGI_FORMAT_AI44:
+    case DXGI_FORMAT_IA44:
+    case DXGI_FORMAT_P8:
+    case DXGI_FORMAT_A8P8:
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    default:
+        if (BitsPerPixel(format) == 0)
+        {
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+        }
+    }
+
+    // Bound sizes (for security purposes we don't trust DDS file metadata larger than the Direct3D hardware requirements)
+    if ((mipCount > D3D11_REQ_MIP_LEVELS) ||
+        (arraySize > D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
+        (width > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION) ||
+        (height > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION))
+    {
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+    }
+
+    if (forceSRGB)
+    {
+        format = MakeSRGB(format);
+    }
+
+    hr = GetDDSSubresourceRanges(bitOffset, width, height, 1, mipCount, arraySize, format, fileSize, streaming->ranges);
+    if (FAILED(hr))
+        return hr;
+
+    // Pick the first mip that fits within tailSize; resident mip clamping needs Feature Level 10.0
+    size_t tailMip = 0;
+    if (mDevice->GetFeatureLevel() >= D3D_FEATURE_LEVEL_10_0)
+    {
+        while (tailMip + 1 < mipCount
+               && std::max(std::max<size_t>(1, width >> tailMip), std::max<size_t>(1, height >> tailMip)) > tailSize)
+        {
+            ++tailMip;
+        }
+    }
+
+    D3D11_TEXTURE2D_DESC desc;
+    desc.Width = static_cast<UINT>(width);
+    desc.Height = static_cast<UINT>(height);
+    desc.MipLevels = static_cast<UINT>(mipCount);
+    desc.ArraySize = static_cast<UINT>(arraySize);
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.SampleDesc.Quality = 0;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    desc.CPUAccessFlags = 0;
+    desc.MiscFlags = 0;
+
+    hr = mDevice->CreateTexture2D(&desc, nullptr, streaming->texture.GetAddressOf());
+    if (FAILED(hr))
+        return hr;
+
+    streaming->mipCount = mipCount;
+    streaming->residentMip = tailMip;
+
+    // Clamp sampling before any data arrives, then upload the tail
+    d3dContext->SetResourceMinLOD(streaming->texture.Get(), static_cast<FLOAT>(tailMip));
+
+    hr = Upload(d3dContext, *streaming, tailMip, mipCount);
+    if (FAILED(hr))
+        return hr;
+
+    if (textureView)
+    {
+        D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc = {};
+        SRVDesc.Format = format;
+
+        if (arraySize > 1)
+        {
+            SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            SRVDesc.Texture2DArray.MipLevels = static_cast<UINT>(-1);
+            SRVDesc.Texture2DArray.ArraySize = static_cast<UINT>(arraySize);
+        }
+        else
+        {
+            SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+            SRVDesc.Texture2D.MipLevels = static_cast<UINT>(-1);
+        }
+
+        hr = mDevice->CreateShaderResourceView(streaming->texture.Get(), &SRVDesc, textureView);
+        if (FAILED(hr))
+            return hr;
+    }
+
+    if (texture)
+    {
+        *texture = streaming->texture.Get();
+        (*texture)->AddRef();
+    }
+
+    SetDebugObjectName(streaming->texture.Get(), "DDSTextureStreamer");
+
+    if (tailMip > 0)
+    {
+        mStreaming.emplace_back(std::move(streaming));
+    }
+
+    return S_OK;
+}
+
+
+_Use_decl_annotations_
+size_t DDSTextureStreamer::Impl::Update(ID3D11DeviceContext* d3dContext)
+{
+    size_t budget = mBudget;
+    bool first = true;
+
+    while (!mStreaming.empty())
+    {
+        // Bring every texture up a level before any texture gets its largest mips
+        auto next = std::min_element(mStreaming.begin(), mStreaming.end(), [](std::unique_ptr<StreamingTexture> const& a, std::unique_ptr<StreamingTexture> const& b)
+        {
+            return a->MipBytes(a->residentMip - 1) < b->MipBytes(b->residentMip - 1);
+        });
+
+        auto& streaming = **next;
+        size_t mip = streaming.residentMip - 1;
+        size_t bytes = streaming.MipBytes(mip);
+
+        if (!first && bytes > budget)
+            break;
+
+        HRESULT hr = Upload(d3dContext, streaming, mip, mip + 1);
+        if (SUCCEEDED(hr))
+        {
+            streaming.residentMip = mip;
+            d3dContext->SetResourceMinLOD(streaming.texture.Get(), static_cast<FLOAT>(mip));
+        }
+        else
+        {
+            // Leave the texture at the mips it already has
+            DebugTrace("DDSTextureStreamer failed to stream mip %zu (%08X)\n", mip, hr);
+        }
+
+        if (FAILED(hr) || !streaming.residentMip)
+        {
+            mStreaming.erase(next);
+        }
+
+        budget -= std::min(bytes, budget);
+        first = false;
+    }
+
+    return mStreaming.size();
+}
+
+
+// Public constructor.
+_Use_decl_annotations_
+DDSTextureStreamer::DDSTextureStreamer(ID3D11Device* d3dDevice)
+  : pImpl(new Impl(d3dDevice))
+{
+}
+
+
+// Move constructor.
+DDSTextureStreamer::DDSTextureStreamer(DDSTextureStreamer&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+DDSTextureStreamer& DDSTextureStreamer::operator= (DDSTextureStreamer&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+DDSTextureStreamer::~DDSTextureStreamer()
+{
+}
+
+
+_Use_decl_annotations_
+HRESULT DDSTextureStreamer::CreateTexture(ID3D11DeviceContext* d3dContext, const wchar_t* szFileName,
+                                          ID3D11Resource** texture, ID3D11ShaderResourceView** textureView,
+                                          size_t tailSize, bool forceSRGB)
+{
+    return pImpl->CreateTexture(d3dContext, szFileName, tailSize, forceSRGB, texture, textureView);
+}
+
+
+_Use_decl_annotations_
+size_t DDSTextureStreamer::Update(ID3D11DeviceContext* d3dContext)
+{
+    return pImpl->Update(d3dContext);
+}
+
+
+void DDSTextureStreamer::SetUploadBudget(size_t bytesPerUpdate)
+{
+    pImpl->mBudget = bytesPerUpdate;
+}
+
+
+void DDSTextureStreamer::Clear()
+{
+    pImpl->Clear();
+}
@@ -15,6 +15,7 @@
 #include "Effects.h"
 #include "DemandCreate.h"
 #include "SharedResourcePool.h"
+#include "ShardedCache.h"
 
 #include "DDSTextureLoader.h"
 #include "WICTextureLoader.h"
@@ -50,6 +51,8 @@ public:
     void CreatePixelShader( _In_z_ const wchar_t* shader, _Outptr_ ID3D11PixelShader** pixelShader );
 
     void ReleaseCache();
+    IEffectFactory::CacheStatistics GetCacheStatistics() const;
+    void ResetCacheStatistics();
     void SetSharing( bool enabled ) { mSharing = enabled; }
     void EnableForceSRGB(bool forceSRGB) { mForceSRGB = forceSRGB; }
 
@@ -60,9 +63,9 @@ public:
 private:
     ComPtr<ID3D11Device> device;
 
-    typedef std::map< std::wstring, std::shared_ptr<IEffect> > EffectCache;
-    typedef std::map< std::wstring, ComPtr<ID3D11ShaderResourceView> > TextureCache;
-    typedef std::map< std::wstring, ComPtr<ID3D11PixelShader> > ShaderCache;
+    typedef ShardedCache< std::shared_ptr<IEffect> > EffectCache;
+    typedef ShardedCache< ComPtr<ID3D11ShaderResourceView> > TextureCache;
+    typedef ShardedCache< ComPtr<ID3D11PixelShader> > ShaderCache;
 
     EffectCache  mEffectCache;
     EffectCache  mEffectCacheSkinning;
@@ -72,6 +75,7 @@ private:
     bool mSharing;
     bool mForceSRGB;
 
+    // Serializes use of the immediate context for WIC autogen-mipmaps; the caches are locked per shard.
     std::mutex mutex;
 };
 
@@ -90,21 +94,12 @@ std::shared_ptr<IEffect> DGSLEffectFactory::Impl::CreateEffect( DGSLEffectFactor
 
     if ( mSharing && info.name && *info.name )
     {
-        if ( info.enableSkinning )
-        {
-            auto it = mEffectCacheSkinning.find( info.name );
-            if ( it != mEffectCacheSkinning.end() )
-            {
-                return it->second;
-            }
-        }
-        else
+        auto& cache = info.enableSkinning ? mEffectCacheSkinning : mEffectCache;
+
+        std::shared_ptr<IEffect> cached;
+        if ( cache.Find( info.name, cached ) )
         {
-            auto it = mEffectCache.find( info.name );
-            if ( it != mEffectCache.end() )
-            {
-                return it->second;
-            }
+            return cached;
         }
     }
 
@@ -151,15 +146,9 @@ std::shared_ptr<IEffect> DGSLEffectFactory::Impl::CreateEffect( DGSLEffectFactor
 
     if ( mSharing && info.name && *info.name )
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        if ( info.enableSkinning )
-        {
-            mEffectCacheSkinning.insert( EffectCache::value_type( info.name, effect ) );
-        }
-        else
-        {
-            mEffectCache.insert( EffectCache::value_type( info.name, effect ) );
-        }
+        auto& cache = info.enableSkinning ? mEffectCacheSkinning : mEffectCache;
+
+        return cache.Insert( info.name, effect );
     }
 
     return effect;
@@ -171,21 +160,12 @@ std::shared_ptr<IEffect> DGSLEffectFactory::Impl::CreateDGSLEffect( DGSLEffectFa
 {
     if ( mSharing && info.name && *info.name )
     {
-        if ( info.enableSkinning )
-        {
-            auto it = mEffectCacheSkinning.find( info.name );
-            if ( it != mEffectCacheSkinning.end() )
-            {
-                return it->second;
-            }
-        }
-        else
+        auto& cache = info.enableSkinning ? mEffectCacheSkinning : mEffectCache;
+
+        std::shared_ptr<IEffect> cached;
+        if ( cache.Find( info.name, cached ) )
         {
-            auto it = mEffectCache.find( info.name );
-            if ( it != mEffectCache.end() )
-            {
-                return it->second;
-            }
+            return cached;
         }
     }
 
@@ -332,15 +312,9 @@ std::shared_ptr<IEffect> DGSLEffectFactory::Impl::CreateDGSLEffect( DGSLEffectFa
 
     if ( mSharing && info.name && *info.name )
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        if ( info.enableSkinning )
-        {
-            mEffectCacheSkinning.insert( EffectCache::value_type( info.name, effect ) );
-        }
-        else
-        {
-            mEffectCache.insert( EffectCache::value_type( info.name, effect ) );
-        }
+        auto& cache = info.enableSkinning ? mEffectCacheSkinning : mEffectCache;
+
+        return cache.Insert( info.name, effect );
     }
 
     return effect;
@@ -357,13 +331,11 @@ void DGSLEffectFactory::Impl::CreateTexture( const wchar_t* name, ID3D11DeviceCo
     UNREFERENCED_PARAMETER(deviceContext);
 #endif
 
-    auto it = mTextureCache.find( name );
+    ComPtr<ID3D11ShaderResourceView> cached;
 
-    if ( mSharing && it != mTextureCache.end() )
+    if ( mSharing && mTextureCache.Find( name, cached ) )
     {
-        ID3D11ShaderResourceView* srv = it->second.Get();
-        srv->AddRef();
-        *textureView = srv;
+        *textureView = cached.Detach();
     }
     else
     {
@@ -426,10 +398,15 @@ void DGSLEffectFactory::Impl::CreateTexture( const wchar_t* name, ID3D11DeviceCo
             }
         }
 
-        if ( mSharing && *name && it == mTextureCache.end() )
-        {   
-            std::lock_guard<std::mutex> lock(mutex);
-            mTextureCache.insert( TextureCache::value_type( name, *textureView ) );
+        if ( mSharing && *name )
+        {
+            // Another thread may have loaded the same texture meanwhile; hand back the shared copy.
+            cached = mTextureCache.Insert( name, *textureView );
+            if ( cached.Get() != *textureView )
+            {
+                (*textureView)->Release();
+                *textureView = cached.Detach();
+            }
         }
     }
 }
@@ -441,13 +418,11 @@ void DGSLEffectFactory::Impl::CreatePixelShader( const wchar_t* name, ID3D11Pixe
     if ( !name || !pixelShader )
         throw std::exception("invalid arguments");
 
-    auto it = mShaderCache.find( name );
+    ComPtr<ID3D11PixelShader> cached;
 
-    if ( mSharing && it != mShaderCache.end() )
+    if ( mSharing && mShaderCache.Find( name, cached ) )
     {
-        ID3D11PixelShader* ps = it->second.Get();
-        ps->AddRef();
-        *pixelShader = ps;
+        *pixelShader = cached.Detach();
     }
     else
     {
@@ -481,10 +456,14 @@ void DGSLEffectFactory::Impl::CreatePixelShader( const wchar_t* name, ID3D11Pixe
 
         _Analysis_assume_(*pixelShader != 0);
 
-        if ( mSharing && *name && it == mShaderCache.end() )
-        {   
-            std::lock_guard<std::mutex> lock(mutex);
-            mShaderCache.insert( ShaderCache::value_type( name, *pixelShader ) );
+        if ( mSharing && *name )
+        {
+            cached = mShaderCache.Insert( name, *pixelShader );
+            if ( cached.Get() != *pixelShader )
+            {
+                (*pixelShader)->Release();
+                *pixelShader = cached.Detach();
+            }
         }
     }
 }
@@ -492,11 +471,47 @@ void DGSLEffectFactory::Impl::CreatePixelShader( const wchar_t* name, ID3D11Pixe
 
 void DGSLEffectFactory::Impl::ReleaseCache()
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    mEffectCache.clear();
-    mEffectCacheSkinning.clear();
-    mTextureCache.clear();
-    mShaderCache.clear();
+    mEffectCache.Clear();
+    mEffectCacheSkinning.Clear();
+    mTextureCache.Clear();
+    mShaderCache.Clear();
+}
+
+
+IEffectFactory::CacheStatistics DGSLEffectFactory::Impl::GetCacheStatistics() const
+{
+    IEffectFactory::CacheStatistics result = {};
+
+    auto stats = mEffectCache.GetStatistics();
+    result.effectHits = stats.hits;
+    result.effectMisses = stats.misses;
+    result.contentions = stats.contentions;
+
+    stats = mEffectCacheSkinning.GetStatistics();
+    result.effectHits += stats.hits;
+    result.effectMisses += stats.misses;
+    result.contentions += stats.contentions;
+
+    stats = mTextureCache.GetStatistics();
+    result.textureHits = stats.hits;
+    result.textureMisses = stats.misses;
+    result.contentions += stats.contentions;
+
+    stats = mShaderCache.GetStatistics();
+    result.textureHits += stats.hits;
+    result.textureMisses += stats.misses;
+    result.contentions += stats.contentions;
+
+    return result;
+}
+
+
+void DGSLEffectFactory::Impl::ResetCacheStatistics()
+{
+    mEffectCache.ResetStatistics();
+    mEffectCacheSkinning.ResetStatistics();
+    mTextureCache.ResetStatistics();
+    mShaderCache.ResetStatistics();
 }
 
 
@@ -590,4 +605,13 @@ void DGSLEffectFactory::SetDirectory( _In_opt_z_ const wchar_t* path )
     }
     else
         *pImpl->mPath = 0;
-}
\ No newline at end of file
+}
+IEffectFactory::CacheStatistics DGSLEffectFactory::GetCacheStatistics() const
+{
+    return pImpl->GetCacheStatistics();
+}
+
+void DGSLEffectFactory::ResetCacheStatistics()
+{
+    pImpl->ResetCacheStatistics();
+}
@@ -13,12 +13,20 @@
 
 #include "pch.h"
 #include "Effects.h"
+#include "BinaryReader.h"
 #include "DemandCreate.h"
+#include "DirectXHelpers.h"
 #include "SharedResourcePool.h"
+#include "ShardedCache.h"
+#include "TextureCache.h"
 
 #include "DDSTextureLoader.h"
 #include "WICTextureLoader.h"
 
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
 
@@ -34,26 +42,61 @@ public:
         device(device),
         mSharing(true),
         mUseNormalMapEffect(true),
-        mForceSRGB(false)
+        mForceSRGB(false),
+        mLazyTextures(false),
+        mUploadBudget(DefaultUploadBudget),
+        mShutdown(false)
     {}
 
+    ~Impl();
+
     std::shared_ptr<IEffect> CreateEffect( _In_ IEffectFactory* factory, _In_ const IEffectFactory::EffectInfo& info, _In_opt_ ID3D11DeviceContext* deviceContext );
     void CreateTexture( _In_z_ const wchar_t* texture, _In_opt_ ID3D11DeviceContext* deviceContext, _Outptr_ ID3D11ShaderResourceView** textureView );
 
     void ReleaseCache();
+    IEffectFactory::CacheStatistics GetCacheStatistics() const;
+    void ResetCacheStatistics();
     void SetSharing( bool enabled ) { mSharing = enabled; }
     void EnableNormalMapEffect( bool enabled ) { mUseNormalMapEffect = enabled; }
     void EnableForceSRGB(bool forceSRGB) { mForceSRGB = forceSRGB; }
+    void SetTextureCache( std::shared_ptr<DirectX::TextureCache> const& cache ) { mDecodedCache = cache; }
+
+    void EnableLazyTextureLoading( bool enabled ) { mLazyTextures = enabled; }
+    void SetTextureUploadBudget( size_t bytesPerFrame ) { mUploadBudget = bytesPerFrame; }
+    void SetTextureLoadedCallback( std::function<void(const wchar_t*, HRESULT)> callback );
+    size_t ProcessTextureLoads( _In_ ID3D11DeviceContext* deviceContext );
 
     static SharedResourcePool<ID3D11Device*, Impl> instancePool;
 
+    static const size_t DefaultUploadBudget = 4 * 1024 * 1024;
+
     wchar_t mPath[MAX_PATH];
 
 private:
+    typedef std::function<void(IEffect*, ID3D11ShaderResourceView*)> TextureSetter;
+
+    // A texture requested by one or more effects while lazy loading is enabled.
+    struct PendingTexture
+    {
+        std::wstring                                                name;
+        std::wstring                                                fullName;
+        std::vector<std::pair<std::weak_ptr<IEffect>, TextureSetter>> bindings;
+        std::unique_ptr<uint8_t[]>                                  data;
+        size_t                                                      dataSize;
+        HRESULT                                                     hr;
+    };
+
+    void LoadTexture( _In_ IEffectFactory* factory, _In_z_ const wchar_t* name, _In_opt_ ID3D11DeviceContext* deviceContext,
+                      std::shared_ptr<IEffect> const& effect, TextureSetter setter );
+    void ResolveTexturePath( _In_z_ const wchar_t* name, _Out_writes_(MAX_PATH) wchar_t* fullName ) const;
+    HRESULT CreateTextureFromData( PendingTexture const& pending, _In_opt_ ID3D11DeviceContext* deviceContext, _Outptr_ ID3D11ShaderResourceView** textureView );
+    ID3D11ShaderResourceView* GetPlaceholderTexture();
+    void TextureReadThread();
+
     ComPtr<ID3D11Device> device;
 
-    typedef std::map< std::wstring, std::shared_ptr<IEffect> > EffectCache;
-    typedef std::map< std::wstring, ComPtr<ID3D11ShaderResourceView> > TextureCache;
+    typedef ShardedCache< std::shared_ptr<IEffect> > EffectCache;
+    typedef ShardedCache< ComPtr<ID3D11ShaderResourceView> > TextureCache;
 
     EffectCache  mEffectCache;
     EffectCache  mEffectCacheSkinning;
@@ -61,11 +104,29 @@ private:
     EffectCache  mEffectNormalMap;
     TextureCache mTextureCache;
 
+    std::shared_ptr<DirectX::TextureCache> mDecodedCache;
+
     bool mSharing;
     bool mUseNormalMapEffect;
     bool mForceSRGB;
 
+    // Serializes use of the immediate context for WIC autogen-mipmaps and the placeholder creation;
+    // the caches are locked per shard.
     std::mutex mutex;
+
+    // Lazy texture loading: file reads happen on mReadThread, texture creation in ProcessTextureLoads.
+    bool mLazyTextures;
+    size_t mUploadBudget;
+    ComPtr<ID3D11ShaderResourceView> mPlaceholder;
+    std::function<void(const wchar_t*, HRESULT)> mLoadedCallback;
+
+    std::map<std::wstring, std::shared_ptr<PendingTexture>> mPendingTextures;
+    std::deque<std::shared_ptr<PendingTexture>> mReadQueue;
+    std::deque<std::shared_ptr<PendingTexture>> mReadyQueue;
+    std::mutex mLoadMutex;
+    std::condition_variable mLoadSignal;
+    std::thread mReadThread;
+    bool mShutdown;
 };
 
 
@@ -81,10 +142,10 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
         // SkinnedEffect
         if (mSharing && info.name && *info.name)
         {
-            auto it = mEffectCacheSkinning.find(info.name);
-            if (mSharing && it != mEffectCacheSkinning.end())
+            std::shared_ptr<IEffect> cached;
+            if (mEffectCacheSkinning.Find(info.name, cached))
             {
-                return it->second;
+                return cached;
             }
         }
 
@@ -118,11 +179,10 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (info.diffuseTexture && *info.diffuseTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture(srv.Get());
+            LoadTexture(factory, info.diffuseTexture, deviceContext, effect, [](IEffect* e, ID3D11ShaderResourceView* srv)
+            {
+                static_cast<SkinnedEffect*>(e)->SetTexture(srv);
+            });
         }
 
         if (info.biasedVertexNormals)
@@ -132,8 +192,7 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (mSharing && info.name && *info.name)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            mEffectCacheSkinning.insert(EffectCache::value_type(info.name, effect));
+            return mEffectCacheSkinning.Insert(info.name, effect);
         }
 
         return effect;
@@ -143,10 +202,10 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
         // DualTextureEffect
         if (mSharing && info.name && *info.name)
         {
-            auto it = mEffectCacheDualTexture.find(info.name);
-            if (mSharing && it != mEffectCacheDualTexture.end())
+            std::shared_ptr<IEffect> cached;
+            if (mEffectCacheDualTexture.Find(info.name, cached))
             {
-                return it->second;
+                return cached;
             }
         }
 
@@ -166,26 +225,23 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (info.diffuseTexture && *info.diffuseTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture(srv.Get());
+            LoadTexture(factory, info.diffuseTexture, deviceContext, effect, [](IEffect* e, ID3D11ShaderResourceView* srv)
+            {
+                static_cast<DualTextureEffect*>(e)->SetTexture(srv);
+            });
         }
 
         if (info.specularTexture && *info.specularTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.specularTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture2(srv.Get());
+            LoadTexture(factory, info.specularTexture, deviceContext, effect, [](IEffect* e, ID3D11ShaderResourceView* srv)
+            {
+                static_cast<DualTextureEffect*>(e)->SetTexture2(srv);
+            });
         }
 
         if (mSharing && info.name && *info.name)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            mEffectCacheDualTexture.insert(EffectCache::value_type(info.name, effect));
+            return mEffectCacheDualTexture.Insert(info.name, effect);
         }
 
         return effect;
@@ -195,10 +251,10 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
         // NormalMapEffect
         if (mSharing && info.name && *info.name)
         {
-            auto it = mEffectNormalMap.find(info.name);
-            if (mSharing && it != mEffectNormalMap.end())
+            std::shared_ptr<IEffect> cached;
+            if (mEffectNormalMap.Find(info.name, cached))
             {
-                return it->second;
+                return cached;
             }
         }
 
@@ -237,29 +293,26 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (info.diffuseTexture && *info.diffuseTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetTexture(srv.Get());
+            LoadTexture(factory, info.diffuseTexture, deviceContext, effect, [](IEffect* e, ID3D11ShaderResourceView* srv)
+            {
+                static_cast<NormalMapEffect*>(e)->SetTexture(srv);
+            });
         }
 
         if (info.specularTexture && *info.specularTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.specularTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetSpecularTexture(srv.Get());
+            LoadTexture(factory, info.specularTexture, deviceContext, effect, [](IEffect* e, ID3D11ShaderResourceView* srv)
+            {
+                static_cast<NormalMapEffect*>(e)->SetSpecularTexture(srv);
+            });
         }
 
         if (info.normalTexture && *info.normalTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.normalTexture, deviceContext, srv.GetAddressOf());
-
-            effect->SetNormalTexture(srv.Get());
+            LoadTexture(factory, info.normalTexture, deviceContext, effect, [](IEffect* e, ID3D11ShaderResourceView* srv)
+            {
+                static_cast<NormalMapEffect*>(e)->SetNormalTexture(srv);
+            });
         }
 
         if (info.biasedVertexNormals)
@@ -269,8 +322,7 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (mSharing && info.name && *info.name)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            mEffectNormalMap.insert(EffectCache::value_type(info.name, effect));
+            return mEffectNormalMap.Insert(info.name, effect);
         }
 
         return effect;
@@ -280,10 +332,10 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
         // BasicEffect
         if (mSharing && info.name && *info.name)
         {
-            auto it = mEffectCache.find(info.name);
-            if (mSharing && it != mEffectCache.end())
+            std::shared_ptr<IEffect> cached;
+            if (mEffectCache.Find(info.name, cached))
             {
-                return it->second;
+                return cached;
             }
         }
 
@@ -323,11 +375,11 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (info.diffuseTexture && *info.diffuseTexture)
         {
-            ComPtr<ID3D11ShaderResourceView> srv;
-
-            factory->CreateTexture(info.diffuseTexture, deviceContext, srv.GetAddressOf());
+            LoadTexture(factory, info.diffuseTexture, deviceContext, effect, [](IEffect* e, ID3D11ShaderResourceView* srv)
+            {
+                static_cast<BasicEffect*>(e)->SetTexture(srv);
+            });
 
-            effect->SetTexture(srv.Get());
             effect->SetTextureEnabled(true);
         }
 
@@ -338,8 +390,7 @@ std::shared_ptr<IEffect> EffectFactory::Impl::CreateEffect(IEffectFactory* facto
 
         if (mSharing && info.name && *info.name)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            mEffectCache.insert(EffectCache::value_type(info.name, effect));
+            return mEffectCache.Insert(info.name, effect);
         }
 
         return effect;
@@ -356,36 +407,36 @@ void EffectFactory::Impl::CreateTexture(const wchar_t* name, ID3D11DeviceContext
     UNREFERENCED_PARAMETER(deviceContext);
 #endif
 
-    auto it = mTextureCache.find(name);
+    ComPtr<ID3D11ShaderResourceView> cached;
 
-    if (mSharing && it != mTextureCache.end())
+    if (mSharing && mTextureCache.Find(name, cached))
     {
-        ID3D11ShaderResourceView* srv = it->second.Get();
-        srv->AddRef();
-        *textureView = srv;
+        *textureView = cached.Detach();
     }
     else
     {
         wchar_t fullName[MAX_PATH] = {};
-        wcscpy_s(fullName, mPath);
-        wcscat_s(fullName, name);
+        ResolveTexturePath(name, fullName);
 
-        WIN32_FILE_ATTRIBUTE_DATA fileAttr = {};
-        if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
+        wchar_t ext[_MAX_EXT];
+        _wsplitpath_s(name, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+
+        if (mDecodedCache)
         {
-            // Try Current Working Directory (CWD)
-            wcscpy_s(fullName, name);
-            if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
+            std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+            if (deviceContext)
+                lock.lock();
+
+            HRESULT hr = mDecodedCache->CreateTextureFromFile(
+                device.Get(), deviceContext, fullName,
+                nullptr, textureView, mForceSRGB);
+            if (FAILED(hr))
             {
-                DebugTrace("EffectFactory could not find texture file '%ls'\n", name);
-                throw std::exception("CreateTexture");
+                DebugTrace("TextureCache::CreateTextureFromFile failed (%08X) for '%ls'\n", hr, fullName);
+                throw std::exception("TextureCache::CreateTextureFromFile");
             }
         }
-
-        wchar_t ext[_MAX_EXT];
-        _wsplitpath_s(name, nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
-
-        if (_wcsicmp(ext, L".dds") == 0)
+        else if (_wcsicmp(ext, L".dds") == 0)
         {
             HRESULT hr = CreateDDSTextureFromFileEx(
                 device.Get(), fullName, 0,
@@ -425,22 +476,341 @@ void EffectFactory::Impl::CreateTexture(const wchar_t* name, ID3D11DeviceContext
             }
         }
 
-        if (mSharing && *name && it == mTextureCache.end())
+        if (mSharing && *name)
         {
-            std::lock_guard<std::mutex> lock(mutex);
-            mTextureCache.insert(TextureCache::value_type(name, *textureView));
+            // Another thread may have loaded the same texture meanwhile; hand back the shared copy.
+            cached = mTextureCache.Insert(name, *textureView);
+            if (cached.Get() != *textureView)
+            {
+                (*textureView)->Release();
+                *textureView = cached.Detach();
+            }
         }
     }
 }
 
+EffectFactory::Impl::~Impl()
+{
+    if (mReadThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mLoadMutex);
+            mShutdown = true;
+        }
+
+        mLoadSignal.notify_all();
+        mReadThread.join();
+    }
+}
+
+_Use_decl_annotations_
+void EffectFactory::Impl::ResolveTexturePath(const wchar_t* name, wchar_t* fullName) const
+{
+    wcscpy_s(fullName, MAX_PATH, mPath);
+    wcscat_s(fullName, MAX_PATH, name);
+
+    WIN32_FILE_ATTRIBUTE_DATA fileAttr = {};
+    if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
+    {
+        // Try Current Working Directory (CWD)
+        wcscpy_s(fullName, MAX_PATH, name);
+        if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
+        {
+            DebugTrace("EffectFactory could not find texture file '%ls'\n", name);
+            throw std::exception("CreateTexture");
+        }
+    }
+}
+
+_Use_decl_annotations_
+void EffectFactory::Impl::LoadTexture(IEffectFactory* factory, const wchar_t* name, ID3D11DeviceContext* deviceContext,
+                                      std::shared_ptr<IEffect> const& effect, TextureSetter setter)
+{
+    // Lazy loading decodes the file data itself in ProcessTextureLoads, so it doesn't go through
+    // IEffectFactory::CreateTexture; a factory that overrides CreateTexture gets it called only
+    // while lazy loading is disabled.
+    if (!mLazyTextures)
+    {
+        ComPtr<ID3D11ShaderResourceView> srv;
+
+        factory->CreateTexture(name, deviceContext, srv.GetAddressOf());
+
+        setter(effect.get(), srv.Get());
+        return;
+    }
+
+    auto placeholder = GetPlaceholderTexture();
+
+    ComPtr<ID3D11ShaderResourceView> cached;
+    wchar_t fullName[MAX_PATH] = {};
+    bool resolved = false;
+
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mLoadMutex);
+
+            // ProcessTextureLoads moves a finished texture from mPendingTextures to mTextureCache under
+            // mLoadMutex, so checking both under it never misses one and never queues a second read.
+            if (mSharing && mTextureCache.Find(name, cached))
+                break;
+
+            auto it = mPendingTextures.find(name);
+            if (it != mPendingTextures.end())
+            {
+                setter(effect.get(), placeholder);
+                it->second->bindings.emplace_back(effect, setter);
+                return;
+            }
+
+            if (resolved)
+            {
+                auto pending = std::make_shared<PendingTexture>();
+                pending->name = name;
+                pending->fullName = fullName;
+                pending->dataSize = 0;
+                pending->hr = E_PENDING;
+
+                setter(effect.get(), placeholder);
+                pending->bindings.emplace_back(effect, setter);
+
+                mPendingTextures[name] = pending;
+                mReadQueue.push_back(pending);
+
+                if (!mReadThread.joinable())
+                {
+                    mReadThread = std::thread(&Impl::TextureReadThread, this);
+                }
+
+                mLoadSignal.notify_one();
+                return;
+            }
+        }
+
+        // Looking for the file touches the file system, so it is done without the lock; the
+        // texture may be requested or finished meanwhile, which the next pass picks up.
+        ResolveTexturePath(name, fullName);
+        resolved = true;
+    }
+
+    setter(effect.get(), cached.Get());
+}
+
+ID3D11ShaderResourceView* EffectFactory::Impl::GetPlaceholderTexture()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!mPlaceholder)
+    {
+        static const uint32_t s_white = 0xFFFFFFFF;
+
+        D3D11_SUBRESOURCE_DATA initData = { &s_white, sizeof(uint32_t), 0 };
+
+        CD3D11_TEXTURE2D_DESC desc(DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, 1, D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE);
+
+        ComPtr<ID3D11Texture2D> tex;
+        ThrowIfFailed(device->CreateTexture2D(&desc, &initData, tex.GetAddressOf()));
+
+        ThrowIfFailed(device->CreateShaderResourceView(tex.Get(), nullptr, mPlaceholder.ReleaseAndGetAddressOf()));
+
+        SetDebugObjectName(mPlaceholder.Get(), "EffectFactory:Placeholder");
+    }
+
+    return mPlaceholder.Get();
+}
+
+void EffectFactory::Impl::TextureReadThread()
+{
+    for (;;)
+    {
+        std::shared_ptr<PendingTexture> pending;
+
+        {
+            std::unique_lock<std::mutex> lock(mLoadMutex);
+            mLoadSignal.wait(lock, [this]() { return mShutdown || !mReadQueue.empty(); });
+
+            if (mShutdown)
+                return;
+
+            pending = mReadQueue.front();
+            mReadQueue.pop_front();
+        }
+
+        pending->hr = BinaryReader::ReadEntireFile(pending->fullName.c_str(), pending->data, &pending->dataSize);
+
+        std::lock_guard<std::mutex> lock(mLoadMutex);
+        mReadyQueue.push_back(pending);
+    }
+}
+
+_Use_decl_annotations_
+HRESULT EffectFactory::Impl::CreateTextureFromData(PendingTexture const& pending, ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView** textureView)
+{
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    UNREFERENCED_PARAMETER(deviceContext);
+#endif
+
+    wchar_t ext[_MAX_EXT];
+    _wsplitpath_s(pending.name.c_str(), nullptr, 0, nullptr, 0, nullptr, 0, ext, _MAX_EXT);
+
+    if (mDecodedCache)
+    {
+        std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+        if (deviceContext)
+            lock.lock();
+
+        return mDecodedCache->CreateTextureFromMemory(
+            device.Get(), deviceContext, pending.data.get(), pending.dataSize,
+            nullptr, textureView, mForceSRGB);
+    }
+    else if (_wcsicmp(ext, L".dds") == 0)
+    {
+        return CreateDDSTextureFromMemoryEx(
+            device.Get(), pending.data.get(), pending.dataSize, 0,
+            D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+            mForceSRGB, nullptr, textureView);
+    }
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    else if (deviceContext)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return CreateWICTextureFromMemoryEx(
+            device.Get(), deviceContext, pending.data.get(), pending.dataSize, 0,
+            D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+            mForceSRGB ? WIC_LOADER_FORCE_SRGB : WIC_LOADER_DEFAULT, nullptr, textureView);
+    }
+#endif
+    else
+    {
+        return CreateWICTextureFromMemoryEx(
+            device.Get(), pending.data.get(), pending.dataSize, 0,
+            D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+            mForceSRGB ? WIC_LOADER_FORCE_SRGB : WIC_LOADER_DEFAULT, nullptr, textureView);
+    }
+}
+
+_Use_decl_annotations_
+size_t EffectFactory::Impl::ProcessTextureLoads(ID3D11DeviceContext* deviceContext)
+{
+    size_t uploaded = 0;
+
+    for (;;)
+    {
+        std::shared_ptr<PendingTexture> pending;
+
+        {
+            std::lock_guard<std::mutex> lock(mLoadMutex);
+            if (mReadyQueue.empty())
+                break;
+
+            // Always make progress on at least one texture per call, even if it exceeds the budget
+            auto& next = mReadyQueue.front();
+            if (uploaded > 0 && (uploaded + next->dataSize) > mUploadBudget)
+                break;
+
+            pending = next;
+            mReadyQueue.pop_front();
+        }
+
+        uploaded += pending->dataSize;
+
+        ComPtr<ID3D11ShaderResourceView> srv;
+        HRESULT hr = pending->hr;
+        if (SUCCEEDED(hr))
+        {
+            hr = CreateTextureFromData(*pending, deviceContext, srv.GetAddressOf());
+        }
+
+        pending->data.reset();
+
+        // Cache the texture, take its bindings, and retire it from the pending list in one step, so a
+        // request for it finds it either pending or cached and never starts a second read.
+        decltype(pending->bindings) bindings;
+
+        {
+            std::lock_guard<std::mutex> lock(mLoadMutex);
+
+            if (SUCCEEDED(hr) && mSharing)
+            {
+                srv = mTextureCache.Insert(pending->name.c_str(), srv);
+            }
+
+            bindings.swap(pending->bindings);
+            mPendingTextures.erase(pending->name);
+        }
+
+        if (SUCCEEDED(hr))
+        {
+            for (auto it = bindings.begin(); it != bindings.end(); ++it)
+            {
+                auto effect = it->first.lock();
+                if (effect)
+                {
+                    it->second(effect.get(), srv.Get());
+                }
+            }
+        }
+        else
+        {
+            DebugTrace("EffectFactory failed (%08X) to load texture '%ls'; keeping placeholder\n", hr, pending->fullName.c_str());
+        }
+
+        if (mLoadedCallback)
+        {
+            mLoadedCallback(pending->name.c_str(), hr);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mLoadMutex);
+    return mPendingTextures.size();
+}
+
+void EffectFactory::Impl::SetTextureLoadedCallback(std::function<void(const wchar_t*, HRESULT)> callback)
+{
+    mLoadedCallback = callback;
+}
+
 void EffectFactory::Impl::ReleaseCache()
 {
+    mEffectCache.Clear();
+    mEffectCacheSkinning.Clear();
+    mEffectCacheDualTexture.Clear();
+    mEffectNormalMap.Clear();
+    mTextureCache.Clear();
+
     std::lock_guard<std::mutex> lock(mutex);
-    mEffectCache.clear();
-    mEffectCacheSkinning.clear();
-    mEffectCacheDualTexture.clear();
-    mEffectNormalMap.clear();
-    mTextureCache.clear();
+    mPlaceholder.Reset();
+}
+
+IEffectFactory::CacheStatistics EffectFactory::Impl::GetCacheStatistics() const
+{
+    const EffectCache* effectCaches[] = { &mEffectCache, &mEffectCacheSkinning, &mEffectCacheDualTexture, &mEffectNormalMap };
+
+    IEffectFactory::CacheStatistics result = {};
+
+    for (size_t j = 0; j < _countof(effectCaches); ++j)
+    {
+        auto stats = effectCaches[j]->GetStatistics();
+        result.effectHits += stats.hits;
+        result.effectMisses += stats.misses;
+        result.contentions += stats.contentions;
+    }
+
+    auto stats = mTextureCache.GetStatistics();
+    result.textureHits = stats.hits;
+    result.textureMisses = stats.misses;
+    result.contentions += stats.contentions;
+
+    return result;
+}
+
+void EffectFactory::Impl::ResetCacheStatistics()
+{
+    mEffectCache.ResetStatistics();
+    mEffectCacheSkinning.ResetStatistics();
+    mEffectCacheDualTexture.ResetStatistics();
+    mEffectNormalMap.ResetStatistics();
+    mTextureCache.ResetStatistics();
 }
 
 
@@ -502,6 +872,42 @@ void EffectFactory::EnableForceSRGB(bool forceSRGB)
     pImpl->EnableForceSRGB( forceSRGB );
 }
 
+IEffectFactory::CacheStatistics EffectFactory::GetCacheStatistics() const
+{
+    return pImpl->GetCacheStatistics();
+}
+
+void EffectFactory::ResetCacheStatistics()
+{
+    pImpl->ResetCacheStatistics();
+}
+
+void EffectFactory::EnableLazyTextureLoading(bool enabled)
+{
+    pImpl->EnableLazyTextureLoading(enabled);
+}
+
+void EffectFactory::SetTextureUploadBudget(size_t bytesPerFrame)
+{
+    pImpl->SetTextureUploadBudget(bytesPerFrame);
+}
+
+void EffectFactory::SetTextureLoadedCallback(std::function<void __cdecl(const wchar_t* name, HRESULT hr)> callback)
+{
+    pImpl->SetTextureLoadedCallback(callback);
+}
+
+_Use_decl_annotations_
+size_t EffectFactory::ProcessTextureLoads(ID3D11DeviceContext* deviceContext)
+{
+    return pImpl->ProcessTextureLoads(deviceContext);
+}
+
+void EffectFactory::SetTextureCache(std::shared_ptr<TextureCache> cache)
+{
+    pImpl->SetTextureCache(cache);
+}
+
 void EffectFactory::SetDirectory(_In_opt_z_ const wchar_t* path)
 {
     if (path && *path != 0)
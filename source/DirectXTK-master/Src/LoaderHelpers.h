@@ -15,9 +15,22 @@
 
 #pragma once
 
-#include "DDS.h"
+#include "dds.h"
 #include "DDSTextureLoader.h"
 
+#include <thread>
+
+// Visual C++ 2013 has no constexpr: there the format tables are const data, the helpers are
+// plain inline functions, and the compile-time checks of the tables are left out.
+#if defined(_MSC_VER) && (_MSC_FULL_VER < 190023506)
+#define LOADER_CONST const
+#define LOADER_CONSTEXPR
+#else
+#define LOADER_CONST constexpr
+#define LOADER_CONSTEXPR constexpr
+#define LOADER_STATIC_CHECKS
+#endif
+
 
 namespace DirectX
 {
@@ -25,262 +38,350 @@ namespace DirectX
     namespace LoaderHelpers
     {
         //--------------------------------------------------------------------------------------
-        // Return the BPP for a particular format
+        // Per-format metadata, indexed by DXGI_FORMAT. Every header validation and every mip
+        // level's GetSurfaceInfo asks for these properties, so they are read from one table
+        // built at compile time instead of walking a switch statement per property.
         //--------------------------------------------------------------------------------------
-        inline size_t BitsPerPixel(_In_ DXGI_FORMAT fmt)
-        {
-            switch (fmt)
-            {
-            case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-            case DXGI_FORMAT_R32G32B32A32_FLOAT:
-            case DXGI_FORMAT_R32G32B32A32_UINT:
-            case DXGI_FORMAT_R32G32B32A32_SINT:
-                return 128;
-
-            case DXGI_FORMAT_R32G32B32_TYPELESS:
-            case DXGI_FORMAT_R32G32B32_FLOAT:
-            case DXGI_FORMAT_R32G32B32_UINT:
-            case DXGI_FORMAT_R32G32B32_SINT:
-                return 96;
-
-            case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-            case DXGI_FORMAT_R16G16B16A16_FLOAT:
-            case DXGI_FORMAT_R16G16B16A16_UNORM:
-            case DXGI_FORMAT_R16G16B16A16_UINT:
-            case DXGI_FORMAT_R16G16B16A16_SNORM:
-            case DXGI_FORMAT_R16G16B16A16_SINT:
-            case DXGI_FORMAT_R32G32_TYPELESS:
-            case DXGI_FORMAT_R32G32_FLOAT:
-            case DXGI_FORMAT_R32G32_UINT:
-            case DXGI_FORMAT_R32G32_SINT:
-            case DXGI_FORMAT_R32G8X24_TYPELESS:
-            case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-            case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-            case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-            case DXGI_FORMAT_Y416:
-            case DXGI_FORMAT_Y210:
-            case DXGI_FORMAT_Y216:
-                return 64;
-
-            case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-            case DXGI_FORMAT_R10G10B10A2_UNORM:
-            case DXGI_FORMAT_R10G10B10A2_UINT:
-            case DXGI_FORMAT_R11G11B10_FLOAT:
-            case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-            case DXGI_FORMAT_R8G8B8A8_UNORM:
-            case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-            case DXGI_FORMAT_R8G8B8A8_UINT:
-            case DXGI_FORMAT_R8G8B8A8_SNORM:
-            case DXGI_FORMAT_R8G8B8A8_SINT:
-            case DXGI_FORMAT_R16G16_TYPELESS:
-            case DXGI_FORMAT_R16G16_FLOAT:
-            case DXGI_FORMAT_R16G16_UNORM:
-            case DXGI_FORMAT_R16G16_UINT:
-            case DXGI_FORMAT_R16G16_SNORM:
-            case DXGI_FORMAT_R16G16_SINT:
-            case DXGI_FORMAT_R32_TYPELESS:
-            case DXGI_FORMAT_D32_FLOAT:
-            case DXGI_FORMAT_R32_FLOAT:
-            case DXGI_FORMAT_R32_UINT:
-            case DXGI_FORMAT_R32_SINT:
-            case DXGI_FORMAT_R24G8_TYPELESS:
-            case DXGI_FORMAT_D24_UNORM_S8_UINT:
-            case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-            case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-            case DXGI_FORMAT_R8G8_B8G8_UNORM:
-            case DXGI_FORMAT_G8R8_G8B8_UNORM:
-            case DXGI_FORMAT_B8G8R8A8_UNORM:
-            case DXGI_FORMAT_B8G8R8X8_UNORM:
-            case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-            case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-            case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-            case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-            case DXGI_FORMAT_AYUV:
-            case DXGI_FORMAT_Y410:
-            case DXGI_FORMAT_YUY2:
-                return 32;
-
-            case DXGI_FORMAT_P010:
-            case DXGI_FORMAT_P016:
-                return 24;
-
-            case DXGI_FORMAT_R8G8_TYPELESS:
-            case DXGI_FORMAT_R8G8_UNORM:
-            case DXGI_FORMAT_R8G8_UINT:
-            case DXGI_FORMAT_R8G8_SNORM:
-            case DXGI_FORMAT_R8G8_SINT:
-            case DXGI_FORMAT_R16_TYPELESS:
-            case DXGI_FORMAT_R16_FLOAT:
-            case DXGI_FORMAT_D16_UNORM:
-            case DXGI_FORMAT_R16_UNORM:
-            case DXGI_FORMAT_R16_UINT:
-            case DXGI_FORMAT_R16_SNORM:
-            case DXGI_FORMAT_R16_SINT:
-            case DXGI_FORMAT_B5G6R5_UNORM:
-            case DXGI_FORMAT_B5G5R5A1_UNORM:
-            case DXGI_FORMAT_A8P8:
-            case DXGI_FORMAT_B4G4R4A4_UNORM:
-                return 16;
-
-            case DXGI_FORMAT_NV12:
-            case DXGI_FORMAT_420_OPAQUE:
-            case DXGI_FORMAT_NV11:
-                return 12;
-
-            case DXGI_FORMAT_R8_TYPELESS:
-            case DXGI_FORMAT_R8_UNORM:
-            case DXGI_FORMAT_R8_UINT:
-            case DXGI_FORMAT_R8_SNORM:
-            case DXGI_FORMAT_R8_SINT:
-            case DXGI_FORMAT_A8_UNORM:
-            case DXGI_FORMAT_AI44:
-            case DXGI_FORMAT_IA44:
-            case DXGI_FORMAT_P8:
-                return 8;
-
-            case DXGI_FORMAT_R1_UNORM:
-                return 1;
-
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-                return 4;
-
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                return 8;
+        enum FORMAT_LAYOUT : uint8_t
+        {
+            FORMAT_LINEAR = 0,      // bitsPerPixel per pixel, rows rounded up to a whole byte
+            FORMAT_BLOCK,           // 4x4 blocks of bytesPerElement (BC1 - BC7)
+            FORMAT_PACKED,          // Pairs of pixels in bytesPerElement (YUY2, RGBG)
+            FORMAT_PLANAR,          // Luma rows followed by half-height chroma rows
+            FORMAT_NV11,            // 4:1:1 planar
+        };
+
+        struct DXGIFormatInfo
+        {
+            DXGI_FORMAT     format;
+            uint8_t         bitsPerPixel;
+            uint8_t         bytesPerElement;    // Bytes per block, pixel pair or chroma sample
+            FORMAT_LAYOUT   layout;
+            DXGI_FORMAT     srgbFormat;         // UNKNOWN when there is no _SRGB twin
+            DXGI_FORMAT     typedFormat;        // UNKNOWN unless a typeless format has a UNORM or FLOAT view
+        };
+
+        LOADER_CONST DXGIFormatInfo s_formatInfo[] =
+        {
+            //  format                                bpp  bpe  layout          srgbFormat                         typedFormat
+            { DXGI_FORMAT_UNKNOWN,                      0,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32A32_TYPELESS,      128,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R32G32B32A32_FLOAT },
+            { DXGI_FORMAT_R32G32B32A32_FLOAT,         128,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32A32_UINT,          128,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32A32_SINT,          128,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32_TYPELESS,          96,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R32G32B32_FLOAT },
+            { DXGI_FORMAT_R32G32B32_FLOAT,             96,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32_UINT,              96,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32_SINT,              96,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_TYPELESS,       64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R16G16B16A16_UNORM },
+            { DXGI_FORMAT_R16G16B16A16_FLOAT,          64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_UNORM,          64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_UINT,           64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_SNORM,          64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_SINT,           64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32_TYPELESS,             64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R32G32_FLOAT },
+            { DXGI_FORMAT_R32G32_FLOAT,                64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32_UINT,                 64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32_SINT,                 64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G8X24_TYPELESS,           64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D32_FLOAT_S8X24_UINT,        64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS,    64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_X32_TYPELESS_G8X24_UINT,     64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10A2_TYPELESS,        32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R10G10B10A2_UNORM },
+            { DXGI_FORMAT_R10G10B10A2_UNORM,           32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10A2_UINT,            32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R11G11B10_FLOAT,             32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_TYPELESS,           32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R8G8B8A8_UNORM },
+            { DXGI_FORMAT_R8G8B8A8_UNORM,              32,  0, FORMAT_LINEAR, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,   DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,         32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_UINT,               32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_SNORM,              32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_SINT,               32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_TYPELESS,             32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R16G16_UNORM },
+            { DXGI_FORMAT_R16G16_FLOAT,                32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_UNORM,                32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_UINT,                 32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_SNORM,                32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_SINT,                 32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_TYPELESS,                32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R32_FLOAT },
+            { DXGI_FORMAT_D32_FLOAT,                   32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_FLOAT,                   32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_UINT,                    32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_SINT,                    32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R24G8_TYPELESS,              32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D24_UNORM_S8_UINT,           32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R24_UNORM_X8_TYPELESS,       32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_X24_TYPELESS_G8_UINT,        32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_TYPELESS,               16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R8G8_UNORM },
+            { DXGI_FORMAT_R8G8_UNORM,                  16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_UINT,                   16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_SNORM,                  16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_SINT,                   16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_TYPELESS,                16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R16_UNORM },
+            { DXGI_FORMAT_R16_FLOAT,                   16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D16_UNORM,                   16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_UNORM,                   16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_UINT,                    16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_SNORM,                   16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_SINT,                    16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_TYPELESS,                  8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_R8_UNORM },
+            { DXGI_FORMAT_R8_UNORM,                     8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_UINT,                      8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_SNORM,                     8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_SINT,                      8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_A8_UNORM,                     8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R1_UNORM,                     1,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R9G9B9E5_SHAREDEXP,          32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_B8G8_UNORM,             32,  4, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_G8R8_G8B8_UNORM,             32,  4, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC1_TYPELESS,                 4,  8, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_BC1_UNORM },
+            { DXGI_FORMAT_BC1_UNORM,                    4,  8, FORMAT_BLOCK,  DXGI_FORMAT_BC1_UNORM_SRGB,        DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC1_UNORM_SRGB,               4,  8, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC2_TYPELESS,                 8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_BC2_UNORM },
+            { DXGI_FORMAT_BC2_UNORM,                    8, 16, FORMAT_BLOCK,  DXGI_FORMAT_BC2_UNORM_SRGB,        DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC2_UNORM_SRGB,               8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC3_TYPELESS,                 8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_BC3_UNORM },
+            { DXGI_FORMAT_BC3_UNORM,                    8, 16, FORMAT_BLOCK,  DXGI_FORMAT_BC3_UNORM_SRGB,        DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC3_UNORM_SRGB,               8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC4_TYPELESS,                 4,  8, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_BC4_UNORM },
+            { DXGI_FORMAT_BC4_UNORM,                    4,  8, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC4_SNORM,                    4,  8, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC5_TYPELESS,                 8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_BC5_UNORM },
+            { DXGI_FORMAT_BC5_UNORM,                    8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC5_SNORM,                    8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B5G6R5_UNORM,                16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B5G5R5A1_UNORM,              16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8A8_UNORM,              32,  0, FORMAT_LINEAR, DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,   DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8X8_UNORM,              32,  0, FORMAT_LINEAR, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB,   DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM,  32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8A8_TYPELESS,           32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_B8G8R8A8_UNORM },
+            { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,         32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8X8_TYPELESS,           32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_B8G8R8X8_UNORM },
+            { DXGI_FORMAT_B8G8R8X8_UNORM_SRGB,         32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC6H_TYPELESS,                8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC6H_UF16,                    8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC6H_SF16,                    8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC7_TYPELESS,                 8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_BC7_UNORM },
+            { DXGI_FORMAT_BC7_UNORM,                    8, 16, FORMAT_BLOCK,  DXGI_FORMAT_BC7_UNORM_SRGB,        DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC7_UNORM_SRGB,               8, 16, FORMAT_BLOCK,  DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_AYUV,                        32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y410,                        32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y416,                        64,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_NV12,                        12,  2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_P010,                        24,  4, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_P016,                        24,  4, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_420_OPAQUE,                  12,  2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_YUY2,                        32,  4, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y210,                        64,  8, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y216,                        64,  8, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_NV11,                        12,  0, FORMAT_NV11,   DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_AI44,                         8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_IA44,                         8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_P8,                           8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_A8P8,                        16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B4G4R4A4_UNORM,              16,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+        };
+
+        LOADER_CONST size_t c_formatInfoCount = sizeof(s_formatInfo) / sizeof(s_formatInfo[0]);
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
 
-            case DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT:
-            case DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT:
-            case DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM:
-                return 32;
+        LOADER_CONST DXGIFormatInfo s_xboxFormatInfo[] =
+        {
+            { DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT,     32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT,     32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D16_UNORM_S8_UINT,          24,  4, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_UNORM_X8_TYPELESS,      24,  4, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_X16_TYPELESS_G8_UINT,       24,  4, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM,   32,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R4G4_UNORM,                  8,  0, FORMAT_LINEAR, DXGI_FORMAT_UNKNOWN,               DXGI_FORMAT_UNKNOWN },
+        };
 
-            case DXGI_FORMAT_D16_UNORM_S8_UINT:
-            case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-                return 24;
+        inline LOADER_CONSTEXPR const DXGIFormatInfo& FindXboxFormatInfo(DXGI_FORMAT fmt, size_t index = 0)
+        {
+            return (index >= sizeof(s_xboxFormatInfo) / sizeof(s_xboxFormatInfo[0])) ? s_formatInfo[0]
+                : (s_xboxFormatInfo[index].format == fmt) ? s_xboxFormatInfo[index]
+                : FindXboxFormatInfo(fmt, index + 1);
+        }
 
-            case DXGI_FORMAT_R4G4_UNORM:
-                return 8;
+        inline LOADER_CONSTEXPR const DXGIFormatInfo& GetFormatInfo(DXGI_FORMAT fmt)
+        {
+            return (static_cast<size_t>(fmt) < c_formatInfoCount) ? s_formatInfo[fmt] : FindXboxFormatInfo(fmt);
+        }
 
-#endif // _XBOX_ONE && _TITLE
+#else
 
-            default:
-                return 0;
-            }
+        inline LOADER_CONSTEXPR const DXGIFormatInfo& GetFormatInfo(DXGI_FORMAT fmt)
+        {
+            return (static_cast<size_t>(fmt) < c_formatInfoCount) ? s_formatInfo[fmt] : s_formatInfo[0];
         }
 
+#endif // _XBOX_ONE && _TITLE
+
         //--------------------------------------------------------------------------------------
-        inline DXGI_FORMAT MakeSRGB(_In_ DXGI_FORMAT format)
+        // Compile-time checks of the table
+        //--------------------------------------------------------------------------------------
+        inline LOADER_CONSTEXPR bool IsFormatInfoIndexed(size_t index = 0)
         {
-            switch (format)
-            {
-            case DXGI_FORMAT_R8G8B8A8_UNORM:
-                return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+            return (index >= c_formatInfoCount)
+                || (s_formatInfo[index].format == static_cast<DXGI_FORMAT>(index) && IsFormatInfoIndexed(index + 1));
+        }
 
-            case DXGI_FORMAT_BC1_UNORM:
-                return DXGI_FORMAT_BC1_UNORM_SRGB;
+        inline LOADER_CONSTEXPR bool IsFormatViewCompatible(const DXGIFormatInfo& info, DXGI_FORMAT view)
+        {
+            return (view == DXGI_FORMAT_UNKNOWN)
+                || (GetFormatInfo(view).bitsPerPixel == info.bitsPerPixel
+                    && GetFormatInfo(view).layout == info.layout
+                    && GetFormatInfo(view).typedFormat == DXGI_FORMAT_UNKNOWN);
+        }
 
-            case DXGI_FORMAT_BC2_UNORM:
-                return DXGI_FORMAT_BC2_UNORM_SRGB;
+        inline LOADER_CONSTEXPR bool IsFormatInfoConsistent(size_t index = 0)
+        {
+            return (index >= c_formatInfoCount)
+                || ((s_formatInfo[index].layout != FORMAT_BLOCK || s_formatInfo[index].bytesPerElement == s_formatInfo[index].bitsPerPixel * 2)
+                    && IsFormatViewCompatible(s_formatInfo[index], s_formatInfo[index].srgbFormat)
+                    && IsFormatViewCompatible(s_formatInfo[index], s_formatInfo[index].typedFormat)
+                    && IsFormatInfoConsistent(index + 1));
+        }
 
-            case DXGI_FORMAT_BC3_UNORM:
-                return DXGI_FORMAT_BC3_UNORM_SRGB;
+#ifdef LOADER_STATIC_CHECKS
+        static_assert(c_formatInfoCount == DXGI_FORMAT_B4G4R4A4_UNORM + 1, "Format table must cover every DXGI 1.2 format");
+        static_assert(IsFormatInfoIndexed(), "Format table must be in DXGI_FORMAT order");
+        static_assert(IsFormatInfoConsistent(), "Format table sRGB or typed views differ in size or layout");
+#endif
 
-            case DXGI_FORMAT_B8G8R8A8_UNORM:
-                return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        //--------------------------------------------------------------------------------------
+        // Return the BPP for a particular format
+        //--------------------------------------------------------------------------------------
+        inline LOADER_CONSTEXPR size_t BitsPerPixel(_In_ DXGI_FORMAT fmt)
+        {
+            return GetFormatInfo(fmt).bitsPerPixel;
+        }
 
-            case DXGI_FORMAT_B8G8R8X8_UNORM:
-                return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+        //--------------------------------------------------------------------------------------
+        inline LOADER_CONSTEXPR DXGI_FORMAT MakeSRGB(_In_ DXGI_FORMAT format)
+        {
+            return (GetFormatInfo(format).srgbFormat != DXGI_FORMAT_UNKNOWN) ? GetFormatInfo(format).srgbFormat : format;
+        }
 
-            case DXGI_FORMAT_BC7_UNORM:
-                return DXGI_FORMAT_BC7_UNORM_SRGB;
+        //--------------------------------------------------------------------------------------
+        inline LOADER_CONSTEXPR bool IsCompressed(_In_ DXGI_FORMAT fmt)
+        {
+            return GetFormatInfo(fmt).layout == FORMAT_BLOCK;
+        }
 
-            default:
-                return format;
-            }
+        //--------------------------------------------------------------------------------------
+        inline LOADER_CONSTEXPR DXGI_FORMAT EnsureNotTypeless(DXGI_FORMAT fmt)
+        {
+            // Assumes UNORM or FLOAT; doesn't use UINT or SINT
+            return (GetFormatInfo(fmt).typedFormat != DXGI_FORMAT_UNKNOWN) ? GetFormatInfo(fmt).typedFormat : fmt;
         }
 
+#ifdef LOADER_STATIC_CHECKS
+        static_assert(BitsPerPixel(DXGI_FORMAT_R32G32B32A32_FLOAT) == 128, "BitsPerPixel");
+        static_assert(BitsPerPixel(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB) == 32, "BitsPerPixel");
+        static_assert(BitsPerPixel(DXGI_FORMAT_P010) == 24, "BitsPerPixel");
+        static_assert(BitsPerPixel(DXGI_FORMAT_NV12) == 12, "BitsPerPixel");
+        static_assert(BitsPerPixel(DXGI_FORMAT_R1_UNORM) == 1, "BitsPerPixel");
+        static_assert(BitsPerPixel(DXGI_FORMAT_BC1_UNORM) == 4 && BitsPerPixel(DXGI_FORMAT_BC7_UNORM) == 8, "BitsPerPixel");
+        static_assert(BitsPerPixel(DXGI_FORMAT_UNKNOWN) == 0 && BitsPerPixel(static_cast<DXGI_FORMAT>(c_formatInfoCount)) == 0, "BitsPerPixel");
+        static_assert(MakeSRGB(DXGI_FORMAT_B8G8R8X8_UNORM) == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, "MakeSRGB");
+        static_assert(MakeSRGB(DXGI_FORMAT_BC7_UNORM) == DXGI_FORMAT_BC7_UNORM_SRGB, "MakeSRGB");
+        static_assert(MakeSRGB(DXGI_FORMAT_BC4_UNORM) == DXGI_FORMAT_BC4_UNORM, "MakeSRGB");
+        static_assert(IsCompressed(DXGI_FORMAT_BC6H_SF16) && !IsCompressed(DXGI_FORMAT_YUY2), "IsCompressed");
+        static_assert(EnsureNotTypeless(DXGI_FORMAT_R16G16B16A16_TYPELESS) == DXGI_FORMAT_R16G16B16A16_UNORM, "EnsureNotTypeless");
+        static_assert(EnsureNotTypeless(DXGI_FORMAT_BC6H_TYPELESS) == DXGI_FORMAT_BC6H_TYPELESS, "EnsureNotTypeless");
+#endif
+
         //--------------------------------------------------------------------------------------
-        inline bool IsCompressed(_In_ DXGI_FORMAT fmt)
-        {
-            switch (fmt)
-            {
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                return true;
+        //--------------------------------------------------------------------------------------
+        // Positional reads from a file opened with FILE_FLAG_OVERLAPPED. A single ReadFile copies
+        // cached file data out on one core, so large files (cubemap skies and texture arrays run
+        // to tens of MB) are read as several chunks on their own threads.
+        //--------------------------------------------------------------------------------------
+        inline HRESULT ReadFileAt(_In_ HANDLE hFile, size_t offset, size_t size, _Out_writes_bytes_(size) uint8_t* dest)
+        {
+            ScopedHandle hEvent(safe_handle(CreateEventEx(nullptr, nullptr, CREATE_EVENT_MANUAL_RESET, EVENT_MODIFY_STATE | SYNCHRONIZE)));
+            if (!hEvent)
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
+            }
 
-            default:
-                return false;
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32);
+            overlapped.hEvent = hEvent.get();
+
+            if (!ReadFile(hFile, dest, static_cast<DWORD>(size), nullptr, &overlapped))
+            {
+                DWORD error = GetLastError();
+                if (error != ERROR_IO_PENDING)
+                {
+                    return HRESULT_FROM_WIN32(error);
+                }
+            }
+
+            DWORD bytesRead = 0;
+            if (!GetOverlappedResult(hFile, &overlapped, &bytesRead, TRUE))
+            {
+                return HRESULT_FROM_WIN32(GetLastError());
             }
+
+            return (bytesRead == size) ? S_OK : HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
         }
 
-        //--------------------------------------------------------------------------------------
-        inline DXGI_FORMAT EnsureNotTypeless(DXGI_FORMAT fmt)
+        inline HRESULT ReadFileParallel(_In_ HANDLE hFile, size_t size, _Out_writes_bytes_(size) uint8_t* dest)
         {
-            // Assumes UNORM or FLOAT; doesn't use UINT or SINT
-            switch (fmt)
-            {
-            case DXGI_FORMAT_R32G32B32A32_TYPELESS: return DXGI_FORMAT_R32G32B32A32_FLOAT;
-            case DXGI_FORMAT_R32G32B32_TYPELESS:    return DXGI_FORMAT_R32G32B32_FLOAT;
-            case DXGI_FORMAT_R16G16B16A16_TYPELESS: return DXGI_FORMAT_R16G16B16A16_UNORM;
-            case DXGI_FORMAT_R32G32_TYPELESS:       return DXGI_FORMAT_R32G32_FLOAT;
-            case DXGI_FORMAT_R10G10B10A2_TYPELESS:  return DXGI_FORMAT_R10G10B10A2_UNORM;
-            case DXGI_FORMAT_R8G8B8A8_TYPELESS:     return DXGI_FORMAT_R8G8B8A8_UNORM;
-            case DXGI_FORMAT_R16G16_TYPELESS:       return DXGI_FORMAT_R16G16_UNORM;
-            case DXGI_FORMAT_R32_TYPELESS:          return DXGI_FORMAT_R32_FLOAT;
-            case DXGI_FORMAT_R8G8_TYPELESS:         return DXGI_FORMAT_R8G8_UNORM;
-            case DXGI_FORMAT_R16_TYPELESS:          return DXGI_FORMAT_R16_UNORM;
-            case DXGI_FORMAT_R8_TYPELESS:           return DXGI_FORMAT_R8_UNORM;
-            case DXGI_FORMAT_BC1_TYPELESS:          return DXGI_FORMAT_BC1_UNORM;
-            case DXGI_FORMAT_BC2_TYPELESS:          return DXGI_FORMAT_BC2_UNORM;
-            case DXGI_FORMAT_BC3_TYPELESS:          return DXGI_FORMAT_BC3_UNORM;
-            case DXGI_FORMAT_BC4_TYPELESS:          return DXGI_FORMAT_BC4_UNORM;
-            case DXGI_FORMAT_BC5_TYPELESS:          return DXGI_FORMAT_BC5_UNORM;
-            case DXGI_FORMAT_B8G8R8A8_TYPELESS:     return DXGI_FORMAT_B8G8R8A8_UNORM;
-            case DXGI_FORMAT_B8G8R8X8_TYPELESS:     return DXGI_FORMAT_B8G8R8X8_UNORM;
-            case DXGI_FORMAT_BC7_TYPELESS:          return DXGI_FORMAT_BC7_UNORM;
-            default:                                return fmt;
+            const size_t minChunkSize = 4 * 1024 * 1024;
+            const size_t maxThreads = 8;
+
+            size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), maxThreads);
+            threadCount = std::min(threadCount, size / minChunkSize);
+
+            if (threadCount <= 1)
+            {
+                return ReadFileAt(hFile, 0, size, dest);
+            }
+
+            size_t chunkSize = (size + threadCount - 1) / threadCount;
+
+            std::vector<HRESULT> results(threadCount, S_OK);
+            auto readChunk = [&](size_t j)
+            {
+                size_t offset = j * chunkSize;
+                results[j] = ReadFileAt(hFile, offset, std::min(chunkSize, size - offset), dest + offset);
+            };
+
+            std::vector<std::thread> threads;
+            for (size_t j = 1; j < threadCount; ++j)
+            {
+                try
+                {
+                    threads.emplace_back(readChunk, j);
+                }
+                catch (const std::system_error&)
+                {
+                    // Out of threads, so read this chunk here instead
+                    readChunk(j);
+                }
+            }
+
+            readChunk(0);
+
+            for (auto& t : threads)
+            {
+                t.join();
             }
+
+            for (auto hr : results)
+            {
+                if (FAILED(hr))
+                {
+                    return hr;
+                }
+            }
+
+            return S_OK;
         }
 
         //--------------------------------------------------------------------------------------
@@ -296,20 +397,25 @@ namespace DirectX
                 return E_POINTER;
             }
 
-            // open the file
+            // open the file for positional reads
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+            CREATEFILE2_EXTENDED_PARAMETERS params = {};
+            params.dwSize = sizeof(params);
+            params.dwFileAttributes = FILE_ATTRIBUTE_NORMAL;
+            params.dwFileFlags = FILE_FLAG_OVERLAPPED;
+
             ScopedHandle hFile(safe_handle(CreateFile2(fileName,
                 GENERIC_READ,
                 FILE_SHARE_READ,
                 OPEN_EXISTING,
-                nullptr)));
+                &params)));
 #else
             ScopedHandle hFile(safe_handle(CreateFileW(fileName,
                 GENERIC_READ,
                 FILE_SHARE_READ,
                 nullptr,
                 OPEN_EXISTING,
-                FILE_ATTRIBUTE_NORMAL,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
                 nullptr)));
 #endif
 
@@ -345,20 +451,10 @@ namespace DirectX
             }
 
             // read the data in
-            DWORD BytesRead = 0;
-            if (!ReadFile(hFile.get(),
-                ddsData.get(),
-                fileInfo.EndOfFile.LowPart,
-                &BytesRead,
-                nullptr
-            ))
-            {
-                return HRESULT_FROM_WIN32(GetLastError());
-            }
-
-            if (BytesRead < fileInfo.EndOfFile.LowPart)
+            HRESULT hr = ReadFileParallel(hFile.get(), fileInfo.EndOfFile.LowPart, ddsData.get());
+            if (FAILED(hr))
             {
-                return E_FAIL;
+                return (hr == HRESULT_FROM_WIN32(ERROR_HANDLE_EOF)) ? E_FAIL : hr;
             }
 
             // DDS files always start with the same magic number ("DDS ")
@@ -415,118 +511,51 @@ namespace DirectX
             size_t rowBytes = 0;
             size_t numRows = 0;
 
-            bool bc = false;
-            bool packed = false;
-            bool planar = false;
-            size_t bpe = 0;
-            switch (fmt)
-            {
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-                bc = true;
-                bpe = 8;
-                break;
-
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                bc = true;
-                bpe = 16;
-                break;
-
-            case DXGI_FORMAT_R8G8_B8G8_UNORM:
-            case DXGI_FORMAT_G8R8_G8B8_UNORM:
-            case DXGI_FORMAT_YUY2:
-                packed = true;
-                bpe = 4;
-                break;
-
-            case DXGI_FORMAT_Y210:
-            case DXGI_FORMAT_Y216:
-                packed = true;
-                bpe = 8;
-                break;
-
-            case DXGI_FORMAT_NV12:
-            case DXGI_FORMAT_420_OPAQUE:
-                planar = true;
-                bpe = 2;
-                break;
-
-            case DXGI_FORMAT_P010:
-            case DXGI_FORMAT_P016:
-                planar = true;
-                bpe = 4;
-                break;
-
-#if defined(_XBOX_ONE) && defined(_TITLE)
-
-            case DXGI_FORMAT_D16_UNORM_S8_UINT:
-            case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-                planar = true;
-                bpe = 4;
-                break;
-
-#endif
-            }
-
-            if (bc)
+            const DXGIFormatInfo& info = GetFormatInfo(fmt);
+            size_t bpe = info.bytesPerElement;
+            switch (info.layout)
             {
-                size_t numBlocksWide = 0;
-                if (width > 0)
-                {
-                    numBlocksWide = std::max<size_t>(1, (width + 3) / 4);
-                }
-                size_t numBlocksHigh = 0;
-                if (height > 0)
+            case FORMAT_BLOCK:
                 {
-                    numBlocksHigh = std::max<size_t>(1, (height + 3) / 4);
+                    size_t numBlocksWide = 0;
+                    if (width > 0)
+                    {
+                        numBlocksWide = std::max<size_t>(1, (width + 3) / 4);
+                    }
+                    size_t numBlocksHigh = 0;
+                    if (height > 0)
+                    {
+                        numBlocksHigh = std::max<size_t>(1, (height + 3) / 4);
+                    }
+                    rowBytes = numBlocksWide * bpe;
+                    numRows = numBlocksHigh;
+                    numBytes = rowBytes * numBlocksHigh;
                 }
-                rowBytes = numBlocksWide * bpe;
-                numRows = numBlocksHigh;
-                numBytes = rowBytes * numBlocksHigh;
-            }
-            else if (packed)
-            {
+                break;
+
+            case FORMAT_PACKED:
                 rowBytes = ((width + 1) >> 1) * bpe;
                 numRows = height;
                 numBytes = rowBytes * height;
-            }
-            else if (fmt == DXGI_FORMAT_NV11)
-            {
+                break;
+
+            case FORMAT_NV11:
                 rowBytes = ((width + 3) >> 2) * 4;
                 numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
                 numBytes = rowBytes * numRows;
-            }
-            else if (planar)
-            {
+                break;
+
+            case FORMAT_PLANAR:
                 rowBytes = ((width + 1) >> 1) * bpe;
                 numBytes = (rowBytes * height) + ((rowBytes * height + 1) >> 1);
                 numRows = height + ((height + 1) >> 1);
-            }
-            else
-            {
-                size_t bpp = BitsPerPixel(fmt);
-                rowBytes = (width * bpp + 7) / 8; // round up to nearest byte
+                break;
+
+            default:
+                rowBytes = (width * info.bitsPerPixel + 7) / 8; // round up to nearest byte
                 numRows = height;
                 numBytes = rowBytes * height;
+                break;
             }
 
             if (outNumBytes)
@@ -544,249 +573,371 @@ namespace DirectX
         }
 
         //--------------------------------------------------------------------------------------
-#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
+        // Pitches and offsets of one array item's mip chain. Every item of an array (and every
+        // face of a cubemap) shares the same layout, so it is computed once per format and size,
+        // and recent layouts are cached across loads.
+        //--------------------------------------------------------------------------------------
+        struct DDSMipLayout
+        {
+            size_t width;
+            size_t height;
+            size_t depth;
+            size_t rowPitch;
+            size_t slicePitch;
+            size_t offset;          // Bytes from the start of the array item
+        };
 
-        inline DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf)
+        struct DDSSubresourceLayout
         {
-            if (ddpf.flags & DDS_RGB)
+            DXGI_FORMAT format;
+            size_t width;
+            size_t height;
+            size_t depth;
+            size_t itemSize;        // Bytes in one array item's whole mip chain
+            std::vector<DDSMipLayout> mips;
+        };
+
+        inline std::shared_ptr<const DDSSubresourceLayout> GetDDSSubresourceLayout(_In_ size_t width,
+            _In_ size_t height,
+            _In_ size_t depth,
+            _In_ size_t mipCount,
+            _In_ DXGI_FORMAT format)
+        {
+            const size_t maxCachedLayouts = 32;
+
+            static std::mutex s_mutex;
+            static std::vector<std::shared_ptr<const DDSSubresourceLayout>> s_layouts; // Most recently used last
+
             {
-                // Note that sRGB formats are written using the "DX10" extended header
+                std::lock_guard<std::mutex> lock(s_mutex);
 
-                switch (ddpf.RGBBitCount)
+                for (auto it = s_layouts.begin(); it != s_layouts.end(); ++it)
                 {
-                case 32:
-                    if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
+                    auto& layout = **it;
+                    if (layout.format == format && layout.width == width && layout.height == height
+                        && layout.depth == depth && layout.mips.size() == mipCount)
                     {
-                        return DXGI_FORMAT_R8G8B8A8_UNORM;
+                        auto result = *it;
+                        s_layouts.erase(it);
+                        s_layouts.push_back(result);
+                        return result;
                     }
+                }
+            }
 
-                    if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000))
-                    {
-                        return DXGI_FORMAT_B8G8R8A8_UNORM;
-                    }
+            auto layout = std::make_shared<DDSSubresourceLayout>();
+            layout->format = format;
+            layout->width = width;
+            layout->height = height;
+            layout->depth = depth;
+            layout->mips.resize(mipCount);
+
+            size_t w = width;
+            size_t h = height;
+            size_t d = depth;
+            size_t offset = 0;
+            for (auto& mip : layout->mips)
+            {
+                GetSurfaceInfo(w, h, format, &mip.slicePitch, &mip.rowPitch, nullptr);
 
-                    if (ISBITMASK(0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000))
-                    {
-                        return DXGI_FORMAT_B8G8R8X8_UNORM;
-                    }
+                mip.width = w;
+                mip.height = h;
+                mip.depth = d;
+                mip.offset = offset;
 
-                    // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+                offset += mip.slicePitch * d;
 
-                    // Note that many common DDS reader/writers (including D3DX) swap the
-                    // the RED/BLUE masks for 10:10:10:2 formats. We assume
-                    // below that the 'backwards' header mask is being used since it is most
-                    // likely written by D3DX. The more robust solution is to use the 'DX10'
-                    // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+                w = std::max<size_t>(1, w >> 1);
+                h = std::max<size_t>(1, h >> 1);
+                d = std::max<size_t>(1, d >> 1);
+            }
 
-                    // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
-                    if (ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000))
-                    {
-                        return DXGI_FORMAT_R10G10B10A2_UNORM;
-                    }
+            layout->itemSize = offset;
 
-                    // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+            std::lock_guard<std::mutex> lock(s_mutex);
 
-                    if (ISBITMASK(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R16G16_UNORM;
-                    }
+            if (s_layouts.size() >= maxCachedLayouts)
+            {
+                s_layouts.erase(s_layouts.begin());
+            }
 
-                    if (ISBITMASK(0xffffffff, 0x00000000, 0x00000000, 0x00000000))
-                    {
-                        // Only 32-bit color channel format in D3D9 was R32F
-                        return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
-                    }
-                    break;
+            s_layouts.push_back(layout);
 
-                case 24:
-                    // No 24bpp DXGI formats aka D3DFMT_R8G8B8
-                    break;
+            return layout;
+        }
 
-                case 16:
-                    if (ISBITMASK(0x7c00, 0x03e0, 0x001f, 0x8000))
-                    {
-                        return DXGI_FORMAT_B5G5R5A1_UNORM;
-                    }
-                    if (ISBITMASK(0xf800, 0x07e0, 0x001f, 0x0000))
-                    {
-                        return DXGI_FORMAT_B5G6R5_UNORM;
-                    }
+        //--------------------------------------------------------------------------------------
+        // Location of each subresource within a DDS file, so that a loader can read just the
+        // mips it needs. Array items are stored in order, each holding its whole mip chain.
+        //--------------------------------------------------------------------------------------
+        struct DDSSubresourceRange
+        {
+            size_t mipLevel;
+            size_t arrayIndex;
+            size_t offset;          // Bytes from the start of the file
+            size_t size;
+            size_t rowPitch;
+            size_t slicePitch;
+        };
 
-                    // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+        struct DDSFileRange
+        {
+            size_t offset;
+            size_t size;
+        };
 
-                    if (ISBITMASK(0x0f00, 0x00f0, 0x000f, 0xf000))
-                    {
-                        return DXGI_FORMAT_B4G4R4A4_UNORM;
-                    }
+        inline HRESULT GetDDSSubresourceRanges(_In_ size_t bitOffset,
+            _In_ size_t width,
+            _In_ size_t height,
+            _In_ size_t depth,
+            _In_ size_t mipCount,
+            _In_ size_t arraySize,
+            _In_ DXGI_FORMAT format,
+            _In_ size_t fileSize,
+            std::vector<DDSSubresourceRange>& ranges)
+        {
+            ranges.clear();
 
-                    // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+            auto layout = GetDDSSubresourceLayout(width, height, depth, mipCount, format);
 
-                    // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
-                    break;
-                }
-            }
-            else if (ddpf.flags & DDS_LUMINANCE)
+            if (bitOffset > fileSize || (arraySize && layout->itemSize > (fileSize - bitOffset) / arraySize))
             {
-                if (8 == ddpf.RGBBitCount)
-                {
-                    if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
+                return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+            }
 
-                    // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+            ranges.reserve(mipCount * arraySize);
 
-                    if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
-                    {
-                        return DXGI_FORMAT_R8G8_UNORM; // Some DDS writers assume the bitcount should be 8 instead of 16
-                    }
-                }
-
-                if (16 == ddpf.RGBBitCount)
-                {
-                    if (ISBITMASK(0x0000ffff, 0x00000000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-                    if (ISBITMASK(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00))
-                    {
-                        return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-                }
-            }
-            else if (ddpf.flags & DDS_ALPHA)
+            for (size_t j = 0; j < arraySize; j++)
             {
-                if (8 == ddpf.RGBBitCount)
+                size_t itemOffset = bitOffset + j * layout->itemSize;
+                for (size_t i = 0; i < mipCount; i++)
                 {
-                    return DXGI_FORMAT_A8_UNORM;
+                    auto& mip = layout->mips[i];
+
+                    DDSSubresourceRange range = { i, j, itemOffset + mip.offset, mip.slicePitch * mip.depth, mip.rowPitch, mip.slicePitch };
+                    ranges.push_back(range);
                 }
             }
-            else if (ddpf.flags & DDS_BUMPDUDV)
-            {
-                if (16 == ddpf.RGBBitCount)
-                {
-                    if (ISBITMASK(0x00ff, 0xff00, 0x0000, 0x0000))
-                    {
-                        return DXGI_FORMAT_R8G8_SNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-                }
 
-                if (32 == ddpf.RGBBitCount)
-                {
-                    if (ISBITMASK(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000))
-                    {
-                        return DXGI_FORMAT_R8G8B8A8_SNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
-                    if (ISBITMASK(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000))
-                    {
-                        return DXGI_FORMAT_R16G16_SNORM; // D3DX10/11 writes this out as DX10 extension
-                    }
+            return S_OK;
+        }
 
-                    // No DXGI format maps to ISBITMASK(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000) aka D3DFMT_A2W10V10U10
-                }
-            }
-            else if (ddpf.flags & DDS_FOURCC)
+        // File reads covering mips [firstMip, endMip) of every array item, merging ranges that
+        // are adjacent in the file so that, for example, the mip tail of a 2D texture is one read.
+        inline void PlanDDSReads(const std::vector<DDSSubresourceRange>& ranges,
+            _In_ size_t firstMip,
+            _In_ size_t endMip,
+            std::vector<DDSFileRange>& reads)
+        {
+            reads.clear();
+
+            for (auto& range : ranges)
             {
-                if (MAKEFOURCC('D', 'X', 'T', '1') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC1_UNORM;
-                }
-                if (MAKEFOURCC('D', 'X', 'T', '3') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC2_UNORM;
-                }
-                if (MAKEFOURCC('D', 'X', 'T', '5') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC3_UNORM;
-                }
+                if (range.mipLevel < firstMip || range.mipLevel >= endMip)
+                    continue;
 
-                // While pre-multiplied alpha isn't directly supported by the DXGI formats,
-                // they are basically the same as these BC formats so they can be mapped
-                if (MAKEFOURCC('D', 'X', 'T', '2') == ddpf.fourCC)
+                if (!reads.empty() && reads.back().offset + reads.back().size == range.offset)
                 {
-                    return DXGI_FORMAT_BC2_UNORM;
+                    reads.back().size += range.size;
                 }
-                if (MAKEFOURCC('D', 'X', 'T', '4') == ddpf.fourCC)
+                else
                 {
-                    return DXGI_FORMAT_BC3_UNORM;
+                    DDSFileRange read = { range.offset, range.size };
+                    reads.push_back(read);
                 }
+            }
+        }
 
-                if (MAKEFOURCC('A', 'T', 'I', '1') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC4_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '4', 'U') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC4_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '4', 'S') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC4_SNORM;
-                }
+        //--------------------------------------------------------------------------------------
+        // Legacy (non-"DX10") pixel formats with channel masks. A header is matched against
+        // its pixel format class in one pass; FourCC codes are resolved with a single switch.
+        //--------------------------------------------------------------------------------------
+        struct DDSMaskedFormat
+        {
+            uint32_t    flags;          // DDS_RGB, DDS_LUMINANCE or DDS_BUMPDUDV
+            uint32_t    RGBBitCount;
+            uint32_t    RBitMask;
+            uint32_t    GBitMask;
+            uint32_t    BBitMask;
+            uint32_t    ABitMask;
+            DXGI_FORMAT format;
+        };
 
-                if (MAKEFOURCC('A', 'T', 'I', '2') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC5_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '5', 'U') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC5_UNORM;
-                }
-                if (MAKEFOURCC('B', 'C', '5', 'S') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_BC5_SNORM;
-                }
+        LOADER_CONST DDSMaskedFormat s_maskedFormats[] =
+        {
+            // Note that sRGB formats are written using the "DX10" extended header
+            { DDS_RGB,       32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000, DXGI_FORMAT_R8G8B8A8_UNORM },
+            { DDS_RGB,       32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000, DXGI_FORMAT_B8G8R8A8_UNORM },
+            { DDS_RGB,       32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000, DXGI_FORMAT_B8G8R8X8_UNORM },
 
-                // BC6H and BC7 are written using the "DX10" extended header
+            // No DXGI format maps to (0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
 
-                if (MAKEFOURCC('R', 'G', 'B', 'G') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_R8G8_B8G8_UNORM;
-                }
-                if (MAKEFOURCC('G', 'R', 'G', 'B') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_G8R8_G8B8_UNORM;
-                }
+            // Note that many common DDS reader/writers (including D3DX) swap the
+            // the RED/BLUE masks for 10:10:10:2 formats. We assume
+            // below that the 'backwards' header mask is being used since it is most
+            // likely written by D3DX. The more robust solution is to use the 'DX10'
+            // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
 
-                if (MAKEFOURCC('Y', 'U', 'Y', '2') == ddpf.fourCC)
-                {
-                    return DXGI_FORMAT_YUY2;
-                }
+            // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+            { DDS_RGB,       32, 0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000, DXGI_FORMAT_R10G10B10A2_UNORM },
 
-                // Check for D3DFORMAT enums being set here
-                switch (ddpf.fourCC)
-                {
-                case 36: // D3DFMT_A16B16G16R16
-                    return DXGI_FORMAT_R16G16B16A16_UNORM;
+            // No DXGI format maps to (0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+            { DDS_RGB,       32, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000, DXGI_FORMAT_R16G16_UNORM },
+
+            // Only 32-bit color channel format in D3D9 was R32F
+            { DDS_RGB,       32, 0xffffffff, 0x00000000, 0x00000000, 0x00000000, DXGI_FORMAT_R32_FLOAT }, // D3DX writes this out as a FourCC of 114
+
+            // No 24bpp DXGI formats aka D3DFMT_R8G8B8
+
+            { DDS_RGB,       16, 0x7c00,     0x03e0,     0x001f,     0x8000,     DXGI_FORMAT_B5G5R5A1_UNORM },
+            { DDS_RGB,       16, 0xf800,     0x07e0,     0x001f,     0x0000,     DXGI_FORMAT_B5G6R5_UNORM },
+
+            // No DXGI format maps to (0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+            { DDS_RGB,       16, 0x0f00,     0x00f0,     0x000f,     0xf000,     DXGI_FORMAT_B4G4R4A4_UNORM },
+
+            // No DXGI format maps to (0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+            // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+
+            { DDS_LUMINANCE,  8, 0x000000ff, 0x00000000, 0x00000000, 0x00000000, DXGI_FORMAT_R8_UNORM }, // D3DX10/11 writes this out as DX10 extension
+
+            // No DXGI format maps to (0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+
+            { DDS_LUMINANCE,  8, 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00, DXGI_FORMAT_R8G8_UNORM }, // Some DDS writers assume the bitcount should be 8 instead of 16
+            { DDS_LUMINANCE, 16, 0x0000ffff, 0x00000000, 0x00000000, 0x00000000, DXGI_FORMAT_R16_UNORM }, // D3DX10/11 writes this out as DX10 extension
+            { DDS_LUMINANCE, 16, 0x000000ff, 0x00000000, 0x00000000, 0x0000ff00, DXGI_FORMAT_R8G8_UNORM }, // D3DX10/11 writes this out as DX10 extension
+
+            { DDS_BUMPDUDV,  16, 0x00ff,     0xff00,     0x0000,     0x0000,     DXGI_FORMAT_R8G8_SNORM }, // D3DX10/11 writes this out as DX10 extension
+            { DDS_BUMPDUDV,  32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000, DXGI_FORMAT_R8G8B8A8_SNORM }, // D3DX10/11 writes this out as DX10 extension
+            { DDS_BUMPDUDV,  32, 0x0000ffff, 0xffff0000, 0x00000000, 0x00000000, DXGI_FORMAT_R16G16_SNORM }, // D3DX10/11 writes this out as DX10 extension
+
+            // No DXGI format maps to (0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000) aka D3DFMT_A2W10V10U10
+        };
+
+        //--------------------------------------------------------------------------------------
+        inline DXGI_FORMAT GetDXGIFormatFromFourCC(uint32_t fourCC)
+        {
+            switch (fourCC)
+            {
+            case MAKEFOURCC('D', 'X', 'T', '1'):
+                return DXGI_FORMAT_BC1_UNORM;
+
+            case MAKEFOURCC('D', 'X', 'T', '3'):
+                return DXGI_FORMAT_BC2_UNORM;
+
+            case MAKEFOURCC('D', 'X', 'T', '5'):
+                return DXGI_FORMAT_BC3_UNORM;
+
+            // While pre-multiplied alpha isn't directly supported by the DXGI formats,
+            // they are basically the same as these BC formats so they can be mapped
+            case MAKEFOURCC('D', 'X', 'T', '2'):
+                return DXGI_FORMAT_BC2_UNORM;
+
+            case MAKEFOURCC('D', 'X', 'T', '4'):
+                return DXGI_FORMAT_BC3_UNORM;
+
+            case MAKEFOURCC('A', 'T', 'I', '1'):
+            case MAKEFOURCC('B', 'C', '4', 'U'):
+                return DXGI_FORMAT_BC4_UNORM;
+
+            case MAKEFOURCC('B', 'C', '4', 'S'):
+                return DXGI_FORMAT_BC4_SNORM;
+
+            case MAKEFOURCC('A', 'T', 'I', '2'):
+            case MAKEFOURCC('B', 'C', '5', 'U'):
+                return DXGI_FORMAT_BC5_UNORM;
+
+            case MAKEFOURCC('B', 'C', '5', 'S'):
+                return DXGI_FORMAT_BC5_SNORM;
+
+            // BC6H and BC7 are written using the "DX10" extended header
+
+            case MAKEFOURCC('R', 'G', 'B', 'G'):
+                return DXGI_FORMAT_R8G8_B8G8_UNORM;
+
+            case MAKEFOURCC('G', 'R', 'G', 'B'):
+                return DXGI_FORMAT_G8R8_G8B8_UNORM;
+
+            case MAKEFOURCC('Y', 'U', 'Y', '2'):
+                return DXGI_FORMAT_YUY2;
+
+            // Check for D3DFORMAT enums being set here
+            case 36: // D3DFMT_A16B16G16R16
+                return DXGI_FORMAT_R16G16B16A16_UNORM;
+
+            case 110: // D3DFMT_Q16W16V16U16
+                return DXGI_FORMAT_R16G16B16A16_SNORM;
 
-                case 110: // D3DFMT_Q16W16V16U16
-                    return DXGI_FORMAT_R16G16B16A16_SNORM;
+            case 111: // D3DFMT_R16F
+                return DXGI_FORMAT_R16_FLOAT;
 
-                case 111: // D3DFMT_R16F
-                    return DXGI_FORMAT_R16_FLOAT;
+            case 112: // D3DFMT_G16R16F
+                return DXGI_FORMAT_R16G16_FLOAT;
 
-                case 112: // D3DFMT_G16R16F
-                    return DXGI_FORMAT_R16G16_FLOAT;
+            case 113: // D3DFMT_A16B16G16R16F
+                return DXGI_FORMAT_R16G16B16A16_FLOAT;
 
-                case 113: // D3DFMT_A16B16G16R16F
-                    return DXGI_FORMAT_R16G16B16A16_FLOAT;
+            case 114: // D3DFMT_R32F
+                return DXGI_FORMAT_R32_FLOAT;
 
-                case 114: // D3DFMT_R32F
-                    return DXGI_FORMAT_R32_FLOAT;
+            case 115: // D3DFMT_G32R32F
+                return DXGI_FORMAT_R32G32_FLOAT;
 
-                case 115: // D3DFMT_G32R32F
-                    return DXGI_FORMAT_R32G32_FLOAT;
+            case 116: // D3DFMT_A32B32G32R32F
+                return DXGI_FORMAT_R32G32B32A32_FLOAT;
 
-                case 116: // D3DFMT_A32B32G32R32F
-                    return DXGI_FORMAT_R32G32B32A32_FLOAT;
+            default:
+                return DXGI_FORMAT_UNKNOWN;
+            }
+        }
+
+        //--------------------------------------------------------------------------------------
+        inline DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf)
+        {
+            uint32_t pfClass;
+            if (ddpf.flags & DDS_RGB)
+            {
+                pfClass = DDS_RGB;
+            }
+            else if (ddpf.flags & DDS_LUMINANCE)
+            {
+                pfClass = DDS_LUMINANCE;
+            }
+            else if (ddpf.flags & DDS_ALPHA)
+            {
+                return (8 == ddpf.RGBBitCount) ? DXGI_FORMAT_A8_UNORM : DXGI_FORMAT_UNKNOWN;
+            }
+            else if (ddpf.flags & DDS_BUMPDUDV)
+            {
+                pfClass = DDS_BUMPDUDV;
+            }
+            else if (ddpf.flags & DDS_FOURCC)
+            {
+                return GetDXGIFormatFromFourCC(ddpf.fourCC);
+            }
+            else
+            {
+                return DXGI_FORMAT_UNKNOWN;
+            }
+
+            for (const auto& entry : s_maskedFormats)
+            {
+                if (entry.flags == pfClass
+                    && entry.RGBBitCount == ddpf.RGBBitCount
+                    && entry.RBitMask == ddpf.RBitMask
+                    && entry.GBitMask == ddpf.GBitMask
+                    && entry.BBitMask == ddpf.BBitMask
+                    && entry.ABitMask == ddpf.ABitMask)
+                {
+                    return entry.format;
                 }
             }
 
             return DXGI_FORMAT_UNKNOWN;
         }
 
-#undef ISBITMASK
-
         //--------------------------------------------------------------------------------------
         inline DirectX::DDS_ALPHA_MODE GetAlphaMode(_In_ const DDS_HEADER* header)
         {
@@ -815,6 +966,34 @@ namespace DirectX
             return DDS_ALPHA_MODE_UNKNOWN;
         }
 
+        //--------------------------------------------------------------------------------------
+        // A 2D image decoded into system memory, top level first. WICTextureLoader decodes
+        // into this and TextureCache keeps it, so a texture can be recreated without decoding.
+        //--------------------------------------------------------------------------------------
+        struct DecodedImage
+        {
+            struct Level
+            {
+                size_t                  width;
+                size_t                  height;
+                size_t                  rowPitch;
+                std::vector<uint8_t>    pixels;
+            };
+
+            DXGI_FORMAT         format;
+            std::vector<Level>  levels;
+
+            size_t GetSize() const
+            {
+                size_t size = 0;
+                for (auto it = levels.cbegin(); it != levels.cend(); ++it)
+                {
+                    size += it->pixels.size();
+                }
+                return size;
+            }
+        };
+
         //--------------------------------------------------------------------------------------
         class auto_delete_file
         {
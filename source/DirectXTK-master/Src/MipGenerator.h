@@ -0,0 +1,435 @@
+//--------------------------------------------------------------------------------------
+// File: MipGenerator.h
+//
+// CPU mipmap chain generator for 8-bit RGBA images, used by the texture loaders when the
+// device can't (or shouldn't) generate mips, and by the command-line tools. sRGB data is
+// filtered in linear space. Like BlockCompression.h, this header only depends on the C++
+// standard library (and SSE2 where available).
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define DIRECTX_MIP_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace DirectX
+{
+    namespace MipGeneration
+    {
+        enum MIP_FLAGS
+        {
+            MIP_DEFAULT         = 0,
+            MIP_SRGB            = 0x1,  // Texels are sRGB encoded, so filter in linear space
+            MIP_ALPHA_WEIGHTED  = 0x2,  // Weight color by alpha (for straight, non-premultiplied alpha)
+            MIP_KAISER          = 0x4,  // Kaiser-windowed sinc rather than a box filter
+        };
+
+        // One level of the chain, tightly packed at 4 bytes per texel.
+        struct MipLevel
+        {
+            size_t                  width;
+            size_t                  height;
+            std::vector<uint8_t>    pixels;
+        };
+
+        inline size_t CountMips(size_t width, size_t height)
+        {
+            size_t levels = 1;
+            while (width > 1 || height > 1)
+            {
+                width = std::max<size_t>(1, width / 2);
+                height = std::max<size_t>(1, height / 2);
+                ++levels;
+            }
+            return levels;
+        }
+
+        namespace Internal
+        {
+            // Source texels and weights contributing to each destination texel along one axis.
+            struct FilterTaps
+            {
+                size_t                  tapCount;
+                std::vector<size_t>     first;
+                std::vector<float>      weights;    // tapCount per destination texel
+            };
+
+            inline double BesselI0(double x)
+            {
+                double sum = 1.0;
+                double term = 1.0;
+                for (int k = 1; k < 32; ++k)
+                {
+                    term *= (x * 0.5 / k) * (x * 0.5 / k);
+                    sum += term;
+                    if (term < sum * 1e-12)
+                        break;
+                }
+                return sum;
+            }
+
+            inline double KaiserSinc(double t)
+            {
+                const double radius = 3.0;
+                const double beta = 4.0;
+                const double pi = 3.14159265358979323846;
+
+                if (fabs(t) >= radius)
+                    return 0.0;
+
+                double sinc = (t == 0.0) ? 1.0 : sin(pi * t) / (pi * t);
+                double x = t / radius;
+                return sinc * BesselI0(beta * sqrt(1.0 - x * x)) / BesselI0(beta);
+            }
+
+            // The box filter weights each source texel by how much of it the destination texel
+            // covers, so odd sizes are resampled exactly. The Kaiser filter spans 3 destination
+            // texels either side and clamps at the edges.
+            inline void BuildTaps(size_t srcSize, size_t dstSize, bool kaiser, FilterTaps& taps)
+            {
+                double scale = double(srcSize) / double(dstSize);
+
+                std::vector<std::vector<double>> rows(dstSize);
+                taps.first.resize(dstSize);
+                taps.tapCount = 0;
+
+                for (size_t i = 0; i < dstSize; ++i)
+                {
+                    double lo, hi;
+                    if (kaiser)
+                    {
+                        double center = (double(i) + 0.5) * scale;
+                        lo = center - 3.0 * scale;
+                        hi = center + 3.0 * scale;
+                    }
+                    else
+                    {
+                        lo = double(i) * scale;
+                        hi = double(i + 1) * scale;
+                    }
+
+                    auto first = size_t(std::max(0.0, floor(lo)));
+                    auto last = std::min(srcSize - 1, size_t(std::max(0.0, ceil(hi) - 1.0)));
+
+                    auto& row = rows[i];
+                    row.assign(last - first + 1, 0.0);
+
+                    for (double s = floor(lo); s < hi; s += 1.0)
+                    {
+                        double w;
+                        if (kaiser)
+                        {
+                            w = KaiserSinc((s + 0.5 - (double(i) + 0.5) * scale) / scale);
+                        }
+                        else
+                        {
+                            w = std::min(hi, s + 1.0) - std::max(lo, s);
+                        }
+
+                        auto index = size_t(std::min(std::max(s, double(first)), double(last)));
+                        row[index - first] += w;
+                    }
+
+                    double total = 0.0;
+                    for (auto w : row)
+                        total += w;
+
+                    for (auto& w : row)
+                        w /= total;
+
+                    taps.first[i] = first;
+                    taps.tapCount = std::max(taps.tapCount, row.size());
+                }
+
+                // Pad every texel to the same tap count, shifting the window back at the far edge
+                taps.weights.assign(dstSize * taps.tapCount, 0.f);
+                for (size_t i = 0; i < dstSize; ++i)
+                {
+                    auto& row = rows[i];
+                    size_t first = std::min(taps.first[i], srcSize - std::min(srcSize, taps.tapCount));
+                    for (size_t k = 0; k < row.size(); ++k)
+                    {
+                        taps.weights[i * taps.tapCount + (taps.first[i] - first) + k] = float(row[k]);
+                    }
+                    taps.first[i] = first;
+                }
+            }
+
+            struct SRGBTables
+            {
+                float   toLinear[256];
+                float   thresholds[256];    // Linear value at which each 8-bit code starts
+                uint8_t coarse[4096];
+
+                SRGBTables()
+                {
+                    for (int j = 0; j < 256; ++j)
+                    {
+                        toLinear[j] = Decode(float(j) / 255.f);
+                        thresholds[j] = (j == 0) ? 0.f : Decode((float(j) - 0.5f) / 255.f);
+                    }
+
+                    for (int j = 0; j < 4096; ++j)
+                    {
+                        float c = float(j) / 4095.f;
+                        int code = 0;
+                        while (code < 255 && thresholds[code + 1] <= c)
+                            ++code;
+                        coarse[j] = uint8_t(code);
+                    }
+                }
+
+                static float Decode(float c)
+                {
+                    return (c <= 0.04045f) ? (c / 12.92f) : powf((c + 0.055f) / 1.055f, 2.4f);
+                }
+
+                // Table lookup followed by at most a step or two to land on the exact rounding.
+                uint8_t Encode(float c) const
+                {
+                    c = std::min(std::max(c, 0.f), 1.f);
+                    int code = coarse[int(c * 4095.f)];
+                    while (code < 255 && thresholds[code + 1] <= c)
+                        ++code;
+                    while (code > 0 && thresholds[code] > c)
+                        --code;
+                    return uint8_t(code);
+                }
+            };
+
+            inline const SRGBTables& GetSRGBTables()
+            {
+                static const SRGBTables s_tables;
+                return s_tables;
+            }
+
+            inline uint8_t ToUNORM(float c)
+            {
+                c = std::min(std::max(c, 0.f), 1.f);
+                return uint8_t(c * 255.f + 0.5f);
+            }
+
+            // Runs row(first, last) over bands of rows, using every core for large images.
+            template<typename TBand>
+            void ForEachBand(size_t rows, size_t rowCost, unsigned threadCount, TBand band)
+            {
+                const size_t bandSize = 8;
+                size_t bands = (rows + bandSize - 1) / bandSize;
+
+                if (!threadCount)
+                    threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+                // Spinning up threads isn't worth it for the small levels of the chain
+                if (rows * rowCost < 65536)
+                    threadCount = 1;
+
+                threadCount = unsigned(std::min<size_t>(threadCount, bands));
+
+                std::atomic<size_t> next(0);
+                auto worker = [&]()
+                {
+                    for (size_t j = next++; j < bands; j = next++)
+                    {
+                        band(j * bandSize, std::min(rows, (j + 1) * bandSize));
+                    }
+                };
+
+                std::vector<std::thread> threads;
+                for (unsigned j = 1; j < threadCount; ++j)
+                    threads.emplace_back(worker);
+
+                worker();
+
+                for (auto& t : threads)
+                    t.join();
+            }
+
+            // dest[x] = sum of weights[k] * rows[k][x] over a row of count floats (a multiple of 4).
+            inline void FilterColumns(float* dest, const float* const* rows, const float* weights, size_t tapCount, size_t count)
+            {
+            #if defined(DIRECTX_MIP_USE_SSE2)
+                for (size_t x = 0; x < count; x += 4)
+                {
+                    __m128 sum = _mm_setzero_ps();
+                    for (size_t k = 0; k < tapCount; ++k)
+                    {
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + x)));
+                    }
+                    _mm_storeu_ps(dest + x, sum);
+                }
+            #else
+                for (size_t x = 0; x < count; ++x)
+                {
+                    float sum = 0.f;
+                    for (size_t k = 0; k < tapCount; ++k)
+                        sum += weights[k] * rows[k][x];
+                    dest[x] = sum;
+                }
+            #endif
+            }
+
+            // Resamples one row of RGBA texels horizontally.
+            inline void FilterRow(float* dest, const float* src, const FilterTaps& taps, size_t dstWidth)
+            {
+                const float* weights = taps.weights.data();
+                for (size_t x = 0; x < dstWidth; ++x, weights += taps.tapCount)
+                {
+                    const float* s = src + taps.first[x] * 4;
+
+                #if defined(DIRECTX_MIP_USE_SSE2)
+                    __m128 sum = _mm_setzero_ps();
+                    for (size_t k = 0; k < taps.tapCount; ++k)
+                    {
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(s + k * 4)));
+                    }
+                    _mm_storeu_ps(dest + x * 4, sum);
+                #else
+                    float sum[4] = {};
+                    for (size_t k = 0; k < taps.tapCount; ++k)
+                    {
+                        for (size_t c = 0; c < 4; ++c)
+                            sum[c] += weights[k] * s[k * 4 + c];
+                    }
+                    memcpy(dest + x * 4, sum, sizeof(sum));
+                #endif
+                }
+            }
+
+            inline void ToFloatRow(const uint8_t* src, float* dest, size_t width, unsigned flags)
+            {
+                const float* toLinear = GetSRGBTables().toLinear;
+                for (size_t x = 0; x < width; ++x, src += 4, dest += 4)
+                {
+                    float a = float(src[3]) / 255.f;
+                    float scale = (flags & MIP_ALPHA_WEIGHTED) ? a : 1.f;
+                    for (size_t c = 0; c < 3; ++c)
+                        dest[c] = ((flags & MIP_SRGB) ? toLinear[src[c]] : (float(src[c]) / 255.f)) * scale;
+                    dest[3] = a;
+                }
+            }
+
+            inline void FromFloatRow(const float* src, uint8_t* dest, size_t width, unsigned flags)
+            {
+                auto& tables = GetSRGBTables();
+                for (size_t x = 0; x < width; ++x, src += 4, dest += 4)
+                {
+                    float a = std::min(std::max(src[3], 0.f), 1.f);
+                    float scale = 1.f;
+                    if (flags & MIP_ALPHA_WEIGHTED)
+                        scale = (a > 0.f) ? (1.f / a) : 0.f;
+
+                    for (size_t c = 0; c < 3; ++c)
+                        dest[c] = (flags & MIP_SRGB) ? tables.Encode(src[c] * scale) : ToUNORM(src[c] * scale);
+                    dest[3] = ToUNORM(a);
+                }
+            }
+        }
+
+        // Builds levels (0 for a full chain) from an 8-bit RGBA, BGRA or BGRX image; level 0 is a
+        // copy of the source. The first level is filtered straight from the source, converting
+        // only the rows each band needs, and later levels from the previous one at float precision.
+        inline void GenerateMipChain(const uint8_t* rgba, size_t width, size_t height, size_t rowPitch,
+                                     size_t levels, unsigned flags, std::vector<MipLevel>& mips, unsigned threadCount = 0)
+        {
+            using namespace Internal;
+
+            size_t maxLevels = CountMips(width, height);
+            if (!levels || levels > maxLevels)
+                levels = maxLevels;
+
+            mips.resize(levels);
+            mips[0].width = width;
+            mips[0].height = height;
+            mips[0].pixels.resize(width * height * 4);
+            for (size_t y = 0; y < height; ++y)
+            {
+                memcpy(&mips[0].pixels[y * width * 4], rgba + y * rowPitch, width * 4);
+            }
+
+            if (levels < 2)
+                return;
+
+            std::vector<float> current;
+            std::vector<float> next;
+            size_t srcWidth = width;
+            size_t srcHeight = height;
+
+            for (size_t level = 1; level < levels; ++level)
+            {
+                size_t dstWidth = std::max<size_t>(1, srcWidth / 2);
+                size_t dstHeight = std::max<size_t>(1, srcHeight / 2);
+
+                FilterTaps rowTaps, columnTaps;
+                BuildTaps(srcWidth, dstWidth, (flags & MIP_KAISER) != 0, rowTaps);
+                BuildTaps(srcHeight, dstHeight, (flags & MIP_KAISER) != 0, columnTaps);
+
+                auto& mip = mips[level];
+                mip.width = dstWidth;
+                mip.height = dstHeight;
+                mip.pixels.resize(dstWidth * dstHeight * 4);
+
+                next.resize(dstWidth * dstHeight * 4);
+
+                // Filter vertically into a full-width row, then horizontally into the level
+                ForEachBand(dstHeight, srcWidth * (columnTaps.tapCount + rowTaps.tapCount), threadCount, [&](size_t y0, size_t y1)
+                {
+                    std::vector<float> column(srcWidth * 4);
+                    std::vector<const float*> rows(columnTaps.tapCount);
+
+                    const float* source = current.data();
+                    size_t sourceRow = 0;
+
+                    std::vector<float> converted;
+                    if (level == 1)
+                    {
+                        sourceRow = columnTaps.first[y0];
+                        size_t sourceEnd = columnTaps.first[y1 - 1] + columnTaps.tapCount;
+
+                        converted.resize((sourceEnd - sourceRow) * srcWidth * 4);
+                        for (size_t sy = sourceRow; sy < sourceEnd; ++sy)
+                            ToFloatRow(rgba + sy * rowPitch, &converted[(sy - sourceRow) * srcWidth * 4], srcWidth, flags);
+
+                        source = converted.data();
+                    }
+
+                    for (size_t y = y0; y < y1; ++y)
+                    {
+                        for (size_t k = 0; k < columnTaps.tapCount; ++k)
+                            rows[k] = source + (columnTaps.first[y] + k - sourceRow) * srcWidth * 4;
+
+                        FilterColumns(column.data(), rows.data(), &columnTaps.weights[y * columnTaps.tapCount], columnTaps.tapCount, srcWidth * 4);
+
+                        float* dest = &next[y * dstWidth * 4];
+                        FilterRow(dest, column.data(), rowTaps, dstWidth);
+                        FromFloatRow(dest, &mip.pixels[y * dstWidth * 4], dstWidth, flags);
+                    }
+                });
+
+                std::swap(current, next);
+                srcWidth = dstWidth;
+                srcHeight = dstHeight;
+            }
+        }
+    }
+}
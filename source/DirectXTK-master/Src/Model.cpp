@@ -231,15 +231,65 @@ void XM_CALLCONV ModelMesh::Draw(
 }
 
 
+_Use_decl_annotations_
+bool XM_CALLCONV ModelMesh::IsVisible(FXMMATRIX worldView, const BoundingFrustum& viewFrustum) const
+{
+    // Meshes without usable extents are never culled
+    if (boundingSphere.Radius <= 0.f)
+        return true;
+
+    BoundingSphere sphere;
+    boundingSphere.Transform(sphere, worldView);
+
+    ContainmentType result = viewFrustum.Contains(sphere);
+    if (result != INTERSECTS)
+        return (result == CONTAINS);
+
+    // The sphere straddles a plane, so refine with the box (transformed as an AABB to stay conservative)
+    BoundingBox box;
+    boundingBox.Transform(box, worldView);
+
+    return viewFrustum.Intersects(box);
+}
+
+
 //--------------------------------------------------------------------------------------
 // Model
 //--------------------------------------------------------------------------------------
 
+Model::Model() :
+    mFrustumCulling(true)
+{
+    ResetCullingStats();
+}
+
+
 Model::~Model()
 {
 }
 
 
+_Use_decl_annotations_
+void XM_CALLCONV Model::CreateViewFrustum(BoundingFrustum& viewFrustum, FXMMATRIX projection)
+{
+    // BoundingFrustum::CreateFromMatrix expects a left-handed projection
+    if (XMVectorGetW(projection.r[2]) >= 0.f)
+    {
+        BoundingFrustum::CreateFromMatrix(viewFrustum, projection);
+        return;
+    }
+
+    // Right-handed: build the frustum with Z mirrored, then turn it around to look down -Z
+    XMMATRIX mirror = XMMatrixScaling(1.f, 1.f, -1.f);
+    BoundingFrustum::CreateFromMatrix(viewFrustum, XMMatrixMultiply(mirror, projection));
+
+    float rightSlope = viewFrustum.RightSlope;
+    viewFrustum.RightSlope = -viewFrustum.LeftSlope;
+    viewFrustum.LeftSlope = -rightSlope;
+    XMStoreFloat4(&viewFrustum.Orientation, XMQuaternionRotationRollPitchYaw(0.f, XM_PI, 0.f));
+}
+
+
 _Use_decl_annotations_
 void XM_CALLCONV Model::Draw(
     ID3D11DeviceContext* deviceContext,
@@ -251,12 +301,28 @@ void XM_CALLCONV Model::Draw(
 {
     assert(deviceContext != 0);
 
+    XMMATRIX worldView = XMMatrixMultiply(world, view);
+
+    BoundingFrustum viewFrustum;
+    if (mFrustumCulling)
+    {
+        CreateViewFrustum(viewFrustum, projection);
+    }
+
     // Draw opaque parts
     for (auto it = meshes.cbegin(); it != meshes.cend(); ++it)
     {
         auto mesh = it->get();
         assert(mesh != 0);
 
+        if (mFrustumCulling && !mesh->IsVisible(worldView, viewFrustum))
+        {
+            ++mCullingStats.meshesCulled;
+            continue;
+        }
+
+        ++mCullingStats.meshesDrawn;
+
         mesh->PrepareForRendering(deviceContext, states, false, wireframe);
 
         mesh->Draw(deviceContext, world, view, projection, false, setCustomState);
@@ -268,6 +334,9 @@ void XM_CALLCONV Model::Draw(
         auto mesh = it->get();
         assert(mesh != 0);
 
+        if (mFrustumCulling && !mesh->IsVisible(worldView, viewFrustum))
+            continue;
+
         mesh->PrepareForRendering(deviceContext, states, true, wireframe);
 
         mesh->Draw(deviceContext, world, view, projection, true, setCustomState);
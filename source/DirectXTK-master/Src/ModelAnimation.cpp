@@ -0,0 +1,492 @@
+//--------------------------------------------------------------------------------------
+// File: ModelAnimation.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "ModelAnimation.h"
+
+#include "Effects.h"
+#include "PlatformHelpers.h"
+
+using namespace DirectX;
+
+namespace
+{
+    // Local bone pose as separate rotation, translation and scale streams, padded to a
+    // multiple of four bones so they can be sampled and blended four bones at a time.
+    struct PoseBuffer
+    {
+        std::unique_ptr<XMVECTOR[], aligned_deleter> rotations;
+        std::unique_ptr<XMVECTOR[], aligned_deleter> translations;
+        std::unique_ptr<XMVECTOR[], aligned_deleter> scales;
+
+        void Allocate(size_t count)
+        {
+            count = (count + 3) & ~size_t(3);
+
+            rotations = AllocateVectors(count);
+            translations = AllocateVectors(count);
+            scales = AllocateVectors(count);
+        }
+
+        static std::unique_ptr<XMVECTOR[], aligned_deleter> AllocateVectors(size_t count)
+        {
+            auto ptr = reinterpret_cast<XMVECTOR*>(_aligned_malloc(sizeof(XMVECTOR) * count, 16));
+            if (!ptr)
+                throw std::bad_alloc();
+
+            return std::unique_ptr<XMVECTOR[], aligned_deleter>(ptr);
+        }
+    };
+
+
+    std::unique_ptr<XMMATRIX[], aligned_deleter> AllocateMatrices(size_t count)
+    {
+        auto ptr = reinterpret_cast<XMMATRIX*>(_aligned_malloc(sizeof(XMMATRIX) * count, 16));
+        if (!ptr)
+            throw std::bad_alloc();
+
+        return std::unique_ptr<XMMATRIX[], aligned_deleter>(ptr);
+    }
+
+
+    // Four bones of one pose stream, transposed so that row i holds component i of each bone.
+    inline XMMATRIX XM_CALLCONV LoadBones(_In_reads_(4) XMVECTOR const* bones)
+    {
+        return XMMatrixTranspose(XMMATRIX(bones[0], bones[1], bones[2], bones[3]));
+    }
+
+    inline void XM_CALLCONV StoreBones(_Out_writes_(4) XMVECTOR* bones, FXMMATRIX m)
+    {
+        XMMATRIX t = XMMatrixTranspose(m);
+
+        bones[0] = t.r[0];
+        bones[1] = t.r[1];
+        bones[2] = t.r[2];
+        bones[3] = t.r[3];
+    }
+
+
+    // Lerps the x, y and z rows of four transposed bones; w is not used by the pose.
+    inline XMMATRIX XM_CALLCONV LerpBones(FXMVECTOR t, FXMMATRIX v0, CXMMATRIX v1)
+    {
+        XMMATRIX result;
+        result.r[0] = XMVectorLerpV(v0.r[0], v1.r[0], t);
+        result.r[1] = XMVectorLerpV(v0.r[1], v1.r[1], t);
+        result.r[2] = XMVectorLerpV(v0.r[2], v1.r[2], t);
+        result.r[3] = v0.r[3];
+        return result;
+    }
+
+
+    // XMQuaternionSlerpV for four transposed quaternions, each with its own weight in t.
+    // Omega never exceeds pi/2 here, so it comes from XMVectorACos rather than XMVectorATan2.
+    XMMATRIX XM_CALLCONV SlerpBones(FXMVECTOR t, FXMMATRIX q0, CXMMATRIX q1)
+    {
+        static const XMVECTORF32 OneMinusEpsilon = { { { 1.0f - 0.00001f, 1.0f - 0.00001f, 1.0f - 0.00001f, 1.0f - 0.00001f } } };
+
+        XMVECTOR cosOmega = XMVectorMultiply(q0.r[0], q1.r[0]);
+        cosOmega = XMVectorMultiplyAdd(q0.r[1], q1.r[1], cosOmega);
+        cosOmega = XMVectorMultiplyAdd(q0.r[2], q1.r[2], cosOmega);
+        cosOmega = XMVectorMultiplyAdd(q0.r[3], q1.r[3], cosOmega);
+
+        // Take the shorter way round.
+        XMVECTOR sign = XMVectorSelect(g_XMOne, g_XMNegativeOne, XMVectorLess(cosOmega, g_XMZero));
+        cosOmega = XMVectorMultiply(cosOmega, sign);
+
+        XMVECTOR sinOmega = XMVectorSqrt(XMVectorMax(XMVectorNegativeMultiplySubtract(cosOmega, cosOmega, g_XMOne), g_XMZero));
+        XMVECTOR omega = XMVectorACos(cosOmega);
+
+        XMVECTOR invT = XMVectorSubtract(g_XMOne, t);
+        XMVECTOR s0 = XMVectorDivide(XMVectorSin(XMVectorMultiply(invT, omega)), sinOmega);
+        XMVECTOR s1 = XMVectorDivide(XMVectorSin(XMVectorMultiply(t, omega)), sinOmega);
+
+        // Nearly equal keys are lerped instead, which also drops the division by zero.
+        XMVECTOR useSlerp = XMVectorLess(cosOmega, OneMinusEpsilon);
+        s0 = XMVectorSelect(invT, s0, useSlerp);
+        s1 = XMVectorMultiply(XMVectorSelect(t, s1, useSlerp), sign);
+
+        XMMATRIX result;
+        result.r[0] = XMVectorMultiplyAdd(q0.r[0], s0, XMVectorMultiply(q1.r[0], s1));
+        result.r[1] = XMVectorMultiplyAdd(q0.r[1], s0, XMVectorMultiply(q1.r[1], s1));
+        result.r[2] = XMVectorMultiplyAdd(q0.r[2], s0, XMVectorMultiply(q1.r[2], s1));
+        result.r[3] = XMVectorMultiplyAdd(q0.r[3], s0, XMVectorMultiply(q1.r[3], s1));
+        return result;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// AnimationClip / ModelSkeleton
+//--------------------------------------------------------------------------------------
+
+AnimationClip::AnimationClip() :
+    startTime(0.f),
+    endTime(0.f)
+{
+}
+
+
+_Use_decl_annotations_
+int ModelSkeleton::FindClip(const wchar_t* clipName) const
+{
+    for (size_t j = 0; j < clips.size(); ++j)
+    {
+        if (clips[j].name == clipName)
+            return static_cast<int>(j);
+    }
+
+    return -1;
+}
+
+
+//--------------------------------------------------------------------------------------
+// AnimationPlayer
+//--------------------------------------------------------------------------------------
+
+// Internal AnimationPlayer implementation class.
+class AnimationPlayer::Impl
+{
+public:
+    explicit Impl(std::shared_ptr<const ModelSkeleton> skeleton);
+
+    void Play(size_t clipIndex, bool loop, float fadeDuration);
+    void Update(float elapsedSeconds);
+
+    // Playback position within one clip, with a key cursor per track so that
+    // sampling forward in time is amortised O(1) per bone.
+    struct Layer
+    {
+        int                     clip;
+        float                   time;
+        bool                    loop;
+        std::vector<uint32_t>   cursors;
+    };
+
+    std::shared_ptr<const ModelSkeleton> mSkeleton;
+    size_t mBoneCount;
+
+    Layer mCurrent;
+    Layer mPrevious;
+    float mFadeDuration;
+    float mFadeTime;
+    bool mPlaying;
+
+    PoseBuffer mRestPose;
+    PoseBuffer mCurrentPose;
+    PoseBuffer mPreviousPose;
+
+    std::unique_ptr<XMMATRIX[], aligned_deleter> mInvBindPose;
+    std::unique_ptr<XMMATRIX[], aligned_deleter> mGlobal;
+    std::unique_ptr<XMMATRIX[], aligned_deleter> mPalette;
+
+private:
+    void Advance(Layer& layer, float elapsedSeconds);
+    void Sample(Layer& layer, PoseBuffer& pose);
+    void BuildPalette(PoseBuffer const& pose);
+};
+
+
+AnimationPlayer::Impl::Impl(std::shared_ptr<const ModelSkeleton> skeleton)
+  : mSkeleton(std::move(skeleton)),
+    mBoneCount(0),
+    mFadeDuration(0.f),
+    mFadeTime(0.f),
+    mPlaying(false)
+{
+    if (!mSkeleton || mSkeleton->bones.empty())
+        throw std::exception("AnimationPlayer requires a skeleton with bones");
+
+    mBoneCount = mSkeleton->bones.size();
+
+    mRestPose.Allocate(mBoneCount);
+    mCurrentPose.Allocate(mBoneCount);
+    mPreviousPose.Allocate(mBoneCount);
+
+    mInvBindPose = AllocateMatrices(mBoneCount);
+    mGlobal = AllocateMatrices(mBoneCount);
+    mPalette = AllocateMatrices(mBoneCount);
+
+    for (size_t b = 0; b < mBoneCount; ++b)
+    {
+        auto& bone = mSkeleton->bones[b];
+
+        if (bone.parentIndex >= static_cast<int32_t>(b))
+            throw std::exception("Skeleton bones must be ordered parent first");
+
+        mInvBindPose[b] = XMLoadFloat4x4(&bone.invBindPose);
+
+        XMVECTOR s, r, t;
+        if (!XMMatrixDecompose(&s, &r, &t, XMLoadFloat4x4(&bone.localTransform)))
+        {
+            s = g_XMOne;
+            r = XMQuaternionIdentity();
+            t = g_XMZero;
+        }
+
+        mRestPose.scales[b] = s;
+        mRestPose.rotations[b] = r;
+        mRestPose.translations[b] = t;
+    }
+
+    for (size_t b = mBoneCount; b & 3; ++b)
+    {
+        mRestPose.scales[b] = g_XMOne;
+        mRestPose.rotations[b] = XMQuaternionIdentity();
+        mRestPose.translations[b] = g_XMZero;
+    }
+
+    mCurrent.clip = mPrevious.clip = -1;
+    mCurrent.time = mPrevious.time = 0.f;
+    mCurrent.loop = mPrevious.loop = false;
+
+    BuildPalette(mRestPose);
+}
+
+
+void AnimationPlayer::Impl::Play(size_t clipIndex, bool loop, float fadeDuration)
+{
+    if (clipIndex >= mSkeleton->clips.size())
+        throw std::out_of_range("clipIndex parameter out of range");
+
+    if (fadeDuration > 0.f && mCurrent.clip >= 0)
+    {
+        std::swap(mPrevious, mCurrent);
+        mFadeDuration = fadeDuration;
+        mFadeTime = 0.f;
+    }
+    else
+    {
+        mPrevious.clip = -1;
+        mFadeDuration = 0.f;
+    }
+
+    mCurrent.clip = static_cast<int>(clipIndex);
+    mCurrent.time = 0.f;
+    mCurrent.loop = loop;
+    mCurrent.cursors.assign(mBoneCount, 0);
+
+    mPlaying = true;
+}
+
+
+void AnimationPlayer::Impl::Update(float elapsedSeconds)
+{
+    if (mCurrent.clip < 0)
+        return;
+
+    Advance(mCurrent, elapsedSeconds);
+    Sample(mCurrent, mCurrentPose);
+
+    if (mPrevious.clip >= 0)
+    {
+        mFadeTime += elapsedSeconds;
+
+        if (mFadeTime >= mFadeDuration)
+        {
+            mPrevious.clip = -1;
+        }
+        else
+        {
+            Advance(mPrevious, elapsedSeconds);
+            Sample(mPrevious, mPreviousPose);
+
+            // Blend the outgoing clip into the incoming one.
+            XMVECTOR weight = XMVectorReplicate(mFadeTime / mFadeDuration);
+
+            for (size_t b = 0; b < mBoneCount; b += 4)
+            {
+                StoreBones(&mCurrentPose.rotations[b], SlerpBones(weight, LoadBones(&mPreviousPose.rotations[b]), LoadBones(&mCurrentPose.rotations[b])));
+                StoreBones(&mCurrentPose.translations[b], LerpBones(weight, LoadBones(&mPreviousPose.translations[b]), LoadBones(&mCurrentPose.translations[b])));
+                StoreBones(&mCurrentPose.scales[b], LerpBones(weight, LoadBones(&mPreviousPose.scales[b]), LoadBones(&mCurrentPose.scales[b])));
+            }
+        }
+    }
+
+    BuildPalette(mCurrentPose);
+}
+
+
+void AnimationPlayer::Impl::Advance(Layer& layer, float elapsedSeconds)
+{
+    auto& clip = mSkeleton->clips[layer.clip];
+    float duration = clip.GetDuration();
+
+    layer.time += elapsedSeconds;
+
+    if (layer.time >= duration)
+    {
+        if (layer.loop && duration > 0.f)
+        {
+            // Wrapping moves time backwards, which the cursors pick up in Sample.
+            layer.time = fmodf(layer.time, duration);
+        }
+        else
+        {
+            layer.time = duration;
+
+            if (&layer == &mCurrent)
+                mPlaying = false;
+        }
+    }
+}
+
+
+void AnimationPlayer::Impl::Sample(Layer& layer, PoseBuffer& pose)
+{
+    auto& clip = mSkeleton->clips[layer.clip];
+    float t = clip.startTime + layer.time;
+
+    size_t trackCount = std::min(mBoneCount, clip.tracks.size());
+
+    // Each bone's key pair is found on its own, then four bones are interpolated at once.
+    for (size_t b = 0; b < mBoneCount; b += 4)
+    {
+        XMMATRIX r0, r1, t0, t1, s0, s1;
+        float weights[4] = {};
+
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            size_t bone = b + lane;
+
+            if (bone >= trackCount || !clip.tracks[bone].keyCount)
+            {
+                r0.r[lane] = r1.r[lane] = mRestPose.rotations[bone];
+                t0.r[lane] = t1.r[lane] = mRestPose.translations[bone];
+                s0.r[lane] = s1.r[lane] = mRestPose.scales[bone];
+                continue;
+            }
+
+            auto& track = clip.tracks[bone];
+            auto times = &clip.keyTimes[track.firstKey];
+            uint32_t& cursor = layer.cursors[bone];
+
+            if (cursor >= track.keyCount || times[cursor] > t)
+                cursor = 0;
+
+            while (cursor + 1 < track.keyCount && times[cursor + 1] <= t)
+                ++cursor;
+
+            size_t k0 = track.firstKey + cursor;
+            size_t k1 = k0;
+
+            if (cursor + 1 < track.keyCount && t > times[cursor])
+            {
+                float span = times[cursor + 1] - times[cursor];
+                weights[lane] = (span > 0.f) ? (t - times[cursor]) / span : 0.f;
+                k1 = k0 + 1;
+            }
+
+            r0.r[lane] = XMLoadFloat4(&clip.keyRotations[k0]);
+            r1.r[lane] = XMLoadFloat4(&clip.keyRotations[k1]);
+            t0.r[lane] = XMLoadFloat3(&clip.keyTranslations[k0]);
+            t1.r[lane] = XMLoadFloat3(&clip.keyTranslations[k1]);
+            s0.r[lane] = XMLoadFloat3(&clip.keyScales[k0]);
+            s1.r[lane] = XMLoadFloat3(&clip.keyScales[k1]);
+        }
+
+        XMVECTOR f = XMVectorSet(weights[0], weights[1], weights[2], weights[3]);
+
+        StoreBones(&pose.rotations[b], SlerpBones(f, XMMatrixTranspose(r0), XMMatrixTranspose(r1)));
+        StoreBones(&pose.translations[b], LerpBones(f, XMMatrixTranspose(t0), XMMatrixTranspose(t1)));
+        StoreBones(&pose.scales[b], LerpBones(f, XMMatrixTranspose(s0), XMMatrixTranspose(s1)));
+    }
+}
+
+
+void AnimationPlayer::Impl::BuildPalette(PoseBuffer const& pose)
+{
+    for (size_t b = 0; b < mBoneCount; ++b)
+    {
+        XMMATRIX local = XMMatrixAffineTransformation(pose.scales[b], g_XMZero, pose.rotations[b], pose.translations[b]);
+
+        int32_t parent = mSkeleton->bones[b].parentIndex;
+        mGlobal[b] = (parent >= 0) ? XMMatrixMultiply(local, mGlobal[parent]) : local;
+
+        mPalette[b] = XMMatrixMultiply(mInvBindPose[b], mGlobal[b]);
+    }
+}
+
+
+// Public constructor.
+AnimationPlayer::AnimationPlayer(std::shared_ptr<const ModelSkeleton> skeleton)
+  : pImpl(new Impl(std::move(skeleton)))
+{
+}
+
+
+// Move constructor.
+AnimationPlayer::AnimationPlayer(AnimationPlayer&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+AnimationPlayer& AnimationPlayer::operator= (AnimationPlayer&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+AnimationPlayer::~AnimationPlayer()
+{
+}
+
+
+void AnimationPlayer::Play(size_t clipIndex, bool loop, float fadeDuration)
+{
+    pImpl->Play(clipIndex, loop, fadeDuration);
+}
+
+
+void AnimationPlayer::Update(float elapsedSeconds)
+{
+    pImpl->Update(elapsedSeconds);
+}
+
+
+float AnimationPlayer::GetTime() const
+{
+    return pImpl->mCurrent.time;
+}
+
+
+bool AnimationPlayer::IsPlaying() const
+{
+    return pImpl->mPlaying;
+}
+
+
+XMMATRIX const* AnimationPlayer::GetBoneTransforms() const
+{
+    return pImpl->mPalette.get();
+}
+
+
+size_t AnimationPlayer::GetBoneCount() const
+{
+    return pImpl->mBoneCount;
+}
+
+
+_Use_decl_annotations_
+void AnimationPlayer::SetBoneTransforms(IEffectSkinning* effect) const
+{
+    assert(effect != 0);
+
+    size_t count = std::min<size_t>(pImpl->mBoneCount, IEffectSkinning::MaxBones);
+
+    effect->SetBoneTransforms(pImpl->mPalette.get(), count);
+}
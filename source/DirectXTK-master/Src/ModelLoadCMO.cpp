@@ -13,6 +13,7 @@
 
 #include "pch.h"
 #include "Model.h"
+#include "ModelAnimation.h"
 
 #include "DDSTextureLoader.h"
 #include "Effects.h"
@@ -212,6 +213,66 @@ static void CreateInputLayout(_In_ ID3D11Device* device, IEffect* effect, _Out_
     SetDebugObjectName(*pInputLayout, "ModelCMO");
 }
 
+// Helper for regrouping CMO keyframes (ordered by time) into per-bone SoA tracks.
+static void CreateAnimationTracks( AnimationClip& clip, _In_reads_(nKeys) const VSD3DStarter::Keyframe* keys, size_t nKeys, size_t nBones )
+{
+    clip.tracks.resize( nBones );
+
+    for( size_t b = 0; b < nBones; ++b )
+    {
+        clip.tracks[ b ].firstKey = 0;
+        clip.tracks[ b ].keyCount = 0;
+    }
+
+    for( size_t k = 0; k < nKeys; ++k )
+    {
+        if ( keys[ k ].BoneIndex >= nBones )
+            throw std::exception("Invalid keyframe bone index\n");
+
+        ++clip.tracks[ keys[ k ].BoneIndex ].keyCount;
+    }
+
+    uint32_t offset = 0;
+    for( size_t b = 0; b < nBones; ++b )
+    {
+        clip.tracks[ b ].firstKey = offset;
+        offset += clip.tracks[ b ].keyCount;
+    }
+
+    clip.keyTimes.resize( nKeys );
+    clip.keyRotations.resize( nKeys );
+    clip.keyTranslations.resize( nKeys );
+    clip.keyScales.resize( nKeys );
+
+    std::vector<uint32_t> fill( nBones, 0 );
+
+    for( size_t k = 0; k < nKeys; ++k )
+    {
+        auto& key = keys[ k ];
+        size_t dest = clip.tracks[ key.BoneIndex ].firstKey + fill[ key.BoneIndex ]++;
+
+        XMVECTOR s, r, t;
+        if ( !XMMatrixDecompose( &s, &r, &t, XMLoadFloat4x4( &key.Transform ) ) )
+            throw std::exception("Keyframe transform cannot be decomposed\n");
+
+        clip.keyTimes[ dest ] = key.Time;
+        XMStoreFloat4( &clip.keyRotations[ dest ], r );
+        XMStoreFloat3( &clip.keyTranslations[ dest ], t );
+        XMStoreFloat3( &clip.keyScales[ dest ], s );
+    }
+
+    // Exporters write keys in time order, but make sure each track is before sampling relies on it
+    for( size_t b = 0; b < nBones; ++b )
+    {
+        auto& track = clip.tracks[ b ];
+        auto first = clip.keyTimes.begin() + track.firstKey;
+
+        if ( !std::is_sorted( first, first + track.keyCount ) )
+            throw std::exception("Keyframes are not in time order\n");
+    }
+}
+
+
 // Shared VB input element description
 static INIT_ONCE g_InitOnce = INIT_ONCE_STATIC_INIT;
 static std::shared_ptr<std::vector<D3D11_INPUT_ELEMENT_DESC>> g_vbdecl;
@@ -521,10 +582,11 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
         XMVECTOR max = XMVectorSet( extents->MaxX, extents->MaxY, extents->MaxZ, 0.f );
         BoundingBox::CreateFromPoints( mesh->boundingBox, min, max );
 
-#if 0
         // Animation data
         if ( *bSkeleton )
         {
+            auto skeleton = std::make_shared<ModelSkeleton>();
+
             // Bones
             auto nBones = reinterpret_cast<const UINT*>( meshData + usedSize );
             usedSize += sizeof(UINT);
@@ -534,6 +596,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
             if ( !*nBones )
                 throw std::exception("Animation bone data is missing\n");
 
+            skeleton->bones.resize( *nBones );
+
             for( UINT j = 0; j < *nBones; ++j )
             {
                 // Bone name
@@ -547,9 +611,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 usedSize += sizeof(wchar_t)*(*nName);
                 if ( dataSize < usedSize )
                     throw std::exception("End of file");
-                
-                // TODO - What to do with bone name?
-                boneName;
 
                 // Bone settings
                 auto bones = reinterpret_cast<const VSD3DStarter::Bone*>( meshData + usedSize );
@@ -557,8 +618,14 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 if ( dataSize < usedSize )  
                     throw std::exception("End of file");
 
-                // TODO - What to do with bone data?
-                bones;
+                if ( bones->ParentIndex >= static_cast<INT>( j ) )
+                    throw std::exception("Invalid bone parent index\n");
+
+                auto& bone = skeleton->bones[ j ];
+                bone.name.assign( boneName, *nName );
+                bone.parentIndex = bones->ParentIndex;
+                bone.invBindPose = bones->InvBindPos;
+                bone.localTransform = bones->LocalTransform;
             }
 
             // Animation Clips
@@ -567,6 +634,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
             if ( dataSize < usedSize )
                 throw std::exception("End of file");
 
+            skeleton->clips.resize( *nClips );
+
             for( UINT j = 0; j < *nClips; ++j )
             {
                 // Clip name
@@ -580,9 +649,6 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 usedSize += sizeof(wchar_t)*(*nName);
                 if ( dataSize < usedSize )
                     throw std::exception("End of file");
-                
-                // TODO - What to do with clip name?
-                clipName;
 
                 auto clip = reinterpret_cast<const VSD3DStarter::Clip*>( meshData + usedSize );
                 usedSize += sizeof(VSD3DStarter::Clip);
@@ -597,13 +663,16 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO( ID3D11Device* d3dDevice, c
                 if ( dataSize < usedSize )  
                     throw std::exception("End of file");
 
-                // TODO - What to do with keys and clip->StartTime, clip->EndTime?
-                keys;
+                auto& anim = skeleton->clips[ j ];
+                anim.name.assign( clipName, *nName );
+                anim.startTime = clip->StartTime;
+                anim.endTime = clip->EndTime;
+
+                CreateAnimationTracks( anim, keys, clip->keys, *nBones );
             }
+
+            mesh->skeleton = skeleton;
         }
-#else
-        UNREFERENCED_PARAMETER(bSkeleton);
-#endif
 
         bool enableSkinning = ( *nSkinVBs ) != 0;
 
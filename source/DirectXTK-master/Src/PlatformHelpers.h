@@ -27,7 +27,7 @@ namespace DirectX
     public:
         com_exception(HRESULT hr) : result(hr) {}
 
-        virtual const char* what() const override
+        virtual const char* what() const throw() override
         {
             static char s_str[64] = {};
             sprintf_s(s_str, "Failure with HRESULT of %08X", result);
@@ -74,7 +74,11 @@ namespace DirectX
 
     struct handle_closer { void operator()(HANDLE h) { if (h) CloseHandle(h); } };
 
-    typedef public std::unique_ptr<void, handle_closer> ScopedHandle;
+    typedef std::unique_ptr<void, handle_closer> ScopedHandle;
+
+    struct unmap_deleter { void operator()(void const* p) { if (p) UnmapViewOfFile(p); } };
+
+    typedef std::unique_ptr<void const, unmap_deleter> ScopedMappedView;
 
     inline HANDLE safe_handle( HANDLE h ) { return (h == INVALID_HANDLE_VALUE) ? 0 : h; }
 }
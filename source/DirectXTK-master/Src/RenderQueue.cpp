@@ -0,0 +1,443 @@
+//--------------------------------------------------------------------------------------
+// File: RenderQueue.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "RenderQueue.h"
+
+#include "CommonStates.h"
+#include "Effects.h"
+#include "Model.h"
+
+#include <unordered_map>
+
+using namespace DirectX;
+
+#ifndef _CPPRTTI
+#error RenderQueue requires RTTI
+#endif
+
+namespace
+{
+    // Sort key layout, most significant first:
+    //   63      alpha (alpha parts keep their submission order after all opaque parts)
+    //   62      custom state (parts of models enqueued with setCustomState follow the other opaque parts)
+    //   61      rasterizer (cull clockwise vs counter-clockwise)
+    //   46..60  effect
+    //   34..45  input layout
+    //   18..33  vertex buffer
+    //   2..17   index buffer
+    const uint64_t KeyAlphaBit = uint64_t(1) << 63;
+    const uint64_t KeyCustomStateBit = uint64_t(1) << 62;
+    const uint64_t KeyCullBit = uint64_t(1) << 61;
+
+    const int KeyEffectShift = 46;
+    const int KeyLayoutShift = 34;
+    const int KeyVertexBufferShift = 18;
+    const int KeyIndexBufferShift = 2;
+
+    const uint32_t KeyEffectMask = 0x7FFF;
+    const uint32_t KeyLayoutMask = 0xFFF;
+    const uint32_t KeyBufferMask = 0xFFFF;
+
+    typedef std::unordered_map<const void*, uint32_t> IdMap;
+
+    // Hands out small dense ids for objects seen this frame. Ids that overflow the key field
+    // wrap around, which only costs sort quality since state filtering compares the pointers.
+    inline uint32_t GetId(IdMap& ids, _In_opt_ const void* object, uint32_t mask)
+    {
+        auto it = ids.find(object);
+        if (it != ids.end())
+            return it->second;
+
+        uint32_t id = static_cast<uint32_t>(ids.size()) & mask;
+        ids.emplace(object, id);
+        return id;
+    }
+}
+
+
+// Internal RenderQueue implementation class.
+class RenderQueue::Impl
+{
+public:
+    Impl();
+
+    void XM_CALLCONV Begin(FXMMATRIX view, CXMMATRIX projection);
+    void End(_In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, bool wireframe);
+    void XM_CALLCONV Enqueue(const Model& model, FXMMATRIX world, std::function<void()>& setCustomState);
+
+    Statistics mStats;
+
+private:
+    // A single mesh part waiting to be drawn.
+    struct QueuedPart
+    {
+        ModelMeshPart const* part;
+        ModelMesh const* mesh;
+        uint32_t instance;
+    };
+
+    void ResetQueue();
+
+    bool mInBeginEndPair;
+
+    XMFLOAT4X4 mView;
+    XMFLOAT4X4 mProjection;
+    BoundingFrustum mViewFrustum;
+
+    std::vector<XMFLOAT4X4> mWorlds;
+    std::vector<std::function<void()>> mCustomStates;
+    std::vector<QueuedPart> mParts;
+    std::vector<std::pair<uint64_t, uint32_t>> mSortKeys;
+
+    IdMap mEffectIds;
+    IdMap mLayoutIds;
+    IdMap mBufferIds;
+};
+
+
+RenderQueue::Impl::Impl()
+    : mInBeginEndPair(false)
+{
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+
+void XM_CALLCONV RenderQueue::Impl::Begin(FXMMATRIX view, CXMMATRIX projection)
+{
+    if (mInBeginEndPair)
+        throw std::exception("Cannot nest Begin calls on a single RenderQueue");
+
+    XMStoreFloat4x4(&mView, view);
+    XMStoreFloat4x4(&mProjection, projection);
+    Model::CreateViewFrustum(mViewFrustum, projection);
+
+    ResetQueue();
+    memset(&mStats, 0, sizeof(mStats));
+
+    mInBeginEndPair = true;
+}
+
+
+void XM_CALLCONV RenderQueue::Impl::Enqueue(const Model& model, FXMMATRIX world, std::function<void()>& setCustomState)
+{
+    if (!mInBeginEndPair)
+        throw std::exception("Begin must be called before Enqueue");
+
+    XMMATRIX worldView = XMMatrixMultiply(world, XMLoadFloat4x4(&mView));
+
+    auto instance = static_cast<uint32_t>(mWorlds.size());
+    bool instanceUsed = false;
+
+    for (auto mit = model.meshes.cbegin(); mit != model.meshes.cend(); ++mit)
+    {
+        auto mesh = mit->get();
+        assert(mesh != 0);
+
+        if (model.GetFrustumCulling() && !mesh->IsVisible(worldView, mViewFrustum))
+        {
+            ++mStats.meshesCulled;
+            continue;
+        }
+
+        for (auto it = mesh->meshParts.cbegin(); it != mesh->meshParts.cend(); ++it)
+        {
+            auto part = it->get();
+            assert(part != 0);
+
+            uint64_t key;
+            if (part->isAlpha)
+            {
+                key = KeyAlphaBit;
+            }
+            else
+            {
+                key = setCustomState ? KeyCustomStateBit : 0;
+                key |= mesh->ccw ? 0 : KeyCullBit;
+                key |= uint64_t(GetId(mEffectIds, part->effect.get(), KeyEffectMask)) << KeyEffectShift;
+                key |= uint64_t(GetId(mLayoutIds, part->inputLayout.Get(), KeyLayoutMask)) << KeyLayoutShift;
+                key |= uint64_t(GetId(mBufferIds, part->vertexBuffer.Get(), KeyBufferMask)) << KeyVertexBufferShift;
+                key |= uint64_t(GetId(mBufferIds, part->indexBuffer.Get(), KeyBufferMask)) << KeyIndexBufferShift;
+            }
+
+            QueuedPart queued = { part, mesh, instance };
+
+            // Pairing with the queue index keeps the sort stable.
+            mSortKeys.emplace_back(key, static_cast<uint32_t>(mParts.size()));
+            mParts.push_back(queued);
+
+            instanceUsed = true;
+        }
+    }
+
+    if (instanceUsed)
+    {
+        XMFLOAT4X4 w;
+        XMStoreFloat4x4(&w, world);
+        mWorlds.push_back(w);
+        mCustomStates.push_back(std::move(setCustomState));
+    }
+}
+
+
+void RenderQueue::Impl::End(_In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, bool wireframe)
+{
+    if (!mInBeginEndPair)
+        throw std::exception("Begin must be called before End");
+
+    mInBeginEndPair = false;
+
+    assert(deviceContext != 0);
+
+    mStats.partsQueued = static_cast<uint32_t>(mParts.size());
+
+    if (mParts.empty())
+        return;
+
+    std::sort(mSortKeys.begin(), mSortKeys.end());
+
+    XMMATRIX view = XMLoadFloat4x4(&mView);
+    XMMATRIX projection = XMLoadFloat4x4(&mProjection);
+
+    // Every model mesh uses the same samplers, so set them once.
+    ID3D11SamplerState* samplers[] =
+    {
+        states.LinearWrap(),
+        states.LinearWrap(),
+    };
+
+    deviceContext->PSSetSamplers(0, 2, samplers);
+
+    ID3D11BlendState* currentBlendState = nullptr;
+    ID3D11DepthStencilState* currentDepthStencilState = nullptr;
+    ID3D11RasterizerState* currentRasterizerState = nullptr;
+    ID3D11InputLayout* currentInputLayout = nullptr;
+    ID3D11Buffer* currentVertexBuffer = nullptr;
+    uint32_t currentVertexStride = 0;
+    ID3D11Buffer* currentIndexBuffer = nullptr;
+    DXGI_FORMAT currentIndexFormat = DXGI_FORMAT_UNKNOWN;
+    D3D_PRIMITIVE_TOPOLOGY currentTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    IEffect* currentEffect = nullptr;
+    uint32_t currentInstance = UINT32_MAX;
+
+    for (auto it = mSortKeys.cbegin(); it != mSortKeys.cend(); ++it)
+    {
+        auto& queued = mParts[it->second];
+        auto part = queued.part;
+        auto mesh = queued.mesh;
+
+        bool newBatch = false;
+
+        // Pick the same blend, depth stencil and rasterizer states as ModelMesh::PrepareForRendering.
+        ID3D11BlendState* blendState;
+        ID3D11DepthStencilState* depthStencilState;
+
+        if (part->isAlpha)
+        {
+            blendState = mesh->pmalpha ? states.AlphaBlend() : states.NonPremultiplied();
+            depthStencilState = states.DepthRead();
+        }
+        else
+        {
+            blendState = states.Opaque();
+            depthStencilState = states.DepthDefault();
+        }
+
+        ID3D11RasterizerState* rasterizerState;
+        if (wireframe)
+            rasterizerState = states.Wireframe();
+        else
+            rasterizerState = mesh->ccw ? states.CullCounterClockwise() : states.CullClockwise();
+
+        if (blendState != currentBlendState)
+        {
+            deviceContext->OMSetBlendState(blendState, nullptr, 0xFFFFFFFF);
+            currentBlendState = blendState;
+            ++mStats.blendStateChanges;
+            newBatch = true;
+        }
+
+        if (depthStencilState != currentDepthStencilState)
+        {
+            deviceContext->OMSetDepthStencilState(depthStencilState, 0);
+            currentDepthStencilState = depthStencilState;
+            ++mStats.depthStencilStateChanges;
+            newBatch = true;
+        }
+
+        if (rasterizerState != currentRasterizerState)
+        {
+            deviceContext->RSSetState(rasterizerState);
+            currentRasterizerState = rasterizerState;
+            ++mStats.rasterizerStateChanges;
+            newBatch = true;
+        }
+
+        if (part->inputLayout.Get() != currentInputLayout)
+        {
+            currentInputLayout = part->inputLayout.Get();
+            deviceContext->IASetInputLayout(currentInputLayout);
+            ++mStats.inputLayoutChanges;
+            newBatch = true;
+        }
+
+        if (part->vertexBuffer.Get() != currentVertexBuffer || part->vertexStride != currentVertexStride)
+        {
+            auto vb = part->vertexBuffer.Get();
+            UINT vbStride = part->vertexStride;
+            UINT vbOffset = 0;
+            deviceContext->IASetVertexBuffers(0, 1, &vb, &vbStride, &vbOffset);
+
+            currentVertexBuffer = vb;
+            currentVertexStride = vbStride;
+            ++mStats.vertexBufferChanges;
+            newBatch = true;
+        }
+
+        if (part->indexBuffer.Get() != currentIndexBuffer || part->indexFormat != currentIndexFormat)
+        {
+            // Note that if indexFormat is DXGI_FORMAT_R32_UINT, this model mesh part requires a Feature Level 9.2 or greater device
+            deviceContext->IASetIndexBuffer(part->indexBuffer.Get(), part->indexFormat, 0);
+
+            currentIndexBuffer = part->indexBuffer.Get();
+            currentIndexFormat = part->indexFormat;
+            ++mStats.indexBufferChanges;
+            newBatch = true;
+        }
+
+        // Effects hold the per-instance matrices, so they are reapplied whenever either changes.
+        auto effect = part->effect.get();
+        assert(effect != 0);
+
+        if (effect != currentEffect || queued.instance != currentInstance)
+        {
+            auto imatrices = dynamic_cast<IEffectMatrices*>(effect);
+            if (imatrices)
+            {
+                imatrices->SetMatrices(XMLoadFloat4x4(&mWorlds[queued.instance]), view, projection);
+            }
+
+            effect->Apply(deviceContext);
+
+            if (effect != currentEffect)
+                newBatch = true;
+
+            currentEffect = effect;
+            currentInstance = queued.instance;
+            ++mStats.effectApplies;
+        }
+
+        // The hook runs at the same point as in ModelMeshPart::Draw, which sets the topology after it.
+        auto& setCustomState = mCustomStates[queued.instance];
+        if (setCustomState)
+        {
+            setCustomState();
+            currentTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+            ++mStats.customStateCalls;
+        }
+
+        if (part->primitiveType != currentTopology)
+        {
+            deviceContext->IASetPrimitiveTopology(part->primitiveType);
+            currentTopology = part->primitiveType;
+            ++mStats.topologyChanges;
+            newBatch = true;
+        }
+
+        if (newBatch || setCustomState)
+            ++mStats.batches;
+
+        deviceContext->DrawIndexed(part->indexCount, part->startIndex, part->vertexOffset);
+        ++mStats.drawCalls;
+
+        // Nothing the hook may have bound is known any more, so the next part sets everything again.
+        if (setCustomState)
+        {
+            currentBlendState = nullptr;
+            currentDepthStencilState = nullptr;
+            currentRasterizerState = nullptr;
+            currentInputLayout = nullptr;
+            currentVertexBuffer = nullptr;
+            currentIndexBuffer = nullptr;
+            currentEffect = nullptr;
+            currentInstance = UINT32_MAX;
+        }
+    }
+
+    ResetQueue();
+}
+
+
+void RenderQueue::Impl::ResetQueue()
+{
+    mWorlds.clear();
+    mCustomStates.clear();
+    mParts.clear();
+    mSortKeys.clear();
+
+    mEffectIds.clear();
+    mLayoutIds.clear();
+    mBufferIds.clear();
+}
+
+
+// Public constructor.
+RenderQueue::RenderQueue()
+  : pImpl(new Impl())
+{
+}
+
+
+// Move constructor.
+RenderQueue::RenderQueue(RenderQueue&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+RenderQueue& RenderQueue::operator= (RenderQueue&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+RenderQueue::~RenderQueue()
+{
+}
+
+
+void XM_CALLCONV RenderQueue::Begin(FXMMATRIX view, CXMMATRIX projection)
+{
+    pImpl->Begin(view, projection);
+}
+
+
+void RenderQueue::End(_In_ ID3D11DeviceContext* deviceContext, const CommonStates& states, bool wireframe)
+{
+    pImpl->End(deviceContext, states, wireframe);
+}
+
+
+void XM_CALLCONV RenderQueue::Enqueue(const Model& model, FXMMATRIX world, std::function<void()> setCustomState)
+{
+    pImpl->Enqueue(model, world, setCustomState);
+}
+
+
+const RenderQueue::Statistics& RenderQueue::GetStatistics() const
+{
+    return pImpl->mStats;
+}
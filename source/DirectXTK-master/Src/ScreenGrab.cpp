@@ -34,10 +34,22 @@
 #include "PlatformHelpers.h"
 #include "LoaderHelpers.h"
 
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 using namespace DirectX::LoaderHelpers;
 
+namespace DirectX
+{
+extern bool _IsWIC2();
+extern IWICImagingFactory* _GetWIC();
+}
+
 namespace
 {
     //--------------------------------------------------------------------------------------
@@ -160,489 +172,1197 @@ namespace
 
         return S_OK;
     }
-} // anonymous namespace
-
-
-//--------------------------------------------------------------------------------------
-_Use_decl_annotations_
-HRESULT DirectX::SaveDDSTextureToFile( ID3D11DeviceContext* pContext,
-                                       ID3D11Resource* pSource,
-                                       const wchar_t* fileName )
-{
-    if ( !fileName )
-        return E_INVALIDARG;
 
-    D3D11_TEXTURE2D_DESC desc = {};
-    ComPtr<ID3D11Texture2D> pStaging;
-    HRESULT hr = CaptureTexture( pContext, pSource, desc, pStaging );
-    if ( FAILED(hr) )
-        return hr;
 
-    // Create file
+    //--------------------------------------------------------------------------------------
+    // Writes the top-level image of a texture already read back to memory.
+    HRESULT WriteDDSImage(_In_z_ const wchar_t* fileName,
+        DXGI_FORMAT format, UINT width, UINT height,
+        _In_ const uint8_t* pixels, size_t srcRowPitch)
+    {
+        // Create file
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-    ScopedHandle hFile( safe_handle( CreateFile2( fileName, GENERIC_WRITE | DELETE, 0, CREATE_ALWAYS, nullptr ) ) );
+        ScopedHandle hFile( safe_handle( CreateFile2( fileName, GENERIC_WRITE | DELETE, 0, CREATE_ALWAYS, nullptr ) ) );
 #else
-    ScopedHandle hFile( safe_handle( CreateFileW( fileName, GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, 0, nullptr ) ) );
+        ScopedHandle hFile( safe_handle( CreateFileW( fileName, GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, 0, nullptr ) ) );
 #endif
-    if ( !hFile )
-        return HRESULT_FROM_WIN32( GetLastError() );
-
-    auto_delete_file delonfail(hFile.get());
-
-    // Setup header
-    const size_t MAX_HEADER_SIZE = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
-    uint8_t fileHeader[ MAX_HEADER_SIZE ];
-
-    *reinterpret_cast<uint32_t*>(&fileHeader[0]) = DDS_MAGIC;
-
-    auto header = reinterpret_cast<DDS_HEADER*>( &fileHeader[0] + sizeof(uint32_t) );
-    size_t headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER);
-    memset( header, 0, sizeof(DDS_HEADER) );
-    header->size = sizeof( DDS_HEADER );
-    header->flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
-    header->height = desc.Height;
-    header->width = desc.Width;
-    header->mipMapCount = 1;
-    header->caps = DDS_SURFACE_FLAGS_TEXTURE;
-
-    // Try to use a legacy .DDS pixel format for better tools support, otherwise fallback to 'DX10' header extension
-    DDS_HEADER_DXT10* extHeader = nullptr;
-    switch( desc.Format )
-    {
-    case DXGI_FORMAT_R8G8B8A8_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8B8G8R8, sizeof(DDS_PIXELFORMAT) );    break;
-    case DXGI_FORMAT_R16G16_UNORM:          memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_G16R16, sizeof(DDS_PIXELFORMAT) );      break;
-    case DXGI_FORMAT_R8G8_UNORM:            memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8L8, sizeof(DDS_PIXELFORMAT) );        break;
-    case DXGI_FORMAT_R16_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_L16, sizeof(DDS_PIXELFORMAT) );         break;
-    case DXGI_FORMAT_R8_UNORM:              memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_L8, sizeof(DDS_PIXELFORMAT) );          break;
-    case DXGI_FORMAT_A8_UNORM:              memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8, sizeof(DDS_PIXELFORMAT) );          break;
-    case DXGI_FORMAT_R8G8_B8G8_UNORM:       memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_R8G8_B8G8, sizeof(DDS_PIXELFORMAT) );   break;
-    case DXGI_FORMAT_G8R8_G8B8_UNORM:       memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_G8R8_G8B8, sizeof(DDS_PIXELFORMAT) );   break;
-    case DXGI_FORMAT_BC1_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DXT1, sizeof(DDS_PIXELFORMAT) );        break;
-    case DXGI_FORMAT_BC2_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DXT3, sizeof(DDS_PIXELFORMAT) );        break;
-    case DXGI_FORMAT_BC3_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DXT5, sizeof(DDS_PIXELFORMAT) );        break;
-    case DXGI_FORMAT_BC4_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC4_UNORM, sizeof(DDS_PIXELFORMAT) );   break;
-    case DXGI_FORMAT_BC4_SNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC4_SNORM, sizeof(DDS_PIXELFORMAT) );   break;
-    case DXGI_FORMAT_BC5_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC5_UNORM, sizeof(DDS_PIXELFORMAT) );   break;
-    case DXGI_FORMAT_BC5_SNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC5_SNORM, sizeof(DDS_PIXELFORMAT) );   break;
-    case DXGI_FORMAT_B5G6R5_UNORM:          memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_R5G6B5, sizeof(DDS_PIXELFORMAT) );      break;
-    case DXGI_FORMAT_B5G5R5A1_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A1R5G5B5, sizeof(DDS_PIXELFORMAT) );    break;
-    case DXGI_FORMAT_R8G8_SNORM:            memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_V8U8, sizeof(DDS_PIXELFORMAT) );        break;
-    case DXGI_FORMAT_R8G8B8A8_SNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_Q8W8V8U8, sizeof(DDS_PIXELFORMAT) );    break;
-    case DXGI_FORMAT_R16G16_SNORM:          memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_V16U16, sizeof(DDS_PIXELFORMAT) );      break;
-    case DXGI_FORMAT_B8G8R8A8_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8R8G8B8, sizeof(DDS_PIXELFORMAT) );    break; // DXGI 1.1
-    case DXGI_FORMAT_B8G8R8X8_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_X8R8G8B8, sizeof(DDS_PIXELFORMAT) );    break; // DXGI 1.1
-    case DXGI_FORMAT_YUY2:                  memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_YUY2, sizeof(DDS_PIXELFORMAT) );        break; // DXGI 1.2
-    case DXGI_FORMAT_B4G4R4A4_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A4R4G4B4, sizeof(DDS_PIXELFORMAT) );    break; // DXGI 1.2
-
-    // Legacy D3DX formats using D3DFMT enum value as FourCC
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 116; break; // D3DFMT_A32B32G32R32F
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 113; break; // D3DFMT_A16B16G16R16F
-    case DXGI_FORMAT_R16G16B16A16_UNORM:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 36;  break; // D3DFMT_A16B16G16R16
-    case DXGI_FORMAT_R16G16B16A16_SNORM:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 110; break; // D3DFMT_Q16W16V16U16
-    case DXGI_FORMAT_R32G32_FLOAT:          header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 115; break; // D3DFMT_G32R32F
-    case DXGI_FORMAT_R16G16_FLOAT:          header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 112; break; // D3DFMT_G16R16F
-    case DXGI_FORMAT_R32_FLOAT:             header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 114; break; // D3DFMT_R32F
-    case DXGI_FORMAT_R16_FLOAT:             header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 111; break; // D3DFMT_R16F
-
-    case DXGI_FORMAT_AI44:
-    case DXGI_FORMAT_IA44:
-    case DXGI_FORMAT_P8:
-    case DXGI_FORMAT_A8P8:
-        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
-
-    default:
-        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DX10, sizeof(DDS_PIXELFORMAT) );
-
-        headerSize += sizeof(DDS_HEADER_DXT10);
-        extHeader = reinterpret_cast<DDS_HEADER_DXT10*>( reinterpret_cast<uint8_t*>(&fileHeader[0]) + sizeof(uint32_t) + sizeof(DDS_HEADER) );
-        memset( extHeader, 0, sizeof(DDS_HEADER_DXT10) );
-        extHeader->dxgiFormat = desc.Format;
-        extHeader->resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
-        extHeader->arraySize = 1;
-        break;
-    }
+        if ( !hFile )
+            return HRESULT_FROM_WIN32( GetLastError() );
+
+        auto_delete_file delonfail(hFile.get());
+
+        // Setup header
+        const size_t MAX_HEADER_SIZE = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+        uint8_t fileHeader[ MAX_HEADER_SIZE ];
+
+        *reinterpret_cast<uint32_t*>(&fileHeader[0]) = DDS_MAGIC;
+
+        auto header = reinterpret_cast<DDS_HEADER*>( &fileHeader[0] + sizeof(uint32_t) );
+        size_t headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER);
+        memset( header, 0, sizeof(DDS_HEADER) );
+        header->size = sizeof( DDS_HEADER );
+        header->flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP;
+        header->height = height;
+        header->width = width;
+        header->mipMapCount = 1;
+        header->caps = DDS_SURFACE_FLAGS_TEXTURE;
+
+        // Try to use a legacy .DDS pixel format for better tools support, otherwise fallback to 'DX10' header extension
+        DDS_HEADER_DXT10* extHeader = nullptr;
+        switch( format )
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8B8G8R8, sizeof(DDS_PIXELFORMAT) );    break;
+        case DXGI_FORMAT_R16G16_UNORM:          memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_G16R16, sizeof(DDS_PIXELFORMAT) );      break;
+        case DXGI_FORMAT_R8G8_UNORM:            memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8L8, sizeof(DDS_PIXELFORMAT) );        break;
+        case DXGI_FORMAT_R16_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_L16, sizeof(DDS_PIXELFORMAT) );         break;
+        case DXGI_FORMAT_R8_UNORM:              memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_L8, sizeof(DDS_PIXELFORMAT) );          break;
+        case DXGI_FORMAT_A8_UNORM:              memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8, sizeof(DDS_PIXELFORMAT) );          break;
+        case DXGI_FORMAT_R8G8_B8G8_UNORM:       memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_R8G8_B8G8, sizeof(DDS_PIXELFORMAT) );   break;
+        case DXGI_FORMAT_G8R8_G8B8_UNORM:       memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_G8R8_G8B8, sizeof(DDS_PIXELFORMAT) );   break;
+        case DXGI_FORMAT_BC1_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DXT1, sizeof(DDS_PIXELFORMAT) );        break;
+        case DXGI_FORMAT_BC2_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DXT3, sizeof(DDS_PIXELFORMAT) );        break;
+        case DXGI_FORMAT_BC3_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DXT5, sizeof(DDS_PIXELFORMAT) );        break;
+        case DXGI_FORMAT_BC4_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC4_UNORM, sizeof(DDS_PIXELFORMAT) );   break;
+        case DXGI_FORMAT_BC4_SNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC4_SNORM, sizeof(DDS_PIXELFORMAT) );   break;
+        case DXGI_FORMAT_BC5_UNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC5_UNORM, sizeof(DDS_PIXELFORMAT) );   break;
+        case DXGI_FORMAT_BC5_SNORM:             memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_BC5_SNORM, sizeof(DDS_PIXELFORMAT) );   break;
+        case DXGI_FORMAT_B5G6R5_UNORM:          memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_R5G6B5, sizeof(DDS_PIXELFORMAT) );      break;
+        case DXGI_FORMAT_B5G5R5A1_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A1R5G5B5, sizeof(DDS_PIXELFORMAT) );    break;
+        case DXGI_FORMAT_R8G8_SNORM:            memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_V8U8, sizeof(DDS_PIXELFORMAT) );        break;
+        case DXGI_FORMAT_R8G8B8A8_SNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_Q8W8V8U8, sizeof(DDS_PIXELFORMAT) );    break;
+        case DXGI_FORMAT_R16G16_SNORM:          memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_V16U16, sizeof(DDS_PIXELFORMAT) );      break;
+        case DXGI_FORMAT_B8G8R8A8_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A8R8G8B8, sizeof(DDS_PIXELFORMAT) );    break; // DXGI 1.1
+        case DXGI_FORMAT_B8G8R8X8_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_X8R8G8B8, sizeof(DDS_PIXELFORMAT) );    break; // DXGI 1.1
+        case DXGI_FORMAT_YUY2:                  memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_YUY2, sizeof(DDS_PIXELFORMAT) );        break; // DXGI 1.2
+        case DXGI_FORMAT_B4G4R4A4_UNORM:        memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_A4R4G4B4, sizeof(DDS_PIXELFORMAT) );    break; // DXGI 1.2
+
+        // Legacy D3DX formats using D3DFMT enum value as FourCC
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 116; break; // D3DFMT_A32B32G32R32F
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 113; break; // D3DFMT_A16B16G16R16F
+        case DXGI_FORMAT_R16G16B16A16_UNORM:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 36;  break; // D3DFMT_A16B16G16R16
+        case DXGI_FORMAT_R16G16B16A16_SNORM:    header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 110; break; // D3DFMT_Q16W16V16U16
+        case DXGI_FORMAT_R32G32_FLOAT:          header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 115; break; // D3DFMT_G32R32F
+        case DXGI_FORMAT_R16G16_FLOAT:          header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 112; break; // D3DFMT_G16R16F
+        case DXGI_FORMAT_R32_FLOAT:             header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 114; break; // D3DFMT_R32F
+        case DXGI_FORMAT_R16_FLOAT:             header->ddspf.size = sizeof(DDS_PIXELFORMAT); header->ddspf.flags = DDS_FOURCC; header->ddspf.fourCC = 111; break; // D3DFMT_R16F
+
+        case DXGI_FORMAT_AI44:
+        case DXGI_FORMAT_IA44:
+        case DXGI_FORMAT_P8:
+        case DXGI_FORMAT_A8P8:
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
 
-    size_t rowPitch, slicePitch, rowCount;
-    GetSurfaceInfo( desc.Width, desc.Height, desc.Format, &slicePitch, &rowPitch, &rowCount );
+        default:
+            memcpy_s( &header->ddspf, sizeof(header->ddspf), &DDSPF_DX10, sizeof(DDS_PIXELFORMAT) );
+
+            headerSize += sizeof(DDS_HEADER_DXT10);
+            extHeader = reinterpret_cast<DDS_HEADER_DXT10*>( reinterpret_cast<uint8_t*>(&fileHeader[0]) + sizeof(uint32_t) + sizeof(DDS_HEADER) );
+            memset( extHeader, 0, sizeof(DDS_HEADER_DXT10) );
+            extHeader->dxgiFormat = format;
+            extHeader->resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+            extHeader->arraySize = 1;
+            break;
+        }
 
-    if ( IsCompressed( desc.Format ) )
-    {
-        header->flags |= DDS_HEADER_FLAGS_LINEARSIZE;
-        header->pitchOrLinearSize = static_cast<uint32_t>( slicePitch );
-    }
-    else
-    {
-        header->flags |= DDS_HEADER_FLAGS_PITCH;
-        header->pitchOrLinearSize = static_cast<uint32_t>( rowPitch );
-    }
+        size_t rowPitch, slicePitch, rowCount;
+        GetSurfaceInfo( width, height, format, &slicePitch, &rowPitch, &rowCount );
 
-    // Setup pixels
-    std::unique_ptr<uint8_t[]> pixels( new (std::nothrow) uint8_t[ slicePitch ] );
-    if (!pixels)
-        return E_OUTOFMEMORY;
+        if ( IsCompressed( format ) )
+        {
+            header->flags |= DDS_HEADER_FLAGS_LINEARSIZE;
+            header->pitchOrLinearSize = static_cast<uint32_t>( slicePitch );
+        }
+        else
+        {
+            header->flags |= DDS_HEADER_FLAGS_PITCH;
+            header->pitchOrLinearSize = static_cast<uint32_t>( rowPitch );
+        }
 
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    hr = pContext->Map( pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped );
-    if ( FAILED(hr) )
-        return hr;
+        // Pixels are written in one block, so repack the rows if the source is padded
+        std::unique_ptr<uint8_t[]> packed;
+        const uint8_t* data = pixels;
+        if ( srcRowPitch != rowPitch )
+        {
+            packed.reset( new (std::nothrow) uint8_t[ slicePitch ] );
+            if ( !packed )
+                return E_OUTOFMEMORY;
 
-    auto sptr = reinterpret_cast<const uint8_t*>( mapped.pData );
-    if ( !sptr )
-    {
-        pContext->Unmap( pStaging.Get(), 0 );
-        return E_POINTER;
-    }
+            auto sptr = pixels;
+            uint8_t* dptr = packed.get();
 
-    uint8_t* dptr = pixels.get();
+            size_t msize = std::min<size_t>( rowPitch, srcRowPitch );
+            for( size_t h = 0; h < rowCount; ++h )
+            {
+                memcpy_s( dptr, rowPitch, sptr, msize );
+                sptr += srcRowPitch;
+                dptr += rowPitch;
+            }
 
-    size_t msize = std::min<size_t>( rowPitch, mapped.RowPitch );
-    for( size_t h = 0; h < rowCount; ++h )
-    {
-        memcpy_s( dptr, rowPitch, sptr, msize );
-        sptr += mapped.RowPitch;
-        dptr += rowPitch;
-    }
+            data = packed.get();
+        }
 
-    pContext->Unmap( pStaging.Get(), 0 );
+        // Write header & pixels
+        DWORD bytesWritten;
+        if ( !WriteFile( hFile.get(), fileHeader, static_cast<DWORD>( headerSize ), &bytesWritten, nullptr ) )
+            return HRESULT_FROM_WIN32( GetLastError() );
 
-    // Write header & pixels
-    DWORD bytesWritten;
-    if ( !WriteFile( hFile.get(), fileHeader, static_cast<DWORD>( headerSize ), &bytesWritten, nullptr ) )
-        return HRESULT_FROM_WIN32( GetLastError() );
+        if ( bytesWritten != headerSize )
+            return E_FAIL;
 
-    if ( bytesWritten != headerSize )
-        return E_FAIL;
+        if ( !WriteFile( hFile.get(), data, static_cast<DWORD>( slicePitch ), &bytesWritten, nullptr ) )
+            return HRESULT_FROM_WIN32( GetLastError() );
 
-    if ( !WriteFile( hFile.get(), pixels.get(), static_cast<DWORD>( slicePitch ), &bytesWritten, nullptr ) )
-        return HRESULT_FROM_WIN32( GetLastError() );
+        if ( bytesWritten != slicePitch )
+            return E_FAIL;
 
-    if ( bytesWritten != slicePitch )
-        return E_FAIL;
+        delonfail.clear();
 
-    delonfail.clear();
+        return S_OK;
+    }
 
-    return S_OK;
-}
 
-//--------------------------------------------------------------------------------------
-namespace DirectX
-{
-extern bool _IsWIC2();
-extern IWICImagingFactory* _GetWIC();
-}
+    //--------------------------------------------------------------------------------------
+    // Encodes the top-level image of a texture already read back to memory.
+    HRESULT WriteWICImage(_In_z_ const wchar_t* fileName,
+        REFGUID guidContainerFormat,
+        _In_opt_ const GUID* targetFormat,
+        std::function<void(IPropertyBag2*)> setCustomProps,
+        DXGI_FORMAT format, UINT width, UINT height,
+        _In_ const uint8_t* pixels, size_t rowPitch)
+    {
+        // Determine source format's WIC equivalent
+        WICPixelFormatGUID pfGuid;
+        bool sRGB = false;
+        switch ( format )
+        {
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:            pfGuid = GUID_WICPixelFormat128bppRGBAFloat; break;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:            pfGuid = GUID_WICPixelFormat64bppRGBAHalf; break;
+        case DXGI_FORMAT_R16G16B16A16_UNORM:            pfGuid = GUID_WICPixelFormat64bppRGBA; break;
+        case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:    pfGuid = GUID_WICPixelFormat32bppRGBA1010102XR; break; // DXGI 1.1
+        case DXGI_FORMAT_R10G10B10A2_UNORM:             pfGuid = GUID_WICPixelFormat32bppRGBA1010102; break;
+        case DXGI_FORMAT_B5G5R5A1_UNORM:                pfGuid = GUID_WICPixelFormat16bppBGRA5551; break;
+        case DXGI_FORMAT_B5G6R5_UNORM:                  pfGuid = GUID_WICPixelFormat16bppBGR565; break;
+        case DXGI_FORMAT_R32_FLOAT:                     pfGuid = GUID_WICPixelFormat32bppGrayFloat; break;
+        case DXGI_FORMAT_R16_FLOAT:                     pfGuid = GUID_WICPixelFormat16bppGrayHalf; break;
+        case DXGI_FORMAT_R16_UNORM:                     pfGuid = GUID_WICPixelFormat16bppGray; break;
+        case DXGI_FORMAT_R8_UNORM:                      pfGuid = GUID_WICPixelFormat8bppGray; break;
+        case DXGI_FORMAT_A8_UNORM:                      pfGuid = GUID_WICPixelFormat8bppAlpha; break;
+
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            pfGuid = GUID_WICPixelFormat32bppRGBA;
+            break;
 
-_Use_decl_annotations_
-HRESULT DirectX::SaveWICTextureToFile( ID3D11DeviceContext* pContext,
-                                       ID3D11Resource* pSource,
-                                       REFGUID guidContainerFormat, 
-                                       const wchar_t* fileName,
-                                       const GUID* targetFormat,
-                                       std::function<void(IPropertyBag2*)> setCustomProps )
-{
-    if ( !fileName )
-        return E_INVALIDARG;
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            pfGuid = GUID_WICPixelFormat32bppRGBA;
+            sRGB = true;
+            break;
 
-    D3D11_TEXTURE2D_DESC desc = {};
-    ComPtr<ID3D11Texture2D> pStaging;
-    HRESULT hr = CaptureTexture( pContext, pSource, desc, pStaging );
-    if ( FAILED(hr) )
-        return hr;
+        case DXGI_FORMAT_B8G8R8A8_UNORM: // DXGI 1.1
+            pfGuid = GUID_WICPixelFormat32bppBGRA;
+            break;
 
-    // Determine source format's WIC equivalent
-    WICPixelFormatGUID pfGuid;
-    bool sRGB = false;
-    switch ( desc.Format )
-    {
-    case DXGI_FORMAT_R32G32B32A32_FLOAT:            pfGuid = GUID_WICPixelFormat128bppRGBAFloat; break;
-    case DXGI_FORMAT_R16G16B16A16_FLOAT:            pfGuid = GUID_WICPixelFormat64bppRGBAHalf; break;
-    case DXGI_FORMAT_R16G16B16A16_UNORM:            pfGuid = GUID_WICPixelFormat64bppRGBA; break;
-    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:    pfGuid = GUID_WICPixelFormat32bppRGBA1010102XR; break; // DXGI 1.1
-    case DXGI_FORMAT_R10G10B10A2_UNORM:             pfGuid = GUID_WICPixelFormat32bppRGBA1010102; break;
-    case DXGI_FORMAT_B5G5R5A1_UNORM:                pfGuid = GUID_WICPixelFormat16bppBGRA5551; break;
-    case DXGI_FORMAT_B5G6R5_UNORM:                  pfGuid = GUID_WICPixelFormat16bppBGR565; break;
-    case DXGI_FORMAT_R32_FLOAT:                     pfGuid = GUID_WICPixelFormat32bppGrayFloat; break;
-    case DXGI_FORMAT_R16_FLOAT:                     pfGuid = GUID_WICPixelFormat16bppGrayHalf; break;
-    case DXGI_FORMAT_R16_UNORM:                     pfGuid = GUID_WICPixelFormat16bppGray; break;
-    case DXGI_FORMAT_R8_UNORM:                      pfGuid = GUID_WICPixelFormat8bppGray; break;
-    case DXGI_FORMAT_A8_UNORM:                      pfGuid = GUID_WICPixelFormat8bppAlpha; break;
-
-    case DXGI_FORMAT_R8G8B8A8_UNORM:
-        pfGuid = GUID_WICPixelFormat32bppRGBA;
-        break;
-
-    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-        pfGuid = GUID_WICPixelFormat32bppRGBA;
-        sRGB = true;
-        break;
-
-    case DXGI_FORMAT_B8G8R8A8_UNORM: // DXGI 1.1
-        pfGuid = GUID_WICPixelFormat32bppBGRA;
-        break;
-
-    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: // DXGI 1.1
-        pfGuid = GUID_WICPixelFormat32bppBGRA;
-        sRGB = true;
-        break;
-
-    case DXGI_FORMAT_B8G8R8X8_UNORM: // DXGI 1.1
-        pfGuid = GUID_WICPixelFormat32bppBGR;
-        break; 
-
-    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB: // DXGI 1.1
-        pfGuid = GUID_WICPixelFormat32bppBGR;
-        sRGB = true;
-        break; 
-
-    default:
-        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
-    }
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB: // DXGI 1.1
+            pfGuid = GUID_WICPixelFormat32bppBGRA;
+            sRGB = true;
+            break;
 
-    auto pWIC = _GetWIC();
-    if ( !pWIC )
-        return E_NOINTERFACE;
+        case DXGI_FORMAT_B8G8R8X8_UNORM: // DXGI 1.1
+            pfGuid = GUID_WICPixelFormat32bppBGR;
+            break; 
 
-    ComPtr<IWICStream> stream;
-    hr = pWIC->CreateStream( stream.GetAddressOf() );
-    if ( FAILED(hr) )
-        return hr;
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB: // DXGI 1.1
+            pfGuid = GUID_WICPixelFormat32bppBGR;
+            sRGB = true;
+            break; 
 
-    hr = stream->InitializeFromFilename( fileName, GENERIC_WRITE );
-    if ( FAILED(hr) )
-        return hr;
+        default:
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
 
-    auto_delete_file_wic delonfail(stream, fileName);
+        auto pWIC = _GetWIC();
+        if ( !pWIC )
+            return E_NOINTERFACE;
 
-    ComPtr<IWICBitmapEncoder> encoder;
-    hr = pWIC->CreateEncoder( guidContainerFormat, 0, encoder.GetAddressOf() );
-    if ( FAILED(hr) )
-        return hr;
+        ComPtr<IWICStream> stream;
+        HRESULT hr = pWIC->CreateStream( stream.GetAddressOf() );
+        if ( FAILED(hr) )
+            return hr;
 
-    hr = encoder->Initialize( stream.Get(), WICBitmapEncoderNoCache );
-    if ( FAILED(hr) )
-        return hr;
+        hr = stream->InitializeFromFilename( fileName, GENERIC_WRITE );
+        if ( FAILED(hr) )
+            return hr;
 
-    ComPtr<IWICBitmapFrameEncode> frame;
-    ComPtr<IPropertyBag2> props;
-    hr = encoder->CreateNewFrame( frame.GetAddressOf(), props.GetAddressOf() );
-    if ( FAILED(hr) )
-        return hr;
+        auto_delete_file_wic delonfail(stream, fileName);
 
-    if ( targetFormat && memcmp( &guidContainerFormat, &GUID_ContainerFormatBmp, sizeof(WICPixelFormatGUID) ) == 0 && _IsWIC2() )
-    {
-        // Opt-in to the WIC2 support for writing 32-bit Windows BMP files with an alpha channel
-        PROPBAG2 option = {};
-        option.pstrName = const_cast<wchar_t*>(L"EnableV5Header32bppBGRA");
-
-        VARIANT varValue;    
-        varValue.vt = VT_BOOL;
-        varValue.boolVal = VARIANT_TRUE;      
-        (void)props->Write( 1, &option, &varValue ); 
-    }
+        ComPtr<IWICBitmapEncoder> encoder;
+        hr = pWIC->CreateEncoder( guidContainerFormat, 0, encoder.GetAddressOf() );
+        if ( FAILED(hr) )
+            return hr;
 
-    if ( setCustomProps )
-    {
-        setCustomProps( props.Get() );
-    }
+        hr = encoder->Initialize( stream.Get(), WICBitmapEncoderNoCache );
+        if ( FAILED(hr) )
+            return hr;
 
-    hr = frame->Initialize( props.Get() );
-    if ( FAILED(hr) )
-        return hr;
+        ComPtr<IWICBitmapFrameEncode> frame;
+        ComPtr<IPropertyBag2> props;
+        hr = encoder->CreateNewFrame( frame.GetAddressOf(), props.GetAddressOf() );
+        if ( FAILED(hr) )
+            return hr;
 
-    hr = frame->SetSize( desc.Width , desc.Height );
-    if ( FAILED(hr) )
-        return hr;
+        if ( targetFormat && memcmp( &guidContainerFormat, &GUID_ContainerFormatBmp, sizeof(WICPixelFormatGUID) ) == 0 && _IsWIC2() )
+        {
+            // Opt-in to the WIC2 support for writing 32-bit Windows BMP files with an alpha channel
+            PROPBAG2 option = {};
+            option.pstrName = const_cast<wchar_t*>(L"EnableV5Header32bppBGRA");
+
+            VARIANT varValue;    
+            varValue.vt = VT_BOOL;
+            varValue.boolVal = VARIANT_TRUE;      
+            (void)props->Write( 1, &option, &varValue ); 
+        }
 
-    hr = frame->SetResolution( 72, 72 );
-    if ( FAILED(hr) )
-        return hr;
+        if ( setCustomProps )
+        {
+            setCustomProps( props.Get() );
+        }
 
-    // Pick a target format
-    WICPixelFormatGUID targetGuid;
-    if ( targetFormat )
-    {
-        targetGuid = *targetFormat;
-    }
-    else
-    {
-        // Screenshots dont typically include the alpha channel of the render target
-        switch ( desc.Format )
+        hr = frame->Initialize( props.Get() );
+        if ( FAILED(hr) )
+            return hr;
+
+        hr = frame->SetSize( width, height );
+        if ( FAILED(hr) )
+            return hr;
+
+        hr = frame->SetResolution( 72, 72 );
+        if ( FAILED(hr) )
+            return hr;
+
+        // Pick a target format
+        WICPixelFormatGUID targetGuid;
+        if ( targetFormat )
         {
-#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) || defined(_WIN7_PLATFORM_UPDATE)
-        case DXGI_FORMAT_R32G32B32A32_FLOAT:            
-        case DXGI_FORMAT_R16G16B16A16_FLOAT:
-            if ( _IsWIC2() )
-            {
-                targetGuid = GUID_WICPixelFormat96bppRGBFloat;
-            }
-            else
+            targetGuid = *targetFormat;
+        }
+        else
+        {
+            // Screenshots dont typically include the alpha channel of the render target
+            switch ( format )
             {
-                targetGuid = GUID_WICPixelFormat24bppBGR;
-            }
-            break;
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) || defined(_WIN7_PLATFORM_UPDATE)
+            case DXGI_FORMAT_R32G32B32A32_FLOAT:            
+            case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                if ( _IsWIC2() )
+                {
+                    targetGuid = GUID_WICPixelFormat96bppRGBFloat;
+                }
+                else
+                {
+                    targetGuid = GUID_WICPixelFormat24bppBGR;
+                }
+                break;
 #endif
 
-        case DXGI_FORMAT_R16G16B16A16_UNORM: targetGuid = GUID_WICPixelFormat48bppBGR; break;
-        case DXGI_FORMAT_B5G5R5A1_UNORM:     targetGuid = GUID_WICPixelFormat16bppBGR555; break;
-        case DXGI_FORMAT_B5G6R5_UNORM:       targetGuid = GUID_WICPixelFormat16bppBGR565; break;
+            case DXGI_FORMAT_R16G16B16A16_UNORM: targetGuid = GUID_WICPixelFormat48bppBGR; break;
+            case DXGI_FORMAT_B5G5R5A1_UNORM:     targetGuid = GUID_WICPixelFormat16bppBGR555; break;
+            case DXGI_FORMAT_B5G6R5_UNORM:       targetGuid = GUID_WICPixelFormat16bppBGR565; break;
 
-        case DXGI_FORMAT_R32_FLOAT:
-        case DXGI_FORMAT_R16_FLOAT:
-        case DXGI_FORMAT_R16_UNORM:
-        case DXGI_FORMAT_R8_UNORM:
-        case DXGI_FORMAT_A8_UNORM:
-            targetGuid = GUID_WICPixelFormat8bppGray;
-            break;
+            case DXGI_FORMAT_R32_FLOAT:
+            case DXGI_FORMAT_R16_FLOAT:
+            case DXGI_FORMAT_R16_UNORM:
+            case DXGI_FORMAT_R8_UNORM:
+            case DXGI_FORMAT_A8_UNORM:
+                targetGuid = GUID_WICPixelFormat8bppGray;
+                break;
 
-        default:
-            targetGuid = GUID_WICPixelFormat24bppBGR;
-            break;
+            default:
+                targetGuid = GUID_WICPixelFormat24bppBGR;
+                break;
+            }
         }
-    }
-
-    hr = frame->SetPixelFormat( &targetGuid );
-    if ( FAILED(hr) )
-        return hr;
-
-    if ( targetFormat && memcmp( targetFormat, &targetGuid, sizeof(WICPixelFormatGUID) ) != 0 )
-    {
-        // Requested output pixel format is not supported by the WIC codec
-        return E_FAIL;
-    }
 
-    // Encode WIC metadata
-    ComPtr<IWICMetadataQueryWriter> metawriter;
-    if ( SUCCEEDED( frame->GetMetadataQueryWriter( metawriter.GetAddressOf() ) ) )
-    {
-        PROPVARIANT value;
-        PropVariantInit( &value );
+        hr = frame->SetPixelFormat( &targetGuid );
+        if ( FAILED(hr) )
+            return hr;
 
-        value.vt = VT_LPSTR;
-        value.pszVal = const_cast<char*>("DirectXTK");
+        if ( targetFormat && memcmp( targetFormat, &targetGuid, sizeof(WICPixelFormatGUID) ) != 0 )
+        {
+            // Requested output pixel format is not supported by the WIC codec
+            return E_FAIL;
+        }
 
-        if ( memcmp( &guidContainerFormat, &GUID_ContainerFormatPng, sizeof(GUID) ) == 0 )
+        // Encode WIC metadata
+        ComPtr<IWICMetadataQueryWriter> metawriter;
+        if ( SUCCEEDED( frame->GetMetadataQueryWriter( metawriter.GetAddressOf() ) ) )
         {
-            // Set Software name
-            (void)metawriter->SetMetadataByName( L"/tEXt/{str=Software}", &value );
+            PROPVARIANT value;
+            PropVariantInit( &value );
 
-            // Set sRGB chunk
-            if ( sRGB )
+            value.vt = VT_LPSTR;
+            value.pszVal = const_cast<char*>("DirectXTK");
+
+            if ( memcmp( &guidContainerFormat, &GUID_ContainerFormatPng, sizeof(GUID) ) == 0 )
             {
-                value.vt = VT_UI1;
-                value.bVal = 0;
-                (void)metawriter->SetMetadataByName( L"/sRGB/RenderingIntent", &value );
+                // Set Software name
+                (void)metawriter->SetMetadataByName( L"/tEXt/{str=Software}", &value );
+
+                // Set sRGB chunk
+                if ( sRGB )
+                {
+                    value.vt = VT_UI1;
+                    value.bVal = 0;
+                    (void)metawriter->SetMetadataByName( L"/sRGB/RenderingIntent", &value );
+                }
             }
-        }
 #if defined(_XBOX_ONE) && defined(_TITLE)
-        else if ( memcmp( &guidContainerFormat, &GUID_ContainerFormatJpeg, sizeof(GUID) ) == 0 )
-        {
-            // Set Software name
-            (void)metawriter->SetMetadataByName( L"/app1/ifd/{ushort=305}", &value );
-
-            if ( sRGB )
+            else if ( memcmp( &guidContainerFormat, &GUID_ContainerFormatJpeg, sizeof(GUID) ) == 0 )
             {
-                // Set EXIF Colorspace of sRGB
-                value.vt = VT_UI2;
-                value.uiVal = 1;
-                (void)metawriter->SetMetadataByName( L"/app1/ifd/exif/{ushort=40961}", &value );
+                // Set Software name
+                (void)metawriter->SetMetadataByName( L"/app1/ifd/{ushort=305}", &value );
+
+                if ( sRGB )
+                {
+                    // Set EXIF Colorspace of sRGB
+                    value.vt = VT_UI2;
+                    value.uiVal = 1;
+                    (void)metawriter->SetMetadataByName( L"/app1/ifd/exif/{ushort=40961}", &value );
+                }
             }
-        }
-        else if ( memcmp( &guidContainerFormat, &GUID_ContainerFormatTiff, sizeof(GUID) ) == 0 )
-        {
-            // Set Software name
-            (void)metawriter->SetMetadataByName( L"/ifd/{ushort=305}", &value );
+            else if ( memcmp( &guidContainerFormat, &GUID_ContainerFormatTiff, sizeof(GUID) ) == 0 )
+            {
+                // Set Software name
+                (void)metawriter->SetMetadataByName( L"/ifd/{ushort=305}", &value );
 
-            if ( sRGB )
+                if ( sRGB )
+                {
+                    // Set EXIF Colorspace of sRGB
+                    value.vt = VT_UI2;
+                    value.uiVal = 1;
+                    (void)metawriter->SetMetadataByName( L"/ifd/exif/{ushort=40961}", &value );
+                }
+            }
+#else
+            else
             {
-                // Set EXIF Colorspace of sRGB
-                value.vt = VT_UI2;
-                value.uiVal = 1;
-                (void)metawriter->SetMetadataByName( L"/ifd/exif/{ushort=40961}", &value );
+                // Set Software name
+                (void)metawriter->SetMetadataByName( L"System.ApplicationName", &value );
+
+                if ( sRGB )
+                {
+                    // Set EXIF Colorspace of sRGB
+                    value.vt = VT_UI2;
+                    value.uiVal = 1;
+                    (void)metawriter->SetMetadataByName( L"System.Image.ColorSpace", &value );
+                }
             }
+#endif
         }
-#else
-        else
+
+        if ( memcmp( &targetGuid, &pfGuid, sizeof(WICPixelFormatGUID) ) != 0 )
         {
-            // Set Software name
-            (void)metawriter->SetMetadataByName( L"System.ApplicationName", &value );
+            // Conversion required to write
+            ComPtr<IWICBitmap> source;
+            hr = pWIC->CreateBitmapFromMemory( width, height, pfGuid,
+                                               static_cast<UINT>( rowPitch ), static_cast<UINT>( rowPitch * height ),
+                                               const_cast<BYTE*>( pixels ), source.GetAddressOf() );
+            if ( FAILED(hr) )
+                return hr;
 
-            if ( sRGB )
+            ComPtr<IWICFormatConverter> FC;
+            hr = pWIC->CreateFormatConverter( FC.GetAddressOf() );
+            if ( FAILED(hr) )
+                return hr;
+
+            BOOL canConvert = FALSE;
+            hr = FC->CanConvert( pfGuid, targetGuid, &canConvert );
+            if ( FAILED(hr) || !canConvert )
             {
-                // Set EXIF Colorspace of sRGB
-                value.vt = VT_UI2;
-                value.uiVal = 1;
-                (void)metawriter->SetMetadataByName( L"System.Image.ColorSpace", &value );
+                return E_UNEXPECTED;
             }
-        }
-#endif
-    }
-
-    D3D11_MAPPED_SUBRESOURCE mapped;
-    hr = pContext->Map( pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped );
-    if ( FAILED(hr) )
-        return hr;
 
-    if ( memcmp( &targetGuid, &pfGuid, sizeof(WICPixelFormatGUID) ) != 0 )
-    {
-        // Conversion required to write
-        ComPtr<IWICBitmap> source;
-        hr = pWIC->CreateBitmapFromMemory( desc.Width, desc.Height, pfGuid,
-                                           mapped.RowPitch, mapped.RowPitch * desc.Height,
-                                           reinterpret_cast<BYTE*>( mapped.pData ), source.GetAddressOf() );
-        if ( FAILED(hr) )
-        {
-            pContext->Unmap( pStaging.Get(), 0 );
-            return hr;
-        }
+            hr = FC->Initialize( source.Get(), targetGuid, WICBitmapDitherTypeNone, 0, 0, WICBitmapPaletteTypeCustom );
+            if ( FAILED(hr) )
+                return hr;
 
-        ComPtr<IWICFormatConverter> FC;
-        hr = pWIC->CreateFormatConverter( FC.GetAddressOf() );
-        if ( FAILED(hr) )
-        {
-            pContext->Unmap( pStaging.Get(), 0 );
-            return hr;
+            WICRect rect = { 0, 0, static_cast<INT>( width ), static_cast<INT>( height ) };
+            hr = frame->WriteSource( FC.Get(), &rect );
+            if ( FAILED(hr) )
+                return hr;
         }
-
-        BOOL canConvert = FALSE;
-        hr = FC->CanConvert( pfGuid, targetGuid, &canConvert );
-        if ( FAILED(hr) || !canConvert )
+        else
         {
-            return E_UNEXPECTED;
+            // No conversion required
+            hr = frame->WritePixels( height, static_cast<UINT>( rowPitch ), static_cast<UINT>( rowPitch * height ), const_cast<BYTE*>( pixels ) );
+            if ( FAILED(hr) )
+                return hr;
         }
 
-        hr = FC->Initialize( source.Get(), targetGuid, WICBitmapDitherTypeNone, 0, 0, WICBitmapPaletteTypeCustom );
+        hr = frame->Commit();
         if ( FAILED(hr) )
-        {
-            pContext->Unmap( pStaging.Get(), 0 );
             return hr;
-        }
 
-        WICRect rect = { 0, 0, static_cast<INT>( desc.Width ), static_cast<INT>( desc.Height ) };
-        hr = frame->WriteSource( FC.Get(), &rect );
+        hr = encoder->Commit();
         if ( FAILED(hr) )
-        {
-            pContext->Unmap( pStaging.Get(), 0 );
             return hr;
-        }
+
+        delonfail.clear();
+
+        return S_OK;
     }
-    else
+
+
+    //--------------------------------------------------------------------------------------
+    // File extension for frame sequences written with a WIC container.
+    const wchar_t* GetContainerExtension(REFGUID guidContainerFormat)
     {
-        // No conversion required
-        hr = frame->WritePixels( desc.Height, mapped.RowPitch, mapped.RowPitch * desc.Height, reinterpret_cast<BYTE*>( mapped.pData ) );
-        if ( FAILED(hr) )
-            return hr;
+        if (memcmp(&guidContainerFormat, &GUID_ContainerFormatPng, sizeof(GUID)) == 0)
+            return L".png";
+
+        if (memcmp(&guidContainerFormat, &GUID_ContainerFormatJpeg, sizeof(GUID)) == 0)
+            return L".jpg";
+
+        if (memcmp(&guidContainerFormat, &GUID_ContainerFormatBmp, sizeof(GUID)) == 0)
+            return L".bmp";
+
+        if (memcmp(&guidContainerFormat, &GUID_ContainerFormatTiff, sizeof(GUID)) == 0)
+            return L".tif";
+
+        if (memcmp(&guidContainerFormat, &GUID_ContainerFormatGif, sizeof(GUID)) == 0)
+            return L".gif";
+
+        return L".jxr";
     }
+} // anonymous namespace
 
-    pContext->Unmap( pStaging.Get(), 0 );
 
-    hr = frame->Commit();
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveDDSTextureToFile( ID3D11DeviceContext* pContext,
+                                       ID3D11Resource* pSource,
+                                       const wchar_t* fileName )
+{
+    if ( !fileName )
+        return E_INVALIDARG;
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    ComPtr<ID3D11Texture2D> pStaging;
+    HRESULT hr = CaptureTexture( pContext, pSource, desc, pStaging );
     if ( FAILED(hr) )
         return hr;
 
-    hr = encoder->Commit();
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    hr = pContext->Map( pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped );
     if ( FAILED(hr) )
         return hr;
 
-    delonfail.clear();
+    auto sptr = reinterpret_cast<const uint8_t*>( mapped.pData );
+    if ( !sptr )
+    {
+        pContext->Unmap( pStaging.Get(), 0 );
+        return E_POINTER;
+    }
+
+    hr = WriteDDSImage( fileName, desc.Format, desc.Width, desc.Height, sptr, mapped.RowPitch );
+
+    pContext->Unmap( pStaging.Get(), 0 );
+
+    return hr;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::SaveWICTextureToFile( ID3D11DeviceContext* pContext,
+                                       ID3D11Resource* pSource,
+                                       REFGUID guidContainerFormat,
+                                       const wchar_t* fileName,
+                                       const GUID* targetFormat,
+                                       std::function<void(IPropertyBag2*)> setCustomProps )
+{
+    if ( !fileName )
+        return E_INVALIDARG;
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    ComPtr<ID3D11Texture2D> pStaging;
+    HRESULT hr = CaptureTexture( pContext, pSource, desc, pStaging );
+    if ( FAILED(hr) )
+        return hr;
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    hr = pContext->Map( pStaging.Get(), 0, D3D11_MAP_READ, 0, &mapped );
+    if ( FAILED(hr) )
+        return hr;
+
+    auto sptr = reinterpret_cast<const uint8_t*>( mapped.pData );
+    if ( !sptr )
+    {
+        pContext->Unmap( pStaging.Get(), 0 );
+        return E_POINTER;
+    }
+
+    hr = WriteWICImage( fileName, guidContainerFormat, targetFormat, setCustomProps,
+                        desc.Format, desc.Width, desc.Height, sptr, mapped.RowPitch );
+
+    pContext->Unmap( pStaging.Get(), 0 );
+
+    return hr;
+}
+
+
+//--------------------------------------------------------------------------------------
+// Internal ScreenGrabQueue implementation class.
+class ScreenGrabQueue::Impl
+{
+public:
+    Impl(size_t frameLatency, size_t workerCount);
+    ~Impl();
+
+    // Where an image gets written.
+    struct Target
+    {
+        std::wstring fileName;
+        bool dds;
+        GUID container;
+    };
+
+    // An image read back to memory, with tightly packed rows.
+    struct EncodeJob
+    {
+        Target target;
+        DXGI_FORMAT format;
+        UINT width;
+        UINT height;
+        size_t rowPitch;
+        std::unique_ptr<uint8_t[]> pixels;
+    };
+
+    // One staging texture in the readback ring.
+    struct Slot
+    {
+        ComPtr<ID3D11Texture2D> staging;
+        D3D11_TEXTURE2D_DESC desc;
+        uint64_t frame;
+        uint64_t fence;
+        bool pending;
+        Target target;
+    };
+
+    HRESULT Capture(_In_ ID3D11DeviceContext* pContext, _In_ ID3D11Resource* pSource, Target&& target);
+    HRESULT Encode(DXGI_FORMAT format, UINT width, UINT height, _In_ const void* pixels, size_t rowPitch, Target&& target);
+    void Update(_In_ ID3D11DeviceContext* pContext);
+    HRESULT Flush(_In_opt_ ID3D11DeviceContext* pContext);
+
+    // Sequence recording.
+    bool mRecording;
+    std::wstring mSequencePrefix;
+    bool mSequenceDDS;
+    GUID mSequenceContainer;
+    uint32_t mSequenceFrame;
+
+private:
+    static HRESULT CreateEncodeJob(DXGI_FORMAT format, UINT width, UINT height, _In_ const void* pixels, size_t srcRowPitch, std::unique_ptr<EncodeJob>& job);
+
+    HRESULT ReadBack(_In_ ID3D11DeviceContext* pContext, Slot& slot, bool wait);
+    void Submit(std::unique_ptr<EncodeJob> job);
+    void ReportFailure(HRESULT hr);
+    void EncodeThread();
+
+    // Readback ring, filled on the calling thread.
+    size_t mFrameLatency;
+    uint64_t mFrameCount;
+    std::vector<Slot> mSlots;
+    ComPtr<ID3D11Device> mDevice;
+    ComPtr<ID3D11Texture2D> mResolveTexture;
+
+    // Encoder pool. Producers wait on mIdleSignal when mMaxQueuedJobs images are already waiting,
+    // which keeps memory bounded if a long sequence outpaces the encoders.
+    size_t mWorkerCount;
+    size_t mMaxQueuedJobs;
+    std::vector<std::thread> mWorkers;
+    std::deque<std::unique_ptr<EncodeJob>> mJobs;
+    size_t mActiveJobs;
+    HRESULT mFirstFailure;
+    std::mutex mJobMutex;
+    std::condition_variable mJobSignal;
+    std::condition_variable mIdleSignal;
+    bool mShutdown;
+};
+
+
+ScreenGrabQueue::Impl::Impl(size_t frameLatency, size_t workerCount)
+  : mRecording(false),
+    mSequenceDDS(true),
+    mSequenceContainer{},
+    mSequenceFrame(0),
+    mFrameLatency(frameLatency),
+    mFrameCount(0),
+    mWorkerCount(workerCount),
+    mActiveJobs(0),
+    mFirstFailure(S_OK),
+    mShutdown(false)
+{
+    if (!mWorkerCount)
+    {
+        mWorkerCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 4);
+    }
+
+    mMaxQueuedJobs = mWorkerCount * 2;
+
+    // A copy made this frame is read back frameLatency frames later, so that many slots plus
+    // one are in flight while recording; the extra slot leaves room for a screenshot.
+    mSlots.resize(frameLatency + 2);
+
+    for (auto& slot : mSlots)
+    {
+        slot.desc = {};
+        slot.frame = 0;
+        slot.fence = 0;
+        slot.pending = false;
+    }
+}
+
+
+ScreenGrabQueue::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> lock(mJobMutex);
+        mShutdown = true;
+    }
+
+    // Workers finish the queued images before exiting
+    mJobSignal.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::Impl::Capture(ID3D11DeviceContext* pContext, ID3D11Resource* pSource, Target&& target)
+{
+    if (!pContext || !pSource)
+        return E_INVALIDARG;
+
+    D3D11_RESOURCE_DIMENSION resType = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+    pSource->GetType(&resType);
+
+    if (resType != D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    ComPtr<ID3D11Texture2D> pTexture;
+    HRESULT hr = pSource->QueryInterface(IID_GRAPHICS_PPV_ARGS(pTexture.GetAddressOf()));
+    if (FAILED(hr))
+        return hr;
+
+    D3D11_TEXTURE2D_DESC desc;
+    pTexture->GetDesc(&desc);
+
+    ComPtr<ID3D11Device> d3dDevice;
+    pContext->GetDevice(d3dDevice.GetAddressOf());
+
+    if (mDevice != d3dDevice)
+    {
+        // Staging textures belong to one device, so copies made on the previous one are dropped
+        for (auto& slot : mSlots)
+        {
+            slot.staging.Reset();
+            slot.pending = false;
+        }
+
+        mResolveTexture.Reset();
+        mDevice = d3dDevice;
+    }
+
+    ID3D11Resource* copySource = pSource;
+
+    if (desc.SampleDesc.Count > 1)
+    {
+        // MSAA content is resolved into a texture that is kept for the next capture
+        DXGI_FORMAT fmt = EnsureNotTypeless(desc.Format);
+
+        D3D11_TEXTURE2D_DESC resolveDesc = {};
+        if (mResolveTexture)
+        {
+            mResolveTexture->GetDesc(&resolveDesc);
+        }
+
+        if (!mResolveTexture || resolveDesc.Width != desc.Width || resolveDesc.Height != desc.Height || resolveDesc.Format != desc.Format)
+        {
+            UINT support = 0;
+            hr = d3dDevice->CheckFormatSupport(fmt, &support);
+            if (FAILED(hr))
+                return hr;
+
+            if (!(support & D3D11_FORMAT_SUPPORT_MULTISAMPLE_RESOLVE))
+                return E_FAIL;
+
+            CD3D11_TEXTURE2D_DESC tempDesc(desc.Format, desc.Width, desc.Height, 1, 1, 0, D3D11_USAGE_DEFAULT);
+
+            hr = d3dDevice->CreateTexture2D(&tempDesc, nullptr, mResolveTexture.ReleaseAndGetAddressOf());
+            if (FAILED(hr))
+                return hr;
+
+            SetDebugObjectName(mResolveTexture.Get(), "ScreenGrabQueue:Resolve");
+        }
+
+        pContext->ResolveSubresource(mResolveTexture.Get(), 0, pSource, 0, fmt);
+
+        copySource = mResolveTexture.Get();
+    }
+
+    Slot* slot = nullptr;
+    for (auto& candidate : mSlots)
+    {
+        if (!candidate.pending)
+        {
+            slot = &candidate;
+            break;
+        }
+    }
+
+    if (!slot)
+    {
+        // Every slot is still in flight, so wait for the oldest copy
+        slot = &*std::min_element(mSlots.begin(), mSlots.end(), [](Slot const& a, Slot const& b)
+        {
+            return a.frame < b.frame;
+        });
+
+        hr = ReadBack(pContext, *slot, true);
+        if (FAILED(hr))
+            ReportFailure(hr);
+    }
+
+    if (!slot->staging || slot->desc.Width != desc.Width || slot->desc.Height != desc.Height || slot->desc.Format != desc.Format)
+    {
+        CD3D11_TEXTURE2D_DESC stagingDesc(desc.Format, desc.Width, desc.Height, 1, 1, 0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ);
+
+        hr = d3dDevice->CreateTexture2D(&stagingDesc, nullptr, slot->staging.ReleaseAndGetAddressOf());
+        if (FAILED(hr))
+            return hr;
+
+        slot->desc = stagingDesc;
+
+        SetDebugObjectName(slot->staging.Get(), "ScreenGrabQueue:Staging");
+    }
+
+    pContext->CopySubresourceRegion(slot->staging.Get(), 0, 0, 0, 0, copySource, 0, nullptr);
+
+    slot->fence = 0;
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+
+    if (d3dDevice->GetCreationFlags() & D3D11_CREATE_DEVICE_IMMEDIATE_CONTEXT_FAST_SEMANTICS)
+    {
+        ComPtr<ID3D11DeviceContextX> d3dContextX;
+        hr = pContext->QueryInterface(IID_GRAPHICS_PPV_ARGS(d3dContextX.GetAddressOf()));
+        if (FAILED(hr))
+            return hr;
+
+        slot->fence = d3dContextX->InsertFence(0);
+    }
+
+#endif
+
+    slot->frame = mFrameCount;
+    slot->pending = true;
+    slot->target = std::move(target);
+
+    return S_OK;
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::Impl::Encode(DXGI_FORMAT format, UINT width, UINT height, const void* pixels, size_t rowPitch, Target&& target)
+{
+    if (!pixels)
+        return E_INVALIDARG;
+
+    std::unique_ptr<EncodeJob> job;
+    HRESULT hr = CreateEncodeJob(format, width, height, pixels, rowPitch, job);
+    if (FAILED(hr))
+        return hr;
+
+    job->target = std::move(target);
+
+    Submit(std::move(job));
+
+    return S_OK;
+}
+
+
+_Use_decl_annotations_
+void ScreenGrabQueue::Impl::Update(ID3D11DeviceContext* pContext)
+{
+    ++mFrameCount;
+
+    for (auto& slot : mSlots)
+    {
+        if (!slot.pending || mFrameCount - slot.frame < mFrameLatency)
+            continue;
+
+        // Copies the GPU hasn't reached yet are tried again next frame
+        HRESULT hr = ReadBack(pContext, slot, false);
+        if (FAILED(hr) && hr != DXGI_ERROR_WAS_STILL_DRAWING)
+        {
+            ReportFailure(hr);
+        }
+    }
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::Impl::Flush(ID3D11DeviceContext* pContext)
+{
+    if (pContext)
+    {
+        // Oldest first, so sequence frames reach the encoders in order
+        for (;;)
+        {
+            Slot* oldest = nullptr;
+            for (auto& slot : mSlots)
+            {
+                if (slot.pending && (!oldest || slot.frame < oldest->frame))
+                    oldest = &slot;
+            }
+
+            if (!oldest)
+                break;
+
+            HRESULT hr = ReadBack(pContext, *oldest, true);
+            if (FAILED(hr))
+                ReportFailure(hr);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mJobMutex);
+    mIdleSignal.wait(lock, [this]() { return mJobs.empty() && !mActiveJobs; });
+
+    HRESULT hr = mFirstFailure;
+    mFirstFailure = S_OK;
+    return hr;
+}
+
+
+// Copies an image into a job, dropping any row padding.
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::Impl::CreateEncodeJob(DXGI_FORMAT format, UINT width, UINT height, const void* pixels, size_t srcRowPitch, std::unique_ptr<EncodeJob>& job)
+{
+    if (!width || !height || !BitsPerPixel(format))
+        return E_INVALIDARG;
+
+    size_t rowPitch, slicePitch, rowCount;
+    GetSurfaceInfo(width, height, format, &slicePitch, &rowPitch, &rowCount);
+
+    if (srcRowPitch < rowPitch)
+        return E_INVALIDARG;
+
+    job.reset(new (std::nothrow) EncodeJob);
+    if (!job)
+        return E_OUTOFMEMORY;
+
+    job->pixels.reset(new (std::nothrow) uint8_t[slicePitch]);
+    if (!job->pixels)
+        return E_OUTOFMEMORY;
+
+    job->format = format;
+    job->width = width;
+    job->height = height;
+    job->rowPitch = rowPitch;
+
+    auto sptr = reinterpret_cast<const uint8_t*>(pixels);
+    uint8_t* dptr = job->pixels.get();
+
+    for (size_t h = 0; h < rowCount; ++h)
+    {
+        memcpy_s(dptr, rowPitch, sptr, rowPitch);
+        sptr += srcRowPitch;
+        dptr += rowPitch;
+    }
 
     return S_OK;
 }
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::Impl::ReadBack(ID3D11DeviceContext* pContext, Slot& slot, bool wait)
+{
+#if defined(_XBOX_ONE) && defined(_TITLE)
+
+    // Map doesn't wait for the copy with fast semantics, so check its fence instead
+    if (slot.fence)
+    {
+        ComPtr<ID3D11DeviceX> d3dDeviceX;
+        HRESULT hrFence = mDevice.As(&d3dDeviceX);
+        if (FAILED(hrFence))
+        {
+            slot.pending = false;
+            return hrFence;
+        }
+
+        while (d3dDeviceX->IsFencePending(slot.fence))
+        {
+            if (!wait)
+                return DXGI_ERROR_WAS_STILL_DRAWING;
+
+            SwitchToThread();
+        }
+    }
+
+#endif
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    HRESULT hr = pContext->Map(slot.staging.Get(), 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+    if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+        return hr;
+
+    slot.pending = false;
+
+    if (FAILED(hr))
+        return hr;
+
+    if (!mapped.pData)
+    {
+        pContext->Unmap(slot.staging.Get(), 0);
+        return E_POINTER;
+    }
+
+    std::unique_ptr<EncodeJob> job;
+    hr = CreateEncodeJob(slot.desc.Format, slot.desc.Width, slot.desc.Height, mapped.pData, mapped.RowPitch, job);
+
+    pContext->Unmap(slot.staging.Get(), 0);
+
+    if (FAILED(hr))
+        return hr;
+
+    job->target = std::move(slot.target);
+
+    Submit(std::move(job));
+
+    return S_OK;
+}
+
+
+void ScreenGrabQueue::Impl::Submit(std::unique_ptr<EncodeJob> job)
+{
+    std::unique_lock<std::mutex> lock(mJobMutex);
+
+    if (mWorkers.empty())
+    {
+        for (size_t j = 0; j < mWorkerCount; ++j)
+        {
+            mWorkers.emplace_back(&Impl::EncodeThread, this);
+        }
+    }
+
+    mIdleSignal.wait(lock, [this]() { return mJobs.size() < mMaxQueuedJobs; });
+
+    mJobs.push_back(std::move(job));
+
+    mJobSignal.notify_one();
+}
+
+
+void ScreenGrabQueue::Impl::ReportFailure(HRESULT hr)
+{
+    std::lock_guard<std::mutex> lock(mJobMutex);
+
+    if (SUCCEEDED(mFirstFailure))
+        mFirstFailure = hr;
+}
+
+
+void ScreenGrabQueue::Impl::EncodeThread()
+{
+    // WIC streams and encoders are created on this thread
+    HRESULT hrCOM = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+    for (;;)
+    {
+        std::unique_ptr<EncodeJob> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mJobMutex);
+            mJobSignal.wait(lock, [this]() { return mShutdown || !mJobs.empty(); });
+
+            if (mJobs.empty())
+                break;
+
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+            ++mActiveJobs;
+        }
+
+        mIdleSignal.notify_all();
+
+        auto& target = job->target;
+
+        HRESULT hr = target.dds
+            ? WriteDDSImage(target.fileName.c_str(), job->format, job->width, job->height, job->pixels.get(), job->rowPitch)
+            : WriteWICImage(target.fileName.c_str(), target.container, nullptr, nullptr, job->format, job->width, job->height, job->pixels.get(), job->rowPitch);
+
+        if (FAILED(hr))
+        {
+            DebugTrace("ScreenGrabQueue failed to write %ls (%08X)\n", target.fileName.c_str(), static_cast<unsigned int>(hr));
+        }
+
+        job.reset();
+
+        {
+            std::lock_guard<std::mutex> lock(mJobMutex);
+            --mActiveJobs;
+
+            if (FAILED(hr) && SUCCEEDED(mFirstFailure))
+                mFirstFailure = hr;
+        }
+
+        mIdleSignal.notify_all();
+    }
+
+    if (SUCCEEDED(hrCOM))
+    {
+        CoUninitialize();
+    }
+}
+
+
+// Public constructor.
+ScreenGrabQueue::ScreenGrabQueue(size_t frameLatency, size_t workerCount)
+  : pImpl(new Impl(frameLatency, workerCount))
+{
+}
+
+
+// Move constructor.
+ScreenGrabQueue::ScreenGrabQueue(ScreenGrabQueue&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+ScreenGrabQueue& ScreenGrabQueue::operator= (ScreenGrabQueue&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+ScreenGrabQueue::~ScreenGrabQueue()
+{
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::CaptureDDS(ID3D11DeviceContext* pContext, ID3D11Resource* pSource, const wchar_t* fileName)
+{
+    if (!fileName)
+        return E_INVALIDARG;
+
+    Impl::Target target = { fileName, true, {} };
+
+    return pImpl->Capture(pContext, pSource, std::move(target));
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::CaptureWIC(ID3D11DeviceContext* pContext, ID3D11Resource* pSource, REFGUID guidContainerFormat, const wchar_t* fileName)
+{
+    if (!fileName)
+        return E_INVALIDARG;
+
+    Impl::Target target = { fileName, false, guidContainerFormat };
+
+    return pImpl->Capture(pContext, pSource, std::move(target));
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::EncodeDDS(DXGI_FORMAT format, UINT width, UINT height, const void* pixels, size_t rowPitch, const wchar_t* fileName)
+{
+    if (!fileName)
+        return E_INVALIDARG;
+
+    Impl::Target target = { fileName, true, {} };
+
+    return pImpl->Encode(format, width, height, pixels, rowPitch, std::move(target));
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::EncodeWIC(DXGI_FORMAT format, UINT width, UINT height, const void* pixels, size_t rowPitch, REFGUID guidContainerFormat, const wchar_t* fileName)
+{
+    if (!fileName)
+        return E_INVALIDARG;
+
+    Impl::Target target = { fileName, false, guidContainerFormat };
+
+    return pImpl->Encode(format, width, height, pixels, rowPitch, std::move(target));
+}
+
+
+_Use_decl_annotations_
+void ScreenGrabQueue::BeginSequence(const wchar_t* filePrefix, const GUID* guidContainerFormat)
+{
+    if (!filePrefix)
+        throw std::exception("BeginSequence");
+
+    pImpl->mRecording = true;
+    pImpl->mSequencePrefix = filePrefix;
+    pImpl->mSequenceDDS = (guidContainerFormat == nullptr);
+    pImpl->mSequenceContainer = guidContainerFormat ? *guidContainerFormat : GUID{};
+    pImpl->mSequenceFrame = 0;
+}
+
+
+void ScreenGrabQueue::EndSequence()
+{
+    pImpl->mRecording = false;
+}
+
+
+bool ScreenGrabQueue::IsRecording() const
+{
+    return pImpl->mRecording;
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::CaptureFrame(ID3D11DeviceContext* pContext, ID3D11Resource* pSource)
+{
+    if (!pImpl->mRecording)
+        return S_FALSE;
+
+    wchar_t number[16] = {};
+    swprintf_s(number, L"%05u", pImpl->mSequenceFrame);
+
+    Impl::Target target;
+    target.fileName = pImpl->mSequencePrefix + number + (pImpl->mSequenceDDS ? L".dds" : GetContainerExtension(pImpl->mSequenceContainer));
+    target.dds = pImpl->mSequenceDDS;
+    target.container = pImpl->mSequenceContainer;
+
+    HRESULT hr = pImpl->Capture(pContext, pSource, std::move(target));
+    if (SUCCEEDED(hr))
+    {
+        ++pImpl->mSequenceFrame;
+    }
+
+    return hr;
+}
+
+
+_Use_decl_annotations_
+void ScreenGrabQueue::Update(ID3D11DeviceContext* pContext)
+{
+    pImpl->Update(pContext);
+}
+
+
+_Use_decl_annotations_
+HRESULT ScreenGrabQueue::Flush(ID3D11DeviceContext* pContext)
+{
+    return pImpl->Flush(pContext);
+}
@@ -147,7 +147,9 @@ call :CompileShader%1 NormalMapEffect ps PSNormalPixelLightingTxNoSpec
 call :CompileShader%1 NormalMapEffect ps PSNormalPixelLightingTxNoFogSpec
 
 call :CompileShader%1 SpriteEffect vs SpriteVertexShader
+call :CompileShader%1 SpriteEffect vs SpriteVertexShaderTinted
 call :CompileShader%1 SpriteEffect ps SpritePixelShader
+call :CompileShaderLevel93%1 SpriteEffect ps SpritePixelShaderDistanceField
 
 call :CompileShader%1 DGSLEffect vs main
 call :CompileShader%1 DGSLEffect vs mainVc
@@ -191,6 +193,13 @@ echo %fxc%
 %fxc% || set error=1
 exit /b
 
+:CompileShaderLevel93
+set fxc=fxc /nologo %1.fx /T%2_4_0_level_9_3 /Zi /Zpc /Qstrip_reflect /Qstrip_debug /E%3 /FhCompiled\%1_%3.inc /FdCompiled\%1_%3.pdb /Vn%1_%3
+echo.
+echo %fxc%
+%fxc% || set error=1
+exit /b
+
 :CompileShaderHLSL
 set fxc=fxc /nologo %1.hlsl /T%2_4_0_level_9_1 /Zi /Zpc /Qstrip_reflect /Qstrip_debug /E%3 /FhCompiled\%1_%3.inc /FdCompiled\%1_%3.pdb /Vn%1_%3
 echo.
@@ -205,6 +214,13 @@ echo %fxc%
 %fxc% || set error=1
 exit /b
 
+:CompileShaderLevel93xbox
+set fxc=%XBOXFXC% /nologo %1.fx /T%2_5_0 /Zpc /Zi /Qstrip_reflect /Qstrip_debug /D__XBOX_DISABLE_SHADER_NAME_EMPLACEMENT /E%3 /FhCompiled\XboxOne%1_%3.inc /FdCompiled\XboxOne%1_%3.pdb /Vn%1_%3
+echo.
+echo %fxc%
+%fxc% || set error=1
+exit /b
+
 :CompileShaderHLSLxbox
 set fxc=%XBOXFXC% /nologo %1.hlsl /T%2_5_0 /Zpc /Zi /Qstrip_reflect /Qstrip_debug /D__XBOX_DISABLE_SHADER_NAME_EMPLACEMENT /E%3 /FhCompiled\XboxOne%1_%3.inc /FdCompiled\XboxOne%1_%3.pdb /Vn%1_%3
 echo.
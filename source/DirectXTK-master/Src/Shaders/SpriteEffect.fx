@@ -27,8 +27,38 @@ void SpriteVertexShader(inout float4 color    : COLOR0,
 }
 
 
+// SpriteBatch layers keep their vertices on the GPU, so a layer's tint is applied here instead of being
+// multiplied into the vertex colors.
+cbuffer LayerParameters : register(b1)
+{
+    float4 LayerTint;
+};
+
+
+void SpriteVertexShaderTinted(inout float4 color    : COLOR0,
+                              inout float2 texCoord : TEXCOORD0,
+                              inout float4 position : SV_Position)
+{
+    color *= LayerTint;
+    position = mul(position, MatrixTransform);
+}
+
+
 float4 SpritePixelShader(float4 color    : COLOR0,
                          float2 texCoord : TEXCOORD0) : SV_Target0
 {
     return Texture.Sample(TextureSampler, texCoord) * color;
 }
+
+
+// Distance field glyphs store the distance to the glyph edge in alpha, with the edge at 0.5. Scaling the
+// distance by its screen-space rate of change keeps the antialiased edge one pixel wide at any size.
+float4 SpritePixelShaderDistanceField(float4 color    : COLOR0,
+                                      float2 texCoord : TEXCOORD0) : SV_Target0
+{
+    float distance = Texture.Sample(TextureSampler, texCoord).a;
+
+    float coverage = saturate((distance - 0.5) / max(fwidth(distance), 1e-5) + 0.5);
+
+    return color * coverage;
+}
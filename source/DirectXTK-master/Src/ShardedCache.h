@@ -0,0 +1,189 @@
+//--------------------------------------------------------------------------------------
+// File: ShardedCache.h
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+
+namespace DirectX
+{
+    // Name-keyed cache split into independently locked shards, so that threads loading
+    // different assets rarely wait on each other. Keys are hashed once per call and the
+    // names are interned in the owning shard, so lookups never allocate and only compare
+    // strings whose hashes already match.
+    template<typename TData>
+    class ShardedCache
+    {
+    public:
+        static const size_t ShardCount = 16;
+
+        struct Statistics
+        {
+            size_t hits;
+            size_t misses;
+            size_t contentions;
+        };
+
+        ShardedCache()
+          : mHits(0),
+            mMisses(0),
+            mContentions(0)
+        { }
+
+        ShardedCache(ShardedCache const&) = delete;
+        ShardedCache& operator= (ShardedCache const&) = delete;
+
+        // Copies the cached value into result, returning false if the name isn't present.
+        bool Find(_In_z_ const wchar_t* name, TData& result)
+        {
+            Key key(name);
+            auto& shard = mShards[key.hash % ShardCount];
+
+            auto lock = LockShard(shard);
+
+            auto it = shard.map.find(key);
+            if (it == shard.map.end())
+            {
+                ++mMisses;
+                return false;
+            }
+
+            ++mHits;
+            result = it->second;
+            return true;
+        }
+
+        // Adds the value unless another thread got there first, and returns whichever value
+        // ends up cached so that every caller shares the same instance.
+        TData Insert(_In_z_ const wchar_t* name, TData const& value)
+        {
+            Key key(name);
+            auto& shard = mShards[key.hash % ShardCount];
+
+            auto lock = LockShard(shard);
+
+            auto it = shard.map.find(key);
+            if (it != shard.map.end())
+                return it->second;
+
+            shard.names.emplace_back(name);
+            key.name = shard.names.back().c_str();
+
+            shard.map.insert(std::make_pair(key, value));
+            return value;
+        }
+
+        void Clear()
+        {
+            for (size_t j = 0; j < ShardCount; ++j)
+            {
+                auto& shard = mShards[j];
+
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                shard.map.clear();
+                shard.names.clear();
+            }
+        }
+
+        Statistics GetStatistics() const
+        {
+            Statistics stats;
+            stats.hits = mHits;
+            stats.misses = mMisses;
+            stats.contentions = mContentions;
+            return stats;
+        }
+
+        void ResetStatistics()
+        {
+            mHits = 0;
+            mMisses = 0;
+            mContentions = 0;
+        }
+
+    private:
+        struct Key
+        {
+            explicit Key(const wchar_t* str)
+              : name(str),
+                hash(Hash(str))
+            { }
+
+            const wchar_t* name;
+            size_t hash;
+
+            bool operator== (Key const& other) const
+            {
+                return hash == other.hash && wcscmp(name, other.name) == 0;
+            }
+
+            // FNV-1a
+            static size_t Hash(const wchar_t* str)
+            {
+            #if defined(_WIN64)
+                size_t h = 14695981039346656037ULL;
+                const size_t prime = 1099511628211ULL;
+            #else
+                size_t h = 2166136261U;
+                const size_t prime = 16777619U;
+            #endif
+
+                for (; *str; ++str)
+                {
+                    h ^= static_cast<size_t>(*str);
+                    h *= prime;
+                }
+
+                return h;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator() (Key const& key) const
+            {
+                // Spread the bits already used for shard selection.
+                return key.hash / ShardCount;
+            }
+        };
+
+        struct Shard
+        {
+            std::mutex mutex;
+            std::unordered_map<Key, TData, KeyHash> map;
+            std::deque<std::wstring> names;     // Interned keys; deque elements never move.
+        };
+
+        std::unique_lock<std::mutex> LockShard(Shard& shard)
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex, std::try_to_lock);
+            if (!lock.owns_lock())
+            {
+                ++mContentions;
+                lock.lock();
+            }
+            return lock;
+        }
+
+        Shard mShards[ShardCount];
+
+        std::atomic<size_t> mHits;
+        std::atomic<size_t> mMisses;
+        std::atomic<size_t> mContentions;
+    };
+}
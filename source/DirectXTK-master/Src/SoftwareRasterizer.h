@@ -0,0 +1,1673 @@
+//--------------------------------------------------------------------------------------
+// File: SoftwareRasterizer.h
+//
+// Tile-based software rasterizer implementing the subset of Direct3D 11 used by
+// BasicEffect, SpriteBatch and GeometricPrimitive, so regression scenes can be rendered
+// without a GPU (see RasterTool). Vertices are read through the same input element
+// descriptions as VertexTypes.h, shading follows BasicEffect.fx, and triangles are
+// binned into tiles that Flush rasterizes on several threads. Each tile draws its
+// triangles in submission order, so the output doesn't depend on the thread count.
+//
+// Like BlockCompression.h, this header only depends on the C++ standard library.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "MipGenerator.h"
+
+
+namespace DirectX
+{
+    namespace SoftwareRendering
+    {
+        struct Vector2
+        {
+            float x, y;
+        };
+
+        struct Vector3
+        {
+            float x, y, z;
+        };
+
+        struct Vector4
+        {
+            float x, y, z, w;
+        };
+
+        namespace Internal
+        {
+            inline Vector3 operator+ (const Vector3& a, const Vector3& b) { return Vector3{ a.x + b.x, a.y + b.y, a.z + b.z }; }
+            inline Vector3 operator- (const Vector3& a, const Vector3& b) { return Vector3{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+            inline Vector3 operator* (const Vector3& a, const Vector3& b) { return Vector3{ a.x * b.x, a.y * b.y, a.z * b.z }; }
+            inline Vector3 operator* (const Vector3& a, float s) { return Vector3{ a.x * s, a.y * s, a.z * s }; }
+
+            inline float Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+            inline Vector3 Cross(const Vector3& a, const Vector3& b)
+            {
+                return Vector3{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+            }
+
+            inline Vector3 Normalize(const Vector3& v)
+            {
+                float length = sqrtf(Dot(v, v));
+                return (length > 0.f) ? v * (1.f / length) : v;
+            }
+
+            inline float Saturate(float v) { return std::min(1.f, std::max(0.f, v)); }
+        }
+
+
+        //----------------------------------------------------------------------------------
+        // Row-major matrix for row vectors, laid out like XMMATRIX and SimpleMath::Matrix.
+        struct Matrix
+        {
+            float m[4][4];
+
+            static Matrix Identity()
+            {
+                return Scale(1.f, 1.f, 1.f);
+            }
+
+            static Matrix Scale(float x, float y, float z)
+            {
+                Matrix r = {};
+                r.m[0][0] = x;
+                r.m[1][1] = y;
+                r.m[2][2] = z;
+                r.m[3][3] = 1.f;
+                return r;
+            }
+
+            static Matrix Translation(float x, float y, float z)
+            {
+                Matrix r = Identity();
+                r.m[3][0] = x;
+                r.m[3][1] = y;
+                r.m[3][2] = z;
+                return r;
+            }
+
+            static Matrix RotationX(float radians)
+            {
+                float s = sinf(radians), c = cosf(radians);
+                Matrix r = Identity();
+                r.m[1][1] = c;  r.m[1][2] = s;
+                r.m[2][1] = -s; r.m[2][2] = c;
+                return r;
+            }
+
+            static Matrix RotationY(float radians)
+            {
+                float s = sinf(radians), c = cosf(radians);
+                Matrix r = Identity();
+                r.m[0][0] = c; r.m[0][2] = -s;
+                r.m[2][0] = s; r.m[2][2] = c;
+                return r;
+            }
+
+            static Matrix RotationZ(float radians)
+            {
+                float s = sinf(radians), c = cosf(radians);
+                Matrix r = Identity();
+                r.m[0][0] = c;  r.m[0][1] = s;
+                r.m[1][0] = -s; r.m[1][1] = c;
+                return r;
+            }
+
+            // Right-handed, like XMMatrixPerspectiveFovRH.
+            static Matrix PerspectiveFieldOfView(float fieldOfView, float aspectRatio, float nearPlane, float farPlane)
+            {
+                float height = 1.f / tanf(fieldOfView * 0.5f);
+                float range = farPlane / (nearPlane - farPlane);
+
+                Matrix r = {};
+                r.m[0][0] = height / aspectRatio;
+                r.m[1][1] = height;
+                r.m[2][2] = range;
+                r.m[2][3] = -1.f;
+                r.m[3][2] = range * nearPlane;
+                return r;
+            }
+
+            // Right-handed, like XMMatrixLookAtRH.
+            static Matrix LookAt(const Vector3& eye, const Vector3& target, const Vector3& up)
+            {
+                using namespace Internal;
+
+                Vector3 zaxis = Normalize(eye - target);
+                Vector3 xaxis = Normalize(Cross(up, zaxis));
+                Vector3 yaxis = Cross(zaxis, xaxis);
+
+                Matrix r = Identity();
+                r.m[0][0] = xaxis.x; r.m[0][1] = yaxis.x; r.m[0][2] = zaxis.x;
+                r.m[1][0] = xaxis.y; r.m[1][1] = yaxis.y; r.m[1][2] = zaxis.y;
+                r.m[2][0] = xaxis.z; r.m[2][1] = yaxis.z; r.m[2][2] = zaxis.z;
+                r.m[3][0] = -Dot(xaxis, eye);
+                r.m[3][1] = -Dot(yaxis, eye);
+                r.m[3][2] = -Dot(zaxis, eye);
+                return r;
+            }
+
+            Matrix operator* (const Matrix& b) const
+            {
+                Matrix r;
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    for (size_t j = 0; j < 4; ++j)
+                        r.m[i][j] = m[i][0] * b.m[0][j] + m[i][1] * b.m[1][j] + m[i][2] * b.m[2][j] + m[i][3] * b.m[3][j];
+                }
+                return r;
+            }
+
+            Vector4 Transform(const Vector4& v) const
+            {
+                return Vector4
+                {
+                    v.x * m[0][0] + v.y * m[1][0] + v.z * m[2][0] + v.w * m[3][0],
+                    v.x * m[0][1] + v.y * m[1][1] + v.z * m[2][1] + v.w * m[3][1],
+                    v.x * m[0][2] + v.y * m[1][2] + v.z * m[2][2] + v.w * m[3][2],
+                    v.x * m[0][3] + v.y * m[1][3] + v.z * m[2][3] + v.w * m[3][3],
+                };
+            }
+
+            // Gauss-Jordan elimination with partial pivoting; singular matrices give zero.
+            Matrix Invert() const
+            {
+                double a[4][8];
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    for (size_t j = 0; j < 4; ++j)
+                    {
+                        a[i][j] = m[i][j];
+                        a[i][j + 4] = (i == j) ? 1.0 : 0.0;
+                    }
+                }
+
+                for (size_t col = 0; col < 4; ++col)
+                {
+                    size_t pivot = col;
+                    for (size_t row = col + 1; row < 4; ++row)
+                    {
+                        if (fabs(a[row][col]) > fabs(a[pivot][col]))
+                            pivot = row;
+                    }
+
+                    if (a[pivot][col] == 0.0)
+                        return Matrix{};
+
+                    if (pivot != col)
+                    {
+                        for (size_t j = 0; j < 8; ++j)
+                            std::swap(a[pivot][j], a[col][j]);
+                    }
+
+                    double scale = 1.0 / a[col][col];
+                    for (size_t j = 0; j < 8; ++j)
+                        a[col][j] *= scale;
+
+                    for (size_t row = 0; row < 4; ++row)
+                    {
+                        if (row == col || a[row][col] == 0.0)
+                            continue;
+
+                        double factor = a[row][col];
+                        for (size_t j = 0; j < 8; ++j)
+                            a[row][j] -= factor * a[col][j];
+                    }
+                }
+
+                Matrix r;
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    for (size_t j = 0; j < 4; ++j)
+                        r.m[i][j] = float(a[i][j + 4]);
+                }
+                return r;
+            }
+        };
+
+
+        //----------------------------------------------------------------------------------
+        // Fixed-function state, matching the objects of the same names in CommonStates.
+        enum BlendState
+        {
+            BLEND_OPAQUE = 0,
+            BLEND_ALPHA,                // Premultiplied alpha
+            BLEND_ADDITIVE,
+            BLEND_NONPREMULTIPLIED,
+        };
+
+        enum DepthState
+        {
+            DEPTH_NONE = 0,
+            DEPTH_DEFAULT,              // LESS_EQUAL test and write
+            DEPTH_READ,                 // LESS_EQUAL test only
+        };
+
+        enum CullMode
+        {
+            CULL_NONE = 0,
+            CULL_CLOCKWISE,
+            CULL_COUNTERCLOCKWISE,
+        };
+
+        enum SamplerState
+        {
+            SAMPLER_POINT_WRAP = 0,
+            SAMPLER_POINT_CLAMP,
+            SAMPLER_LINEAR_WRAP,        // Trilinear
+            SAMPLER_LINEAR_CLAMP,
+        };
+
+
+        //----------------------------------------------------------------------------------
+        // 8-bit RGBA texture with its mip chain.
+        class Texture
+        {
+        public:
+            // Builds levels mips (0 for a full chain) from the image with the MipGenerator.
+            Texture(const uint8_t* rgba, size_t width, size_t height, size_t rowPitch, size_t levels = 0, unsigned mipFlags = MipGeneration::MIP_DEFAULT)
+            {
+                if (!rgba || !width || !height)
+                    throw std::invalid_argument("Texture needs an image");
+
+                MipGeneration::GenerateMipChain(rgba, width, height, rowPitch, levels, mipFlags, mLevels);
+            }
+
+            // Takes an existing chain, such as the levels read from a DDS file.
+            explicit Texture(std::vector<MipGeneration::MipLevel>&& levels)
+              : mLevels(std::move(levels))
+            {
+                if (mLevels.empty() || !mLevels[0].width || !mLevels[0].height)
+                    throw std::invalid_argument("Texture needs at least one level");
+            }
+
+            size_t Width() const { return mLevels[0].width; }
+            size_t Height() const { return mLevels[0].height; }
+            size_t LevelCount() const { return mLevels.size(); }
+            const MipGeneration::MipLevel& Level(size_t level) const { return mLevels[level]; }
+
+            // lod is log2 of the texel footprint on the top level, as computed by the rasterizer.
+            Vector4 Sample(SamplerState sampler, float u, float v, float lod) const
+            {
+                bool wrap = (sampler == SAMPLER_POINT_WRAP || sampler == SAMPLER_LINEAR_WRAP);
+                float maxLevel = float(mLevels.size() - 1);
+
+                if (sampler == SAMPLER_POINT_WRAP || sampler == SAMPLER_POINT_CLAMP)
+                {
+                    auto& level = mLevels[size_t(std::min(maxLevel, std::max(0.f, floorf(lod + 0.5f))))];
+                    return Fetch(level, int(floorf(u * float(level.width))), int(floorf(v * float(level.height))), wrap);
+                }
+
+                lod = std::min(maxLevel, std::max(0.f, lod));
+                size_t first = size_t(lod);
+                float blend = lod - float(first);
+
+                Vector4 color = Bilinear(mLevels[first], u, v, wrap);
+                if (blend > 0.f && first + 1 < mLevels.size())
+                {
+                    Vector4 next = Bilinear(mLevels[first + 1], u, v, wrap);
+                    color.x += (next.x - color.x) * blend;
+                    color.y += (next.y - color.y) * blend;
+                    color.z += (next.z - color.z) * blend;
+                    color.w += (next.w - color.w) * blend;
+                }
+                return color;
+            }
+
+        private:
+            static int Address(int coord, size_t size, bool wrap)
+            {
+                int n = int(size);
+                if (wrap)
+                {
+                    coord %= n;
+                    return (coord < 0) ? coord + n : coord;
+                }
+                return std::min(n - 1, std::max(0, coord));
+            }
+
+            static Vector4 Load(const MipGeneration::MipLevel& level, int x, int y)
+            {
+                const uint8_t* texel = &level.pixels[(size_t(y) * level.width + size_t(x)) * 4];
+                const float scale = 1.f / 255.f;
+                return Vector4{ texel[0] * scale, texel[1] * scale, texel[2] * scale, texel[3] * scale };
+            }
+
+            static Vector4 Fetch(const MipGeneration::MipLevel& level, int x, int y, bool wrap)
+            {
+                return Load(level, Address(x, level.width, wrap), Address(y, level.height, wrap));
+            }
+
+            static Vector4 Bilinear(const MipGeneration::MipLevel& level, float u, float v, bool wrap)
+            {
+                float x = u * float(level.width) - 0.5f;
+                float y = v * float(level.height) - 0.5f;
+                float fx = floorf(x), fy = floorf(y);
+                float ax = x - fx, ay = y - fy;
+                int x0 = Address(int(fx), level.width, wrap), x1 = Address(int(fx) + 1, level.width, wrap);
+                int y0 = Address(int(fy), level.height, wrap), y1 = Address(int(fy) + 1, level.height, wrap);
+
+                Vector4 c00 = Load(level, x0, y0);
+                Vector4 c10 = Load(level, x1, y0);
+                Vector4 c01 = Load(level, x0, y1);
+                Vector4 c11 = Load(level, x1, y1);
+
+                float w00 = (1.f - ax) * (1.f - ay), w10 = ax * (1.f - ay), w01 = (1.f - ax) * ay, w11 = ax * ay;
+                return Vector4
+                {
+                    c00.x * w00 + c10.x * w10 + c01.x * w01 + c11.x * w11,
+                    c00.y * w00 + c10.y * w10 + c01.y * w01 + c11.y * w11,
+                    c00.z * w00 + c10.z * w10 + c01.z * w01 + c11.z * w11,
+                    c00.w * w00 + c10.w * w10 + c01.w * w01 + c11.w * w11,
+                };
+            }
+
+            std::vector<MipGeneration::MipLevel> mLevels;
+        };
+
+
+        //----------------------------------------------------------------------------------
+        // Input assembly. Elements have the same members as D3D11_INPUT_ELEMENT_DESC.
+        const uint32_t FORMAT_R32G32B32A32_FLOAT = 2;
+        const uint32_t FORMAT_R32G32B32_FLOAT = 6;
+        const uint32_t FORMAT_R32G32_FLOAT = 16;
+        const uint32_t FORMAT_R8G8B8A8_UNORM = 28;
+        const uint32_t FORMAT_R8G8B8A8_UINT = 30;
+        const uint32_t FORMAT_B8G8R8A8_UNORM = 87;
+
+        const uint32_t APPEND_ALIGNED_ELEMENT = 0xffffffff;
+
+        struct InputElement
+        {
+            const char* SemanticName;
+            uint32_t    SemanticIndex;
+            uint32_t    Format;
+            uint32_t    InputSlot;
+            uint32_t    AlignedByteOffset;
+            uint32_t    InputSlotClass;
+            uint32_t    InstanceDataStepRate;
+        };
+
+        class InputLayout
+        {
+        public:
+            struct Attribute
+            {
+                uint32_t format;        // 0 if the layout doesn't have this semantic
+                uint32_t offset;
+            };
+
+            Attribute position;
+            Attribute normal;
+            Attribute color;
+            Attribute textureCoordinate;
+            size_t    stride;
+
+            // Accepts InputElement or D3D11_INPUT_ELEMENT_DESC arrays. Semantics other than
+            // SV_Position, NORMAL, COLOR and TEXCOORD0 are skipped.
+            template<typename TElement>
+            InputLayout(const TElement* elements, size_t count, size_t vertexStride)
+              : position{}, normal{}, color{}, textureCoordinate{}, stride(vertexStride)
+            {
+                uint32_t offset = 0;
+                for (size_t j = 0; j < count; ++j)
+                {
+                    auto& element = elements[j];
+                    if (element.AlignedByteOffset != APPEND_ALIGNED_ELEMENT)
+                        offset = element.AlignedByteOffset;
+
+                    Attribute attribute = { uint32_t(element.Format), offset };
+                    offset += FormatSize(attribute.format);
+
+                    if (SemanticIs(element.SemanticName, "SV_Position") || SemanticIs(element.SemanticName, "POSITION"))
+                        position = attribute;
+                    else if (SemanticIs(element.SemanticName, "NORMAL"))
+                        normal = attribute;
+                    else if (SemanticIs(element.SemanticName, "COLOR") && !element.SemanticIndex)
+                        color = attribute;
+                    else if (SemanticIs(element.SemanticName, "TEXCOORD") && !element.SemanticIndex)
+                        textureCoordinate = attribute;
+                }
+
+                if (!position.format)
+                    throw std::invalid_argument("Input layout has no position");
+            }
+
+            // Layout of one of the vertex types from VertexTypes.h, e.g. Create<VertexPositionNormalTexture>().
+            template<typename TVertex>
+            static InputLayout Create()
+            {
+                return InputLayout(TVertex::InputElements, TVertex::InputElementCount, sizeof(TVertex));
+            }
+
+            Vector4 Read(const Attribute& attribute, const uint8_t* vertex, float defaultW) const
+            {
+                const uint8_t* data = vertex + attribute.offset;
+                Vector4 r = { 0.f, 0.f, 0.f, defaultW };
+
+                switch (attribute.format)
+                {
+                case FORMAT_R32G32B32A32_FLOAT:
+                    memcpy(&r, data, 16);
+                    break;
+
+                case FORMAT_R32G32B32_FLOAT:
+                    memcpy(&r, data, 12);
+                    break;
+
+                case FORMAT_R32G32_FLOAT:
+                    memcpy(&r, data, 8);
+                    break;
+
+                case FORMAT_R8G8B8A8_UNORM:
+                case FORMAT_B8G8R8A8_UNORM:
+                    {
+                        const float scale = 1.f / 255.f;
+                        bool bgra = attribute.format == FORMAT_B8G8R8A8_UNORM;
+                        r.x = data[bgra ? 2 : 0] * scale;
+                        r.y = data[1] * scale;
+                        r.z = data[bgra ? 0 : 2] * scale;
+                        r.w = data[3] * scale;
+                    }
+                    break;
+
+                default:
+                    throw std::invalid_argument("Unsupported vertex element format");
+                }
+
+                return r;
+            }
+
+        private:
+            static uint32_t FormatSize(uint32_t format)
+            {
+                switch (format)
+                {
+                case FORMAT_R32G32B32A32_FLOAT: return 16;
+                case FORMAT_R32G32B32_FLOAT:    return 12;
+                case FORMAT_R32G32_FLOAT:       return 8;
+                case FORMAT_R8G8B8A8_UNORM:
+                case FORMAT_R8G8B8A8_UINT:
+                case FORMAT_B8G8R8A8_UNORM:     return 4;
+                default:
+                    throw std::invalid_argument("Unsupported vertex element format");
+                }
+            }
+
+            // HLSL semantics are case-insensitive.
+            static bool SemanticIs(const char* name, const char* semantic)
+            {
+                for (; *name && *semantic; ++name, ++semantic)
+                {
+                    if (tolower(static_cast<unsigned char>(*name)) != tolower(static_cast<unsigned char>(*semantic)))
+                        return false;
+                }
+                return !*name && !*semantic;
+            }
+        };
+
+
+        //----------------------------------------------------------------------------------
+        // The parameters of BasicEffect, with the same defaults.
+        struct DirectionalLight
+        {
+            bool    enabled;
+            Vector3 direction;
+            Vector3 diffuseColor;
+            Vector3 specularColor;
+        };
+
+        struct BasicEffectState
+        {
+            static const size_t MaxDirectionalLights = 3;
+
+            Matrix              world;
+            Matrix              view;
+            Matrix              projection;
+
+            Vector3             diffuseColor;
+            Vector3             emissiveColor;
+            Vector3             specularColor;
+            float               specularPower;
+            float               alpha;
+
+            bool                lightingEnabled;
+            bool                perPixelLighting;
+            Vector3             ambientLightColor;
+            DirectionalLight    lights[MaxDirectionalLights];
+
+            bool                vertexColorEnabled;
+            bool                textureEnabled;
+            const Texture*      texture;
+
+            bool                fogEnabled;
+            float               fogStart;
+            float               fogEnd;
+            Vector3             fogColor;
+
+            BasicEffectState()
+              : world(Matrix::Identity()),
+                view(Matrix::Identity()),
+                projection(Matrix::Identity()),
+                diffuseColor{ 1.f, 1.f, 1.f },
+                emissiveColor{},
+                specularColor{ 1.f, 1.f, 1.f },
+                specularPower(16.f),
+                alpha(1.f),
+                lightingEnabled(false),
+                perPixelLighting(false),
+                ambientLightColor{},
+                vertexColorEnabled(false),
+                textureEnabled(false),
+                texture(nullptr),
+                fogEnabled(false),
+                fogStart(0.f),
+                fogEnd(1.f),
+                fogColor{}
+            {
+                for (size_t i = 0; i < MaxDirectionalLights; ++i)
+                {
+                    lights[i].enabled = (i == 0);
+                    lights[i].direction = Vector3{ 0.f, -1.f, 0.f };
+                    lights[i].diffuseColor = Vector3{ 1.f, 1.f, 1.f };
+                    lights[i].specularColor = Vector3{};
+                }
+            }
+
+            // Same three-light rig as EffectLights::EnableDefaultLighting.
+            void EnableDefaultLighting()
+            {
+                static const Vector3 directions[MaxDirectionalLights] =
+                {
+                    { -0.5265408f, -0.5735765f, -0.6275069f },
+                    {  0.7198464f,  0.3420201f,  0.6040227f },
+                    {  0.4545195f, -0.7660444f,  0.4545195f },
+                };
+
+                static const Vector3 diffuse[MaxDirectionalLights] =
+                {
+                    { 1.0000000f, 0.9607844f, 0.8078432f },
+                    { 0.9647059f, 0.7607844f, 0.4078432f },
+                    { 0.3231373f, 0.3607844f, 0.3937255f },
+                };
+
+                static const Vector3 specular[MaxDirectionalLights] =
+                {
+                    { 1.0000000f, 0.9607844f, 0.8078432f },
+                    { 0.0000000f, 0.0000000f, 0.0000000f },
+                    { 0.3231373f, 0.3607844f, 0.3937255f },
+                };
+
+                lightingEnabled = true;
+                ambientLightColor = Vector3{ 0.05333332f, 0.09882354f, 0.1819608f };
+
+                for (size_t i = 0; i < MaxDirectionalLights; ++i)
+                {
+                    lights[i].enabled = true;
+                    lights[i].direction = directions[i];
+                    lights[i].diffuseColor = diffuse[i];
+                    lights[i].specularColor = specular[i];
+                }
+            }
+
+            void DisableSpecular()
+            {
+                specularColor = Vector3{};
+                specularPower = 1.f;
+            }
+        };
+
+
+        //----------------------------------------------------------------------------------
+        struct FrameStatistics
+        {
+            size_t  drawCalls;
+            size_t  triangles;              // Submitted
+            size_t  trianglesRasterized;    // Surviving clipping and culling
+            size_t  pixels;                 // Passing the depth test
+            double  setupMilliseconds;      // Vertex shading, clipping and binning on the calling thread
+            double  rasterMilliseconds;     // Tile rasterization in Flush
+        };
+
+
+        class Rasterizer
+        {
+        public:
+            static const size_t TileSize = 64;
+
+            Rasterizer(size_t width, size_t height, unsigned threadCount = 0)
+              : mWidth(width),
+                mHeight(height),
+                mTilesX((width + TileSize - 1) / TileSize),
+                mTilesY((height + TileSize - 1) / TileSize),
+                mThreadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency())),
+                mBlend(BLEND_OPAQUE),
+                mDepth(DEPTH_DEFAULT),
+                mCull(CULL_COUNTERCLOCKWISE),
+                mSampler(SAMPLER_LINEAR_WRAP),
+                mColor(width * height * 4),
+                mDepthBuffer(width * height, 1.f),
+                mBins(mTilesX * mTilesY),
+                mStats{}
+            {
+                if (!width || !height || width > 16384 || height > 16384)
+                    throw std::invalid_argument("Render target size out of range");
+            }
+
+            Rasterizer(Rasterizer const&) = delete;
+            Rasterizer& operator= (Rasterizer const&) = delete;
+
+            size_t Width() const { return mWidth; }
+            size_t Height() const { return mHeight; }
+
+            void SetBlendState(BlendState state) { mBlend = state; }
+            void SetDepthStencilState(DepthState state) { mDepth = state; }
+            void SetRasterizerState(CullMode state) { mCull = state; }
+            void SetSamplerState(SamplerState state) { mSampler = state; }
+
+            void Clear(const Vector4& color, float depth = 1.f)
+            {
+                Flush();
+
+                uint8_t texel[4] = { ToUNORM(color.x), ToUNORM(color.y), ToUNORM(color.z), ToUNORM(color.w) };
+                for (size_t j = 0; j < mWidth * mHeight; ++j)
+                    memcpy(&mColor[j * 4], texel, 4);
+
+                std::fill(mDepthBuffer.begin(), mDepthBuffer.end(), depth);
+            }
+
+            // Triangle lists, with the effect and current states captured until the next Flush.
+            // The vertex data can be reused straight away, but textures must outlive the Flush.
+            template<typename TIndex>
+            void DrawIndexed(const BasicEffectState& effect, const InputLayout& layout, const void* vertices, size_t vertexCount, const TIndex* indices, size_t indexCount)
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+
+                uint32_t draw = PrepareDraw(effect, layout, vertices, vertexCount);
+
+                for (size_t j = 0; j + 2 < indexCount; j += 3)
+                {
+                    size_t i0 = indices[j], i1 = indices[j + 1], i2 = indices[j + 2];
+                    if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+                        throw std::out_of_range("Index out of range");
+
+                    SetupTriangle(mShaded[i0], mShaded[i1], mShaded[i2], draw);
+                }
+
+                mStats.triangles += indexCount / 3;
+                mStats.setupMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            }
+
+            void Draw(const BasicEffectState& effect, const InputLayout& layout, const void* vertices, size_t vertexCount)
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+
+                uint32_t draw = PrepareDraw(effect, layout, vertices, vertexCount);
+
+                for (size_t j = 0; j + 2 < vertexCount; j += 3)
+                    SetupTriangle(mShaded[j], mShaded[j + 1], mShaded[j + 2], draw);
+
+                mStats.triangles += vertexCount / 3;
+                mStats.setupMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            }
+
+            // Rasterizes everything drawn since the last Flush.
+            void Flush()
+            {
+                if (mTriangles.empty())
+                {
+                    mDraws.clear();
+                    return;
+                }
+
+                auto start = std::chrono::high_resolution_clock::now();
+
+                std::vector<size_t> tiles;
+                for (size_t j = 0; j < mBins.size(); ++j)
+                {
+                    if (!mBins[j].empty())
+                        tiles.push_back(j);
+                }
+
+                std::atomic<size_t> next(0);
+                std::atomic<size_t> pixels(0);
+                auto worker = [&]()
+                {
+                    size_t count = 0;
+                    for (size_t j = next++; j < tiles.size(); j = next++)
+                    {
+                        count += RasterizeTile(tiles[j]);
+                    }
+                    pixels += count;
+                };
+
+                std::vector<std::thread> threads;
+                size_t threadCount = std::min<size_t>(mThreadCount, tiles.size());
+                for (size_t j = 1; j < threadCount; ++j)
+                    threads.emplace_back(worker);
+
+                worker();
+
+                for (auto& thread : threads)
+                    thread.join();
+
+                for (auto& bin : mBins)
+                    bin.clear();
+
+                mTriangles.clear();
+                mVaryings.clear();
+                mDraws.clear();
+
+                mStats.pixels += pixels;
+                mStats.rasterMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            }
+
+            // Tightly packed 8-bit RGBA, flushing any pending draws first.
+            const uint8_t* GetPixels()
+            {
+                Flush();
+                return mColor.data();
+            }
+
+            size_t GetRowPitch() const { return mWidth * 4; }
+
+            const FrameStatistics& GetStatistics() const { return mStats; }
+            void ResetStatistics() { mStats = FrameStatistics{}; }
+
+        private:
+            // Interpolated vertex outputs, in the order of the BasicEffect.fx output structures.
+            enum Varying
+            {
+                VARYING_DIFFUSE = 0,        // rgba
+                VARYING_SPECULAR = 4,       // rgb
+                VARYING_FOG = 7,
+                VARYING_TEXCOORD = 8,       // uv
+                VARYING_POSITION_WS = 10,   // Per-pixel lighting only
+                VARYING_NORMAL_WS = 13,
+                VARYING_COUNT = 16,
+                VARYING_COUNT_VERTEX_LIT = 10,
+            };
+
+            struct ShadedVertex
+            {
+                Vector4 position;
+                float   varyings[VARYING_COUNT];
+            };
+
+            // Constants folded the same way as EffectLights::SetConstants.
+            struct LightingConstants
+            {
+                Vector4 diffuseColor;       // xyz premultiplied by alpha
+                Vector3 emissiveColor;
+                Vector3 specularColor;
+                float   specularPower;
+                Vector3 eyePosition;
+                Vector3 lightDirection[BasicEffectState::MaxDirectionalLights];
+                Vector3 lightDiffuse[BasicEffectState::MaxDirectionalLights];
+                Vector3 lightSpecular[BasicEffectState::MaxDirectionalLights];
+            };
+
+            struct DrawRecord
+            {
+                BlendState          blend;
+                DepthState          depth;
+                SamplerState        sampler;
+                const Texture*      texture;
+                bool                perPixelLighting;
+                bool                fog;
+                size_t              varyingCount;
+                Vector3             fogColor;
+                LightingConstants   lighting;
+            };
+
+            struct Triangle
+            {
+                int32_t     x[3];           // 24.8 fixed point
+                int32_t     y[3];
+                int32_t     minX, minY, maxX, maxY;
+                float       z[3];
+                float       invW[3];
+                uint32_t    draw;
+                size_t      varyings;       // 3 * VARYING_COUNT values in mVaryings, premultiplied by invW
+            };
+
+            static const int32_t SubpixelBits = 8;
+            static const int32_t SubpixelScale = 1 << SubpixelBits;
+
+            static uint8_t ToUNORM(float c)
+            {
+                return uint8_t(Internal::Saturate(c) * 255.f + 0.5f);
+            }
+
+            static void ComputeLights(const LightingConstants& c, const Vector3& eyeVector, const Vector3& worldNormal, Vector3& diffuse, Vector3& specular)
+            {
+                using namespace Internal;
+
+                Vector3 diffuseSum = {};
+                Vector3 specularSum = {};
+
+                for (size_t i = 0; i < BasicEffectState::MaxDirectionalLights; ++i)
+                {
+                    float dotL = -Dot(c.lightDirection[i], worldNormal);
+                    float dotH = Dot(Normalize(eyeVector - c.lightDirection[i]), worldNormal);
+                    float zeroL = (dotL >= 0.f) ? 1.f : 0.f;
+
+                    diffuseSum = diffuseSum + c.lightDiffuse[i] * (zeroL * dotL);
+                    specularSum = specularSum + c.lightSpecular[i] * (powf(std::max(dotH, 0.f) * zeroL, c.specularPower) * dotL);
+                }
+
+                diffuse = diffuseSum * Vector3{ c.diffuseColor.x, c.diffuseColor.y, c.diffuseColor.z } + c.emissiveColor;
+                specular = specularSum * c.specularColor;
+            }
+
+            // Runs the BasicEffect vertex shader over every vertex and records the draw state.
+            uint32_t PrepareDraw(const BasicEffectState& effect, const InputLayout& layout, const void* vertices, size_t vertexCount)
+            {
+                using namespace Internal;
+
+                if (effect.lightingEnabled && !layout.normal.format)
+                    throw std::invalid_argument("Lighting needs vertex normals");
+                if (effect.vertexColorEnabled && !layout.color.format)
+                    throw std::invalid_argument("Vertex color needs a COLOR element");
+                if (effect.textureEnabled && (!layout.textureCoordinate.format || !effect.texture))
+                    throw std::invalid_argument("Texturing needs a texture and a TEXCOORD element");
+
+                DrawRecord record;
+                record.blend = mBlend;
+                record.depth = mDepth;
+                record.sampler = mSampler;
+                record.texture = effect.textureEnabled ? effect.texture : nullptr;
+                record.perPixelLighting = effect.lightingEnabled && effect.perPixelLighting;
+                record.fog = effect.fogEnabled;
+                record.varyingCount = record.perPixelLighting ? size_t(VARYING_COUNT) : size_t(VARYING_COUNT_VERTEX_LIT);
+                record.fogColor = effect.fogColor;
+
+                Matrix worldView = effect.world * effect.view;
+                Matrix worldViewProj = worldView * effect.projection;
+                Matrix worldInverse = effect.world.Invert();
+                Matrix viewInverse = effect.view.Invert();
+
+                auto& lighting = record.lighting;
+                Vector3 diffuse = effect.diffuseColor;
+                if (effect.lightingEnabled)
+                {
+                    lighting.emissiveColor = (effect.emissiveColor + effect.ambientLightColor * diffuse) * effect.alpha;
+                }
+                else
+                {
+                    lighting.emissiveColor = Vector3{};
+                    diffuse = diffuse + effect.emissiveColor;
+                }
+                lighting.diffuseColor = Vector4{ diffuse.x * effect.alpha, diffuse.y * effect.alpha, diffuse.z * effect.alpha, effect.alpha };
+                lighting.specularColor = effect.specularColor;
+                lighting.specularPower = effect.specularPower;
+                lighting.eyePosition = Vector3{ viewInverse.m[3][0], viewInverse.m[3][1], viewInverse.m[3][2] };
+                for (size_t i = 0; i < BasicEffectState::MaxDirectionalLights; ++i)
+                {
+                    auto& light = effect.lights[i];
+                    lighting.lightDirection[i] = light.direction;
+                    lighting.lightDiffuse[i] = light.enabled ? light.diffuseColor : Vector3{};
+                    lighting.lightSpecular[i] = light.enabled ? light.specularColor : Vector3{};
+                }
+
+                // Only the Z row of the world+view matrix is needed for fog.
+                Vector4 fogVector = {};
+                if (effect.fogEnabled)
+                {
+                    if (effect.fogStart == effect.fogEnd)
+                    {
+                        fogVector.w = 1.f;
+                    }
+                    else
+                    {
+                        float scale = 1.f / (effect.fogStart - effect.fogEnd);
+                        fogVector = Vector4{ worldView.m[0][2] * scale, worldView.m[1][2] * scale, worldView.m[2][2] * scale, (worldView.m[3][2] + effect.fogStart) * scale };
+                    }
+                }
+
+                mShaded.resize(vertexCount);
+
+                auto source = static_cast<const uint8_t*>(vertices);
+                for (size_t j = 0; j < vertexCount; ++j, source += layout.stride)
+                {
+                    auto& out = mShaded[j];
+                    float* v = out.varyings;
+
+                    Vector4 position = layout.Read(layout.position, source, 1.f);
+                    out.position = worldViewProj.Transform(position);
+
+                    Vector4 color = lighting.diffuseColor;
+                    Vector3 specular = {};
+
+                    if (effect.lightingEnabled)
+                    {
+                        Vector4 normal = layout.Read(layout.normal, source, 0.f);
+                        Vector3 worldNormal = Normalize(Vector3
+                        {
+                            normal.x * worldInverse.m[0][0] + normal.y * worldInverse.m[0][1] + normal.z * worldInverse.m[0][2],
+                            normal.x * worldInverse.m[1][0] + normal.y * worldInverse.m[1][1] + normal.z * worldInverse.m[1][2],
+                            normal.x * worldInverse.m[2][0] + normal.y * worldInverse.m[2][1] + normal.z * worldInverse.m[2][2],
+                        });
+
+                        Vector4 worldPosition = effect.world.Transform(position);
+                        Vector3 positionWS = { worldPosition.x, worldPosition.y, worldPosition.z };
+
+                        if (record.perPixelLighting)
+                        {
+                            color = Vector4{ 1.f, 1.f, 1.f, lighting.diffuseColor.w };
+                            memcpy(v + VARYING_POSITION_WS, &positionWS, sizeof(Vector3));
+                            memcpy(v + VARYING_NORMAL_WS, &worldNormal, sizeof(Vector3));
+                        }
+                        else
+                        {
+                            Vector3 lit;
+                            ComputeLights(lighting, Normalize(lighting.eyePosition - positionWS), worldNormal, lit, specular);
+                            color = Vector4{ lit.x, lit.y, lit.z, lighting.diffuseColor.w };
+                        }
+                    }
+
+                    if (effect.vertexColorEnabled)
+                    {
+                        Vector4 vertexColor = layout.Read(layout.color, source, 1.f);
+                        color.x *= vertexColor.x;
+                        color.y *= vertexColor.y;
+                        color.z *= vertexColor.z;
+                        color.w *= vertexColor.w;
+                    }
+
+                    memcpy(v + VARYING_DIFFUSE, &color, sizeof(Vector4));
+                    memcpy(v + VARYING_SPECULAR, &specular, sizeof(Vector3));
+
+                    v[VARYING_FOG] = Saturate(position.x * fogVector.x + position.y * fogVector.y + position.z * fogVector.z + position.w * fogVector.w);
+
+                    if (effect.textureEnabled)
+                    {
+                        Vector4 uv = layout.Read(layout.textureCoordinate, source, 0.f);
+                        v[VARYING_TEXCOORD] = uv.x;
+                        v[VARYING_TEXCOORD + 1] = uv.y;
+                    }
+                    else
+                    {
+                        v[VARYING_TEXCOORD] = v[VARYING_TEXCOORD + 1] = 0.f;
+                    }
+                }
+
+                mDraws.push_back(record);
+                mStats.drawCalls++;
+
+                return uint32_t(mDraws.size() - 1);
+            }
+
+            static float PlaneDistance(const Vector4& p, size_t plane)
+            {
+                switch (plane)
+                {
+                case 0:  return p.w + p.x;
+                case 1:  return p.w - p.x;
+                case 2:  return p.w + p.y;
+                case 3:  return p.w - p.y;
+                case 4:  return p.z;
+                default: return p.w - p.z;
+                }
+            }
+
+            static unsigned OutCode(const Vector4& p)
+            {
+                unsigned code = 0;
+                for (size_t plane = 0; plane < 6; ++plane)
+                {
+                    if (PlaneDistance(p, plane) < 0.f)
+                        code |= 1u << plane;
+                }
+                return code;
+            }
+
+            // Sutherland-Hodgman against the view volume, then a fan of the clipped polygon.
+            void SetupTriangle(const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c, uint32_t draw)
+            {
+                unsigned codeA = OutCode(a.position), codeB = OutCode(b.position), codeC = OutCode(c.position);
+
+                if (codeA & codeB & codeC)
+                    return;
+
+                if (!(codeA | codeB | codeC))
+                {
+                    EmitTriangle(a, b, c, draw);
+                    return;
+                }
+
+                size_t varyingCount = mDraws[draw].varyingCount;
+
+                ShadedVertex buffers[2][9];
+                size_t count = 3;
+                buffers[0][0] = a;
+                buffers[0][1] = b;
+                buffers[0][2] = c;
+
+                unsigned planes = codeA | codeB | codeC;
+                size_t current = 0;
+
+                for (size_t plane = 0; plane < 6; ++plane)
+                {
+                    if (!(planes & (1u << plane)))
+                        continue;
+
+                    auto& input = buffers[current];
+                    auto& output = buffers[current ^ 1];
+                    size_t outputCount = 0;
+
+                    for (size_t j = 0; j < count; ++j)
+                    {
+                        auto& p0 = input[j];
+                        auto& p1 = input[(j + 1) % count];
+                        float d0 = PlaneDistance(p0.position, plane);
+                        float d1 = PlaneDistance(p1.position, plane);
+
+                        if (d0 >= 0.f)
+                            output[outputCount++] = p0;
+
+                        if ((d0 >= 0.f) != (d1 >= 0.f))
+                        {
+                            float t = d0 / (d0 - d1);
+                            auto& out = output[outputCount++];
+                            out.position.x = p0.position.x + (p1.position.x - p0.position.x) * t;
+                            out.position.y = p0.position.y + (p1.position.y - p0.position.y) * t;
+                            out.position.z = p0.position.z + (p1.position.z - p0.position.z) * t;
+                            out.position.w = p0.position.w + (p1.position.w - p0.position.w) * t;
+                            for (size_t k = 0; k < varyingCount; ++k)
+                                out.varyings[k] = p0.varyings[k] + (p1.varyings[k] - p0.varyings[k]) * t;
+                        }
+                    }
+
+                    count = outputCount;
+                    current ^= 1;
+
+                    if (count < 3)
+                        return;
+                }
+
+                auto& polygon = buffers[current];
+                for (size_t j = 1; j + 1 < count; ++j)
+                    EmitTriangle(polygon[0], polygon[j], polygon[j + 1], draw);
+            }
+
+            static int32_t FloorDivide(int32_t a, int32_t b)
+            {
+                return (a >= 0) ? (a / b) : -((-a + b - 1) / b);
+            }
+
+            // Projects, snaps and culls a triangle inside the view volume, then bins it.
+            void EmitTriangle(const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c, uint32_t draw)
+            {
+                const ShadedVertex* v[3] = { &a, &b, &c };
+
+                Triangle tri;
+                tri.draw = draw;
+
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    auto& p = v[j]->position;
+                    float invW = 1.f / p.w;
+                    float sx = (p.x * invW + 1.f) * 0.5f * float(mWidth);
+                    float sy = (1.f - p.y * invW) * 0.5f * float(mHeight);
+
+                    tri.x[j] = int32_t(lrintf(sx * float(SubpixelScale)));
+                    tri.y[j] = int32_t(lrintf(sy * float(SubpixelScale)));
+                    tri.z[j] = p.z * invW;
+                    tri.invW[j] = invW;
+                }
+
+                // With y pointing down, a positive area is clockwise on screen.
+                int64_t area = int64_t(tri.x[1] - tri.x[0]) * int64_t(tri.y[2] - tri.y[0]) - int64_t(tri.x[2] - tri.x[0]) * int64_t(tri.y[1] - tri.y[0]);
+
+                if (!area)
+                    return;
+
+                if ((mCull == CULL_CLOCKWISE && area > 0) || (mCull == CULL_COUNTERCLOCKWISE && area < 0))
+                    return;
+
+                // Rasterize everything clockwise.
+                if (area < 0)
+                {
+                    std::swap(v[1], v[2]);
+                    std::swap(tri.x[1], tri.x[2]);
+                    std::swap(tri.y[1], tri.y[2]);
+                    std::swap(tri.z[1], tri.z[2]);
+                    std::swap(tri.invW[1], tri.invW[2]);
+                }
+
+                // Pixels whose centers fall inside the bounding box.
+                int32_t half = SubpixelScale / 2;
+                tri.minX = std::max(0, FloorDivide(std::min({ tri.x[0], tri.x[1], tri.x[2] }) - half + SubpixelScale - 1, SubpixelScale));
+                tri.minY = std::max(0, FloorDivide(std::min({ tri.y[0], tri.y[1], tri.y[2] }) - half + SubpixelScale - 1, SubpixelScale));
+                tri.maxX = std::min(int32_t(mWidth) - 1, FloorDivide(std::max({ tri.x[0], tri.x[1], tri.x[2] }) - half, SubpixelScale));
+                tri.maxY = std::min(int32_t(mHeight) - 1, FloorDivide(std::max({ tri.y[0], tri.y[1], tri.y[2] }) - half, SubpixelScale));
+
+                if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+                    return;
+
+                tri.varyings = mVaryings.size();
+                mVaryings.resize(mVaryings.size() + 3 * VARYING_COUNT);
+                size_t varyingCount = mDraws[draw].varyingCount;
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    float* dest = &mVaryings[tri.varyings + j * VARYING_COUNT];
+                    for (size_t k = 0; k < varyingCount; ++k)
+                        dest[k] = v[j]->varyings[k] * tri.invW[j];
+                }
+
+                uint32_t index = uint32_t(mTriangles.size());
+                mTriangles.push_back(tri);
+                mStats.trianglesRasterized++;
+
+                for (size_t ty = size_t(tri.minY) / TileSize; ty <= size_t(tri.maxY) / TileSize; ++ty)
+                {
+                    for (size_t tx = size_t(tri.minX) / TileSize; tx <= size_t(tri.maxX) / TileSize; ++tx)
+                        mBins[ty * mTilesX + tx].push_back(index);
+                }
+            }
+
+            // Rasterizes the triangles binned to one tile in order; returns the pixels written.
+            size_t RasterizeTile(size_t tile)
+            {
+                using namespace Internal;
+
+                int32_t tileX0 = int32_t((tile % mTilesX) * TileSize);
+                int32_t tileY0 = int32_t((tile / mTilesX) * TileSize);
+                int32_t tileX1 = std::min(int32_t(mWidth), tileX0 + int32_t(TileSize)) - 1;
+                int32_t tileY1 = std::min(int32_t(mHeight), tileY0 + int32_t(TileSize)) - 1;
+
+                size_t pixels = 0;
+                float attributes[VARYING_COUNT];
+
+                for (uint32_t index : mBins[tile])
+                {
+                    auto& tri = mTriangles[index];
+                    auto& draw = mDraws[tri.draw];
+                    const float* varyings = &mVaryings[tri.varyings];
+
+                    int32_t x0 = std::max(tri.minX, tileX0);
+                    int32_t y0 = std::max(tri.minY, tileY0);
+                    int32_t x1 = std::min(tri.maxX, tileX1);
+                    int32_t y1 = std::min(tri.maxY, tileY1);
+                    if (x0 > x1 || y0 > y1)
+                        continue;
+
+                    // Edge j is opposite vertex j, so its function is that vertex's barycentric weight.
+                    int64_t stepX[3], stepY[3], row[3], bias[3];
+                    int32_t startX = x0 * SubpixelScale + SubpixelScale / 2;
+                    int32_t startY = y0 * SubpixelScale + SubpixelScale / 2;
+
+                    for (size_t e = 0; e < 3; ++e)
+                    {
+                        size_t i0 = (e + 1) % 3, i1 = (e + 2) % 3;
+                        int64_t dx = tri.x[i1] - tri.x[i0];
+                        int64_t dy = tri.y[i1] - tri.y[i0];
+
+                        stepX[e] = -dy * SubpixelScale;
+                        stepY[e] = dx * SubpixelScale;
+                        row[e] = dx * (startY - tri.y[i0]) - dy * (startX - tri.x[i0]);
+
+                        // Top-left fill rule: pixels exactly on an edge belong to top and left edges.
+                        bias[e] = (dy < 0 || (dy == 0 && dx > 0)) ? 0 : -1;
+                    }
+
+                    // The edge functions sum to twice the triangle's area at any point.
+                    float invArea = float(1.0 / double(row[0] + row[1] + row[2]));
+
+                    float dldx[3], dldy[3];
+                    for (size_t e = 0; e < 3; ++e)
+                    {
+                        dldx[e] = float(stepX[e]) * invArea;
+                        dldy[e] = float(stepY[e]) * invArea;
+                    }
+
+                    const float* v0 = varyings;
+                    const float* v1 = varyings + VARYING_COUNT;
+                    const float* v2 = varyings + 2 * VARYING_COUNT;
+
+                    for (int32_t y = y0; y <= y1; ++y)
+                    {
+                        int64_t w0 = row[0], w1 = row[1], w2 = row[2];
+
+                        for (int32_t x = x0; x <= x1; ++x, w0 += stepX[0], w1 += stepX[1], w2 += stepX[2])
+                        {
+                            if (((w0 + bias[0]) | (w1 + bias[1]) | (w2 + bias[2])) < 0)
+                                continue;
+
+                            float l0 = float(w0) * invArea;
+                            float l1 = float(w1) * invArea;
+                            float l2 = float(w2) * invArea;
+
+                            size_t pixel = size_t(y) * mWidth + size_t(x);
+                            float z = l0 * tri.z[0] + l1 * tri.z[1] + l2 * tri.z[2];
+
+                            if (draw.depth != DEPTH_NONE)
+                            {
+                                if (!(z <= mDepthBuffer[pixel]))
+                                    continue;
+
+                                if (draw.depth == DEPTH_DEFAULT)
+                                    mDepthBuffer[pixel] = z;
+                            }
+
+                            // Perspective-correct interpolation.
+                            float q = l0 * tri.invW[0] + l1 * tri.invW[1] + l2 * tri.invW[2];
+                            float invQ = 1.f / q;
+                            for (size_t k = 0; k < draw.varyingCount; ++k)
+                                attributes[k] = (l0 * v0[k] + l1 * v1[k] + l2 * v2[k]) * invQ;
+
+                            float lod = 0.f;
+                            if (draw.texture)
+                            {
+                                // Analytic screen-space derivatives of the texture coordinate.
+                                float dqdx = dldx[0] * tri.invW[0] + dldx[1] * tri.invW[1] + dldx[2] * tri.invW[2];
+                                float dqdy = dldy[0] * tri.invW[0] + dldy[1] * tri.invW[1] + dldy[2] * tri.invW[2];
+                                const size_t t = VARYING_TEXCOORD;
+                                float dudx = ((dldx[0] * v0[t] + dldx[1] * v1[t] + dldx[2] * v2[t]) - attributes[t] * dqdx) * invQ;
+                                float dvdx = ((dldx[0] * v0[t + 1] + dldx[1] * v1[t + 1] + dldx[2] * v2[t + 1]) - attributes[t + 1] * dqdx) * invQ;
+                                float dudy = ((dldy[0] * v0[t] + dldy[1] * v1[t] + dldy[2] * v2[t]) - attributes[t] * dqdy) * invQ;
+                                float dvdy = ((dldy[0] * v0[t + 1] + dldy[1] * v1[t + 1] + dldy[2] * v2[t + 1]) - attributes[t + 1] * dqdy) * invQ;
+
+                                float w = float(draw.texture->Width()), h = float(draw.texture->Height());
+                                float rho2 = std::max((dudx * w) * (dudx * w) + (dvdx * h) * (dvdx * h),
+                                                      (dudy * w) * (dudy * w) + (dvdy * h) * (dvdy * h));
+                                lod = (rho2 > 0.f) ? 0.5f * log2f(rho2) : 0.f;
+                            }
+
+                            Shade(draw, attributes, lod, &mColor[pixel * 4]);
+                            ++pixels;
+                        }
+
+                        row[0] += stepY[0];
+                        row[1] += stepY[1];
+                        row[2] += stepY[2];
+                    }
+                }
+
+                return pixels;
+            }
+
+            // The BasicEffect pixel shader, followed by the output merger.
+            static void Shade(const DrawRecord& draw, const float* attributes, float lod, uint8_t* dest)
+            {
+                using namespace Internal;
+
+                Vector4 color = { attributes[VARYING_DIFFUSE], attributes[VARYING_DIFFUSE + 1], attributes[VARYING_DIFFUSE + 2], attributes[VARYING_DIFFUSE + 3] };
+                Vector3 specular = { attributes[VARYING_SPECULAR], attributes[VARYING_SPECULAR + 1], attributes[VARYING_SPECULAR + 2] };
+
+                if (draw.texture)
+                {
+                    Vector4 texel = draw.texture->Sample(draw.sampler, attributes[VARYING_TEXCOORD], attributes[VARYING_TEXCOORD + 1], lod);
+                    color.x *= texel.x;
+                    color.y *= texel.y;
+                    color.z *= texel.z;
+                    color.w *= texel.w;
+                }
+
+                if (draw.perPixelLighting)
+                {
+                    Vector3 positionWS = { attributes[VARYING_POSITION_WS], attributes[VARYING_POSITION_WS + 1], attributes[VARYING_POSITION_WS + 2] };
+                    Vector3 normalWS = { attributes[VARYING_NORMAL_WS], attributes[VARYING_NORMAL_WS + 1], attributes[VARYING_NORMAL_WS + 2] };
+
+                    Vector3 diffuse;
+                    ComputeLights(draw.lighting, Normalize(draw.lighting.eyePosition - positionWS), Normalize(normalWS), diffuse, specular);
+                    color.x *= diffuse.x;
+                    color.y *= diffuse.y;
+                    color.z *= diffuse.z;
+                }
+
+                color.x += specular.x * color.w;
+                color.y += specular.y * color.w;
+                color.z += specular.z * color.w;
+
+                if (draw.fog)
+                {
+                    float fog = attributes[VARYING_FOG];
+                    color.x += (draw.fogColor.x * color.w - color.x) * fog;
+                    color.y += (draw.fogColor.y * color.w - color.y) * fog;
+                    color.z += (draw.fogColor.z * color.w - color.z) * fog;
+                }
+
+                float src[4] = { Saturate(color.x), Saturate(color.y), Saturate(color.z), Saturate(color.w) };
+                float srcFactor = 1.f, destFactor = 0.f;
+
+                switch (draw.blend)
+                {
+                case BLEND_ALPHA:               srcFactor = 1.f;    destFactor = 1.f - src[3]; break;
+                case BLEND_ADDITIVE:            srcFactor = src[3]; destFactor = 1.f; break;
+                case BLEND_NONPREMULTIPLIED:    srcFactor = src[3]; destFactor = 1.f - src[3]; break;
+                default:                        break;
+                }
+
+                const float scale = 1.f / 255.f;
+                for (size_t c = 0; c < 4; ++c)
+                    dest[c] = ToUNORM(src[c] * srcFactor + float(dest[c]) * scale * destFactor);
+            }
+
+            size_t                          mWidth;
+            size_t                          mHeight;
+            size_t                          mTilesX;
+            size_t                          mTilesY;
+            unsigned                        mThreadCount;
+
+            BlendState                      mBlend;
+            DepthState                      mDepth;
+            CullMode                        mCull;
+            SamplerState                    mSampler;
+
+            std::vector<uint8_t>            mColor;
+            std::vector<float>              mDepthBuffer;
+
+            std::vector<ShadedVertex>       mShaded;
+            std::vector<DrawRecord>         mDraws;
+            std::vector<Triangle>           mTriangles;
+            std::vector<float>              mVaryings;
+            std::vector<std::vector<uint32_t>> mBins;
+
+            FrameStatistics                 mStats;
+        };
+
+
+        //----------------------------------------------------------------------------------
+        // The SpriteBatch subset: sprites become quads drawn with a vertex-colored, textured
+        // BasicEffect, which computes the same texture * color as SpriteEffect.
+        enum SpriteSortMode
+        {
+            SPRITE_SORT_DEFERRED = 0,
+            SPRITE_SORT_IMMEDIATE,
+            SPRITE_SORT_TEXTURE,
+            SPRITE_SORT_BACK_TO_FRONT,
+            SPRITE_SORT_FRONT_TO_BACK,
+        };
+
+        enum SpriteEffects
+        {
+            SPRITE_EFFECTS_NONE = 0,
+            SPRITE_EFFECTS_FLIP_HORIZONTALLY = 1,
+            SPRITE_EFFECTS_FLIP_VERTICALLY = 2,
+            SPRITE_EFFECTS_FLIP_BOTH = 3,
+        };
+
+        struct Rect
+        {
+            int32_t left, top, right, bottom;
+        };
+
+        class SpriteRenderer
+        {
+        public:
+            explicit SpriteRenderer(Rasterizer& rasterizer)
+              : mRasterizer(rasterizer),
+                mInBeginEndPair(false),
+                mSortMode(SPRITE_SORT_DEFERRED),
+                mBlend(BLEND_ALPHA),
+                mSampler(SAMPLER_LINEAR_CLAMP),
+                mDepth(DEPTH_NONE),
+                mCull(CULL_COUNTERCLOCKWISE),
+                mTransform(Matrix::Identity())
+            {
+            }
+
+            SpriteRenderer(SpriteRenderer const&) = delete;
+            SpriteRenderer& operator= (SpriteRenderer const&) = delete;
+
+            // Same defaults as SpriteBatch::Begin.
+            void Begin(SpriteSortMode sortMode = SPRITE_SORT_DEFERRED,
+                       BlendState blend = BLEND_ALPHA,
+                       SamplerState sampler = SAMPLER_LINEAR_CLAMP,
+                       DepthState depth = DEPTH_NONE,
+                       CullMode cull = CULL_COUNTERCLOCKWISE,
+                       const Matrix& transform = Matrix::Identity())
+            {
+                if (mInBeginEndPair)
+                    throw std::logic_error("Cannot nest Begin calls on a single SpriteRenderer");
+
+                mSortMode = sortMode;
+                mBlend = blend;
+                mSampler = sampler;
+                mDepth = depth;
+                mCull = cull;
+                mTransform = transform;
+                mInBeginEndPair = true;
+            }
+
+            void Draw(const Texture& texture, const Vector2& position, const Rect* sourceRectangle = nullptr,
+                      const Vector4& color = Vector4{ 1.f, 1.f, 1.f, 1.f }, float rotation = 0.f,
+                      const Vector2& origin = Vector2{ 0.f, 0.f }, const Vector2& scale = Vector2{ 1.f, 1.f },
+                      unsigned effects = SPRITE_EFFECTS_NONE, float layerDepth = 0.f)
+            {
+                QueueSprite(texture, Vector4{ position.x, position.y, scale.x, scale.y }, sourceRectangle, color, rotation, origin, effects, layerDepth);
+            }
+
+            void Draw(const Texture& texture, const Rect& destinationRectangle, const Rect* sourceRectangle = nullptr,
+                      const Vector4& color = Vector4{ 1.f, 1.f, 1.f, 1.f }, float rotation = 0.f,
+                      const Vector2& origin = Vector2{ 0.f, 0.f }, unsigned effects = SPRITE_EFFECTS_NONE, float layerDepth = 0.f)
+            {
+                Vector4 destination =
+                {
+                    float(destinationRectangle.left),
+                    float(destinationRectangle.top),
+                    float(destinationRectangle.right - destinationRectangle.left),
+                    float(destinationRectangle.bottom - destinationRectangle.top),
+                };
+                QueueSprite(texture, destination, sourceRectangle, color, rotation, origin, effects | DestSizeInPixels, layerDepth);
+            }
+
+            void End()
+            {
+                if (!mInBeginEndPair)
+                    throw std::logic_error("Begin must be called before End");
+
+                mInBeginEndPair = false;
+
+                switch (mSortMode)
+                {
+                case SPRITE_SORT_TEXTURE:
+                    std::stable_sort(mSprites.begin(), mSprites.end(), [](const SpriteInfo& a, const SpriteInfo& b) { return a.texture < b.texture; });
+                    break;
+
+                case SPRITE_SORT_BACK_TO_FRONT:
+                    std::stable_sort(mSprites.begin(), mSprites.end(), [](const SpriteInfo& a, const SpriteInfo& b) { return a.layerDepth > b.layerDepth; });
+                    break;
+
+                case SPRITE_SORT_FRONT_TO_BACK:
+                    std::stable_sort(mSprites.begin(), mSprites.end(), [](const SpriteInfo& a, const SpriteInfo& b) { return a.layerDepth < b.layerDepth; });
+                    break;
+
+                default:
+                    break;
+                }
+
+                // Batch adjacent sprites that share a texture.
+                for (size_t start = 0; start < mSprites.size(); )
+                {
+                    size_t end = start + 1;
+                    while (end < mSprites.size() && mSprites[end].texture == mSprites[start].texture)
+                        ++end;
+
+                    RenderBatch(&mSprites[start], end - start);
+                    start = end;
+                }
+
+                mSprites.clear();
+            }
+
+        private:
+            static const unsigned DestSizeInPixels = 4;
+
+            struct SpriteInfo
+            {
+                const Texture*  texture;
+                Vector4         source;         // x, y, width, height in texels
+                Vector4         destination;    // x, y, width, height in pixels
+                Vector4         color;
+                Vector2         origin;
+                float           rotation;
+                float           layerDepth;
+                unsigned        flags;
+            };
+
+            // Same layout as VertexPositionColorTexture.
+            struct SpriteVertex
+            {
+                float position[3];
+                float color[4];
+                float textureCoordinate[2];
+            };
+
+            void QueueSprite(const Texture& texture, Vector4 destination, const Rect* sourceRectangle, const Vector4& color,
+                             float rotation, const Vector2& origin, unsigned flags, float layerDepth)
+            {
+                if (!mInBeginEndPair)
+                    throw std::logic_error("Begin must be called before Draw");
+
+                SpriteInfo sprite;
+                sprite.texture = &texture;
+                sprite.source = sourceRectangle
+                    ? Vector4{ float(sourceRectangle->left), float(sourceRectangle->top), float(sourceRectangle->right - sourceRectangle->left), float(sourceRectangle->bottom - sourceRectangle->top) }
+                    : Vector4{ 0.f, 0.f, float(texture.Width()), float(texture.Height()) };
+
+                // Scale is relative to the source region.
+                if (!(flags & DestSizeInPixels))
+                {
+                    destination.z *= sprite.source.z;
+                    destination.w *= sprite.source.w;
+                }
+
+                sprite.destination = destination;
+                sprite.color = color;
+                sprite.origin = origin;
+                sprite.rotation = rotation;
+                sprite.layerDepth = layerDepth;
+                sprite.flags = flags;
+
+                mSprites.push_back(sprite);
+
+                if (mSortMode == SPRITE_SORT_IMMEDIATE)
+                {
+                    RenderBatch(&mSprites.back(), 1);
+                    mSprites.clear();
+                }
+            }
+
+            // Matches SpriteBatch::Impl::RenderSprite.
+            static void RenderSprite(const SpriteInfo& sprite, SpriteVertex* vertices)
+            {
+                float textureWidth = float(sprite.texture->Width());
+                float textureHeight = float(sprite.texture->Height());
+
+                float sourceWidth = (sprite.source.z != 0.f) ? sprite.source.z : 1e-6f;
+                float sourceHeight = (sprite.source.w != 0.f) ? sprite.source.w : 1e-6f;
+                float originX = sprite.origin.x / sourceWidth;
+                float originY = sprite.origin.y / sourceHeight;
+
+                float sin = 0.f, cos = 1.f;
+                if (sprite.rotation != 0.f)
+                {
+                    sin = sinf(sprite.rotation);
+                    cos = cosf(sprite.rotation);
+                }
+
+                static const float cornerOffsets[4][2] = { { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 } };
+                unsigned mirrorBits = sprite.flags & 3;
+
+                for (size_t i = 0; i < 4; ++i)
+                {
+                    float cornerX = (cornerOffsets[i][0] - originX) * sprite.destination.z;
+                    float cornerY = (cornerOffsets[i][1] - originY) * sprite.destination.w;
+
+                    auto& vertex = vertices[i];
+                    vertex.position[0] = sprite.destination.x + cornerX * cos - cornerY * sin;
+                    vertex.position[1] = sprite.destination.y + cornerX * sin + cornerY * cos;
+                    vertex.position[2] = sprite.layerDepth;
+
+                    memcpy(vertex.color, &sprite.color, sizeof(vertex.color));
+
+                    auto& texCorner = cornerOffsets[i ^ mirrorBits];
+                    vertex.textureCoordinate[0] = (sprite.source.x + texCorner[0] * sprite.source.z) / textureWidth;
+                    vertex.textureCoordinate[1] = (sprite.source.y + texCorner[1] * sprite.source.w) / textureHeight;
+                }
+            }
+
+            void RenderBatch(const SpriteInfo* sprites, size_t count)
+            {
+                static const InputElement elements[] =
+                {
+                    { "SV_Position", 0, FORMAT_R32G32B32_FLOAT,    0, APPEND_ALIGNED_ELEMENT, 0, 0 },
+                    { "COLOR",       0, FORMAT_R32G32B32A32_FLOAT, 0, APPEND_ALIGNED_ELEMENT, 0, 0 },
+                    { "TEXCOORD",    0, FORMAT_R32G32_FLOAT,       0, APPEND_ALIGNED_ELEMENT, 0, 0 },
+                };
+
+                static const InputLayout layout(elements, 3, sizeof(SpriteVertex));
+
+                mVertices.resize(count * 4);
+                mIndices.resize(count * 6);
+
+                for (size_t j = 0; j < count; ++j)
+                {
+                    RenderSprite(sprites[j], &mVertices[j * 4]);
+
+                    static const uint32_t quad[6] = { 0, 1, 2, 1, 3, 2 };
+                    for (size_t k = 0; k < 6; ++k)
+                        mIndices[j * 6 + k] = uint32_t(j * 4) + quad[k];
+                }
+
+                // Pixel coordinates to clip space, as in SpriteBatch::Impl::GetViewportTransform.
+                Matrix viewport = Matrix::Identity();
+                viewport.m[0][0] = 2.f / float(mRasterizer.Width());
+                viewport.m[1][1] = -2.f / float(mRasterizer.Height());
+                viewport.m[3][0] = -1.f;
+                viewport.m[3][1] = 1.f;
+
+                BasicEffectState effect;
+                effect.world = mTransform * viewport;
+                effect.vertexColorEnabled = true;
+                effect.textureEnabled = true;
+                effect.texture = sprites[0].texture;
+
+                mRasterizer.SetBlendState(mBlend);
+                mRasterizer.SetSamplerState(mSampler);
+                mRasterizer.SetDepthStencilState(mDepth);
+                mRasterizer.SetRasterizerState(mCull);
+                mRasterizer.DrawIndexed(effect, layout, mVertices.data(), mVertices.size(), mIndices.data(), mIndices.size());
+            }
+
+            Rasterizer&                 mRasterizer;
+            bool                        mInBeginEndPair;
+            SpriteSortMode              mSortMode;
+            BlendState                  mBlend;
+            SamplerState                mSampler;
+            DepthState                  mDepth;
+            CullMode                    mCull;
+            Matrix                      mTransform;
+
+            std::vector<SpriteInfo>     mSprites;
+            std::vector<SpriteVertex>   mVertices;
+            std::vector<uint32_t>       mIndices;
+        };
+    }
+}
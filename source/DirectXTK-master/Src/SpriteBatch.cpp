@@ -19,6 +19,10 @@
 #include "VertexTypes.h"
 #include "SharedResourcePool.h"
 #include "AlignedNew.h"
+#include "SpriteSort.h"
+
+#include <mutex>
+#include <thread>
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -28,10 +32,14 @@ namespace
     // Include the precompiled shader code.
     #if defined(_XBOX_ONE) && defined(_TITLE)
     #include "Shaders/Compiled/XboxOneSpriteEffect_SpriteVertexShader.inc"
+    #include "Shaders/Compiled/XboxOneSpriteEffect_SpriteVertexShaderTinted.inc"
     #include "Shaders/Compiled/XboxOneSpriteEffect_SpritePixelShader.inc"
+    #include "Shaders/Compiled/XboxOneSpriteEffect_SpritePixelShaderDistanceField.inc"
     #else
     #include "Shaders/Compiled/SpriteEffect_SpriteVertexShader.inc"
+    #include "Shaders/Compiled/SpriteEffect_SpriteVertexShaderTinted.inc"
     #include "Shaders/Compiled/SpriteEffect_SpritePixelShader.inc"
+    #include "Shaders/Compiled/SpriteEffect_SpritePixelShaderDistanceField.inc"
     #endif
 
 
@@ -58,6 +66,17 @@ namespace
 
         return v;
     }
+
+
+    // Helper writes a vector to write-combined memory without reading it into the cache.
+    inline void XM_CALLCONV StreamFloat4A(_Out_ XMFLOAT4A* destination, FXMVECTOR v)
+    {
+#if defined(_XM_SSE_INTRINSICS_)
+        _mm_stream_ps(reinterpret_cast<float*>(destination), v);
+#else
+        XMStoreFloat4A(destination, v);
+#endif
+    }
 }
 
 
@@ -96,21 +115,115 @@ public:
 
 
         // Combine values from the public SpriteEffects enum with these internal-only flags.
-        static const int SourceInTexels = 4;
-        static const int DestSizeInPixels = 8;
+        static const int SourceInTexels = 8;
+        static const int DestSizeInPixels = 16;
+
+        static_assert(((SpriteEffects_FlipBoth | SpriteEffects_DistanceField) & (SourceInTexels | DestSizeInPixels)) == 0, "Flag bits must not overlap");
+    };
+
+
+    // Sprites waiting to be drawn. These are kept in fixed-size blocks, so growing the queue never
+    // moves (or copies) the sprites already queued, and pointers to them stay valid until clear.
+    class SpriteQueue
+    {
+    public:
+        SpriteQueue() : mCount(0) {}
+
+        SpriteQueue(SpriteQueue const&) = delete;
+        SpriteQueue& operator= (SpriteQueue const&) = delete;
+
+        // Returns the slot past the end of the queue, which Commit then adds to it.
+        SpriteInfo* Allocate()
+        {
+            if (mCount >= mBlocks.size() * BlockSize)
+            {
+                mBlocks.emplace_back(new SpriteInfo[BlockSize]);
+            }
+
+            return &(*this)[mCount];
+        }
+
+        void Commit(_In_ ID3D11ShaderResourceView* texture)
+        {
+            mCount++;
+
+            // Make sure we hold a refcount on this texture until the sprite has been drawn. Only checking the
+            // back of the vector means we will add duplicate references if the caller switches back and forth
+            // between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
+            // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
+            if (textureReferences.empty() || texture != textureReferences.back().Get())
+            {
+                textureReferences.emplace_back(texture);
+            }
+        }
+
+        // Grows the queue to count sprites, leaving the new ones for the caller to fill in.
+        void Resize(size_t count)
+        {
+            while (count > mBlocks.size() * BlockSize)
+            {
+                mBlocks.emplace_back(new SpriteInfo[BlockSize]);
+            }
+
+            mCount = count;
+        }
+
+        void Clear()
+        {
+            mCount = 0;
+            textureReferences.clear();
+        }
+
+        size_t Size() const { return mCount; }
+
+        SpriteInfo& operator[] (size_t index) { return mBlocks[index >> BlockShift][index & (BlockSize - 1)]; }
+        SpriteInfo const& operator[] (size_t index) const { return mBlocks[index >> BlockShift][index & (BlockSize - 1)]; }
 
-        static_assert((SpriteEffects_FlipBoth & (SourceInTexels | DestSizeInPixels)) == 0, "Flag bits must not overlap");
+        // If each SpriteInfo instance held a refcount on its texture, could end up with
+        // many redundant AddRef/Release calls on the same object, so instead we use
+        // this separate list to hold just a single refcount each time we change texture.
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textureReferences;
+
+    private:
+        static const size_t BlockShift = 9;
+        static const size_t BlockSize = size_t(1) << BlockShift;
+
+        std::vector<std::unique_ptr<SpriteInfo[]>> mBlocks;
+        size_t mCount;
     };
 
+
+    // Layers keep the sprites recorded between Begin(layer) and End, and their vertices.
+    void BeginLayer(_In_ Layer::Impl* layer);
+    void XM_CALLCONV DrawLayer(_In_ Layer::Impl* layer, FXMVECTOR tint, FXMMATRIX transform);
+
+    // Recorders add sprites to their own queues, which End merges into this batch.
+    void RegisterRecorder(_In_ SpriteQueue* queue);
+    void UnregisterRecorder(_In_ SpriteQueue* queue);
+    void CheckRecording() const;
+
+    static void XM_CALLCONV WriteSprite(_Out_ SpriteInfo* sprite,
+        FXMVECTOR destination,
+        _In_opt_ RECT const* sourceRectangle,
+        FXMVECTOR color,
+        FXMVECTOR originRotationDepth,
+        int flags);
+
     DXGI_MODE_ROTATION mRotation;
 
     bool mSetViewport;
     D3D11_VIEWPORT mViewPort;
 
+    Statistics mStats;
+
 private:
     // Implementation helper methods.
-    void GrowSpriteQueue();
     void PrepareForRendering();
+    void XM_CALLCONV SetTransform(_In_ ID3D11DeviceContext* deviceContext, FXMMATRIX transformMatrix);
+    void XM_CALLCONV SetLayerTint(_In_ ID3D11DeviceContext* deviceContext, FXMVECTOR tint);
+    void SetPixelShader(_In_ ID3D11DeviceContext* deviceContext, bool distanceField);
+    void UpdateLayer(_In_ Layer::Impl* layer);
+    void MergeRecordedSprites();
     void FlushBatch();
     void SortSprites();
     void GrowSortedSprites();
@@ -122,6 +235,11 @@ private:
         FXMVECTOR textureSize,
         FXMVECTOR inverseTextureSize);
 
+    static void XM_CALLCONV RenderSprites(_In_reads_(SpritesPerGroup) SpriteInfo const* const* sprites,
+        _Out_writes_(SpritesPerGroup * VerticesPerSprite) VertexPositionColorTexture* vertices,
+        FXMVECTOR textureSize,
+        FXMVECTOR inverseTextureSize);
+
     static XMVECTOR GetTextureSize(_In_ ID3D11ShaderResourceView* texture);
     XMMATRIX GetViewportTransform(_In_ ID3D11DeviceContext* deviceContext, DXGI_MODE_ROTATION rotation );
 
@@ -129,33 +247,40 @@ private:
     // Constants.
     static const size_t MaxBatchSize = 2048;
     static const size_t MinBatchSize = 128;
-    static const size_t InitialQueueSize = 64;
+    static const size_t ParallelMergeSize = 16384;
+    static const size_t MaxMergeThreads = 8;
     static const size_t VerticesPerSprite = 4;
     static const size_t IndicesPerSprite = 6;
+    static const size_t SpritesPerGroup = 4;
 
 
     // Queue of sprites waiting to be drawn.
-    std::unique_ptr<SpriteInfo[]> mSpriteQueue;
+    SpriteQueue mSpriteQueue;
 
-    size_t mSpriteQueueCount;
-    size_t mSpriteQueueArraySize;
+
+    // Queues of the recorders for this batch, in the order they were created.
+    std::vector<SpriteQueue*> mRecorderQueues;
+    std::mutex mRecorderMutex;
 
 
     // To avoid needlessly copying around bulky SpriteInfo structures, we leave that
     // actual data alone and just sort this array of pointers instead. But we want contiguous
-    // memory for cache efficiency, so these pointers are just shortcuts into the single
-    // mSpriteQueue array, and we take care to keep them in order when sorting is disabled.
+    // memory for cache efficiency, so these pointers are just shortcuts into the blocks of
+    // mSpriteQueue, and we take care to keep them in order when sorting is disabled.
     std::vector<SpriteInfo const*> mSortedSprites;
 
 
-    // If each SpriteInfo instance held a refcount on its texture, could end up with
-    // many redundant AddRef/Release calls on the same object, so instead we use
-    // this separate list to hold just a single refcount each time we change texture.
-    std::vector<ComPtr<ID3D11ShaderResourceView>> mSpriteTextureReferences;
+    // Sort keys (sort value above queue index) and the distinct textures being sorted, kept
+    // between batches so sorting doesn't allocate once they have grown.
+    std::vector<uint64_t> mSortKeys;
+    std::vector<uint64_t> mSortScratch;
+    std::vector<ID3D11ShaderResourceView*> mSortTextures;
 
 
     // Mode settings from the last Begin call.
     bool mInBeginEndPair;
+    Layer::Impl* mRecordingLayer;
+    bool mDistanceFieldShaderSet;
 
     SpriteSortMode mSortMode;
     ComPtr<ID3D11BlendState> mBlendState;
@@ -172,7 +297,9 @@ private:
         DeviceResources(_In_ ID3D11Device* device);
 
         ComPtr<ID3D11VertexShader> vertexShader;
+        ComPtr<ID3D11VertexShader> tintedVertexShader;
         ComPtr<ID3D11PixelShader> pixelShader;
+        ComPtr<ID3D11PixelShader> distanceFieldPixelShader;
         ComPtr<ID3D11InputLayout> inputLayout;
         ComPtr<ID3D11Buffer> indexBuffer;
 
@@ -200,6 +327,7 @@ private:
         ComPtr<ID3D11Buffer> vertexBuffer;
 
         ConstantBuffer<XMMATRIX> constantBuffer;
+        ConstantBuffer<XMVECTOR> layerTintBuffer;
 
         size_t vertexBufferPosition;
 
@@ -219,6 +347,128 @@ private:
 };
 
 
+// Internal SpriteBatch::Layer implementation class.
+class SpriteBatch::Layer::Impl
+{
+public:
+    typedef SpriteBatch::Impl::SpriteInfo SpriteInfo;
+
+    Impl()
+      : recordCount(0),
+        dirtyBegin(0),
+        dirtyEnd(0),
+        bufferCapacity(0),
+        runsChanged(false)
+    {}
+
+    Impl(Impl const&) = delete;
+    Impl& operator= (Impl const&) = delete;
+
+    void BeginRecording()
+    {
+        recordCount = 0;
+
+        // The previous references are kept until End, since most sprites use the same textures again.
+        std::swap(sprites.textureReferences, previousReferences);
+        sprites.textureReferences.clear();
+    }
+
+    // Stores the next sprite, marking it dirty only if it differs from the one it replaces.
+    void Record(SpriteInfo const& sprite)
+    {
+        if (recordCount < sprites.Size())
+        {
+            SpriteInfo& previous = sprites[recordCount];
+
+            if (!IsSameSprite(previous, sprite))
+            {
+                if (previous.texture != sprite.texture || ((previous.flags ^ sprite.flags) & SpriteEffects_DistanceField))
+                {
+                    runsChanged = true;
+                }
+
+                previous = sprite;
+                MarkDirty(recordCount);
+            }
+        }
+        else
+        {
+            *sprites.Allocate() = sprite;
+            sprites.Resize(recordCount + 1);
+            runsChanged = true;
+            MarkDirty(recordCount);
+        }
+
+        recordCount++;
+
+        if (sprites.textureReferences.empty() || sprite.texture != sprites.textureReferences.back().Get())
+        {
+            sprites.textureReferences.emplace_back(sprite.texture);
+        }
+    }
+
+    void EndRecording()
+    {
+        if (recordCount != sprites.Size())
+        {
+            // Dropped sprites just stop being drawn; their vertices are left in the buffer.
+            sprites.Resize(recordCount);
+            runsChanged = true;
+            dirtyEnd = std::min(dirtyEnd, recordCount);
+            dirtyBegin = std::min(dirtyBegin, dirtyEnd);
+        }
+
+        previousReferences.clear();
+    }
+
+    void MarkDirty(size_t index)
+    {
+        if (dirtyBegin == dirtyEnd)
+        {
+            dirtyBegin = index;
+            dirtyEnd = index + 1;
+        }
+        else
+        {
+            dirtyBegin = std::min(dirtyBegin, index);
+            dirtyEnd = std::max(dirtyEnd, index + 1);
+        }
+    }
+
+    static bool IsSameSprite(SpriteInfo const& a, SpriteInfo const& b)
+    {
+        // Compare member by member, since the padding at the end of SpriteInfo is undefined.
+        return memcmp(&a.source, &b.source, sizeof(XMFLOAT4A) * 4) == 0
+            && a.texture == b.texture
+            && a.flags == b.flags;
+    }
+
+    // A run of sprites sharing a texture, drawn together.
+    struct Run
+    {
+        ID3D11ShaderResourceView* texture;
+        bool distanceField;
+        size_t start;
+        size_t count;
+    };
+
+    SpriteBatch::Impl::SpriteQueue sprites;
+    std::vector<ComPtr<ID3D11ShaderResourceView>> previousReferences;
+    size_t recordCount;
+
+    // Vertices of all the sprites, and the range that hasn't been uploaded.
+    std::vector<VertexPositionColorTexture> vertices;
+    size_t dirtyBegin;
+    size_t dirtyEnd;
+
+    ComPtr<ID3D11Buffer> vertexBuffer;
+    size_t bufferCapacity;
+
+    std::vector<Run> runs;
+    bool runsChanged;
+};
+
+
 // Global pools of per-device and per-context SpriteBatch resources.
 SharedResourcePool<ID3D11Device*, SpriteBatch::Impl::DeviceResources> SpriteBatch::Impl::deviceResourcesPool;
 SharedResourcePool<ID3D11DeviceContext*, SpriteBatch::Impl::ContextResources> SpriteBatch::Impl::contextResourcesPool;
@@ -247,6 +497,13 @@ void SpriteBatch::Impl::DeviceResources::CreateShaders(_In_ ID3D11Device* device
                                    &vertexShader)
     );
     
+    ThrowIfFailed(
+        device->CreateVertexShader(SpriteEffect_SpriteVertexShaderTinted,
+                                   sizeof(SpriteEffect_SpriteVertexShaderTinted),
+                                   nullptr,
+                                   &tintedVertexShader)
+    );
+
     ThrowIfFailed(
         device->CreatePixelShader(SpriteEffect_SpritePixelShader,
                                   sizeof(SpriteEffect_SpritePixelShader),
@@ -262,7 +519,21 @@ void SpriteBatch::Impl::DeviceResources::CreateShaders(_In_ ID3D11Device* device
                                   &inputLayout)
     );
 
+    // The distance field shader uses screen-space derivatives, which Feature Level 9.1 and 9.2 lack.
+    if (device->GetFeatureLevel() >= D3D_FEATURE_LEVEL_9_3)
+    {
+        ThrowIfFailed(
+            device->CreatePixelShader(SpriteEffect_SpritePixelShaderDistanceField,
+                                      sizeof(SpriteEffect_SpritePixelShaderDistanceField),
+                                      nullptr,
+                                      &distanceFieldPixelShader)
+        );
+
+        SetDebugObjectName(distanceFieldPixelShader.Get(), "DirectXTK:SpriteBatch");
+    }
+
     SetDebugObjectName(vertexShader.Get(), "DirectXTK:SpriteBatch");
+    SetDebugObjectName(tintedVertexShader.Get(), "DirectXTK:SpriteBatch");
     SetDebugObjectName(pixelShader.Get(),  "DirectXTK:SpriteBatch");
     SetDebugObjectName(inputLayout.Get(),  "DirectXTK:SpriteBatch");
 }
@@ -318,6 +589,7 @@ std::vector<short> SpriteBatch::Impl::DeviceResources::CreateIndexValues()
 // Per-context constructor.
 SpriteBatch::Impl::ContextResources::ContextResources(_In_ ID3D11DeviceContext* context)
   :constantBuffer(GetDevice(context).Get()),
+    layerTintBuffer(GetDevice(context).Get()),
     vertexBufferPosition(0),
     inImmediateMode(false)
 {
@@ -374,9 +646,10 @@ SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
   : mRotation( DXGI_MODE_ROTATION_IDENTITY ),
     mSetViewport(false),
     mViewPort{},
-    mSpriteQueueCount(0),
-    mSpriteQueueArraySize(0),
+    mStats{},
     mInBeginEndPair(false),
+    mRecordingLayer(nullptr),
+    mDistanceFieldShaderSet(false),
     mSortMode(SpriteSortMode_Deferred),
     mTransformMatrix(MatrixIdentity),
     mDeviceResources(deviceResourcesPool.DemandCreate(GetDevice(deviceContext).Get())),
@@ -406,6 +679,8 @@ void XM_CALLCONV SpriteBatch::Impl::Begin(SpriteSortMode sortMode,
     mSetCustomShaders = setCustomShaders;
     mTransformMatrix = transformMatrix;
 
+    mStats = {};
+
     if (sortMode == SpriteSortMode_Immediate)
     {
         // If we are in immediate mode, set device state ready for drawing.
@@ -427,7 +702,13 @@ void SpriteBatch::Impl::End()
     if (!mInBeginEndPair)
         throw std::exception("Begin must be called before End");
 
-    if (mSortMode == SpriteSortMode_Immediate)
+    if (mRecordingLayer)
+    {
+        // Layers are drawn by DrawLayer, so there's nothing to draw yet.
+        mRecordingLayer->EndRecording();
+        mRecordingLayer = nullptr;
+    }
+    else if (mSortMode == SpriteSortMode_Immediate)
     {
         // If we are in immediate mode, sprites have already been drawn.
         mContextResources->inImmediateMode = false;
@@ -439,6 +720,7 @@ void SpriteBatch::Impl::End()
             throw std::exception("Cannot end one SpriteBatch while another is using SpriteSortMode_Immediate");
 
         PrepareForRendering();
+        MergeRecordedSprites();
         FlushBatch();
     }
 
@@ -465,14 +747,49 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
     if (!mInBeginEndPair)
         throw std::exception("Begin must be called before Draw");
 
+    if (mRecordingLayer)
+    {
+        SpriteInfo sprite;
+
+        WriteSprite(&sprite, destination, sourceRectangle, color, originRotationDepth, flags);
+
+        sprite.texture = texture;
+
+        mRecordingLayer->Record(sprite);
+        return;
+    }
+
     // Get a pointer to the output sprite.
-    if (mSpriteQueueCount >= mSpriteQueueArraySize)
+    SpriteInfo* sprite = mSpriteQueue.Allocate();
+
+    WriteSprite(sprite, destination, sourceRectangle, color, originRotationDepth, flags);
+
+    sprite->texture = texture;
+
+    mStats.sprites++;
+
+    if (mSortMode == SpriteSortMode_Immediate)
+    {
+        // If we are in immediate mode, draw this sprite straight away.
+        RenderBatch(texture, &sprite, 1);
+    }
+    else
     {
-        GrowSpriteQueue();
+        // Queue this sprite for later sorting and batched rendering.
+        mSpriteQueue.Commit(texture);
     }
+}
 
-    SpriteInfo* sprite = &mSpriteQueue[mSpriteQueueCount];
 
+// Fills in the parameters of a sprite, other than its texture.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::WriteSprite(SpriteInfo* sprite,
+    FXMVECTOR destination,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    FXMVECTOR originRotationDepth,
+    int flags)
+{
     XMVECTOR dest = destination;
 
     if (sourceRectangle)
@@ -503,214 +820,604 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
     XMStoreFloat4A(&sprite->color, color);
     XMStoreFloat4A(&sprite->originRotationDepth, originRotationDepth);
 
-    sprite->texture = texture;
     sprite->flags = flags;
-
-    if (mSortMode == SpriteSortMode_Immediate)
-    {
-        // If we are in immediate mode, draw this sprite straight away.
-        RenderBatch(texture, &sprite, 1);
-    }
-    else
-    {
-        // Queue this sprite for later sorting and batched rendering.
-        mSpriteQueueCount++;
-
-        // Make sure we hold a refcount on this texture until the sprite has been drawn. Only checking the
-        // back of the vector means we will add duplicate references if the caller switches back and forth
-        // between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
-        // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
-        if (mSpriteTextureReferences.empty() || texture != mSpriteTextureReferences.back().Get())
-        {
-            mSpriteTextureReferences.emplace_back(texture);
-        }
-    }
 }
 
 
-// Dynamically expands the array used to store pending sprite information.
-void SpriteBatch::Impl::GrowSpriteQueue()
+_Use_decl_annotations_
+void SpriteBatch::Impl::RegisterRecorder(SpriteQueue* queue)
 {
-    // Grow by a factor of 2.
-    size_t newSize = std::max(InitialQueueSize, mSpriteQueueArraySize * 2);
+    std::lock_guard<std::mutex> lock(mRecorderMutex);
 
-    // Allocate the new array.
-    std::unique_ptr<SpriteInfo[]> newArray(new SpriteInfo[newSize]);
+    mRecorderQueues.push_back(queue);
+}
 
-    // Copy over any existing sprites.
-    for (size_t i = 0; i < mSpriteQueueCount; i++)
-    {
-        newArray[i] = mSpriteQueue[i];
-    }
 
-    // Replace the previous array with the new one.
-    mSpriteQueue = std::move(newArray);
-    mSpriteQueueArraySize = newSize;
+_Use_decl_annotations_
+void SpriteBatch::Impl::UnregisterRecorder(SpriteQueue* queue)
+{
+    std::lock_guard<std::mutex> lock(mRecorderMutex);
 
-    // Clear any dangling SpriteInfo pointers left over from previous rendering.
-    mSortedSprites.clear();
+    mRecorderQueues.erase(std::remove(mRecorderQueues.begin(), mRecorderQueues.end(), queue), mRecorderQueues.end());
 }
 
 
-// Sets up D3D device state ready for drawing sprites.
-void SpriteBatch::Impl::PrepareForRendering()
+// Recorders only read the Begin state, which the caller must not change while they record.
+void SpriteBatch::Impl::CheckRecording() const
 {
-    auto deviceContext = mContextResources->deviceContext.Get();
+    if (!mInBeginEndPair)
+        throw std::exception("Begin must be called before Draw");
 
-    // Set state objects.
-    auto blendState        = mBlendState        ? mBlendState.Get()        : mDeviceResources->stateObjects.AlphaBlend();
-    auto depthStencilState = mDepthStencilState ? mDepthStencilState.Get() : mDeviceResources->stateObjects.DepthNone();
-    auto rasterizerState   = mRasterizerState   ? mRasterizerState.Get()   : mDeviceResources->stateObjects.CullCounterClockwise();
-    auto samplerState      = mSamplerState      ? mSamplerState.Get()      : mDeviceResources->stateObjects.LinearClamp();
+    if (mSortMode == SpriteSortMode_Immediate)
+        throw std::exception("SpriteBatch::Recorder cannot be used with SpriteSortMode_Immediate");
 
-    deviceContext->OMSetBlendState(blendState, nullptr, 0xFFFFFFFF);
-    deviceContext->OMSetDepthStencilState(depthStencilState, 0);
-    deviceContext->RSSetState(rasterizerState);
-    deviceContext->PSSetSamplers(0, 1, &samplerState);
+    if (mRecordingLayer)
+        throw std::exception("SpriteBatch::Recorder cannot be used while recording a layer");
+}
 
-    // Set shaders.
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    deviceContext->IASetInputLayout(mDeviceResources->inputLayout.Get());
-    deviceContext->VSSetShader(mDeviceResources->vertexShader.Get(), nullptr, 0);
-    deviceContext->PSSetShader(mDeviceResources->pixelShader.Get(), nullptr, 0);
 
-    // Set the vertex and index buffer.
-#if !defined(_XBOX_ONE) || !defined(_TITLE)
-    auto vertexBuffer = mContextResources->vertexBuffer.Get();
-    UINT vertexStride = sizeof(VertexPositionColorTexture);
-    UINT vertexOffset = 0;
+// Begins recording sprites into a layer.
+_Use_decl_annotations_
+void SpriteBatch::Impl::BeginLayer(Layer::Impl* layer)
+{
+    if (mInBeginEndPair)
+        throw std::exception("Cannot nest Begin calls on a single SpriteBatch");
 
-    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
-#endif
+    layer->BeginRecording();
 
-    deviceContext->IASetIndexBuffer(mDeviceResources->indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+    mRecordingLayer = layer;
+    mSortMode = SpriteSortMode_Deferred;
+    mInBeginEndPair = true;
+}
 
-    // Set the transform matrix.
-    XMMATRIX transformMatrix = (mRotation == DXGI_MODE_ROTATION_UNSPECIFIED)
-                               ? mTransformMatrix
-                               : ( mTransformMatrix * GetViewportTransform(deviceContext, mRotation) );
 
-#if defined(_XBOX_ONE) && defined(_TITLE)
-    void* grfxMemory;
-    mContextResources->constantBuffer.SetData(deviceContext, transformMatrix, &grfxMemory);
+// Draws a layer, after any sprites queued before it. The tint multiplies the recorded sprite colors,
+// and the transform is applied ahead of the one given to Begin.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::DrawLayer(Layer::Impl* layer, FXMVECTOR tint, FXMMATRIX transform)
+{
+    if (!mInBeginEndPair || mRecordingLayer)
+        throw std::exception("DrawLayer must be called between Begin and End");
 
-    deviceContext->VSSetPlacementConstantBuffer( 0, mContextResources->constantBuffer.GetBuffer(), grfxMemory );
-#else
-    mContextResources->constantBuffer.SetData(deviceContext, transformMatrix);
+    size_t count = layer->sprites.Size();
 
-    ID3D11Buffer* constantBuffer = mContextResources->constantBuffer.GetBuffer();
+    if (!count)
+        return;
 
-    deviceContext->VSSetConstantBuffers(0, 1, &constantBuffer);
-#endif
+    auto deviceContext = mContextResources->deviceContext.Get();
 
-    // If this is a deferred D3D context, reset position so the first Map call will use D3D11_MAP_WRITE_DISCARD.
-    if (deviceContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED)
+    if (mSortMode != SpriteSortMode_Immediate)
     {
-        mContextResources->vertexBufferPosition = 0;
-    }
+        if (mContextResources->inImmediateMode)
+            throw std::exception("Cannot draw a layer while another SpriteBatch is using SpriteSortMode_Immediate");
 
-    // Hook lets the caller replace our settings with their own custom shaders.
-    if (mSetCustomShaders)
-    {
-        mSetCustomShaders();
+        // Draw what was queued before the layer, which also sets the device state. Sprites from
+        // recorders are left for End, since their threads may still be recording.
+        PrepareForRendering();
+        FlushBatch();
     }
-}
 
+    UpdateLayer(layer);
 
-// Sends queued sprites to the graphics device.
-void SpriteBatch::Impl::FlushBatch()
-{
-    if (!mSpriteQueueCount)
-        return;
+    auto vertexBuffer = layer->vertexBuffer.Get();
+    UINT vertexStride = sizeof(VertexPositionColorTexture);
+    UINT vertexOffset = 0;
 
-    SortSprites();
+    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
 
-    // Walk through the sorted sprite list, looking for adjacent entries that share a texture.
-    ID3D11ShaderResourceView* batchTexture = nullptr;
-    size_t batchStart = 0;
+    SetTransform(deviceContext, XMMatrixMultiply(transform, mTransformMatrix));
+
+    // The tint is a shader constant, so the layer's vertices don't change with it. Custom shaders can
+    // read it from constant buffer b1.
+    SetLayerTint(deviceContext, tint);
 
-    for (size_t pos = 0; pos < mSpriteQueueCount; pos++)
+    if (!mSetCustomShaders)
     {
-        ID3D11ShaderResourceView* texture = mSortedSprites[pos]->texture;
+        deviceContext->VSSetShader(mDeviceResources->tintedVertexShader.Get(), nullptr, 0);
+    }
 
-        _Analysis_assume_(texture != nullptr);
+    for (auto it = layer->runs.cbegin(); it != layer->runs.cend(); ++it)
+    {
+        deviceContext->PSSetShaderResources(0, 1, &it->texture);
+
+        SetPixelShader(deviceContext, it->distanceField);
+
+        mStats.batches++;
 
-        // Flush whenever the texture changes.
-        if (texture != batchTexture)
+        // The shared index buffer covers MaxBatchSize sprites, so longer runs are drawn in pieces.
+        for (size_t start = it->start; start < it->start + it->count; start += MaxBatchSize)
         {
-            if (pos > batchStart)
-            {
-                RenderBatch(batchTexture, &mSortedSprites[batchStart], pos - batchStart);
-            }
+            size_t batchSize = std::min(size_t(MaxBatchSize), it->start + it->count - start);
 
-            batchTexture = texture;
-            batchStart = pos;
+            deviceContext->DrawIndexed(static_cast<UINT>(batchSize * IndicesPerSprite), 0, static_cast<INT>(start * VerticesPerSprite));
+
+            mStats.drawCalls++;
         }
     }
 
-    // Flush the final batch.
-    RenderBatch(batchTexture, &mSortedSprites[batchStart], mSpriteQueueCount - batchStart);
-
-    // Reset the queue.
-    mSpriteQueueCount = 0;
-    mSpriteTextureReferences.clear();
+    mStats.sprites += static_cast<uint32_t>(count);
 
-    // When sorting is disabled, we persist mSortedSprites data from one batch to the next, to avoid
-    // uneccessary work in GrowSortedSprites. But we never reuse these when sorting, because re-sorting
-    // previously sorted items gives unstable ordering if some sprites have identical sort keys.
-    if (mSortMode != SpriteSortMode_Deferred)
+    // Put back the batch's own vertex shader, vertex buffer and transform for the sprites that follow.
+    if (!mSetCustomShaders)
     {
-        mSortedSprites.clear();
+        deviceContext->VSSetShader(mDeviceResources->vertexShader.Get(), nullptr, 0);
     }
-}
+
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    vertexBuffer = mContextResources->vertexBuffer.Get();
+
+    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
+#endif
+
+    SetTransform(deviceContext, mTransformMatrix);
+}
+
+
+// Regenerates the vertices of the layer's dirty sprites and uploads them.
+_Use_decl_annotations_
+void SpriteBatch::Impl::UpdateLayer(Layer::Impl* layer)
+{
+    auto deviceContext = mContextResources->deviceContext.Get();
+
+    size_t count = layer->sprites.Size();
+    bool uploadAll = false;
+
+    if (count > layer->bufferCapacity)
+    {
+        size_t capacity = std::max<size_t>(std::max<size_t>(count, layer->bufferCapacity * 2), 64);
+
+        D3D11_BUFFER_DESC vertexBufferDesc = {};
+
+        vertexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(VertexPositionColorTexture) * capacity * VerticesPerSprite);
+        vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+        vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+
+        ThrowIfFailed(
+            GetDevice(deviceContext)->CreateBuffer(&vertexBufferDesc, nullptr, layer->vertexBuffer.ReleaseAndGetAddressOf())
+        );
+
+        SetDebugObjectName(layer->vertexBuffer.Get(), "DirectXTK:SpriteBatch::Layer");
+
+        layer->bufferCapacity = capacity;
+        layer->vertices.resize(capacity * VerticesPerSprite);
+
+        // Everything needs uploading to the new buffer, but only the dirty sprites need new vertices.
+        uploadAll = true;
+    }
+
+    // Regenerate vertices for the dirty sprites, reusing the texture size across runs of sprites.
+    ID3D11ShaderResourceView* texture = nullptr;
+    XMVECTOR textureSize = g_XMZero;
+    XMVECTOR inverseTextureSize = g_XMZero;
+
+    for (size_t i = layer->dirtyBegin; i < layer->dirtyEnd; i++)
+    {
+        auto& sprite = layer->sprites[i];
+
+        if (sprite.texture != texture)
+        {
+            texture = sprite.texture;
+            textureSize = GetTextureSize(texture);
+            inverseTextureSize = XMVectorReciprocal(textureSize);
+        }
+
+        RenderSprite(&sprite, &layer->vertices[i * VerticesPerSprite], textureSize, inverseTextureSize);
+    }
+
+    // Upload the dirty range, or everything into a new buffer.
+    size_t uploadBegin = uploadAll ? 0 : layer->dirtyBegin;
+    size_t uploadEnd = uploadAll ? count : layer->dirtyEnd;
+
+    if (uploadBegin < uploadEnd)
+    {
+        auto source = &layer->vertices[uploadBegin * VerticesPerSprite];
+
+        D3D11_BOX box = {};
+        box.left = static_cast<UINT>(uploadBegin * VerticesPerSprite * sizeof(VertexPositionColorTexture));
+        box.right = static_cast<UINT>(uploadEnd * VerticesPerSprite * sizeof(VertexPositionColorTexture));
+        box.bottom = 1;
+        box.back = 1;
+
+        deviceContext->UpdateSubresource(layer->vertexBuffer.Get(), 0, &box, source, 0, 0);
+
+        mStats.vertexBytes += box.right - box.left;
+    }
+
+    layer->dirtyBegin = layer->dirtyEnd = 0;
+
+    // Rebuild the texture runs if textures were added, removed or changed.
+    if (layer->runsChanged)
+    {
+        layer->runs.clear();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto spriteTexture = layer->sprites[i].texture;
+            bool distanceField = (layer->sprites[i].flags & SpriteEffects_DistanceField) != 0;
+
+            if (layer->runs.empty() || layer->runs.back().texture != spriteTexture || layer->runs.back().distanceField != distanceField)
+            {
+                Layer::Impl::Run run = { spriteTexture, distanceField, i, 0 };
+                layer->runs.push_back(run);
+            }
+
+            layer->runs.back().count++;
+        }
+
+        layer->runsChanged = false;
+    }
+}
+
+
+// Appends the sprites recorded on other threads to the queue, in recorder creation order. Each
+// recorder's sprites are copied into their own range of the queue, on separate threads when
+// there are enough of them to be worth it.
+void SpriteBatch::Impl::MergeRecordedSprites()
+{
+    std::lock_guard<std::mutex> lock(mRecorderMutex);
+
+    size_t queueCount = mSpriteQueue.Size();
+    size_t recordedCount = 0;
+
+    for (auto it = mRecorderQueues.cbegin(); it != mRecorderQueues.cend(); ++it)
+    {
+        recordedCount += (*it)->Size();
+    }
+
+    if (!recordedCount)
+        return;
+
+    mSpriteQueue.Resize(queueCount + recordedCount);
+
+    std::vector<size_t> offsets;
+    offsets.reserve(mRecorderQueues.size());
+
+    for (auto it = mRecorderQueues.cbegin(); it != mRecorderQueues.cend(); ++it)
+    {
+        offsets.push_back(queueCount);
+        queueCount += (*it)->Size();
+    }
+
+    auto copyQueue = [&](size_t j)
+    {
+        SpriteQueue const& source = *mRecorderQueues[j];
+        size_t offset = offsets[j];
+
+        for (size_t i = 0; i < source.Size(); i++)
+        {
+            mSpriteQueue[offset + i] = source[i];
+        }
+    };
+
+    size_t threadCount = (recordedCount >= ParallelMergeSize) ? std::min(size_t(std::max(1u, std::thread::hardware_concurrency())), size_t(MaxMergeThreads)) : 1;
+
+    if (threadCount > 1 && mRecorderQueues.size() > 1)
+    {
+        // Threads take recorders in turn; this thread takes the first share.
+        auto copyShare = [&](size_t first)
+        {
+            for (size_t j = first; j < mRecorderQueues.size(); j += threadCount)
+            {
+                copyQueue(j);
+            }
+        };
+
+        threadCount = std::min(threadCount, mRecorderQueues.size());
+
+        std::vector<std::thread> threads;
+        for (size_t j = 1; j < threadCount; ++j)
+        {
+            try
+            {
+                threads.emplace_back(copyShare, j);
+            }
+            catch (const std::system_error&)
+            {
+                // Out of threads, so copy this share here instead
+                copyShare(j);
+            }
+        }
+
+        copyShare(0);
+
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+    else
+    {
+        for (size_t j = 0; j < mRecorderQueues.size(); ++j)
+        {
+            copyQueue(j);
+        }
+    }
+
+    // Take over the texture references and reset the recorders for the next batch.
+    for (auto it = mRecorderQueues.begin(); it != mRecorderQueues.end(); ++it)
+    {
+        auto& references = (*it)->textureReferences;
+
+        mSpriteQueue.textureReferences.insert(mSpriteQueue.textureReferences.end(),
+                                              std::make_move_iterator(references.begin()),
+                                              std::make_move_iterator(references.end()));
+
+        (*it)->Clear();
+    }
+
+    mStats.sprites += static_cast<uint32_t>(recordedCount);
+}
+
+
+// Sets up D3D device state ready for drawing sprites.
+void SpriteBatch::Impl::PrepareForRendering()
+{
+    auto deviceContext = mContextResources->deviceContext.Get();
+
+    // Set state objects.
+    auto blendState        = mBlendState        ? mBlendState.Get()        : mDeviceResources->stateObjects.AlphaBlend();
+    auto depthStencilState = mDepthStencilState ? mDepthStencilState.Get() : mDeviceResources->stateObjects.DepthNone();
+    auto rasterizerState   = mRasterizerState   ? mRasterizerState.Get()   : mDeviceResources->stateObjects.CullCounterClockwise();
+    auto samplerState      = mSamplerState      ? mSamplerState.Get()      : mDeviceResources->stateObjects.LinearClamp();
+
+    deviceContext->OMSetBlendState(blendState, nullptr, 0xFFFFFFFF);
+    deviceContext->OMSetDepthStencilState(depthStencilState, 0);
+    deviceContext->RSSetState(rasterizerState);
+    deviceContext->PSSetSamplers(0, 1, &samplerState);
+
+    // Set shaders.
+    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    deviceContext->IASetInputLayout(mDeviceResources->inputLayout.Get());
+    deviceContext->VSSetShader(mDeviceResources->vertexShader.Get(), nullptr, 0);
+    deviceContext->PSSetShader(mDeviceResources->pixelShader.Get(), nullptr, 0);
+
+    mDistanceFieldShaderSet = false;
+
+    // Set the vertex and index buffer.
+#if !defined(_XBOX_ONE) || !defined(_TITLE)
+    auto vertexBuffer = mContextResources->vertexBuffer.Get();
+    UINT vertexStride = sizeof(VertexPositionColorTexture);
+    UINT vertexOffset = 0;
+
+    deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &vertexStride, &vertexOffset);
+#endif
+
+    deviceContext->IASetIndexBuffer(mDeviceResources->indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+
+    // Set the transform matrix.
+    SetTransform(deviceContext, mTransformMatrix);
+
+    // If this is a deferred D3D context, reset position so the first Map call will use D3D11_MAP_WRITE_DISCARD.
+    if (deviceContext->GetType() == D3D11_DEVICE_CONTEXT_DEFERRED)
+    {
+        mContextResources->vertexBufferPosition = 0;
+    }
+
+    // Hook lets the caller replace our settings with their own custom shaders.
+    if (mSetCustomShaders)
+    {
+        mSetCustomShaders();
+    }
+}
+
+
+// Sets the matrix the sprite vertex shader transforms positions by.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::SetTransform(ID3D11DeviceContext* deviceContext, FXMMATRIX transformMatrix)
+{
+    XMMATRIX transform = (mRotation == DXGI_MODE_ROTATION_UNSPECIFIED)
+                         ? transformMatrix
+                         : ( transformMatrix * GetViewportTransform(deviceContext, mRotation) );
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    void* grfxMemory;
+    mContextResources->constantBuffer.SetData(deviceContext, transform, &grfxMemory);
+
+    deviceContext->VSSetPlacementConstantBuffer( 0, mContextResources->constantBuffer.GetBuffer(), grfxMemory );
+#else
+    mContextResources->constantBuffer.SetData(deviceContext, transform);
+
+    ID3D11Buffer* constantBuffer = mContextResources->constantBuffer.GetBuffer();
+
+    deviceContext->VSSetConstantBuffers(0, 1, &constantBuffer);
+#endif
+}
+
+
+// Sets the color the tinted sprite vertex shader multiplies layer vertex colors by.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::SetLayerTint(ID3D11DeviceContext* deviceContext, FXMVECTOR tint)
+{
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    void* grfxMemory;
+    mContextResources->layerTintBuffer.SetData(deviceContext, tint, &grfxMemory);
+
+    deviceContext->VSSetPlacementConstantBuffer( 1, mContextResources->layerTintBuffer.GetBuffer(), grfxMemory );
+#else
+    mContextResources->layerTintBuffer.SetData(deviceContext, tint);
+
+    ID3D11Buffer* constantBuffer = mContextResources->layerTintBuffer.GetBuffer();
+
+    deviceContext->VSSetConstantBuffers(1, 1, &constantBuffer);
+#endif
+}
+
+
+// Switches between the regular and distance field pixel shaders, unless the caller has replaced ours.
+_Use_decl_annotations_
+void SpriteBatch::Impl::SetPixelShader(ID3D11DeviceContext* deviceContext, bool distanceField)
+{
+    if (mSetCustomShaders || distanceField == mDistanceFieldShaderSet)
+        return;
+
+    if (distanceField && !mDeviceResources->distanceFieldPixelShader)
+        throw std::exception("SpriteEffects_DistanceField requires Feature Level 9.3 or later");
+
+    deviceContext->PSSetShader(distanceField ? mDeviceResources->distanceFieldPixelShader.Get()
+                                             : mDeviceResources->pixelShader.Get(), nullptr, 0);
+
+    mDistanceFieldShaderSet = distanceField;
+}
+
+
+// Sends queued sprites to the graphics device.
+void SpriteBatch::Impl::FlushBatch()
+{
+    if (!mSpriteQueue.Size())
+        return;
+
+    SortSprites();
+
+    // Walk through the sorted sprite list, looking for adjacent entries that share a texture and pixel shader.
+    ID3D11ShaderResourceView* batchTexture = nullptr;
+    int batchDistanceField = 0;
+    size_t batchStart = 0;
+
+    size_t count = mSpriteQueue.Size();
+
+    for (size_t pos = 0; pos < count; pos++)
+    {
+        ID3D11ShaderResourceView* texture = mSortedSprites[pos]->texture;
+        int distanceField = mSortedSprites[pos]->flags & SpriteEffects_DistanceField;
+
+        _Analysis_assume_(texture != nullptr);
+
+        // Flush whenever the texture or shader changes.
+        if (texture != batchTexture || distanceField != batchDistanceField)
+        {
+            if (pos > batchStart)
+            {
+                RenderBatch(batchTexture, &mSortedSprites[batchStart], pos - batchStart);
+            }
+
+            batchTexture = texture;
+            batchDistanceField = distanceField;
+            batchStart = pos;
+        }
+    }
+
+    // Flush the final batch.
+    RenderBatch(batchTexture, &mSortedSprites[batchStart], count - batchStart);
+
+    // Reset the queue.
+    mSpriteQueue.Clear();
+
+    // When sorting is disabled, we persist mSortedSprites data from one batch to the next, to avoid
+    // uneccessary work in GrowSortedSprites. But we never reuse these when sorting, because re-sorting
+    // previously sorted items gives unstable ordering if some sprites have identical sort keys.
+    if (mSortMode != SpriteSortMode_Deferred)
+    {
+        mSortedSprites.clear();
+    }
+}
 
 
 // Sorts the array of queued sprites.
+//
+// Rather than comparing SpriteInfo pointers, each sprite gets a 64-bit key holding its sort value
+// above its queue index, and the keys are radix sorted. Keys start out in queue order and the sort is
+// stable, so sprites with equal sort values are drawn in the order they were queued.
 void SpriteBatch::Impl::SortSprites()
 {
-    // Fill the mSortedSprites vector.
-    if (mSortedSprites.size() < mSpriteQueueCount)
+    if (mSortMode != SpriteSortMode_Texture &&
+        mSortMode != SpriteSortMode_BackToFront &&
+        mSortMode != SpriteSortMode_FrontToBack)
     {
-        GrowSortedSprites();
+        // Fill the mSortedSprites vector.
+        if (mSortedSprites.size() < mSpriteQueue.Size())
+        {
+            GrowSortedSprites();
+        }
+        return;
     }
 
+    size_t count = mSpriteQueue.Size();
+
+    assert(count <= UINT32_MAX);
+
+    mSortKeys.resize(count);
+    mSortScratch.resize(count);
+
+    uint64_t* keys = mSortKeys.data();
+
     switch (mSortMode)
     {
         case SpriteSortMode_Texture:
-            // Sort by texture.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
             {
-                return x->texture < y->texture;
-            });
+                // Number the distinct textures in pointer order. The queue's texture references already list
+                // each change of texture, so lookups are only needed where the texture changes.
+                mSortTextures.clear();
+
+                for (auto it = mSpriteQueue.textureReferences.cbegin(); it != mSpriteQueue.textureReferences.cend(); ++it)
+                {
+                    mSortTextures.push_back(it->Get());
+                }
+
+                std::sort(mSortTextures.begin(), mSortTextures.end());
+                mSortTextures.erase(std::unique(mSortTextures.begin(), mSortTextures.end()), mSortTextures.end());
+
+                ID3D11ShaderResourceView* texture = nullptr;
+                uint64_t textureKey = 0;
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (mSpriteQueue[i].texture != texture)
+                    {
+                        texture = mSpriteQueue[i].texture;
+
+                        auto id = std::lower_bound(mSortTextures.cbegin(), mSortTextures.cend(), texture) - mSortTextures.cbegin();
+                        textureKey = static_cast<uint64_t>(id) << 32;
+                    }
+
+                    keys[i] = textureKey | i;
+                }
+            }
             break;
 
         case SpriteSortMode_BackToFront:
             // Sort back to front.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            for (size_t i = 0; i < count; i++)
             {
-                return x->originRotationDepth.w > y->originRotationDepth.w;
-            });
+                uint32_t depthKey = ~SpriteSorting::GetDepthSortKey(mSpriteQueue[i].originRotationDepth.w);
+
+                keys[i] = (static_cast<uint64_t>(depthKey) << 32) | i;
+            }
             break;
 
         case SpriteSortMode_FrontToBack:
             // Sort front to back.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + mSpriteQueueCount, [](SpriteInfo const* x, SpriteInfo const* y) -> bool
+            for (size_t i = 0; i < count; i++)
             {
-                return x->originRotationDepth.w < y->originRotationDepth.w;
-            });
+                uint32_t depthKey = SpriteSorting::GetDepthSortKey(mSpriteQueue[i].originRotationDepth.w);
+
+                keys[i] = (static_cast<uint64_t>(depthKey) << 32) | i;
+            }
             break;
     }
+
+    keys = SpriteSorting::RadixSortKeys(keys, mSortScratch.data(), count);
+
+    if (mSortedSprites.size() < count)
+    {
+        mSortedSprites.resize(count);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        mSortedSprites[i] = &mSpriteQueue[static_cast<uint32_t>(keys[i])];
+    }
 }
 
 
-// Populates the mSortedSprites vector with pointers to individual elements of the mSpriteQueue array.
+// Populates the mSortedSprites vector with pointers to individual elements of the mSpriteQueue blocks.
 void SpriteBatch::Impl::GrowSortedSprites()
 {
     size_t previousSize = mSortedSprites.size();
+    size_t count = mSpriteQueue.Size();
 
-    mSortedSprites.resize(mSpriteQueueCount);
+    mSortedSprites.resize(count);
 
-    for (size_t i = previousSize; i < mSpriteQueueCount; i++)
+    for (size_t i = previousSize; i < count; i++)
     {
         mSortedSprites[i] = &mSpriteQueue[i];
     }
@@ -726,8 +1433,12 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
     // Draw using the specified texture.
     deviceContext->PSSetShaderResources(0, 1, &texture);
 
+    SetPixelShader(deviceContext, (sprites[0]->flags & SpriteEffects_DistanceField) != 0);
+
     XMVECTOR textureSize = GetTextureSize(texture);
     XMVECTOR inverseTextureSize = XMVectorReciprocal(textureSize);
+
+    mStats.batches++;
             
     while (count > 0)
     {
@@ -744,7 +1455,7 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
                 // If we are out of room, or about to submit an excessively small batch, wrap back to the start of the vertex buffer.
                 mContextResources->vertexBufferPosition = 0;
 
-                batchSize = std::min(count, MaxBatchSize);
+                batchSize = std::min(count, size_t(MaxBatchSize));
             }
             else
             {
@@ -770,8 +1481,26 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
         auto vertices = static_cast<VertexPositionColorTexture*>(mappedBuffer.pData) + mContextResources->vertexBufferPosition * VerticesPerSprite;
 #endif
 
-        // Generate sprite vertex data.
-        for (size_t i = 0; i < batchSize; i++)
+        // Generate sprite vertex data, four sprites at a time while the output is 16-byte aligned.
+        size_t i = 0;
+
+        if (!(reinterpret_cast<uintptr_t>(vertices) & 15))
+        {
+            for (; i + SpritesPerGroup <= batchSize; i += SpritesPerGroup)
+            {
+                assert(i + SpritesPerGroup <= count);
+                _Analysis_assume_(i + SpritesPerGroup <= count);
+                RenderSprites(&sprites[i], vertices, textureSize, inverseTextureSize);
+
+                vertices += SpritesPerGroup * VerticesPerSprite;
+            }
+
+#if defined(_XM_SSE_INTRINSICS_)
+            _mm_sfence();
+#endif
+        }
+
+        for (; i < batchSize; i++)
         {
             assert(i < count);
             _Analysis_assume_(i < count);
@@ -792,6 +1521,9 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
 
         deviceContext->DrawIndexed(indexCount, startIndex, 0);
 
+        mStats.drawCalls++;
+        mStats.vertexBytes += static_cast<uint32_t>(sizeof(VertexPositionColorTexture) * batchSize * VerticesPerSprite);
+
         // Advance the buffer position.
 #if !defined(_XBOX_ONE) || !defined(_TITLE)
         mContextResources->vertexBufferPosition += batchSize;
@@ -918,6 +1650,158 @@ void XM_CALLCONV SpriteBatch::Impl::RenderSprite(SpriteInfo const* sprite,
 }
 
 
+// Generates vertex data for four sprites at once. The sprites are transposed so each vector holds
+// one value from all four, and every lane goes through the same DirectXMath operations as
+// RenderSprite does, so the output is bit-for-bit the same. Each sprite's four vertices make
+// nine aligned vectors, which are streamed straight to the (write-combined) vertex buffer.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::RenderSprites(SpriteInfo const* const* sprites,
+    VertexPositionColorTexture* vertices,
+    FXMVECTOR textureSize,
+    FXMVECTOR inverseTextureSize)
+{
+    static_assert(sizeof(VertexPositionColorTexture) * VerticesPerSprite == 9 * sizeof(XMFLOAT4A), "Vertex layout must match the streamed vectors");
+    static_assert(SpritesPerGroup == 4, "RenderSprites transposes groups of four sprites");
+
+    SpriteInfo const* s0 = sprites[0];
+    SpriteInfo const* s1 = sprites[1];
+    SpriteInfo const* s2 = sprites[2];
+    SpriteInfo const* s3 = sprites[3];
+
+    // Load sprite parameters transposed: source.r[0] holds the four source x values, and so on.
+    XMMATRIX source = XMMatrixTranspose(XMMATRIX(XMLoadFloat4A(&s0->source), XMLoadFloat4A(&s1->source),
+                                                 XMLoadFloat4A(&s2->source), XMLoadFloat4A(&s3->source)));
+    XMMATRIX destination = XMMatrixTranspose(XMMATRIX(XMLoadFloat4A(&s0->destination), XMLoadFloat4A(&s1->destination),
+                                                      XMLoadFloat4A(&s2->destination), XMLoadFloat4A(&s3->destination)));
+    XMMATRIX originRotationDepth = XMMatrixTranspose(XMMATRIX(XMLoadFloat4A(&s0->originRotationDepth), XMLoadFloat4A(&s1->originRotationDepth),
+                                                              XMLoadFloat4A(&s2->originRotationDepth), XMLoadFloat4A(&s3->originRotationDepth)));
+
+    XMVECTOR sourceInTexels = XMVectorSelectControl((s0->flags & SpriteInfo::SourceInTexels) != 0, (s1->flags & SpriteInfo::SourceInTexels) != 0,
+                                                    (s2->flags & SpriteInfo::SourceInTexels) != 0, (s3->flags & SpriteInfo::SourceInTexels) != 0);
+    XMVECTOR destSizeInPixels = XMVectorSelectControl((s0->flags & SpriteInfo::DestSizeInPixels) != 0, (s1->flags & SpriteInfo::DestSizeInPixels) != 0,
+                                                      (s2->flags & SpriteInfo::DestSizeInPixels) != 0, (s3->flags & SpriteInfo::DestSizeInPixels) != 0);
+    XMVECTOR flipHorizontally = XMVectorSelectControl((s0->flags & SpriteEffects_FlipHorizontally) != 0, (s1->flags & SpriteEffects_FlipHorizontally) != 0,
+                                                      (s2->flags & SpriteEffects_FlipHorizontally) != 0, (s3->flags & SpriteEffects_FlipHorizontally) != 0);
+    XMVECTOR flipVertically = XMVectorSelectControl((s0->flags & SpriteEffects_FlipVertically) != 0, (s1->flags & SpriteEffects_FlipVertically) != 0,
+                                                    (s2->flags & SpriteEffects_FlipVertically) != 0, (s3->flags & SpriteEffects_FlipVertically) != 0);
+
+    XMVECTOR textureWidth = XMVectorSplatX(textureSize);
+    XMVECTOR textureHeight = XMVectorSplatY(textureSize);
+    XMVECTOR inverseTextureWidth = XMVectorSplatX(inverseTextureSize);
+    XMVECTOR inverseTextureHeight = XMVectorSplatY(inverseTextureSize);
+
+    XMVECTOR sourceX = source.r[0];
+    XMVECTOR sourceY = source.r[1];
+    XMVECTOR sourceWidth = source.r[2];
+    XMVECTOR sourceHeight = source.r[3];
+
+    XMVECTOR destinationWidth = destination.r[2];
+    XMVECTOR destinationHeight = destination.r[3];
+
+    // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+    XMVECTOR zero = XMVectorZero();
+    XMVECTOR originX = XMVectorDivide(originRotationDepth.r[0], XMVectorSelect(sourceWidth, g_XMEpsilon, XMVectorEqual(sourceWidth, zero)));
+    XMVECTOR originY = XMVectorDivide(originRotationDepth.r[1], XMVectorSelect(sourceHeight, g_XMEpsilon, XMVectorEqual(sourceHeight, zero)));
+
+    // Convert the source region from texels to mod-1 texture coordinate format.
+    sourceX = XMVectorSelect(sourceX, sourceX * inverseTextureWidth, sourceInTexels);
+    sourceY = XMVectorSelect(sourceY, sourceY * inverseTextureHeight, sourceInTexels);
+    sourceWidth = XMVectorSelect(sourceWidth, sourceWidth * inverseTextureWidth, sourceInTexels);
+    sourceHeight = XMVectorSelect(sourceHeight, sourceHeight * inverseTextureHeight, sourceInTexels);
+    originX = XMVectorSelect(originX * inverseTextureWidth, originX, sourceInTexels);
+    originY = XMVectorSelect(originY * inverseTextureHeight, originY, sourceInTexels);
+
+    // If the destination size is relative to the source region, convert it to pixels.
+    destinationWidth = XMVectorSelect(destinationWidth * textureWidth, destinationWidth, destSizeInPixels);
+    destinationHeight = XMVectorSelect(destinationHeight * textureHeight, destinationHeight, destSizeInPixels);
+
+    // Compute the 2x2 rotation matrices. Unrotated sprites use the identity rows, including the +0
+    // that RenderSprite has in place of -sin.
+    XMFLOAT4A sinValues(0, 0, 0, 0);
+    XMFLOAT4A cosValues(1, 1, 1, 1);
+    XMFLOAT4A rotationValues;
+
+    XMStoreFloat4A(&rotationValues, originRotationDepth.r[2]);
+
+    if (rotationValues.x != 0)
+        XMScalarSinCos(&sinValues.x, &cosValues.x, rotationValues.x);
+    if (rotationValues.y != 0)
+        XMScalarSinCos(&sinValues.y, &cosValues.y, rotationValues.y);
+    if (rotationValues.z != 0)
+        XMScalarSinCos(&sinValues.z, &cosValues.z, rotationValues.z);
+    if (rotationValues.w != 0)
+        XMScalarSinCos(&sinValues.w, &cosValues.w, rotationValues.w);
+
+    XMVECTOR sinV = XMLoadFloat4A(&sinValues);
+    XMVECTOR cosV = XMLoadFloat4A(&cosValues);
+    XMVECTOR negativeSinV = XMVectorSelect(-sinV, zero, XMVectorEqual(originRotationDepth.r[2], zero));
+
+    // Generate the four corners of all four sprites, then transpose back to one row per sprite.
+    XMVECTOR one = XMVectorSplatOne();
+
+    XMMATRIX positionX, positionY, textureU, textureV;
+
+    for (size_t i = 0; i < VerticesPerSprite; i++)
+    {
+        XMVECTOR cornerX = (i & 1) ? one : zero;
+        XMVECTOR cornerY = (i & 2) ? one : zero;
+
+        // Calculate position.
+        XMVECTOR cornerOffsetX = (cornerX - originX) * destinationWidth;
+        XMVECTOR cornerOffsetY = (cornerY - originY) * destinationHeight;
+
+        // Apply 2x2 rotation matrix.
+        XMVECTOR position1X = XMVectorMultiplyAdd(cornerOffsetX, cosV, destination.r[0]);
+        XMVECTOR position1Y = XMVectorMultiplyAdd(cornerOffsetX, sinV, destination.r[1]);
+
+        positionX.r[i] = XMVectorMultiplyAdd(cornerOffsetY, negativeSinV, position1X);
+        positionY.r[i] = XMVectorMultiplyAdd(cornerOffsetY, cosV, position1Y);
+
+        // Compute the texture coordinate from the mirrored corner.
+        XMVECTOR mirrorX = XMVectorSelect(cornerX, (i & 1) ? zero : one, flipHorizontally);
+        XMVECTOR mirrorY = XMVectorSelect(cornerY, (i & 2) ? zero : one, flipVertically);
+
+        textureU.r[i] = XMVectorMultiplyAdd(mirrorX, sourceWidth, sourceX);
+        textureV.r[i] = XMVectorMultiplyAdd(mirrorY, sourceHeight, sourceY);
+    }
+
+    positionX = XMMatrixTranspose(positionX);
+    positionY = XMMatrixTranspose(positionY);
+    textureU = XMMatrixTranspose(textureU);
+    textureV = XMMatrixTranspose(textureV);
+
+    auto output = reinterpret_cast<XMFLOAT4A*>(vertices);
+
+    for (size_t j = 0; j < SpritesPerGroup; j++)
+    {
+        XMVECTOR color = XMLoadFloat4A(&sprites[j]->color);
+
+        // Each vertex is position.xyz, color.rgba, textureCoordinate.xy.
+        XMVECTOR xy01 = XMVectorMergeXY(positionX.r[j], positionY.r[j]);
+        XMVECTOR xy23 = XMVectorMergeZW(positionX.r[j], positionY.r[j]);
+        XMVECTOR uv01 = XMVectorMergeXY(textureU.r[j], textureV.r[j]);
+        XMVECTOR uv23 = XMVectorMergeZW(textureU.r[j], textureV.r[j]);
+
+        XMVECTOR zrgb = XMVectorPermute<4, 0, 1, 2>(color, XMVectorReplicatePtr(&sprites[j]->originRotationDepth.w));
+
+        XMVECTOR xyzz = XMVectorPermute<2, 3, 4, 4>(xy01, zrgb);
+        XMVECTOR uvxy = XMVectorPermute<0, 1, 6, 7>(uv23, xy23);
+
+        StreamFloat4A(output + 0, XMVectorPermute<0, 1, 4, 5>(xy01, zrgb));     // x0 y0 z  r
+        StreamFloat4A(output + 1, XMVectorPermute<1, 2, 3, 4>(color, uv01));    // g  b  a  u0
+        StreamFloat4A(output + 2, XMVectorPermute<1, 4, 5, 6>(uv01, xyzz));     // v0 x1 y1 z
+        StreamFloat4A(output + 3, color);                                       // r  g  b  a
+        StreamFloat4A(output + 4, XMVectorPermute<2, 3, 4, 5>(uv01, xy23));     // u1 v1 x2 y2
+        StreamFloat4A(output + 5, zrgb);                                        // z  r  g  b
+        StreamFloat4A(output + 6, XMVectorPermute<3, 4, 5, 6>(color, uvxy));    // a  u2 v2 x3
+        StreamFloat4A(output + 7, XMVectorPermute<3, 4, 5, 6>(xy23, zrgb));     // y3 z  r  g
+        StreamFloat4A(output + 8, XMVectorPermute<2, 3, 6, 7>(color, uv23));    // b  a  u3 v3
+
+        output += 9;
+    }
+}
+
+
 // Helper looks up the size of the specified texture.
 XMVECTOR SpriteBatch::Impl::GetTextureSize(_In_ ID3D11ShaderResourceView* texture)
 {
@@ -1195,3 +2079,261 @@ void SpriteBatch::SetViewport( const D3D11_VIEWPORT& viewPort )
     pImpl->mSetViewport = true;
     pImpl->mViewPort = viewPort;
 }
+
+
+const SpriteBatch::Statistics& SpriteBatch::GetStatistics() const
+{
+    return pImpl->mStats;
+}
+
+
+void SpriteBatch::Begin(Layer& layer)
+{
+    pImpl->BeginLayer(layer.pImpl.get());
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::DrawLayer(Layer& layer, FXMVECTOR tint, FXMMATRIX transform)
+{
+    pImpl->DrawLayer(layer.pImpl.get(), tint, transform);
+}
+
+
+// Public constructor.
+SpriteBatch::Layer::Layer()
+  : pImpl(new Impl())
+{
+}
+
+
+// Move constructor.
+SpriteBatch::Layer::Layer(Layer&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+SpriteBatch::Layer& SpriteBatch::Layer::operator= (Layer&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+SpriteBatch::Layer::~Layer()
+{
+}
+
+
+size_t SpriteBatch::Layer::GetSpriteCount() const
+{
+    return pImpl->sprites.Size();
+}
+
+
+void SpriteBatch::Layer::ReleaseDeviceResources()
+{
+    pImpl->vertexBuffer.Reset();
+    pImpl->bufferCapacity = 0;
+}
+
+
+// Internal SpriteBatch::Recorder implementation class.
+class SpriteBatch::Recorder::Impl
+{
+public:
+    Impl(_In_ SpriteBatch::Impl* batch)
+      : mBatch(batch)
+    {
+        mBatch->RegisterRecorder(&mQueue);
+    }
+
+    ~Impl()
+    {
+        mBatch->UnregisterRecorder(&mQueue);
+    }
+
+    Impl(Impl const&) = delete;
+    Impl& operator= (Impl const&) = delete;
+
+    void XM_CALLCONV Draw(_In_ ID3D11ShaderResourceView* texture,
+        FXMVECTOR destination,
+        _In_opt_ RECT const* sourceRectangle,
+        FXMVECTOR color,
+        FXMVECTOR originRotationDepth,
+        int flags)
+    {
+        if (!texture)
+            throw std::exception("Texture cannot be null");
+
+        mBatch->CheckRecording();
+
+        auto sprite = mQueue.Allocate();
+
+        SpriteBatch::Impl::WriteSprite(sprite, destination, sourceRectangle, color, originRotationDepth, flags);
+
+        sprite->texture = texture;
+
+        mQueue.Commit(texture);
+    }
+
+private:
+    SpriteBatch::Impl* mBatch;
+    SpriteBatch::Impl::SpriteQueue mQueue;
+};
+
+
+// Public constructor.
+SpriteBatch::Recorder::Recorder(SpriteBatch& batch)
+  : pImpl(new Impl(batch.pImpl.get()))
+{
+}
+
+
+// Move constructor.
+SpriteBatch::Recorder::Recorder(Recorder&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+SpriteBatch::Recorder& SpriteBatch::Recorder::operator= (Recorder&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+SpriteBatch::Recorder::~Recorder()
+{
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture, XMFLOAT2 const& position, FXMVECTOR color)
+{
+    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), g_XMOne); // x, y, 1, 1
+    
+    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    XMFLOAT2 const& position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    float scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(XMLoadFloat2(&position), XMLoadFloat(&scale)); // x, y, scale, scale
+    
+    XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    XMFLOAT2 const& position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    XMFLOAT2 const& scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&position), XMLoadFloat2(&scale)); // x, y, scale.x, scale.y
+    
+    XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+    
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture, FXMVECTOR position, FXMVECTOR color)
+{
+    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, g_XMOne); // x, y, 1, 1
+    
+    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, 0);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    FXMVECTOR position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR origin,
+    float scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    XMVECTOR destination = XMVectorPermute<0, 1, 4, 4>(position, XMLoadFloat(&scale)); // x, y, scale, scale
+
+    XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
+
+    XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
+    
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    FXMVECTOR position,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    FXMVECTOR origin,
+    GXMVECTOR scale,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    XMVECTOR destination = XMVectorPermute<0, 1, 4, 5>(position, scale); // x, y, scale.x, scale.y
+    
+    XMVECTOR rotationDepth = XMVectorMergeXY(XMVectorReplicate(rotation), XMVectorReplicate(layerDepth));
+
+    XMVECTOR originRotationDepth = XMVectorPermute<0, 1, 4, 5>(origin, rotationDepth);
+
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture, RECT const& destinationRectangle, FXMVECTOR color)
+{
+    XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
+
+    pImpl->Draw(texture, destination, nullptr, color, g_XMZero, SpriteBatch::Impl::SpriteInfo::DestSizeInPixels);
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Recorder::Draw(ID3D11ShaderResourceView* texture,
+    RECT const& destinationRectangle,
+    RECT const* sourceRectangle,
+    FXMVECTOR color,
+    float rotation,
+    XMFLOAT2 const& origin,
+    SpriteEffects effects,
+    float layerDepth)
+{
+    XMVECTOR destination = LoadRect(&destinationRectangle); // x, y, w, h
+
+    XMVECTOR originRotationDepth = XMVectorSet(origin.x, origin.y, rotation, layerDepth);
+    
+    pImpl->Draw(texture, destination, sourceRectangle, color, originRotationDepth, effects | SpriteBatch::Impl::SpriteInfo::DestSizeInPixels);
+}
@@ -14,6 +14,10 @@
 #include "pch.h"
 
 #include <algorithm>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "SpriteFont.h"
@@ -29,22 +33,69 @@ using Microsoft::WRL::ComPtr;
 class SpriteFont::Impl
 {
 public:
-    Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, bool forceSRGB);
+    Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, bool forceSRGB, ScopedMappedView&& mappedFile = ScopedMappedView());
     Impl(_In_ ID3D11ShaderResourceView* texture, _In_reads_(glyphCount) Glyph const* glyphs, _In_ size_t glyphCount, _In_ float lineSpacing);
 
     Glyph const* FindGlyph(wchar_t character) const;
+    Glyph const* FindGlyphOrNull(wchar_t character) const;
 
     void SetDefaultCharacter(wchar_t character);
 
+    // Distance field fonts add SpriteEffects_DistanceField to every glyph they draw.
+    SpriteEffects GetDrawEffects(SpriteEffects effects) const
+    {
+        return (distanceRange > 0) ? static_cast<SpriteEffects>(effects | SpriteEffects_DistanceField) : effects;
+    }
+
     template<typename TAction>
     void ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const;
 
+    template<typename TAction, typename TNewLine, typename TSpace>
+    void ForEachGlyph(_In_z_ wchar_t const* text, TAction action, TNewLine newLine, TSpace space) const;
+
+    std::shared_ptr<const TextLayout> CreateTextLayout(_In_z_ wchar_t const* text);
+    void SetTextLayoutCacheSize(size_t layoutCount);
+    void ClearTextLayoutCache();
+
 
     // Fields.
     ComPtr<ID3D11ShaderResourceView> texture;
-    std::vector<Glyph> glyphs;
+    Glyph const* glyphs;
+    size_t glyphCount;
     Glyph const* defaultGlyph;
     float lineSpacing;
+    float distanceRange;
+
+private:
+    void BuildGlyphTable();
+
+    // Glyphs are either copied into ownedGlyphs, or referenced in place from the mapped file.
+    std::vector<Glyph> ownedGlyphs;
+    ScopedMappedView mappedFile;
+
+    // Glyph lookup table for the Basic Multilingual Plane, in pages of 256 characters. Page 0 always
+    // holds Latin-1 so the common case is a single load, page 1 is shared by every empty page, and
+    // the rest are only allocated for ranges the font covers. Entries point into the glyphs array,
+    // which is never changed after construction.
+    static const size_t GlyphPageShift = 8;
+    static const size_t GlyphPageSize = size_t(1) << GlyphPageShift;
+    static const size_t EmptyGlyphPage = 1;
+
+    std::vector<Glyph const*> glyphTable;
+    uint16_t glyphPageIndex[0x10000 >> GlyphPageShift];
+
+    // Text layouts, most recently used first, with an index by hash of their text.
+    struct CachedLayout
+    {
+        uint64_t hash;
+        std::wstring text;
+        std::shared_ptr<const TextLayout> layout;
+    };
+
+    std::list<CachedLayout> layoutCache;
+    std::unordered_map<uint64_t, std::list<CachedLayout>::iterator> layoutIndex;
+    size_t layoutCacheSize;
+    std::mutex layoutMutex;
 };
 
 
@@ -52,6 +103,51 @@ public:
 const XMFLOAT2 SpriteFont::Float2Zero(0, 0);
 
 static const char spriteFontMagic[] = "DXTKfont";
+static const char spriteFontDistanceFieldMagic[] = "DXTKfsdf";
+
+static_assert(sizeof(spriteFontMagic) == sizeof(spriteFontDistanceFieldMagic), "Magic strings must be the same length");
+
+static const size_t DefaultTextLayoutCacheSize = 64;
+
+
+namespace
+{
+    static_assert(SpriteEffects_FlipHorizontally == 1 &&
+                  SpriteEffects_FlipVertically == 2, "If you change these enum values, the following tables must be updated to match");
+
+    // Lookup table indicates which way to move along each axis per SpriteEffects enum value.
+    const XMVECTORF32 axisDirectionTable[4] =
+    {
+        { -1, -1 },
+        {  1, -1 },
+        { -1,  1 },
+        {  1,  1 },
+    };
+
+    // Lookup table indicates which axes are mirrored for each SpriteEffects enum value.
+    const XMVECTORF32 axisIsMirroredTable[4] =
+    {
+        { 0, 0 },
+        { 1, 0 },
+        { 0, 1 },
+        { 1, 1 },
+    };
+
+    // 64-bit FNV-1a hash of a string, which also returns its length.
+    uint64_t HashText(_In_z_ wchar_t const* text, _Out_ size_t* length)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        wchar_t const* end = text;
+
+        for (; *end; end++)
+        {
+            hash = (hash ^ static_cast<uint64_t>(*end)) * 1099511628211ULL;
+        }
+
+        *length = static_cast<size_t>(end - text);
+        return hash;
+    }
+}
 
 
 // Comparison operators make our sorted glyph vector work with std::binary_search and lower_bound.
@@ -74,31 +170,60 @@ namespace DirectX
 }
 
 
-// Reads a SpriteFont from the binary format created by the MakeSpriteFont utility.
-SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, bool forceSRGB) :
-    defaultGlyph(nullptr)
+// Reads a SpriteFont from the binary format created by the MakeSpriteFont utility. Every field in the
+// format is 32 bits wide, so when the reader is over a mapped file, which starts on a page boundary,
+// the glyph array is suitably aligned to be used where it lies.
+SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, bool forceSRGB, ScopedMappedView&& mappedFile) :
+    defaultGlyph(nullptr),
+    distanceRange(0),
+    mappedFile(std::move(mappedFile)),
+    layoutCacheSize(DefaultTextLayoutCacheSize)
 {
-    // Validate the header.
-    for (char const* magic = spriteFontMagic; *magic; magic++)
+    static_assert(sizeof(Glyph) % 4 == 0 && alignof(Glyph) <= 4, "Glyph layout must match the .spritefont format");
+
+    // Validate the header, which also says whether this is a distance field font.
+    auto magic = reader->ReadArray<char>(sizeof(spriteFontMagic) - 1);
+
+    bool isDistanceField = false;
+
+    if (memcmp(magic, spriteFontDistanceFieldMagic, sizeof(spriteFontMagic) - 1) == 0)
     {
-        if (reader->Read<uint8_t>() != *magic)
-        {
-            DebugTrace( "SpriteFont provided with an invalid .spritefont file\n" );
-            throw std::exception("Not a MakeSpriteFont output binary");
-        }
+        isDistanceField = true;
+    }
+    else if (memcmp(magic, spriteFontMagic, sizeof(spriteFontMagic) - 1) != 0)
+    {
+        DebugTrace( "SpriteFont provided with an invalid .spritefont file\n" );
+        throw std::exception("Not a MakeSpriteFont output binary");
     }
 
     // Read the glyph data.
-    auto glyphCount = reader->Read<uint32_t>();
-    auto glyphData = reader->ReadArray<Glyph>(glyphCount);
+    glyphCount = reader->Read<uint32_t>();
+    glyphs = reader->ReadArray<Glyph>(glyphCount);
+
+    if (!this->mappedFile || (reinterpret_cast<uintptr_t>(glyphs) % alignof(Glyph)) != 0)
+    {
+        ownedGlyphs.assign(glyphs, glyphs + glyphCount);
+        glyphs = ownedGlyphs.data();
+    }
 
-    glyphs.assign(glyphData, glyphData + glyphCount);
+    BuildGlyphTable();
 
     // Read font properties.
     lineSpacing = reader->Read<float>();
 
     SetDefaultCharacter((wchar_t)reader->Read<uint32_t>());
 
+    if (isDistanceField)
+    {
+        distanceRange = reader->Read<float>();
+
+        if (!(distanceRange > 0))
+        {
+            DebugTrace( "SpriteFont provided with an invalid distance range (%f)\n", distanceRange );
+            throw std::exception("Invalid distance field font");
+        }
+    }
+
     // Read the texture data.
     auto textureWidth = reader->Read<uint32_t>();
     auto textureHeight = reader->Read<uint32_t>();
@@ -112,7 +237,7 @@ SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, boo
         textureFormat = LoaderHelpers::MakeSRGB(textureFormat);
     }
 
-    // Create the D3D texture.
+    // Create the D3D texture. For mapped files, the initial data is read straight from the mapping.
     CD3D11_TEXTURE2D_DESC textureDesc(textureFormat, textureWidth, textureHeight, 1, 1, D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE);
     CD3D11_SHADER_RESOURCE_VIEW_DESC viewDesc(D3D11_SRV_DIMENSION_TEXTURE2D, textureFormat);
     D3D11_SUBRESOURCE_DATA initData = { textureData, textureStride };
@@ -135,25 +260,90 @@ SpriteFont::Impl::Impl(_In_ ID3D11Device* device, _In_ BinaryReader* reader, boo
 _Use_decl_annotations_
 SpriteFont::Impl::Impl(ID3D11ShaderResourceView* texture, Glyph const* glyphs, size_t glyphCount, float lineSpacing)
   : texture(texture),
-    glyphs(glyphs, glyphs + glyphCount),
+    glyphCount(glyphCount),
     defaultGlyph(nullptr),
-    lineSpacing(lineSpacing)
+    lineSpacing(lineSpacing),
+    distanceRange(0),
+    ownedGlyphs(glyphs, glyphs + glyphCount),
+    layoutCacheSize(DefaultTextLayoutCacheSize)
 {
     if (!std::is_sorted(glyphs, glyphs + glyphCount))
     {
         throw std::exception("Glyphs must be in ascending codepoint order");
     }
+
+    this->glyphs = ownedGlyphs.data();
+
+    BuildGlyphTable();
+}
+
+
+// Fills in the glyph lookup table, so FindGlyph doesn't have to search the glyphs array.
+void SpriteFont::Impl::BuildGlyphTable()
+{
+    glyphTable.assign(GlyphPageSize * 2, nullptr);
+
+    std::fill_n(glyphPageIndex, _countof(glyphPageIndex), static_cast<uint16_t>(EmptyGlyphPage));
+    glyphPageIndex[0] = 0;
+
+    // Walk backwards so that if a character is repeated, the first glyph wins, as it does for lower_bound.
+    for (size_t i = glyphCount; i-- > 0; )
+    {
+        auto glyph = glyphs + i;
+
+        uint32_t character = glyph->Character;
+
+        if (character > 0xFFFF)
+            continue;
+
+        size_t page = character >> GlyphPageShift;
+
+        if (glyphPageIndex[page] == EmptyGlyphPage)
+        {
+            glyphPageIndex[page] = static_cast<uint16_t>(glyphTable.size() >> GlyphPageShift);
+            glyphTable.resize(glyphTable.size() + GlyphPageSize, nullptr);
+        }
+
+        glyphTable[(size_t(glyphPageIndex[page]) << GlyphPageShift) | (character & (GlyphPageSize - 1))] = glyph;
+    }
+}
+
+
+// Looks up the requested glyph, returning null if it is not in the font.
+SpriteFont::Glyph const* SpriteFont::Impl::FindGlyphOrNull(wchar_t character) const
+{
+    uint32_t code = static_cast<uint32_t>(character);
+
+    if (code < GlyphPageSize)
+    {
+        return glyphTable[code];
+    }
+
+    if (code <= 0xFFFF)
+    {
+        return glyphTable[(size_t(glyphPageIndex[code >> GlyphPageShift]) << GlyphPageShift) | (code & (GlyphPageSize - 1))];
+    }
+
+    // Characters beyond the BMP only occur where wchar_t is 32 bits wide.
+    auto glyph = std::lower_bound(glyphs, glyphs + glyphCount, character);
+
+    if (glyph != glyphs + glyphCount && glyph->Character == code)
+    {
+        return glyph;
+    }
+
+    return nullptr;
 }
 
 
 // Looks up the requested glyph, falling back to the default character if it is not in the font.
 SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
 {
-    auto glyph = std::lower_bound(glyphs.begin(), glyphs.end(), character);
+    auto glyph = FindGlyphOrNull(character);
 
-    if (glyph != glyphs.end() && glyph->Character == character)
+    if (glyph)
     {
-        return &*glyph;
+        return glyph;
     }
 
     if (defaultGlyph)
@@ -169,6 +359,8 @@ SpriteFont::Glyph const* SpriteFont::Impl::FindGlyph(wchar_t character) const
 // Sets the missing-character fallback glyph.
 void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
 {
+    ClearTextLayoutCache();
+
     defaultGlyph = nullptr;
 
     if (character)
@@ -178,9 +370,17 @@ void SpriteFont::Impl::SetDefaultCharacter(wchar_t character)
 }
 
 
-// The core glyph layout algorithm, shared between DrawString and MeasureString.
+// The core glyph layout algorithm, shared between DrawString, MeasureString and text layouts.
 template<typename TAction>
 void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action) const
+{
+    ForEachGlyph(text, action, [](float) {}, []() {});
+}
+
+
+// newLine is called with the y of each new line, and space for whitespace characters that have nothing to draw.
+template<typename TAction, typename TNewLine, typename TSpace>
+void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action, TNewLine newLine, TSpace space) const
 {
     float x = 0;
     float y = 0;
@@ -199,6 +399,7 @@ void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action)
                 // New line.
                 x = 0;
                 y += lineSpacing;
+                newLine(y);
                 break;
 
             default:
@@ -218,6 +419,10 @@ void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action)
                 {
                     action(glyph, x, y, advance);
                 }
+                else
+                {
+                    space();
+                }
 
                 x += advance;
                 break;
@@ -226,12 +431,163 @@ void SpriteFont::Impl::ForEachGlyph(_In_z_ wchar_t const* text, TAction action)
 }
 
 
+// Returns the cached layout of the text, laying it out if it isn't in the cache.
+_Use_decl_annotations_
+std::shared_ptr<const SpriteFont::TextLayout> SpriteFont::Impl::CreateTextLayout(wchar_t const* text)
+{
+    size_t length;
+    uint64_t hash = HashText(text, &length);
+
+    std::lock_guard<std::mutex> lock(layoutMutex);
+
+    auto it = layoutIndex.find(hash);
+
+    if (it != layoutIndex.end())
+    {
+        if (it->second->text.compare(0, std::wstring::npos, text, length) == 0)
+        {
+            layoutCache.splice(layoutCache.begin(), layoutCache, it->second);
+            return it->second->layout;
+        }
+
+        // A hash collision; the new text replaces the old one.
+        layoutCache.erase(it->second);
+        layoutIndex.erase(it);
+    }
+
+    auto layout = std::make_shared<TextLayout>();
+    auto& glyphQuads = layout->mGlyphs;
+    auto& lines = layout->mLines;
+
+    TextLayout::Line firstLine = { 0, 0, 0, 0 };
+    lines.push_back(firstLine);
+
+    XMVECTOR size = XMVectorZero();
+
+    // Whitespace after a word on the line starts a new word at the next glyph that isn't whitespace.
+    uint32_t word = 0;
+    bool lineHasWord = false;
+    bool afterSpace = false;
+
+    ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
+    {
+        UNREFERENCED_PARAMETER(advance);
+
+        if (iswspace(static_cast<wint_t>(glyph->Character)))
+        {
+            afterSpace = lineHasWord;
+        }
+        else
+        {
+            if (afterSpace)
+            {
+                word++;
+                afterSpace = false;
+            }
+
+            lineHasWord = true;
+        }
+
+        TextLayout::GlyphQuad quad = { glyph->Subrect, x, y + glyph->YOffset, word };
+        glyphQuads.push_back(quad);
+
+        // Measured the same way as MeasureString.
+        float w = (float)(glyph->Subrect.right - glyph->Subrect.left);
+        float h = (float)(glyph->Subrect.bottom - glyph->Subrect.top) + glyph->YOffset;
+
+        h = std::max(h, lineSpacing);
+
+        size = XMVectorMax(size, XMVectorSet(x + w, y + h, 0, 0));
+
+        auto& line = lines.back();
+        line.GlyphCount++;
+        line.Width = std::max(line.Width, x + w);
+    },
+    [&](float y)
+    {
+        TextLayout::Line line = { static_cast<uint32_t>(glyphQuads.size()), 0, y, 0 };
+        lines.push_back(line);
+
+        word = 0;
+        lineHasWord = false;
+        afterSpace = false;
+    },
+    [&]()
+    {
+        afterSpace = lineHasWord;
+    });
+
+    glyphQuads.shrink_to_fit();
+    lines.shrink_to_fit();
+    XMStoreFloat2(&layout->mSize, size);
+
+    if (layoutCacheSize > 0)
+    {
+        CachedLayout entry = { hash, std::wstring(text, length), layout };
+
+        layoutCache.push_front(std::move(entry));
+        layoutIndex[hash] = layoutCache.begin();
+
+        while (layoutCache.size() > layoutCacheSize)
+        {
+            layoutIndex.erase(layoutCache.back().hash);
+            layoutCache.pop_back();
+        }
+    }
+
+    return layout;
+}
+
+
+void SpriteFont::Impl::SetTextLayoutCacheSize(size_t layoutCount)
+{
+    std::lock_guard<std::mutex> lock(layoutMutex);
+
+    layoutCacheSize = layoutCount;
+
+    while (layoutCache.size() > layoutCacheSize)
+    {
+        layoutIndex.erase(layoutCache.back().hash);
+        layoutCache.pop_back();
+    }
+}
+
+
+// Drops every cached layout, for when the font properties they were laid out with change.
+void SpriteFont::Impl::ClearTextLayoutCache()
+{
+    std::lock_guard<std::mutex> lock(layoutMutex);
+
+    layoutCache.clear();
+    layoutIndex.clear();
+}
+
+
 // Construct from a binary file created by the MakeSpriteFont utility.
-SpriteFont::SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB)
+SpriteFont::SpriteFont(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB, bool memoryMapped)
 {
-    BinaryReader reader(fileName);
+    if (memoryMapped)
+    {
+        ScopedMappedView mappedFile;
+        size_t dataSize;
 
-    pImpl = std::make_unique<Impl>(device, &reader, forceSRGB);
+        HRESULT hr = BinaryReader::MapEntireFile(fileName, mappedFile, &dataSize);
+        if (FAILED(hr))
+        {
+            DebugTrace( "SpriteFont failed (%08X) to map '%ls'\n", hr, fileName );
+            throw std::exception( "SpriteFont" );
+        }
+
+        BinaryReader reader(static_cast<uint8_t const*>(mappedFile.get()), dataSize);
+
+        pImpl = std::make_unique<Impl>(device, &reader, forceSRGB, std::move(mappedFile));
+    }
+    else
+    {
+        BinaryReader reader(fileName);
+
+        pImpl = std::make_unique<Impl>(device, &reader, forceSRGB);
+    }
 }
 
 
@@ -294,27 +650,6 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
 
 void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wchar_t const* text, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
 {
-    static_assert(SpriteEffects_FlipHorizontally == 1 &&
-                  SpriteEffects_FlipVertically == 2, "If you change these enum values, the following tables must be updated to match");
-
-    // Lookup table indicates which way to move along each axis per SpriteEffects enum value.
-    static XMVECTORF32 axisDirectionTable[4] =
-    {
-        { -1, -1 },
-        {  1, -1 },
-        { -1,  1 },
-        {  1,  1 },
-    };
-
-    // Lookup table indicates which axes are mirrored for each SpriteEffects enum value.
-    static XMVECTORF32 axisIsMirroredTable[4] =
-    {
-        { 0, 0 },
-        { 1, 0 },
-        { 0, 1 },
-        { 1, 1 },
-    };
-
     XMVECTOR baseOffset = origin;
 
     // If the text is mirrored, offset the start position accordingly.
@@ -323,6 +658,8 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
         baseOffset -= MeasureString(text) * axisIsMirroredTable[effects & 3];
     }
 
+    auto drawEffects = pImpl->GetDrawEffects(effects);
+
     // Draw each character in turn.
     pImpl->ForEachGlyph(text, [&](Glyph const* glyph, float x, float y, float advance)
     {
@@ -341,11 +678,77 @@ void XM_CALLCONV SpriteFont::DrawString(_In_ SpriteBatch* spriteBatch, _In_z_ wc
             offset = XMVectorMultiplyAdd(glyphRect, axisIsMirroredTable[effects & 3], offset);
         }
 
-        spriteBatch->Draw(pImpl->texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, effects, layerDepth);
+        spriteBatch->Draw(pImpl->texture.Get(), position, &glyph->Subrect, color, rotation, offset, scale, drawEffects, layerDepth);
     });
 }
 
 
+// Text layouts
+std::shared_ptr<const SpriteFont::TextLayout> SpriteFont::CreateTextLayout(_In_z_ wchar_t const* text) const
+{
+    return pImpl->CreateTextLayout(text);
+}
+
+
+void SpriteFont::SetTextLayoutCacheSize(size_t layoutCount)
+{
+    pImpl->SetTextLayoutCacheSize(layoutCount);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawTextLayout(spriteBatch, layout, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, XMFLOAT2 const& position, FXMVECTOR color, float rotation, XMFLOAT2 const& origin, XMFLOAT2 const& scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawTextLayout(spriteBatch, layout, XMLoadFloat2(&position), color, rotation, XMLoadFloat2(&origin), XMLoadFloat2(&scale), effects, layerDepth);
+}
+
+
+void XM_CALLCONV SpriteFont::DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, float scale, SpriteEffects effects, float layerDepth) const
+{
+    DrawTextLayout(spriteBatch, layout, position, color, rotation, origin, XMVectorReplicate(scale), effects, layerDepth);
+}
+
+
+// Draws the glyph quads of a layout the same way DrawString would draw its text, without laying it out again.
+void XM_CALLCONV SpriteFont::DrawTextLayout(_In_ SpriteBatch* spriteBatch, TextLayout const& layout, FXMVECTOR position, FXMVECTOR color, float rotation, FXMVECTOR origin, GXMVECTOR scale, SpriteEffects effects, float layerDepth) const
+{
+    XMVECTOR baseOffset = origin;
+
+    // If the text is mirrored, offset the start position accordingly.
+    if (effects)
+    {
+        baseOffset -= layout.GetSize() * axisIsMirroredTable[effects & 3];
+    }
+
+    auto drawEffects = pImpl->GetDrawEffects(effects);
+
+    auto texture = pImpl->texture.Get();
+
+    for (auto it = layout.mGlyphs.cbegin(); it != layout.mGlyphs.cend(); ++it)
+    {
+        XMVECTOR offset = XMVectorMultiplyAdd(XMVectorSet(it->X, it->Y, 0, 0), axisDirectionTable[effects & 3], baseOffset);
+
+        if (effects)
+        {
+            // For mirrored characters, specify bottom and/or right instead of top left.
+            XMVECTOR glyphRect = XMConvertVectorIntToFloat(XMLoadInt4(reinterpret_cast<uint32_t const*>(&it->Subrect)), 0);
+
+            // xy = glyph width/height.
+            glyphRect = XMVectorSwizzle<2, 3, 0, 1>(glyphRect) - glyphRect;
+
+            offset = XMVectorMultiplyAdd(glyphRect, axisIsMirroredTable[effects & 3], offset);
+        }
+
+        spriteBatch->Draw(texture, position, &it->Subrect, color, rotation, offset, scale, drawEffects, layerDepth);
+    }
+}
+
+
 XMVECTOR XM_CALLCONV SpriteFont::MeasureString(_In_z_ wchar_t const* text) const
 {
     XMVECTOR result = XMVectorZero();
@@ -422,6 +825,8 @@ float SpriteFont::GetLineSpacing() const
 
 void SpriteFont::SetLineSpacing(float spacing)
 {
+    pImpl->ClearTextLayoutCache();
+
     pImpl->lineSpacing = spacing;
 }
 
@@ -441,7 +846,19 @@ void SpriteFont::SetDefaultCharacter(wchar_t character)
 
 bool SpriteFont::ContainsCharacter(wchar_t character) const
 {
-    return std::binary_search(pImpl->glyphs.begin(), pImpl->glyphs.end(), character);
+    return pImpl->FindGlyphOrNull(character) != nullptr;
+}
+
+
+bool SpriteFont::IsDistanceField() const
+{
+    return pImpl->distanceRange > 0;
+}
+
+
+float SpriteFont::GetDistanceRange() const
+{
+    return pImpl->distanceRange;
 }
 
 
@@ -459,3 +876,34 @@ void SpriteFont::GetSpriteSheet( ID3D11ShaderResourceView** texture ) const
 
     ThrowIfFailed( pImpl->texture.CopyTo( texture ) );
 }
+
+
+// Text layout properties
+XMVECTOR XM_CALLCONV SpriteFont::TextLayout::GetSize() const
+{
+    return XMLoadFloat2(&mSize);
+}
+
+
+size_t SpriteFont::TextLayout::GetGlyphCount() const
+{
+    return mGlyphs.size();
+}
+
+
+SpriteFont::TextLayout::GlyphQuad const* SpriteFont::TextLayout::GetGlyphs() const
+{
+    return mGlyphs.data();
+}
+
+
+size_t SpriteFont::TextLayout::GetLineCount() const
+{
+    return mLines.size();
+}
+
+
+SpriteFont::TextLayout::Line const* SpriteFont::TextLayout::GetLines() const
+{
+    return mLines.data();
+}
@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------------------
+// File: SpriteSort.h
+//
+// Sort keys for SpriteBatch: each sprite's sort value (a texture number or its depth)
+// goes in the upper 32 bits of a 64-bit key and its queue index in the lower 32, and the
+// keys are put in order with a stable radix sort. Like BlockCompression.h, this header only
+// depends on the C++ standard library.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+
+namespace DirectX
+{
+    namespace SpriteSorting
+    {
+        // Maps a float to an unsigned integer with the same ordering (treating -0 as +0).
+        inline uint32_t GetDepthSortKey(float depth)
+        {
+            uint32_t bits;
+            memcpy(&bits, &depth, sizeof(bits));
+
+            if (bits == 0x80000000)
+                bits = 0;
+
+            return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+        }
+
+
+        // Sorts 64-bit keys by their upper 32 bits with a stable LSD radix sort, one byte per pass.
+        // Passes where every key has the same byte are skipped, so a few textures or a narrow depth
+        // range sort in one or two passes. Returns whichever of the two buffers holds the result.
+        inline uint64_t* RadixSortKeys(uint64_t* keys, uint64_t* scratch, size_t count)
+        {
+            if (count <= 64)
+            {
+                // The low bits are unique, so a plain sort of small arrays is stable too.
+                std::sort(keys, keys + count);
+                return keys;
+            }
+
+            uint32_t histograms[4][256] = {};
+
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t key = static_cast<uint32_t>(keys[i] >> 32);
+
+                histograms[0][key & 0xff]++;
+                histograms[1][(key >> 8) & 0xff]++;
+                histograms[2][(key >> 16) & 0xff]++;
+                histograms[3][key >> 24]++;
+            }
+
+            for (size_t pass = 0; pass < 4; pass++)
+            {
+                uint32_t* offsets = histograms[pass];
+                unsigned int shift = static_cast<unsigned int>(32 + pass * 8);
+
+                if (offsets[(keys[0] >> shift) & 0xff] == count)
+                    continue;
+
+                uint32_t total = 0;
+
+                for (size_t j = 0; j < 256; j++)
+                {
+                    uint32_t bucketCount = offsets[j];
+                    offsets[j] = total;
+                    total += bucketCount;
+                }
+
+                for (size_t i = 0; i < count; i++)
+                {
+                    uint64_t key = keys[i];
+                    scratch[offsets[(key >> shift) & 0xff]++] = key;
+                }
+
+                std::swap(keys, scratch);
+            }
+
+            return keys;
+        }
+    }
+}
@@ -0,0 +1,330 @@
+//--------------------------------------------------------------------------------------
+// File: TextCrawl.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "TextCrawl.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    // A half plane of the text plane, holding the points where a * x + b * y + c >= 0.
+    struct HalfPlane
+    {
+        float a;
+        float b;
+        float c;
+    };
+
+    // Clipping a convex polygon to a half plane adds at most one vertex.
+    const size_t MaxPolygonVertices = 16;
+
+    // Clips a convex polygon to a half plane (Sutherland-Hodgman), returning the new vertex count.
+    size_t ClipPolygon(_In_reads_(count) XMFLOAT2 const* polygon, size_t count, HalfPlane const& plane, _Out_writes_(MaxPolygonVertices) XMFLOAT2* result)
+    {
+        size_t resultCount = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto& current = polygon[i];
+            auto& next = polygon[(i + 1) % count];
+
+            float currentDistance = plane.a * current.x + plane.b * current.y + plane.c;
+            float nextDistance = plane.a * next.x + plane.b * next.y + plane.c;
+
+            if (currentDistance >= 0)
+            {
+                result[resultCount++] = current;
+            }
+
+            // Add the point where the edge crosses the plane.
+            if ((currentDistance >= 0) != (nextDistance >= 0))
+            {
+                float t = currentDistance / (currentDistance - nextDistance);
+
+                result[resultCount++] = XMFLOAT2(current.x + (next.x - current.x) * t,
+                                                 current.y + (next.y - current.y) * t);
+            }
+        }
+
+        return resultCount;
+    }
+}
+
+
+// Internal TextCrawl implementation class.
+class TextCrawl::Impl
+{
+public:
+    Impl(_In_ SpriteFont const* font, _In_z_ wchar_t const* text, TextCrawlAlignment alignment);
+
+    void XM_CALLCONV Draw(_In_ SpriteBatch* spriteBatch, FXMMATRIX textToClip, FXMVECTOR color, _In_opt_ ID3D11BlendState* blendState, _In_opt_ ID3D11DepthStencilState* depthStencilState);
+
+    ComPtr<ID3D11ShaderResourceView> texture;
+    SpriteEffects effects;
+    float lineSpacing;
+    XMFLOAT2 size;
+
+    // Glyph quads already positioned for the alignment, and the lines they belong to, in order of y.
+    std::vector<SpriteFont::TextLayout::GlyphQuad> glyphs;
+    std::vector<SpriteFont::TextLayout::Line> lines;
+
+    float fadeStart;
+    float fadeEnd;
+    size_t visibleLineCount;
+
+private:
+    bool XM_CALLCONV FindVisibleRange(FXMMATRIX textToClip, _Out_ float* top, _Out_ float* bottom) const;
+};
+
+
+// Lays out the text and applies the alignment, so drawing only has to pick lines.
+_Use_decl_annotations_
+TextCrawl::Impl::Impl(SpriteFont const* font, wchar_t const* text, TextCrawlAlignment alignment)
+  : effects(font->IsDistanceField() ? SpriteEffects_DistanceField : SpriteEffects_None),
+    lineSpacing(font->GetLineSpacing()),
+    fadeStart(0),
+    fadeEnd(0),
+    visibleLineCount(0)
+{
+    font->GetSpriteSheet(texture.GetAddressOf());
+
+    auto layout = font->CreateTextLayout(text);
+
+    glyphs.assign(layout->GetGlyphs(), layout->GetGlyphs() + layout->GetGlyphCount());
+    lines.assign(layout->GetLines(), layout->GetLines() + layout->GetLineCount());
+
+    XMStoreFloat2(&size, layout->GetSize());
+
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        auto& line = lines[i];
+
+        // The last line of a paragraph is followed by an empty line, or by nothing.
+        bool endsParagraph = (i + 1 == lines.size()) || (lines[i + 1].GlyphCount == 0);
+
+        float wordSpacing = 0;
+        float glyphSpacing = 0;
+
+        if (alignment == TextCrawlAlignment_Justify && !endsParagraph && line.GlyphCount > 1)
+        {
+            // The extra width goes into the gaps between words, or between the glyphs of a single word.
+            uint32_t gapCount = glyphs[line.FirstGlyph + line.GlyphCount - 1].Word;
+
+            if (gapCount > 0)
+            {
+                wordSpacing = (size.x - line.Width) / gapCount;
+            }
+            else
+            {
+                glyphSpacing = (size.x - line.Width) / (line.GlyphCount - 1);
+            }
+
+            line.Width = size.x;
+        }
+
+        float left = -line.Width / 2;
+
+        for (uint32_t j = 0; j < line.GlyphCount; j++)
+        {
+            auto& glyph = glyphs[line.FirstGlyph + j];
+
+            glyph.X += left + wordSpacing * glyph.Word + glyphSpacing * j;
+        }
+    }
+}
+
+
+// Finds the rows of the text plane that can be seen, by clipping the document's bounds to the view frustum
+// (and the fade distance). Clip space is linear over the plane, so each frustum plane is a half plane here.
+_Use_decl_annotations_
+bool XM_CALLCONV TextCrawl::Impl::FindVisibleRange(FXMMATRIX textToClip, float* top, float* bottom) const
+{
+    XMFLOAT4X4 m;
+    XMStoreFloat4x4(&m, textToClip);
+
+    // Clip space x, y, z and w of a point on the plane are x * row 0 + y * row 1 + row 3.
+    HalfPlane planes[7] =
+    {
+        { m._14 + m._11, m._24 + m._21, m._44 + m._41 },    // -w <= x
+        { m._14 - m._11, m._24 - m._21, m._44 - m._41 },    //  x <= w
+        { m._14 + m._12, m._24 + m._22, m._44 + m._42 },    // -w <= y
+        { m._14 - m._12, m._24 - m._22, m._44 - m._42 },    //  y <= w
+        { m._13,         m._23,         m._43         },    //  0 <= z
+        { m._14 - m._13, m._24 - m._23, m._44 - m._43 },    //  z <= w
+        { -m._14,        -m._24,        fadeEnd - m._44 },  //  w <= fade end
+    };
+
+    size_t planeCount = (fadeEnd > fadeStart) ? 7 : 6;
+
+    XMFLOAT2 polygon[2][MaxPolygonVertices] =
+    {
+        {
+            XMFLOAT2(-size.x / 2, 0),
+            XMFLOAT2( size.x / 2, 0),
+            XMFLOAT2( size.x / 2, size.y),
+            XMFLOAT2(-size.x / 2, size.y),
+        },
+    };
+
+    size_t count = 4;
+    size_t current = 0;
+
+    for (size_t i = 0; i < planeCount && count > 0; i++)
+    {
+        count = ClipPolygon(polygon[current], count, planes[i], polygon[current ^ 1]);
+        current ^= 1;
+    }
+
+    if (!count)
+        return false;
+
+    *top = polygon[current][0].y;
+    *bottom = polygon[current][0].y;
+
+    for (size_t i = 1; i < count; i++)
+    {
+        *top = std::min(*top, polygon[current][i].y);
+        *bottom = std::max(*bottom, polygon[current][i].y);
+    }
+
+    return true;
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV TextCrawl::Impl::Draw(SpriteBatch* spriteBatch, FXMMATRIX textToClip, FXMVECTOR color, ID3D11BlendState* blendState, ID3D11DepthStencilState* depthStencilState)
+{
+    visibleLineCount = 0;
+
+    float top, bottom;
+
+    if (!FindVisibleRange(textToClip, &top, &bottom))
+        return;
+
+    // Glyphs can reach past their line, so allow a line of slack on either side.
+    auto first = std::lower_bound(lines.cbegin(), lines.cend(), top - lineSpacing * 2, [](SpriteFont::TextLayout::Line const& line, float y)
+    {
+        return line.Y < y;
+    });
+
+    // The matrix already ends in clip space, so SpriteBatch must not append its viewport transform.
+    auto rotation = spriteBatch->GetRotation();
+
+    spriteBatch->SetRotation(DXGI_MODE_ROTATION_UNSPECIFIED);
+    spriteBatch->Begin(SpriteSortMode_Deferred, blendState, nullptr, depthStencilState, nullptr, nullptr, textToClip);
+
+    XMFLOAT4X4 m;
+    XMStoreFloat4x4(&m, textToClip);
+
+    for (auto line = first; line != lines.cend() && line->Y < bottom + lineSpacing; ++line)
+    {
+        if (!line->GlyphCount)
+            continue;
+
+        XMVECTOR lineColor = color;
+
+        if (fadeEnd > fadeStart)
+        {
+            // Depth of the middle of the line.
+            float w = (line->Y + lineSpacing / 2) * m._24 + m._44;
+
+            float fade = std::min((fadeEnd - w) / (fadeEnd - fadeStart), 1.f);
+
+            if (fade <= 0)
+                continue;
+
+            // Sprites use premultiplied alpha, so fade every channel.
+            lineColor = XMVectorScale(color, fade);
+        }
+
+        auto glyph = glyphs.cbegin() + line->FirstGlyph;
+
+        for (uint32_t i = 0; i < line->GlyphCount; i++, ++glyph)
+        {
+            spriteBatch->Draw(texture.Get(), XMVectorSet(glyph->X, glyph->Y, 0, 0), &glyph->Subrect, lineColor, 0, g_XMZero, 1, effects);
+        }
+
+        visibleLineCount++;
+    }
+
+    spriteBatch->End();
+    spriteBatch->SetRotation(rotation);
+}
+
+
+// Public constructor.
+_Use_decl_annotations_
+TextCrawl::TextCrawl(SpriteFont const* font, wchar_t const* text, TextCrawlAlignment alignment)
+  : pImpl(new Impl(font, text, alignment))
+{
+}
+
+
+// Move constructor.
+TextCrawl::TextCrawl(TextCrawl&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+TextCrawl& TextCrawl::operator= (TextCrawl&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+TextCrawl::~TextCrawl()
+{
+}
+
+
+_Use_decl_annotations_
+void XM_CALLCONV TextCrawl::Draw(SpriteBatch* spriteBatch, FXMMATRIX textToClip, FXMVECTOR color, ID3D11BlendState* blendState, ID3D11DepthStencilState* depthStencilState)
+{
+    pImpl->Draw(spriteBatch, textToClip, color, blendState, depthStencilState);
+}
+
+
+void TextCrawl::SetFadeDistance(float start, float end)
+{
+    pImpl->fadeStart = start;
+    pImpl->fadeEnd = end;
+}
+
+
+XMVECTOR XM_CALLCONV TextCrawl::GetSize() const
+{
+    return XMLoadFloat2(&pImpl->size);
+}
+
+
+size_t TextCrawl::GetLineCount() const
+{
+    return pImpl->lines.size();
+}
+
+
+size_t TextCrawl::GetVisibleLineCount() const
+{
+    return pImpl->visibleLineCount;
+}
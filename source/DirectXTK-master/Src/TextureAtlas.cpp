@@ -0,0 +1,238 @@
+//--------------------------------------------------------------------------------------
+// File: TextureAtlas.cpp
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "TextureAtlas.h"
+#include "DDSTextureLoader.h"
+#include "DirectXHelpers.h"
+#include "BinaryReader.h"
+#include "PlatformHelpers.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+
+namespace
+{
+    const char atlasMagic[] = "DXTKatlas";
+
+    std::wstring WidenName(_In_reads_(length) char const* name, size_t length)
+    {
+        if (!length)
+            return std::wstring();
+
+        int count = MultiByteToWideChar(CP_UTF8, 0, name, static_cast<int>(length), nullptr, 0);
+        if (count <= 0)
+            throw std::exception("Invalid atlas entry name");
+
+        std::wstring result(static_cast<size_t>(count), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, name, static_cast<int>(length), &result[0], count);
+        return result;
+    }
+}
+
+
+// Internal TextureAtlas implementation class.
+class TextureAtlas::Impl
+{
+public:
+    Impl(_In_ ID3D11Device* device, _In_z_ wchar_t const* fileName, bool forceSRGB);
+
+    struct Entry
+    {
+        RECT rect;
+
+        // Only used by fonts.
+        std::vector<SpriteFont::Glyph> glyphs;
+        float lineSpacing;
+        wchar_t defaultCharacter;
+    };
+
+    Entry const& FindEntry(_In_z_ wchar_t const* name) const;
+
+    ComPtr<ID3D11ShaderResourceView> texture;
+    std::map<std::wstring, Entry> entries;
+    float packingEfficiency;
+};
+
+
+// Reads the entry table written by DDSTool, then loads the page it describes.
+_Use_decl_annotations_
+TextureAtlas::Impl::Impl(ID3D11Device* device, wchar_t const* fileName, bool forceSRGB)
+  : packingEfficiency(0)
+{
+    BinaryReader reader(fileName);
+
+    // Validate the header.
+    for (char const* magic = atlasMagic; *magic; magic++)
+    {
+        if (reader.Read<uint8_t>() != *magic)
+        {
+            DebugTrace("TextureAtlas provided with an invalid .atlas file\n");
+            throw std::exception("Not a DDSTool atlas");
+        }
+    }
+
+    auto pageWidth = reader.Read<uint32_t>();
+    auto pageHeight = reader.Read<uint32_t>();
+    auto entryCount = reader.Read<uint32_t>();
+
+    uint64_t entryArea = 0;
+
+    for (uint32_t j = 0; j < entryCount; j++)
+    {
+        auto nameLength = reader.Read<uint32_t>();
+        auto name = WidenName(reader.ReadArray<char>(nameLength), nameLength);
+
+        Entry entry;
+        auto rect = reader.ReadArray<int32_t>(4);
+        entry.rect.left = rect[0];
+        entry.rect.top = rect[1];
+        entry.rect.right = rect[2];
+        entry.rect.bottom = rect[3];
+
+        entryArea += uint64_t(rect[2] - rect[0]) * uint64_t(rect[3] - rect[1]);
+
+        entry.lineSpacing = 0;
+        entry.defaultCharacter = 0;
+
+        auto glyphCount = reader.Read<uint32_t>();
+        if (glyphCount)
+        {
+            entry.lineSpacing = reader.Read<float>();
+            entry.defaultCharacter = static_cast<wchar_t>(reader.Read<uint32_t>());
+
+            auto glyphData = reader.ReadArray<SpriteFont::Glyph>(glyphCount);
+            entry.glyphs.assign(glyphData, glyphData + glyphCount);
+        }
+
+        entries[name] = std::move(entry);
+    }
+
+    if (pageWidth && pageHeight)
+    {
+        packingEfficiency = float(double(entryArea) / (double(pageWidth) * double(pageHeight)));
+    }
+
+    // The page has the same name, with a .dds extension.
+    std::wstring pageName(fileName);
+    size_t dot = pageName.find_last_of(L'.');
+    if (dot != std::wstring::npos && pageName.find_first_of(L"\\/", dot) == std::wstring::npos)
+    {
+        pageName.resize(dot);
+    }
+    pageName += L".dds";
+
+    ThrowIfFailed(
+        CreateDDSTextureFromFileEx(device, pageName.c_str(), 0, D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0, forceSRGB, nullptr, texture.GetAddressOf())
+    );
+
+    SetDebugObjectName(texture.Get(), "DirectXTK:TextureAtlas");
+}
+
+
+_Use_decl_annotations_
+TextureAtlas::Impl::Entry const& TextureAtlas::Impl::FindEntry(wchar_t const* name) const
+{
+    auto it = entries.find(name);
+
+    if (it == entries.end())
+    {
+        DebugTrace("TextureAtlas has no entry named %ls\n", name);
+        throw std::exception("Entry not found");
+    }
+
+    return it->second;
+}
+
+
+// Public constructor.
+_Use_decl_annotations_
+TextureAtlas::TextureAtlas(ID3D11Device* device, wchar_t const* fileName, bool forceSRGB)
+  : pImpl(new Impl(device, fileName, forceSRGB))
+{
+}
+
+
+// Move constructor.
+TextureAtlas::TextureAtlas(TextureAtlas&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+TextureAtlas& TextureAtlas::operator= (TextureAtlas&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+TextureAtlas::~TextureAtlas()
+{
+}
+
+
+ID3D11ShaderResourceView* TextureAtlas::GetTexture() const
+{
+    return pImpl->texture.Get();
+}
+
+
+_Use_decl_annotations_
+bool TextureAtlas::ContainsEntry(wchar_t const* name) const
+{
+    return pImpl->entries.find(name) != pImpl->entries.end();
+}
+
+
+_Use_decl_annotations_
+RECT const& TextureAtlas::GetSourceRect(wchar_t const* name) const
+{
+    return pImpl->FindEntry(name).rect;
+}
+
+
+_Use_decl_annotations_
+std::unique_ptr<SpriteFont> TextureAtlas::CreateSpriteFont(wchar_t const* name) const
+{
+    auto& entry = pImpl->FindEntry(name);
+
+    if (entry.glyphs.empty())
+    {
+        DebugTrace("TextureAtlas entry %ls is not a font\n", name);
+        throw std::exception("Entry is not a font");
+    }
+
+    auto font = std::make_unique<SpriteFont>(pImpl->texture.Get(), entry.glyphs.data(), entry.glyphs.size(), entry.lineSpacing);
+
+    if (entry.defaultCharacter)
+    {
+        font->SetDefaultCharacter(entry.defaultCharacter);
+    }
+
+    return font;
+}
+
+
+float TextureAtlas::GetPackingEfficiency() const
+{
+    return pImpl->packingEfficiency;
+}
@@ -0,0 +1,874 @@
+//--------------------------------------------------------------------------------------
+// File: TextureCache.cpp
+//
+// Keeps decoded images in system memory keyed by a hash of the file contents, so the same
+// image reached through different paths is decoded once, and textures can be recreated
+// after a device reset without decoding again. Decoded WIC images can also be kept as
+// .dds files in a cache directory, which skips decoding entirely on later runs.
+//
+// THIS CODE AND INFORMATION IS PROVIDED "AS IS" WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESSED OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A
+// PARTICULAR PURPOSE.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "TextureCache.h"
+
+#include "DDSTextureLoader.h"
+#include "WICTextureLoader.h"
+
+#include "BinaryReader.h"
+#include "DirectXHelpers.h"
+#include "PlatformHelpers.h"
+#include "LoaderHelpers.h"
+
+#include <mutex>
+#include <unordered_map>
+
+using namespace DirectX;
+using namespace DirectX::LoaderHelpers;
+using Microsoft::WRL::ComPtr;
+
+namespace DirectX
+{
+extern HRESULT _DecodeWICImage(_In_ ID3D11Device* d3dDevice, _In_reads_bytes_(wicDataSize) const uint8_t* wicData, _In_ size_t wicDataSize,
+                               _In_ size_t maxsize, _In_ bool autogen, _In_ unsigned int loadFlags, _Out_ LoaderHelpers::DecodedImage& image);
+extern HRESULT _CreateTextureFromDecodedImage(_In_ ID3D11Device* d3dDevice, _In_opt_ ID3D11DeviceContext* d3dContext, _In_ const LoaderHelpers::DecodedImage& image,
+                                              _In_ D3D11_USAGE usage, _In_ unsigned int bindFlags, _In_ unsigned int cpuAccessFlags, _In_ unsigned int miscFlags,
+                                              _Outptr_opt_ ID3D11Resource** texture, _Outptr_opt_ ID3D11ShaderResourceView** textureView);
+}
+
+namespace
+{
+    // Bump when the decoded layout or the key changes, so older cache files are ignored.
+    const uint64_t c_CacheVersion = 1;
+
+    const uint32_t c_IndexMagic = MAKEFOURCC('T', 'X', 'C', 'I');
+
+    //----------------------------------------------------------------------------------
+    // 64-bit content hash (the XXH64 algorithm), which runs at memory speed on the
+    // multi-megabyte images this is used for.
+    //----------------------------------------------------------------------------------
+    const uint64_t c_Prime1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t c_Prime2 = 0xC2B2AE3D27D4EB4FULL;
+    const uint64_t c_Prime3 = 0x165667B19E3779F9ULL;
+    const uint64_t c_Prime4 = 0x85EBCA77C2B2AE63ULL;
+    const uint64_t c_Prime5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t HashRound(uint64_t acc, uint64_t input)
+    {
+        acc += input * c_Prime2;
+        acc = _rotl64(acc, 31);
+        return acc * c_Prime1;
+    }
+
+    inline uint64_t HashMerge(uint64_t acc, uint64_t value)
+    {
+        acc ^= HashRound(0, value);
+        return acc * c_Prime1 + c_Prime4;
+    }
+
+    inline uint64_t Read64(_In_reads_bytes_(8) const uint8_t* ptr)
+    {
+        uint64_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t Read32(_In_reads_bytes_(4) const uint8_t* ptr)
+    {
+        uint32_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    uint64_t HashContent(_In_reads_bytes_(size) const uint8_t* data, size_t size, uint64_t seed = 0)
+    {
+        const uint8_t* ptr = data;
+        const uint8_t* end = data + size;
+
+        uint64_t hash;
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + c_Prime1 + c_Prime2;
+            uint64_t v2 = seed + c_Prime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - c_Prime1;
+
+            const uint8_t* limit = end - 32;
+            do
+            {
+                v1 = HashRound(v1, Read64(ptr));
+                v2 = HashRound(v2, Read64(ptr + 8));
+                v3 = HashRound(v3, Read64(ptr + 16));
+                v4 = HashRound(v4, Read64(ptr + 24));
+                ptr += 32;
+            } while (ptr <= limit);
+
+            hash = _rotl64(v1, 1) + _rotl64(v2, 7) + _rotl64(v3, 12) + _rotl64(v4, 18);
+            hash = HashMerge(hash, v1);
+            hash = HashMerge(hash, v2);
+            hash = HashMerge(hash, v3);
+            hash = HashMerge(hash, v4);
+        }
+        else
+        {
+            hash = seed + c_Prime5;
+        }
+
+        hash += static_cast<uint64_t>(size);
+
+        for (; ptr + 8 <= end; ptr += 8)
+        {
+            hash ^= HashRound(0, Read64(ptr));
+            hash = _rotl64(hash, 27) * c_Prime1 + c_Prime4;
+        }
+
+        if (ptr + 4 <= end)
+        {
+            hash ^= static_cast<uint64_t>(Read32(ptr)) * c_Prime1;
+            hash = _rotl64(hash, 23) * c_Prime2 + c_Prime3;
+            ptr += 4;
+        }
+
+        for (; ptr < end; ++ptr)
+        {
+            hash ^= (*ptr) * c_Prime5;
+            hash = _rotl64(hash, 11) * c_Prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= c_Prime2;
+        hash ^= hash >> 29;
+        hash *= c_Prime3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    bool IsDDS(_In_reads_bytes_(size) const uint8_t* data, size_t size)
+    {
+        return (size >= sizeof(uint32_t) + sizeof(DDS_HEADER)) && (Read32(data) == DDS_MAGIC);
+    }
+
+    //----------------------------------------------------------------------------------
+    // Writes a decoded image and its mips as a 'DX10' .dds file, via a temporary file so
+    // readers never see a partial image.
+    //----------------------------------------------------------------------------------
+    HRESULT WriteDecodedImage(_In_z_ const wchar_t* fileName, const DecodedImage& image)
+    {
+        if (image.levels.empty() || !BitsPerPixel(image.format))
+            return E_INVALIDARG;
+
+        std::wstring tempName(fileName);
+        tempName += L".tmp";
+
+        {
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+            ScopedHandle hFile(safe_handle(CreateFile2(tempName.c_str(), GENERIC_WRITE | DELETE, 0, CREATE_ALWAYS, nullptr)));
+#else
+            ScopedHandle hFile(safe_handle(CreateFileW(tempName.c_str(), GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, 0, nullptr)));
+#endif
+            if (!hFile)
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            auto_delete_file delonfail(hFile.get());
+
+            uint8_t fileHeader[sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)] = {};
+
+            *reinterpret_cast<uint32_t*>(&fileHeader[0]) = DDS_MAGIC;
+
+            auto& top = image.levels[0];
+
+            auto header = reinterpret_cast<DDS_HEADER*>(&fileHeader[0] + sizeof(uint32_t));
+            header->size = sizeof(DDS_HEADER);
+            header->flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP | DDS_HEADER_FLAGS_PITCH;
+            header->height = static_cast<uint32_t>(top.height);
+            header->width = static_cast<uint32_t>(top.width);
+            header->pitchOrLinearSize = static_cast<uint32_t>(top.rowPitch);
+            header->mipMapCount = static_cast<uint32_t>(image.levels.size());
+            header->caps = DDS_SURFACE_FLAGS_TEXTURE;
+            memcpy_s(&header->ddspf, sizeof(header->ddspf), &DDSPF_DX10, sizeof(DDS_PIXELFORMAT));
+
+            auto extHeader = reinterpret_cast<DDS_HEADER_DXT10*>(&fileHeader[0] + sizeof(uint32_t) + sizeof(DDS_HEADER));
+            extHeader->dxgiFormat = image.format;
+            extHeader->resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+            extHeader->arraySize = 1;
+
+            DWORD bytesWritten;
+            if (!WriteFile(hFile.get(), fileHeader, static_cast<DWORD>(sizeof(fileHeader)), &bytesWritten, nullptr))
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            if (bytesWritten != sizeof(fileHeader))
+                return E_FAIL;
+
+            for (auto it = image.levels.cbegin(); it != image.levels.cend(); ++it)
+            {
+                if (!WriteFile(hFile.get(), it->pixels.data(), static_cast<DWORD>(it->pixels.size()), &bytesWritten, nullptr))
+                    return HRESULT_FROM_WIN32(GetLastError());
+
+                if (bytesWritten != it->pixels.size())
+                    return E_FAIL;
+            }
+
+            delonfail.clear();
+        }
+
+        if (!MoveFileExW(tempName.c_str(), fileName, MOVEFILE_REPLACE_EXISTING))
+        {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            DeleteFileW(tempName.c_str());
+            return hr;
+        }
+
+        return S_OK;
+    }
+
+    //----------------------------------------------------------------------------------
+    HRESULT ReadDecodedImage(_In_z_ const wchar_t* fileName, DecodedImage& image)
+    {
+        std::unique_ptr<uint8_t[]> ddsData;
+        const DDS_HEADER* header = nullptr;
+        const uint8_t* bitData = nullptr;
+        size_t bitSize = 0;
+        HRESULT hr = LoadTextureDataFromFile(fileName, ddsData, &header, &bitData, &bitSize);
+        if (FAILED(hr))
+            return hr;
+
+        if (!(header->ddspf.flags & DDS_FOURCC) || header->ddspf.fourCC != MAKEFOURCC('D', 'X', '1', '0'))
+            return E_FAIL;
+
+        auto extHeader = reinterpret_cast<const DDS_HEADER_DXT10*>(reinterpret_cast<const uint8_t*>(header) + sizeof(DDS_HEADER));
+        if (extHeader->resourceDimension != D3D11_RESOURCE_DIMENSION_TEXTURE2D
+            || extHeader->arraySize != 1
+            || !BitsPerPixel(extHeader->dxgiFormat)
+            || !header->width || !header->height || !header->mipMapCount)
+            return E_FAIL;
+
+        image.format = extHeader->dxgiFormat;
+        image.levels.clear();
+
+        size_t width = header->width;
+        size_t height = header->height;
+
+        try
+        {
+            image.levels.resize(header->mipMapCount);
+
+            for (auto it = image.levels.begin(); it != image.levels.end(); ++it)
+            {
+                size_t numBytes, rowBytes;
+                GetSurfaceInfo(width, height, image.format, &numBytes, &rowBytes, nullptr);
+
+                if (numBytes > bitSize)
+                    return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+                it->width = width;
+                it->height = height;
+                it->rowPitch = rowBytes;
+                it->pixels.assign(bitData, bitData + numBytes);
+
+                bitData += numBytes;
+                bitSize -= numBytes;
+
+                width = std::max<size_t>(width >> 1, 1);
+                height = std::max<size_t>(height >> 1, 1);
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        return S_OK;
+    }
+}
+
+
+// Internal TextureCache implementation class.
+class TextureCache::Impl
+{
+public:
+    Impl(size_t memoryBudget, _In_opt_z_ const wchar_t* cacheDirectory);
+    ~Impl();
+
+    HRESULT CreateTextureFromFile(_In_ ID3D11Device* d3dDevice, _In_opt_ ID3D11DeviceContext* d3dContext, _In_z_ const wchar_t* fileName,
+                                  bool forceSRGB, size_t maxsize,
+                                  _Outptr_opt_ ID3D11Resource** texture, _Outptr_opt_ ID3D11ShaderResourceView** textureView);
+
+    HRESULT CreateTexture(_In_ ID3D11Device* d3dDevice, _In_opt_ ID3D11DeviceContext* d3dContext, uint64_t contentHash,
+                          std::unique_ptr<uint8_t[]>& data, size_t dataSize, _In_opt_z_ const wchar_t* fileName,
+                          bool forceSRGB, size_t maxsize,
+                          _Outptr_opt_ ID3D11Resource** texture, _Outptr_opt_ ID3D11ShaderResourceView** textureView);
+
+    void SetMemoryBudget(size_t bytes);
+    void Trim();
+    TextureCache::Statistics GetStatistics() const;
+
+private:
+    // A cached image: DDS files are kept as read, since they need no decoding.
+    struct CachedImage
+    {
+        std::unique_ptr<uint8_t[]>  ddsData;
+        size_t                      ddsSize;
+        DecodedImage                decoded;
+        size_t                      size;
+    };
+
+    typedef std::shared_ptr<const CachedImage> ImagePtr;
+
+    struct Entry
+    {
+        ImagePtr                        image;
+        std::list<uint64_t>::iterator   lru;
+    };
+
+    // Content hash of a file as of its size and last write time.
+    struct FileStamp
+    {
+        uint64_t    fileSize;
+        uint64_t    writeTime;
+        uint64_t    contentHash;
+    };
+
+    ImagePtr Find(uint64_t key);
+    ImagePtr Insert(uint64_t key, ImagePtr const& image);
+    void EvictToBudget();
+
+    std::wstring GetCacheFileName(uint64_t key) const;
+    void LoadIndex();
+    void SaveIndex();
+
+    mutable std::mutex mMutex;
+    std::unordered_map<uint64_t, Entry> mEntries;
+    std::list<uint64_t> mLRU;                           // Most recently used first
+    std::unordered_map<std::wstring, FileStamp> mFiles;
+    bool mFilesChanged;
+
+    size_t mBudget;
+    std::wstring mDirectory;                            // Empty if decoded images stay in memory only
+
+    TextureCache::Statistics mStats;
+};
+
+
+TextureCache::Impl::Impl(size_t memoryBudget, const wchar_t* cacheDirectory)
+  : mFilesChanged(false),
+    mBudget(memoryBudget),
+    mStats{}
+{
+    if (cacheDirectory && *cacheDirectory)
+    {
+        if (CreateDirectoryW(cacheDirectory, nullptr) || GetLastError() == ERROR_ALREADY_EXISTS)
+        {
+            mDirectory = cacheDirectory;
+            if (mDirectory.back() != L'\\' && mDirectory.back() != L'/')
+            {
+                mDirectory += L'\\';
+            }
+
+            LoadIndex();
+        }
+        else
+        {
+            DebugTrace("TextureCache could not create '%ls' (%08X); decoded images are kept in memory only\n",
+                       cacheDirectory, static_cast<unsigned int>(HRESULT_FROM_WIN32(GetLastError())));
+        }
+    }
+}
+
+
+TextureCache::Impl::~Impl()
+{
+    if (mFilesChanged)
+    {
+        SaveIndex();
+    }
+}
+
+
+_Use_decl_annotations_
+HRESULT TextureCache::Impl::CreateTextureFromFile(ID3D11Device* d3dDevice, ID3D11DeviceContext* d3dContext, const wchar_t* fileName,
+                                                  bool forceSRGB, size_t maxsize,
+                                                  ID3D11Resource** texture, ID3D11ShaderResourceView** textureView)
+{
+    wchar_t fullName[MAX_PATH] = {};
+    DWORD length = GetFullPathNameW(fileName, MAX_PATH, fullName, nullptr);
+    if (!length || length >= MAX_PATH)
+    {
+        wcscpy_s(fullName, MAX_PATH, fileName);
+    }
+
+    WIN32_FILE_ATTRIBUTE_DATA fileAttr = {};
+    if (!GetFileAttributesExW(fullName, GetFileExInfoStandard, &fileAttr))
+        return HRESULT_FROM_WIN32(GetLastError());
+
+    FileStamp stamp;
+    stamp.fileSize = (static_cast<uint64_t>(fileAttr.nFileSizeHigh) << 32) | fileAttr.nFileSizeLow;
+    stamp.writeTime = (static_cast<uint64_t>(fileAttr.ftLastWriteTime.dwHighDateTime) << 32) | fileAttr.ftLastWriteTime.dwLowDateTime;
+    stamp.contentHash = 0;
+
+    bool known = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        auto it = mFiles.find(fullName);
+        if (it != mFiles.end() && it->second.fileSize == stamp.fileSize && it->second.writeTime == stamp.writeTime)
+        {
+            stamp.contentHash = it->second.contentHash;
+            known = true;
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> data;
+    size_t dataSize = 0;
+
+    if (!known)
+    {
+        HRESULT hr = BinaryReader::ReadEntireFile(fullName, data, &dataSize);
+        if (FAILED(hr))
+            return hr;
+
+        stamp.contentHash = HashContent(data.get(), dataSize);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFiles[fullName] = stamp;
+        mFilesChanged = true;
+    }
+
+    return CreateTexture(d3dDevice, d3dContext, stamp.contentHash, data, dataSize, fullName, forceSRGB, maxsize, texture, textureView);
+}
+
+
+// Looks the image up in memory, then in the cache directory, and decodes it only if neither has it.
+// data may be empty if the file hasn't been read, in which case fileName is read on a miss.
+_Use_decl_annotations_
+HRESULT TextureCache::Impl::CreateTexture(ID3D11Device* d3dDevice, ID3D11DeviceContext* d3dContext, uint64_t contentHash,
+                                          std::unique_ptr<uint8_t[]>& data, size_t dataSize, const wchar_t* fileName,
+                                          bool forceSRGB, size_t maxsize,
+                                          ID3D11Resource** texture, ID3D11ShaderResourceView** textureView)
+{
+#if defined(_XBOX_ONE) && defined(_TITLE)
+    // Auto-gen mipmaps need the Xbox device extensions, which the cache doesn't take
+    d3dContext = nullptr;
+#endif
+
+    bool autogen = (d3dContext != 0 && textureView != 0);
+    unsigned int loadFlags = forceSRGB ? WIC_LOADER_FORCE_SRGB : WIC_LOADER_DEFAULT;
+
+    // The decoded result also depends on the size limit (which defaults to the feature level's)
+    // and on whether the R32G32B32 fallback for auto-gen mipmaps applies.
+    uint64_t keyData[] =
+    {
+        contentHash,
+        static_cast<uint64_t>(maxsize),
+        static_cast<uint64_t>(maxsize ? 0 : d3dDevice->GetFeatureLevel()),
+        static_cast<uint64_t>(loadFlags) | (autogen ? 0x100u : 0u),
+    };
+    uint64_t key = HashContent(reinterpret_cast<const uint8_t*>(keyData), sizeof(keyData), c_CacheVersion);
+
+    auto image = Find(key);
+
+    if (!image && !mDirectory.empty())
+    {
+        auto cached = std::make_shared<CachedImage>();
+        if (SUCCEEDED(ReadDecodedImage(GetCacheFileName(key).c_str(), cached->decoded)))
+        {
+            cached->ddsSize = 0;
+            cached->size = cached->decoded.GetSize();
+            image = Insert(key, cached);
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++mStats.diskHits;
+        }
+    }
+
+    // Devices with other format support may need a different conversion
+    if (image && !image->ddsData)
+    {
+        UINT support = 0;
+        HRESULT hr = d3dDevice->CheckFormatSupport(image->decoded.format, &support);
+        if (FAILED(hr) || !(support & D3D11_FORMAT_SUPPORT_TEXTURE2D))
+        {
+            image.reset();
+        }
+    }
+
+    if (!image)
+    {
+        if (!data)
+        {
+            if (!fileName)
+                return E_INVALIDARG;
+
+            HRESULT hr = BinaryReader::ReadEntireFile(fileName, data, &dataSize);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        auto decoded = std::make_shared<CachedImage>();
+        if (IsDDS(data.get(), dataSize))
+        {
+            decoded->ddsData = std::move(data);
+            decoded->ddsSize = dataSize;
+            decoded->size = dataSize;
+        }
+        else
+        {
+            HRESULT hr = _DecodeWICImage(d3dDevice, data.get(), dataSize, maxsize, autogen, loadFlags, decoded->decoded);
+            if (FAILED(hr))
+                return hr;
+
+            decoded->ddsSize = 0;
+            decoded->size = decoded->decoded.GetSize();
+
+            if (!mDirectory.empty())
+            {
+                hr = WriteDecodedImage(GetCacheFileName(key).c_str(), decoded->decoded);
+                if (FAILED(hr))
+                {
+                    DebugTrace("TextureCache failed (%08X) to write decoded image for '%ls'\n",
+                               static_cast<unsigned int>(hr), fileName ? fileName : L"<memory>");
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ++mStats.decodes;
+        }
+
+        image = Insert(key, decoded);
+    }
+
+    if (image->ddsData)
+    {
+        return CreateDDSTextureFromMemoryEx(d3dDevice, image->ddsData.get(), image->ddsSize, maxsize,
+                                            D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+                                            forceSRGB, texture, textureView);
+    }
+
+    return _CreateTextureFromDecodedImage(d3dDevice, d3dContext, image->decoded,
+                                          D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+                                          texture, textureView);
+}
+
+
+TextureCache::Impl::ImagePtr TextureCache::Impl::Find(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(key);
+    if (it == mEntries.end())
+        return nullptr;
+
+    mLRU.splice(mLRU.begin(), mLRU, it->second.lru);
+    ++mStats.memoryHits;
+    return it->second.image;
+}
+
+
+// Adds the image unless another thread got there first, and returns whichever is cached.
+// Images larger than the whole budget are used once and not kept.
+TextureCache::Impl::ImagePtr TextureCache::Impl::Insert(uint64_t key, ImagePtr const& image)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(key);
+    if (it != mEntries.end())
+    {
+        mLRU.splice(mLRU.begin(), mLRU, it->second.lru);
+        return it->second.image;
+    }
+
+    if (image->size > mBudget)
+        return image;
+
+    mLRU.push_front(key);
+
+    Entry entry;
+    entry.image = image;
+    entry.lru = mLRU.begin();
+    mEntries.insert(std::make_pair(key, entry));
+
+    mStats.residentBytes += image->size;
+    EvictToBudget();
+
+    return image;
+}
+
+
+// Called with mMutex held.
+void TextureCache::Impl::EvictToBudget()
+{
+    while (mStats.residentBytes > mBudget && !mLRU.empty())
+    {
+        auto it = mEntries.find(mLRU.back());
+        assert(it != mEntries.end());
+
+        mStats.residentBytes -= it->second.image->size;
+        ++mStats.evictions;
+
+        mEntries.erase(it);
+        mLRU.pop_back();
+    }
+}
+
+
+void TextureCache::Impl::SetMemoryBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBudget = bytes;
+    EvictToBudget();
+}
+
+
+void TextureCache::Impl::Trim()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+    mLRU.clear();
+    mStats.residentBytes = 0;
+}
+
+
+TextureCache::Statistics TextureCache::Impl::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+
+std::wstring TextureCache::Impl::GetCacheFileName(uint64_t key) const
+{
+    wchar_t name[32] = {};
+    swprintf_s(name, L"%016llx.dds", static_cast<unsigned long long>(key));
+    return mDirectory + name;
+}
+
+
+// The index maps source files to their content hash, so unchanged files aren't read again:
+// a header and count, then per file its size, write time, hash, name length and name.
+void TextureCache::Impl::LoadIndex()
+{
+    std::unique_ptr<uint8_t[]> data;
+    size_t dataSize = 0;
+    if (FAILED(BinaryReader::ReadEntireFile((mDirectory + L"index.bin").c_str(), data, &dataSize)))
+        return;
+
+    const uint8_t* ptr = data.get();
+    const uint8_t* end = ptr + dataSize;
+
+    if (dataSize < 3 * sizeof(uint32_t)
+        || Read32(ptr) != c_IndexMagic
+        || Read32(ptr + 4) != static_cast<uint32_t>(c_CacheVersion))
+    {
+        DebugTrace("TextureCache ignoring out of date index in '%ls'\n", mDirectory.c_str());
+        return;
+    }
+
+    uint32_t count = Read32(ptr + 8);
+    ptr += 3 * sizeof(uint32_t);
+
+    for (uint32_t j = 0; j < count; ++j)
+    {
+        if (size_t(end - ptr) < 3 * sizeof(uint64_t) + sizeof(uint32_t))
+            break;
+
+        FileStamp stamp;
+        stamp.fileSize = Read64(ptr);
+        stamp.writeTime = Read64(ptr + 8);
+        stamp.contentHash = Read64(ptr + 16);
+        uint32_t nameLength = Read32(ptr + 24);
+        ptr += 3 * sizeof(uint64_t) + sizeof(uint32_t);
+
+        if (size_t(end - ptr) < size_t(nameLength) * sizeof(wchar_t))
+            break;
+
+        std::wstring name(nameLength, L'\0');
+        memcpy(&name[0], ptr, nameLength * sizeof(wchar_t));
+        ptr += nameLength * sizeof(wchar_t);
+
+        mFiles[name] = stamp;
+    }
+}
+
+
+void TextureCache::Impl::SaveIndex()
+{
+    std::vector<uint8_t> index;
+
+    auto append = [&index](const void* value, size_t size)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(value);
+        index.insert(index.end(), bytes, bytes + size);
+    };
+
+    uint32_t header[3] = { c_IndexMagic, static_cast<uint32_t>(c_CacheVersion), static_cast<uint32_t>(mFiles.size()) };
+    append(header, sizeof(header));
+
+    for (auto it = mFiles.cbegin(); it != mFiles.cend(); ++it)
+    {
+        uint32_t nameLength = static_cast<uint32_t>(it->first.size());
+        append(&it->second.fileSize, sizeof(uint64_t));
+        append(&it->second.writeTime, sizeof(uint64_t));
+        append(&it->second.contentHash, sizeof(uint64_t));
+        append(&nameLength, sizeof(uint32_t));
+        append(it->first.c_str(), nameLength * sizeof(wchar_t));
+    }
+
+    std::wstring fileName = mDirectory + L"index.bin";
+
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile(safe_handle(CreateFile2(fileName.c_str(), GENERIC_WRITE | DELETE, 0, CREATE_ALWAYS, nullptr)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(fileName.c_str(), GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, 0, nullptr)));
+#endif
+    if (!hFile)
+    {
+        DebugTrace("TextureCache could not write index (%08X)\n", static_cast<unsigned int>(HRESULT_FROM_WIN32(GetLastError())));
+        return;
+    }
+
+    auto_delete_file delonfail(hFile.get());
+
+    DWORD bytesWritten;
+    if (WriteFile(hFile.get(), index.data(), static_cast<DWORD>(index.size()), &bytesWritten, nullptr) && bytesWritten == index.size())
+    {
+        delonfail.clear();
+    }
+}
+
+
+// Public constructor.
+_Use_decl_annotations_
+TextureCache::TextureCache(size_t memoryBudget, const wchar_t* cacheDirectory)
+  : pImpl(new Impl(memoryBudget, cacheDirectory))
+{
+}
+
+
+// Move constructor.
+TextureCache::TextureCache(TextureCache&& moveFrom)
+  : pImpl(std::move(moveFrom.pImpl))
+{
+}
+
+
+// Move assignment.
+TextureCache& TextureCache::operator= (TextureCache&& moveFrom)
+{
+    pImpl = std::move(moveFrom.pImpl);
+    return *this;
+}
+
+
+// Public destructor.
+TextureCache::~TextureCache()
+{
+}
+
+
+_Use_decl_annotations_
+HRESULT TextureCache::CreateTextureFromFile(ID3D11Device* d3dDevice, ID3D11DeviceContext* d3dContext, const wchar_t* szFileName,
+                                            ID3D11Resource** texture, ID3D11ShaderResourceView** textureView,
+                                            bool forceSRGB, size_t maxsize)
+{
+    if (texture)
+    {
+        *texture = nullptr;
+    }
+    if (textureView)
+    {
+        *textureView = nullptr;
+    }
+
+    if (!d3dDevice || !szFileName || (!texture && !textureView))
+        return E_INVALIDARG;
+
+    HRESULT hr = pImpl->CreateTextureFromFile(d3dDevice, d3dContext, szFileName, forceSRGB, maxsize, texture, textureView);
+
+    if (SUCCEEDED(hr))
+    {
+        if (texture != 0 && *texture != 0)
+        {
+            SetDebugObjectName(*texture, "TextureCache");
+        }
+
+        if (textureView != 0 && *textureView != 0)
+        {
+            SetDebugObjectName(*textureView, "TextureCache");
+        }
+    }
+
+    return hr;
+}
+
+
+_Use_decl_annotations_
+HRESULT TextureCache::CreateTextureFromMemory(ID3D11Device* d3dDevice, ID3D11DeviceContext* d3dContext,
+                                              const uint8_t* data, size_t dataSize,
+                                              ID3D11Resource** texture, ID3D11ShaderResourceView** textureView,
+                                              bool forceSRGB, size_t maxsize)
+{
+    if (texture)
+    {
+        *texture = nullptr;
+    }
+    if (textureView)
+    {
+        *textureView = nullptr;
+    }
+
+    if (!d3dDevice || !data || !dataSize || (!texture && !textureView))
+        return E_INVALIDARG;
+
+    // The caller keeps its buffer, so DDS data that gets cached is copied on a miss
+    std::unique_ptr<uint8_t[]> copy(new (std::nothrow) uint8_t[dataSize]);
+    if (!copy)
+        return E_OUTOFMEMORY;
+
+    memcpy(copy.get(), data, dataSize);
+
+    HRESULT hr = pImpl->CreateTexture(d3dDevice, d3dContext, HashContent(data, dataSize), copy, dataSize, nullptr,
+                                      forceSRGB, maxsize, texture, textureView);
+
+    if (SUCCEEDED(hr))
+    {
+        if (texture != 0 && *texture != 0)
+        {
+            SetDebugObjectName(*texture, "TextureCache");
+        }
+
+        if (textureView != 0 && *textureView != 0)
+        {
+            SetDebugObjectName(*textureView, "TextureCache");
+        }
+    }
+
+    return hr;
+}
+
+
+void TextureCache::SetMemoryBudget(size_t bytes)
+{
+    pImpl->SetMemoryBudget(bytes);
+}
+
+
+void TextureCache::Trim()
+{
+    pImpl->Trim();
+}
+
+
+TextureCache::Statistics TextureCache::GetStatistics() const
+{
+    return pImpl->GetStatistics();
+}
@@ -7,7 +7,8 @@
 // Note: Assumes application has already called CoInitializeEx
 //
 // Warning: CreateWICTexture* functions are not thread-safe if given a d3dContext instance for
-//          auto-gen mipmap support.
+//          auto-gen mipmap support. WIC_LOADER_CPU_MIPS builds the mipmaps on the CPU instead,
+//          which needs no d3dContext.
 //
 // Note these functions are useful for images created as simple 2D textures. For
 // more complex resources, DDSTextureLoader is an excellent light-weight runtime loader.
@@ -35,6 +36,7 @@
 #include "DirectXHelpers.h"
 #include "PlatformHelpers.h"
 #include "LoaderHelpers.h"
+#include "MipGenerator.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -258,21 +260,15 @@ namespace
     }
 
     //---------------------------------------------------------------------------------
-    HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
-        _In_opt_ ID3D11DeviceContext* d3dContext,
-#if defined(_XBOX_ONE) && defined(_TITLE)
-        _In_opt_ ID3D11DeviceX* d3dDeviceX,
-        _In_opt_ ID3D11DeviceContextX* d3dContextX,
-#endif
+    // Decodes the frame into system memory, resizing and converting it to a DXGI format the
+    // device supports, and builds the CPU mip chain if WIC_LOADER_CPU_MIPS is given. autogen
+    // says whether the caller will ask for auto-generated mipmaps.
+    HRESULT DecodeWIC(_In_ ID3D11Device* d3dDevice,
         _In_ IWICBitmapFrameDecode *frame,
         _In_ size_t maxsize,
-        _In_ D3D11_USAGE usage,
-        _In_ unsigned int bindFlags,
-        _In_ unsigned int cpuAccessFlags,
-        _In_ unsigned int miscFlags,
+        _In_ bool autogen,
         _In_ unsigned int loadFlags,
-        _Outptr_opt_ ID3D11Resource** texture,
-        _Outptr_opt_ ID3D11ShaderResourceView** textureView)
+        _Out_ LoaderHelpers::DecodedImage& image)
     {
         UINT width, height;
         HRESULT hr = frame->GetSize(&width, &height);
@@ -389,7 +385,7 @@ namespace
         }
 
 #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8) || defined(_WIN7_PLATFORM_UPDATE)
-        if ((format == DXGI_FORMAT_R32G32B32_FLOAT) && d3dContext != 0 && textureView != 0)
+        if ((format == DXGI_FORMAT_R32G32B32_FLOAT) && autogen)
         {
             // Special case test for optional device support for autogen mipchains for R32G32B32_FLOAT 
             UINT fmtSupport = 0;
@@ -480,9 +476,24 @@ namespace
         size_t rowPitch = (twidth * bpp + 7) / 8;
         size_t imageSize = rowPitch * theight;
 
-        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[imageSize]);
-        if (!temp)
+        image.format = format;
+        image.levels.clear();
+
+        try
+        {
+            image.levels.resize(1);
+            image.levels[0].pixels.resize(imageSize);
+        }
+        catch (const std::bad_alloc&)
+        {
             return E_OUTOFMEMORY;
+        }
+
+        image.levels[0].width = twidth;
+        image.levels[0].height = theight;
+        image.levels[0].rowPitch = rowPitch;
+
+        uint8_t* temp = image.levels[0].pixels.data();
 
         // Load image data
         if (memcmp(&convertGUID, &pixelFormat, sizeof(GUID)) == 0
@@ -490,7 +501,7 @@ namespace
             && theight == height)
         {
             // No format conversion or resize needed
-            hr = frame->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+            hr = frame->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
             if (FAILED(hr))
                 return hr;
         }
@@ -518,7 +529,7 @@ namespace
             if (memcmp(&convertGUID, &pfScaler, sizeof(GUID)) == 0)
             {
                 // No format conversion needed
-                hr = scaler->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+                hr = scaler->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
                 if (FAILED(hr))
                     return hr;
             }
@@ -540,7 +551,7 @@ namespace
                 if (FAILED(hr))
                     return hr;
 
-                hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+                hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
                 if (FAILED(hr))
                     return hr;
             }
@@ -568,17 +579,93 @@ namespace
             if (FAILED(hr))
                 return hr;
 
-            hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp.get());
+            hr = FC->CopyPixels(0, static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize), temp);
             if (FAILED(hr))
                 return hr;
         }
 
+        // Build the mip chain on the CPU if requested; sRGB formats are filtered in linear space
+        if (loadFlags & WIC_LOADER_CPU_MIPS)
+        {
+            bool cpuMips = true;
+            unsigned mipFlags = MipGeneration::MIP_DEFAULT;
+
+            switch (format)
+            {
+            case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+                mipFlags = MipGeneration::MIP_SRGB;
+                break;
+
+            case DXGI_FORMAT_R8G8B8A8_UNORM:
+            case DXGI_FORMAT_B8G8R8A8_UNORM:
+            case DXGI_FORMAT_B8G8R8X8_UNORM:
+                break;
+
+            default:
+                cpuMips = false;
+                break;
+            }
+
+            if (cpuMips)
+            {
+                try
+                {
+                    std::vector<MipGeneration::MipLevel> mips;
+                    MipGeneration::GenerateMipChain(temp, twidth, theight, rowPitch, 0, mipFlags, mips);
+
+                    image.levels.resize(mips.size());
+                    for (size_t level = 0; level < mips.size(); ++level)
+                    {
+                        image.levels[level].width = mips[level].width;
+                        image.levels[level].height = mips[level].height;
+                        image.levels[level].rowPitch = mips[level].width * 4;
+                        image.levels[level].pixels = std::move(mips[level].pixels);
+                    }
+                }
+                catch (const std::bad_alloc&)
+                {
+                    return E_OUTOFMEMORY;
+                }
+                catch (const std::exception&)
+                {
+                    return E_FAIL;
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Creates the texture from a decoded image, auto-generating the mipmaps on the GPU when
+    // only the top level was decoded and a context and shader-view were given.
+    HRESULT CreateTextureFromImage(_In_ ID3D11Device* d3dDevice,
+        _In_opt_ ID3D11DeviceContext* d3dContext,
+#if defined(_XBOX_ONE) && defined(_TITLE)
+        _In_opt_ ID3D11DeviceX* d3dDeviceX,
+        _In_opt_ ID3D11DeviceContextX* d3dContextX,
+#endif
+        _In_ const LoaderHelpers::DecodedImage& image,
+        _In_ D3D11_USAGE usage,
+        _In_ unsigned int bindFlags,
+        _In_ unsigned int cpuAccessFlags,
+        _In_ unsigned int miscFlags,
+        _Outptr_opt_ ID3D11Resource** texture,
+        _Outptr_opt_ ID3D11ShaderResourceView** textureView)
+    {
+        if (image.levels.empty())
+            return E_INVALIDARG;
+
+        auto& top = image.levels[0];
+
         // See if format is supported for auto-gen mipmaps (varies by feature level)
         bool autogen = false;
-        if (d3dContext != 0 && textureView != 0) // Must have context and shader-view to auto generate mipmaps
+        if (d3dContext != 0 && textureView != 0 && image.levels.size() == 1) // Must have context and shader-view to auto generate mipmaps
         {
             UINT fmtSupport = 0;
-            hr = d3dDevice->CheckFormatSupport(format, &fmtSupport);
+            HRESULT hr = d3dDevice->CheckFormatSupport(image.format, &fmtSupport);
             if (SUCCEEDED(hr) && (fmtSupport & D3D11_FORMAT_SUPPORT_MIP_AUTOGEN))
             {
                 autogen = true;
@@ -591,11 +678,11 @@ namespace
 
         // Create texture
         D3D11_TEXTURE2D_DESC desc;
-        desc.Width = twidth;
-        desc.Height = theight;
-        desc.MipLevels = (autogen) ? 0 : 1;
+        desc.Width = static_cast<UINT>(top.width);
+        desc.Height = static_cast<UINT>(top.height);
+        desc.MipLevels = (autogen) ? 0 : static_cast<UINT>(image.levels.size());
         desc.ArraySize = 1;
-        desc.Format = format;
+        desc.Format = image.format;
         desc.SampleDesc.Count = 1;
         desc.SampleDesc.Quality = 0;
         desc.Usage = usage;
@@ -612,13 +699,19 @@ namespace
             desc.MiscFlags = miscFlags;
         }
 
-        D3D11_SUBRESOURCE_DATA initData;
-        initData.pSysMem = temp.get();
-        initData.SysMemPitch = static_cast<UINT>(rowPitch);
-        initData.SysMemSlicePitch = static_cast<UINT>(imageSize);
+        std::unique_ptr<D3D11_SUBRESOURCE_DATA[]> initData(new (std::nothrow) D3D11_SUBRESOURCE_DATA[image.levels.size()]);
+        if (!initData)
+            return E_OUTOFMEMORY;
+
+        for (size_t level = 0; level < image.levels.size(); ++level)
+        {
+            initData[level].pSysMem = image.levels[level].pixels.data();
+            initData[level].SysMemPitch = static_cast<UINT>(image.levels[level].rowPitch);
+            initData[level].SysMemSlicePitch = static_cast<UINT>(image.levels[level].pixels.size());
+        }
 
         ID3D11Texture2D* tex = nullptr;
-        hr = d3dDevice->CreateTexture2D(&desc, (autogen) ? nullptr : &initData, &tex);
+        HRESULT hr = d3dDevice->CreateTexture2D(&desc, (autogen) ? nullptr : initData.get(), &tex);
         if (SUCCEEDED(hr) && tex != 0)
         {
             if (textureView != 0)
@@ -627,7 +720,7 @@ namespace
                 SRVDesc.Format = desc.Format;
 
                 SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-                SRVDesc.Texture2D.MipLevels = (autogen) ? -1 : 1;
+                SRVDesc.Texture2D.MipLevels = (autogen || image.levels.size() > 1) ? -1 : 1;
 
                 hr = d3dDevice->CreateShaderResourceView(tex, &SRVDesc, textureView);
                 if (FAILED(hr))
@@ -642,12 +735,9 @@ namespace
 
 #if defined(_XBOX_ONE) && defined(_TITLE)
                     ID3D11Texture2D *pStaging = nullptr;
-                    CD3D11_TEXTURE2D_DESC stagingDesc(format, twidth, theight, 1, 1, 0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ, 1, 0, 0);
-                    initData.pSysMem = temp.get();
-                    initData.SysMemPitch = static_cast<UINT>(rowPitch);
-                    initData.SysMemSlicePitch = static_cast<UINT>(imageSize);
+                    CD3D11_TEXTURE2D_DESC stagingDesc(image.format, desc.Width, desc.Height, 1, 1, 0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ, 1, 0, 0);
 
-                    hr = d3dDevice->CreateTexture2D(&stagingDesc, &initData, &pStaging);
+                    hr = d3dDevice->CreateTexture2D(&stagingDesc, initData.get(), &pStaging);
                     if (SUCCEEDED(hr))
                     {
                         d3dContext->CopySubresourceRegion(tex, 0, 0, 0, 0, pStaging, 0, nullptr);
@@ -657,7 +747,7 @@ namespace
                         pStaging->Release();
                     }
 #else
-                    d3dContext->UpdateSubresource(tex, 0, nullptr, temp.get(), static_cast<UINT>(rowPitch), static_cast<UINT>(imageSize));
+                    d3dContext->UpdateSubresource(tex, 0, nullptr, top.pixels.data(), static_cast<UINT>(top.rowPitch), static_cast<UINT>(top.pixels.size()));
 #endif
                     d3dContext->GenerateMips(*textureView);
                 }
@@ -676,8 +766,126 @@ namespace
 
         return hr;
     }
+
+    //---------------------------------------------------------------------------------
+    HRESULT CreateTextureFromWIC(_In_ ID3D11Device* d3dDevice,
+        _In_opt_ ID3D11DeviceContext* d3dContext,
+#if defined(_XBOX_ONE) && defined(_TITLE)
+        _In_opt_ ID3D11DeviceX* d3dDeviceX,
+        _In_opt_ ID3D11DeviceContextX* d3dContextX,
+#endif
+        _In_ IWICBitmapFrameDecode *frame,
+        _In_ size_t maxsize,
+        _In_ D3D11_USAGE usage,
+        _In_ unsigned int bindFlags,
+        _In_ unsigned int cpuAccessFlags,
+        _In_ unsigned int miscFlags,
+        _In_ unsigned int loadFlags,
+        _Outptr_opt_ ID3D11Resource** texture,
+        _Outptr_opt_ ID3D11ShaderResourceView** textureView)
+    {
+        LoaderHelpers::DecodedImage image;
+        HRESULT hr = DecodeWIC(d3dDevice, frame, maxsize, (d3dContext != 0 && textureView != 0), loadFlags, image);
+        if (FAILED(hr))
+            return hr;
+
+        return CreateTextureFromImage(d3dDevice, d3dContext,
+#if defined(_XBOX_ONE) && defined(_TITLE)
+            d3dDeviceX, d3dContextX,
+#endif
+            image,
+            usage, bindFlags, cpuAccessFlags, miscFlags,
+            texture, textureView);
+    }
 } // anonymous namespace
 
+
+//--------------------------------------------------------------------------------------
+// The decode and create steps on their own, for TextureCache to keep decoded images
+//--------------------------------------------------------------------------------------
+namespace DirectX
+{
+
+    HRESULT _DecodeWICImage(_In_ ID3D11Device* d3dDevice,
+        _In_reads_bytes_(wicDataSize) const uint8_t* wicData,
+        _In_ size_t wicDataSize,
+        _In_ size_t maxsize,
+        _In_ bool autogen,
+        _In_ unsigned int loadFlags,
+        _Out_ LoaderHelpers::DecodedImage& image)
+    {
+        if (!d3dDevice || !wicData || !wicDataSize)
+            return E_INVALIDARG;
+
+        if (wicDataSize > UINT32_MAX)
+            return HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE);
+
+        auto pWIC = _GetWIC();
+        if (!pWIC)
+            return E_NOINTERFACE;
+
+        ComPtr<IWICStream> stream;
+        HRESULT hr = pWIC->CreateStream(stream.GetAddressOf());
+        if (FAILED(hr))
+            return hr;
+
+        hr = stream->InitializeFromMemory(const_cast<uint8_t*>(wicData), static_cast<DWORD>(wicDataSize));
+        if (FAILED(hr))
+            return hr;
+
+        ComPtr<IWICBitmapDecoder> decoder;
+        hr = pWIC->CreateDecoderFromStream(stream.Get(), 0, WICDecodeMetadataCacheOnDemand, decoder.GetAddressOf());
+        if (FAILED(hr))
+            return hr;
+
+        ComPtr<IWICBitmapFrameDecode> frame;
+        hr = decoder->GetFrame(0, frame.GetAddressOf());
+        if (FAILED(hr))
+            return hr;
+
+        return DecodeWIC(d3dDevice, frame.Get(), maxsize, autogen, loadFlags, image);
+    }
+
+    // Auto-gen mipmaps need the Xbox device extensions there, so d3dContext is ignored on that platform.
+    HRESULT _CreateTextureFromDecodedImage(_In_ ID3D11Device* d3dDevice,
+        _In_opt_ ID3D11DeviceContext* d3dContext,
+        _In_ const LoaderHelpers::DecodedImage& image,
+        _In_ D3D11_USAGE usage,
+        _In_ unsigned int bindFlags,
+        _In_ unsigned int cpuAccessFlags,
+        _In_ unsigned int miscFlags,
+        _Outptr_opt_ ID3D11Resource** texture,
+        _Outptr_opt_ ID3D11ShaderResourceView** textureView)
+    {
+        if (texture)
+        {
+            *texture = nullptr;
+        }
+        if (textureView)
+        {
+            *textureView = nullptr;
+        }
+
+        if (!d3dDevice || (!texture && !textureView))
+            return E_INVALIDARG;
+
+#if defined(_XBOX_ONE) && defined(_TITLE)
+        UNREFERENCED_PARAMETER(d3dContext);
+
+        return CreateTextureFromImage(d3dDevice, nullptr, nullptr, nullptr,
+            image,
+            usage, bindFlags, cpuAccessFlags, miscFlags,
+            texture, textureView);
+#else
+        return CreateTextureFromImage(d3dDevice, d3dContext,
+            image,
+            usage, bindFlags, cpuAccessFlags, miscFlags,
+            texture, textureView);
+#endif
+    }
+
+} // namespace DirectX
+
 //--------------------------------------------------------------------------------------
 _Use_decl_annotations_
 HRESULT DirectX::CreateWICTextureFromMemory(ID3D11Device* d3dDevice,
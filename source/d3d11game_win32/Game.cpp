@@ -25,6 +25,12 @@ Game::Game() :
 }
 Game::~Game()
 {
+	// Write out any recorded frames still waiting on the GPU
+	if (m_screenGrab)
+	{
+		m_screenGrab->Flush(m_d3dContext.Get());
+	}
+
 	if (m_audEngine)
 	{
 		m_audEngine->Suspend();
@@ -39,6 +45,9 @@ void Game::Initialize(HWND window, int width, int height)
     m_outputWidth = max(width, 1) * renderrScale;
     m_outputHeight = max(height, 1) * renderrScale;
 
+	// Decoded textures outlive the device, so a device reset doesn't decode them again
+	m_textureCache = std::make_shared<TextureCache>(TextureCache::DefaultMemoryBudget, L"TextureCache");
+
     CreateDevice();
 
     CreateResources();
@@ -82,6 +91,16 @@ void Game::Update(DX::StepTimer const& timer)
 	float t_dock = t_scene3 + 3.f;	// Scene for the docking/boarding
 	float t_end = t_dock + 10.f;	// Scene for the ending
 
+	// Record the crawl as an image sequence while it plays
+	bool inCrawl = timer.GetTotalSeconds() >= t_open && timer.GetTotalSeconds() < t_panStart;
+	if (recordCrawl && inCrawl != m_screenGrab->IsRecording())
+	{
+		if (inCrawl)
+			m_screenGrab->BeginSequence(L"crawl", &GUID_ContainerFormatPng);
+		else
+			m_screenGrab->EndSequence();
+	}
+
 	bool shipChasing = false; // Flag to perform the pursuit logic
 
 	// Ships' chance of shooting
@@ -305,6 +324,12 @@ void Game::Render()
 
     // TODO: Add your rendering code here.
 
+	// Create any model textures that finished loading since the last frame
+	static_cast<EffectFactory*>(m_fxFactory.get())->ProcessTextureLoads(m_d3dContext.Get());
+
+	// Stream in the next few mips of any textures that started at low resolution
+	m_textureStreamer->Update(m_d3dContext.Get());
+
 	// Draw skybox
 	m_sky_fx->SetWorld(m_sky_world);
 	m_sky_fx->SetView(m_view);
@@ -315,20 +340,32 @@ void Game::Render()
 	m_blasterFlash_fx->SetView(m_view);
 	m_blasterFlash_fx->SetProjection(m_sky_proj);
 
-	// Draw models
-	m_stard->Draw(m_d3dContext.Get(), *m_states, m_stard_world, m_view, m_proj);
-	m_runner->Draw(m_d3dContext.Get(), *m_states, m_runner_world, m_view, m_proj);
+	// Queue up the models so their parts get drawn sorted by state (off-screen meshes are culled)
+	m_renderQueue->Begin(m_view, m_proj);
+	m_renderQueue->Enqueue(*m_stard, m_stard_world);
+	m_renderQueue->Enqueue(*m_runner, m_runner_world);
 
 	// Only draw the opening titles when we need too
 	if (drawTitle)
 	{
-		m_title->Draw(m_d3dContext.Get(), *m_states, m_title_world, m_view, m_proj);
-		m_crawl->Draw(m_d3dContext.Get(), *m_states, m_crawl_world, m_view, m_proj);
+		m_renderQueue->Enqueue(*m_title, m_title_world);
 	}
 	
 	// Draw all of our balsterrsss
 	for (int i = 0; i < o_blasters.size(); i++)
-		o_blasters[i]->model->Draw(m_d3dContext.Get(), *m_states, o_blasters[i]->m_world, m_view, m_proj);
+		m_renderQueue->Enqueue(*o_blasters[i]->model, o_blasters[i]->m_world);
+
+	m_renderQueue->End(m_d3dContext.Get(), *m_states);
+
+	// Draw the lines of the crawl that are on screen, projected onto the crawl plane. It's the biggest sprite
+	// workload, so its CPU time (sprite batching plus the driver calls) is kept for the debug info.
+	if (drawTitle)
+	{
+		auto crawlStart = std::chrono::high_resolution_clock::now();
+		m_crawl->Draw(m_spriteBatch.get(), m_crawl_text * m_crawl_world * m_view * m_proj, crawlColor);
+		m_crawlTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - crawlStart).count();
+		m_crawlStats = m_spriteBatch->GetStatistics();
+	}
 
 	// Draw all of our blaster explosionssss
 	for (int i = 0; i < o_blasterFlashes.size(); i++)
@@ -338,6 +375,26 @@ void Game::Render()
 	}
 
 	// Draw debug text
+	auto spriteStats = m_spriteBatch->GetStatistics();
+
+	// Record the debug info into its layer; only the glyphs that changed since last frame get new vertices
+	if (debug)
+	{
+		std::wostringstream infoTxt;
+		infoTxt << std::setprecision(4) << L"Total seconds: " << debugTime << L"\nCurrent scene: " << debugState;
+		auto& queueStats = m_renderQueue->GetStatistics();
+		infoTxt << L"\nDraw calls: " << queueStats.drawCalls << L" batches: " << queueStats.batches << L" state changes: " << queueStats.StateChanges()
+			<< L"\nMeshes culled: " << queueStats.meshesCulled
+			<< L"\nSprites: " << spriteStats.sprites << L" sprite batches: " << spriteStats.batches
+			<< L"\nCrawl lines: " << m_crawl->GetVisibleLineCount() << L" of " << m_crawl->GetLineCount()
+			<< L"\nCrawl sprites: " << m_crawlStats.sprites << L" batches: " << m_crawlStats.batches << L" vertex KB: " << m_crawlStats.vertexBytes / 1024
+			<< L" Msprites/s: " << (m_crawlTime > 0 ? m_crawlStats.sprites / m_crawlTime / 1e6 : 0);
+
+		m_spriteBatch->Begin(*m_debugLayer);
+		m_font->DrawString(m_spriteBatch.get(), infoTxt.str().c_str(), m_fontPos, Colors::White);
+		m_spriteBatch->End();
+	}
+
 	m_spriteBatch->Begin();
 
 	// Ending fadeout
@@ -349,28 +406,34 @@ void Game::Render()
 
 		// Lerp the fade colour then render it
 		Color fadeTint = Color::Lerp(Color(0.f, 0.f, 0.f, 0.f), (Color)Colors::White, m_timer.GetTotalSeconds() - fadeOutTime);
-		m_spriteBatch->Draw(t_blackbg.Get(), m_fullscreenRect, fadeTint);
+		m_spriteBatch->DrawLayer(*m_backgroundLayer, fadeTint);
 	}
 
 	// Opening prelude rendering
 	if (drawPrelude)
 	{
 		// Draw the black background
-		m_spriteBatch->Draw(t_blackbg.Get(), m_fullscreenRect);
+		m_spriteBatch->DrawLayer(*m_backgroundLayer);
 
 		// Draw bluetext prelude
 		Color preludeTint = Colors::White * (cosf(m_timer.GetTotalSeconds() / 2.5f + 1.f) * -1.5f);
-		m_spriteBatch->Draw(t_prelude.Get(), t_prelude_screen, nullptr, preludeTint, 0.f, t_prelude_origin, 0.5f);
+		m_spriteBatch->DrawLayer(*m_preludeLayer, preludeTint);
 	}
 
 	// Draw debug info if it's enabled
 	if (debug)
+		m_spriteBatch->DrawLayer(*m_debugLayer);
+	m_spriteBatch->End();
+
+	// Copy the finished frame for the recording; it is read back and encoded a few frames later
+	if (m_screenGrab->IsRecording())
 	{
-		std::wostringstream infoTxt;
-		infoTxt << std::setprecision(4) << L"Total seconds: " << debugTime << L"\nCurrent scene: " << debugState;
-		m_font->DrawString(m_spriteBatch.get(), infoTxt.str().c_str(), m_fontPos, Colors::White);
+		ComPtr<ID3D11Resource> backBuffer;
+		m_renderTargetView->GetResource(backBuffer.GetAddressOf());
+		DX::ThrowIfFailed(m_screenGrab->CaptureFrame(m_d3dContext.Get(), backBuffer.Get()));
 	}
-	m_spriteBatch->End();
+
+	m_screenGrab->Update(m_d3dContext.Get());
 
     Present();
 }
@@ -542,11 +605,23 @@ void Game::CreateDevice()
 
 	// Custom code past here
 	m_states = std::make_unique<CommonStates>(m_d3dDevice.Get());
-	m_fxFactory = std::make_unique<EffectFactory>(m_d3dDevice.Get());
-
-	// Prep the text print objects
-	m_font = std::make_unique<SpriteFont>(m_d3dDevice.Get(), L"..\\..\\content\\Fonts\\Arial_14_Regular.spritefont");
+	auto fxFactory = std::make_unique<EffectFactory>(m_d3dDevice.Get());
+	// Read model textures in the background so spawning blasters mid-scene doesn't stall a frame
+	fxFactory->EnableLazyTextureLoading(true);
+	fxFactory->SetTextureCache(m_textureCache);
+	m_fxFactory = std::move(fxFactory);
+
+	// Prep the text print objects. The font, prelude and background are packed into one atlas page
+	// by DDSTool -atlas, so the whole overlay draws in a single sprite batch.
+	m_overlayAtlas = std::make_unique<TextureAtlas>(m_d3dDevice.Get(), L"..\\..\\content\\Textures\\overlay.atlas");
+	m_font = m_overlayAtlas->CreateSpriteFont(L"Arial_14_Regular");
 	m_spriteBatch = std::make_unique<SpriteBatch>(m_d3dContext.Get());
+	m_backgroundLayer = std::make_unique<SpriteBatch::Layer>();
+	m_preludeLayer = std::make_unique<SpriteBatch::Layer>();
+	m_debugLayer = std::make_unique<SpriteBatch::Layer>();
+	m_renderQueue = std::make_unique<RenderQueue>();
+	m_textureStreamer = std::make_unique<DDSTextureStreamer>(m_d3dDevice.Get());
+	m_screenGrab = std::make_unique<ScreenGrabQueue>();
 
 	// Prep models
 	// Star Destroyer
@@ -561,7 +636,18 @@ void Game::CreateDevice()
 	m_title = Model::CreateFromCMO(m_d3dDevice.Get(), L"..\\..\\content\\Models\\title.cmo", *m_fxFactory, true);
 	m_title_world = Matrix::Identity;
 
-	m_crawl = Model::CreateFromCMO(m_d3dDevice.Get(), L"..\\..\\content\\Models\\titlecrawl.cmo", *m_fxFactory, true);
+	// Crawl, laid out once from plain text so changing it doesn't need a new texture
+	std::wifstream crawlFile(L"..\\..\\content\\Text\\crawl.txt");
+	if (!crawlFile)
+		throw std::exception("Failed to open crawl.txt");
+
+	std::wstring crawlText((std::istreambuf_iterator<wchar_t>(crawlFile)), std::istreambuf_iterator<wchar_t>());
+	m_crawl = std::make_unique<TextCrawl>(m_font.get(), crawlText.c_str(), TextCrawlAlignment_Justify);
+	m_crawl->SetFadeDistance(9.f, 10.f); // Same as the fog the crawl model used to have
+
+	// Fit the text to the width of the old crawl plane, with its first line at the plane's far edge
+	float crawlScale = crawlWidth / XMVectorGetX(m_crawl->GetSize());
+	m_crawl_text = Matrix::CreateScale(crawlScale) * Matrix::CreateRotationX(XM_PIDIV2) * Matrix::CreateTranslation(0.f, 0.f, -crawlTop);
 	m_crawl_world = Matrix::Identity;
 
 	// Audio work
@@ -590,19 +676,11 @@ void Game::CreateDevice()
 	m_thereyougo = std::make_unique<SoundEffect>(m_audEngine.get(), L"..\\..\\content\\Audio\\thereyougo.wav");
 
 
-	ComPtr<ID3D11Resource> resource;
-
-	DX::ThrowIfFailed(CreateWICTextureFromFile(m_d3dDevice.Get(), L"..\\..\\content\\Textures\\longtime.png", resource.GetAddressOf(), t_prelude.ReleaseAndGetAddressOf()));
-	DX::ThrowIfFailed(CreateWICTextureFromFile(m_d3dDevice.Get(), L"..\\..\\content\\Textures\\theywantedblacksoigavethemblack.png", nullptr, t_blackbg.ReleaseAndGetAddressOf()));
+	t_prelude = m_overlayAtlas->GetSourceRect(L"longtime");
+	t_blackbg = m_overlayAtlas->GetSourceRect(L"theywantedblacksoigavethemblack");
 
-	ComPtr<ID3D11Texture2D> prelude;
-	DX::ThrowIfFailed(resource.As(&prelude));
-
-	CD3D11_TEXTURE2D_DESC preludeDesc;
-	prelude->GetDesc(&preludeDesc);
-
-	t_prelude_origin.x = float(preludeDesc.Width / 2);
-	t_prelude_origin.y = float(preludeDesc.Height / 2);
+	t_prelude_origin.x = float((t_prelude.right - t_prelude.left) / 2);
+	t_prelude_origin.y = float((t_prelude.bottom - t_prelude.top) / 2);
 
 	// Model light parameters
 	const DirectX::SimpleMath::Vector3 light1pos = Vector3(0.3, 0.3, -0.05);
@@ -663,33 +741,11 @@ void Game::CreateDevice()
 		}
 	});
 
-	m_crawl->UpdateEffects([](IEffect* effect)
-	{
-		auto lights = dynamic_cast<IEffectLights*>(effect);
-		if (lights)
-		{
-			lights->SetLightingEnabled(true);
-			lights->SetAmbientLightColor(Colors::White * 1.3f);
-			lights->SetLightEnabled(0, false);
-			lights->SetLightEnabled(1, false);
-			lights->SetLightEnabled(2, false);
-		}
-
-		auto fog = dynamic_cast<IEffectFog*>(effect);
-		if (fog)
-		{
-			fog->SetFogEnabled(true);
-			fog->SetFogColor(Colors::Black);
-			fog->SetFogStart(9);
-			fog->SetFogEnd(10);
-		}
-	});
-
-	// Prep the skybox
+	// Prep the skybox; the full resolution star field streams in over the first frames
 	if(debug)
-		DX::ThrowIfFailed(CreateWICTextureFromFile(m_d3dDevice.Get(), L"..\\..\\content\\Textures\\horizonsphere.png", nullptr, m_sky_texture.ReleaseAndGetAddressOf()));
+		DX::ThrowIfFailed(m_textureCache->CreateTextureFromFile(m_d3dDevice.Get(), nullptr, L"..\\..\\content\\Textures\\horizonsphere.dds", nullptr, m_sky_texture.ReleaseAndGetAddressOf()));
 	else
-		DX::ThrowIfFailed(CreateWICTextureFromFile(m_d3dDevice.Get(), L"..\\..\\content\\Textures\\Stars1HD.png", nullptr, m_sky_texture.ReleaseAndGetAddressOf()));
+		DX::ThrowIfFailed(m_textureStreamer->CreateTexture(m_d3dContext.Get(), L"..\\..\\content\\Textures\\Stars1HD.dds", nullptr, m_sky_texture.ReleaseAndGetAddressOf(), 256));
 
 	m_sky = GeometricPrimitive::CreateGeoSphere(m_d3dContext.Get(), 100.f, 3U, false);
 	m_sky_world = Matrix::Identity;
@@ -851,6 +907,17 @@ void Game::CreateResources()
 	m_fullscreenRect.right = backBufferWidth;
 	m_fullscreenRect.bottom = backBufferHeight;
 
+	// The overlays only move when the window size changes, so their sprites are recorded once here
+	auto overlay = m_overlayAtlas->GetTexture();
+
+	m_spriteBatch->Begin(*m_backgroundLayer);
+	m_spriteBatch->Draw(overlay, m_fullscreenRect, &t_blackbg);
+	m_spriteBatch->End();
+
+	m_spriteBatch->Begin(*m_preludeLayer);
+	m_spriteBatch->Draw(overlay, t_prelude_screen, &t_prelude, Colors::White, 0.f, t_prelude_origin, 0.5f);
+	m_spriteBatch->End();
+
 	// Push our turrent origin vectors values to the array
 	// Blender axis: X, Z, Y
 
@@ -874,6 +941,13 @@ void Game::OnDeviceLost()
 	m_fxFactory.reset();
 	m_font.reset();
 	m_spriteBatch.reset();
+	m_backgroundLayer.reset();
+	m_preludeLayer.reset();
+	m_debugLayer.reset();
+	m_overlayAtlas.reset();
+	m_renderQueue.reset();
+	m_textureStreamer.reset();
+	m_screenGrab.reset();
 	m_stard.reset();
 	m_runner.reset();
 	m_sky.reset();
@@ -883,8 +957,6 @@ void Game::OnDeviceLost()
 	m_blasterFlash_fx.reset();
 	m_title.reset();
 	m_crawl.reset();
-	t_prelude.Reset();
-	t_blackbg.Reset();
 	
 
 	for (int i = 0; i < o_blasters.size(); i++)
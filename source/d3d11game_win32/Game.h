@@ -83,6 +83,7 @@ private:
 
 	// Debug stuff
 	bool debug = false;
+	bool recordCrawl = false; // Writes each frame of the crawl to crawl00000.png onwards, for making videos
 	int debugState;
 	float debugTime;
 
@@ -105,8 +106,16 @@ private:
 
 	std::unique_ptr<DirectX::CommonStates> m_states;
 	std::unique_ptr<DirectX::IEffectFactory> m_fxFactory;
+	std::shared_ptr<DirectX::TextureCache> m_textureCache;
 	std::unique_ptr<DirectX::SpriteFont> m_font;
 	std::unique_ptr<DirectX::SpriteBatch> m_spriteBatch;
+	std::unique_ptr<DirectX::SpriteBatch::Layer> m_backgroundLayer;
+	std::unique_ptr<DirectX::SpriteBatch::Layer> m_preludeLayer;
+	std::unique_ptr<DirectX::SpriteBatch::Layer> m_debugLayer;
+	std::unique_ptr<DirectX::TextureAtlas> m_overlayAtlas;
+	std::unique_ptr<DirectX::RenderQueue> m_renderQueue;
+	std::unique_ptr<DirectX::DDSTextureStreamer> m_textureStreamer;
+	std::unique_ptr<DirectX::ScreenGrabQueue> m_screenGrab;
 
 	// Resources
 	// Sky stuff
@@ -120,14 +129,22 @@ private:
 	std::unique_ptr<DirectX::Model> m_title;
 	DirectX::SimpleMath::Matrix m_title_world;
 
-	std::unique_ptr<DirectX::Model> m_crawl;
+	// The crawl is text laid out on a plane; m_crawl_text takes its layout pixels onto the plane, then m_crawl_world moves it
+	std::unique_ptr<DirectX::TextCrawl> m_crawl;
+	DirectX::SimpleMath::Matrix m_crawl_text;
 	DirectX::SimpleMath::Matrix m_crawl_world;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> t_prelude;
+	float crawlWidth = 4.25f; // Width of the crawl plane, and the distance from its center to the far edge
+	float crawlTop = 3.4f;
+	DirectX::SimpleMath::Color crawlColor = DirectX::SimpleMath::Color(0.96f, 0.87f, 0.1f);
+	DirectX::SpriteBatch::Statistics m_crawlStats = {}; // Sprite counters and CPU seconds of the last crawl draw
+	double m_crawlTime = 0;
+
+	// Overlay sprites are source rectangles in m_overlayAtlas
+	RECT t_prelude;
 	DirectX::SimpleMath::Vector2 t_prelude_origin;
 	DirectX::SimpleMath::Vector2 t_prelude_screen;
 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> t_blackbg;
+	RECT t_blackbg;
 	RECT m_fullscreenRect;
 
 	// Star Destroyer stuff
@@ -15,7 +15,8 @@
 
 // DirectXTK Project Headers
 #include "CommonStates.h"
-//#include "DDSTextureLoader.h"
+#include "DDSTextureLoader.h"
+#include "DDSTextureStreamer.h"
 //#include "DirectXHelpers.h"
 #include "Effects.h"
 //#include "GamePad.h"
@@ -25,10 +26,14 @@
 #include "Model.h"
 //#include "Mouse.h"
 #include "PrimitiveBatch.h"
-//#include "ScreenGrab.h"
+#include "RenderQueue.h"
+#include "ScreenGrab.h"
 #include "SimpleMath.h"
 #include "SpriteBatch.h"
 #include "SpriteFont.h"
+#include "TextCrawl.h"
+#include "TextureAtlas.h"
+#include "TextureCache.h"
 //#include "VertexTypes.h"
 #include "WICTextureLoader.h"
 #include <Audio.h>
@@ -36,7 +41,9 @@
 // Other stuff used
 //#include <algorithm>
 #include <sstream>
+#include <fstream>
 #include <iomanip>
+#include <chrono>
 //#include <string>
 
 // Use the C++ standard templated min/max
@@ -62,6 +69,7 @@
 #include <wrl/client.h>
 
 #include <d3d11_1.h>
+#include <wincodec.h>
 #include <DirectXMath.h>
 #include <DirectXColors.h>
 